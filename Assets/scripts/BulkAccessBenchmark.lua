@@ -0,0 +1,59 @@
+-- Compares moving transforms one at a time through the per entity bindings
+-- against the bulk GetPositions / SetPositions calls.
+-- Load as a scene script, e.g. LoadLuaScene("/Scripts/BulkAccessBenchmark.lua")
+
+local entityCount = 10000
+local iterations = 10
+
+registry = scene:GetRegistry()
+
+local entities = {}
+for i = 1, entityCount do
+    local entity = registry:Create()
+    registry:assign_Transform(entity)
+    registry:get_Transform(entity):SetLocalPosition(Vector3.new(Rand(-50.0, 50.0), Rand(-50.0, 50.0), Rand(-50.0, 50.0)))
+    entities[i] = entity
+end
+
+local function PerEntity()
+    for i = 1, entityCount do
+        local transform = registry:get_Transform(entities[i])
+        local position = transform:GetLocalPosition()
+        transform:SetLocalPosition(Vector3.new(position.x + 0.1, position.y, position.z))
+    end
+end
+
+local function EachView()
+    registry:view_Transform():each(function(transform)
+        local position = transform:GetLocalPosition()
+        transform:SetLocalPosition(Vector3.new(position.x + 0.1, position.y, position.z))
+    end)
+end
+
+local positions = {}
+local ids = {}
+local function Bulk()
+    local count = registry:GetPositions(positions, ids)
+    for i = 1, count * 3, 3 do
+        positions[i] = positions[i] + 0.1
+    end
+    registry:SetPositions(positions, ids)
+end
+
+local function Measure(name, func)
+    local start = GetTimeMS()
+    for i = 1, iterations do
+        func()
+    end
+    local time = (GetTimeMS() - start) / iterations
+    Log.Info(name .. " : " .. string.format("%.3f", time) .. " ms for " .. entityCount .. " entities")
+    return time
+end
+
+local perEntity = Measure("Per entity get/set", PerEntity)
+Measure("View each", EachView)
+local bulk = Measure("Bulk positions", Bulk)
+Log.Info("Bulk speedup : " .. string.format("%.1f", perEntity / bulk) .. "x")
+
+function OnUpdate(dt)
+end
@@ -1,7 +1,18 @@
+-- Nothing happens per frame here, a 1 Hz update is enough
+UpdateRate = ScriptUpdateRate.OneHz
+
 function OnInit()
     Log.Warn("luaTest Component OnInit")
 end 
 
 function OnUpdate(dt)
     --Log.Critical("luaTest Component  OnUpdate")
-end
\ No newline at end of file
+end
+
+-- Resumed by the scheduler only when the wait has expired
+function Run()
+    while true do
+        wait(5.0)
+        Log.Info("luaTest Component Run")
+    end
+end
@@ -2,17 +2,24 @@
 echo "Compiling shaders"
 cd "$(dirname "$0")"
 
-COMPILER="/Users/josephmorton/vulkansdk-macos-1.2.141.0/macOS/bin/glslangValidator"
+# Use the SDK's compiler when VULKAN_SDK is set, otherwise whichever is on the PATH
+if [ -n "$VULKAN_SDK" ]
+then
+    COMPILER="$VULKAN_SDK/bin/glslangValidator"
+else
+    COMPILER="glslangValidator"
+fi
 
 echo $COMPILER
 
-DSTDIR=compiledSPV
+DSTDIR=CompiledSPV
+mkdir -p $DSTDIR
 
 for SRC in *.vert *.frag *.comp; do
 
     if [ -e $SRC ]
     then
-        OUT="compiledSPV/$(echo "$SRC" | sed "s/\.frag$/.frag/" | sed "s/\.vert$/.vert/" | sed "s/\.comp$/.comp/").spv"
+        OUT="$DSTDIR/$(echo "$SRC" | sed "s/\.frag$/.frag/" | sed "s/\.vert$/.vert/" | sed "s/\.comp$/.comp/").spv"
 
         if [ -e $OUT ]
         then    
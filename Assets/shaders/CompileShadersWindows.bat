@@ -2,9 +2,14 @@
 @echo off
 setLocal enableExtensions enableDelayedExpansion
 
-dir=$(cd -P -- "$(dirname -- "${BASH_SOURCE[0]}")" && pwd -P)
+cd /d "%~dp0"
 
-set COMPILER=C:/VulkanSDK/1.1.126.0/Bin32/glslangValidator.exe
+rem Use the SDK's compiler when VULKAN_SDK is set, otherwise whichever is on the PATH
+if defined VULKAN_SDK (
+  set COMPILER="%VULKAN_SDK%\Bin\glslangValidator.exe"
+) else (
+  set COMPILER=glslangValidator.exe
+)
 set DSTDIR=CompiledSPV
 
 echo Compiling Shaders to spv
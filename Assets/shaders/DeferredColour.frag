@@ -8,14 +8,10 @@ layout(location = 2) in vec4 fragPosition;
 layout(location = 3) in vec3 fragNormal;
 layout(location = 4) in vec3 fragTangent;
 
-layout(set = 1, binding = 0) uniform sampler2D u_AlbedoMap;
-layout(set = 1, binding = 1) uniform sampler2D u_MetallicMap;
-layout(set = 1, binding = 2) uniform sampler2D u_RoughnessMap;
-layout(set = 1, binding = 3) uniform sampler2D u_NormalMap;
-layout(set = 1, binding = 4) uniform sampler2D u_AOMap;
-layout(set = 1, binding = 5) uniform sampler2D u_EmissiveMap;
-
-layout(set = 1,binding = 6) uniform UniformMaterialData
+#define MAX_MATERIAL_TEXTURES 16
+#define MAX_MATERIALS 128
+
+struct MaterialData
 {
 	vec4  albedoColour;
 	vec4  RoughnessColour;
@@ -29,13 +25,40 @@ layout(set = 1,binding = 6) uniform UniformMaterialData
 	float usingEmissiveMap;
 	float workflow;
 	float padding;
-} materialProperties;
+	uint  albedoMap;
+	uint  metallicMap;
+	uint  roughnessMap;
+	uint  normalMap;
+	uint  aoMap;
+	uint  emissiveMap;
+	uint  padding1;
+	uint  padding2;
+};
+
+layout(push_constant) uniform PushConsts
+{
+	uint materialIndex;
+} pushConsts;
 
+layout(set = 1, binding = 0) uniform sampler2D u_Textures[MAX_MATERIAL_TEXTURES];
+
+layout(set = 1, binding = 2) uniform UniformMaterialData
+{
+	MaterialData materials[MAX_MATERIALS];
+} materialTable;
+
+#define materialProperties materialTable.materials[pushConsts.materialIndex]
+#define u_AlbedoMap u_Textures[materialProperties.albedoMap]
+#define u_MetallicMap u_Textures[materialProperties.metallicMap]
+#define u_RoughnessMap u_Textures[materialProperties.roughnessMap]
+#define u_NormalMap u_Textures[materialProperties.normalMap]
+#define u_AOMap u_Textures[materialProperties.aoMap]
+#define u_EmissiveMap u_Textures[materialProperties.emissiveMap]
+
+// Positions are rebuilt from depth in DeferredLight.frag
 layout(location = 0) out vec4 outColor;
-layout(location = 1) out vec4 outPosition;
-layout(location = 2) out vec4 outNormal;
-layout(location = 3) out vec4 outPBR;
-layout(location = 4) out vec4 outDepth;
+layout(location = 1) out vec4 outNormal;
+layout(location = 2) out vec4 outPBR;
 
 const float PBR_WORKFLOW_SEPARATE_TEXTURES = 0.0f;
 const float PBR_WORKFLOW_METALLIC_ROUGHNESS = 1.0f;
@@ -81,12 +104,25 @@ vec3 GetEmissive()
 	return (1.0 - materialProperties.usingEmissiveMap) * materialProperties.emissiveColour.rgb + materialProperties.usingEmissiveMap * GammaCorrectTextureRGB(texture(u_EmissiveMap, fragTexCoord));
 }
 
+// Must match GBuffer::EncodeNormal
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 encoded = n.xy;
+	if (n.z < 0.0)
+		encoded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return encoded;
+}
+
 vec3 GetNormalFromMap()
 {
 	if (materialProperties.usingNormalMap < 0.1)
 		return normalize(fragNormal);
 
-	vec3 tangentNormal = texture(u_NormalMap, fragTexCoord).xyz * 2.0 - 1.0;
+	// z is rebuilt so two channel (BC5) cooked normal maps work too
+	vec3 tangentNormal;
+	tangentNormal.xy = texture(u_NormalMap, fragTexCoord).xy * 2.0 - 1.0;
+	tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
 
 	vec3 Q1 = dFdx(fragPosition.xyz);
 	vec3 Q2 = dFdy(fragPosition.xyz);
@@ -132,11 +168,6 @@ void main()
 	float ao		= GetAO();
 
     outColor    = texColour;
-	outPosition = fragPosition;
-	outNormal   = vec4(GetNormalFromMap(),1.0);
-	outPBR      = vec4(metallic,roughness, ao, 1.0);
-
-	outPosition.w = emissive.x;
-	outNormal.w   = emissive.y;
-	outPBR.w      = emissive.z;
+	outNormal   = vec4(EncodeNormal(GetNormalFromMap()), emissive.xy);
+	outPBR      = vec4(metallic, roughness, ao, emissive.z);
 }
\ No newline at end of file
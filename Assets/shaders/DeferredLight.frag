@@ -6,18 +6,24 @@ layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 
 layout(set = 1, binding = 0) uniform sampler2D uColourSampler;
-layout(set = 1, binding = 1) uniform sampler2D uPositionSampler;
+layout(set = 1, binding = 1) uniform sampler2D uDepthSampler;
 layout(set = 1, binding = 2) uniform sampler2D uNormalSampler;
 layout(set = 1, binding = 3) uniform sampler2D uPBRSampler;
 layout(set = 1, binding = 4) uniform sampler2D uPreintegratedFG;
 layout(set = 1, binding = 5) uniform samplerCube uEnvironmentMap;
 layout(set = 1, binding = 6) uniform samplerCube uIrradianceMap;
 layout(set = 1, binding = 7) uniform sampler2DArray uShadowMap;
-layout(set = 1, binding = 8) uniform sampler2D uDepthSampler;
 
-#define MAX_LIGHTS 32
+#define MAX_LIGHTS 256
 #define MAX_SHADOWMAPS 16
 
+// Must match LightClusterGrid.h
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+#define MAX_CLUSTER_LIGHT_INDICES 16384
+
 struct Light
 {
 	vec4 colour;
@@ -31,18 +37,41 @@ struct Light
 
 layout(std140, binding = 0) uniform UniformBufferLight
 {
-	Light lights[MAX_LIGHTS];
  	vec4 cameraPosition;
 	mat4 viewMatrix;
 	mat4 uShadowTransform[MAX_SHADOWMAPS];
     vec4 uSplitDepths[MAX_SHADOWMAPS];
 	mat4 biasMat;
+	mat4 clusterProjView;
+	mat4 screenToWorld; // (u, v, depth) to world space, see GBuffer::BuildScreenToWorld
+	vec4 clusterParams; // x : slice scale, y : slice bias, z : clustering enabled, w : heatmap scale
 	int lightCount;
 	int shadowCount;
 	int mode;
 	int cubemapMipLevels;
+	int directionalLightCount;
+	int padding0;
+	int padding1;
+	int padding2;
 } ubo;
 
+layout(std140, binding = 1) uniform UniformBufferClusterLights
+{
+	Light lights[MAX_LIGHTS];
+} lightData;
+
+// offset | count << 16, four clusters per element
+layout(std140, binding = 2) uniform UniformBufferClusters
+{
+	uvec4 clusters[CLUSTER_COUNT / 4];
+} clusterData;
+
+// u8 light indices, sixteen per element
+layout(std140, binding = 3) uniform UniformBufferClusterIndices
+{
+	uvec4 indices[MAX_CLUSTER_LIGHT_INDICES / 16];
+} clusterIndices;
+
 #define PI 3.1415926535897932384626433832795
 #define GAMMA 2.2
 
@@ -99,75 +128,127 @@ vec3 fresnelSchlickRoughness(vec3 F0, float cosTheta, float roughness)
     return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(1.0 - cosTheta, 5.0);
 }
 
-vec3 Lighting(vec3 F0, float shadow, vec3 wsPos, Material material)
+vec3 CalculateLight(Light light, vec3 F0, float shadow, vec3 wsPos, Material material)
 {
-	vec3 result = vec3(0.0);
+	float value = shadow;
 
-	for(int i = 0; i < ubo.lightCount; i++)
+	if(light.type == 2.0)
 	{
-		Light light = ubo.lights[i];
+	    // Vector to light
+		vec3 L = light.position.xyz - wsPos;
+		// Distance from light to fragment position
+		float dist = length(L);
 
-		float value = shadow;
+		// Light to fragment
+		L = normalize(L);
 
-		if(light.type == 2.0)
-		{
-		    // Vector to light
-			vec3 L = light.position.xyz - wsPos;
-			// Distance from light to fragment position
-			float dist = length(L);
+		// Attenuation
+		float atten = light.radius / (pow(dist, 2.0) + 1.0);
+
+		value = atten;
+
+		light.direction = vec4(L,1.0);
+	}
+	else if (light.type == 1.0)
+	{
+		vec3 L = light.position.xyz - wsPos;
+		float cutoffAngle   = 1.0f - light.angle;      
+		float dist          = length(L);
+		L = normalize(L);
+		float theta         = dot(L.xyz, light.direction.xyz);
+		float epsilon       = cutoffAngle - cutoffAngle * 0.9f;
+		float attenuation 	= ((theta - cutoffAngle) / epsilon); // atteunate when approaching the outer cone
+		attenuation         *= light.radius / (pow(dist, 2.0) + 1.0);//saturate(1.0f - dist / light.range);
+		//float intensity 	= attenuation * attenuation;
+		
+		
+		// Erase light if there is no need to compute it
+		//intensity *= step(theta, cutoffAngle);
+
+		value = clamp(attenuation, 0.0, 1.0);
+	}
 
-			// Light to fragment
-			L = normalize(L);
+	vec3 Li = light.direction.xyz;
+	vec3 Lradiance = light.colour.xyz * light.intensity;
+	vec3 Lh = normalize(Li + material.View);
 
-			// Attenuation
-			float atten = light.radius / (pow(dist, 2.0) + 1.0);
+	// Calculate angles between surface normal and various light vectors.
+	float cosLi = max(0.0, dot(material.Normal, Li));
+	float cosLh = max(0.0, dot(material.Normal, Lh));
 
-			value = atten;
+	vec3 F = fresnelSchlick(F0, max(0.0, dot(Lh, material.View)));
+	float D = ndfGGX(cosLh, material.Roughness);
+	float G = gaSchlickGGX(cosLi, material.NDotV, material.Roughness);
 
-			light.direction = vec4(L,1.0);
-		}
-		else if (light.type == 1.0)
-		{
-			vec3 L = light.position.xyz - wsPos;
-			float cutoffAngle   = 1.0f - light.angle;      
-			float dist          = length(L);
-			L = normalize(L);
-			float theta         = dot(L.xyz, light.direction.xyz);
-			float epsilon       = cutoffAngle - cutoffAngle * 0.9f;
-			float attenuation 	= ((theta - cutoffAngle) / epsilon); // atteunate when approaching the outer cone
-			attenuation         *= light.radius / (pow(dist, 2.0) + 1.0);//saturate(1.0f - dist / light.range);
-			//float intensity 	= attenuation * attenuation;
-			
-			
-			// Erase light if there is no need to compute it
-			//intensity *= step(theta, cutoffAngle);
-
-			value = clamp(attenuation, 0.0, 1.0);
-		}
+	vec3 kd = (1.0 - F) * (1.0 - material.Metallic.x);
+	vec3 diffuseBRDF = kd * material.Albedo.xyz;
+
+	// Cook-Torrance
+	vec3 specularBRDF = (F * D * G) / max(Epsilon, 4.0 * cosLi * material.NDotV);
+
+	return (diffuseBRDF + specularBRDF) * Lradiance * cosLi * value * material.AO;
+}
+
+uint GetClusterIndex(vec3 wsPos)
+{
+	vec4 clipPos = vec4(wsPos, 1.0) * ubo.clusterProjView;
+	vec2 ndc = clipPos.xy / clipPos.w;
+
+	uint x = uint(clamp((ndc.x * 0.5 + 0.5) * CLUSTER_GRID_X, 0.0, CLUSTER_GRID_X - 1));
+	uint y = uint(clamp((ndc.y * 0.5 + 0.5) * CLUSTER_GRID_Y, 0.0, CLUSTER_GRID_Y - 1));
+	uint z = uint(clamp(log(max(clipPos.w, 0.0001)) * ubo.clusterParams.x + ubo.clusterParams.y, 0.0, CLUSTER_GRID_Z - 1));
+
+	return x + y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+}
 
-		vec3 Li = light.direction.xyz;
-		vec3 Lradiance = light.colour.xyz * light.intensity;
-		vec3 Lh = normalize(Li + material.View);
+uint GetClusterData(uint clusterIndex)
+{
+	return clusterData.clusters[clusterIndex / 4][clusterIndex % 4];
+}
 
-		// Calculate angles between surface normal and various light vectors.
-		float cosLi = max(0.0, dot(material.Normal, Li));
-		float cosLh = max(0.0, dot(material.Normal, Lh));
+uint GetClusterLightIndex(uint index)
+{
+	uint word = clusterIndices.indices[index / 16][(index / 4) % 4];
+	return (word >> ((index % 4) * 8)) & 0xFF;
+}
 
-		vec3 F = fresnelSchlick(F0, max(0.0, dot(Lh, material.View)));
-		float D = ndfGGX(cosLh, material.Roughness);
-		float G = gaSchlickGGX(cosLi, material.NDotV, material.Roughness);
+vec3 Lighting(vec3 F0, float shadow, vec3 wsPos, Material material)
+{
+	vec3 result = vec3(0.0);
 
-		vec3 kd = (1.0 - F) * (1.0 - material.Metallic.x);
-		vec3 diffuseBRDF = kd * material.Albedo.xyz;
+	for(int i = 0; i < ubo.directionalLightCount; i++)
+	{
+		result += CalculateLight(lightData.lights[i], F0, shadow, wsPos, material);
+	}
 
-		// Cook-Torrance
-		vec3 specularBRDF = (F * D * G) / max(Epsilon, 4.0 * cosLi * material.NDotV);
+	if(ubo.clusterParams.z > 0.0)
+	{
+		uint cluster = GetClusterData(GetClusterIndex(wsPos));
+		uint offset = cluster & 0xFFFF;
+		uint count = cluster >> 16;
 
-		result += (diffuseBRDF + specularBRDF) * Lradiance * cosLi * value * material.AO;
+		for(uint i = 0; i < count; i++)
+		{
+			result += CalculateLight(lightData.lights[GetClusterLightIndex(offset + i)], F0, shadow, wsPos, material);
+		}
+	}
+	else
+	{
+		for(int i = ubo.directionalLightCount; i < ubo.lightCount; i++)
+		{
+			result += CalculateLight(lightData.lights[i], F0, shadow, wsPos, material);
+		}
 	}
+
 	return result;
 }
 
+vec3 HeatmapColour(float value)
+{
+	value = clamp(value, 0.0, 1.0);
+	return clamp(vec3(value * 4.0 - 2.0, 2.0 - abs(value * 4.0 - 2.0), 2.0 - value * 4.0), 0.0, 1.0);
+}
+
 vec3 RadianceIBLIntegration(float NdotV, float roughness, vec3 metallic)
 {
 	vec2 preintegratedFG = texture(uPreintegratedFG, vec2(roughness, 1.0 - NdotV)).rg;
@@ -200,6 +281,22 @@ vec3 GammaCorrectTextureRGB(vec3 texCol)
 	return vec3(pow(texCol.rgb, vec3(GAMMA)));
 }
 
+// Must match GBuffer::DecodeNormal
+vec3 DecodeNormal(vec2 encoded)
+{
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -fold : fold;
+	n.y += n.y >= 0.0 ? -fold : fold;
+	return normalize(n);
+}
+
+vec3 ReconstructPosition(vec2 uv, float depth)
+{
+	vec4 wsPos = vec4(uv, depth, 1.0) * ubo.screenToWorld;
+	return wsPos.xyz / wsPos.w;
+}
+
 float Attentuate( vec3 lightData, float dist )
 {
 	float att =  1.0 / ( lightData.x + lightData.y*dist + lightData.z*dist*dist );
@@ -215,7 +312,10 @@ float textureProj(vec4 shadowCoord, vec2 offset, int cascadeIndex)
 
 	if ( shadowCoord.z > -1.0 && shadowCoord.z < 1.0 && shadowCoord.w > 0)
 	{
-		float dist = texture(uShadowMap, vec3(shadowCoord.st + offset, cascadeIndex)).r;
+		// Cached static casters and per frame dynamic casters live in separate layers
+		float staticDist = texture(uShadowMap, vec3(shadowCoord.st + offset, cascadeIndex)).r;
+		float dynamicDist = texture(uShadowMap, vec3(shadowCoord.st + offset, cascadeIndex + ubo.shadowCount)).r;
+		float dist = min(staticDist, dynamicDist);
 		if (dist < shadowCoord.z - bias)
 		{
 			shadow = ambient;
@@ -283,16 +383,16 @@ void main()
 	if(colourTex.w < 0.1)
         discard;
 
-    vec4 positionTex = texture(uPositionSampler , fragTexCoord);
+    float depth      = texture(uDepthSampler    , fragTexCoord).r;
     vec4 pbrTex		 = texture(uPBRSampler      , fragTexCoord);
     vec4 normalTex   = texture(uNormalSampler   , fragTexCoord);
 
     vec3  spec      = vec3(pbrTex.x);
 
 	float roughness = pbrTex.y;
-	vec3 emissive	= vec3(positionTex.w, normalTex.w, pbrTex.w);
-    vec3 wsPos      = positionTex.xyz;
-	vec3 normal		= normalize(normalTex.xyz);
+	vec3 emissive	= vec3(normalTex.z, normalTex.w, pbrTex.w);
+    vec3 wsPos      = ReconstructPosition(fragTexCoord, depth);
+	vec3 normal		= DecodeNormal(normalTex.xy);
     vec3 finalColour;
 
 	Material material;
@@ -349,6 +449,12 @@ void main()
                     case 3 : outColor = outColor * vec4(0.8,0.8,0.2,1.0); break;
                 }
                 break;
+			case 8:
+			{
+				float count = ubo.clusterParams.z > 0.0 ? float(GetClusterData(GetClusterIndex(wsPos)) >> 16) : float(ubo.lightCount - ubo.directionalLightCount);
+				outColor = vec4(mix(colourTex.rgb * 0.2, HeatmapColour(count / ubo.clusterParams.w), count > 0.0 ? 0.8 : 0.0), 1.0);
+				break;
+			}
 		}
 	}
 }
@@ -9,9 +9,14 @@
 #include "Graphics/API/Renderer.h"
 #include "Graphics/API/GraphicsContext.h"
 #include "Graphics/RenderManager.h"
+#include "Graphics/Renderers/OcclusionCuller.h"
 #include "Graphics/Layers/LayerStack.h"
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Material.h"
+#include "Graphics/MaterialTable.h"
+#include "Graphics/ParticleManager.h"
+#include "Graphics/TerrainManager.h"
+#include "Graphics/Animation/AnimationManager.h"
 #include "Graphics/Renderers/DebugRenderer.h"
 
 #include "ECS/Component/MeshComponent.h"
@@ -115,7 +120,7 @@ namespace Lumos
 
 		m_SystemManager = CreateScope<SystemManager>();
 
-		auto audioManager = AudioManager::Create();
+		auto audioManager = AudioManager::Create(static_cast<AudioBackend>(m_InitialProperties.AudioBackend));
 		if (audioManager)
 		{
 			audioManager->OnInit();
@@ -124,6 +129,9 @@ namespace Lumos
 
 		m_SystemManager->RegisterSystem<LumosPhysicsEngine>();
 		m_SystemManager->RegisterSystem<B2PhysicsEngine>();
+		m_SystemManager->RegisterSystem<ParticleManager>();
+		m_SystemManager->RegisterSystem<TerrainManager>();
+		m_SystemManager->RegisterSystem<AnimationManager>();
 
         Material::InitDefaultTexture();
 
@@ -156,6 +164,7 @@ namespace Lumos
         lmdel m_Editor;
         #endif
 
+		MaterialTable::Release();
 		Graphics::Renderer::Release();
 		Graphics::GraphicsContext::Release();
 
@@ -269,6 +278,9 @@ namespace Lumos
             m_Editor->OnRender();
 #endif
 
+			// Once a frame, before any renderer submits meshes
+			m_RenderManager->GetOcclusionCuller()->Build(m_SceneManager->GetCurrentScene());
+
 			m_LayerStack->OnRender(m_SceneManager->GetCurrentScene());
 			DebugRenderer::Render(m_SceneManager->GetCurrentScene());
 			m_ImGuiLayer->OnRender(m_SceneManager->GetCurrentScene());
@@ -0,0 +1,154 @@
+#include "lmpch.h"
+#include "EntityIndex.h"
+#include "SceneGraph.h"
+
+namespace Lumos
+{
+	static const std::vector<entt::entity> s_NoEntities;
+
+	// Lists are kept in entity id order, so the same set of entities always reads back the same way
+	static bool ComesBefore(entt::entity a, entt::entity b)
+	{
+		return entt::registry::entity(a) < entt::registry::entity(b);
+	}
+
+	static String FoldCase(const String& key)
+	{
+		String folded = key;
+		for (auto& c : folded)
+			c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		return folded;
+	}
+
+	void EntityIndex::Index::Insert(entt::entity entity, const String& key)
+	{
+		Remove(entity);
+
+		auto& list = entities[key];
+		if (list.empty())
+			sortedKeys.emplace(FoldCase(key), key);
+
+		list.insert(std::lower_bound(list.begin(), list.end(), entity, ComesBefore), entity);
+		keys[entity] = key;
+	}
+
+	void EntityIndex::Index::Remove(entt::entity entity)
+	{
+		auto keyIt = keys.find(entity);
+		if (keyIt == keys.end())
+			return;
+
+		auto listIt = entities.find(keyIt->second);
+		if (listIt != entities.end())
+		{
+			auto& list = listIt->second;
+			list.erase(std::find(list.begin(), list.end(), entity));
+
+			if (list.empty())
+			{
+				sortedKeys.erase({ FoldCase(keyIt->second), keyIt->second });
+				entities.erase(listIt);
+			}
+		}
+
+		keys.erase(keyIt);
+	}
+
+	void EntityIndex::Index::Clear()
+	{
+		entities.clear();
+		keys.clear();
+		sortedKeys.clear();
+	}
+
+	void EntityIndex::Init(entt::registry& registry)
+	{
+		m_Registry = &registry;
+
+		registry.on_construct<NameComponent>().connect<&EntityIndex::OnNameChanged>(*this);
+		registry.on_update<NameComponent>().connect<&EntityIndex::OnNameChanged>(*this);
+		registry.on_destroy<NameComponent>().connect<&EntityIndex::OnNameDestroyed>(*this);
+
+		registry.on_construct<TagComponent>().connect<&EntityIndex::OnTagChanged>(*this);
+		registry.on_update<TagComponent>().connect<&EntityIndex::OnTagChanged>(*this);
+		registry.on_destroy<TagComponent>().connect<&EntityIndex::OnTagDestroyed>(*this);
+
+		Rebuild();
+	}
+
+	void EntityIndex::OnNameChanged(entt::registry& registry, entt::entity entity)
+	{
+		m_Names.Insert(entity, registry.get<NameComponent>(entity).name);
+	}
+
+	void EntityIndex::OnNameDestroyed(entt::registry&, entt::entity entity)
+	{
+		m_Names.Remove(entity);
+	}
+
+	void EntityIndex::OnTagChanged(entt::registry& registry, entt::entity entity)
+	{
+		m_Tags.Insert(entity, registry.get<TagComponent>(entity).tag);
+	}
+
+	void EntityIndex::OnTagDestroyed(entt::registry&, entt::entity entity)
+	{
+		m_Tags.Remove(entity);
+	}
+
+	void EntityIndex::Rebuild()
+	{
+		m_Names.Clear();
+		m_Tags.Clear();
+
+		auto names = m_Registry->view<NameComponent>();
+		for (size_t i = 0; i < names.size(); i++)
+			m_Names.Insert(names.data()[i], names.raw()[i].name);
+
+		auto tags = m_Registry->view<TagComponent>();
+		for (size_t i = 0; i < tags.size(); i++)
+			m_Tags.Insert(tags.data()[i], tags.raw()[i].tag);
+
+		m_Dirty = false;
+	}
+
+	entt::entity EntityIndex::FindByName(const String& name)
+	{
+		auto& entities = FindAllByName(name);
+		return entities.empty() ? entt::null : entities.front();
+	}
+
+	const std::vector<entt::entity>& EntityIndex::FindAllByName(const String& name)
+	{
+		if (m_Dirty)
+			Rebuild();
+
+		auto it = m_Names.entities.find(name);
+		return it != m_Names.entities.end() ? it->second : s_NoEntities;
+	}
+
+	const std::vector<entt::entity>& EntityIndex::FindAllByTag(const String& tag)
+	{
+		if (m_Dirty)
+			Rebuild();
+
+		auto it = m_Tags.entities.find(tag);
+		return it != m_Tags.entities.end() ? it->second : s_NoEntities;
+	}
+
+	void EntityIndex::FindByNamePrefix(const String& prefix, std::vector<entt::entity>& entities)
+	{
+		if (m_Dirty)
+			Rebuild();
+
+		const String folded = FoldCase(prefix);
+		for (auto it = m_Names.sortedKeys.lower_bound({ folded, String() }); it != m_Names.sortedKeys.end(); ++it)
+		{
+			if (it->first.compare(0, folded.size(), folded) != 0)
+				break;
+
+			auto& list = m_Names.entities[it->second];
+			entities.insert(entities.end(), list.begin(), list.end());
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "lmpch.h"
+
+#include <entt/entt.hpp>
+#include <set>
+
+namespace Lumos
+{
+	// Lookup from entity names and tags to entities, kept current through the registry's
+	// NameComponent / TagComponent signals. Writes that bypass the registry (assigning
+	// NameComponent::name directly) must call MarkDirty so the next query rebuilds.
+	// One instance lives in each registry's context, see EntityIndex::Get.
+	class LUMOS_EXPORT EntityIndex
+	{
+	public:
+		EntityIndex() = default;
+		~EntityIndex() = default;
+
+		void Init(entt::registry& registry);
+
+		// Returns the entity with the name and the lowest id, or entt::null
+		entt::entity FindByName(const String& name);
+
+		// Both lists are in entity id order
+		const std::vector<entt::entity>& FindAllByName(const String& name);
+		const std::vector<entt::entity>& FindAllByTag(const String& tag);
+
+		// Appends every entity whose name starts with prefix, ignoring case, in name order, then entity id order
+		void FindByNamePrefix(const String& prefix, std::vector<entt::entity>& entities);
+
+		void MarkDirty() { m_Dirty = true; }
+
+		static EntityIndex* Get(entt::registry& registry) { return registry.try_ctx<EntityIndex>(); }
+
+	private:
+		struct Index
+		{
+			std::unordered_map<String, std::vector<entt::entity>> entities;
+			std::unordered_map<entt::entity, String> keys;
+
+			// Case folded key first, so prefix searches ignore case
+			std::set<std::pair<String, String>> sortedKeys;
+
+			void Insert(entt::entity entity, const String& key);
+			void Remove(entt::entity entity);
+			void Clear();
+		};
+
+		void OnNameChanged(entt::registry& registry, entt::entity entity);
+		void OnNameDestroyed(entt::registry& registry, entt::entity entity);
+		void OnTagChanged(entt::registry& registry, entt::entity entity);
+		void OnTagDestroyed(entt::registry& registry, entt::entity entity);
+
+		void Rebuild();
+
+		entt::registry* m_Registry = nullptr;
+		Index m_Names;
+		Index m_Tags;
+		bool m_Dirty = false;
+	};
+}
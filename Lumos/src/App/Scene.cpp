@@ -3,6 +3,9 @@
 #include "Core/OS/Input.h"
 #include "Application.h"
 #include "Scripting/LuaManager.h"
+#include "Utilities/Timer.h"
+#include "EntityIndex.h"
+#include "SceneRaycast.h"
 #include "Graphics/API/GraphicsContext.h"
 #include "Graphics/Layers/LayerStack.h"
 #include "Graphics/RenderManager.h"
@@ -108,6 +111,12 @@ namespace Lumos
 		m_SceneBoundingRadius = 400.0f; //Default scene radius of 400m
 
 		m_SceneGraph.Init(m_Registry);
+
+		if (!EntityIndex::Get(m_Registry))
+			m_Registry.set<EntityIndex>().Init(m_Registry);
+
+		if (!SceneRaycast::Get(m_Registry))
+			m_Registry.set<SceneRaycast>().Init(m_Registry);
 	}
 
 	void Scene::OnCleanupScene()
@@ -155,6 +164,14 @@ namespace Lumos
 
 	void Scene::OnUpdate(const TimeStep& timeStep)
 	{
+		if (m_ResetLevel)
+		{
+			m_ResetLevel = false;
+			m_LevelSnapshot.Restore(m_Registry, this);
+			if (auto raycast = SceneRaycast::Get(m_Registry))
+				raycast->MarkDirty();
+		}
+
 		const Maths::Vector2 mousePos = Input::GetInput()->GetMousePosition();
 
         auto cameraView = m_Registry.view<Camera>();
@@ -172,9 +189,13 @@ namespace Lumos
         }
 
 		m_SceneGraph.Update(m_Registry);
+
+		if (auto raycast = SceneRaycast::Get(m_Registry))
+			raycast->MarkMoved();
         
         if(m_LuaUpdateFunction)
         {
+            Timer timer;
             sol::protected_function_result result = m_LuaUpdateFunction.call(timeStep.GetElapsedMillis());
             if (!result.valid())
             {
@@ -182,6 +203,7 @@ namespace Lumos
                 Debug::Log::Error("Failed to Execute Scene Lua update" );
                 Debug::Log::Error("Error : {0}", err.what());
             }
+            LuaManager::Instance()->SetSceneScriptTime(timer.GetMS(1000.0f));
         }
 	}
 
@@ -257,6 +279,18 @@ namespace Lumos
         m_LuaUpdateFunction = m_LuaEnv["OnUpdate"];
     }
 
+	void Scene::SaveLevelSnapshot()
+	{
+		m_LevelSnapshot.Capture(m_Registry);
+		LUMOS_LOG_INFO("Saved level snapshot : {0} entities, {1} bytes, {2} ms", m_LevelSnapshot.GetEntityCount(), m_LevelSnapshot.GetSize(), m_LevelSnapshot.GetCaptureTime());
+	}
+
+	void Scene::ResetLevel()
+	{
+		if (!m_LevelSnapshot.Empty())
+			m_ResetLevel = true;
+	}
+
     Scene* Scene::LoadFromLua(const String& filePath)
     {
         Scene* scene = new Scene("");
@@ -1,6 +1,7 @@
 #pragma once
 #include "lmpch.h"
 #include "SceneGraph.h"
+#include "SceneSnapshot.h"
 #include "Maths/Maths.h"
 #include "Utilities/AssetManager.h"
 
@@ -82,6 +83,12 @@ namespace Lumos
         
         static Scene* LoadFromLua(const String& filePath);
 
+		// Keeps the current state of the scene to return to with ResetLevel
+		void SaveLevelSnapshot();
+		// Restores the last saved snapshot at the start of the next update, so it is safe to call from scripts
+		void ResetLevel();
+		const SceneSnapshot& GetLevelSnapshot() const { return m_LevelSnapshot; }
+
 	protected:
 
 		String m_SceneName;
@@ -96,6 +103,9 @@ namespace Lumos
 
 		SceneGraph m_SceneGraph;
 
+		SceneSnapshot m_LevelSnapshot;
+		bool m_ResetLevel = false;
+
     private:
 		NONCOPYABLE(Scene)
 
@@ -9,6 +9,11 @@ namespace Lumos
         String name;
     };
 
+	struct TagComponent
+	{
+		String tag;
+	};
+
 	struct ActiveComponent
 	{
         ActiveComponent(bool act)
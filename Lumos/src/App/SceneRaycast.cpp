@@ -0,0 +1,178 @@
+#include "lmpch.h"
+#include "SceneRaycast.h"
+#include "ECS/Component/MeshComponent.h"
+#include "Maths/Transform.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+namespace Lumos
+{
+	void SceneRaycast::Init(entt::registry& registry)
+	{
+		m_Registry = &registry;
+
+		registry.on_construct<MeshComponent>().connect<&SceneRaycast::OnMeshesChanged>(*this);
+		registry.on_update<MeshComponent>().connect<&SceneRaycast::OnMeshesChanged>(*this);
+		registry.on_destroy<MeshComponent>().connect<&SceneRaycast::OnMeshesChanged>(*this);
+		registry.on_construct<Maths::Transform>().connect<&SceneRaycast::OnMeshesChanged>(*this);
+		registry.on_destroy<Maths::Transform>().connect<&SceneRaycast::OnMeshesChanged>(*this);
+
+		MarkDirty();
+	}
+
+	void SceneRaycast::OnMeshesChanged(entt::registry&, entt::entity)
+	{
+		m_Dirty = true;
+	}
+
+	void SceneRaycast::Update()
+	{
+		if (!m_Dirty && !m_Moved)
+			return;
+
+		LUMOS_PROFILE_FUNC;
+
+		if (m_Dirty)
+		{
+			m_Instances.clear();
+
+			auto group = m_Registry->group<MeshComponent>(entt::get<Maths::Transform>);
+			for (auto entity : group)
+			{
+				if (group.get<MeshComponent>(entity).GetMesh())
+					m_Instances.push_back({ entity, nullptr, Maths::Matrix3x4::IDENTITY, Maths::Matrix3::IDENTITY });
+			}
+		}
+
+		m_Bounds.resize(m_Instances.size());
+
+		for (size_t i = 0; i < m_Instances.size(); i++)
+		{
+			auto& instance = m_Instances[i];
+			auto& worldMatrix = m_Registry->get<Maths::Transform>(instance.entity).GetWorldMatrix();
+
+			// SetMesh does not go through the registry, so the pointer is read again here
+			instance.mesh = m_Registry->get<MeshComponent>(instance.entity).GetMesh();
+			if (!instance.mesh)
+			{
+				m_Bounds[i] = Maths::BoundingBox();
+				continue;
+			}
+
+			instance.worldToLocal = Maths::Matrix3x4(worldMatrix).Inverse();
+			instance.normalMatrix = instance.worldToLocal.ToMatrix3().Transpose();
+			m_Bounds[i] = instance.mesh->GetBoundingBox()->Transformed(worldMatrix);
+		}
+
+		if (m_Dirty)
+			m_BVH.Build(m_Bounds.data(), static_cast<u32>(m_Bounds.size()), 2);
+		else
+			m_BVH.Refit(m_Bounds.data());
+
+		m_Dirty = false;
+		m_Moved = false;
+	}
+
+	float SceneRaycast::IntersectInstance(const Instance& instance, const Maths::Ray& ray, float maxDistance, Maths::Vector3* normal) const
+	{
+		if (!instance.mesh || !instance.mesh->GetActive())
+			return Maths::M_INFINITY;
+
+		// The local direction keeps the transform's scale, so distances along it match world distances
+		const Maths::Ray localRay = ray.Transformed(instance.worldToLocal);
+
+		auto& bvh = instance.mesh->GetBVH();
+		if (!bvh)
+		{
+			const float distance = localRay.HitDistance(*instance.mesh->GetBoundingBox());
+			if (distance >= maxDistance)
+				return Maths::M_INFINITY;
+
+			if (normal)
+				*normal = -ray.direction_;
+			return distance;
+		}
+
+		if (!normal)
+			return bvh->AnyHit(localRay, maxDistance) ? 0.0f : Maths::M_INFINITY;
+
+		Maths::RayHit hit;
+		if (!bvh->Raycast(localRay, hit, maxDistance))
+			return Maths::M_INFINITY;
+
+		*normal = (instance.normalMatrix * hit.normal).Normalized();
+		return hit.distance;
+	}
+
+	bool SceneRaycast::Raycast(const Maths::Ray& ray, RaycastHit& hit, float maxDistance)
+	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		Update();
+
+		hit = RaycastHit();
+		float closest = maxDistance;
+		const auto& indices = m_BVH.GetIndices();
+
+		m_BVH.Traverse(ray, closest, [&](u32 first, u32 count, float& maxDist)
+		{
+			for (u32 i = first; i < first + count; i++)
+			{
+				const auto& instance = m_Instances[indices[i]];
+
+				Maths::Vector3 normal;
+				const float distance = IntersectInstance(instance, ray, maxDist, &normal);
+				if (distance < maxDist)
+				{
+					maxDist = distance;
+					hit.entity = instance.entity;
+					hit.distance = distance;
+					hit.normal = normal;
+				}
+			}
+			return false;
+		});
+
+		if (hit.Hit())
+			hit.position = ray.origin_ + ray.direction_ * hit.distance;
+
+		m_LastQueryTime = timer.GetMS(1000.0f);
+		return hit.Hit();
+	}
+
+	bool SceneRaycast::AnyHit(const Maths::Ray& ray, float maxDistance)
+	{
+		LUMOS_PROFILE_FUNC;
+
+		Update();
+
+		bool found = false;
+		const auto& indices = m_BVH.GetIndices();
+
+		m_BVH.Traverse(ray, maxDistance, [&](u32 first, u32 count, float& maxDist)
+		{
+			for (u32 i = first; i < first + count; i++)
+			{
+				if (IntersectInstance(m_Instances[indices[i]], ray, maxDist, nullptr) < maxDist)
+				{
+					found = true;
+					return true;
+				}
+			}
+			return false;
+		});
+
+		return found;
+	}
+
+	void SceneRaycast::Raycast(const Maths::Ray* rays, u32 count, RaycastHit* hits, float maxDistance)
+	{
+		LUMOS_PROFILE_FUNC;
+
+		Update();
+
+		for (u32 i = 0; i < count; i++)
+			Raycast(rays[i], hits[i], maxDistance);
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "lmpch.h"
+#include "Maths/BVH.h"
+#include "Maths/Matrix3.h"
+
+#include <entt/entt.hpp>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class Mesh;
+	}
+
+	struct RaycastHit
+	{
+		entt::entity entity = entt::null;
+		float distance = Maths::M_INFINITY;
+		Maths::Vector3 position;
+		Maths::Vector3 normal;
+
+		bool Hit() const { return entity != entt::null; }
+	};
+
+	// Ray queries against every MeshComponent in a registry. A top level BVH over the mesh
+	// instances' world bounds is rebuilt when meshes are added or removed and refit when they
+	// move, then each candidate is tested against its mesh's triangle BVH in local space.
+	// Meshes without a triangle BVH are hit on their bounding box.
+	// One instance lives in each registry's context, see SceneRaycast::Get.
+	class LUMOS_EXPORT SceneRaycast
+	{
+	public:
+		SceneRaycast() = default;
+		~SceneRaycast() = default;
+
+		void Init(entt::registry& registry);
+
+		// Closest hit within maxDistance of a ray with a normalised direction
+		bool Raycast(const Maths::Ray& ray, RaycastHit& hit, float maxDistance = Maths::M_INFINITY);
+		// Whether anything is hit within maxDistance, stops at the first hit found
+		bool AnyHit(const Maths::Ray& ray, float maxDistance = Maths::M_INFINITY);
+		// Closest hits for a batch of rays, the scene is brought up to date once for all of them
+		void Raycast(const Maths::Ray* rays, u32 count, RaycastHit* hits, float maxDistance = Maths::M_INFINITY);
+
+		// Meshes were added, removed or swapped, the top level tree is rebuilt on the next query
+		void MarkDirty() { m_Dirty = true; }
+		// Transforms may have changed, the top level tree is refit on the next query
+		void MarkMoved() { m_Moved = true; }
+
+		u32 GetInstanceCount() const { return static_cast<u32>(m_Instances.size()); }
+		float GetLastQueryTime() const { return m_LastQueryTime; }
+
+		static SceneRaycast* Get(entt::registry& registry) { return registry.try_ctx<SceneRaycast>(); }
+
+	private:
+		struct Instance
+		{
+			entt::entity entity;
+			Graphics::Mesh* mesh;
+			Maths::Matrix3x4 worldToLocal;
+			Maths::Matrix3 normalMatrix;
+		};
+
+		void OnMeshesChanged(entt::registry& registry, entt::entity entity);
+
+		void Update();
+		float IntersectInstance(const Instance& instance, const Maths::Ray& ray, float maxDistance, Maths::Vector3* normal) const;
+
+		entt::registry* m_Registry = nullptr;
+		Maths::BVH m_BVH;
+		std::vector<Instance> m_Instances;
+		std::vector<Maths::BoundingBox> m_Bounds;
+		bool m_Dirty = true;
+		bool m_Moved = true;
+		float m_LastQueryTime = 0.0f;
+	};
+}
@@ -0,0 +1,952 @@
+#include "lmpch.h"
+#include "SceneSnapshot.h"
+#include "Scene.h"
+#include "SceneGraph.h"
+#include "ECS/Component/Components.h"
+#include "Scripting/ScriptComponent.h"
+#include "Graphics/Light.h"
+#include "Graphics/Sprite.h"
+#include "Graphics/Camera/Camera.h"
+#include "Graphics/ModelLoader/ModelLoader.h"
+#include "Physics/LumosPhysicsEngine/SphereCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/CuboidCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/PyramidCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/CapsuleCollisionShape.h"
+#include "Maths/Transform.h"
+#include "Core/OS/FileSystem.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <Box2D/Box2D.h>
+
+#define SNAPSHOT_CHUNK(a, b, c, d) (u32(a) | (u32(b) << 8) | (u32(c) << 16) | (u32(d) << 24))
+#define SNAPSHOT_MAGIC SNAPSHOT_CHUNK('L', 'M', 'S', 'S')
+#define SNAPSHOT_VERSION 1
+
+namespace Lumos
+{
+	static const u32 CHUNK_ENTITIES		= SNAPSHOT_CHUNK('E', 'N', 'T', 'S');
+	static const u32 CHUNK_TRANSFORM	= SNAPSHOT_CHUNK('T', 'R', 'N', 'S');
+	static const u32 CHUNK_HIERARCHY	= SNAPSHOT_CHUNK('H', 'I', 'E', 'R');
+	static const u32 CHUNK_NAME			= SNAPSHOT_CHUNK('N', 'A', 'M', 'E');
+	static const u32 CHUNK_TAG			= SNAPSHOT_CHUNK('T', 'A', 'G', ' ');
+	static const u32 CHUNK_ACTIVE		= SNAPSHOT_CHUNK('A', 'C', 'T', 'V');
+	static const u32 CHUNK_MESH_ASSETS	= SNAPSHOT_CHUNK('M', 'S', 'H', 'A');
+	static const u32 CHUNK_MESH			= SNAPSHOT_CHUNK('M', 'E', 'S', 'H');
+	static const u32 CHUNK_MATERIAL		= SNAPSHOT_CHUNK('M', 'A', 'T', 'L');
+	static const u32 CHUNK_LIGHT		= SNAPSHOT_CHUNK('L', 'G', 'H', 'T');
+	static const u32 CHUNK_CAMERA		= SNAPSHOT_CHUNK('C', 'A', 'M', 'R');
+	static const u32 CHUNK_PHYSICS3D	= SNAPSHOT_CHUNK('P', 'H', '3', 'D');
+	static const u32 CHUNK_SCRIPT		= SNAPSHOT_CHUNK('S', 'C', 'R', 'P');
+
+	static const u32 NO_ASSET = ~0u;
+
+	static bool IsKnownChunk(u32 id)
+	{
+		return id == CHUNK_ENTITIES || id == CHUNK_TRANSFORM || id == CHUNK_HIERARCHY || id == CHUNK_NAME || id == CHUNK_TAG
+			|| id == CHUNK_ACTIVE || id == CHUNK_MESH_ASSETS || id == CHUNK_MESH || id == CHUNK_MATERIAL || id == CHUNK_LIGHT
+			|| id == CHUNK_CAMERA || id == CHUNK_PHYSICS3D || id == CHUNK_SCRIPT;
+	}
+
+	struct SnapshotHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 chunkCount;
+		u32 entityCount;
+	};
+
+	// size is the number of bytes following the header, so unknown chunks can be skipped
+	struct ChunkHeader
+	{
+		u32 id;
+		u32 version;
+		u32 count;
+		u32 size;
+	};
+
+	struct TransformRecord
+	{
+		Maths::Vector3 position;
+		Maths::Vector3 scale;
+		Maths::Quaternion orientation;
+	};
+
+	struct HierarchyRecord
+	{
+		entt::entity parent;
+		entt::entity first;
+		entt::entity next;
+		entt::entity prev;
+	};
+
+	struct MeshAssetRecord
+	{
+		u32 pathLength;
+		u32 subMeshIndex;
+		u8 isPrimitive;
+		u8 primitiveType;
+		u8 padding[2];
+	};
+
+	struct MaterialRecord
+	{
+		u32 asset;
+		// Mesh asset of the same entity, materials loaded from a file are taken from the mesh's model
+		u32 meshAsset;
+	};
+
+	struct CameraRecord
+	{
+		float pitch, yaw, roll;
+		Maths::Vector3 position;
+		float aspectRatio, scale;
+		float fov, nearPlane, farPlane;
+		u32 orthographic;
+		u32 controller;
+	};
+
+	struct Physics3DRecord
+	{
+		Maths::Vector3 position;
+		Maths::Quaternion orientation;
+		Maths::Vector3 linearVelocity;
+		Maths::Vector3 angularVelocity;
+		Maths::Vector3 force;
+		Maths::Vector3 torque;
+		Maths::Matrix3 inverseInertia;
+		float inverseMass;
+		float elasticity;
+		float friction;
+		u8 isStatic;
+		u8 atRest;
+		u8 shapeType;
+		u8 padding;
+		// Half dimensions for boxes and pyramids, radius (and height) for spheres and capsules
+		Maths::Vector3 shapeSize;
+		u32 object;
+	};
+
+	struct ScriptRecord
+	{
+		u32 pathLength;
+		u32 updateRate;
+	};
+
+	struct Physics2DState
+	{
+		Maths::Vector2 position;
+		float angle;
+		Maths::Vector2 linearVelocity;
+		float angularVelocity;
+	};
+
+	static_assert(std::is_trivially_copyable<Graphics::Light>::value, "Lights are saved as raw bytes");
+
+	class SnapshotWriter
+	{
+	public:
+		explicit SnapshotWriter(std::vector<u8>& data) : m_Data(data) {}
+
+		void WriteBytes(const void* bytes, size_t size)
+		{
+			const size_t offset = m_Data.size();
+			m_Data.resize(offset + size);
+			if (size > 0)
+				memcpy(m_Data.data() + offset, bytes, size);
+		}
+
+		template<typename T>
+		void Write(const T& value) { WriteBytes(&value, sizeof(T)); }
+
+		template<typename T>
+		void WriteArray(const T* values, size_t count) { WriteBytes(values, sizeof(T) * count); }
+
+		void BeginChunk(u32 id, u32 version, u32 count)
+		{
+			m_ChunkStart = m_Data.size();
+			Write(ChunkHeader{ id, version, count, 0 });
+		}
+
+		void EndChunk()
+		{
+			const u32 size = static_cast<u32>(m_Data.size() - m_ChunkStart - sizeof(ChunkHeader));
+			memcpy(m_Data.data() + m_ChunkStart + offsetof(ChunkHeader, size), &size, sizeof(u32));
+			m_ChunkCount++;
+		}
+
+		u32 GetChunkCount() const { return m_ChunkCount; }
+
+	private:
+		std::vector<u8>& m_Data;
+		size_t m_ChunkStart = 0;
+		u32 m_ChunkCount = 0;
+	};
+
+	class SnapshotReader
+	{
+	public:
+		SnapshotReader(const u8* data, size_t size) : m_Data(data), m_Size(size) {}
+
+		bool ReadBytes(void* bytes, size_t size)
+		{
+			if (m_Offset + size > m_Size)
+				return false;
+
+			if (size > 0)
+				memcpy(bytes, m_Data + m_Offset, size);
+			m_Offset += size;
+			return true;
+		}
+
+		template<typename T>
+		bool Read(T& value) { return ReadBytes(&value, sizeof(T)); }
+
+		template<typename T>
+		bool ReadArray(std::vector<T>& values, size_t count)
+		{
+			values.resize(count);
+			return ReadBytes(values.data(), sizeof(T) * count);
+		}
+
+		bool Skip(size_t size)
+		{
+			if (m_Offset + size > m_Size)
+				return false;
+
+			m_Offset += size;
+			return true;
+		}
+
+		const char* GetCurrent() const { return reinterpret_cast<const char*>(m_Data + m_Offset); }
+		size_t GetOffset() const { return m_Offset; }
+
+	private:
+		const u8* m_Data;
+		size_t m_Size;
+		size_t m_Offset = 0;
+	};
+
+	// Components kept by value for in-session restores only
+	struct ComponentCopiesBase
+	{
+		virtual ~ComponentCopiesBase() = default;
+		virtual void Restore(entt::registry& registry) const = 0;
+	};
+
+	template<typename T>
+	struct ComponentCopies : public ComponentCopiesBase
+	{
+		std::vector<entt::entity> entities;
+		std::vector<T> components;
+
+		void Capture(entt::registry& registry)
+		{
+			auto view = registry.view<T>();
+			entities.assign(view.data(), view.data() + view.size());
+			components.assign(view.raw(), view.raw() + view.size());
+		}
+
+		void Restore(entt::registry& registry) const override
+		{
+			if (!entities.empty())
+				registry.insert<T>(entities.begin(), entities.end(), components.begin(), components.end());
+		}
+	};
+
+	struct SceneSnapshot::LiveAssets
+	{
+		std::vector<MeshComponent> meshes;
+		std::vector<Ref<Material>> materials;
+		std::vector<Ref<CameraController>> cameraControllers;
+		std::vector<Ref<PhysicsObject3D>> physics3D;
+		std::vector<Physics2DState> physics2DStates;
+		ComponentCopies<Physics2DComponent> physics2D;
+		std::vector<Scope<ComponentCopiesBase>> copies;
+
+		template<typename T>
+		void Copy(entt::registry& registry)
+		{
+			if (registry.view<T>().empty())
+				return;
+
+			auto components = CreateScope<ComponentCopies<T>>();
+			components->Capture(registry);
+			copies.emplace_back(std::move(components));
+		}
+	};
+
+	// Strings are written as a length per record followed by all the characters
+	template<typename Component, typename GetString>
+	static void WriteStrings(entt::registry& registry, SnapshotWriter& writer, u32 id, GetString getString)
+	{
+		auto view = registry.view<Component>();
+		if (view.empty())
+			return;
+
+		const u32 count = static_cast<u32>(view.size());
+		std::vector<u32> lengths(count);
+		for (u32 i = 0; i < count; i++)
+			lengths[i] = static_cast<u32>(getString(view.raw()[i]).size());
+
+		writer.BeginChunk(id, 1, count);
+		writer.WriteArray(view.data(), count);
+		writer.WriteArray(lengths.data(), count);
+		for (u32 i = 0; i < count; i++)
+			writer.WriteBytes(getString(view.raw()[i]).data(), lengths[i]);
+		writer.EndChunk();
+	}
+
+	static bool ReadStrings(SnapshotReader& reader, u32 count, std::vector<String>& strings)
+	{
+		std::vector<u32> lengths;
+		if (!reader.ReadArray(lengths, count))
+			return false;
+
+		strings.resize(count);
+		for (u32 i = 0; i < count; i++)
+		{
+			const char* chars = reader.GetCurrent();
+			if (!reader.Skip(lengths[i]))
+				return false;
+			strings[i].assign(chars, lengths[i]);
+		}
+
+		return true;
+	}
+
+	static Ref<CollisionShape> CreateCollisionShape(u32 type, const Maths::Vector3& size)
+	{
+		switch (type)
+		{
+		case CollisionCuboid	: return CreateRef<CuboidCollisionShape>(size);
+		case CollisionSphere	: return CreateRef<SphereCollisionShape>(size.x);
+		case CollisionPyramid	: return CreateRef<PyramidCollisionShape>(size);
+		case CollisionCapsule	: return CreateRef<CapsuleCollisionShape>(size.x, size.y);
+		default					: return nullptr;
+		}
+	}
+
+	static Maths::Vector3 GetCollisionShapeSize(const CollisionShape* shape)
+	{
+		switch (shape->GetType())
+		{
+		case CollisionCuboid	:
+		{
+			auto cuboid = static_cast<const CuboidCollisionShape*>(shape);
+			return Maths::Vector3(cuboid->GetHalfWidth(), cuboid->GetHalfHeight(), cuboid->GetHalfDepth());
+		}
+		case CollisionPyramid	:
+		{
+			auto pyramid = static_cast<const PyramidCollisionShape*>(shape);
+			return Maths::Vector3(pyramid->GetHalfWidth(), pyramid->GetHalfHeight(), pyramid->GetHalfDepth());
+		}
+		case CollisionSphere	: return Maths::Vector3(static_cast<const SphereCollisionShape*>(shape)->GetRadius(), 0.0f, 0.0f);
+		case CollisionCapsule	:
+		{
+			auto capsule = static_cast<const CapsuleCollisionShape*>(shape);
+			return Maths::Vector3(capsule->GetRadius(), capsule->GetHeight(), 0.0f);
+		}
+		default					: return Maths::Vector3(0.0f);
+		}
+	}
+
+	SceneSnapshot::SceneSnapshot() = default;
+	SceneSnapshot::~SceneSnapshot() = default;
+
+	void SceneSnapshot::Clear()
+	{
+		m_Data.clear();
+		m_Data.shrink_to_fit();
+		m_Assets.reset();
+		m_EntityCount = 0;
+	}
+
+	void SceneSnapshot::Capture(entt::registry& registry)
+	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		Clear();
+		m_Assets = CreateScope<LiveAssets>();
+		m_EntityCount = static_cast<u32>(registry.alive());
+
+		SnapshotWriter writer(m_Data);
+		writer.Write(SnapshotHeader{ SNAPSHOT_MAGIC, SNAPSHOT_VERSION, 0, m_EntityCount });
+
+		// entt's own entity array, destroyed slots included, so ids and versions survive a restore
+		writer.BeginChunk(CHUNK_ENTITIES, 1, static_cast<u32>(registry.size()));
+		writer.WriteArray(registry.data(), registry.size());
+		writer.EndChunk();
+
+		{
+			auto view = registry.view<Maths::Transform>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<TransformRecord> records(count);
+			for (u32 i = 0; i < count; i++)
+			{
+				const auto& transform = view.raw()[i];
+				records[i] = { transform.GetLocalPosition(), transform.GetLocalScale(), transform.GetLocalOrientation() };
+			}
+
+			writer.BeginChunk(CHUNK_TRANSFORM, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			writer.EndChunk();
+		}
+
+		{
+			auto view = registry.view<Hierarchy>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<HierarchyRecord> records(count);
+			for (u32 i = 0; i < count; i++)
+			{
+				const auto& hierarchy = view.raw()[i];
+				records[i] = { hierarchy.parent(), hierarchy.first(), hierarchy.next(), hierarchy.prev() };
+			}
+
+			writer.BeginChunk(CHUNK_HIERARCHY, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			writer.EndChunk();
+		}
+
+		WriteStrings<NameComponent>(registry, writer, CHUNK_NAME, [](const NameComponent& name) -> const String& { return name.name; });
+		WriteStrings<TagComponent>(registry, writer, CHUNK_TAG, [](const TagComponent& tag) -> const String& { return tag.tag; });
+
+		{
+			auto view = registry.view<ActiveComponent>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<u8> records(count);
+			for (u32 i = 0; i < count; i++)
+				records[i] = view.raw()[i].active ? 1 : 0;
+
+			writer.BeginChunk(CHUNK_ACTIVE, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			writer.EndChunk();
+		}
+
+		// Meshes are shared between entities, so they are written once and referenced by index
+		std::unordered_map<Graphics::Mesh*, u32> meshAssets;
+		{
+			auto view = registry.view<MeshComponent>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<u32> records(count);
+			for (u32 i = 0; i < count; i++)
+			{
+				const auto& mesh = view.raw()[i];
+				auto it = meshAssets.find(mesh.GetMesh());
+				if (it == meshAssets.end())
+				{
+					it = meshAssets.emplace(mesh.GetMesh(), static_cast<u32>(m_Assets->meshes.size())).first;
+					m_Assets->meshes.push_back(mesh);
+				}
+				records[i] = it->second;
+			}
+
+			writer.BeginChunk(CHUNK_MESH_ASSETS, 1, static_cast<u32>(m_Assets->meshes.size()));
+			for (auto& mesh : m_Assets->meshes)
+			{
+				MeshAssetRecord record = {};
+				record.pathLength = static_cast<u32>(mesh.GetFilePath().size());
+				record.subMeshIndex = mesh.GetSubMeshIndex();
+				record.isPrimitive = mesh.IsPrimitive() ? 1 : 0;
+				record.primitiveType = static_cast<u8>(mesh.GetPrimitiveType());
+				writer.Write(record);
+			}
+			for (auto& mesh : m_Assets->meshes)
+				writer.WriteBytes(mesh.GetFilePath().data(), mesh.GetFilePath().size());
+			writer.EndChunk();
+
+			writer.BeginChunk(CHUNK_MESH, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			writer.EndChunk();
+		}
+
+		{
+			auto view = registry.view<MaterialComponent>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<MaterialRecord> records(count);
+			std::unordered_map<Material*, u32> materialAssets;
+			for (u32 i = 0; i < count; i++)
+			{
+				const auto& material = view.raw()[i].GetMaterial();
+				auto it = materialAssets.find(material.get());
+				if (it == materialAssets.end())
+				{
+					it = materialAssets.emplace(material.get(), static_cast<u32>(m_Assets->materials.size())).first;
+					m_Assets->materials.push_back(material);
+				}
+
+				auto mesh = registry.try_get<MeshComponent>(view.data()[i]);
+				records[i] = { it->second, mesh ? meshAssets[mesh->GetMesh()] : NO_ASSET };
+			}
+
+			writer.BeginChunk(CHUNK_MATERIAL, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			writer.EndChunk();
+		}
+
+		{
+			auto view = registry.view<Graphics::Light>();
+			writer.BeginChunk(CHUNK_LIGHT, 1, static_cast<u32>(view.size()));
+			writer.WriteArray(view.data(), view.size());
+			writer.WriteArray(view.raw(), view.size());
+			writer.EndChunk();
+		}
+
+		{
+			auto view = registry.view<Camera>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<CameraRecord> records(count);
+			for (u32 i = 0; i < count; i++)
+			{
+				const auto& camera = view.raw()[i];
+				auto& record = records[i];
+				record.pitch = camera.GetPitch();
+				record.yaw = camera.GetYaw();
+				record.roll = camera.GetRoll();
+				record.position = camera.GetPosition();
+				record.aspectRatio = camera.GetAspectRatio();
+				record.scale = camera.GetScale();
+				record.fov = camera.GetFOV();
+				record.nearPlane = camera.GetNear();
+				record.farPlane = camera.GetFar();
+				record.orthographic = camera.IsOrthographic() ? 1 : 0;
+				record.controller = NO_ASSET;
+
+				if (camera.GetController())
+				{
+					record.controller = static_cast<u32>(m_Assets->cameraControllers.size());
+					m_Assets->cameraControllers.push_back(camera.GetController());
+				}
+			}
+
+			writer.BeginChunk(CHUNK_CAMERA, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			writer.EndChunk();
+		}
+
+		{
+			auto view = registry.view<Physics3DComponent>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<Physics3DRecord> records(count);
+			for (u32 i = 0; i < count; i++)
+			{
+				const auto& object = view.raw()[i].GetPhysicsObject();
+				auto& record = records[i];
+				record = {};
+				record.position = object->GetPosition();
+				record.orientation = object->GetOrientation();
+				record.linearVelocity = object->GetLinearVelocity();
+				record.angularVelocity = object->GetAngularVelocity();
+				record.force = object->GetForce();
+				record.torque = object->GetTorque();
+				record.inverseInertia = object->GetInverseInertia();
+				record.inverseMass = object->GetInverseMass();
+				record.elasticity = object->GetElasticity();
+				record.friction = object->GetFriction();
+				record.isStatic = object->GetIsStatic() ? 1 : 0;
+				record.atRest = object->GetIsAtRest() ? 1 : 0;
+				record.object = static_cast<u32>(m_Assets->physics3D.size());
+
+				if (object->GetCollisionShape())
+				{
+					record.shapeType = static_cast<u8>(object->GetCollisionShape()->GetType());
+					record.shapeSize = GetCollisionShapeSize(object->GetCollisionShape().get());
+				}
+
+				m_Assets->physics3D.push_back(object);
+			}
+
+			writer.BeginChunk(CHUNK_PHYSICS3D, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			writer.EndChunk();
+		}
+
+		{
+			auto view = registry.view<ScriptComponent>();
+			const u32 count = static_cast<u32>(view.size());
+			std::vector<ScriptRecord> records(count);
+			for (u32 i = 0; i < count; i++)
+				records[i] = { static_cast<u32>(view.raw()[i].GetFilePath().size()), static_cast<u32>(view.raw()[i].GetUpdateRate()) };
+
+			writer.BeginChunk(CHUNK_SCRIPT, 1, count);
+			writer.WriteArray(view.data(), count);
+			writer.WriteArray(records.data(), count);
+			for (u32 i = 0; i < count; i++)
+				writer.WriteBytes(view.raw()[i].GetFilePath().data(), records[i].pathLength);
+			writer.EndChunk();
+		}
+
+		// No binary form yet, these only come back in the same session
+		m_Assets->physics2D.Capture(registry);
+		m_Assets->physics2DStates.resize(m_Assets->physics2D.components.size());
+		for (size_t i = 0; i < m_Assets->physics2DStates.size(); i++)
+		{
+			auto object = m_Assets->physics2D.components[i].GetPhysicsObjectRaw();
+			const b2Vec2 velocity = object->GetB2Body()->GetLinearVelocity();
+			m_Assets->physics2DStates[i] = { object->GetPosition(), object->GetAngle(), Maths::Vector2(velocity.x, velocity.y), object->GetB2Body()->GetAngularVelocity() };
+		}
+
+		m_Assets->Copy<Graphics::Sprite>(registry);
+		m_Assets->Copy<SoundComponent>(registry);
+		m_Assets->Copy<TextureMatrixComponent>(registry);
+		m_Assets->Copy<AIComponent>(registry);
+		m_Assets->Copy<ParticleComponent>(registry);
+		m_Assets->Copy<TerrainComponent>(registry);
+		m_Assets->Copy<AnimatorComponent>(registry);
+		m_Assets->Copy<OccluderComponent>(registry);
+
+		const u32 chunkCount = writer.GetChunkCount();
+		memcpy(m_Data.data() + offsetof(SnapshotHeader, chunkCount), &chunkCount, sizeof(u32));
+
+		m_CaptureTime = timer.GetMS(1000.0f);
+	}
+
+	bool SceneSnapshot::Restore(entt::registry& registry, Scene* scene) const
+	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		SnapshotReader reader(m_Data.data(), m_Data.size());
+
+		SnapshotHeader header;
+		if (!reader.Read(header) || header.magic != SNAPSHOT_MAGIC || header.version > SNAPSHOT_VERSION)
+		{
+			LUMOS_LOG_ERROR("Invalid scene snapshot");
+			return false;
+		}
+
+		registry.clear();
+
+		std::vector<entt::entity> entities;
+		std::vector<MeshComponent> meshes;
+		std::vector<Ref<Material>> fileMaterials;
+
+		for (u32 chunk = 0; chunk < header.chunkCount; chunk++)
+		{
+			ChunkHeader chunkHeader;
+			if (!reader.Read(chunkHeader))
+				return false;
+
+			const size_t chunkEnd = reader.GetOffset() + chunkHeader.size;
+			const u32 count = chunkHeader.count;
+
+			// Chunks from a newer build are skipped whole, their layout is unknown
+			if (!IsKnownChunk(chunkHeader.id))
+			{
+				if (!reader.Skip(chunkHeader.size))
+					return false;
+				continue;
+			}
+
+			if (chunkHeader.id == CHUNK_ENTITIES)
+			{
+				if (!reader.ReadArray(entities, count))
+					return false;
+
+				registry.assign(entities.begin(), entities.end());
+				continue;
+			}
+
+			// Every other chunk starts with the entities it belongs to
+			if (chunkHeader.id != CHUNK_MESH_ASSETS && !reader.ReadArray(entities, count))
+				return false;
+
+			if (chunkHeader.id == CHUNK_TRANSFORM)
+			{
+				std::vector<TransformRecord> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				std::vector<Maths::Transform> transforms(count);
+				for (u32 i = 0; i < count; i++)
+				{
+					auto& transform = transforms[i];
+					transform.SetLocalPosition(records[i].position);
+					transform.SetLocalScale(records[i].scale);
+					transform.SetLocalOrientation(records[i].orientation);
+					transform.SetWorldMatrix(Maths::Matrix4());
+				}
+
+				registry.insert<Maths::Transform>(entities.begin(), entities.end(), transforms.begin(), transforms.end());
+			}
+			else if (chunkHeader.id == CHUNK_HIERARCHY)
+			{
+				std::vector<HierarchyRecord> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				// Inserted unlinked so Hierarchy::on_construct leaves them alone, then the saved links are copied in
+				registry.insert<Hierarchy>(entities.begin(), entities.end());
+				for (u32 i = 0; i < count; i++)
+				{
+					auto& hierarchy = registry.get<Hierarchy>(entities[i]);
+					hierarchy._parent = records[i].parent;
+					hierarchy._first = records[i].first;
+					hierarchy._next = records[i].next;
+					hierarchy._prev = records[i].prev;
+				}
+			}
+			else if (chunkHeader.id == CHUNK_NAME || chunkHeader.id == CHUNK_TAG)
+			{
+				std::vector<String> strings;
+				if (!ReadStrings(reader, count, strings))
+					return false;
+
+				if (chunkHeader.id == CHUNK_NAME)
+				{
+					std::vector<NameComponent> names(count);
+					for (u32 i = 0; i < count; i++)
+						names[i].name = std::move(strings[i]);
+					registry.insert<NameComponent>(entities.begin(), entities.end(), names.begin(), names.end());
+				}
+				else
+				{
+					std::vector<TagComponent> tags(count);
+					for (u32 i = 0; i < count; i++)
+						tags[i].tag = std::move(strings[i]);
+					registry.insert<TagComponent>(entities.begin(), entities.end(), tags.begin(), tags.end());
+				}
+			}
+			else if (chunkHeader.id == CHUNK_ACTIVE)
+			{
+				std::vector<u8> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				for (u32 i = 0; i < count; i++)
+					registry.emplace<ActiveComponent>(entities[i], records[i] != 0);
+			}
+			else if (chunkHeader.id == CHUNK_MESH_ASSETS)
+			{
+				std::vector<MeshAssetRecord> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				std::vector<String> paths(count);
+				for (u32 i = 0; i < count; i++)
+				{
+					const char* chars = reader.GetCurrent();
+					if (!reader.Skip(records[i].pathLength))
+						return false;
+					paths[i].assign(chars, records[i].pathLength);
+				}
+
+				if (m_Assets && m_Assets->meshes.size() == count)
+				{
+					meshes = m_Assets->meshes;
+					continue;
+				}
+
+				// Loaded from disk, primitives are regenerated and models loaded once per file
+				meshes.assign(count, MeshComponent());
+				fileMaterials.assign(count, nullptr);
+				std::unordered_map<String, entt::registry> models;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					if (records[i].isPrimitive)
+					{
+						meshes[i] = MeshComponent(static_cast<Graphics::PrimitiveType>(records[i].primitiveType));
+						continue;
+					}
+
+					if (paths[i].empty())
+						continue;
+
+					auto it = models.find(paths[i]);
+					if (it == models.end())
+					{
+						it = models.emplace(paths[i], entt::registry()).first;
+						ModelLoader::LoadModel(paths[i], it->second);
+					}
+
+					auto& model = it->second;
+					auto view = model.view<MeshComponent>();
+					for (auto entity : view)
+					{
+						const auto& mesh = view.get(entity);
+						if (mesh.GetSubMeshIndex() != records[i].subMeshIndex)
+							continue;
+
+						meshes[i] = mesh;
+						if (auto material = model.try_get<MaterialComponent>(entity))
+							fileMaterials[i] = material->GetMaterial();
+						break;
+					}
+				}
+			}
+			else if (chunkHeader.id == CHUNK_MESH)
+			{
+				std::vector<u32> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					if (records[i] < meshes.size() && meshes[records[i]].GetMesh())
+						registry.emplace<MeshComponent>(entities[i], meshes[records[i]]);
+				}
+			}
+			else if (chunkHeader.id == CHUNK_MATERIAL)
+			{
+				std::vector<MaterialRecord> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					Ref<Material> material;
+					if (m_Assets && records[i].asset < m_Assets->materials.size())
+						material = m_Assets->materials[records[i].asset];
+					else if (records[i].meshAsset < fileMaterials.size())
+						material = fileMaterials[records[i].meshAsset];
+
+					if (material)
+						registry.emplace<MaterialComponent>(entities[i], material);
+					else
+						registry.emplace<MaterialComponent>(entities[i]);
+				}
+			}
+			else if (chunkHeader.id == CHUNK_LIGHT)
+			{
+				std::vector<Graphics::Light> lights;
+				if (!reader.ReadArray(lights, count))
+					return false;
+
+				registry.insert<Graphics::Light>(entities.begin(), entities.end(), lights.begin(), lights.end());
+			}
+			else if (chunkHeader.id == CHUNK_CAMERA)
+			{
+				std::vector<CameraRecord> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					const auto& record = records[i];
+					auto& camera = registry.emplace<Camera>(entities[i], record.pitch, record.yaw, record.position, record.fov, record.nearPlane, record.farPlane, record.aspectRatio);
+					camera.SetRoll(record.roll);
+					camera.SetScale(record.scale);
+					camera.SetIsOrthographic(record.orthographic != 0);
+
+					if (m_Assets && record.controller < m_Assets->cameraControllers.size())
+						camera.SetCameraController(m_Assets->cameraControllers[record.controller]);
+				}
+			}
+			else if (chunkHeader.id == CHUNK_PHYSICS3D)
+			{
+				std::vector<Physics3DRecord> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					const auto& record = records[i];
+
+					// The live object keeps its collision callbacks, one from disk gets a new shape
+					Ref<PhysicsObject3D> object;
+					if (m_Assets && record.object < m_Assets->physics3D.size())
+						object = m_Assets->physics3D[record.object];
+					else
+					{
+						object = CreateRef<PhysicsObject3D>();
+						object->SetCollisionShape(CreateCollisionShape(record.shapeType, record.shapeSize));
+					}
+
+					object->SetIsStatic(false);
+					object->SetPosition(record.position);
+					object->SetOrientation(record.orientation);
+					object->SetLinearVelocity(record.linearVelocity);
+					object->SetAngularVelocity(record.angularVelocity);
+					object->SetForce(record.force);
+					object->SetTorque(record.torque);
+					object->SetInverseInertia(record.inverseInertia);
+					object->SetInverseMass(record.inverseMass);
+					object->SetElasticity(record.elasticity);
+					object->SetFriction(record.friction);
+					object->SetIsStatic(record.isStatic != 0);
+					object->SetIsAtRest(record.atRest != 0);
+
+					registry.emplace<Physics3DComponent>(entities[i], object);
+				}
+			}
+			else if (chunkHeader.id == CHUNK_SCRIPT)
+			{
+				std::vector<ScriptRecord> records;
+				if (!reader.ReadArray(records, count))
+					return false;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					const char* chars = reader.GetCurrent();
+					if (!reader.Skip(records[i].pathLength))
+						return false;
+
+					auto& script = registry.emplace<ScriptComponent>(entities[i], String(chars, records[i].pathLength), scene);
+					script.SetUpdateRate(static_cast<ScriptUpdateRate>(records[i].updateRate));
+				}
+			}
+
+			// Skips anything a newer chunk version appended
+			if (reader.GetOffset() > chunkEnd || !reader.Skip(chunkEnd - reader.GetOffset()))
+				return false;
+		}
+
+		if (m_Assets)
+		{
+			m_Assets->physics2D.Restore(registry);
+			for (size_t i = 0; i < m_Assets->physics2DStates.size(); i++)
+			{
+				auto object = m_Assets->physics2D.components[i].GetPhysicsObjectRaw();
+				const auto& state = m_Assets->physics2DStates[i];
+				object->SetPosition(state.position);
+				object->SetOrientation(state.angle);
+				object->SetLinearVelocity(state.linearVelocity);
+				object->SetAngularVelocity(state.angularVelocity);
+			}
+
+			for (auto& copies : m_Assets->copies)
+				copies->Restore(registry);
+		}
+
+		m_RestoreTime = timer.GetMS(1000.0f);
+		return true;
+	}
+
+	bool SceneSnapshot::Save(const String& filePath) const
+	{
+		if (m_Data.empty())
+			return false;
+
+		return FileSystem::WriteFile(filePath, const_cast<u8*>(m_Data.data()), static_cast<u32>(m_Data.size()));
+	}
+
+	bool SceneSnapshot::Load(const String& filePath)
+	{
+		Clear();
+
+		const i64 size = FileSystem::GetFileSize(filePath);
+		if (size < i64(sizeof(SnapshotHeader)))
+			return false;
+
+		m_Data.resize(static_cast<size_t>(size));
+		SnapshotHeader header;
+		if (!FileSystem::ReadFile(filePath, m_Data.data(), size) || !SnapshotReader(m_Data.data(), m_Data.size()).Read(header) || header.magic != SNAPSHOT_MAGIC)
+		{
+			LUMOS_LOG_ERROR("Failed to load scene snapshot {0}", filePath);
+			Clear();
+			return false;
+		}
+
+		m_EntityCount = header.entityCount;
+		return true;
+	}
+}
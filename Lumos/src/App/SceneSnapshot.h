@@ -0,0 +1,57 @@
+#pragma once
+#include "lmpch.h"
+
+#include <entt/entt.hpp>
+
+namespace Lumos
+{
+	class Scene;
+	class MeshComponent;
+	class MaterialComponent;
+	class PhysicsObject3D;
+	class PhysicsObject2D;
+	class CameraController;
+
+	// Versioned binary copy of a registry. The entity array is stored as entt keeps it, so
+	// restoring keeps every entity id and version, and each component type is written as one
+	// chunk of entities followed by tightly packed records.
+	//
+	// Chunks saved to disk : entities, Transform, Hierarchy, NameComponent, TagComponent,
+	// ActiveComponent, MeshComponent (by source file / primitive), MaterialComponent,
+	// Graphics::Light, Camera, Physics3DComponent and ScriptComponent (by file path).
+	// A snapshot taken with Capture also keeps references to the live assets, physics objects
+	// and the components that have no binary form (sprites, sounds, 2D physics ...), so
+	// restoring it in the same session is exact and does not touch the disk or the GPU.
+	class LUMOS_EXPORT SceneSnapshot
+	{
+	public:
+		SceneSnapshot();
+		~SceneSnapshot();
+
+		void Capture(entt::registry& registry);
+
+		// Replaces everything in the registry with the snapshot. Scripts are reloaded and bound to scene.
+		// Not safe while the registry is being iterated, see Scene::ResetLevel for a deferred restore.
+		bool Restore(entt::registry& registry, Scene* scene = nullptr) const;
+
+		bool Save(const String& filePath) const;
+		bool Load(const String& filePath);
+
+		void Clear();
+		bool Empty() const { return m_Data.empty(); }
+
+		u32 GetEntityCount() const { return m_EntityCount; }
+		size_t GetSize() const { return m_Data.size(); }
+		float GetCaptureTime() const { return m_CaptureTime; }
+		float GetRestoreTime() const { return m_RestoreTime; }
+
+	private:
+		struct LiveAssets;
+
+		std::vector<u8> m_Data;
+		Scope<LiveAssets> m_Assets;
+		u32 m_EntityCount = 0;
+		float m_CaptureTime = 0.0f;
+		mutable float m_RestoreTime = 0.0f;
+	};
+}
@@ -1,18 +1,45 @@
 #include "lmpch.h"
 #include "AudioManager.h"
+#include "MixerAudioManager.h"
+#include "ECS/Component/SoundComponent.h"
+#include "Graphics/Camera/Camera.h"
 
 #ifdef LUMOS_OPENAL
 #include "Platform/OpenAL/ALManager.h"
+#include "Platform/OpenAL/ALAudioOutput.h"
 #endif
 
+#define AUDIO_CAPTURE_FILE "AudioCapture.wav"
+
 namespace Lumos
 {
-    AudioManager* AudioManager::Create()
+    AudioManager* AudioManager::Create(AudioBackend backend)
     {
+        switch (backend)
+        {
         #ifdef LUMOS_OPENAL
-        return lmnew Audio::ALManager();
-        #else
-        return nullptr;
+        case AudioBackend::Default:
+        case AudioBackend::OpenAL:
+            if (Audio::ALManager::IsDeviceAvailable())
+                return lmnew Audio::ALManager();
+
+            LUMOS_LOG_WARN("No OpenAL device available, falling back to the software mixer");
+            break;
+        case AudioBackend::MixerOpenAL:
+            return lmnew Audio::MixerAudioManager(lmnew ALAudioOutput());
         #endif
+        case AudioBackend::MixerWavFile:
+            return lmnew Audio::MixerAudioManager(lmnew WavFileAudioOutput(AUDIO_CAPTURE_FILE));
+        default:
+            break;
+        }
+
+        return lmnew Audio::MixerAudioManager(lmnew NullAudioOutput());
+    }
+
+    void AudioManager::DeclareAccess(SystemAccess& access)
+    {
+        // The listener is a camera, sound nodes are owned through SoundComponents
+        access.Read<Camera>().Write<SoundComponent>().Write<AudioManager>();
     }
 }
\ No newline at end of file
@@ -1,30 +1,50 @@
 #pragma once
 #include "lmpch.h"
 #include "ECS/ISystem.h"
+#include "AudioStream.h"
 
 namespace Lumos
 {
 	class Camera;
+	class Sound;
 	class SoundNode;
 
+	enum class AudioBackend : int
+	{
+		Default = 0,	// OpenAL when a device opens, otherwise the mixer with no output
+		OpenAL,
+		MixerOpenAL,
+		MixerNull,
+		MixerWavFile
+	};
+
     class LUMOS_EXPORT AudioManager : public ISystem
     {
     public:
-        static AudioManager* Create();
+        static AudioManager* Create(AudioBackend backend = AudioBackend::Default);
 
         virtual ~AudioManager() = default;
         virtual void OnInit() override = 0;
         virtual void OnUpdate(const TimeStep& dt, Scene* scene) override = 0;
 
+		virtual Sound* CreateSound(const String& name, const String& extension) = 0;
+		virtual SoundNode* CreateSoundNode() = 0;
+
 		virtual void SetListener(Camera* camera) { m_Listener = camera; }
 		Camera* GetListener() const { return m_Listener; }
 
 		void AddSoundNode(SoundNode* node) { m_SoundNodes.emplace_back(node); }
+		void RemoveSoundNode(SoundNode* node) { m_SoundNodes.erase(std::remove(m_SoundNodes.begin(), m_SoundNodes.end(), node), m_SoundNodes.end()); }
 		void OnDebugDraw() override {};
+		void DeclareAccess(SystemAccess& access) override;
 
 		void ClearNodes() { m_SoundNodes.clear(); }
+
+		AudioStreamer& GetStreamer() { return m_Streamer; }
+
 	protected:
 		Camera*	m_Listener;
 		std::vector<SoundNode*> m_SoundNodes;
+		AudioStreamer m_Streamer;
 	};
 }
@@ -0,0 +1,345 @@
+#include "lmpch.h"
+#include "AudioMixer.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+#include "Maths/Maths.h"
+
+#include <imgui/imgui.h>
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Lumos
+{
+	static const u32 BLOCK_SAMPLES = AUDIO_MIX_BLOCK_FRAMES * AUDIO_MIX_CHANNELS;
+
+	void LowPassEffect::Process(float* samples, u32 frames, u32 sampleRate)
+	{
+		const float rc = 1.0f / (2.0f * Maths::M_PI * Maths::Max(Cutoff, 1.0f));
+		const float dt = 1.0f / float(sampleRate);
+		const float alpha = dt / (rc + dt);
+
+		for (u32 i = 0; i < frames; i++)
+		{
+			for (u32 c = 0; c < AUDIO_MIX_CHANNELS; c++)
+			{
+				float& sample = samples[i * AUDIO_MIX_CHANNELS + c];
+				m_History[c] += alpha * (sample - m_History[c]);
+				sample = m_History[c];
+			}
+		}
+	}
+
+	void LimiterEffect::Process(float* samples, u32 frames, u32)
+	{
+		// x / (1 + |x|) above the knee, continuous with the untouched range below it
+		const float knee = 0.5f;
+		for (u32 i = 0; i < frames * AUDIO_MIX_CHANNELS; i++)
+		{
+			const float value = samples[i];
+			const float magnitude = fabsf(value);
+			if (magnitude > knee)
+			{
+				const float over = (magnitude - knee) / (1.0f - knee);
+				samples[i] = std::copysign(knee + (1.0f - knee) * over / (1.0f + over), value);
+			}
+		}
+	}
+
+	// Resamples count frames with linear interpolation and adds them to the stereo output with
+	// ramped gains. Every frame read must have a following source frame, the caller splits
+	// blocks at the end of the source to guarantee it.
+	template<u32 Channels>
+	static void MixFrames(const float* source, u32 lastFrame, double& position, double step, float* out, u32 count, float* gain, const float* gainStep)
+	{
+		u32 i = 0;
+
+#ifdef LUMOS_SSE
+		const __m128 rampV = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		for (; i + 4 <= count; i += 4)
+		{
+			alignas(16) float a[Channels][4];
+			alignas(16) float b[Channels][4];
+			alignas(16) float fraction[4];
+
+			for (u32 lane = 0; lane < 4; lane++)
+			{
+				const double framePosition = position + step * lane;
+				const u32 index = Maths::Min(static_cast<u32>(framePosition), lastFrame - 1);
+				fraction[lane] = static_cast<float>(framePosition - index);
+
+				for (u32 c = 0; c < Channels; c++)
+				{
+					a[c][lane] = source[index * Channels + c];
+					b[c][lane] = source[(index + 1) * Channels + c];
+				}
+			}
+
+			const __m128 fractionV = _mm_load_ps(fraction);
+			const __m128 gainL = _mm_add_ps(_mm_set1_ps(gain[0]), _mm_mul_ps(rampV, _mm_set1_ps(gainStep[0])));
+			const __m128 gainR = _mm_add_ps(_mm_set1_ps(gain[1]), _mm_mul_ps(rampV, _mm_set1_ps(gainStep[1])));
+
+			const __m128 aL = _mm_load_ps(a[0]);
+			const __m128 left = _mm_add_ps(aL, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(b[0]), aL), fractionV));
+			__m128 right = left;
+			if (Channels == 2)
+			{
+				const __m128 aR = _mm_load_ps(a[Channels - 1]);
+				right = _mm_add_ps(aR, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(b[Channels - 1]), aR), fractionV));
+			}
+
+			const __m128 mixedL = _mm_mul_ps(left, gainL);
+			const __m128 mixedR = _mm_mul_ps(right, gainR);
+
+			// L0 R0 L1 R1 | L2 R2 L3 R3
+			float* dest = out + i * AUDIO_MIX_CHANNELS;
+			_mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm_unpacklo_ps(mixedL, mixedR)));
+			_mm_storeu_ps(dest + 4, _mm_add_ps(_mm_loadu_ps(dest + 4), _mm_unpackhi_ps(mixedL, mixedR)));
+
+			position += step * 4.0;
+			gain[0] += gainStep[0] * 4.0f;
+			gain[1] += gainStep[1] * 4.0f;
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			const u32 index = Maths::Min(static_cast<u32>(position), lastFrame - 1);
+			const float fraction = static_cast<float>(position - index);
+
+			const float* a = source + index * Channels;
+			const float* b = a + Channels;
+			const float left = a[0] + (b[0] - a[0]) * fraction;
+			const float right = a[Channels - 1] + (b[Channels - 1] - a[Channels - 1]) * fraction;
+
+			out[i * AUDIO_MIX_CHANNELS] += left * gain[0];
+			out[i * AUDIO_MIX_CHANNELS + 1] += right * gain[1];
+
+			position += step;
+			gain[0] += gainStep[0];
+			gain[1] += gainStep[1];
+		}
+	}
+
+	AudioMixer::AudioMixer(u32 sampleRate)
+		: m_SampleRate(sampleRate)
+	{
+		AddBus("Master", 0);
+	}
+
+	AudioMixer::~AudioMixer()
+	{
+		for (auto& bus : m_Buses)
+		{
+			for (auto effect : bus.Effects)
+				delete effect;
+
+			delete[] bus.Samples;
+		}
+	}
+
+	u32 AudioMixer::AddBus(const String& name, u32 parent)
+	{
+		Bus bus;
+		bus.Name = name;
+		bus.Parent = m_Buses.empty() ? 0 : Maths::Min(parent, static_cast<u32>(m_Buses.size() - 1));
+		bus.Samples = lmnew float[BLOCK_SAMPLES];
+		memset(bus.Samples, 0, sizeof(float) * BLOCK_SAMPLES);
+
+		m_Buses.push_back(bus);
+		return static_cast<u32>(m_Buses.size() - 1);
+	}
+
+	void AudioMixer::AddEffect(u32 bus, AudioEffect* effect)
+	{
+		m_Buses[bus].Effects.push_back(effect);
+	}
+
+	void AudioMixer::BeginBlock()
+	{
+		for (auto& bus : m_Buses)
+			memset(bus.Samples, 0, sizeof(float) * BLOCK_SAMPLES);
+
+		m_MixedVoices = 0;
+	}
+
+	bool AudioMixer::MixVoice(MixerVoice& voice)
+	{
+		if (!voice.Samples || voice.FrameCount < 2)
+			return SkipVoice(voice);
+
+		float* out = m_Buses[voice.Bus < m_Buses.size() ? voice.Bus : 0].Samples;
+
+		float gainStep[AUDIO_MIX_CHANNELS];
+		for (u32 c = 0; c < AUDIO_MIX_CHANNELS; c++)
+			gainStep[c] = (voice.TargetGain[c] - voice.Gain[c]) / float(AUDIO_MIX_BLOCK_FRAMES);
+
+		// Interpolation reads one frame ahead, so the last frame only ever appears as that neighbour
+		const u32 lastFrame = voice.FrameCount - 1;
+		bool playing = true;
+		u32 written = 0;
+
+		while (written < AUDIO_MIX_BLOCK_FRAMES)
+		{
+			if (voice.Position >= lastFrame)
+			{
+				if (!voice.Looping)
+				{
+					playing = false;
+					break;
+				}
+
+				voice.Position = fmod(voice.Position, double(lastFrame));
+			}
+
+			const u32 available = static_cast<u32>(ceil((lastFrame - voice.Position) / voice.Step));
+			const u32 count = Maths::Max(1u, Maths::Min(available, AUDIO_MIX_BLOCK_FRAMES - written));
+
+			if (voice.Channels == 2)
+				MixFrames<2>(voice.Samples, lastFrame, voice.Position, voice.Step, out + written * AUDIO_MIX_CHANNELS, count, voice.Gain, gainStep);
+			else
+				MixFrames<1>(voice.Samples, lastFrame, voice.Position, voice.Step, out + written * AUDIO_MIX_CHANNELS, count, voice.Gain, gainStep);
+
+			written += count;
+		}
+
+		for (u32 c = 0; c < AUDIO_MIX_CHANNELS; c++)
+			voice.Gain[c] = voice.TargetGain[c];
+
+		m_MixedVoices++;
+		return playing;
+	}
+
+	bool AudioMixer::SkipVoice(MixerVoice& voice)
+	{
+		for (u32 c = 0; c < AUDIO_MIX_CHANNELS; c++)
+			voice.Gain[c] = voice.TargetGain[c];
+
+		voice.Position += voice.Step * AUDIO_MIX_BLOCK_FRAMES;
+
+		if (voice.FrameCount < 2)
+			return false;
+
+		const double lastFrame = voice.FrameCount - 1;
+		if (voice.Position < lastFrame)
+			return true;
+
+		if (!voice.Looping)
+			return false;
+
+		voice.Position = fmod(voice.Position, lastFrame);
+		return true;
+	}
+
+	const float* AudioMixer::EndBlock()
+	{
+		LUMOS_PROFILE_FUNC;
+
+		for (size_t i = m_Buses.size() - 1; i > 0; i--)
+		{
+			auto& bus = m_Buses[i];
+			for (auto effect : bus.Effects)
+			{
+				if (effect->Enabled)
+					effect->Process(bus.Samples, AUDIO_MIX_BLOCK_FRAMES, m_SampleRate);
+			}
+
+			float* parent = m_Buses[bus.Parent].Samples;
+			for (u32 s = 0; s < BLOCK_SAMPLES; s++)
+				parent[s] += bus.Samples[s] * bus.Volume;
+		}
+
+		auto& master = m_Buses[0];
+		for (u32 s = 0; s < BLOCK_SAMPLES; s++)
+			master.Samples[s] *= master.Volume;
+
+		for (auto effect : master.Effects)
+		{
+			if (effect->Enabled)
+				effect->Process(master.Samples, AUDIO_MIX_BLOCK_FRAMES, m_SampleRate);
+		}
+
+		return master.Samples;
+	}
+
+	void AudioMixer::OnImGui()
+	{
+		for (auto& bus : m_Buses)
+		{
+			ImGui::PushID(&bus);
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted(bus.Name.c_str());
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::SliderFloat("##Volume", &bus.Volume, 0.0f, 2.0f);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			for (auto effect : bus.Effects)
+			{
+				ImGui::PushID(effect);
+				ImGui::AlignTextToFramePadding();
+				ImGui::Text("  %s", effect->GetName());
+				ImGui::NextColumn();
+				ImGui::Checkbox("##Enabled", &effect->Enabled);
+				ImGui::NextColumn();
+				ImGui::PopID();
+			}
+
+			ImGui::PopID();
+		}
+	}
+
+	double AudioMixer::Benchmark(u32 voiceCount, u32 blockCount)
+	{
+		const u32 sourceFrames = 48000;
+		std::vector<float> mono(sourceFrames);
+		std::vector<float> stereo(sourceFrames * 2);
+
+		// Fixed seed so every run mixes exactly the same data
+		u32 seed = 0x12345678;
+		auto next = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return float(seed >> 8) / float(1 << 24) * 2.0f - 1.0f;
+		};
+
+		for (auto& sample : mono)
+			sample = next();
+		for (auto& sample : stereo)
+			sample = next();
+
+		AudioMixer mixer(48000);
+		std::vector<MixerVoice> voices(voiceCount);
+		for (u32 i = 0; i < voiceCount; i++)
+		{
+			auto& voice = voices[i];
+			voice.Channels = (i % 2) + 1;
+			voice.Samples = voice.Channels == 2 ? stereo.data() : mono.data();
+			voice.FrameCount = sourceFrames;
+			voice.Step = 0.5 + (i % 7) * 0.25;
+			voice.Position = double(i * 97 % sourceFrames);
+			voice.Looping = true;
+			voice.TargetGain[0] = 0.25f + (i % 3) * 0.25f;
+			voice.TargetGain[1] = 1.0f - voice.TargetGain[0];
+		}
+
+		float checksum = 0.0f;
+		Timer timer;
+
+		for (u32 block = 0; block < blockCount; block++)
+		{
+			mixer.BeginBlock();
+			for (auto& voice : voices)
+				mixer.MixVoice(voice);
+			checksum += mixer.EndBlock()[block % BLOCK_SAMPLES];
+		}
+
+		const double time = timer.GetMS(1000.0);
+		const double voicesPerMS = time > 0.0 ? double(voiceCount) * blockCount / time : 0.0;
+
+		LUMOS_LOG_INFO("Mixed {0} voices x {1} blocks in {2} ms, {3} voice blocks per ms (checksum {4})", voiceCount, blockCount, time, voicesPerMS, checksum);
+		return voicesPerMS;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "lmpch.h"
+
+// Frames mixed per block, outputs accept whole blocks only
+#define AUDIO_MIX_BLOCK_FRAMES 512
+#define AUDIO_MIX_CHANNELS 2
+
+namespace Lumos
+{
+	// Hook run over a bus's interleaved stereo block before it is summed into its parent
+	class LUMOS_EXPORT AudioEffect
+	{
+	public:
+		virtual ~AudioEffect() = default;
+
+		virtual void Process(float* samples, u32 frames, u32 sampleRate) = 0;
+		virtual const char* GetName() const = 0;
+
+		bool Enabled = true;
+	};
+
+	// One pole low pass, for muffling occluded or underwater buses
+	class LUMOS_EXPORT LowPassEffect : public AudioEffect
+	{
+	public:
+		LowPassEffect(float cutoff = 2000.0f) : Cutoff(cutoff) {}
+
+		void Process(float* samples, u32 frames, u32 sampleRate) override;
+		const char* GetName() const override { return "Low Pass"; }
+
+		float Cutoff;
+
+	private:
+		float m_History[AUDIO_MIX_CHANNELS] = {};
+	};
+
+	// Soft knee clipper keeping the master bus inside [-1, 1]
+	class LUMOS_EXPORT LimiterEffect : public AudioEffect
+	{
+	public:
+		void Process(float* samples, u32 frames, u32 sampleRate) override;
+		const char* GetName() const override { return "Limiter"; }
+	};
+
+	// Playback state of one source being mixed. Samples are interleaved float frames owned by
+	// the caller, Position is in source frames and Step is source frames per output frame.
+	struct MixerVoice
+	{
+		const float* Samples = nullptr;
+		u32 Channels = 1;
+		u32 FrameCount = 0;
+		double Position = 0.0;
+		double Step = 1.0;
+		bool Looping = false;
+		u32 Bus = 0;
+
+		// Gains reached at the end of the next block, ramped from the current ones to avoid clicks
+		float Gain[AUDIO_MIX_CHANNELS] = {};
+		float TargetGain[AUDIO_MIX_CHANNELS] = {};
+	};
+
+	class LUMOS_EXPORT AudioMixer
+	{
+	public:
+		AudioMixer(u32 sampleRate = 48000);
+		~AudioMixer();
+
+		// Bus 0 is the master bus. A bus must be added after its parent so the graph can be
+		// summed back to front in a single pass.
+		u32 AddBus(const String& name, u32 parent = 0);
+		void AddEffect(u32 bus, AudioEffect* effect);
+		void SetBusVolume(u32 bus, float volume) { m_Buses[bus].Volume = volume; }
+		u32 GetBusCount() const { return static_cast<u32>(m_Buses.size()); }
+
+		// Clears every bus for a new block of AUDIO_MIX_BLOCK_FRAMES frames
+		void BeginBlock();
+
+		// Adds the voice into its bus and advances it, returns false once a one shot voice ends
+		bool MixVoice(MixerVoice& voice);
+
+		// Advances the voice without mixing it, for voices too quiet to hear
+		bool SkipVoice(MixerVoice& voice);
+
+		// Runs effects and sums the bus graph, returns the master block
+		const float* EndBlock();
+
+		u32 GetSampleRate() const { return m_SampleRate; }
+		u32 GetMixedVoices() const { return m_MixedVoices; }
+
+		void OnImGui();
+
+		// Mixes a fixed set of generated voices through one bus on the calling thread and
+		// returns how many voice blocks were mixed per millisecond
+		static double Benchmark(u32 voiceCount, u32 blockCount);
+
+	private:
+		struct Bus
+		{
+			String Name;
+			u32 Parent = 0;
+			float Volume = 1.0f;
+			std::vector<AudioEffect*> Effects;
+			float* Samples = nullptr;
+		};
+
+		std::vector<Bus> m_Buses;
+		u32 m_SampleRate;
+		u32 m_MixedVoices = 0;
+	};
+}
@@ -0,0 +1,84 @@
+#include "lmpch.h"
+#include "AudioOutput.h"
+#include "Maths/Maths.h"
+
+namespace Lumos
+{
+	WavFileAudioOutput::WavFileAudioOutput(const String& filePath)
+		: m_FilePath(filePath)
+	{
+	}
+
+	WavFileAudioOutput::~WavFileAudioOutput()
+	{
+		Close();
+	}
+
+	bool WavFileAudioOutput::Open(u32 sampleRate, u32 channels)
+	{
+		m_SampleRate = sampleRate;
+		m_Channels = channels;
+		m_DataSize = 0;
+
+		m_File.open(m_FilePath, std::ios::binary | std::ios::trunc);
+		if (!m_File.is_open())
+		{
+			LUMOS_LOG_ERROR("Failed to open audio capture file {0}", m_FilePath);
+			return false;
+		}
+
+		// Sizes are patched in Close once the length is known
+		WriteHeader();
+		return true;
+	}
+
+	void WavFileAudioOutput::Close()
+	{
+		if (!m_File.is_open())
+			return;
+
+		m_File.seekp(0);
+		WriteHeader();
+		m_File.close();
+	}
+
+	void WavFileAudioOutput::WriteHeader()
+	{
+		const u32 byteRate = m_SampleRate * m_Channels * 2;
+		const u16 blockAlign = static_cast<u16>(m_Channels * 2);
+		const u16 bitsPerSample = 16;
+		const u16 format = 1;
+		const u16 channels = static_cast<u16>(m_Channels);
+		const u32 fmtSize = 16;
+		const u32 riffSize = 36 + m_DataSize;
+
+		m_File.write("RIFF", 4);
+		m_File.write(reinterpret_cast<const char*>(&riffSize), 4);
+		m_File.write("WAVE", 4);
+		m_File.write("fmt ", 4);
+		m_File.write(reinterpret_cast<const char*>(&fmtSize), 4);
+		m_File.write(reinterpret_cast<const char*>(&format), 2);
+		m_File.write(reinterpret_cast<const char*>(&channels), 2);
+		m_File.write(reinterpret_cast<const char*>(&m_SampleRate), 4);
+		m_File.write(reinterpret_cast<const char*>(&byteRate), 4);
+		m_File.write(reinterpret_cast<const char*>(&blockAlign), 2);
+		m_File.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
+		m_File.write("data", 4);
+		m_File.write(reinterpret_cast<const char*>(&m_DataSize), 4);
+	}
+
+	void WavFileAudioOutput::Write(const float* samples, u32 frames)
+	{
+		if (!m_File.is_open())
+			return;
+
+		const u32 count = frames * m_Channels;
+		m_Buffer.resize(count);
+
+		for (u32 i = 0; i < count; i++)
+			m_Buffer[i] = static_cast<i16>(Maths::Clamp(samples[i], -1.0f, 1.0f) * 32767.0f);
+
+		m_File.write(reinterpret_cast<const char*>(m_Buffer.data()), count * sizeof(i16));
+		m_DataSize += count * sizeof(i16);
+	}
+}
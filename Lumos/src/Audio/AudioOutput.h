@@ -0,0 +1,57 @@
+#pragma once
+
+#include "lmpch.h"
+
+namespace Lumos
+{
+	// Destination for the mixer's interleaved float blocks
+	class LUMOS_EXPORT AudioOutput
+	{
+	public:
+		virtual ~AudioOutput() = default;
+
+		virtual bool Open(u32 sampleRate, u32 channels) = 0;
+		virtual void Close() = 0;
+
+		// How many of the frames the game clock asked for can be written now. Device outputs
+		// override this to follow their own clock instead.
+		virtual u32 GetWritableFrames(u32 requestedFrames) { return requestedFrames; }
+
+		virtual void Write(const float* samples, u32 frames) = 0;
+		virtual const char* GetName() const = 0;
+	};
+
+	// Discards everything, for headless servers and tests
+	class LUMOS_EXPORT NullAudioOutput : public AudioOutput
+	{
+	public:
+		bool Open(u32, u32) override { return true; }
+		void Close() override {}
+		void Write(const float*, u32) override {}
+		const char* GetName() const override { return "Null"; }
+	};
+
+	// Records the mix to a 16 bit PCM wav file, paced by the game clock so a fixed timestep
+	// always produces the same file
+	class LUMOS_EXPORT WavFileAudioOutput : public AudioOutput
+	{
+	public:
+		WavFileAudioOutput(const String& filePath);
+		~WavFileAudioOutput();
+
+		bool Open(u32 sampleRate, u32 channels) override;
+		void Close() override;
+		void Write(const float* samples, u32 frames) override;
+		const char* GetName() const override { return "Wav File"; }
+
+	private:
+		void WriteHeader();
+
+		String m_FilePath;
+		std::ofstream m_File;
+		std::vector<i16> m_Buffer;
+		u32 m_SampleRate = 0;
+		u32 m_Channels = 0;
+		u32 m_DataSize = 0;
+	};
+}
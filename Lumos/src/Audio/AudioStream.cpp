@@ -0,0 +1,119 @@
+#include "lmpch.h"
+#include "AudioStream.h"
+#include "OggLoader.h"
+#include "WavLoader.h"
+
+namespace Lumos
+{
+	AudioStream* AudioStream::Create(const String& fileName, const String& extension)
+	{
+		AudioStream* stream = nullptr;
+
+		if (extension == "wav")
+			stream = lmnew WavStream(fileName);
+		else if (extension == "ogg")
+			stream = lmnew OggStream(fileName);
+
+		if (stream && !stream->IsValid())
+		{
+			delete stream;
+			return nullptr;
+		}
+
+		return stream;
+	}
+
+	AudioStreamer::~AudioStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Running = false;
+		}
+
+		m_Condition.notify_one();
+
+		if (m_Thread.joinable())
+			m_Thread.join();
+	}
+
+	void AudioStreamer::Register(AudioStreamBuffer* buffer)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Buffers.push_back(buffer);
+
+			if (!m_Running)
+			{
+				m_Running = true;
+				m_Thread = std::thread(&AudioStreamer::Run, this);
+			}
+		}
+
+		m_Condition.notify_one();
+	}
+
+	void AudioStreamer::Unregister(AudioStreamBuffer* buffer)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Buffers.erase(std::remove(m_Buffers.begin(), m_Buffers.end(), buffer), m_Buffers.end());
+		m_FillDone.wait(lock, [&] { return m_Filling != buffer; });
+	}
+
+	bool AudioStreamer::Fill(AudioStreamBuffer* buffer)
+	{
+		bool filled = false;
+
+		while (!buffer->finished.load(std::memory_order_relaxed) && buffer->GetReadyCount() < AUDIO_STREAM_CHUNKS)
+		{
+			const u32 write = buffer->writeIndex.load(std::memory_order_relaxed);
+			const u32 slot = write % AUDIO_STREAM_CHUNKS;
+
+			u32 size = buffer->stream->Read(buffer->chunks[slot], AUDIO_STREAM_CHUNK_SIZE);
+
+			if (size < AUDIO_STREAM_CHUNK_SIZE && buffer->looping.load(std::memory_order_relaxed))
+			{
+				buffer->stream->Rewind();
+				size += buffer->stream->Read(buffer->chunks[slot] + size, AUDIO_STREAM_CHUNK_SIZE - size);
+			}
+
+			if (size == 0)
+			{
+				buffer->finished.store(true, std::memory_order_release);
+				break;
+			}
+
+			buffer->sizes[slot] = size;
+			buffer->writeIndex.store(write + 1, std::memory_order_release);
+			filled = true;
+		}
+
+		return filled;
+	}
+
+	void AudioStreamer::Run()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		while (m_Running)
+		{
+			// The lock only guards the buffer list. File reads and decoding happen without it, so
+			// Register and Unregister on the game thread never wait behind a decode.
+			bool filled = false;
+			for (size_t i = 0; i < m_Buffers.size(); i++)
+			{
+				m_Filling = m_Buffers[i];
+				lock.unlock();
+
+				filled |= Fill(m_Filling);
+
+				lock.lock();
+				m_Filling = nullptr;
+				m_FillDone.notify_all();
+			}
+
+			// Nothing to decode until a node consumes a chunk, the timeout covers a missed notify
+			if (!filled)
+				m_Condition.wait_for(lock, std::chrono::milliseconds(10));
+		}
+	}
+}
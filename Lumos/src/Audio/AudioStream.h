@@ -0,0 +1,96 @@
+#pragma once
+
+#include "lmpch.h"
+#include "AudioData.h"
+
+#include <atomic>
+#include <condition_variable>
+
+#define AUDIO_STREAM_CHUNK_SIZE 32768
+#define AUDIO_STREAM_CHUNKS 4
+
+namespace Lumos
+{
+	// Incremental decoder. Read fills the buffer with interleaved PCM in the format described
+	// by GetFormat (Size and Length cover the whole file, Data is unused).
+	class LUMOS_EXPORT AudioStream
+	{
+	public:
+		static AudioStream* Create(const String& fileName, const String& extension);
+		virtual ~AudioStream() = default;
+
+		// Returns the number of bytes written, less than size only at the end of the file
+		virtual u32 Read(u8* buffer, u32 size) = 0;
+		virtual void Rewind() = 0;
+		virtual void Seek(double ms) = 0;
+
+		const AudioData& GetFormat() const { return m_Format; }
+		bool IsValid() const { return m_Format.Channels > 0; }
+
+	protected:
+		AudioData m_Format = {};
+	};
+
+	// Ring of decoded chunks for one playing source. The streamer thread fills it and the
+	// sound node drains it into its queued buffers, so each stream's memory stays bounded.
+	struct AudioStreamBuffer
+	{
+		AudioStream* stream = nullptr;
+		u8 chunks[AUDIO_STREAM_CHUNKS][AUDIO_STREAM_CHUNK_SIZE];
+		u32 sizes[AUDIO_STREAM_CHUNKS] = {};
+
+		// Monotonic counters, the slot is index % AUDIO_STREAM_CHUNKS
+		std::atomic<u32> readIndex { 0 };
+		std::atomic<u32> writeIndex { 0 };
+		std::atomic<bool> looping { false };
+		std::atomic<bool> finished { false };
+
+		u32 GetReadyCount() const { return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_relaxed); }
+
+		const u8* GetChunk(u32& size) const
+		{
+			const u32 slot = readIndex.load(std::memory_order_relaxed) % AUDIO_STREAM_CHUNKS;
+			size = sizes[slot];
+			return chunks[slot];
+		}
+
+		void PopChunk() { readIndex.fetch_add(1, std::memory_order_release); }
+	};
+
+	// Background thread decoding registered streams ahead of playback
+	class LUMOS_EXPORT AudioStreamer
+	{
+	public:
+		AudioStreamer() = default;
+		~AudioStreamer();
+
+		void Register(AudioStreamBuffer* buffer);
+
+		// Blocks until the thread is no longer touching the buffer
+		void Unregister(AudioStreamBuffer* buffer);
+
+		// Wakes the thread after chunks have been consumed
+		void Notify() { m_Condition.notify_one(); }
+
+		u32 GetStreamCount() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return static_cast<u32>(m_Buffers.size());
+		}
+
+	private:
+		void Run();
+		bool Fill(AudioStreamBuffer* buffer);
+
+		std::vector<AudioStreamBuffer*> m_Buffers;
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+
+		// Buffer being decoded outside the lock, Unregister waits on m_FillDone until it moves on
+		AudioStreamBuffer* m_Filling = nullptr;
+		std::condition_variable m_FillDone;
+
+		std::thread m_Thread;
+		bool m_Running = false;
+	};
+}
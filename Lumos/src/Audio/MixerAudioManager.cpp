@@ -0,0 +1,171 @@
+#include "lmpch.h"
+#include "MixerAudioManager.h"
+#include "MixerSound.h"
+#include "MixerSoundNode.h"
+#include "Graphics/Camera/Camera.h"
+#include "Utilities/TimeStep.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
+
+// Upper bound on how far the mix may fall behind before frames are dropped, in blocks
+#define MAX_PENDING_BLOCKS 32
+
+namespace Lumos
+{
+	namespace Audio
+	{
+		MixerAudioManager::MixerAudioManager(AudioOutput* output, u32 sampleRate)
+			: m_Mixer(sampleRate)
+			, m_Output(output)
+		{
+			m_Listener = nullptr;
+			m_DebugName = "Software Audio Mixer";
+
+			// Muffling is opt in from the bus settings
+			auto lowPass = lmnew LowPassEffect();
+			lowPass->Enabled = false;
+
+			m_SoundBus = m_Mixer.AddBus("Sounds");
+			m_Mixer.AddEffect(m_SoundBus, lowPass);
+			m_Mixer.AddEffect(0, lmnew LimiterEffect());
+		}
+
+		MixerAudioManager::~MixerAudioManager()
+		{
+			m_Output->Close();
+			delete m_Output;
+		}
+
+		void MixerAudioManager::OnInit()
+		{
+			LUMOS_LOG_INFO("Creating software audio mixer, output : {0}", m_Output->GetName());
+
+			if (!m_Output->Open(m_Mixer.GetSampleRate(), AUDIO_MIX_CHANNELS))
+			{
+				LUMOS_LOG_WARN("Failed to open {0} audio output, mixing to null output", m_Output->GetName());
+				delete m_Output;
+				m_Output = lmnew NullAudioOutput();
+				m_Output->Open(m_Mixer.GetSampleRate(), AUDIO_MIX_CHANNELS);
+			}
+		}
+
+		Sound* MixerAudioManager::CreateSound(const String& name, const String& extension)
+		{
+			return lmnew MixerSound(name, extension);
+		}
+
+		SoundNode* MixerAudioManager::CreateSoundNode()
+		{
+			auto node = lmnew MixerSoundNode();
+			node->SetBus(m_SoundBus);
+			return node;
+		}
+
+		void MixerAudioManager::OnUpdate(const TimeStep& dt, Scene*)
+		{
+			LUMOS_PROFILE_FUNC;
+
+			Timer timer;
+
+			m_PendingFrames += dt.GetMillis() * 0.001 * m_Mixer.GetSampleRate();
+			m_PendingFrames = Maths::Min(m_PendingFrames, double(MAX_PENDING_BLOCKS * AUDIO_MIX_BLOCK_FRAMES));
+
+			const u32 requested = static_cast<u32>(m_PendingFrames) / AUDIO_MIX_BLOCK_FRAMES * AUDIO_MIX_BLOCK_FRAMES;
+			const u32 blocks = Maths::Min(m_Output->GetWritableFrames(requested), u32(MAX_PENDING_BLOCKS * AUDIO_MIX_BLOCK_FRAMES)) / AUDIO_MIX_BLOCK_FRAMES;
+			m_PendingFrames = Maths::Max(0.0, m_PendingFrames - double(blocks * AUDIO_MIX_BLOCK_FRAMES));
+
+			Maths::Vector3 listenerPosition(0.0f);
+			Maths::Vector3 listenerRight(1.0f, 0.0f, 0.0f);
+			if (m_Listener)
+			{
+				listenerPosition = m_Listener->GetPosition();
+				listenerRight = m_Listener->GetRightDirection();
+			}
+
+			m_VoicesMixed = 0;
+			for (u32 block = 0; block < blocks; block++)
+			{
+				m_Mixer.BeginBlock();
+
+				for (auto node : m_SoundNodes)
+					static_cast<MixerSoundNode*>(node)->Mix(m_Mixer, listenerPosition, listenerRight);
+
+				m_VoicesMixed = Maths::Max(m_VoicesMixed, m_Mixer.GetMixedVoices());
+				m_Output->Write(m_Mixer.EndBlock(), AUDIO_MIX_BLOCK_FRAMES);
+			}
+
+			for (auto node : m_SoundNodes)
+				node->OnUpdate(dt.GetMillis());
+
+			m_BlocksMixed = blocks;
+			m_MixTime = timer.GetMS(1000.0f);
+		}
+
+		void MixerAudioManager::OnImGui()
+		{
+			ImGui::TextUnformatted("Software Audio Mixer");
+
+			ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
+			ImGui::Columns(2);
+			ImGui::Separator();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Output");
+			ImGui::NextColumn();
+			ImGui::TextUnformatted(m_Output->GetName());
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Number Of Audio Sources");
+			ImGui::NextColumn();
+			ImGui::Text("%5.2lu", m_SoundNodes.size());
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Mixed Voices");
+			ImGui::NextColumn();
+			ImGui::Text("%5.2u", m_VoicesMixed);
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Streaming Sources");
+			ImGui::NextColumn();
+			ImGui::Text("%5.2u", m_Streamer.GetStreamCount());
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Blocks This Frame");
+			ImGui::NextColumn();
+			ImGui::Text("%5.2u", m_BlocksMixed);
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Mix Time");
+			ImGui::NextColumn();
+			ImGui::Text("%5.2f ms", m_MixTime);
+			ImGui::NextColumn();
+
+			m_Mixer.OnImGui();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Benchmark Voices");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::DragInt("##BenchmarkVoices", &m_BenchmarkVoices, 1.0f, 1, 4096);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			if (ImGui::Button("Run Mix Benchmark"))
+				m_BenchmarkResult = AudioMixer::Benchmark(static_cast<u32>(m_BenchmarkVoices), 1000);
+			ImGui::NextColumn();
+			ImGui::Text("%.1f voice blocks / ms", m_BenchmarkResult);
+			ImGui::NextColumn();
+
+			ImGui::Columns(1);
+			ImGui::Separator();
+			ImGui::PopStyleVar();
+		}
+	}
+}
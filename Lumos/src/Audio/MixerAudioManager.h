@@ -0,0 +1,49 @@
+#pragma once
+
+#include "lmpch.h"
+#include "AudioManager.h"
+#include "AudioMixer.h"
+#include "AudioOutput.h"
+
+namespace Lumos
+{
+	namespace Audio
+	{
+		// Mixes every sound node in software and hands the result to an AudioOutput, so audio
+		// logic runs the same with a device, without one, or while recording to disk
+		class LUMOS_EXPORT MixerAudioManager : public AudioManager
+		{
+		public:
+			MixerAudioManager(AudioOutput* output, u32 sampleRate = 48000);
+			~MixerAudioManager();
+
+			void OnInit() override;
+			void OnUpdate(const TimeStep& dt, Scene* scene) override;
+			void OnImGui() override;
+
+			Sound* CreateSound(const String& name, const String& extension) override;
+			SoundNode* CreateSoundNode() override;
+
+			AudioMixer& GetMixer() { return m_Mixer; }
+			AudioOutput* GetOutput() const { return m_Output; }
+
+			// Bus new sound nodes are routed to
+			u32 GetSoundBus() const { return m_SoundBus; }
+
+		private:
+			AudioMixer m_Mixer;
+			AudioOutput* m_Output;
+			u32 m_SoundBus;
+
+			// Frames owed to the output by the game clock, mixed in whole blocks
+			double m_PendingFrames = 0.0;
+
+			float m_MixTime = 0.0f;
+			u32 m_BlocksMixed = 0;
+			u32 m_VoicesMixed = 0;
+
+			int m_BenchmarkVoices = 256;
+			double m_BenchmarkResult = 0.0;
+		};
+	}
+}
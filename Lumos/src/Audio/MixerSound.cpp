@@ -0,0 +1,62 @@
+#include "lmpch.h"
+#include "MixerSound.h"
+#include "WavLoader.h"
+#include "OggLoader.h"
+#include "AudioStream.h"
+
+namespace Lumos
+{
+	MixerSound::MixerSound(const String& fileName, const String& format)
+	{
+		m_FilePath = fileName;
+		m_Extension = format;
+
+		AudioStream* stream = AudioStream::Create(fileName, format);
+		if (stream && stream->GetFormat().Size > SOUND_STREAM_THRESHOLD)
+		{
+			m_Data = stream->GetFormat();
+			m_Streaming = true;
+			delete stream;
+			return;
+		}
+
+		delete stream;
+
+		if (format == "wav")
+			m_Data = LoadWav(fileName);
+		else if (format == "ogg")
+			m_Data = LoadOgg(fileName);
+
+		if (!m_Data.Data)
+			return;
+
+		ConvertSamples(m_Data.Data, m_Data.Size, m_Data.BitRate, m_Samples);
+
+		// The float copy is all the mixer reads
+		delete[] m_Data.Data;
+		m_Data.Data = nullptr;
+	}
+
+	void MixerSound::ConvertSamples(const u8* data, u32 size, u32 bitRate, std::vector<float>& samples)
+	{
+		if (bitRate == 16)
+		{
+			const i16* source = reinterpret_cast<const i16*>(data);
+			const u32 count = size / 2;
+			const size_t offset = samples.size();
+			samples.resize(offset + count);
+
+			for (u32 i = 0; i < count; i++)
+				samples[offset + i] = source[i] * (1.0f / 32768.0f);
+		}
+		else if (bitRate == 8)
+		{
+			// 8 bit PCM is unsigned with 128 as silence
+			const size_t offset = samples.size();
+			samples.resize(offset + size);
+
+			for (u32 i = 0; i < size; i++)
+				samples[offset + i] = (float(data[i]) - 128.0f) * (1.0f / 128.0f);
+		}
+	}
+}
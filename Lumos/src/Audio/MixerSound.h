@@ -0,0 +1,24 @@
+#pragma once
+
+#include "lmpch.h"
+#include "Sound.h"
+
+namespace Lumos
+{
+	// Sound decoded to float frames for the software mixer
+	class LUMOS_EXPORT MixerSound : public Sound
+	{
+	public:
+		MixerSound(const String& fileName, const String& format);
+		~MixerSound() = default;
+
+		const float* GetSamples() const { return m_Samples.data(); }
+		u32 GetFrameCount() const { return m_Data.Channels ? static_cast<u32>(m_Samples.size() / m_Data.Channels) : 0; }
+
+		// Appends 8 or 16 bit PCM to samples as floats in [-1, 1]
+		static void ConvertSamples(const u8* data, u32 size, u32 bitRate, std::vector<float>& samples);
+
+	private:
+		std::vector<float> m_Samples;
+	};
+}
@@ -0,0 +1,197 @@
+#include "lmpch.h"
+#include "MixerSoundNode.h"
+#include "MixerSound.h"
+#include "AudioManager.h"
+
+#include "App/Application.h"
+
+namespace Lumos
+{
+	MixerSoundNode::MixerSoundNode()
+	{
+	}
+
+	MixerSoundNode::~MixerSoundNode()
+	{
+		StopStream();
+
+		auto audioManager = Application::Instance()->GetSystem<AudioManager>();
+		if (audioManager)
+			audioManager->RemoveSoundNode(this);
+	}
+
+	void MixerSoundNode::OnUpdate(float)
+	{
+		if (m_Sound)
+			m_TimeLeft = Maths::Max(0.0, m_Sound->GetLength() - m_StreamPos);
+	}
+
+	void MixerSoundNode::Mix(AudioMixer& mixer, const Maths::Vector3& listenerPosition, const Maths::Vector3& listenerRight)
+	{
+		if (!IsPlaying() || m_Paused)
+			return;
+
+		// Balance pan from the listener's right vector, centred sounds keep full gain in both ears
+		const float gain = m_Volume * GetAttenuation(listenerPosition);
+		float pan = 0.0f;
+		if (!m_IsGlobal)
+		{
+			Maths::Vector3 direction = m_Position - listenerPosition;
+			const float distance = direction.Length();
+			if (distance > 0.0001f)
+				pan = Maths::Clamp(direction.DotProduct(listenerRight) / distance, -1.0f, 1.0f);
+		}
+
+		m_Voice.TargetGain[0] = gain * Maths::Min(1.0f, 1.0f - pan);
+		m_Voice.TargetGain[1] = gain * Maths::Min(1.0f, 1.0f + pan);
+		m_Voice.Step = double(m_Sound->GetFrequency()) / double(mixer.GetSampleRate()) * m_Pitch;
+
+		const double blockMS = AUDIO_MIX_BLOCK_FRAMES * 1000.0 / mixer.GetSampleRate();
+		const bool audible = m_Voice.Gain[0] > 0.0f || m_Voice.Gain[1] > 0.0f || m_Voice.TargetGain[0] > 0.0f || m_Voice.TargetGain[1] > 0.0f;
+
+		if (m_Sound->IsStreaming())
+		{
+			if (!m_StreamBuffer)
+				return;
+
+			m_StreamBuffer->looping = m_IsLooping;
+
+			FillStream(static_cast<u32>(m_Voice.Step * AUDIO_MIX_BLOCK_FRAMES) + 2);
+
+			// Nothing decoded yet, wait rather than skipping ahead of the stream
+			if (m_Voice.FrameCount < 2 && !m_StreamBuffer->finished)
+				return;
+
+			// Looping is handled by the decoder, running out of staged frames is an underrun or the end
+			const bool mixed = audible ? mixer.MixVoice(m_Voice) : mixer.SkipVoice(m_Voice);
+			if (!mixed && m_StreamBuffer->finished && m_StreamBuffer->GetReadyCount() == 0)
+				m_Stopped = true;
+
+			m_StreamPos += blockMS * m_Pitch;
+			if (m_IsLooping && m_Sound->GetLength() > 0.0)
+				m_StreamPos = fmod(m_StreamPos, m_Sound->GetLength());
+		}
+		else
+		{
+			auto sound = static_cast<MixerSound*>(m_Sound);
+			m_Voice.Samples = sound->GetSamples();
+			m_Voice.FrameCount = sound->GetFrameCount();
+			m_Voice.Looping = m_IsLooping;
+
+			if (!(audible ? mixer.MixVoice(m_Voice) : mixer.SkipVoice(m_Voice)))
+				m_Stopped = true;
+
+			m_StreamPos = m_Voice.Position * 1000.0 / m_Sound->GetFrequency();
+		}
+	}
+
+	void MixerSoundNode::FillStream(u32 framesNeeded)
+	{
+		const u32 channels = m_Voice.Channels;
+
+		// Keep the frame under the read position, interpolation still needs it
+		const u32 consumed = Maths::Min(static_cast<u32>(m_Voice.Position), m_Voice.FrameCount > 0 ? m_Voice.FrameCount - 1 : 0u);
+		if (consumed > 0)
+		{
+			m_StreamSamples.erase(m_StreamSamples.begin(), m_StreamSamples.begin() + consumed * channels);
+			m_Voice.Position -= consumed;
+		}
+
+		bool consumedChunk = false;
+		while (m_StreamSamples.size() / channels < m_Voice.Position + framesNeeded && m_StreamBuffer->GetReadyCount() > 0)
+		{
+			u32 size = 0;
+			const u8* data = m_StreamBuffer->GetChunk(size);
+			MixerSound::ConvertSamples(data, size, m_Sound->GetBitRate(), m_StreamSamples);
+			m_StreamBuffer->PopChunk();
+			consumedChunk = true;
+		}
+
+		if (consumedChunk)
+			Application::Instance()->GetSystem<AudioManager>()->GetStreamer().Notify();
+
+		m_Voice.Samples = m_StreamSamples.data();
+		m_Voice.FrameCount = static_cast<u32>(m_StreamSamples.size() / channels);
+		m_Voice.Looping = false;
+	}
+
+	void MixerSoundNode::Pause()
+	{
+		m_Paused = true;
+	}
+
+	void MixerSoundNode::Resume()
+	{
+		m_Paused = false;
+
+		if (m_Stopped && m_Sound)
+		{
+			// Restart from the beginning like a stopped OpenAL source
+			m_Stopped = false;
+			m_StreamPos = 0.0;
+			m_Voice.Position = 0.0;
+
+			if (m_Sound->IsStreaming())
+			{
+				StopStream();
+				StartStream();
+			}
+		}
+	}
+
+	void MixerSoundNode::Stop()
+	{
+		m_Stopped = true;
+	}
+
+	void MixerSoundNode::SetSound(Sound* s)
+	{
+		StopStream();
+
+		m_Sound = s;
+		m_Stopped = false;
+		m_StreamPos = 0.0;
+		m_Voice.Position = 0.0;
+		m_Voice.Samples = nullptr;
+		m_Voice.FrameCount = 0;
+
+		if (m_Sound)
+		{
+			m_TimeLeft = m_Sound->GetLength();
+			m_Voice.Channels = Maths::Max(1, Maths::Min(2, m_Sound->GetChannels()));
+
+			if (m_Sound->IsStreaming())
+				StartStream();
+		}
+	}
+
+	void MixerSoundNode::StartStream()
+	{
+		AudioStream* stream = m_Sound->OpenStream();
+		if (!stream)
+			return;
+
+		m_StreamBuffer = lmnew AudioStreamBuffer();
+		m_StreamBuffer->stream = stream;
+		m_StreamBuffer->looping = m_IsLooping;
+
+		Application::Instance()->GetSystem<AudioManager>()->GetStreamer().Register(m_StreamBuffer);
+	}
+
+	void MixerSoundNode::StopStream()
+	{
+		if (!m_StreamBuffer)
+			return;
+
+		Application::Instance()->GetSystem<AudioManager>()->GetStreamer().Unregister(m_StreamBuffer);
+
+		delete m_StreamBuffer->stream;
+		delete m_StreamBuffer;
+		m_StreamBuffer = nullptr;
+
+		m_StreamSamples.clear();
+		m_Voice.Samples = nullptr;
+		m_Voice.FrameCount = 0;
+		m_Voice.Position = 0.0;
+	}
+}
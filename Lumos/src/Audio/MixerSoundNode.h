@@ -0,0 +1,42 @@
+#pragma once
+
+#include "lmpch.h"
+#include "SoundNode.h"
+#include "AudioMixer.h"
+#include "AudioStream.h"
+
+namespace Lumos
+{
+	class LUMOS_EXPORT MixerSoundNode : public SoundNode
+	{
+	public:
+		MixerSoundNode();
+		virtual ~MixerSoundNode();
+
+		void OnUpdate(float msec) override;
+		void Pause() override;
+		void Resume() override;
+		void Stop() override;
+		void SetSound(Sound *s) override;
+
+		bool IsPlaying() const override { return m_Sound && !m_Stopped; }
+
+		// Mixes the next block into the node's bus, called by the mixer manager
+		void Mix(AudioMixer& mixer, const Maths::Vector3& listenerPosition, const Maths::Vector3& listenerRight);
+
+		void SetBus(u32 bus) { m_Voice.Bus = bus; }
+		u32 GetBus() const { return m_Voice.Bus; }
+
+	private:
+		void StartStream();
+		void StopStream();
+
+		// Drops consumed frames and appends decoded chunks until the next block is covered
+		void FillStream(u32 framesNeeded);
+
+		MixerVoice m_Voice;
+		AudioStreamBuffer* m_StreamBuffer = nullptr;
+		std::vector<float> m_StreamSamples;
+		bool m_Stopped = false;
+	};
+}
@@ -43,4 +43,57 @@ namespace Lumos
 
 		return data;
 	}
+
+	OggStream::OggStream(const String& fileName)
+	{
+		m_Handle = stb_vorbis_open_filename(fileName.c_str(), nullptr, nullptr);
+
+		if (!m_Handle)
+		{
+			LUMOS_LOG_CRITICAL("Failed to open OGG stream '{0}'!", fileName);
+			return;
+		}
+
+		const stb_vorbis_info info = stb_vorbis_get_info(m_Handle);
+		m_Format.Channels = info.channels;
+		m_Format.BitRate = 16;
+		m_Format.FreqRate = static_cast<float>(info.sample_rate);
+		m_Format.Size = stb_vorbis_stream_length_in_samples(m_Handle) * info.channels * sizeof(i16);
+		m_Format.Length = stb_vorbis_stream_length_in_seconds(m_Handle) * 1000.0f;
+	}
+
+	OggStream::~OggStream()
+	{
+		if (m_Handle)
+			stb_vorbis_close(m_Handle);
+	}
+
+	u32 OggStream::Read(u8* buffer, u32 size)
+	{
+		const u32 frameSize = m_Format.Channels * sizeof(i16);
+		u32 bytesRead = 0;
+
+		// Vorbis decodes a packet at a time, keep going until the buffer is full or the file ends
+		while (bytesRead + frameSize <= size)
+		{
+			const int frames = stb_vorbis_get_samples_short_interleaved(m_Handle, m_Format.Channels, reinterpret_cast<short*>(buffer + bytesRead), (size - bytesRead) / sizeof(i16));
+			if (frames <= 0)
+				break;
+
+			bytesRead += frames * frameSize;
+		}
+
+		return bytesRead;
+	}
+
+	void OggStream::Rewind()
+	{
+		stb_vorbis_seek_start(m_Handle);
+	}
+
+	void OggStream::Seek(double ms)
+	{
+		const u32 sample = static_cast<u32>(fmod(ms, m_Format.Length) * 0.001 * m_Format.FreqRate);
+		stb_vorbis_seek(m_Handle, sample);
+	}
 }
\ No newline at end of file
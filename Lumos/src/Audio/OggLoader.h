@@ -2,8 +2,25 @@
 
 #include "lmpch.h"
 #include "AudioData.h"
+#include "AudioStream.h"
+
+struct stb_vorbis;
 
 namespace Lumos
 {
 	AudioData LoadOgg(const String& fileName);
+
+	class OggStream : public AudioStream
+	{
+	public:
+		OggStream(const String& fileName);
+		~OggStream();
+
+		u32 Read(u8* buffer, u32 size) override;
+		void Rewind() override;
+		void Seek(double ms) override;
+
+	private:
+		stb_vorbis* m_Handle = nullptr;
+	};
 }
\ No newline at end of file
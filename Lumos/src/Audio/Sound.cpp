@@ -1,10 +1,9 @@
 #include "lmpch.h"
 #include "Sound.h"
 #include "Core/VFS.h"
-
-#ifdef LUMOS_OPENAL
-#include "Platform/OpenAL/ALSound.h"
-#endif
+#include "AudioStream.h"
+#include "AudioManager.h"
+#include "App/Application.h"
 
 namespace Lumos
 {
@@ -19,11 +18,14 @@ namespace Lumos
 
 	Sound* Sound::Create(const String& name, const String& extension)
 	{
-#ifdef LUMOS_OPENAL
-		return lmnew ALSound(name, extension);
-#else
-		return nullptr;
-#endif
+		// The sound's format depends on which backend is mixing it
+		auto audioManager = Application::Instance()->GetSystem<AudioManager>();
+		return audioManager ? audioManager->CreateSound(name, extension) : nullptr;
+	}
+
+	AudioStream* Sound::OpenStream() const
+	{
+		return AudioStream::Create(m_FilePath, m_Extension);
 	}
 
 	double Sound::GetLength() const
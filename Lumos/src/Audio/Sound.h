@@ -4,8 +4,13 @@
 #include "AudioData.h"
 #include "Utilities/TSingleton.h"
 
+// Files decoding to more than this are streamed from disk instead of loaded up front
+#define SOUND_STREAM_THRESHOLD (2 * 1024 * 1024)
+
 namespace Lumos
 {
+	class AudioStream;
+
 	class LUMOS_EXPORT Sound
 	{
 		friend class SoundManager;
@@ -23,9 +28,14 @@ namespace Lumos
 		double			GetLength() const;
 		virtual double	StreamData(unsigned int	buffer, double timeLeft) { return 0.0f; }
 
+		// New decoder positioned at the start of the file, owned by the caller
+		AudioStream*	OpenStream() const;
+
 	protected:
 		Sound();
 		bool	m_Streaming;
+		String	m_FilePath;
+		String	m_Extension;
 
 		AudioData m_Data;
 	};
@@ -1,20 +1,15 @@
 #include "lmpch.h"
 #include "SoundNode.h"
+#include "AudioManager.h"
 #include "Graphics/Camera/Camera.h"
-
-#ifdef LUMOS_OPENAL
-#include "Platform/OpenAL/ALSoundNode.h"
-#endif
+#include "App/Application.h"
 
 namespace Lumos
 {
 	SoundNode* SoundNode::Create()
 	{
-#ifdef LUMOS_OPENAL
-		return lmnew ALSoundNode();
-#else
-		return nullptr;
-#endif
+		auto audioManager = Application::Instance()->GetSystem<AudioManager>();
+		return audioManager ? audioManager->CreateSoundNode() : nullptr;
 	}
 
 	SoundNode::SoundNode()
@@ -38,6 +33,8 @@ namespace Lumos
 		m_Sound = nullptr;
 		m_Paused = false;
 		m_StreamPos = 0;
+		m_Priority = 1.0f;
+		m_Virtual = false;
 		m_IsGlobal = false;
 		m_Stationary = false;
 		m_ReferenceDistance = 0.0f;
@@ -48,6 +45,24 @@ namespace Lumos
 	{
 	}
 
+	float SoundNode::GetAttenuation(const Maths::Vector3& listenerPosition) const
+	{
+		if (m_IsGlobal)
+			return 1.0f;
+
+		const float distance = (m_Position - listenerPosition).Length();
+		if (distance >= m_Radius)
+			return 0.0f;
+
+		const float referenceDistance = Maths::Min(m_ReferenceDistance, m_Radius);
+		return distance <= referenceDistance ? 1.0f : 1.0f - (distance - referenceDistance) / (m_Radius - referenceDistance);
+	}
+
+	float SoundNode::GetAudibility(const Maths::Vector3& listenerPosition) const
+	{
+		return m_Volume * m_Priority * GetAttenuation(listenerPosition);
+	}
+
 	void SoundNode::SetSound(Sound *s)
 	{
 		m_Sound = s;
@@ -49,6 +49,22 @@ namespace Lumos
 
 		double			GetTimeLeft() const { return m_TimeLeft; }
 
+		// Playback position in ms, kept up to date while the node is virtual
+		double			GetPlaybackPosition() const { return m_StreamPos; }
+
+		// Higher priority voices win hardware sources over equally audible ones
+		void			SetPriority(float value) { m_Priority = Maths::Max(0.0f, value); }
+		float			GetPriority() const { return m_Priority; }
+
+		bool			IsVirtual() const { return m_Virtual; }
+		virtual bool	IsPlaying() const { return m_Sound != nullptr; }
+
+		// Linear clamped distance model, the same one the OpenAL backend sets up
+		float			GetAttenuation(const Maths::Vector3& listenerPosition) const;
+
+		// Estimated loudness at the listener, used to rank voices
+		float			GetAudibility(const Maths::Vector3& listenerPosition) const;
+
 		virtual void OnUpdate(float msec) = 0;
 		virtual void Pause() = 0;
 		virtual void Resume() = 0;
@@ -70,6 +86,8 @@ namespace Lumos
 		float			m_ReferenceDistance;
 		bool			m_Stationary;
 		double			m_StreamPos;
+		float			m_Priority;
+		bool			m_Virtual;
 	};
 
 }
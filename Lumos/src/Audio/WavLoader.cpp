@@ -71,4 +71,97 @@ namespace Lumos
 
 		name = String(chunk, 4);
 	}
-}
+
+	WavStream::WavStream(const String& fileName)
+		: m_File(fileName.c_str(), std::ios::in | std::ios::binary)
+	{
+		if (!m_File)
+		{
+			LUMOS_LOG_CRITICAL("Failed to open WAV stream '{0}'!", fileName);
+			return;
+		}
+
+		String chunkName;
+		u32 chunkSize = 0;
+		u32 channels = 0;
+
+		// Only the headers are read here, sample data is pulled in by Read
+		while (m_File && !m_File.eof())
+		{
+			LoadWAVChunkInfo(m_File, chunkName, chunkSize);
+
+			if (chunkName == "RIFF")
+			{
+				m_File.seekg(4, std::ios_base::cur);
+			}
+			else if (chunkName == "fmt ")
+			{
+				u16 format, blockAlign, bitsPerSample, numChannels;
+				u32 sampleRate, byteRate;
+
+				m_File.read(reinterpret_cast<char*>(&format), sizeof(u16));
+				m_File.read(reinterpret_cast<char*>(&numChannels), sizeof(u16));
+				m_File.read(reinterpret_cast<char*>(&sampleRate), sizeof(u32));
+				m_File.read(reinterpret_cast<char*>(&byteRate), sizeof(u32));
+				m_File.read(reinterpret_cast<char*>(&blockAlign), sizeof(u16));
+				m_File.read(reinterpret_cast<char*>(&bitsPerSample), sizeof(u16));
+				m_File.seekg(chunkSize - 16, std::ios_base::cur);
+
+				channels = numChannels;
+				m_Format.BitRate = bitsPerSample;
+				m_Format.FreqRate = static_cast<float>(sampleRate);
+			}
+			else if (chunkName == "data")
+			{
+				m_DataOffset = m_File.tellg();
+				m_Format.Size = chunkSize;
+				m_Remaining = chunkSize;
+				break;
+			}
+			else
+			{
+				m_File.seekg(chunkSize + (chunkSize & 1), std::ios_base::cur);
+			}
+		}
+
+		if (m_DataOffset == 0 || channels == 0 || m_Format.BitRate == 0)
+		{
+			LUMOS_LOG_CRITICAL("Failed to find WAV data in '{0}'!", fileName);
+			return;
+		}
+
+		m_Format.Channels = channels;
+		m_Format.Length = static_cast<float>(m_Format.Size) / (m_Format.Channels * m_Format.FreqRate * (m_Format.BitRate / 8.0f)) * 1000.0f;
+	}
+
+	u32 WavStream::Read(u8* buffer, u32 size)
+	{
+		// Whole frames only, so chunk boundaries never split a sample
+		const u32 frameSize = m_Format.Channels * (m_Format.BitRate / 8);
+		const u32 bytes = std::min(size - size % frameSize, m_Remaining);
+
+		m_File.read(reinterpret_cast<char*>(buffer), bytes);
+		const u32 bytesRead = static_cast<u32>(m_File.gcount());
+
+		m_Remaining -= bytesRead;
+		return bytesRead;
+	}
+
+	void WavStream::Rewind()
+	{
+		m_File.clear();
+		m_File.seekg(m_DataOffset);
+		m_Remaining = m_Format.Size;
+	}
+
+	void WavStream::Seek(double ms)
+	{
+		const u32 frameSize = m_Format.Channels * (m_Format.BitRate / 8);
+		const u32 frame = static_cast<u32>(fmod(ms, m_Format.Length) * 0.001 * m_Format.FreqRate);
+		const u32 offset = std::min(frame * frameSize, m_Format.Size);
+
+		m_File.clear();
+		m_File.seekg(m_DataOffset + offset);
+		m_Remaining = m_Format.Size - offset;
+	}
+}
\ No newline at end of file
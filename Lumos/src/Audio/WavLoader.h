@@ -2,6 +2,7 @@
 
 #include "lmpch.h"
 #include "AudioData.h"
+#include "AudioStream.h"
 
 namespace Lumos
 {
@@ -43,5 +44,21 @@ namespace Lumos
 	AudioData LoadWav(const String& fileName);
 
 	void LoadWAVChunkInfo(std::ifstream &file, String &name, unsigned int &size);
+
+	class WavStream : public AudioStream
+	{
+	public:
+		WavStream(const String& fileName);
+		~WavStream() = default;
+
+		u32 Read(u8* buffer, u32 size) override;
+		void Rewind() override;
+		void Seek(double ms) override;
+
+	private:
+		std::ifstream m_File;
+		std::streamoff m_DataOffset = 0;
+		u32 m_Remaining = 0;
+	};
 	
 }
\ No newline at end of file
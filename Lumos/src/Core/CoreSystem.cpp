@@ -34,6 +34,7 @@ namespace Lumos
 		Debug::Log::Info("Shutting down System");
         Profiler::Release();
 		LuaManager::Release();
+		System::JobSystem::OnShutdown();
 		VFS::OnShutdown();
 		Lumos::Memory::LogMemoryInformation();
 
@@ -55,6 +55,29 @@ namespace Lumos
                 return result;
             }
 
+            // Get the oldest item matching pred, the items queued before it keep their order
+            //	Returns false if no item matches
+            template <typename Pred>
+            _FORCE_INLINE_ bool pop_first(T& item, Pred pred)
+            {
+                bool result = false;
+                lock.lock();
+                for (size_t i = tail; i != head; i = (i + 1) % capacity)
+                {
+                    if (!pred(data[i]))
+                        continue;
+
+                    item = std::move(data[i]);
+                    for (size_t j = i; j != tail; j = (j + capacity - 1) % capacity)
+                        data[j] = std::move(data[(j + capacity - 1) % capacity]);
+                    tail = (tail + 1) % capacity;
+                    result = true;
+                    break;
+                }
+                lock.unlock();
+                return result;
+            }
+
         private:
             T data[capacity];
             size_t head = 0;
@@ -64,16 +87,53 @@ namespace Lumos
 
         namespace JobSystem
         {
+            struct Job
+            {
+                std::function<void()> function;
+                Context* context = nullptr;
+            };
+
             uint32_t numThreads = 0;
-            ThreadSafeRingBuffer<std::function<void()>, 256> jobPool;
+            ThreadSafeRingBuffer<Job, 256> jobPool;
             std::condition_variable wakeCondition;
             std::mutex wakeMutex;
-            uint64_t currentLabel = 0;
-            std::atomic<uint64_t> finishedLabel;
+            Context defaultContext;
+            std::vector<std::thread> workers;
+            bool stopping = false; // guarded by wakeMutex
+
+            // Jobs this thread is running inside Wait or Push, nested on its stack
+            thread_local uint32_t waitDepth = 0;
+
+            _FORCE_INLINE_ bool RunNextJob()
+            {
+                Job job;
+                if (!jobPool.pop_front(job))
+                    return false;
+
+                job.function(); // execute job
+                job.context->counter.fetch_sub(1); // update the owner's label state
+                return true;
+            }
+
+            // Runs a queued job of context on the waiting thread. Those are the caller's own children, so the
+            // jobs nested on one stack always depend on the ones below them and never the other way round.
+            _FORCE_INLINE_ bool RunContextJob(const Context* context)
+            {
+                Job job;
+                if (!jobPool.pop_first(job, [context](const Job& queued) { return queued.context == context; }))
+                    return false;
+
+                LUMOS_ASSERT(waitDepth < MaxWaitDepth, "Jobs waiting on jobs nested too deep");
+
+                waitDepth++;
+                job.function();
+                job.context->counter.fetch_sub(1);
+                waitDepth--;
+                return true;
+            }
 
             void OnInit()
             {
-                finishedLabel.store(0);
 
                 // Retrieve the number of hardware threads in this System:
                 auto numCores = std::thread::hardware_concurrency();
@@ -85,19 +145,14 @@ namespace Lumos
                 {
                     std::thread worker([] {
 
-                        std::function<void()> job;
-
                         while (true)
                         {
-                            if (jobPool.pop_front(job))
-                            {
-                                job(); // execute job
-                                finishedLabel.fetch_add(1); // update worker label state
-                            }
-                            else
+                            if (!RunNextJob())
                             {
                                 // no job, put thread to sleep
                                 std::unique_lock<std::mutex> lock(wakeMutex);
+                                if (stopping)
+                                    break;
                                 wakeCondition.wait(lock);
                             }
                         }
@@ -119,12 +174,27 @@ namespace Lumos
                     LUMOS_ASSERT(SUCCEEDED(hr),"");
         #endif // LUMOS_PLATFORM_WINDOWS
 
-                    worker.detach();
+                    workers.push_back(std::move(worker));
                 }
 
                 LUMOS_LOG_INFO("Initialised JobSystem with [{0} cores] [{1} threads]" ,numCores, numThreads);
             }
 
+            void OnShutdown()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                    stopping = true;
+                }
+                wakeCondition.notify_all();
+
+                for (auto& worker : workers)
+                    worker.join();
+
+                workers.clear();
+                stopping = false;
+            }
+
             // This little function will not let the System to be deadlocked while the main thread is waiting for something
             _FORCE_INLINE_ void poll()
             {
@@ -137,18 +207,38 @@ namespace Lumos
                 return numThreads;
             }
 
+            // Runs a queued job of the same context while the pool is full rather than only waiting for the workers to drain it
+            _FORCE_INLINE_ void Push(const Job& job)
+            {
+                while (!jobPool.push_back(job))
+                {
+                    if (!RunContextJob(job.context))
+                        poll();
+                }
+            }
+
             void Execute(const std::function<void()>& job)
             {
-                // The main thread label state is updated:
-                currentLabel += 1;
+                Execute(defaultContext, job);
+            }
+
+            void Execute(Context& context, const std::function<void()>& job)
+            {
+                // The context label state is updated:
+                context.counter.fetch_add(1);
 
                 // Try to push a new job until it is pushed successfully:
-                while (!jobPool.push_back(job)) { poll(); }
+                Push({ job, &context });
 
                 wakeCondition.notify_one(); // wake one thread
             }
 
             void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
+            {
+                Dispatch(defaultContext, jobCount, groupSize, job);
+            }
+
+            void Dispatch(Context& context, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job)
             {
                 if (jobCount == 0 || groupSize == 0)
                 {
@@ -158,8 +248,8 @@ namespace Lumos
                 // Calculate the amount of job groups to dispatch (overestimate, or "ceil"):
                 const uint32_t groupCount = (jobCount + groupSize - 1) / groupSize;
 
-                // The main thread label state is updated:
-                currentLabel += groupCount;
+                // The context label state is updated:
+                context.counter.fetch_add(groupCount);
 
                 for (uint32_t groupIndex = 0; groupIndex < groupCount; ++groupIndex)
                 {
@@ -182,7 +272,7 @@ namespace Lumos
                     };
 
                     // Try to push a new job until it is pushed successfully:
-                    while (!jobPool.push_back(jobGroup)) { poll(); }
+                    Push({ jobGroup, &context });
 
                     wakeCondition.notify_one(); // wake one thread
                 }
@@ -192,13 +282,28 @@ namespace Lumos
 
             bool IsBusy()
             {
-                // Whenever the main thread label is not reached by the workers, it indicates that some worker is still alive
-                return finishedLabel.load() < currentLabel;
+                return IsBusy(defaultContext);
+            }
+
+            bool IsBusy(const Context& context)
+            {
+                // Whenever the context label is not reached by the workers, it indicates that some worker is still alive
+                return context.counter.load() > 0;
             }
 
             void Wait()
             {
-                while (IsBusy()) { poll(); }
+                Wait(defaultContext);
+            }
+
+            void Wait(const Context& context)
+            {
+                // Help with the context's queued jobs, a worker waiting on its own jobs would otherwise deadlock once every worker waits
+                while (IsBusy(context))
+                {
+                    if (!RunContextJob(&context))
+                        poll();
+                }
             }
         }
     }
@@ -1,6 +1,8 @@
 #pragma once
 #include "lmpch.h"
 
+#include <atomic>
+
 struct JobDispatchArgs
 {
 	uint32_t jobIndex;
@@ -13,24 +15,43 @@ namespace Lumos
     {
         namespace JobSystem
         {
+            // Tracks a set of jobs so they can be waited on without waiting for every other job in flight
+            struct Context
+            {
+                std::atomic<uint32_t> counter { 0 };
+            };
+
             void OnInit();
 
+            // Stops the worker threads once the jobs already queued have run
+            void OnShutdown();
+
             uint32_t GetThreadCount();
 
             // Add a job to execute asynchronously. Any idle thread will execute this job.
             void Execute(const std::function<void()>& job);
+            void Execute(Context& context, const std::function<void()>& job);
 
             // Divide a job onto multiple jobs and execute in parallel.
             //	jobCount	: how many jobs to generate for this task.
             //	groupSize	: how many jobs to execute per thread. Jobs inside a group execute serially. It might be worth to increase for small jobs
             //	func		: receives a JobDispatchArgs as parameter
             void Dispatch(uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job);
+            void Dispatch(Context& context, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& job);
 
             // Check if any threads are working currently or not
             bool IsBusy();
+            bool IsBusy(const Context& context);
 
             // Wait until all threads become idle
+            // The waiting thread runs the context's queued jobs inline meanwhile, so jobs can wait on the jobs they
+            // dispatch. Only that context's jobs, an unrelated job run inline could itself be waiting on a job
+            // further down another thread's stack. Each nested wait adds a job to the stack, nesting deeper than
+            // MaxWaitDepth asserts.
+            static const uint32_t MaxWaitDepth = 16;
+
             void Wait();
+            void Wait(const Context& context);
         }
     }
 }
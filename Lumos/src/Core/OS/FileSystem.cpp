@@ -8,6 +8,6 @@ namespace Lumos
 	i64 (*FileSystem::GetFileSizeFunc)(const String&) = NULL;
 	u8* (*FileSystem::ReadFileFunc)(const String&) = NULL;
 	bool (*FileSystem::ReadFileBufferFunc)(const String&, void*, i64) = NULL;
-    bool (*FileSystem::WriteFileFunc)(const String&, u8*) = NULL;
+    bool (*FileSystem::WriteFileFunc)(const String&, u8*, u32) = NULL;
 	bool (*FileSystem::WriteTextFileFunc)(const String&, const String&) = NULL;
 }
@@ -9,12 +9,14 @@ namespace Lumos
 		static bool FileExists(const String& path);
 		static bool FolderExists(const String& path);
 		static i64 GetFileSize(const String& path);
+		// Last write time in platform specific units, only meant for comparing against an earlier value. 0 if the file doesn't exist
+		static i64 GetModifiedTime(const String& path);
 
 		static u8* ReadFile(const String& path);
 		static bool ReadFile(const String& path, void* buffer, i64 size = -1);
 		static String ReadTextFile(const String& path);
 
-		static bool WriteFile(const String& path, u8* buffer);
+		static bool WriteFile(const String& path, u8* buffer, u32 size);
 		static bool WriteTextFile(const String& path, const String& text);
         
         static bool IsRelativePath(const char *path)
@@ -51,7 +53,7 @@ namespace Lumos
 		static bool (*ReadFileBufferFunc)(const String&, void*, i64);
 		static String (*ReadTextFileFunc)(const String&);
 
-		static bool (*WriteFileFunc)(const String&, u8*);
+		static bool (*WriteFileFunc)(const String&, u8*, u32);
 		static bool (*WriteTextFileFunc)(const String&, const String&);
 	};
 
@@ -19,6 +19,7 @@ namespace Lumos
 		bool ShowConsole = true;
 		String Title;
         int RenderAPI;
+        int AudioBackend = 0;
         String FilePath;
 
 	};
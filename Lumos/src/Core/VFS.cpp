@@ -75,11 +75,11 @@ namespace Lumos
 		return ResolvePhysicalPath(path, physicalPath) ? FileSystem::ReadTextFile(physicalPath) : nullptr;
 	}
 
-	bool VFS::WriteFile(const String& path, u8* buffer)
+	bool VFS::WriteFile(const String& path, u8* buffer, u32 size)
 	{
 		LUMOS_ASSERT(s_Instance,"");
 		String physicalPath;
-		return ResolvePhysicalPath(path, physicalPath) ? FileSystem::WriteFile(physicalPath, buffer) : false;
+		return ResolvePhysicalPath(path, physicalPath) ? FileSystem::WriteFile(physicalPath, buffer, size) : false;
 
 	}
 
@@ -18,7 +18,7 @@ namespace Lumos
 		u8* ReadFile(const String& path);
 		String ReadTextFile(const String& path);
 
-		bool WriteFile(const String& path, u8* buffer);
+		bool WriteFile(const String& path, u8* buffer, u32 size);
 		bool WriteTextFile(const String& path, const String& text);
 	public:
 		static void OnInit();
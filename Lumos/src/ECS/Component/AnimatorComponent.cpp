@@ -0,0 +1,20 @@
+#include "lmpch.h"
+#include "AnimatorComponent.h"
+
+namespace Lumos
+{
+	AnimatorComponent::AnimatorComponent()
+	{
+	}
+
+	AnimatorComponent::AnimatorComponent(const Ref<Graphics::Animator>& animator)
+		: m_Animator(animator)
+	{
+	}
+
+	void AnimatorComponent::OnImGui()
+	{
+		if (m_Animator)
+			m_Animator->OnImGui();
+	}
+}
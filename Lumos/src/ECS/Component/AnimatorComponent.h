@@ -0,0 +1,21 @@
+#pragma once
+#include "lmpch.h"
+#include "Graphics/Animation/Animator.h"
+
+namespace Lumos
+{
+	// Plays animations on a skeleton and skins the meshes bound to it, updated by the AnimationManager
+	class LUMOS_EXPORT AnimatorComponent
+	{
+	public:
+		AnimatorComponent();
+		explicit AnimatorComponent(const Ref<Graphics::Animator>& animator);
+
+		void OnImGui();
+
+		const Ref<Graphics::Animator>& GetAnimator() const { return m_Animator; }
+
+	private:
+		Ref<Graphics::Animator> m_Animator;
+	};
+}
@@ -10,3 +10,6 @@
 #include "AIComponent.h"
 #include "ParticleComponent.h"
 #include "MaterialComponent.h"
+#include "TerrainComponent.h"
+#include "AnimatorComponent.h"
+#include "OccluderComponent.h"
@@ -17,6 +17,21 @@ namespace Lumos
         m_Mesh = Lumos::Ref<Graphics::Mesh>(mesh);
 	}
 
+	MeshComponent::MeshComponent(Graphics::PrimitiveType primitive)
+		: m_Mesh(Graphics::CreatePrimative(primitive))
+		, m_PrimitiveType(primitive)
+		, m_IsPrimitive(true)
+	{
+	}
+
+	void MeshComponent::SetPrimitive(Graphics::PrimitiveType primitive)
+	{
+		m_Mesh = Ref<Graphics::Mesh>(Graphics::CreatePrimative(primitive));
+		m_PrimitiveType = primitive;
+		m_IsPrimitive = true;
+		m_FilePath.clear();
+	}
+
 	void MeshComponent::OnImGui()
 	{
 		
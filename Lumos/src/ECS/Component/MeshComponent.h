@@ -13,25 +13,34 @@ namespace Lumos
         MeshComponent();
 		explicit MeshComponent(const Ref<Graphics::Mesh>& mesh);
 		explicit MeshComponent(Graphics::Mesh* mesh);
+		explicit MeshComponent(Graphics::PrimitiveType primitive);
 		~MeshComponent() = default;
 
 		void OnImGui();
 
 		Graphics::Mesh* GetMesh() const { return m_Mesh.get(); }
         void SetMesh(Graphics::Mesh* mesh) { m_Mesh = Ref<Graphics::Mesh>(mesh); }
+        void SetPrimitive(Graphics::PrimitiveType primitive);
 
 		bool& GetActive() { return m_Mesh->GetActive(); }
 
 		nlohmann::json Serialise() { return nullptr; };
 		void Deserialise(nlohmann::json& data) {};
         
+        // Where the mesh was loaded from, scene snapshots save this instead of the mesh data
+        void SetSource(const String& filePath, u32 subMeshIndex) { m_FilePath = filePath; m_SubMeshIndex = subMeshIndex; m_IsPrimitive = false; }
+
         const String& GetFilePath() const { return m_FilePath; }
+        u32 GetSubMeshIndex() const { return m_SubMeshIndex; }
         const Graphics::PrimitiveType& GetPrimitiveType() const { return m_PrimitiveType; }
+        bool IsPrimitive() const { return m_IsPrimitive; }
 
 	private:
 		Ref<Graphics::Mesh> m_Mesh;
 
-        Graphics::PrimitiveType m_PrimitiveType;
+        Graphics::PrimitiveType m_PrimitiveType = Graphics::PrimitiveType::Cube;
         String m_FilePath;
+        u32 m_SubMeshIndex = 0;
+        bool m_IsPrimitive = false;
 	};
 }
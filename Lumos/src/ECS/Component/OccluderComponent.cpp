@@ -0,0 +1,84 @@
+#include "lmpch.h"
+#include "OccluderComponent.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	OccluderComponent::OccluderComponent()
+	{
+	}
+
+	OccluderComponent::OccluderComponent(const Maths::Vector3* positions, u32 positionCount, const u32* indices, u32 indexCount)
+		: m_Positions(positions, positions + positionCount)
+		, m_Indices(indices, indices + indexCount - indexCount % 3)
+	{
+		m_BoundingBox.Merge(positions, positionCount);
+		BuildAdjacency();
+	}
+
+	OccluderComponent::OccluderComponent(const Maths::BoundingBox& box)
+		: m_BoundingBox(box)
+	{
+		const Maths::Vector3& min = box.min_;
+		const Maths::Vector3& max = box.max_;
+
+		m_Positions =
+		{
+			Maths::Vector3(min.x, min.y, min.z), Maths::Vector3(max.x, min.y, min.z),
+			Maths::Vector3(max.x, max.y, min.z), Maths::Vector3(min.x, max.y, min.z),
+			Maths::Vector3(min.x, min.y, max.z), Maths::Vector3(max.x, min.y, max.z),
+			Maths::Vector3(max.x, max.y, max.z), Maths::Vector3(min.x, max.y, max.z)
+		};
+
+		m_Indices =
+		{
+			0, 2, 1, 0, 3, 2,
+			4, 5, 6, 4, 6, 7,
+			0, 1, 5, 0, 5, 4,
+			3, 7, 6, 3, 6, 2,
+			0, 4, 7, 0, 7, 3,
+			1, 2, 6, 1, 6, 5
+		};
+
+		BuildAdjacency();
+	}
+
+	void OccluderComponent::BuildAdjacency()
+	{
+		const u32 triangleCount = GetTriangleCount();
+		m_Adjacency.assign(triangleCount * 3, ~0u);
+
+		// Imported meshes split vertices on seams, weld them so those edges aren't seen as open
+		std::unordered_map<Maths::Vector3, u32> welded;
+		std::vector<u32> weld(m_Positions.size());
+		for (size_t i = 0; i < m_Positions.size(); i++)
+			weld[i] = welded.emplace(m_Positions[i], static_cast<u32>(welded.size())).first->second;
+
+		std::unordered_map<u64, u32> edges;
+		for (u32 triangle = 0; triangle < triangleCount; triangle++)
+		{
+			for (u32 edge = 0; edge < 3; edge++)
+			{
+				const u32 a = weld[m_Indices[triangle * 3 + edge]];
+				const u32 b = weld[m_Indices[triangle * 3 + (edge + 1) % 3]];
+				const u64 key = (static_cast<u64>(Maths::Min(a, b)) << 32) | Maths::Max(a, b);
+
+				auto shared = edges.find(key);
+				if (shared == edges.end())
+					edges[key] = triangle * 3 + edge;
+				else if (m_Adjacency[shared->second] == ~0u)
+				{
+					m_Adjacency[shared->second] = triangle;
+					m_Adjacency[triangle * 3 + edge] = shared->second / 3;
+				}
+			}
+		}
+	}
+
+	void OccluderComponent::OnImGui()
+	{
+		ImGui::Checkbox("Active", &m_Active);
+		ImGui::Text("Triangles : %u", GetTriangleCount());
+	}
+}
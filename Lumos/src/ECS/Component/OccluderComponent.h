@@ -0,0 +1,39 @@
+#pragma once
+#include "lmpch.h"
+#include "Maths/Maths.h"
+
+namespace Lumos
+{
+	// Marks an entity as an occluder for the OcclusionCuller. Holds its own low poly geometry in the
+	// entity's local space, which has to stay inside the rendered surface (a wall's inner box, not its hull).
+	class LUMOS_EXPORT OccluderComponent
+	{
+	public:
+		OccluderComponent();
+		OccluderComponent(const Maths::Vector3* positions, u32 positionCount, const u32* indices, u32 indexCount);
+
+		// Twelve triangles filling box, for walls, floors and buildings that fill their bounds
+		explicit OccluderComponent(const Maths::BoundingBox& box);
+
+		void OnImGui();
+
+		const std::vector<Maths::Vector3>& GetPositions() const { return m_Positions; }
+		const std::vector<u32>& GetIndices() const { return m_Indices; }
+		const Maths::BoundingBox& GetBoundingBox() const { return m_BoundingBox; }
+
+		// Triangle across each edge of each triangle (~0u on open edges), matched by position
+		const std::vector<u32>& GetAdjacency() const { return m_Adjacency; }
+		u32 GetTriangleCount() const { return static_cast<u32>(m_Indices.size() / 3); }
+
+		bool& GetActive() { return m_Active; }
+
+	private:
+		void BuildAdjacency();
+
+		std::vector<Maths::Vector3> m_Positions;
+		std::vector<u32> m_Indices;
+		std::vector<u32> m_Adjacency;
+		Maths::BoundingBox m_BoundingBox;
+		bool m_Active = true;
+	};
+}
@@ -6,6 +6,7 @@
 namespace Lumos
 {
     ParticleComponent::ParticleComponent()
+		: m_PositionOffset(Maths::Vector3(0.0f, 0.0f, 0.0f))
     {
     }
     
@@ -20,5 +21,9 @@ namespace Lumos
 
 	void ParticleComponent::OnImGui()
 	{
+		ImGui::DragFloat3("Position Offset", &m_PositionOffset.x, 0.01f);
+
+		if (m_ParticleEmitter)
+			m_ParticleEmitter->OnImGui();
 	}
 }
@@ -16,6 +16,10 @@ namespace Lumos
 
 		void OnImGui();
 
+		Ref<ParticleEmitter>& GetParticleEmitter() { return m_ParticleEmitter; }
+		const Maths::Vector3& GetPositionOffset() const { return m_PositionOffset; }
+		void SetPositionOffset(const Maths::Vector3& offset) { m_PositionOffset = offset; }
+
     private:
         Ref<ParticleEmitter> m_ParticleEmitter;
         Maths::Vector3 m_PositionOffset;
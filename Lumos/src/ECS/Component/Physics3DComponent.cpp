@@ -38,6 +38,7 @@ namespace Lumos
         auto friction = m_PhysicsObject->GetFriction();
         auto isStatic = m_PhysicsObject->GetIsStatic();
         auto isRest = m_PhysicsObject->GetIsAtRest();
+        auto continuous = m_PhysicsObject->GetContinuousCollision();
         auto mass = 1.0f / m_PhysicsObject->GetInverseMass();
         auto velocity = m_PhysicsObject->GetLinearVelocity();
         auto elasticity = m_PhysicsObject->GetElasticity();
@@ -133,6 +134,16 @@ namespace Lumos
         ImGui::NextColumn();
 			
 
+        ImGui::AlignTextToFramePadding();
+        ImGui::TextUnformatted("Continuous Collision");
+        ImGui::NextColumn();
+        ImGui::PushItemWidth(-1);
+        if(ImGui::Checkbox("##Continuous Collision", &continuous))
+            m_PhysicsObject->SetContinuousCollision(continuous);
+
+        ImGui::PopItemWidth();
+        ImGui::NextColumn();
+
         ImGui::AlignTextToFramePadding();
         ImGui::TextUnformatted("At Rest");
         ImGui::NextColumn();
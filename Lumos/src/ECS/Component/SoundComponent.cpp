@@ -32,6 +32,7 @@ namespace Lumos
 		auto paused = m_SoundNode->GetPaused();
 		auto pitch = m_SoundNode->GetPitch();
 		auto referenceDistance = m_SoundNode->GetReferenceDistance();
+		auto priority = m_SoundNode->GetPriority();
 
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2,2));
         ImGui::Columns(2);
@@ -77,6 +78,22 @@ namespace Lumos
         ImGui::PopItemWidth();
         ImGui::NextColumn();
             
+        ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Priority");
+        ImGui::NextColumn();
+        ImGui::PushItemWidth(-1);
+        if(ImGui::DragFloat("##Priority", &priority, 0.1f, 0.0f, 100.0f))
+            m_SoundNode->SetPriority(priority);
+            
+        ImGui::PopItemWidth();
+        ImGui::NextColumn();
+            
+        ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Voice");
+        ImGui::NextColumn();
+        ImGui::TextUnformatted(m_SoundNode->IsVirtual() ? "Virtual" : "Real");
+        ImGui::NextColumn();
+            
         ImGui::AlignTextToFramePadding();
 		ImGui::TextUnformatted("Paused");
         ImGui::NextColumn();
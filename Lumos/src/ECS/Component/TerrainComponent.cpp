@@ -0,0 +1,20 @@
+#include "lmpch.h"
+#include "TerrainComponent.h"
+
+namespace Lumos
+{
+	TerrainComponent::TerrainComponent()
+	{
+	}
+
+	TerrainComponent::TerrainComponent(const Ref<ChunkedTerrain>& terrain)
+		: m_Terrain(terrain)
+	{
+	}
+
+	void TerrainComponent::OnImGui()
+	{
+		if (m_Terrain)
+			m_Terrain->OnImGui();
+	}
+}
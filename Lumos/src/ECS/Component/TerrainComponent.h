@@ -0,0 +1,21 @@
+#pragma once
+#include "lmpch.h"
+#include "Graphics/ChunkedTerrain.h"
+
+namespace Lumos
+{
+	// Streams a ChunkedTerrain around the camera, its tiles are created as children of this entity
+	class LUMOS_EXPORT TerrainComponent
+	{
+	public:
+		TerrainComponent();
+		explicit TerrainComponent(const Ref<ChunkedTerrain>& terrain);
+
+		void OnImGui();
+
+		const Ref<ChunkedTerrain>& GetTerrain() const { return m_Terrain; }
+
+	private:
+		Ref<ChunkedTerrain> m_Terrain;
+	};
+}
@@ -6,6 +6,49 @@ namespace Lumos
 {
 	class TimeStep;
 
+	// What a system touches during OnUpdate. Components and resources are identified by type, so any
+	// type can stand for a resource (e.g. the system itself or a world it owns). SystemManager orders
+	// two systems when one writes something the other reads or writes, and runs the rest concurrently.
+	class LUMOS_EXPORT SystemAccess
+	{
+	public:
+		template<typename T>
+		SystemAccess& Read() { m_Reads.push_back(typeid(T).hash_code()); return *this; }
+
+		template<typename T>
+		SystemAccess& Write() { m_Writes.push_back(typeid(T).hash_code()); return *this; }
+
+		// Run before / after the system registered as T, whether or not their access conflicts
+		template<typename T>
+		SystemAccess& Before() { m_Before.push_back(typeid(T).hash_code()); return *this; }
+
+		template<typename T>
+		SystemAccess& After() { m_After.push_back(typeid(T).hash_code()); return *this; }
+
+		// Never run on a job system thread (e.g. uses the graphics context)
+		SystemAccess& MainThread() { m_MainThread = true; return *this; }
+
+		// Conflicts with every other system and runs on the main thread
+		SystemAccess& Exclusive() { m_Exclusive = m_MainThread = true; return *this; }
+
+		bool Conflicts(const SystemAccess& other) const;
+
+		const std::vector<size_t>& GetReads() const { return m_Reads; }
+		const std::vector<size_t>& GetWrites() const { return m_Writes; }
+		const std::vector<size_t>& GetBefore() const { return m_Before; }
+		const std::vector<size_t>& GetAfter() const { return m_After; }
+		bool IsMainThread() const { return m_MainThread; }
+		bool IsExclusive() const { return m_Exclusive; }
+
+	private:
+		std::vector<size_t> m_Reads;
+		std::vector<size_t> m_Writes;
+		std::vector<size_t> m_Before;
+		std::vector<size_t> m_After;
+		bool m_MainThread = false;
+		bool m_Exclusive = false;
+	};
+
 	class LUMOS_EXPORT ISystem
 	{
 	public:
@@ -16,6 +59,9 @@ namespace Lumos
 		virtual void OnUpdate(const TimeStep& dt, Scene* scene) = 0;
 		virtual void OnImGui() = 0;
 		virtual void OnDebugDraw() = 0;
+
+		// Called once when registered. Systems that declare nothing run alone on the main thread.
+		virtual void DeclareAccess(SystemAccess& access) { access.Exclusive(); }
         
         _FORCE_INLINE_ const String& GetName() const { return m_DebugName; }
 
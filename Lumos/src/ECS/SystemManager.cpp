@@ -0,0 +1,425 @@
+#include "lmpch.h"
+#include "SystemManager.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	static bool Contains(const std::vector<size_t>& types, size_t type)
+	{
+		return std::find(types.begin(), types.end(), type) != types.end();
+	}
+
+	bool SystemAccess::Conflicts(const SystemAccess& other) const
+	{
+		if (m_Exclusive || other.m_Exclusive)
+			return true;
+
+		for (auto type : m_Writes)
+		{
+			if (Contains(other.m_Reads, type) || Contains(other.m_Writes, type))
+				return true;
+		}
+
+		for (auto type : other.m_Writes)
+		{
+			if (Contains(m_Reads, type))
+				return true;
+		}
+
+		return false;
+	}
+
+	void SystemManager::AddSystem(size_t type, const Ref<ISystem>& system)
+	{
+		SystemNode node;
+		node.type = type;
+		node.system = system;
+		system->DeclareAccess(node.access);
+
+		m_Systems.emplace_back(std::move(node));
+		m_GraphDirty = true;
+	}
+
+	ISystem* SystemManager::FindSystem(size_t type) const
+	{
+		for (auto& node : m_Systems)
+		{
+			if (node.type == type)
+				return node.system.get();
+		}
+
+		return nullptr;
+	}
+
+	void SystemManager::BuildGraph()
+	{
+		const u32 count = static_cast<u32>(m_Systems.size());
+
+		auto indexOf = [this, count](size_t type) -> u32
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				if (m_Systems[i].type == type)
+					return i;
+			}
+			return count;
+		};
+
+		// edges[from * count + to]
+		std::vector<u8> edges(count * count, 0);
+		for (u32 i = 0; i < count; i++)
+		{
+			for (auto type : m_Systems[i].access.GetBefore())
+			{
+				const u32 other = indexOf(type);
+				if (other < count && other != i)
+					edges[i * count + other] = 1;
+			}
+
+			for (auto type : m_Systems[i].access.GetAfter())
+			{
+				const u32 other = indexOf(type);
+				if (other < count && other != i)
+					edges[other * count + i] = 1;
+			}
+		}
+
+		// Constraints are closed transitively so a conflict never gets ordered against one indirectly
+		std::vector<u8> constraints = edges;
+		for (u32 k = 0; k < count; k++)
+			for (u32 i = 0; i < count; i++)
+				for (u32 j = 0; j < count; j++)
+					constraints[i * count + j] |= constraints[i * count + k] & constraints[k * count + j];
+
+		for (u32 i = 0; i < count; i++)
+		{
+			if (constraints[i * count + i])
+			{
+				LUMOS_LOG_ERROR("System Before / After constraints form a cycle, ignoring them");
+				std::fill(edges.begin(), edges.end(), 0);
+				std::fill(constraints.begin(), constraints.end(), 0);
+				break;
+			}
+		}
+
+		// Conflicting systems keep their registration order unless a constraint says otherwise
+		std::vector<u8> graph = edges;
+		for (u32 i = 0; i < count; i++)
+		{
+			for (u32 j = i + 1; j < count; j++)
+			{
+				if (!m_Systems[i].access.Conflicts(m_Systems[j].access))
+					continue;
+
+				if (constraints[j * count + i])
+					graph[j * count + i] = 1;
+				else
+					graph[i * count + j] = 1;
+			}
+		}
+
+		// Kahn's algorithm, always taking the earliest registered ready system so the order is stable
+		auto sort = [this, count](const std::vector<u8>& graph)
+		{
+			std::vector<u32> incoming(count, 0);
+			for (u32 from = 0; from < count; from++)
+				for (u32 to = 0; to < count; to++)
+					incoming[to] += graph[from * count + to];
+
+			m_Order.clear();
+			std::vector<bool> placed(count, false);
+			for (u32 step = 0; step < count; step++)
+			{
+				u32 next = count;
+				for (u32 i = 0; i < count && next == count; i++)
+				{
+					if (!placed[i] && incoming[i] == 0)
+						next = i;
+				}
+
+				if (next == count)
+					return false;
+
+				placed[next] = true;
+				m_Order.push_back(next);
+				for (u32 to = 0; to < count; to++)
+					incoming[to] -= graph[next * count + to];
+			}
+
+			return true;
+		};
+
+		if (!sort(graph))
+		{
+			// A constraint reverses a chain of conflicts, so the conflicts follow the constraints' order instead
+			sort(edges);
+			std::fill(graph.begin(), graph.end(), 0);
+			for (u32 a = 0; a < count; a++)
+			{
+				for (u32 b = a + 1; b < count; b++)
+				{
+					const u32 from = m_Order[a];
+					const u32 to = m_Order[b];
+					if (edges[from * count + to] || m_Systems[from].access.Conflicts(m_Systems[to].access))
+						graph[from * count + to] = 1;
+				}
+			}
+		}
+
+		for (auto& node : m_Systems)
+		{
+			node.successors.clear();
+			node.predecessorCount = 0;
+		}
+
+		for (auto from : m_Order)
+		{
+			for (auto to : m_Order)
+			{
+				if (graph[from * count + to])
+				{
+					m_Systems[from].successors.push_back(to);
+					m_Systems[to].predecessorCount++;
+				}
+			}
+		}
+
+		m_Pending = std::vector<std::atomic<u32>>(count);
+		m_GraphDirty = false;
+		m_RunSerial = true;
+	}
+
+	std::vector<ISystem*> SystemManager::GetUpdateOrder()
+	{
+		if (m_GraphDirty)
+			BuildGraph();
+
+		std::vector<ISystem*> systems;
+		for (auto index : m_Order)
+			systems.push_back(m_Systems[index].system.get());
+		return systems;
+	}
+
+	bool SystemManager::RunsBefore(size_t first, size_t second)
+	{
+		if (m_GraphDirty)
+			BuildGraph();
+
+		const u32 count = static_cast<u32>(m_Systems.size());
+		u32 from = count, to = count;
+		for (u32 i = 0; i < count; i++)
+		{
+			if (m_Systems[i].type == first)
+				from = i;
+			if (m_Systems[i].type == second)
+				to = i;
+		}
+
+		if (from == count || to == count)
+			return false;
+
+		std::vector<bool> visited(count, false);
+		std::vector<u32> pending = { from };
+		while (!pending.empty())
+		{
+			const u32 index = pending.back();
+			pending.pop_back();
+
+			for (auto successor : m_Systems[index].successors)
+			{
+				if (successor == to)
+					return true;
+
+				if (!visited[successor])
+				{
+					visited[successor] = true;
+					pending.push_back(successor);
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void SystemManager::OnUpdate(const TimeStep& dt, Scene* scene)
+	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		if (m_GraphDirty)
+			BuildGraph();
+
+		if (scene != m_LastScene)
+		{
+			m_LastScene = scene;
+			m_RunSerial = true;
+		}
+
+		if (!m_Parallel || m_RunSerial || System::JobSystem::GetThreadCount() <= 1)
+			UpdateSerial(dt, scene);
+		else
+			UpdateParallel(dt, scene);
+
+		m_RunSerial = false;
+		m_UpdateTime = timer.GetMS(1000.0f);
+	}
+
+	void SystemManager::RunSystem(u32 index, const TimeStep& dt, Scene* scene)
+	{
+		auto& node = m_Systems[index];
+
+		Timer timer;
+		node.system->OnUpdate(dt, scene);
+		node.updateTime = timer.GetMS(1000.0f);
+	}
+
+	void SystemManager::UpdateSerial(const TimeStep& dt, Scene* scene)
+	{
+		for (auto index : m_Order)
+		{
+			RunSystem(index, dt, scene);
+			m_Systems[index].ranOnMainThread = true;
+		}
+	}
+
+	void SystemManager::Launch(u32 index, const TimeStep& dt, Scene* scene)
+	{
+		if (m_Systems[index].access.IsMainThread())
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+				m_MainThreadQueue.push_back(index);
+			}
+			m_MainThreadCondition.notify_one();
+			return;
+		}
+
+		System::JobSystem::Execute(m_Context, [this, index, &dt, scene]()
+		{
+			RunSystem(index, dt, scene);
+			m_Systems[index].ranOnMainThread = false;
+
+			for (auto successor : m_Systems[index].successors)
+			{
+				if (m_Pending[successor].fetch_sub(1) == 1)
+					Launch(successor, dt, scene);
+			}
+
+			// Taking the mutex orders the decrement before the main thread's check, so the wake isn't lost
+			if (m_Remaining.fetch_sub(1) == 1)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+				}
+				m_MainThreadCondition.notify_one();
+			}
+		});
+	}
+
+	void SystemManager::UpdateParallel(const TimeStep& dt, Scene* scene)
+	{
+		const u32 count = static_cast<u32>(m_Systems.size());
+
+		m_Remaining.store(count);
+		for (u32 i = 0; i < count; i++)
+			m_Pending[i].store(m_Systems[i].predecessorCount);
+
+		for (auto index : m_Order)
+		{
+			if (m_Systems[index].predecessorCount == 0)
+				Launch(index, dt, scene);
+		}
+
+		while (true)
+		{
+			// Main thread systems run here, lowest graph position first when several are ready.
+			// In between the thread sleeps until a job queues one or the last system finishes.
+			u32 index = count;
+			{
+				std::unique_lock<std::mutex> lock(m_MainThreadMutex);
+				m_MainThreadCondition.wait(lock, [this] { return !m_MainThreadQueue.empty() || m_Remaining.load() == 0; });
+
+				if (m_MainThreadQueue.empty())
+					break;
+
+				for (auto ordered : m_Order)
+				{
+					auto it = std::find(m_MainThreadQueue.begin(), m_MainThreadQueue.end(), ordered);
+					if (it != m_MainThreadQueue.end())
+					{
+						index = ordered;
+						m_MainThreadQueue.erase(it);
+						break;
+					}
+				}
+			}
+
+			RunSystem(index, dt, scene);
+			m_Systems[index].ranOnMainThread = true;
+
+			for (auto successor : m_Systems[index].successors)
+			{
+				if (m_Pending[successor].fetch_sub(1) == 1)
+					Launch(successor, dt, scene);
+			}
+
+			m_Remaining.fetch_sub(1);
+		}
+
+		// The last job may still be returning from its lambda
+		System::JobSystem::Wait(m_Context);
+	}
+
+	void SystemManager::OnImGui()
+	{
+		if (m_GraphDirty)
+			BuildGraph();
+
+		ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(2, 2));
+		ImGui::Columns(2);
+		ImGui::Separator();
+
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Parallel Update");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::Checkbox("##ParallelUpdate", &m_Parallel);
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Update Time");
+		ImGui::NextColumn();
+		ImGui::Text("%5.2f ms", m_UpdateTime);
+		ImGui::NextColumn();
+
+		for (auto index : m_Order)
+		{
+			auto& node = m_Systems[index];
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted(node.system->GetName().c_str());
+			ImGui::NextColumn();
+			ImGui::Text("%5.2f ms (%s)", node.updateTime, node.ranOnMainThread ? "main" : "worker");
+			ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+		ImGui::Separator();
+		ImGui::PopStyleVar();
+
+		for (auto index : m_Order)
+			m_Systems[index].system->OnImGui();
+	}
+
+	void SystemManager::OnDebugDraw()
+	{
+		if (m_GraphDirty)
+			BuildGraph();
+
+		for (auto index : m_Order)
+			m_Systems[index].system->OnDebugDraw();
+	}
+}
@@ -1,23 +1,31 @@
 #pragma once
 #include "ECS/ISystem.h"
 #include "Core/Typename.h"
+#include "Core/JobSystem.h"
+
+#include <condition_variable>
 
 namespace Lumos
 {
-    class SystemManager
+    // Owns the engine systems and updates them each frame. Systems are ordered from their declared
+    // access and Before / After constraints into a stable graph (ties keep registration order),
+    // and systems that do not depend on each other run concurrently on the job system.
+    class LUMOS_EXPORT SystemManager
     {
     public:
+        SystemManager() = default;
+        ~SystemManager() = default;
 
         template <typename T, typename ... Args>
         Ref<T> RegisterSystem(Args&& ...args)
         {
 			auto typeName = typeid(T).hash_code();
-            
-            LUMOS_ASSERT(m_Systems.find(typeName) == m_Systems.end(), "Registering system more than once.");
-            
+
+            LUMOS_ASSERT(FindSystem(typeName) == nullptr, "Registering system more than once.");
+
             // Create a pointer to the system and return it so it can be used externally
             Ref<T> system = CreateRef<T>(std::forward<Args>(args) ...);
-            m_Systems.insert({typeName, std::move( system) });
+            AddSystem(typeName, system);
             return system;
         }
 
@@ -26,11 +34,11 @@ namespace Lumos
 		{
 			auto typeName = typeid(T).hash_code();
 
-			LUMOS_ASSERT(m_Systems.find(typeName) == m_Systems.end(), "Registering system more than once.");
+			LUMOS_ASSERT(FindSystem(typeName) == nullptr, "Registering system more than once.");
 
 			// Create a pointer to the system and return it so it can be used externally
             Ref<T> system = Ref<T>(t);
-            m_Systems.insert({ typeName,std::move( system) });
+            AddSystem(typeName, system);
 			return system;
 		}
 
@@ -39,53 +47,91 @@ namespace Lumos
 		{
 			auto typeName = typeid(T).hash_code();
 
-			if (m_Systems.find(typeName) != m_Systems.end())
+			for (auto it = m_Systems.begin(); it != m_Systems.end(); ++it)
 			{
-				m_Systems.erase(typeName);
+				if (it->type == typeName)
+				{
+					m_Systems.erase(it);
+					m_GraphDirty = true;
+					break;
+				}
 			}
 		}
 
 		template<typename T>
 		T* GetSystem()
 		{
-			auto typeName = typeid(T).hash_code();
-
-			if (m_Systems.find(typeName) != m_Systems.end())
-			{
-				return dynamic_cast<T*>(m_Systems[typeName].get());
-			}
-
-			return nullptr;
+			auto system = FindSystem(typeid(T).hash_code());
+			return system ? dynamic_cast<T*>(system) : nullptr;
 		}
 
 		template<typename T>
-		T* HasSystem()
+		bool HasSystem()
 		{
-			auto typeName = typeid(T).hash_code();
-
-			return m_Systems.find(typeName) != m_Systems.end();
+			return FindSystem(typeid(T).hash_code()) != nullptr;
 		}
 
-		void OnUpdate(const TimeStep& dt, Scene* scene)
-		{
-			for (auto& system : m_Systems)
-				system.second->OnUpdate(dt, scene);
-		}
+		void OnUpdate(const TimeStep& dt, Scene* scene);
+		void OnImGui();
+		void OnDebugDraw();
 
-		void OnImGui()
-		{
-			for (auto& system : m_Systems)
-				system.second->OnImGui();
-		}
+		// Run every system on the calling thread in graph order
+		void SetParallel(bool parallel) { m_Parallel = parallel; }
+		bool GetParallel() const { return m_Parallel; }
+
+		float GetUpdateTime() const { return m_UpdateTime; }
 
-		void OnDebugDraw()
+		// Systems in graph order, the order a serial update runs them in
+		std::vector<ISystem*> GetUpdateOrder();
+
+		// Whether T has to finish before U starts, directly or through other systems
+		template<typename T, typename U>
+		bool RunsBefore()
 		{
-			for (auto& system : m_Systems)
-				system.second->OnDebugDraw();
+			return RunsBefore(typeid(T).hash_code(), typeid(U).hash_code());
 		}
 
     private:
-        // Map from system type string pointer to a system pointer
-        std::unordered_map<size_t, Ref<ISystem>> m_Systems;
+		struct SystemNode
+		{
+			size_t type;
+			Ref<ISystem> system;
+			SystemAccess access;
+			std::vector<u32> successors;
+			u32 predecessorCount = 0;
+			float updateTime = 0.0f;
+			bool ranOnMainThread = true;
+		};
+
+		void AddSystem(size_t type, const Ref<ISystem>& system);
+		ISystem* FindSystem(size_t type) const;
+
+		void BuildGraph();
+		bool RunsBefore(size_t first, size_t second);
+		void UpdateSerial(const TimeStep& dt, Scene* scene);
+		void UpdateParallel(const TimeStep& dt, Scene* scene);
+		void RunSystem(u32 index, const TimeStep& dt, Scene* scene);
+		void Launch(u32 index, const TimeStep& dt, Scene* scene);
+
+		// Kept in registration order
+		std::vector<SystemNode> m_Systems;
+		// Topological order used for serial updates, debug draw and ImGui
+		std::vector<u32> m_Order;
+		bool m_GraphDirty = true;
+		bool m_Parallel = true;
+
+		// Set when the graph or scene changes so entt creates its pools and groups before systems share the registry
+		bool m_RunSerial = true;
+		Scene* m_LastScene = nullptr;
+
+		System::JobSystem::Context m_Context;
+		std::vector<std::atomic<u32>> m_Pending;
+		std::atomic<u32> m_Remaining { 0 };
+		std::mutex m_MainThreadMutex;
+		std::vector<u32> m_MainThreadQueue;
+		// Wakes the main thread when a main thread system is queued or the last system finishes
+		std::condition_variable m_MainThreadCondition;
+
+		float m_UpdateTime = 0.0f;
     };
 }
@@ -9,6 +9,7 @@
 #include "Graphics/Layers/LayerStack.h"
 #include "Graphics/RenderManager.h"
 #include "Graphics/GBuffer.h"
+#include "Scripting/LuaManager.h"
 #include "ImGui/ImGuiHelpers.h"
 #include <imgui/imgui.h>
 
@@ -42,6 +43,12 @@ namespace Lumos
 					ImGui::TreePop();
 				}
 
+				if (ImGui::TreeNode("Scripts"))
+				{
+					LuaManager::Instance()->OnImGui();
+					ImGui::TreePop();
+				}
+
 				ImGui::NewLine();
 				ImGui::Text("FPS : %5.2i", Engine::Instance()->GetFPS());
 				ImGui::Text("UPS : %5.2i", Engine::Instance()->GetUPS());
@@ -73,13 +80,7 @@ namespace Lumos
 
 						ImGui::TreePop();
 					}
-					if (ImGui::TreeNode("Position Texture"))
-					{
-						ImGuiHelpers::Image(Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(Graphics::SCREENTEX_POSITION), Maths::Vector2(128.0f, 128.0f));
-						ImGuiHelpers::Tooltip(Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(Graphics::SCREENTEX_POSITION), Maths::Vector2(256.0f, 256.0f));
-
-						ImGui::TreePop();
-					}
+					ImGui::Text("Memory : %.2f MB", Application::Instance()->GetRenderManager()->GetGBuffer()->GetMemoryUsage() / (1024.0f * 1024.0f));
 					ImGui::TreePop();
 				}
 				ImGui::TreePop();
@@ -19,6 +19,7 @@
 #include "App/Engine.h"
 #include "App/Scene.h"
 #include "App/SceneManager.h"
+#include "App/SceneRaycast.h"
 #include "Events/ApplicationEvent.h"
 
 #include "ECS/Component/Components.h"
@@ -37,6 +38,7 @@
 #include "Graphics/Renderers/GridRenderer.h"
 #include "Graphics/Renderers/DebugRenderer.h"
 #include "Graphics/ModelLoader/ModelLoader.h"
+#include "Graphics/CookedTexture.h"
 #include "Graphics/Environment.h"
 
 #include "Utilities/AssetsManager.h"
@@ -51,6 +53,7 @@
 #include <IconFontCppHeaders/IconsFontAwesome5Brands.h>
 
 #include <imgui/plugins/ImFileBrowser.h>
+#include <unordered_set>
 
 static ImVec2 operator+(const ImVec2 &a, const ImVec2 &b) {
 	return ImVec2(a.x + b.x, a.y + b.y);
@@ -90,7 +93,7 @@ namespace Lumos
 
 		if (!fileFound)
 		{
-			FileSystem::WriteFile("editor.ini", nullptr);
+			FileSystem::WriteFile("editor.ini", nullptr, 0);
 			ImGui::GetIO().IniFilename = "editor.ini";
 		}
 #endif	
@@ -169,6 +172,11 @@ namespace Lumos
         return false;
     }
 
+    bool IsSnapshotFile(const String& filePath)
+    {
+        return StringFormat::GetFilePathExtension(filePath) == "lsnap";
+    }
+
 	void Editor::OnImGui()
 	{
 		LUMOS_PROFILE_FUNC;
@@ -222,6 +230,16 @@ namespace Lumos
                     m_FileBrowserWindow.Open();
                 }
 
+                if(ImGui::MenuItem("Save Snapshot"))
+                {
+                    auto scene = m_Application->GetSceneManager()->GetCurrentScene();
+                    SceneSnapshot snapshot;
+                    snapshot.Capture(scene->GetRegistry());
+                    String filePath = scene->GetSceneName() + ".lsnap";
+                    if(snapshot.Save(filePath))
+                        LUMOS_LOG_INFO("Saved {0} : {1} entities, {2} bytes, {3} ms", filePath, snapshot.GetEntityCount(), snapshot.GetSize(), snapshot.GetCaptureTime());
+                }
+
 				if (ImGui::BeginMenu("Style"))
 				{
 					if (ImGui::MenuItem("Dark", "")) { ImGuiHelpers::SetTheme(ImGuiHelpers::Dark); }
@@ -289,7 +307,7 @@ namespace Lumos
 				if (ImGui::MenuItem("Cube"))
 				{
 					auto entity = registry.create();
-					registry.emplace<MeshComponent>(entity, Graphics::CreatePrimative(Graphics::PrimitiveType::Cube));
+					registry.emplace<MeshComponent>(entity, Graphics::PrimitiveType::Cube);
 					registry.emplace<NameComponent>(entity, "Cube");
 					registry.emplace<Maths::Transform>(entity);
 				}
@@ -297,7 +315,7 @@ namespace Lumos
 				if (ImGui::MenuItem("Sphere"))
 				{
 					auto entity = registry.create();
-					registry.emplace<MeshComponent>(entity, Graphics::CreatePrimative(Graphics::PrimitiveType::Sphere));
+					registry.emplace<MeshComponent>(entity, Graphics::PrimitiveType::Sphere);
 					registry.emplace<NameComponent>(entity, "Sphere");
 					registry.emplace<Maths::Transform>(entity);
 				}
@@ -305,7 +323,7 @@ namespace Lumos
 				if (ImGui::MenuItem("Pyramid"))
 				{
 					auto entity = registry.create();
-					registry.emplace<MeshComponent>(entity, Graphics::CreatePrimative(Graphics::PrimitiveType::Pyramid));
+					registry.emplace<MeshComponent>(entity, Graphics::PrimitiveType::Pyramid);
 					registry.emplace<NameComponent>(entity, "Pyramid");
 					registry.emplace<Maths::Transform>(entity);
 				}
@@ -313,7 +331,7 @@ namespace Lumos
 				if (ImGui::MenuItem("Plane"))
 				{
 					auto entity = registry.create();
-					registry.emplace<MeshComponent>(entity, Graphics::CreatePrimative(Graphics::PrimitiveType::Plane));
+					registry.emplace<MeshComponent>(entity, Graphics::PrimitiveType::Plane);
 					registry.emplace<NameComponent>(entity, "Plane");
 					registry.emplace<Maths::Transform>(entity);
 				}
@@ -321,7 +339,7 @@ namespace Lumos
 				if (ImGui::MenuItem("Cylinder"))
 				{
 					auto entity = registry.create();
-					registry.emplace<MeshComponent>(entity, Graphics::CreatePrimative(Graphics::PrimitiveType::Cylinder));
+					registry.emplace<MeshComponent>(entity, Graphics::PrimitiveType::Cylinder);
 					registry.emplace<NameComponent>(entity, "Cylinder");
 					registry.emplace<Maths::Transform>(entity);
 				}
@@ -329,7 +347,7 @@ namespace Lumos
 				if (ImGui::MenuItem("Capsule"))
 				{
 					auto entity = registry.create();
-					registry.emplace<MeshComponent>(entity, Graphics::CreatePrimative(Graphics::PrimitiveType::Capsule));
+					registry.emplace<MeshComponent>(entity, Graphics::PrimitiveType::Capsule);
 					registry.emplace<NameComponent>(entity, "Capsule");
 					registry.emplace<Maths::Transform>(entity);
 				}
@@ -340,6 +358,7 @@ namespace Lumos
             if (ImGui::BeginMenu("Graphics"))
             {
                 if (ImGui::MenuItem("Compile Shaders")) { RecompileShaders(); }
+                if (ImGui::MenuItem("Cook Scene Textures")) { CookSceneTextures(); }
                 ImGui::EndMenu();
             }
         
@@ -375,7 +394,13 @@ namespace Lumos
 					ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.28f, 0.56f, 0.9f, 1.0f));
 
                 if (ImGui::Button(ICON_FA_PLAY, ImVec2(19.0f, 19.0f)))
+                {
+                    // Keep the edited scene to return to when play is stopped
+                    if (m_Application->GetEditorState() != EditorState::Play && m_PlaySnapshot.Empty())
+                        m_PlaySnapshot.Capture(m_Application->GetSceneManager()->GetCurrentScene()->GetRegistry());
+
                     m_Application->SetEditorState(EditorState::Play);
+                }
 
                 ImGuiHelpers::Tooltip("Play");
 
@@ -401,6 +426,24 @@ namespace Lumos
 
             ImGui::SameLine();
 
+            {
+                if (ImGui::Button(ICON_FA_STOP, ImVec2(19.0f, 19.0f)) && !m_PlaySnapshot.Empty())
+                {
+                    auto& registry = m_Application->GetSceneManager()->GetCurrentScene()->GetRegistry();
+                    m_PlaySnapshot.Restore(registry, m_Application->GetSceneManager()->GetCurrentScene());
+                    m_PlaySnapshot.Clear();
+
+                    if (!registry.valid(m_Selected))
+                        m_Selected = entt::null;
+
+                    m_Application->SetEditorState(EditorState::Paused);
+                }
+
+                ImGuiHelpers::Tooltip("Stop");
+            }
+
+            ImGui::SameLine();
+
             {
                 selected = m_Application->GetEditorState() == EditorState::Next;
                 if (selected)
@@ -907,6 +950,55 @@ namespace Lumos
     #endif
     }
     
+    void Editor::CookSceneTextures()
+    {
+        auto& registry = m_Application->GetSceneManager()->GetCurrentScene()->GetRegistry();
+
+        Timer timer;
+        std::unordered_set<String> cooked;
+        u32 failed = 0;
+
+        // Cooked files sit next to their sources and are picked up the next time the textures load
+        auto cook = [&](const Ref<Graphics::Texture2D>& texture, bool normalMap)
+        {
+            if (!texture)
+                return;
+
+            String physicalPath;
+            const String& filePath = texture->GetFilepath();
+            if (filePath.empty() || cooked.count(filePath) || StringFormat::GetFilePathExtension(filePath) == "ltex" || !VFS::Get()->ResolvePhysicalPath(filePath, physicalPath))
+                return;
+
+            Graphics::CookOptions options;
+            options.format = normalMap ? Graphics::TextureFormat::BC5 : Graphics::TextureFormat::BC7;
+            options.normalMap = normalMap;
+            options.sRGB = !normalMap;
+
+            if (Graphics::CookedTexture::CookFile(filePath, Graphics::CookedTexture::GetCookedPath(physicalPath), options))
+                cooked.insert(filePath);
+            else
+                failed++;
+        };
+
+        auto view = registry.view<MaterialComponent>();
+        for (auto entity : view)
+        {
+            const auto& material = view.get<MaterialComponent>(entity).GetMaterial();
+            if (!material)
+                continue;
+
+            const auto& textures = material->GetTextures();
+            cook(textures.albedo, false);
+            cook(textures.normal, true);
+            cook(textures.metallic, false);
+            cook(textures.roughness, false);
+            cook(textures.ao, false);
+            cook(textures.emissive, false);
+        }
+
+        Lumos::Debug::Log::Info("Cooked {0} textures in {1} ms ({2} failed)", cooked.size(), timer.GetMS(1000.0f), failed);
+    }
+
     void Editor::DebugDraw()
     {
         auto& registry = Application::Instance()->GetSceneManager()->GetCurrentScene()->GetRegistry();
@@ -1015,31 +1107,16 @@ namespace Lumos
         float closestEntityDist = Maths::M_INFINITY;
         entt::entity currentClosestEntity = entt::null;
 
-        auto group = registry.group<MeshComponent>(entt::get<Maths::Transform>);
-
         static Timer timer;
         static float timeSinceLastSelect = 0.0f;
 
-        for(auto entity : group)
+        // Picks against the mesh triangles rather than their bounding boxes
+        auto raycast = SceneRaycast::Get(registry);
+        RaycastHit hit;
+        if(raycast && raycast->Raycast(ray, hit))
         {
-           const auto &[mesh, trans] = group.get<MeshComponent, Maths::Transform>(entity);
-
-           if (mesh.GetMesh() && mesh.GetMesh()->GetActive())
-           {
-               auto& worldTransform = trans.GetWorldMatrix();
-
-               auto bbCopy = mesh.GetMesh()->GetBoundingBox()->Transformed(worldTransform);
-               float dist = ray.HitDistance(bbCopy);
-           
-               if(dist < Maths::M_INFINITY)
-               {
-                    if(dist < closestEntityDist)
-                    {
-                        closestEntityDist = dist;
-                        currentClosestEntity = entity;
-                    }
-               }
-           }
+            closestEntityDist = hit.distance;
+            currentClosestEntity = hit.entity;
         }
 
         if(m_Selected != entt::null)
@@ -1180,6 +1257,15 @@ namespace Lumos
     {
         if(IsTextFile(filePath))
             OpenTextFile(filePath);
+        else if(IsSnapshotFile(filePath))
+        {
+            auto scene = m_Application->GetSceneManager()->GetCurrentScene();
+            SceneSnapshot snapshot;
+            if(snapshot.Load(filePath) && snapshot.Restore(scene->GetRegistry(), scene))
+                LUMOS_LOG_INFO("Loaded {0} : {1} entities, {2} ms", filePath, snapshot.GetEntityCount(), snapshot.GetRestoreTime());
+
+            m_Selected = entt::null;
+        }
         else if(IsModelFile(filePath))
         {
             auto entity = ModelLoader::LoadModel(filePath, m_Application->GetSceneManager()->GetCurrentScene()->GetRegistry());
@@ -4,6 +4,7 @@
 
 #include "EditorWindow.h"
 #include "FileBrowserWindow.h"
+#include "App/SceneSnapshot.h"
 
 #include <imgui/imgui.h>
 #include <entt/entt.hpp>
@@ -87,6 +88,7 @@ namespace Lumos
 		void FocusCamera(const Maths::Vector3& point, float distance, float speed = 1.0f);
     
         void RecompileShaders();
+        void CookSceneTextures();
         void DebugDraw();
         void SelectObject(const Maths::Ray& ray);
 
@@ -134,6 +136,7 @@ namespace Lumos
 		std::unordered_map<size_t, const char*> m_ComponentIconMap;
     
 		FileBrowserWindow m_FileBrowserWindow;
+		SceneSnapshot m_PlaySnapshot;
         Camera* m_EditorCamera = nullptr;
         //CameraController* m_EditorCameraController = nullptr;
 
@@ -5,6 +5,7 @@
 #include "App/SceneManager.h"
 #include "ImGui/ImGuiHelpers.h"
 #include "App/SceneGraph.h"
+#include "App/EntityIndex.h"
 #include "Maths/Transform.h"
 #include "InspectorWindow.h"
 
@@ -35,14 +36,6 @@ namespace Lumos
 		const auto nameComponent = registry.try_get<NameComponent>(node);
 		String name = nameComponent ? nameComponent->name : StringFormat::ToString(entt::to_integral(node));
     
-		if (m_HierarchyFilter.IsActive())
-		{
-			if (!m_HierarchyFilter.PassFilter(name.c_str()))
-			{
-				show = false;
-			}
-		}
-
 		if (show)
 		{
 			auto hierarchyComponent = registry.try_get<Hierarchy>(node);
@@ -119,7 +112,7 @@ namespace Lumos
 
                 ImGui::PushItemWidth(-1);
                 if (ImGui::InputText("##Name", objName, IM_ARRAYSIZE(objName), 0))
-                    registry.get_or_emplace<NameComponent>(node).name = objName;
+                    registry.emplace_or_replace<NameComponent>(node, String(objName));
                 ImGui::PopStyleVar();
             }
 #if 0
@@ -331,17 +324,53 @@ namespace Lumos
 				}
 
 				ImGui::Indent();
-                
-                registry.each([&](auto entity)
-                {
-					if (registry.valid(entity))
+
+				auto entityIndex = EntityIndex::Get(registry);
+
+				if (m_HierarchyFilter.IsActive())
+				{
+					// Searching lists matching entities instead of walking the tree. A single term is looked
+					// up as a case insensitive name prefix in the index, lists of terms and exclusions
+					// ("a,b", "-a") keep ImGuiTextFilter's substring matching over every name.
+					m_FilteredEntities.clear();
+
+					auto& filters = m_HierarchyFilter.Filters;
+					if (entityIndex && filters.Size == 1 && filters[0].b[0] != '-')
 					{
-						auto hierarchyComponent = registry.try_get<Hierarchy>(entity);
+						entityIndex->FindByNamePrefix(String(filters[0].b, filters[0].e), m_FilteredEntities);
+					}
+					else
+					{
+						auto names = registry.view<NameComponent>();
+						for (auto entity : names)
+						{
+							if (m_HierarchyFilter.PassFilter(names.get(entity).name.c_str()))
+								m_FilteredEntities.push_back(entity);
+						}
+					}
 
-						if (!hierarchyComponent || hierarchyComponent->parent() == entt::null)
-							DrawNode(entity, registry);
+					for (auto entity : m_FilteredEntities)
+					{
+						auto& name = registry.get<NameComponent>(entity).name;
+						ImGui::PushID(static_cast<int>(entt::to_integral(entity)));
+						if (ImGui::Selectable((String(ICON_FA_CUBE) + " " + name).c_str(), m_Editor->GetSelected() == entity))
+							m_Editor->SetSelected(entity);
+						ImGui::PopID();
 					}
-                });
+				}
+				else
+				{
+					registry.each([&](auto entity)
+					{
+						if (registry.valid(entity))
+						{
+							auto hierarchyComponent = registry.try_get<Hierarchy>(entity);
+
+							if (!hierarchyComponent || hierarchyComponent->parent() == entt::null)
+								DrawNode(entity, registry);
+						}
+					});
+				}
 
                 //Only supports one scene
                 ImVec2 min_space = ImGui::GetWindowContentRegionMin();
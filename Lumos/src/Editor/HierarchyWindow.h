@@ -24,5 +24,6 @@ namespace Lumos
 		entt::entity m_DoubleClicked;
 		entt::entity m_HadRecentDroppedEntity;
 		entt::entity m_CopiedEntity;
+		std::vector<entt::entity> m_FilteredEntities;
 	};
 }
@@ -36,6 +36,17 @@ namespace MM {
         if(ImGui::Button("Reload"))
             script.Reload();
 
+        const char* rates[] = { "Every Frame", "10 Hz", "1 Hz" };
+        int rate = static_cast<int>(script.GetUpdateRate());
+        if (ImGui::Combo("Update Rate", &rate, rates, IM_ARRAYSIZE(rates)))
+            script.SetUpdateRate(static_cast<Lumos::ScriptUpdateRate>(rate));
+
+        ImGui::Text("Time : %.3f ms avg, %.3f ms peak", script.GetAverageTime(), script.GetPeakTime());
+        if (script.GetOverBudget())
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Over budget");
+        if (script.IsWaiting())
+            ImGui::TextUnformatted("Waiting");
+
         String filePath = script.GetFilePath();
 
         static char filePathBuffer[INPUT_BUF_SIZE];
@@ -129,6 +140,7 @@ namespace MM {
         auto friction = phys.GetPhysicsObject()->GetFriction();
         auto isStatic = phys.GetPhysicsObject()->GetIsStatic();
         auto isRest = phys.GetPhysicsObject()->GetIsAtRest();
+        auto continuous = phys.GetPhysicsObject()->GetContinuousCollision();
         auto mass = 1.0f / phys.GetPhysicsObject()->GetInverseMass();
         auto velocity = phys.GetPhysicsObject()->GetLinearVelocity();
         auto elasticity = phys.GetPhysicsObject()->GetElasticity();
@@ -234,6 +246,16 @@ namespace MM {
         ImGui::NextColumn();
 
 
+        ImGui::AlignTextToFramePadding();
+        ImGui::TextUnformatted("Continuous Collision");
+        ImGui::NextColumn();
+        ImGui::PushItemWidth(-1);
+        if (ImGui::Checkbox("##Continuous Collision", &continuous))
+            phys.GetPhysicsObject()->SetContinuousCollision(continuous);
+
+        ImGui::PopItemWidth();
+        ImGui::NextColumn();
+
         ImGui::AlignTextToFramePadding();
         ImGui::TextUnformatted("At Rest");
         ImGui::NextColumn();
@@ -424,6 +446,29 @@ namespace MM {
         light.OnImGui();
     }
 
+    template <>
+    void ComponentEditorWidget<Lumos::TerrainComponent>(entt::registry& reg, entt::registry::entity_type e)
+    {
+        reg.get<Lumos::TerrainComponent>(e).OnImGui();
+    }
+
+    template <>
+    void ComponentEditorWidget<Lumos::AnimatorComponent>(entt::registry& reg, entt::registry::entity_type e)
+    {
+        reg.get<Lumos::AnimatorComponent>(e).OnImGui();
+    }
+
+    template <>
+    void ComponentEditorWidget<Lumos::OccluderComponent>(entt::registry& reg, entt::registry::entity_type e)
+    {
+        auto& occluder = reg.get<Lumos::OccluderComponent>(e);
+        occluder.OnImGui();
+
+        auto mesh = reg.try_get<Lumos::MeshComponent>(e);
+        if (mesh && mesh->GetMesh() && mesh->GetMesh()->GetBoundingBox() && ImGui::Button("Fit To Mesh Bounds"))
+            occluder = Lumos::OccluderComponent(*mesh->GetMesh()->GetBoundingBox());
+    }
+
     template <>
     void ComponentEditorWidget<Lumos::MaterialComponent>(entt::registry& reg, entt::registry::entity_type e)
     {
@@ -861,6 +906,9 @@ namespace Lumos
 		TRIVIAL_COMPONENT(Graphics::Light, "Light");
         TRIVIAL_COMPONENT(ScriptComponent, "LuaScript");
         TRIVIAL_COMPONENT(Graphics::Environment, "Environment");
+        TRIVIAL_COMPONENT(TerrainComponent, "Terrain");
+        TRIVIAL_COMPONENT(AnimatorComponent, "Animator");
+        TRIVIAL_COMPONENT(OccluderComponent, "Occluder");
 
 	}
 
@@ -914,7 +962,7 @@ namespace Lumos
         
 			ImGui::PushItemWidth(-1);
 			if (ImGui::InputText("##Name", objName, IM_ARRAYSIZE(objName), 0))
-				registry.get_or_emplace<NameComponent>(selected).name = objName;
+				registry.emplace_or_replace<NameComponent>(selected, String(objName));
 
 			ImGui::Separator();
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "lmpch.h"
 #include "Renderer.h"
+#include "DescriptorSet.h"
 
 namespace Lumos
 {
@@ -10,9 +11,6 @@ namespace Lumos
 		class RenderPass;
 		class CommandBuffer;
 		class DescriptorSet;
-		struct VertexInputDescription;
-		struct DescriptorLayout;
-		struct DescriptorPoolInfo;
 
 		enum class CullMode
 		{
@@ -42,6 +40,9 @@ namespace Lumos
 			std::vector<DescriptorLayout> descriptorLayouts;
 			u32 numLayoutBindings;
 
+			// Ranges only, data is ignored. Packed in order from offset 0
+			std::vector<PushConstant> pushConstants;
+
 			CullMode cullMode;
 			String pipelineName;
 			int numColorAttachments;
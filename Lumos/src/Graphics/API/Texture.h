@@ -39,7 +39,11 @@ namespace Lumos
 			RGBA,
 			DEPTH,
 			STENCIL,
-			DEPTH_STENCIL
+			DEPTH_STENCIL,
+			BC1,
+			BC3,
+			BC5,
+			BC7
 		};
 
 		enum class TextureType
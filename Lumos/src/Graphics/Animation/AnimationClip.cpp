@@ -0,0 +1,277 @@
+#include "lmpch.h"
+#include "AnimationClip.h"
+#include "Core/Profiler.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		namespace
+		{
+			const float SQRT_HALF = 0.70710678f;
+
+			template<typename T, typename Interpolate>
+			T SampleKeys(const std::vector<float>& times, const std::vector<T>& values, float time, bool step, const T& fallback, Interpolate interpolate)
+			{
+				const size_t count = std::min(times.size(), values.size());
+				if (count == 0)
+					return fallback;
+
+				if (count == 1 || time <= times[0])
+					return values[0];
+
+				if (time >= times[count - 1])
+					return values[count - 1];
+
+				const size_t next = std::upper_bound(times.begin(), times.begin() + count, time) - times.begin();
+				if (step)
+					return values[next - 1];
+
+				const float span = times[next] - times[next - 1];
+				const float t = span > 0.0f ? (time - times[next - 1]) / span : 0.0f;
+				return interpolate(values[next - 1], values[next], t);
+			}
+
+			u16 QuantiseUnit(float value)
+			{
+				return static_cast<u16>(Maths::Clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+			}
+
+			void EncodeVector(const Maths::Vector3& value, const Maths::Vector3& min, const Maths::Vector3& extent, u16* out)
+			{
+				out[0] = extent.x > 0.0f ? QuantiseUnit((value.x - min.x) / extent.x) : 0;
+				out[1] = extent.y > 0.0f ? QuantiseUnit((value.y - min.y) / extent.y) : 0;
+				out[2] = extent.z > 0.0f ? QuantiseUnit((value.z - min.z) / extent.z) : 0;
+			}
+
+			Maths::Vector3 DecodeVector(const u16* data, const Maths::Vector3& min, const Maths::Vector3& extent)
+			{
+				const float scale = 1.0f / 65535.0f;
+				return Maths::Vector3(min.x + extent.x * (data[0] * scale), min.y + extent.y * (data[1] * scale), min.z + extent.z * (data[2] * scale));
+			}
+
+			// Smallest three: the largest component is dropped (and made positive, q and -q are the same
+			// rotation), the other three lie in [-1/sqrt(2), 1/sqrt(2)] and get 15 bits each. The top bits
+			// of the first two words hold the index of the dropped component.
+			void EncodeRotation(const Maths::Quaternion& rotation, u16* out)
+			{
+				const Maths::Quaternion normalised = rotation.Normalized();
+				float components[4] = { normalised.w, normalised.x, normalised.y, normalised.z };
+
+				u32 largest = 0;
+				for (u32 i = 1; i < 4; i++)
+				{
+					if (Maths::Abs(components[i]) > Maths::Abs(components[largest]))
+						largest = i;
+				}
+
+				const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+				u32 word = 0;
+				for (u32 i = 0; i < 4; i++)
+				{
+					if (i == largest)
+						continue;
+
+					const float unit = components[i] * sign / SQRT_HALF * 0.5f + 0.5f;
+					out[word++] = static_cast<u16>(Maths::Clamp(unit, 0.0f, 1.0f) * 32767.0f + 0.5f);
+				}
+
+				out[0] |= static_cast<u16>((largest & 1) << 15);
+				out[1] |= static_cast<u16>((largest >> 1) << 15);
+			}
+
+			Maths::Quaternion DecodeRotation(const u16* data)
+			{
+				const u32 largest = (data[0] >> 15) | ((data[1] >> 15) << 1);
+				const float scale = 2.0f / 32767.0f;
+
+				float components[4];
+				float sum = 0.0f;
+				u32 word = 0;
+				for (u32 i = 0; i < 4; i++)
+				{
+					if (i == largest)
+						continue;
+
+					const float value = ((data[word++] & 0x7fff) * scale - 1.0f) * SQRT_HALF;
+					components[i] = value;
+					sum += value * value;
+				}
+
+				components[largest] = Maths::Sqrt(Maths::Max(0.0f, 1.0f - sum));
+				return Maths::Quaternion(components[0], components[1], components[2], components[3]);
+			}
+		}
+
+		void AnimationClip::Build(const String& name, const Skeleton& skeleton, const std::vector<AnimationTrack>& tracks, float duration, const AnimationCompression& compression)
+		{
+			LUMOS_PROFILE_FUNC;
+
+			m_Name = name;
+			m_Duration = Maths::Max(duration, 0.0f);
+			m_FrameCount = static_cast<u32>(Maths::Ceil(m_Duration * compression.sampleRate - 1e-3f)) + 1;
+			m_FrameCount = Maths::Max(m_FrameCount, 2u);
+
+			// Spread the frames evenly over the clip, so the last one lands on its end
+			m_SampleRate = m_Duration > 0.0f ? static_cast<float>(m_FrameCount - 1) / m_Duration : compression.sampleRate;
+
+			const u32 jointCount = skeleton.GetJointCount();
+			m_Channels.clear();
+			m_Channels.resize(jointCount);
+
+			std::vector<const AnimationTrack*> jointTracks(jointCount, nullptr);
+			for (auto& track : tracks)
+			{
+				if (track.joint < jointCount)
+					jointTracks[track.joint] = &track;
+			}
+
+			auto lerpVector = [](const Maths::Vector3& a, const Maths::Vector3& b, float t) { return a.Lerp(b, t); };
+			auto slerp = [](const Maths::Quaternion& a, const Maths::Quaternion& b, float t) { return a.Slerp(b, t); };
+
+			std::vector<Maths::Vector3> positions(m_FrameCount * jointCount);
+			std::vector<Maths::Quaternion> rotations(m_FrameCount * jointCount);
+			std::vector<Maths::Vector3> scales(m_FrameCount * jointCount);
+
+			m_FrameStride = 0;
+			for (u32 joint = 0; joint < jointCount; joint++)
+			{
+				const JointPose& bind = skeleton.GetJoint(joint).bindPose;
+				const AnimationTrack* track = jointTracks[joint];
+				JointChannels& channels = m_Channels[joint];
+
+				for (u32 frame = 0; frame < m_FrameCount; frame++)
+				{
+					const float time = Maths::Min(static_cast<float>(frame) / m_SampleRate, m_Duration);
+					const u32 index = frame * jointCount + joint;
+
+					if (track)
+					{
+						positions[index] = SampleKeys(track->positionTimes, track->positions, time, track->step, bind.position, lerpVector);
+						rotations[index] = SampleKeys(track->rotationTimes, track->rotations, time, track->step, bind.rotation, slerp).Normalized();
+						scales[index] = SampleKeys(track->scaleTimes, track->scales, time, track->step, bind.scale, lerpVector);
+					}
+					else
+					{
+						positions[index] = bind.position;
+						rotations[index] = bind.rotation;
+						scales[index] = bind.scale;
+					}
+				}
+
+				const Maths::Vector3& firstPosition = positions[joint];
+				const Maths::Quaternion& firstRotation = rotations[joint];
+				const Maths::Vector3& firstScale = scales[joint];
+
+				Maths::Vector3 positionMin = firstPosition, positionMax = firstPosition;
+				Maths::Vector3 scaleMin = firstScale, scaleMax = firstScale;
+				bool rotationConstant = true;
+
+				for (u32 frame = 1; frame < m_FrameCount; frame++)
+				{
+					const u32 index = frame * jointCount + joint;
+					positionMin = Maths::VectorMin(positionMin, positions[index]);
+					positionMax = Maths::VectorMax(positionMax, positions[index]);
+					scaleMin = Maths::VectorMin(scaleMin, scales[index]);
+					scaleMax = Maths::VectorMax(scaleMax, scales[index]);
+
+					if (1.0f - Maths::Abs(firstRotation.DotProduct(rotations[index])) > compression.rotationTolerance)
+						rotationConstant = false;
+				}
+
+				auto largestExtent = [](const Maths::Vector3& extent) { return Maths::Max(extent.x, Maths::Max(extent.y, extent.z)); };
+
+				channels.constant.position = firstPosition;
+				channels.constant.rotation = firstRotation;
+				channels.constant.scale = firstScale;
+
+				if (largestExtent(positionMax - positionMin) > compression.positionTolerance)
+				{
+					channels.position = m_FrameStride;
+					channels.positionMin = positionMin;
+					channels.positionExtent = positionMax - positionMin;
+					m_FrameStride += 3;
+				}
+
+				if (!rotationConstant)
+				{
+					channels.rotation = m_FrameStride;
+					m_FrameStride += 3;
+				}
+
+				if (largestExtent(scaleMax - scaleMin) > compression.scaleTolerance)
+				{
+					channels.scale = m_FrameStride;
+					channels.scaleMin = scaleMin;
+					channels.scaleExtent = scaleMax - scaleMin;
+					m_FrameStride += 3;
+				}
+			}
+
+			m_Frames.assign(m_FrameStride * m_FrameCount, 0);
+			for (u32 frame = 0; frame < m_FrameCount; frame++)
+			{
+				u16* data = m_Frames.data() + frame * m_FrameStride;
+				for (u32 joint = 0; joint < jointCount; joint++)
+				{
+					const JointChannels& channels = m_Channels[joint];
+					const u32 index = frame * jointCount + joint;
+
+					if (channels.position != CONSTANT)
+						EncodeVector(positions[index], channels.positionMin, channels.positionExtent, data + channels.position);
+					if (channels.rotation != CONSTANT)
+						EncodeRotation(rotations[index], data + channels.rotation);
+					if (channels.scale != CONSTANT)
+						EncodeVector(scales[index], channels.scaleMin, channels.scaleExtent, data + channels.scale);
+				}
+			}
+		}
+
+		void AnimationClip::Sample(float time, JointPose* pose) const
+		{
+			if (m_FrameCount == 0)
+				return;
+
+			const float frame = Maths::Clamp(time, 0.0f, m_Duration) * m_SampleRate;
+			const u32 frame0 = Maths::Min(static_cast<u32>(frame), m_FrameCount - 1);
+			const u32 frame1 = Maths::Min(frame0 + 1, m_FrameCount - 1);
+			const float alpha = Maths::Clamp(frame - static_cast<float>(frame0), 0.0f, 1.0f);
+
+			const u16* data0 = m_Frames.data() + frame0 * m_FrameStride;
+			const u16* data1 = m_Frames.data() + frame1 * m_FrameStride;
+
+			const u32 jointCount = GetJointCount();
+			for (u32 joint = 0; joint < jointCount; joint++)
+			{
+				const JointChannels& channels = m_Channels[joint];
+				JointPose& out = pose[joint];
+
+				if (channels.position == CONSTANT)
+					out.position = channels.constant.position;
+				else
+					out.position = DecodeVector(data0 + channels.position, channels.positionMin, channels.positionExtent).Lerp(DecodeVector(data1 + channels.position, channels.positionMin, channels.positionExtent), alpha);
+
+				if (channels.rotation == CONSTANT)
+					out.rotation = channels.constant.rotation;
+				else
+					out.rotation = DecodeRotation(data0 + channels.rotation).Nlerp(DecodeRotation(data1 + channels.rotation), alpha, true);
+
+				if (channels.scale == CONSTANT)
+					out.scale = channels.constant.scale;
+				else
+					out.scale = DecodeVector(data0 + channels.scale, channels.scaleMin, channels.scaleExtent).Lerp(DecodeVector(data1 + channels.scale, channels.scaleMin, channels.scaleExtent), alpha);
+			}
+		}
+
+		u32 AnimationClip::GetCompressedSize() const
+		{
+			return static_cast<u32>(m_Frames.size() * sizeof(u16) + m_Channels.size() * sizeof(JointChannels));
+		}
+
+		u32 AnimationClip::GetUncompressedSize() const
+		{
+			// The same frames as full precision positions, rotations and scales
+			return static_cast<u32>(m_FrameCount * m_Channels.size() * (2 * sizeof(float) * 3 + sizeof(float) * 4));
+		}
+	}
+}
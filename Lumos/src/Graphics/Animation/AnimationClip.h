@@ -0,0 +1,85 @@
+#pragma once
+#include "lmpch.h"
+#include "Skeleton.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Keyframes of one joint as they come out of an importer. Each channel has its own key times,
+		// a channel without keys keeps the joint's bind pose.
+		struct AnimationTrack
+		{
+			u32 joint = 0;
+			bool step = false;
+
+			std::vector<float> positionTimes;
+			std::vector<Maths::Vector3> positions;
+			std::vector<float> rotationTimes;
+			std::vector<Maths::Quaternion> rotations;
+			std::vector<float> scaleTimes;
+			std::vector<Maths::Vector3> scales;
+		};
+
+		struct AnimationCompression
+		{
+			// Clips are resampled at a fixed rate, so sampling only ever touches two frames
+			float sampleRate = 30.0f;
+
+			// Channels that never move further than this from their first value are stored once
+			float positionTolerance = 1e-4f;
+			float rotationTolerance = 1e-6f;
+			float scaleTolerance = 1e-4f;
+		};
+
+		// Animation of every joint of a skeleton, resampled and quantised. Animated positions and scales
+		// are 16 bits per component inside the channel's range, animated rotations are the smallest three
+		// components at 15 bits each, and constant channels are kept once at full precision. Frames are
+		// stored one after the other, so a sample reads two small contiguous blocks.
+		class LUMOS_EXPORT AnimationClip
+		{
+		public:
+			AnimationClip() = default;
+
+			void Build(const String& name, const Skeleton& skeleton, const std::vector<AnimationTrack>& tracks, float duration, const AnimationCompression& compression = AnimationCompression());
+
+			// time is clamped to the clip, wrap it first for looping playback. pose holds GetJointCount() entries.
+			void Sample(float time, JointPose* pose) const;
+
+			const String& GetName() const { return m_Name; }
+			float GetDuration() const { return m_Duration; }
+			u32 GetJointCount() const { return static_cast<u32>(m_Channels.size()); }
+			u32 GetFrameCount() const { return m_FrameCount; }
+
+			u32 GetCompressedSize() const;
+			u32 GetUncompressedSize() const;
+
+		private:
+			static const u32 CONSTANT = ~0u;
+
+			struct JointChannels
+			{
+				// Offset of each channel inside a frame, in u16s, or CONSTANT
+				u32 position = CONSTANT;
+				u32 rotation = CONSTANT;
+				u32 scale = CONSTANT;
+
+				// Value of constant channels, and the quantisation range of animated ones
+				JointPose constant;
+				Maths::Vector3 positionMin;
+				Maths::Vector3 positionExtent;
+				Maths::Vector3 scaleMin;
+				Maths::Vector3 scaleExtent;
+			};
+
+			String m_Name;
+			float m_Duration = 0.0f;
+			float m_SampleRate = 30.0f;
+			u32 m_FrameCount = 0;
+			u32 m_FrameStride = 0;
+
+			std::vector<JointChannels> m_Channels;
+			std::vector<u16> m_Frames;
+		};
+	}
+}
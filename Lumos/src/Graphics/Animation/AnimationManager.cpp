@@ -0,0 +1,101 @@
+#include "lmpch.h"
+#include "AnimationManager.h"
+#include "Animator.h"
+#include "ECS/Component/AnimatorComponent.h"
+#include "Utilities/TimeStep.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	AnimationManager::AnimationManager()
+	{
+		m_DebugName = "Animation Manager";
+	}
+
+	AnimationManager::~AnimationManager()
+	{
+		System::JobSystem::Wait(m_Context);
+	}
+
+	void AnimationManager::OnInit()
+	{
+	}
+
+	void AnimationManager::DeclareAccess(SystemAccess& access)
+	{
+		// Skinned vertices are uploaded to their vertex buffers at the end of the update
+		access.Write<AnimatorComponent>().Write<AnimationManager>().MainThread();
+	}
+
+	void AnimationManager::OnUpdate(const TimeStep& timeStep, Scene* scene)
+	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		m_AnimatorCount = 0;
+		m_VertexCount = 0;
+		m_PoseTime = 0.0f;
+		m_SkinTime = 0.0f;
+
+		if (!scene)
+			return;
+
+		m_Animators.clear();
+
+		auto& registry = scene->GetRegistry();
+		auto view = registry.view<AnimatorComponent>();
+		for (auto entity : view)
+		{
+			auto& animator = view.get<AnimatorComponent>(entity).GetAnimator();
+			if (animator)
+				m_Animators.push_back(animator.get());
+		}
+
+		const float dt = timeStep.GetSeconds();
+		const u32 count = static_cast<u32>(m_Animators.size());
+
+		if (count > 1)
+		{
+			System::JobSystem::Dispatch(m_Context, count, 1, [this, dt](JobDispatchArgs args)
+			{
+				m_Animators[args.jobIndex]->Update(dt);
+			});
+
+			System::JobSystem::Wait(m_Context);
+		}
+		else if (count == 1)
+			m_Animators[0]->Update(dt);
+
+		Timer uploadTimer;
+		for (auto animator : m_Animators)
+		{
+			animator->UploadMeshes();
+
+			m_PoseTime += animator->GetPoseTime();
+			m_SkinTime += animator->GetSkinTime();
+			for (auto& mesh : animator->GetMeshes())
+				m_VertexCount += mesh->GetVertexCount();
+		}
+
+		m_AnimatorCount = count;
+		m_UploadTime = uploadTimer.GetMS(1000.0f);
+		m_UpdateTime = timer.GetMS(1000.0f);
+	}
+
+	void AnimationManager::OnImGui()
+	{
+		ImGui::TextUnformatted("Animation Manager");
+		ImGui::Text("Animators : %u", m_AnimatorCount);
+		ImGui::Text("Skinned Vertices : %u", m_VertexCount);
+		ImGui::Text("Pose : %.3f ms, Skin : %.3f ms (summed over threads)", m_PoseTime, m_SkinTime);
+		ImGui::Text("Upload : %.3f ms", m_UploadTime);
+		ImGui::Text("Update : %.3f ms", m_UpdateTime);
+	}
+
+	void AnimationManager::OnDebugDraw()
+	{
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "lmpch.h"
+#include "ECS/ISystem.h"
+#include "Core/JobSystem.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class Animator;
+	}
+
+	// Updates every AnimatorComponent in the scene, one job per animator, then uploads the skinned meshes
+	class LUMOS_EXPORT AnimationManager : public ISystem
+	{
+	public:
+		AnimationManager();
+		~AnimationManager();
+
+		void OnInit() override;
+		void OnUpdate(const TimeStep& timeStep, Scene* scene) override;
+		void OnImGui() override;
+		void OnDebugDraw() override;
+		void DeclareAccess(SystemAccess& access) override;
+
+	private:
+		std::vector<Graphics::Animator*> m_Animators;
+		System::JobSystem::Context m_Context;
+
+		u32 m_AnimatorCount = 0;
+		u32 m_VertexCount = 0;
+		float m_PoseTime = 0.0f;
+		float m_SkinTime = 0.0f;
+		float m_UploadTime = 0.0f;
+		float m_UpdateTime = 0.0f;
+	};
+}
@@ -0,0 +1,191 @@
+#include "lmpch.h"
+#include "Animator.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		Animator::Animator(const Ref<Skeleton>& skeleton)
+			: m_Skeleton(skeleton)
+		{
+			const u32 jointCount = m_Skeleton ? m_Skeleton->GetJointCount() : 0;
+			m_LocalPose.resize(jointCount);
+			m_LayerPose.resize(jointCount);
+			m_ModelPose.resize(jointCount);
+			m_SkinMatrices.resize(jointCount);
+
+			if (m_Skeleton)
+			{
+				m_Skeleton->GetBindPose(m_LocalPose.data());
+				m_Skeleton->GetModelPose(m_LocalPose.data(), m_ModelPose.data());
+				m_Skeleton->GetSkinMatrices(m_ModelPose.data(), m_SkinMatrices.data());
+			}
+		}
+
+		u32 Animator::AddClip(const Ref<AnimationClip>& clip)
+		{
+			m_Clips.push_back(clip);
+			return static_cast<u32>(m_Clips.size() - 1);
+		}
+
+		i32 Animator::FindClip(const String& name) const
+		{
+			for (size_t i = 0; i < m_Clips.size(); i++)
+			{
+				if (m_Clips[i]->GetName() == name)
+					return static_cast<i32>(i);
+			}
+
+			return -1;
+		}
+
+		void Animator::AddMesh(const Ref<SkinnedMesh>& mesh)
+		{
+			m_Meshes.push_back(mesh);
+		}
+
+		void Animator::Play(i32 clip, u32 layer, float weight, bool loop)
+		{
+			if (layer >= m_Layers.size())
+				m_Layers.resize(layer + 1);
+
+			AnimationLayer& target = m_Layers[layer];
+			target.clip = clip;
+			target.time = 0.0f;
+			target.weight = weight;
+			target.loop = loop;
+		}
+
+		void Animator::Update(float dt)
+		{
+			LUMOS_PROFILE_FUNC;
+
+			if (!m_Skeleton)
+				return;
+
+			Timer poseTimer;
+
+			m_Skeleton->GetBindPose(m_LocalPose.data());
+
+			for (auto& layer : m_Layers)
+			{
+				if (layer.clip < 0 || layer.clip >= static_cast<i32>(m_Clips.size()))
+					continue;
+
+				const float duration = m_Clips[layer.clip]->GetDuration();
+				if (!m_Paused)
+				{
+					layer.time += dt * layer.speed;
+					if (layer.loop && duration > 0.0f)
+					{
+						layer.time = fmodf(layer.time, duration);
+						if (layer.time < 0.0f)
+							layer.time += duration;
+					}
+					else
+						layer.time = Maths::Clamp(layer.time, 0.0f, duration);
+				}
+
+				if (layer.weight > 0.0f)
+					BlendLayer(layer);
+			}
+
+			m_Skeleton->GetModelPose(m_LocalPose.data(), m_ModelPose.data());
+			m_Skeleton->GetSkinMatrices(m_ModelPose.data(), m_SkinMatrices.data());
+
+			m_PoseTime = poseTimer.GetMS(1000.0f);
+
+			Timer skinTimer;
+			for (auto& mesh : m_Meshes)
+				mesh->Skin(m_SkinMatrices.data(), static_cast<u32>(m_SkinMatrices.size()));
+
+			m_SkinTime = skinTimer.GetMS(1000.0f);
+		}
+
+		void Animator::BlendLayer(const AnimationLayer& layer)
+		{
+			const Ref<AnimationClip>& clip = m_Clips[layer.clip];
+			clip->Sample(layer.time, m_LayerPose.data());
+
+			const u32 jointCount = Maths::Min(m_Skeleton->GetJointCount(), clip->GetJointCount());
+			for (u32 joint = 0; joint < jointCount; joint++)
+			{
+				float weight = layer.weight;
+				if (joint < layer.jointWeights.size())
+					weight *= layer.jointWeights[joint];
+
+				if (weight <= 0.0f)
+					continue;
+
+				JointPose& pose = m_LocalPose[joint];
+				const JointPose& layerPose = m_LayerPose[joint];
+
+				if (weight >= 1.0f)
+				{
+					pose = layerPose;
+					continue;
+				}
+
+				pose.position = pose.position.Lerp(layerPose.position, weight);
+				pose.rotation = pose.rotation.Nlerp(layerPose.rotation, weight, true);
+				pose.scale = pose.scale.Lerp(layerPose.scale, weight);
+			}
+		}
+
+		void Animator::UploadMeshes()
+		{
+			for (auto& mesh : m_Meshes)
+				mesh->Upload();
+		}
+
+		void Animator::OnImGui()
+		{
+			u32 vertexCount = 0;
+			for (auto& mesh : m_Meshes)
+				vertexCount += mesh->GetVertexCount();
+
+			ImGui::Text("Joints : %u, Meshes : %u, Vertices : %u", m_Skeleton ? m_Skeleton->GetJointCount() : 0, static_cast<u32>(m_Meshes.size()), vertexCount);
+			ImGui::Text("Pose : %.3f ms, Skin : %.3f ms", m_PoseTime, m_SkinTime);
+			ImGui::Checkbox("Paused", &m_Paused);
+
+			for (u32 i = 0; i < m_Layers.size(); i++)
+			{
+				AnimationLayer& layer = m_Layers[i];
+				ImGui::PushID(static_cast<int>(i));
+
+				const char* current = layer.clip >= 0 && layer.clip < static_cast<i32>(m_Clips.size()) ? m_Clips[layer.clip]->GetName().c_str() : "None";
+				if (ImGui::BeginCombo("Clip", current))
+				{
+					if (ImGui::Selectable("None", layer.clip < 0))
+						layer.clip = -1;
+
+					for (u32 clip = 0; clip < m_Clips.size(); clip++)
+					{
+						if (ImGui::Selectable(m_Clips[clip]->GetName().c_str(), layer.clip == static_cast<i32>(clip)))
+						{
+							layer.clip = static_cast<i32>(clip);
+							layer.time = 0.0f;
+						}
+					}
+					ImGui::EndCombo();
+				}
+
+				const float duration = layer.clip >= 0 && layer.clip < static_cast<i32>(m_Clips.size()) ? m_Clips[layer.clip]->GetDuration() : 0.0f;
+				ImGui::SliderFloat("Time", &layer.time, 0.0f, duration);
+				ImGui::SliderFloat("Weight", &layer.weight, 0.0f, 1.0f);
+				ImGui::DragFloat("Speed", &layer.speed, 0.01f, -10.0f, 10.0f);
+				ImGui::Checkbox("Loop", &layer.loop);
+
+				ImGui::Separator();
+				ImGui::PopID();
+			}
+
+			if (ImGui::Button("Add Layer"))
+				m_Layers.emplace_back();
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "lmpch.h"
+#include "Skeleton.h"
+#include "AnimationClip.h"
+#include "SkinnedMesh.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// One clip playing on top of the layers before it. jointWeights, when not empty, masks the
+		// layer per joint (an upper body layer leaves the legs at 0).
+		struct AnimationLayer
+		{
+			i32 clip = -1;
+			float time = 0.0f;
+			float speed = 1.0f;
+			float weight = 1.0f;
+			bool loop = true;
+			std::vector<float> jointWeights;
+		};
+
+		// Plays clips on a skeleton and skins the meshes bound to it. Layers are blended in order over
+		// the bind pose, then the pose is taken to model space and turned into skin matrices.
+		class LUMOS_EXPORT Animator
+		{
+		public:
+			explicit Animator(const Ref<Skeleton>& skeleton);
+
+			u32 AddClip(const Ref<AnimationClip>& clip);
+			i32 FindClip(const String& name) const;
+			const std::vector<Ref<AnimationClip>>& GetClips() const { return m_Clips; }
+
+			void AddMesh(const Ref<SkinnedMesh>& mesh);
+			const std::vector<Ref<SkinnedMesh>>& GetMeshes() const { return m_Meshes; }
+
+			// Starts clip from the beginning on layer, adding layers up to it if needed
+			void Play(i32 clip, u32 layer = 0, float weight = 1.0f, bool loop = true);
+			AnimationLayer& GetLayer(u32 index) { return m_Layers[index]; }
+			u32 GetLayerCount() const { return static_cast<u32>(m_Layers.size()); }
+
+			// Advances the layers, builds the pose and skins the meshes on the CPU. Touches only this
+			// animator and its meshes, so animators are updated in parallel on worker threads.
+			void Update(float dt);
+
+			// Uploads the skinned meshes, main thread only
+			void UploadMeshes();
+
+			const Ref<Skeleton>& GetSkeleton() const { return m_Skeleton; }
+			const std::vector<JointPose>& GetLocalPose() const { return m_LocalPose; }
+			const std::vector<Maths::Matrix3x4>& GetModelPose() const { return m_ModelPose; }
+
+			// Model pose times inverse bind matrix per joint, three rows of four floats each
+			const std::vector<Maths::Matrix3x4>& GetSkinMatrices() const { return m_SkinMatrices; }
+
+			bool& GetPaused() { return m_Paused; }
+
+			float GetPoseTime() const { return m_PoseTime; }
+			float GetSkinTime() const { return m_SkinTime; }
+
+			void OnImGui();
+
+		private:
+			void BlendLayer(const AnimationLayer& layer);
+
+			Ref<Skeleton> m_Skeleton;
+			std::vector<Ref<AnimationClip>> m_Clips;
+			std::vector<Ref<SkinnedMesh>> m_Meshes;
+			std::vector<AnimationLayer> m_Layers;
+
+			std::vector<JointPose> m_LocalPose;
+			std::vector<JointPose> m_LayerPose;
+			std::vector<Maths::Matrix3x4> m_ModelPose;
+			std::vector<Maths::Matrix3x4> m_SkinMatrices;
+
+			bool m_Paused = false;
+			float m_PoseTime = 0.0f;
+			float m_SkinTime = 0.0f;
+		};
+	}
+}
@@ -0,0 +1,88 @@
+#include "lmpch.h"
+#include "Skeleton.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		u32 Skeleton::AddJoint(const String& name, i32 parent, const JointPose& bindPose, const Maths::Matrix3x4& inverseBindMatrix)
+		{
+			LUMOS_ASSERT(parent < static_cast<i32>(m_Joints.size()), "Joint parents must be added before their children");
+
+			Joint joint;
+			joint.name = name;
+			joint.parent = parent;
+			joint.bindPose = bindPose;
+			joint.inverseBindMatrix = inverseBindMatrix;
+			m_Joints.push_back(joint);
+
+			return static_cast<u32>(m_Joints.size() - 1);
+		}
+
+		i32 Skeleton::FindJoint(const String& name) const
+		{
+			for (size_t i = 0; i < m_Joints.size(); i++)
+			{
+				if (m_Joints[i].name == name)
+					return static_cast<i32>(i);
+			}
+
+			return -1;
+		}
+
+		void Skeleton::GetBindPose(JointPose* localPose) const
+		{
+			for (size_t i = 0; i < m_Joints.size(); i++)
+				localPose[i] = m_Joints[i].bindPose;
+		}
+
+		void Skeleton::GetModelPose(const JointPose* localPose, Maths::Matrix3x4* modelPose) const
+		{
+			const u32 count = GetJointCount();
+			for (u32 i = 0; i < count; i++)
+			{
+				const JointPose& pose = localPose[i];
+				const Maths::Matrix3x4 local(pose.position, pose.rotation, pose.scale);
+				const i32 parent = m_Joints[i].parent;
+
+				modelPose[i] = (parent < 0 ? m_RootTransform : modelPose[parent]) * local;
+			}
+		}
+
+		void Skeleton::GetSkinMatrices(const Maths::Matrix3x4* modelPose, Maths::Matrix3x4* skinMatrices) const
+		{
+			const u32 count = GetJointCount();
+			for (u32 i = 0; i < count; i++)
+				skinMatrices[i] = modelPose[i] * m_Joints[i].inverseBindMatrix;
+		}
+
+		void Skeleton::SortParentsFirst(const std::vector<i32>& parents, std::vector<u32>& order)
+		{
+			const u32 count = static_cast<u32>(parents.size());
+			order.clear();
+			order.reserve(count);
+
+			std::vector<std::vector<u32>> children(count);
+			std::vector<u32> stack;
+			for (u32 i = 0; i < count; i++)
+			{
+				if (parents[i] >= 0 && parents[i] < static_cast<i32>(count) && parents[i] != static_cast<i32>(i))
+					children[parents[i]].push_back(i);
+				else
+					stack.push_back(i);
+			}
+
+			// Depth first from the roots, children pushed in reverse so they come out in their original order
+			std::reverse(stack.begin(), stack.end());
+			while (!stack.empty())
+			{
+				const u32 joint = stack.back();
+				stack.pop_back();
+				order.push_back(joint);
+
+				for (auto child = children[joint].rbegin(); child != children[joint].rend(); ++child)
+					stack.push_back(*child);
+			}
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "lmpch.h"
+#include "Maths/Maths.h"
+#include "Maths/Matrix3x4.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Local transform of one joint, relative to its parent
+		struct JointPose
+		{
+			Maths::Vector3 position = Maths::Vector3(0.0f);
+			Maths::Quaternion rotation;
+			Maths::Vector3 scale = Maths::Vector3(1.0f);
+		};
+
+		struct Joint
+		{
+			String name;
+			i32 parent = -1;
+			JointPose bindPose;
+
+			// Mesh space to the joint's space at bind time
+			Maths::Matrix3x4 inverseBindMatrix;
+		};
+
+		// Joint hierarchy of a skinned model. Joints are stored parents first, so a model space pose
+		// is built in one pass over the array.
+		class LUMOS_EXPORT Skeleton
+		{
+		public:
+			Skeleton() = default;
+
+			// parent must already be in the skeleton, or -1 for a root
+			u32 AddJoint(const String& name, i32 parent, const JointPose& bindPose, const Maths::Matrix3x4& inverseBindMatrix);
+			i32 FindJoint(const String& name) const;
+
+			u32 GetJointCount() const { return static_cast<u32>(m_Joints.size()); }
+			const Joint& GetJoint(u32 index) const { return m_Joints[index]; }
+			const std::vector<Joint>& GetJoints() const { return m_Joints; }
+
+			// Transform above the root joints (the nodes they hang from in the source file)
+			void SetRootTransform(const Maths::Matrix3x4& transform) { m_RootTransform = transform; }
+			const Maths::Matrix3x4& GetRootTransform() const { return m_RootTransform; }
+
+			void GetBindPose(JointPose* localPose) const;
+
+			// localPose and modelPose hold GetJointCount() entries
+			void GetModelPose(const JointPose* localPose, Maths::Matrix3x4* modelPose) const;
+			void GetSkinMatrices(const Maths::Matrix3x4* modelPose, Maths::Matrix3x4* skinMatrices) const;
+
+			// Order that visits every parent before its children, for importers whose joints come in any order
+			static void SortParentsFirst(const std::vector<i32>& parents, std::vector<u32>& order);
+
+		private:
+			std::vector<Joint> m_Joints;
+			Maths::Matrix3x4 m_RootTransform;
+		};
+	}
+}
@@ -0,0 +1,204 @@
+#include "lmpch.h"
+#include "SkinnedMesh.h"
+#include "Graphics/API/VertexBuffer.h"
+#include "Core/Profiler.h"
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		SkinWeights SkinWeights::Create(const u32* joints, const float* weights, u32 count)
+		{
+			SkinWeights result;
+			result.weights[0] = 0.0f;
+
+			for (u32 i = 0; i < count; i++)
+			{
+				if (weights[i] <= 0.0f)
+					continue;
+
+				// Insertion into the four heaviest so far
+				for (u32 slot = 0; slot < 4; slot++)
+				{
+					if (weights[i] > result.weights[slot])
+					{
+						for (u32 move = 3; move > slot; move--)
+						{
+							result.joints[move] = result.joints[move - 1];
+							result.weights[move] = result.weights[move - 1];
+						}
+
+						result.joints[slot] = static_cast<u16>(joints[i]);
+						result.weights[slot] = weights[i];
+						break;
+					}
+				}
+			}
+
+			const float total = result.weights[0] + result.weights[1] + result.weights[2] + result.weights[3];
+			if (total <= 0.0f)
+				return SkinWeights();
+
+			for (u32 slot = 0; slot < 4; slot++)
+				result.weights[slot] /= total;
+
+			return result;
+		}
+
+		SkinnedMesh::SkinnedMesh(Ref<VertexArray>& vertexArray, Ref<IndexBuffer>& indexBuffer, const Ref<Maths::BoundingBox>& boundingBox, const Vertex* vertices, const SkinWeights* weights, u32 vertexCount)
+			: Mesh(vertexArray, indexBuffer, boundingBox)
+			, m_BindVertices(vertices, vertices + vertexCount)
+			, m_SkinnedVertices(vertices, vertices + vertexCount)
+			, m_Weights(weights, weights + vertexCount)
+		{
+		}
+
+		SkinnedMesh::~SkinnedMesh()
+		{
+		}
+
+		void SkinnedMesh::Skin(const Maths::Matrix3x4* skinMatrices, u32 jointCount)
+		{
+			LUMOS_PROFILE_FUNC;
+
+			if (jointCount == 0)
+				return;
+
+			m_Columns.resize(jointCount * 16);
+			for (u32 i = 0; i < jointCount; i++)
+			{
+				const Maths::Matrix3x4& m = skinMatrices[i];
+				float* column = m_Columns.data() + i * 16;
+
+				column[0] = m.m00_; column[1] = m.m10_; column[2] = m.m20_; column[3] = 0.0f;
+				column[4] = m.m01_; column[5] = m.m11_; column[6] = m.m21_; column[7] = 0.0f;
+				column[8] = m.m02_; column[9] = m.m12_; column[10] = m.m22_; column[11] = 0.0f;
+				column[12] = m.m03_; column[13] = m.m13_; column[14] = m.m23_; column[15] = 0.0f;
+			}
+
+			const u32 vertexCount = GetVertexCount();
+			const u32 lastJoint = jointCount - 1;
+			const float* columns = m_Columns.data();
+
+#ifdef LUMOS_SSE
+			__m128 boundsMin = _mm_set1_ps(Maths::M_INFINITY);
+			__m128 boundsMax = _mm_set1_ps(-Maths::M_INFINITY);
+			alignas(16) float out[4];
+
+			for (u32 v = 0; v < vertexCount; v++)
+			{
+				const SkinWeights& skin = m_Weights[v];
+				const Vertex& bind = m_BindVertices[v];
+				Vertex& skinned = m_SkinnedVertices[v];
+
+				// Weighted sum of the joint matrices, one column at a time
+				const float* m = columns + Maths::Min<u32>(skin.joints[0], lastJoint) * 16;
+				__m128 weight = _mm_set1_ps(skin.weights[0]);
+				__m128 c0 = _mm_mul_ps(_mm_loadu_ps(m), weight);
+				__m128 c1 = _mm_mul_ps(_mm_loadu_ps(m + 4), weight);
+				__m128 c2 = _mm_mul_ps(_mm_loadu_ps(m + 8), weight);
+				__m128 c3 = _mm_mul_ps(_mm_loadu_ps(m + 12), weight);
+
+				for (u32 k = 1; k < 4 && skin.weights[k] > 0.0f; k++)
+				{
+					m = columns + Maths::Min<u32>(skin.joints[k], lastJoint) * 16;
+					weight = _mm_set1_ps(skin.weights[k]);
+					c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(m), weight));
+					c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(m + 4), weight));
+					c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(m + 8), weight));
+					c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(m + 12), weight));
+				}
+
+				__m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(bind.Position.x)), _mm_mul_ps(c1, _mm_set1_ps(bind.Position.y))),
+					_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(bind.Position.z)), c3));
+				boundsMin = _mm_min_ps(boundsMin, position);
+				boundsMax = _mm_max_ps(boundsMax, position);
+				_mm_store_ps(out, position);
+				skinned.Position = Maths::Vector3(out[0], out[1], out[2]);
+
+				// Normals and tangents by the same matrix, fine for the uniform scales skeletons use
+				__m128 normal = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(bind.Normal.x)), _mm_mul_ps(c1, _mm_set1_ps(bind.Normal.y))), _mm_mul_ps(c2, _mm_set1_ps(bind.Normal.z)));
+				__m128 tangent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(bind.Tangent.x)), _mm_mul_ps(c1, _mm_set1_ps(bind.Tangent.y))), _mm_mul_ps(c2, _mm_set1_ps(bind.Tangent.z)));
+
+				_mm_store_ps(out, normal);
+				skinned.Normal = Maths::Vector3(out[0], out[1], out[2]);
+				_mm_store_ps(out, tangent);
+				skinned.Tangent = Maths::Vector3(out[0], out[1], out[2]);
+
+				skinned.Normal.Normalize();
+				skinned.Tangent.Normalize();
+			}
+
+			if (vertexCount > 0 && m_BoundingBox)
+			{
+				alignas(16) float min[4];
+				alignas(16) float max[4];
+				_mm_store_ps(min, boundsMin);
+				_mm_store_ps(max, boundsMax);
+				m_BoundingBox->Define(Maths::Vector3(min[0], min[1], min[2]), Maths::Vector3(max[0], max[1], max[2]));
+			}
+#else
+			Maths::BoundingBox bounds;
+			for (u32 v = 0; v < vertexCount; v++)
+			{
+				const SkinWeights& skin = m_Weights[v];
+				const Vertex& bind = m_BindVertices[v];
+				Vertex& skinned = m_SkinnedVertices[v];
+
+				float blended[16];
+				for (u32 i = 0; i < 16; i++)
+					blended[i] = 0.0f;
+
+				for (u32 k = 0; k < 4; k++)
+				{
+					if (skin.weights[k] <= 0.0f)
+						continue;
+
+					const float* m = columns + Maths::Min<u32>(skin.joints[k], lastJoint) * 16;
+					for (u32 i = 0; i < 16; i++)
+						blended[i] += m[i] * skin.weights[k];
+				}
+
+				auto transform = [&blended](const Maths::Vector3& v, float w)
+				{
+					return Maths::Vector3(blended[0] * v.x + blended[4] * v.y + blended[8] * v.z + blended[12] * w,
+						blended[1] * v.x + blended[5] * v.y + blended[9] * v.z + blended[13] * w,
+						blended[2] * v.x + blended[6] * v.y + blended[10] * v.z + blended[14] * w);
+				};
+
+				skinned.Position = transform(bind.Position, 1.0f);
+				skinned.Normal = transform(bind.Normal, 0.0f).Normalized();
+				skinned.Tangent = transform(bind.Tangent, 0.0f).Normalized();
+				bounds.Merge(skinned.Position);
+			}
+
+			if (vertexCount > 0 && m_BoundingBox)
+				*m_BoundingBox = bounds;
+#endif
+
+			m_Dirty = true;
+		}
+
+		void SkinnedMesh::Upload()
+		{
+			if (!m_Dirty || !m_VertexArray || m_SkinnedVertices.empty())
+				return;
+
+			// The buffer is DYNAMIC and host visible, so the vertices are written straight into its mapping.
+			// SetDataSub recreates the whole buffer on Vulkan.
+			VertexBuffer* buffer = m_VertexArray->GetBuffer(0);
+			Vertex* vertices = buffer ? buffer->GetPointer<Vertex>() : nullptr;
+			if (vertices)
+			{
+				memcpy(vertices, m_SkinnedVertices.data(), m_SkinnedVertices.size() * sizeof(Vertex));
+				buffer->ReleasePointer();
+			}
+
+			m_Dirty = false;
+		}
+	}
+}
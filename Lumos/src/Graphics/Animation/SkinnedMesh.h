@@ -0,0 +1,50 @@
+#pragma once
+#include "lmpch.h"
+#include "Graphics/Mesh.h"
+#include "Maths/Matrix3x4.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// Up to four joints per vertex, heaviest first, weights summing to one
+		struct SkinWeights
+		{
+			u16 joints[4] = { 0, 0, 0, 0 };
+			float weights[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+			// Keeps the four heaviest influences and normalises them
+			static SkinWeights Create(const u32* joints, const float* weights, u32 count);
+		};
+
+		// Mesh deformed by a skeleton on the CPU. The bind pose vertices are kept, Skin writes the deformed
+		// copy and Upload pushes it to the mesh's dynamic vertex buffer, so renderers draw it like any other mesh.
+		class LUMOS_EXPORT SkinnedMesh : public Mesh
+		{
+		public:
+			SkinnedMesh(Ref<VertexArray>& vertexArray, Ref<IndexBuffer>& indexBuffer, const Ref<Maths::BoundingBox>& boundingBox, const Vertex* vertices, const SkinWeights* weights, u32 vertexCount);
+			~SkinnedMesh() override;
+
+			// Deforms the bind pose by skinMatrices and refits the bounding box. Touches nothing but this
+			// mesh's CPU copy, so meshes can be skinned on worker threads.
+			void Skin(const Maths::Matrix3x4* skinMatrices, u32 jointCount);
+
+			// Uploads the last skinned vertices, main thread only
+			void Upload();
+
+			u32 GetVertexCount() const { return static_cast<u32>(m_BindVertices.size()); }
+			const std::vector<Vertex>& GetBindVertices() const { return m_BindVertices; }
+			const std::vector<Vertex>& GetSkinnedVertices() const { return m_SkinnedVertices; }
+			const std::vector<SkinWeights>& GetSkinWeights() const { return m_Weights; }
+
+		private:
+			std::vector<Vertex> m_BindVertices;
+			std::vector<Vertex> m_SkinnedVertices;
+			std::vector<SkinWeights> m_Weights;
+
+			// Skin matrices transposed to columns, so a vertex is blended and transformed without shuffles
+			std::vector<float> m_Columns;
+			bool m_Dirty = false;
+		};
+	}
+}
@@ -0,0 +1,424 @@
+#include "lmpch.h"
+#include "ChunkedTerrain.h"
+#include "Material.h"
+#include "App/SceneGraph.h"
+#include "ECS/Component/MeshComponent.h"
+#include "ECS/Component/MaterialComponent.h"
+#include "Maths/Transform.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <simplex/simplexnoise.h>
+#include <imgui/imgui.h>
+#include <unordered_set>
+
+namespace Lumos
+{
+	// Fraction of the distance a viewer has to move past a level boundary before a tile changes level
+	static const float LOD_HYSTERESIS = 0.1f;
+
+	ChunkedTerrain::ChunkedTerrain(const TerrainSettings& settings)
+		: m_Settings(settings)
+	{
+		m_Settings.tileResolution = Maths::Max(m_Settings.tileResolution, 1u);
+		m_Settings.lodCount = Maths::Max(m_Settings.lodCount, 1u);
+	}
+
+	ChunkedTerrain::~ChunkedTerrain()
+	{
+		// Jobs write into m_Finished
+		System::JobSystem::Wait(m_Context);
+	}
+
+	float ChunkedTerrain::GetHeight(float x, float z) const
+	{
+		const float sampleX = x / m_Settings.sampleSpacing;
+		const float sampleZ = z / m_Settings.sampleSpacing;
+
+		const float low = octave_noise_2d(1.0f, 0.1f, 0.01f, sampleX / m_Settings.lowScale, sampleZ / m_Settings.lowScale) * 0.5f + 0.5f;
+		const float detail = octave_noise_2d(5.0f, 0.45f, 0.01f, sampleX, sampleZ) * 0.5f + 0.5f;
+		const float value = low * m_Settings.lowWeight + detail * (1.0f - m_Settings.lowWeight);
+
+		return value * value * value * m_Settings.heightScale;
+	}
+
+	Maths::Vector3 ChunkedTerrain::GetNormal(float x, float z, float step) const
+	{
+		Maths::Vector3 normal(GetHeight(x - step, z) - GetHeight(x + step, z), 2.0f * step, GetHeight(x, z - step) - GetHeight(x, z + step));
+		normal.Normalize();
+		return normal;
+	}
+
+	void ChunkedTerrain::BuildTile(const TerrainTileCoord& coord, u32 lod, TerrainTileData& tile) const
+	{
+		lod = Maths::Min(lod, m_Settings.lodCount - 1);
+
+		const u32 quads = Maths::Max(m_Settings.tileResolution >> lod, 1u);
+		const u32 side = quads + 1;
+		const float step = m_Settings.tileSize / static_cast<float>(quads);
+		const float originX = static_cast<float>(coord.x) * m_Settings.tileSize;
+		const float originZ = static_cast<float>(coord.z) * m_Settings.tileSize;
+		const float texScale = m_Settings.textureScale / m_Settings.sampleSpacing;
+
+		tile.coord = coord;
+		tile.lod = lod;
+		tile.bounds.Clear();
+
+		// Heights with a one sample border, so normals at the edges match the neighbouring tiles
+		const u32 border = side + 2;
+		std::vector<float> heights(border * border);
+		for (u32 i = 0; i < border; i++)
+		{
+			for (u32 j = 0; j < border; j++)
+			{
+				const float x = originX + (static_cast<float>(i) - 1.0f) * step;
+				const float z = originZ + (static_cast<float>(j) - 1.0f) * step;
+				heights[i * border + j] = GetHeight(x, z);
+			}
+		}
+
+		const u32 ringCount = quads * 4;
+		tile.vertices.resize(side * side + ringCount);
+		tile.indices.clear();
+		tile.indices.reserve(quads * quads * 6 + ringCount * 6);
+
+		for (u32 i = 0; i < side; i++)
+		{
+			for (u32 j = 0; j < side; j++)
+			{
+				const float height = heights[(i + 1) * border + (j + 1)];
+				const float left = heights[i * border + (j + 1)];
+				const float right = heights[(i + 2) * border + (j + 1)];
+				const float back = heights[(i + 1) * border + j];
+				const float front = heights[(i + 1) * border + (j + 2)];
+
+				Graphics::Vertex& vertex = tile.vertices[i * side + j];
+				vertex.Position = Maths::Vector3(static_cast<float>(i) * step, height, static_cast<float>(j) * step);
+				vertex.TexCoords = Maths::Vector2((originX + vertex.Position.x) * texScale, (originZ + vertex.Position.z) * texScale);
+
+				vertex.Normal = Maths::Vector3(left - right, 2.0f * step, back - front);
+				vertex.Normal.Normalize();
+				vertex.Tangent = Maths::Vector3(2.0f * step, right - left, 0.0f);
+				vertex.Tangent.Normalize();
+
+				tile.bounds.Merge(vertex.Position);
+			}
+		}
+
+		for (u32 i = 0; i < quads; i++)
+		{
+			for (u32 j = 0; j < quads; j++)
+			{
+				const u32 a = i * side + j;
+				const u32 b = (i + 1) * side + j;
+				const u32 c = (i + 1) * side + (j + 1);
+				const u32 d = i * side + (j + 1);
+
+				tile.indices.insert(tile.indices.end(), { c, b, a, a, d, c });
+			}
+		}
+
+		// Skirt: the border vertices walked once around the tile (+x along z = 0, +z along x = max, then back),
+		// each with a copy hanging below it. Walking this way round keeps the skirt facing outwards.
+		const float skirtDepth = m_Settings.skirtDepth * static_cast<float>(lod + 1);
+		std::vector<u32> ring(ringCount);
+		for (u32 k = 0; k < quads; k++)
+		{
+			ring[k] = k * side;
+			ring[quads + k] = quads * side + k;
+			ring[quads * 2 + k] = (quads - k) * side + quads;
+			ring[quads * 3 + k] = quads - k;
+		}
+
+		for (u32 k = 0; k < ringCount; k++)
+		{
+			Graphics::Vertex& skirt = tile.vertices[side * side + k];
+			skirt = tile.vertices[ring[k]];
+			skirt.Position.y -= skirtDepth;
+			tile.bounds.Merge(skirt.Position);
+		}
+
+		for (u32 k = 0; k < ringCount; k++)
+		{
+			const u32 next = (k + 1) % ringCount;
+			const u32 top0 = ring[k];
+			const u32 top1 = ring[next];
+			const u32 bottom0 = side * side + k;
+			const u32 bottom1 = side * side + next;
+
+			tile.indices.insert(tile.indices.end(), { top0, top1, bottom0, top1, bottom1, bottom0 });
+		}
+	}
+
+	TerrainTileCoord ChunkedTerrain::GetTileCoord(const Maths::Vector3& position) const
+	{
+		TerrainTileCoord coord;
+		coord.x = static_cast<i32>(floorf(position.x / m_Settings.tileSize));
+		coord.z = static_cast<i32>(floorf(position.z / m_Settings.tileSize));
+		return coord;
+	}
+
+	float ChunkedTerrain::GetTileDistance(const TerrainTileCoord& coord, const Maths::Vector3& position) const
+	{
+		// Distance to the tile's box, taking the full height range as its vertical extent
+		const float minX = static_cast<float>(coord.x) * m_Settings.tileSize;
+		const float minZ = static_cast<float>(coord.z) * m_Settings.tileSize;
+
+		const float dx = Maths::Max(Maths::Max(minX - position.x, position.x - (minX + m_Settings.tileSize)), 0.0f);
+		const float dz = Maths::Max(Maths::Max(minZ - position.z, position.z - (minZ + m_Settings.tileSize)), 0.0f);
+		const float dy = Maths::Max(Maths::Max(-position.y, position.y - m_Settings.heightScale), 0.0f);
+
+		return sqrtf(dx * dx + dy * dy + dz * dz);
+	}
+
+	u32 ChunkedTerrain::GetRawLod(float distance) const
+	{
+		if (distance < m_Settings.lodDistance)
+			return 0;
+
+		const u32 lod = 1 + static_cast<u32>(floorf(log2f(distance / m_Settings.lodDistance)));
+		return Maths::Min(lod, m_Settings.lodCount - 1);
+	}
+
+	u32 ChunkedTerrain::SelectLod(float distance, u32 currentLod) const
+	{
+		const u32 lod = GetRawLod(distance);
+		if (currentLod == NO_LOD || currentLod == lod)
+			return lod;
+
+		const u32 nearLod = GetRawLod(distance * (1.0f - LOD_HYSTERESIS));
+		const u32 farLod = GetRawLod(distance * (1.0f + LOD_HYSTERESIS));
+
+		return (currentLod >= nearLod && currentLod <= farLod) ? currentLod : lod;
+	}
+
+	void ChunkedTerrain::SelectTiles(const Maths::Vector3& position, std::vector<TerrainTileRequest>& tiles) const
+	{
+		tiles.clear();
+
+		const TerrainTileCoord centre = GetTileCoord(position);
+		const i32 radius = static_cast<i32>(ceilf(m_Settings.viewDistance / m_Settings.tileSize));
+
+		for (i32 x = centre.x - radius; x <= centre.x + radius; x++)
+		{
+			for (i32 z = centre.z - radius; z <= centre.z + radius; z++)
+			{
+				TerrainTileRequest request;
+				request.coord.x = x;
+				request.coord.z = z;
+				request.distance = GetTileDistance(request.coord, position);
+
+				if (request.distance > m_Settings.viewDistance)
+					continue;
+
+				request.lod = SelectLod(request.distance);
+				tiles.push_back(request);
+			}
+		}
+
+		std::sort(tiles.begin(), tiles.end(), [](const TerrainTileRequest& a, const TerrainTileRequest& b)
+		{
+			if (a.distance != b.distance)
+				return a.distance < b.distance;
+			return a.coord.GetKey() < b.coord.GetKey();
+		});
+
+		if (tiles.size() > m_Settings.maxResidentTiles)
+			tiles.resize(m_Settings.maxResidentTiles);
+	}
+
+	Ref<Graphics::Mesh> ChunkedTerrain::CreateMesh(const TerrainTileData& tile) const
+	{
+		Ref<Graphics::VertexArray> vertexArray = Ref<Graphics::VertexArray>(Graphics::VertexArray::Create());
+
+		Graphics::VertexBuffer* buffer = Graphics::VertexBuffer::Create(Graphics::BufferUsage::STATIC);
+		buffer->SetData(static_cast<u32>(sizeof(Graphics::Vertex) * tile.vertices.size()), (void*)tile.vertices.data());
+
+		Graphics::BufferLayout layout;
+		layout.Push<Maths::Vector3>("position");
+		layout.Push<Maths::Vector4>("colour");
+		layout.Push<Maths::Vector2>("texCoord");
+		layout.Push<Maths::Vector3>("normal");
+		layout.Push<Maths::Vector3>("tangent");
+		buffer->SetLayout(layout);
+
+		vertexArray->PushBuffer(buffer);
+
+		Ref<Graphics::IndexBuffer> indexBuffer = Ref<Graphics::IndexBuffer>(Graphics::IndexBuffer::Create(const_cast<u32*>(tile.indices.data()), static_cast<u32>(tile.indices.size())));
+
+		return CreateRef<Graphics::Mesh>(vertexArray, indexBuffer, CreateRef<Maths::BoundingBox>(tile.bounds));
+	}
+
+	void ChunkedTerrain::DestroyTile(entt::registry& registry, Tile& tile)
+	{
+		if (tile.entity != entt::null && registry.valid(tile.entity))
+			registry.destroy(tile.entity);
+
+		tile.entity = entt::null;
+		tile.lod = NO_LOD;
+		tile.bytes = 0;
+	}
+
+	void ChunkedTerrain::Update(entt::registry& registry, entt::entity terrainEntity, const Maths::Vector3& viewerPosition)
+	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		{
+			std::lock_guard<std::mutex> lock(m_FinishedMutex);
+			for (auto& tile : m_Finished)
+				m_Ready.push_back(std::move(tile));
+			m_Finished.clear();
+		}
+
+		auto parentTransform = registry.try_get<Maths::Transform>(terrainEntity);
+		u32 uploads = 0;
+		u32 kept = 0;
+
+		for (auto& data : m_Ready)
+		{
+			auto it = m_Tiles.find(data->coord.GetKey());
+
+			// Evicted, or superseded by a request for another level, while it was being built
+			if (it == m_Tiles.end() || it->second.pendingLod != data->lod)
+			{
+				m_BuildsInFlight--;
+				continue;
+			}
+
+			if (uploads == m_Settings.maxUploadsPerFrame)
+			{
+				m_Ready[kept++] = std::move(data);
+				continue;
+			}
+
+			Tile& tile = it->second;
+			auto mesh = CreateMesh(*data);
+
+			if (tile.entity == entt::null || !registry.valid(tile.entity))
+			{
+				tile.entity = registry.create();
+
+				auto& transform = registry.emplace<Maths::Transform>(tile.entity);
+				transform.SetLocalPosition(Maths::Vector3(static_cast<float>(tile.coord.x) * m_Settings.tileSize, 0.0f, static_cast<float>(tile.coord.z) * m_Settings.tileSize));
+				transform.SetWorldMatrix(parentTransform ? parentTransform->GetWorldMatrix() : Maths::Matrix4());
+
+				registry.emplace<Hierarchy>(tile.entity, terrainEntity);
+				registry.emplace<NameComponent>(tile.entity, "Terrain Tile " + StringFormat::ToString(tile.coord.x) + " " + StringFormat::ToString(tile.coord.z));
+
+				if (m_Material)
+					registry.emplace<MaterialComponent>(tile.entity, m_Material);
+			}
+
+			// The old level stays on screen until its replacement is ready, so switching never leaves a hole
+			registry.emplace_or_replace<MeshComponent>(tile.entity, mesh);
+
+			tile.lod = data->lod;
+			tile.pendingLod = NO_LOD;
+			tile.bytes = static_cast<u32>(data->vertices.size() * sizeof(Graphics::Vertex) + data->indices.size() * sizeof(u32));
+
+			m_BuildsInFlight--;
+			m_BuiltTiles++;
+			uploads++;
+		}
+		m_Ready.resize(kept);
+
+		SelectTiles(viewerPosition, m_Requests);
+
+		std::unordered_set<u64> wanted;
+		wanted.reserve(m_Requests.size());
+		for (auto& request : m_Requests)
+			wanted.insert(request.coord.GetKey());
+
+		for (auto it = m_Tiles.begin(); it != m_Tiles.end();)
+		{
+			if (wanted.find(it->first) == wanted.end())
+			{
+				DestroyTile(registry, it->second);
+				it = m_Tiles.erase(it);
+			}
+			else
+				++it;
+		}
+
+		m_ResidentCount = 0;
+		m_ResidentBytes = 0;
+
+		for (auto& request : m_Requests)
+		{
+			Tile& tile = m_Tiles[request.coord.GetKey()];
+			tile.coord = request.coord;
+
+			// Removed from the scene behind our back (e.g. a snapshot restore)
+			if (tile.entity != entt::null && !registry.valid(tile.entity))
+			{
+				tile.entity = entt::null;
+				tile.lod = NO_LOD;
+				tile.bytes = 0;
+			}
+
+			if (tile.entity != entt::null)
+			{
+				m_ResidentCount++;
+				m_ResidentBytes += tile.bytes;
+			}
+
+			const u32 lod = SelectLod(request.distance, tile.lod);
+			if (lod == tile.lod || lod == tile.pendingLod)
+				continue;
+
+			// Requests are nearest first, so the tiles under the viewer always go first
+			if (m_BuildsInFlight >= m_Settings.maxBuildsInFlight)
+				continue;
+
+			tile.pendingLod = lod;
+			m_BuildsInFlight++;
+
+			const TerrainTileCoord coord = request.coord;
+			System::JobSystem::Execute(m_Context, [this, coord, lod]()
+			{
+				auto data = CreateScope<TerrainTileData>();
+				BuildTile(coord, lod, *data);
+
+				std::lock_guard<std::mutex> lock(m_FinishedMutex);
+				m_Finished.push_back(std::move(data));
+			});
+		}
+
+		m_UpdateTime = timer.GetMS(1000.0f);
+	}
+
+	void ChunkedTerrain::Clear(entt::registry& registry)
+	{
+		System::JobSystem::Wait(m_Context);
+
+		for (auto& tile : m_Tiles)
+			DestroyTile(registry, tile.second);
+
+		m_Tiles.clear();
+		m_Finished.clear();
+		m_Ready.clear();
+		m_BuildsInFlight = 0;
+		m_ResidentCount = 0;
+		m_ResidentBytes = 0;
+	}
+
+	void ChunkedTerrain::OnImGui()
+	{
+		ImGui::Text("Resident Tiles : %u / %u", m_ResidentCount, static_cast<u32>(m_Requests.size()));
+		ImGui::Text("Resident Memory : %.2f MB", static_cast<double>(m_ResidentBytes) / (1024.0 * 1024.0));
+		ImGui::Text("Builds In Flight : %u", m_BuildsInFlight);
+		ImGui::Text("Tiles Built : %u", m_BuiltTiles);
+		ImGui::Text("Update Time : %5.2f ms", m_UpdateTime);
+
+		u32 lodTiles[16] = {};
+		for (auto& tile : m_Tiles)
+		{
+			if (tile.second.lod < 16)
+				lodTiles[tile.second.lod]++;
+		}
+
+		for (u32 i = 0; i < Maths::Min(m_Settings.lodCount, 16u); i++)
+			ImGui::Text("Level %u : %u tiles", i, lodTiles[i]);
+	}
+}
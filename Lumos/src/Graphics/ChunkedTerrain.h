@@ -0,0 +1,146 @@
+#pragma once
+#include "lmpch.h"
+#include "Mesh.h"
+#include "Core/JobSystem.h"
+
+#include <entt/entt.hpp>
+#include <mutex>
+
+namespace Lumos
+{
+	class Material;
+
+	struct TerrainSettings
+	{
+		// World size of a tile, and the quads along its side at level 0 (a power of two)
+		float tileSize = 64.0f;
+		u32 tileResolution = 64;
+
+		// Each level halves the resolution and is used twice as far away as the one before,
+		// level 0 inside lodDistance, level 1 up to 2 * lodDistance and so on
+		u32 lodCount = 5;
+		float lodDistance = 96.0f;
+
+		// Tiles are kept inside viewDistance, nearest first, up to maxResidentTiles
+		float viewDistance = 1024.0f;
+		u32 maxResidentTiles = 1024;
+
+		// Height is (lowWeight * low + (1 - lowWeight) * detail)^3 * heightScale. The noise is sampled every
+		// sampleSpacing world units, the low frequency layer lowScale times coarser.
+		float heightScale = 150.0f;
+		float sampleSpacing = 1.0f;
+		float lowScale = 10.0f;
+		float lowWeight = 0.4f;
+		float textureScale = 1.0f / 16.0f;
+
+		// Skirts hang this far below the tile edges (times the level) to hide cracks between levels
+		float skirtDepth = 2.0f;
+
+		// Limits on the work started and finished per update, so streaming never stalls a frame
+		u32 maxBuildsInFlight = 32;
+		u32 maxUploadsPerFrame = 8;
+	};
+
+	struct TerrainTileCoord
+	{
+		i32 x = 0;
+		i32 z = 0;
+
+		bool operator==(const TerrainTileCoord& other) const { return x == other.x && z == other.z; }
+		u64 GetKey() const { return (u64(u32(x)) << 32) | u64(u32(z)); }
+	};
+
+	// Mesh data of one tile, in the tile's space (its origin is the tile's minimum corner)
+	struct TerrainTileData
+	{
+		TerrainTileCoord coord;
+		u32 lod = 0;
+		std::vector<Graphics::Vertex> vertices;
+		std::vector<u32> indices;
+		Maths::BoundingBox bounds;
+	};
+
+	struct TerrainTileRequest
+	{
+		TerrainTileCoord coord;
+		u32 lod;
+		float distance;
+	};
+
+	// Heightfield split into fixed size tiles, geomipmapped by distance to the viewer and streamed in and
+	// out around it. Tiles are built on the job system and uploaded on the main thread as child entities of
+	// the terrain entity, so every renderer draws and culls them like any other mesh.
+	class LUMOS_EXPORT ChunkedTerrain
+	{
+	public:
+		explicit ChunkedTerrain(const TerrainSettings& settings = TerrainSettings());
+		~ChunkedTerrain();
+
+		// Height at a point in terrain space. Tiles sample this, so neighbours always agree on their shared edge.
+		float GetHeight(float x, float z) const;
+		Maths::Vector3 GetNormal(float x, float z, float step) const;
+
+		// Builds the mesh of a tile at a level, including its skirt. Touches nothing but tile.
+		void BuildTile(const TerrainTileCoord& coord, u32 lod, TerrainTileData& tile) const;
+
+		TerrainTileCoord GetTileCoord(const Maths::Vector3& position) const;
+		float GetTileDistance(const TerrainTileCoord& coord, const Maths::Vector3& position) const;
+
+		// Level for a tile at distance. Passing the tile's current level adds hysteresis, so a viewer
+		// standing on a boundary doesn't rebuild the tile every frame.
+		u32 SelectLod(float distance, u32 currentLod = NO_LOD) const;
+
+		// Tiles that should be resident around position, nearest first
+		void SelectTiles(const Maths::Vector3& position, std::vector<TerrainTileRequest>& tiles) const;
+
+		// Streams the tiles around viewerPosition (in terrain space) in and out as children of terrainEntity
+		void Update(entt::registry& registry, entt::entity terrainEntity, const Maths::Vector3& viewerPosition);
+
+		// Destroys every tile entity. Call before the terrain entity is destroyed.
+		void Clear(entt::registry& registry);
+
+		void SetMaterial(const Ref<Material>& material) { m_Material = material; }
+		const Ref<Material>& GetMaterial() const { return m_Material; }
+
+		const TerrainSettings& GetSettings() const { return m_Settings; }
+
+		u32 GetResidentTileCount() const { return m_ResidentCount; }
+		u64 GetResidentBytes() const { return m_ResidentBytes; }
+
+		void OnImGui();
+
+		static const u32 NO_LOD = ~0u;
+
+	private:
+		struct Tile
+		{
+			TerrainTileCoord coord;
+			entt::entity entity = entt::null;
+			u32 lod = NO_LOD;
+			u32 pendingLod = NO_LOD;
+			u32 bytes = 0;
+		};
+
+		u32 GetRawLod(float distance) const;
+		Ref<Graphics::Mesh> CreateMesh(const TerrainTileData& tile) const;
+		void DestroyTile(entt::registry& registry, Tile& tile);
+
+		TerrainSettings m_Settings;
+		Ref<Material> m_Material;
+
+		std::unordered_map<u64, Tile> m_Tiles;
+		std::vector<TerrainTileRequest> m_Requests;
+
+		// Built by jobs, waiting for the main thread to upload them
+		std::vector<Scope<TerrainTileData>> m_Finished;
+		std::vector<Scope<TerrainTileData>> m_Ready;
+		std::mutex m_FinishedMutex;
+		System::JobSystem::Context m_Context;
+		u32 m_BuildsInFlight = 0;
+
+		u32 m_ResidentCount = 0;
+		u64 m_ResidentBytes = 0;
+		u32 m_BuiltTiles = 0;
+		float m_UpdateTime = 0.0f;
+	};
+}
@@ -0,0 +1,1134 @@
+#include "lmpch.h"
+#include "CookedTexture.h"
+#include "Core/VFS.h"
+#include "Core/OS/FileSystem.h"
+#include "Utilities/LoadImage.h"
+#include "Maths/Maths.h"
+
+#define COOKED_TEXTURE_MAGIC (u32('L') | (u32('T') << 8) | (u32('E') << 16) | (u32('X') << 24))
+#define COOKED_TEXTURE_VERSION 3
+#define COOKED_TEXTURE_EXTENSION "ltex"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		static const u32 COOKED_FLAG_SRGB = BIT(0);
+
+		struct CookedTextureHeader
+		{
+			u32 magic;
+			u32 version;
+			u32 format;
+			u32 flags;
+			u32 width;
+			u32 height;
+			u32 faceCount;
+			u32 mipCount;
+			u64 sourceSize;
+			i64 sourceTime;
+			u64 sourceHash;
+		};
+
+		// ---- Colour space ----
+
+		static float SRGBToLinear(float c)
+		{
+			return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+		}
+
+		static float LinearToSRGB(float c)
+		{
+			return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+		}
+
+		static u8 ToUnorm8(float value)
+		{
+			return static_cast<u8>(Maths::Clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+
+		static void ToLinear(const u8* rgba, u32 count, const CookOptions& options, float* out)
+		{
+			static const std::array<float, 256> s_SRGBTable = []()
+			{
+				std::array<float, 256> table;
+				for (u32 i = 0; i < 256; i++)
+					table[i] = SRGBToLinear(i / 255.0f);
+				return table;
+			}();
+
+			for (u32 i = 0; i < count * 4; i += 4)
+			{
+				for (u32 c = 0; c < 3; c++)
+				{
+					if (options.normalMap)
+						out[i + c] = rgba[i + c] / 255.0f * 2.0f - 1.0f;
+					else if (options.sRGB)
+						out[i + c] = s_SRGBTable[rgba[i + c]];
+					else
+						out[i + c] = rgba[i + c] / 255.0f;
+				}
+				out[i + 3] = rgba[i + 3] / 255.0f;
+			}
+		}
+
+		static void FromLinear(const float* texels, u32 count, const CookOptions& options, u8* out)
+		{
+			for (u32 i = 0; i < count * 4; i += 4)
+			{
+				if (options.normalMap)
+				{
+					Maths::Vector3 normal(texels[i], texels[i + 1], texels[i + 2]);
+					const float length = normal.Length();
+					normal = length > Maths::M_EPSILON ? normal / length : Maths::Vector3(0.0f, 0.0f, 1.0f);
+
+					out[i + 0] = ToUnorm8(normal.x * 0.5f + 0.5f);
+					out[i + 1] = ToUnorm8(normal.y * 0.5f + 0.5f);
+					out[i + 2] = ToUnorm8(normal.z * 0.5f + 0.5f);
+				}
+				else
+				{
+					for (u32 c = 0; c < 3; c++)
+						out[i + c] = ToUnorm8(options.sRGB ? LinearToSRGB(texels[i + c]) : texels[i + c]);
+				}
+				out[i + 3] = ToUnorm8(texels[i + 3]);
+			}
+		}
+
+		// 2x2 box filter, odd edges repeat their last texel
+		static void Downsample(const std::vector<float>& src, u32 srcWidth, u32 srcHeight, std::vector<float>& dst, u32 dstWidth, u32 dstHeight)
+		{
+			dst.resize(dstWidth * dstHeight * 4);
+			for (u32 y = 0; y < dstHeight; y++)
+			{
+				const u32 y0 = Maths::Min(y * 2, srcHeight - 1);
+				const u32 y1 = Maths::Min(y * 2 + 1, srcHeight - 1);
+				for (u32 x = 0; x < dstWidth; x++)
+				{
+					const u32 x0 = Maths::Min(x * 2, srcWidth - 1);
+					const u32 x1 = Maths::Min(x * 2 + 1, srcWidth - 1);
+					for (u32 c = 0; c < 4; c++)
+					{
+						dst[(y * dstWidth + x) * 4 + c] = 0.25f * (src[(y0 * srcWidth + x0) * 4 + c] + src[(y0 * srcWidth + x1) * 4 + c]
+							+ src[(y1 * srcWidth + x0) * 4 + c] + src[(y1 * srcWidth + x1) * 4 + c]);
+					}
+				}
+			}
+		}
+
+		// ---- Block helpers ----
+
+		class BlockWriter
+		{
+		public:
+			explicit BlockWriter(u8* block) : m_Block(block) { memset(m_Block, 0, 16); }
+
+			void Write(u32 value, u32 count)
+			{
+				for (u32 i = 0; i < count; i++, m_Position++)
+				{
+					if ((value >> i) & 1)
+						m_Block[m_Position >> 3] |= u8(1 << (m_Position & 7));
+				}
+			}
+
+		private:
+			u8* m_Block;
+			u32 m_Position = 0;
+		};
+
+		class BlockReader
+		{
+		public:
+			explicit BlockReader(const u8* block) : m_Block(block) {}
+
+			u32 Read(u32 count)
+			{
+				u32 value = 0;
+				for (u32 i = 0; i < count; i++, m_Position++)
+					value |= u32((m_Block[m_Position >> 3] >> (m_Position & 7)) & 1) << i;
+				return value;
+			}
+
+		private:
+			const u8* m_Block;
+			u32 m_Position = 0;
+		};
+
+		// Principal axis of the texels by power iteration on their covariance. Returns false for a flat block.
+		template<u32 Channels>
+		static bool PrincipalAxis(const float (*texels)[4], u32 count, float* mean, float* axis)
+		{
+			float covariance[Channels][Channels] = {};
+			for (u32 c = 0; c < Channels; c++)
+			{
+				mean[c] = 0.0f;
+				for (u32 i = 0; i < count; i++)
+					mean[c] += texels[i][c];
+				mean[c] /= float(count);
+			}
+
+			for (u32 i = 0; i < count; i++)
+				for (u32 a = 0; a < Channels; a++)
+					for (u32 b = 0; b < Channels; b++)
+						covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+
+			// Starting from the widest channel converges in a few steps for typical blocks
+			u32 widest = 0;
+			for (u32 c = 1; c < Channels; c++)
+			{
+				if (covariance[c][c] > covariance[widest][widest])
+					widest = c;
+			}
+
+			if (covariance[widest][widest] < 1e-4f)
+				return false;
+
+			for (u32 c = 0; c < Channels; c++)
+				axis[c] = covariance[widest][c];
+
+			for (u32 iteration = 0; iteration < 8; iteration++)
+			{
+				float next[Channels] = {};
+				float length = 0.0f;
+				for (u32 a = 0; a < Channels; a++)
+				{
+					for (u32 b = 0; b < Channels; b++)
+						next[a] += covariance[a][b] * axis[b];
+					length += next[a] * next[a];
+				}
+
+				if (length < 1e-12f)
+					return false;
+
+				length = 1.0f / sqrtf(length);
+				for (u32 c = 0; c < Channels; c++)
+					axis[c] = next[c] * length;
+			}
+
+			return true;
+		}
+
+		template<u32 Channels>
+		static void FitEndpoints(const float (*texels)[4], u32 count, float* low, float* high)
+		{
+			float mean[4], axis[4];
+			if (!PrincipalAxis<Channels>(texels, count, mean, axis))
+			{
+				for (u32 c = 0; c < Channels; c++)
+					low[c] = high[c] = mean[c];
+				return;
+			}
+
+			float minT = FLT_MAX, maxT = -FLT_MAX;
+			for (u32 i = 0; i < count; i++)
+			{
+				float t = 0.0f;
+				for (u32 c = 0; c < Channels; c++)
+					t += (texels[i][c] - mean[c]) * axis[c];
+				minT = Maths::Min(minT, t);
+				maxT = Maths::Max(maxT, t);
+			}
+
+			for (u32 c = 0; c < Channels; c++)
+			{
+				low[c] = Maths::Clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+				high[c] = Maths::Clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+			}
+		}
+
+		// Least squares endpoints for fixed interpolation weights (weight of high per texel)
+		template<u32 Channels>
+		static bool RefineEndpoints(const float (*texels)[4], const float* weights, u32 count, float* low, float* high)
+		{
+			float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+			float ax[4] = {}, bx[4] = {};
+			for (u32 i = 0; i < count; i++)
+			{
+				const float b = weights[i];
+				const float a = 1.0f - b;
+				aa += a * a;
+				ab += a * b;
+				bb += b * b;
+				for (u32 c = 0; c < Channels; c++)
+				{
+					ax[c] += a * texels[i][c];
+					bx[c] += b * texels[i][c];
+				}
+			}
+
+			const float determinant = aa * bb - ab * ab;
+			if (fabsf(determinant) < 1e-6f)
+				return false;
+
+			const float inverse = 1.0f / determinant;
+			for (u32 c = 0; c < Channels; c++)
+			{
+				low[c] = Maths::Clamp((ax[c] * bb - bx[c] * ab) * inverse, 0.0f, 255.0f);
+				high[c] = Maths::Clamp((bx[c] * aa - ax[c] * ab) * inverse, 0.0f, 255.0f);
+			}
+
+			return true;
+		}
+
+		// ---- BC1 colour ----
+
+		static u16 PackRGB565(const float* colour)
+		{
+			const u32 r = static_cast<u32>(Maths::Clamp(colour[0] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+			const u32 g = static_cast<u32>(Maths::Clamp(colour[1] * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f));
+			const u32 b = static_cast<u32>(Maths::Clamp(colour[2] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+			return static_cast<u16>((r << 11) | (g << 5) | b);
+		}
+
+		static void UnpackRGB565(u16 packed, u32* colour)
+		{
+			const u32 r = (packed >> 11) & 31;
+			const u32 g = (packed >> 5) & 63;
+			const u32 b = packed & 31;
+			colour[0] = (r << 3) | (r >> 2);
+			colour[1] = (g << 2) | (g >> 4);
+			colour[2] = (b << 3) | (b >> 2);
+		}
+
+		// Three colour mode (c0 <= c1) has a transparent black fourth entry, BC3 always uses four colours
+		static void BuildColourPalette(u16 c0, u16 c1, bool forceFourColour, u8 (*palette)[4])
+		{
+			u32 a[3], b[3];
+			UnpackRGB565(c0, a);
+			UnpackRGB565(c1, b);
+
+			const bool fourColour = forceFourColour || c0 > c1;
+			for (u32 c = 0; c < 3; c++)
+			{
+				palette[0][c] = u8(a[c]);
+				palette[1][c] = u8(b[c]);
+				palette[2][c] = u8(fourColour ? (2 * a[c] + b[c]) / 3 : (a[c] + b[c]) / 2);
+				palette[3][c] = u8(fourColour ? (a[c] + 2 * b[c]) / 3 : 0);
+			}
+
+			palette[0][3] = palette[1][3] = palette[2][3] = 255;
+			palette[3][3] = fourColour ? 255 : 0;
+		}
+
+		static float ColourError(const u8* a, const float* b)
+		{
+			float error = 0.0f;
+			for (u32 c = 0; c < 3; c++)
+				error += (a[c] - b[c]) * (a[c] - b[c]);
+			return error;
+		}
+
+		// Picks the indices for c0 / c1 (already ordered for the wanted mode) and returns the block error
+		static float ChooseColourIndices(u16 c0, u16 c1, bool forceFourColour, const float (*texels)[4], const bool* transparent, u32* indices)
+		{
+			u8 palette[4][4];
+			BuildColourPalette(c0, c1, forceFourColour, palette);
+			const bool fourColour = forceFourColour || c0 > c1;
+
+			float error = 0.0f;
+			for (u32 i = 0; i < 16; i++)
+			{
+				if (transparent[i])
+				{
+					indices[i] = 3;
+					continue;
+				}
+
+				float best = FLT_MAX;
+				for (u32 p = 0; p < (fourColour ? 4u : 3u); p++)
+				{
+					const float e = ColourError(palette[p], texels[i]);
+					if (e < best)
+					{
+						best = e;
+						indices[i] = p;
+					}
+				}
+				error += best;
+			}
+
+			return error;
+		}
+
+		static void EncodeColourBlock(const u8* rgba, u8* block, bool allowTransparency)
+		{
+			float texels[16][4];
+			float opaque[16][4];
+			bool transparent[16];
+			u32 opaqueCount = 0;
+
+			for (u32 i = 0; i < 16; i++)
+			{
+				for (u32 c = 0; c < 4; c++)
+					texels[i][c] = rgba[i * 4 + c];
+
+				transparent[i] = allowTransparency && rgba[i * 4 + 3] < 128;
+				if (!transparent[i])
+					memcpy(opaque[opaqueCount++], texels[i], sizeof(texels[i]));
+			}
+
+			u16 c0 = 0, c1 = 0xffff;
+			u32 indices[16];
+			for (u32 i = 0; i < 16; i++)
+				indices[i] = 3;
+
+			if (opaqueCount > 0)
+			{
+				const bool threeColour = opaqueCount < 16;
+				static const float FourColourWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+				static const float ThreeColourWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+				float low[4], high[4];
+				FitEndpoints<3>(opaque, opaqueCount, low, high);
+
+				float bestError = FLT_MAX;
+				u32 candidateIndices[16];
+				for (u32 iteration = 0; iteration < 3; iteration++)
+				{
+					// The mode is picked by the order of the packed endpoints
+					u16 a = PackRGB565(low);
+					u16 b = PackRGB565(high);
+					const bool swapped = threeColour ? a > b : a < b;
+					if (swapped)
+						std::swap(a, b);
+
+					const float error = ChooseColourIndices(a, b, false, texels, transparent, candidateIndices);
+					if (error >= bestError)
+						break;
+
+					bestError = error;
+					c0 = a;
+					c1 = b;
+					memcpy(indices, candidateIndices, sizeof(indices));
+
+					// Palette weights are of c1, which is the high endpoint unless the pair was swapped
+					float weights[16];
+					u32 count = 0;
+					for (u32 i = 0; i < 16; i++)
+					{
+						if (transparent[i])
+							continue;
+
+						const float weight = (threeColour ? ThreeColourWeights : FourColourWeights)[indices[i]];
+						weights[count++] = swapped ? 1.0f - weight : weight;
+					}
+
+					if (bestError == 0.0f || !RefineEndpoints<3>(opaque, weights, count, low, high))
+						break;
+				}
+			}
+
+			block[0] = u8(c0);
+			block[1] = u8(c0 >> 8);
+			block[2] = u8(c1);
+			block[3] = u8(c1 >> 8);
+
+			u32 bits = 0;
+			for (u32 i = 0; i < 16; i++)
+				bits |= indices[i] << (i * 2);
+
+			block[4] = u8(bits);
+			block[5] = u8(bits >> 8);
+			block[6] = u8(bits >> 16);
+			block[7] = u8(bits >> 24);
+		}
+
+		static void DecodeColourBlock(const u8* block, u8* rgba, bool forceFourColour)
+		{
+			const u16 c0 = u16(block[0] | (block[1] << 8));
+			const u16 c1 = u16(block[2] | (block[3] << 8));
+			const u32 bits = u32(block[4]) | (u32(block[5]) << 8) | (u32(block[6]) << 16) | (u32(block[7]) << 24);
+
+			u8 palette[4][4];
+			BuildColourPalette(c0, c1, forceFourColour, palette);
+
+			for (u32 i = 0; i < 16; i++)
+				memcpy(rgba + i * 4, palette[(bits >> (i * 2)) & 3], 4);
+		}
+
+		// ---- BC4 single channel, the alpha of BC3 and both channels of BC5 ----
+
+		static void BuildChannelPalette(u32 a0, u32 a1, u32* palette)
+		{
+			palette[0] = a0;
+			palette[1] = a1;
+			if (a0 > a1)
+			{
+				for (u32 i = 1; i < 7; i++)
+					palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+			}
+			else
+			{
+				for (u32 i = 1; i < 5; i++)
+					palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+		}
+
+		static u32 ChooseChannelIndices(u32 a0, u32 a1, const u8* values, u32 stride, u32* indices)
+		{
+			u32 palette[8];
+			BuildChannelPalette(a0, a1, palette);
+
+			u32 error = 0;
+			for (u32 i = 0; i < 16; i++)
+			{
+				u32 best = ~0u;
+				for (u32 p = 0; p < 8; p++)
+				{
+					const i32 difference = i32(palette[p]) - i32(values[i * stride]);
+					const u32 e = u32(difference * difference);
+					if (e < best)
+					{
+						best = e;
+						indices[i] = p;
+					}
+				}
+				error += best;
+			}
+
+			return error;
+		}
+
+		static void EncodeChannelBlock(const u8* values, u32 stride, u8* block)
+		{
+			u32 minValue = 255, maxValue = 0;
+			u32 innerMin = 255, innerMax = 0;
+			for (u32 i = 0; i < 16; i++)
+			{
+				const u32 value = values[i * stride];
+				minValue = Maths::Min(minValue, value);
+				maxValue = Maths::Max(maxValue, value);
+				if (value != 0 && value != 255)
+				{
+					innerMin = Maths::Min(innerMin, value);
+					innerMax = Maths::Max(innerMax, value);
+				}
+			}
+
+			u32 a0 = maxValue, a1 = minValue;
+			u32 indices[16];
+			u32 error = ChooseChannelIndices(a0, a1, values, stride, indices);
+
+			// Six value mode keeps exact 0 and 255 and spends the rest of the range on the other texels
+			if (error > 0 && (minValue == 0 || maxValue == 255))
+			{
+				if (innerMin > innerMax)
+					innerMin = innerMax = minValue;
+
+				u32 sixIndices[16];
+				const u32 sixError = ChooseChannelIndices(innerMin, innerMax, values, stride, sixIndices);
+				if (sixError < error)
+				{
+					a0 = innerMin;
+					a1 = innerMax;
+					memcpy(indices, sixIndices, sizeof(indices));
+				}
+			}
+
+			block[0] = u8(a0);
+			block[1] = u8(a1);
+
+			u64 bits = 0;
+			for (u32 i = 0; i < 16; i++)
+				bits |= u64(indices[i]) << (i * 3);
+
+			for (u32 i = 0; i < 6; i++)
+				block[2 + i] = u8(bits >> (i * 8));
+		}
+
+		static void DecodeChannelBlock(const u8* block, u8* values, u32 stride)
+		{
+			u32 palette[8];
+			BuildChannelPalette(block[0], block[1], palette);
+
+			u64 bits = 0;
+			for (u32 i = 0; i < 6; i++)
+				bits |= u64(block[2 + i]) << (i * 8);
+
+			for (u32 i = 0; i < 16; i++)
+				values[i * stride] = u8(palette[(bits >> (i * 3)) & 7]);
+		}
+
+		// ---- BC7, mode 6 only : one subset, RGBA endpoints of 7 bits plus a p-bit each, 4 bit indices ----
+
+		static const u32 BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		struct BC7Mode6
+		{
+			u32 endpoints[2][4]; // 7 bit
+			u32 pbits[2];
+			u32 indices[16];
+			float error = FLT_MAX;
+		};
+
+		static u32 BC7Interpolate(u32 e0, u32 e1, u32 index)
+		{
+			return ((64 - BC7Weights[index]) * e0 + BC7Weights[index] * e1 + 32) >> 6;
+		}
+
+		static void BC7TryEndpoints(const float (*texels)[4], const float* low, const float* high, BC7Mode6& best)
+		{
+			for (u32 p = 0; p < 4; p++)
+			{
+				BC7Mode6 candidate;
+				candidate.pbits[0] = p & 1;
+				candidate.pbits[1] = p >> 1;
+
+				u32 expanded[2][4];
+				for (u32 c = 0; c < 4; c++)
+				{
+					candidate.endpoints[0][c] = static_cast<u32>(Maths::Clamp((low[c] - candidate.pbits[0]) * 0.5f + 0.5f, 0.0f, 127.0f));
+					candidate.endpoints[1][c] = static_cast<u32>(Maths::Clamp((high[c] - candidate.pbits[1]) * 0.5f + 0.5f, 0.0f, 127.0f));
+					expanded[0][c] = (candidate.endpoints[0][c] << 1) | candidate.pbits[0];
+					expanded[1][c] = (candidate.endpoints[1][c] << 1) | candidate.pbits[1];
+				}
+
+				float palette[16][4];
+				for (u32 i = 0; i < 16; i++)
+					for (u32 c = 0; c < 4; c++)
+						palette[i][c] = float(BC7Interpolate(expanded[0][c], expanded[1][c], i));
+
+				candidate.error = 0.0f;
+				for (u32 i = 0; i < 16 && candidate.error < best.error; i++)
+				{
+					float bestTexel = FLT_MAX;
+					for (u32 index = 0; index < 16; index++)
+					{
+						float e = 0.0f;
+						for (u32 c = 0; c < 4; c++)
+							e += (palette[index][c] - texels[i][c]) * (palette[index][c] - texels[i][c]);
+
+						if (e < bestTexel)
+						{
+							bestTexel = e;
+							candidate.indices[i] = index;
+						}
+					}
+					candidate.error += bestTexel;
+				}
+
+				if (candidate.error < best.error)
+					best = candidate;
+			}
+		}
+
+		static void EncodeBC7Block(const u8* rgba, u8* block)
+		{
+			float texels[16][4];
+			for (u32 i = 0; i < 16; i++)
+				for (u32 c = 0; c < 4; c++)
+					texels[i][c] = rgba[i * 4 + c];
+
+			float low[4], high[4];
+			FitEndpoints<4>(texels, 16, low, high);
+
+			BC7Mode6 best;
+			BC7TryEndpoints(texels, low, high, best);
+
+			for (u32 iteration = 0; iteration < 2 && best.error > 0.0f; iteration++)
+			{
+				float weights[16];
+				for (u32 i = 0; i < 16; i++)
+					weights[i] = BC7Weights[best.indices[i]] / 64.0f;
+
+				if (!RefineEndpoints<4>(texels, weights, 16, low, high))
+					break;
+
+				const float previous = best.error;
+				BC7TryEndpoints(texels, low, high, best);
+				if (best.error >= previous)
+					break;
+			}
+
+			// The anchor index is stored without its top bit, so it must be below 8
+			if (best.indices[0] & 8)
+			{
+				for (u32 c = 0; c < 4; c++)
+					std::swap(best.endpoints[0][c], best.endpoints[1][c]);
+				std::swap(best.pbits[0], best.pbits[1]);
+				for (u32 i = 0; i < 16; i++)
+					best.indices[i] = 15 - best.indices[i];
+			}
+
+			BlockWriter writer(block);
+			writer.Write(1 << 6, 7);
+			for (u32 c = 0; c < 4; c++)
+			{
+				writer.Write(best.endpoints[0][c], 7);
+				writer.Write(best.endpoints[1][c], 7);
+			}
+			writer.Write(best.pbits[0], 1);
+			writer.Write(best.pbits[1], 1);
+			writer.Write(best.indices[0], 3);
+			for (u32 i = 1; i < 16; i++)
+				writer.Write(best.indices[i], 4);
+		}
+
+		static void DecodeBC7Block(const u8* block, u8* rgba)
+		{
+			// The cooker only writes mode 6, anything else decodes as magenta to stand out
+			if ((block[0] & 0x7f) != 0x40)
+			{
+				for (u32 i = 0; i < 16; i++)
+				{
+					rgba[i * 4 + 0] = 255;
+					rgba[i * 4 + 1] = 0;
+					rgba[i * 4 + 2] = 255;
+					rgba[i * 4 + 3] = 255;
+				}
+				return;
+			}
+
+			BlockReader reader(block);
+			reader.Read(7);
+
+			u32 endpoints[2][4];
+			for (u32 c = 0; c < 4; c++)
+			{
+				endpoints[0][c] = reader.Read(7) << 1;
+				endpoints[1][c] = reader.Read(7) << 1;
+			}
+
+			const u32 p0 = reader.Read(1);
+			const u32 p1 = reader.Read(1);
+			for (u32 c = 0; c < 4; c++)
+			{
+				endpoints[0][c] |= p0;
+				endpoints[1][c] |= p1;
+			}
+
+			for (u32 i = 0; i < 16; i++)
+			{
+				const u32 index = reader.Read(i == 0 ? 3 : 4);
+				for (u32 c = 0; c < 4; c++)
+					rgba[i * 4 + c] = u8(BC7Interpolate(endpoints[0][c], endpoints[1][c], index));
+			}
+		}
+
+		// ---- CookedTexture ----
+
+		bool CookedTexture::IsCompressedFormat(TextureFormat format)
+		{
+			return format == TextureFormat::BC1 || format == TextureFormat::BC3 || format == TextureFormat::BC5 || format == TextureFormat::BC7;
+		}
+
+		static u32 GetBlockSize(TextureFormat format)
+		{
+			return format == TextureFormat::BC1 ? 8 : 16;
+		}
+
+		u32 CookedTexture::GetLevelSize(TextureFormat format, u32 width, u32 height)
+		{
+			if (!IsCompressedFormat(format))
+				return width * height * 4;
+
+			return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+		}
+
+		void CookedTexture::EncodeBlock(TextureFormat format, const u8* rgba, u8* block)
+		{
+			switch (format)
+			{
+			case TextureFormat::BC1:
+				EncodeColourBlock(rgba, block, true);
+				break;
+			case TextureFormat::BC3:
+				EncodeChannelBlock(rgba + 3, 4, block);
+				EncodeColourBlock(rgba, block + 8, false);
+				break;
+			case TextureFormat::BC5:
+				EncodeChannelBlock(rgba + 0, 4, block);
+				EncodeChannelBlock(rgba + 1, 4, block + 8);
+				break;
+			case TextureFormat::BC7:
+				EncodeBC7Block(rgba, block);
+				break;
+			default:
+				LUMOS_ASSERT(false, "[CookedTexture] Not a block compressed format");
+				break;
+			}
+		}
+
+		void CookedTexture::DecodeBlock(TextureFormat format, const u8* block, u8* rgba)
+		{
+			switch (format)
+			{
+			case TextureFormat::BC1:
+				DecodeColourBlock(block, rgba, false);
+				break;
+			case TextureFormat::BC3:
+				DecodeColourBlock(block + 8, rgba, true);
+				DecodeChannelBlock(block, rgba + 3, 4);
+				break;
+			case TextureFormat::BC5:
+				DecodeChannelBlock(block, rgba + 0, 4);
+				DecodeChannelBlock(block + 8, rgba + 1, 4);
+				for (u32 i = 0; i < 16; i++)
+				{
+					rgba[i * 4 + 2] = 0;
+					rgba[i * 4 + 3] = 255;
+				}
+				break;
+			case TextureFormat::BC7:
+				DecodeBC7Block(block, rgba);
+				break;
+			default:
+				LUMOS_ASSERT(false, "[CookedTexture] Not a block compressed format");
+				break;
+			}
+		}
+
+		static void CompressLevel(TextureFormat format, const u8* rgba, u32 width, u32 height, u8* out)
+		{
+			const u32 blockSize = GetBlockSize(format);
+			const u32 blocksWide = (width + 3) / 4;
+			const u32 blocksHigh = (height + 3) / 4;
+
+			u8 texels[16 * 4];
+			for (u32 by = 0; by < blocksHigh; by++)
+			{
+				for (u32 bx = 0; bx < blocksWide; bx++)
+				{
+					// Blocks past the edge of small mips repeat the last row / column
+					for (u32 y = 0; y < 4; y++)
+					{
+						const u32 sy = Maths::Min(by * 4 + y, height - 1);
+						for (u32 x = 0; x < 4; x++)
+						{
+							const u32 sx = Maths::Min(bx * 4 + x, width - 1);
+							memcpy(texels + (y * 4 + x) * 4, rgba + (sy * width + sx) * 4, 4);
+						}
+					}
+
+					CookedTexture::EncodeBlock(format, texels, out + (by * blocksWide + bx) * blockSize);
+				}
+			}
+		}
+
+		static void DecompressLevel(TextureFormat format, const u8* blocks, u32 width, u32 height, u8* rgba)
+		{
+			const u32 blockSize = GetBlockSize(format);
+			const u32 blocksWide = (width + 3) / 4;
+			const u32 blocksHigh = (height + 3) / 4;
+
+			u8 texels[16 * 4];
+			for (u32 by = 0; by < blocksHigh; by++)
+			{
+				for (u32 bx = 0; bx < blocksWide; bx++)
+				{
+					CookedTexture::DecodeBlock(format, blocks + (by * blocksWide + bx) * blockSize, texels);
+
+					for (u32 y = 0; y < 4 && by * 4 + y < height; y++)
+						for (u32 x = 0; x < 4 && bx * 4 + x < width; x++)
+							memcpy(rgba + ((by * 4 + y) * width + bx * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+
+		void CookedTexture::Clear()
+		{
+			m_Data.clear();
+			m_Levels.clear();
+			m_PayloadOffset = 0;
+			m_Format = TextureFormat::NONE;
+			m_SRGB = false;
+			m_Width = m_Height = 0;
+			m_FaceCount = m_MipCount = 0;
+			m_Source = CookSource();
+		}
+
+		// Builds the file image from the header fields and one buffer per level (face major)
+		void CookedTexture::Assemble(const std::vector<std::vector<u8>>& levels)
+		{
+			m_PayloadOffset = static_cast<u32>(sizeof(CookedTextureHeader) + levels.size() * sizeof(Level));
+			m_Levels.resize(levels.size());
+
+			u32 payloadSize = 0;
+			for (u32 face = 0; face < m_FaceCount; face++)
+			{
+				for (u32 mip = 0; mip < m_MipCount; mip++)
+				{
+					Level& level = m_Levels[face * m_MipCount + mip];
+					level.width = Maths::Max(m_Width >> mip, 1u);
+					level.height = Maths::Max(m_Height >> mip, 1u);
+					level.offset = payloadSize;
+					level.size = static_cast<u32>(levels[face * m_MipCount + mip].size());
+					payloadSize += level.size;
+				}
+			}
+
+			CookedTextureHeader header;
+			header.magic = COOKED_TEXTURE_MAGIC;
+			header.version = COOKED_TEXTURE_VERSION;
+			header.format = static_cast<u32>(m_Format);
+			header.flags = m_SRGB ? COOKED_FLAG_SRGB : 0;
+			header.width = m_Width;
+			header.height = m_Height;
+			header.faceCount = m_FaceCount;
+			header.mipCount = m_MipCount;
+			header.sourceSize = m_Source.size;
+			header.sourceTime = m_Source.modifiedTime;
+			header.sourceHash = m_Source.hash;
+
+			m_Data.resize(m_PayloadOffset + payloadSize);
+			memcpy(m_Data.data(), &header, sizeof(header));
+			memcpy(m_Data.data() + sizeof(header), m_Levels.data(), m_Levels.size() * sizeof(Level));
+			for (u32 i = 0; i < m_Levels.size(); i++)
+				memcpy(m_Data.data() + m_PayloadOffset + m_Levels[i].offset, levels[i].data(), levels[i].size());
+		}
+
+		bool CookedTexture::Cook(const u8* const* faces, u32 faceCount, u32 width, u32 height, const CookOptions& options, const CookSource& source)
+		{
+			Clear();
+
+			if (!faces || (faceCount != 1 && faceCount != 6) || width == 0 || height == 0)
+				return false;
+
+			if (!IsCompressedFormat(options.format) && options.format != TextureFormat::RGBA8)
+			{
+				LUMOS_LOG_ERROR("[CookedTexture] Unsupported cook format");
+				return false;
+			}
+
+			m_Format = options.format;
+			m_SRGB = options.sRGB && !options.normalMap;
+			m_Width = width;
+			m_Height = height;
+			m_FaceCount = faceCount;
+			m_MipCount = options.generateMips ? Texture::CalculateMipMapCount(width, height) : 1;
+			m_Source = source;
+
+			std::vector<std::vector<u8>> levels(faceCount * m_MipCount);
+			std::vector<float> linear, next;
+			std::vector<u8> rgba;
+
+			for (u32 face = 0; face < faceCount; face++)
+			{
+				u32 levelWidth = width;
+				u32 levelHeight = height;
+
+				// Each mip is filtered from the float copy of the one above, so rounding never accumulates
+				linear.resize(width * height * 4);
+				ToLinear(faces[face], width * height, options, linear.data());
+
+				for (u32 mip = 0; mip < m_MipCount; mip++)
+				{
+					if (mip > 0)
+					{
+						const u32 nextWidth = Maths::Max(levelWidth / 2, 1u);
+						const u32 nextHeight = Maths::Max(levelHeight / 2, 1u);
+						Downsample(linear, levelWidth, levelHeight, next, nextWidth, nextHeight);
+						std::swap(linear, next);
+						levelWidth = nextWidth;
+						levelHeight = nextHeight;
+					}
+
+					const u8* source = faces[face];
+					if (mip > 0 || options.normalMap)
+					{
+						rgba.resize(levelWidth * levelHeight * 4);
+						FromLinear(linear.data(), levelWidth * levelHeight, options, rgba.data());
+						source = rgba.data();
+					}
+
+					std::vector<u8>& level = levels[face * m_MipCount + mip];
+					level.resize(GetLevelSize(m_Format, levelWidth, levelHeight));
+					if (IsCompressedFormat(m_Format))
+						CompressLevel(m_Format, source, levelWidth, levelHeight, level.data());
+					else
+						memcpy(level.data(), source, level.size());
+				}
+			}
+
+			Assemble(levels);
+			return true;
+		}
+
+		void CookedTexture::Decompress()
+		{
+			if (!IsCompressedFormat(m_Format))
+				return;
+
+			std::vector<std::vector<u8>> levels(m_Levels.size());
+			for (u32 i = 0; i < m_Levels.size(); i++)
+			{
+				levels[i].resize(m_Levels[i].width * m_Levels[i].height * 4);
+				DecompressLevel(m_Format, GetPayload() + m_Levels[i].offset, m_Levels[i].width, m_Levels[i].height, levels[i].data());
+			}
+
+			m_Format = TextureFormat::RGBA8;
+			Assemble(levels);
+		}
+
+		bool CookedTexture::Parse()
+		{
+			if (m_Data.size() < sizeof(CookedTextureHeader))
+				return false;
+
+			CookedTextureHeader header;
+			memcpy(&header, m_Data.data(), sizeof(header));
+
+			if (header.magic != COOKED_TEXTURE_MAGIC || header.version != COOKED_TEXTURE_VERSION)
+				return false;
+
+			m_Format = static_cast<TextureFormat>(header.format);
+			m_SRGB = (header.flags & COOKED_FLAG_SRGB) != 0;
+			m_Width = header.width;
+			m_Height = header.height;
+			m_FaceCount = header.faceCount;
+			m_MipCount = header.mipCount;
+			m_Source.size = header.sourceSize;
+			m_Source.modifiedTime = header.sourceTime;
+			m_Source.hash = header.sourceHash;
+
+			if (!IsCompressedFormat(m_Format) && m_Format != TextureFormat::RGBA8)
+				return false;
+
+			const size_t levelCount = size_t(m_FaceCount) * m_MipCount;
+			m_PayloadOffset = static_cast<u32>(sizeof(CookedTextureHeader) + levelCount * sizeof(Level));
+			if (levelCount == 0 || m_Data.size() < m_PayloadOffset)
+				return false;
+
+			m_Levels.resize(levelCount);
+			memcpy(m_Levels.data(), m_Data.data() + sizeof(CookedTextureHeader), levelCount * sizeof(Level));
+
+			for (auto& level : m_Levels)
+			{
+				if (size_t(m_PayloadOffset) + level.offset + level.size > m_Data.size())
+					return false;
+			}
+
+			return true;
+		}
+
+		bool CookedTexture::Save(const String& filePath) const
+		{
+			if (m_Data.empty())
+				return false;
+
+			return FileSystem::WriteFile(filePath, const_cast<u8*>(m_Data.data()), static_cast<u32>(m_Data.size()));
+		}
+
+		bool CookedTexture::Load(const String& filePath)
+		{
+			Clear();
+
+			String physicalPath;
+			if (!VFS::Get()->ResolvePhysicalPath(filePath, physicalPath))
+				return false;
+
+			const i64 size = FileSystem::GetFileSize(physicalPath);
+			if (size < i64(sizeof(CookedTextureHeader)))
+				return false;
+
+			m_Data.resize(static_cast<size_t>(size));
+			if (!FileSystem::ReadFile(physicalPath, m_Data.data(), size) || !Parse())
+			{
+				LUMOS_LOG_ERROR("Failed to load cooked texture {0}", filePath);
+				Clear();
+				return false;
+			}
+
+			return true;
+		}
+
+		bool CookedTexture::CookFile(const String& sourcePath, const String& cookedPath, const CookOptions& options)
+		{
+			String physicalPath;
+			if (!VFS::Get()->ResolvePhysicalPath(sourcePath, physicalPath))
+				return false;
+
+			u32 width = 0, height = 0, bits = 0;
+			bool isHDR = false;
+			u8* pixels = LoadImageFromFile(physicalPath, &width, &height, &bits, &isHDR);
+			if (!pixels)
+				return false;
+
+			bool result = false;
+			if (isHDR || bits != 32)
+				LUMOS_LOG_WARN("[CookedTexture] {0} is not RGBA8, not cooking it", sourcePath);
+			else
+			{
+				CookedTexture cooked;
+				result = cooked.Cook(pixels, width, height, options, DescribeSource(physicalPath)) && cooked.Save(cookedPath);
+			}
+
+			delete[] pixels;
+			return result;
+		}
+
+		String CookedTexture::GetCookedPath(const String& sourcePath)
+		{
+			const auto dot = sourcePath.find_last_of('.');
+			const auto slash = sourcePath.find_last_of("/\\");
+			if (dot == String::npos || (slash != String::npos && dot < slash))
+				return sourcePath + "." COOKED_TEXTURE_EXTENSION;
+
+			return sourcePath.substr(0, dot + 1) + COOKED_TEXTURE_EXTENSION;
+		}
+
+		bool CookedTexture::FindCooked(const String& filePath, String& outCookedPath, bool checkContent)
+		{
+			if (StringFormat::GetFilePathExtension(filePath) == COOKED_TEXTURE_EXTENSION)
+			{
+				outCookedPath = filePath;
+				return true;
+			}
+
+			String cookedPhysical;
+			const String cookedPath = GetCookedPath(filePath);
+			if (!VFS::Get()->ResolvePhysicalPath(cookedPath, cookedPhysical))
+				return false;
+
+			CookedTextureHeader header;
+			if (!FileSystem::ReadFile(cookedPhysical, &header, sizeof(header)) || header.magic != COOKED_TEXTURE_MAGIC || header.version != COOKED_TEXTURE_VERSION)
+				return false;
+
+			// Files cooked from memory, or shipped without their source, are used as they are
+			String sourcePhysical;
+			if (header.sourceSize != 0 && VFS::Get()->ResolvePhysicalPath(filePath, sourcePhysical))
+			{
+				if (u64(FileSystem::GetFileSize(sourcePhysical)) != header.sourceSize || FileSystem::GetModifiedTime(sourcePhysical) != header.sourceTime
+					|| (checkContent && HashSource(sourcePhysical) != header.sourceHash))
+				{
+					LUMOS_LOG_WARN("[CookedTexture] {0} is out of date, loading {1}", cookedPath, filePath);
+					return false;
+				}
+			}
+
+			outCookedPath = cookedPath;
+			return true;
+		}
+
+		u64 CookedTexture::HashSource(const String& physicalPath)
+		{
+			const i64 size = FileSystem::GetFileSize(physicalPath);
+			if (size <= 0)
+				return 0;
+
+			std::vector<u8> data(static_cast<size_t>(size));
+			if (!FileSystem::ReadFile(physicalPath, data.data(), size))
+				return 0;
+
+			u64 hash = 14695981039346656037ull;
+			for (u8 byte : data)
+			{
+				hash ^= byte;
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		CookSource CookedTexture::DescribeSource(const String& physicalPath)
+		{
+			CookSource source;
+			source.size = u64(Maths::Max(FileSystem::GetFileSize(physicalPath), i64(0)));
+			source.modifiedTime = FileSystem::GetModifiedTime(physicalPath);
+			source.hash = HashSource(physicalPath);
+			return source;
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "lmpch.h"
+#include "Graphics/API/Texture.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		struct CookOptions
+		{
+			// BC1, BC3, BC5, BC7 or RGBA8 (mips only)
+			TextureFormat format = TextureFormat::BC7;
+			// Mips are filtered in linear space and stored sRGB encoded again
+			bool sRGB = true;
+			// Mips are renormalised, the data is treated as linear
+			bool normalMap = false;
+			bool generateMips = true;
+		};
+
+		// The file a texture was cooked from, all 0 if there is none
+		struct CookSource
+		{
+			u64 size = 0;
+			i64 modifiedTime = 0; // FileSystem::GetModifiedTime
+			u64 hash = 0; // CookedTexture::HashSource
+		};
+
+		// Lumos cooked texture (.ltex). Every face and mip level is stored in its GPU format, so loading
+		// is one file read with no image decoding and no mip generation at runtime.
+		// Layout : CookedTextureHeader, one Level per face and mip (face major, the order Vulkan copies
+		// a cube in), then the payload. The class holds the file image, Save writes it out as is.
+		class LUMOS_EXPORT CookedTexture
+		{
+		public:
+			struct Level
+			{
+				u32 width;
+				u32 height;
+				u32 offset; // From the start of the payload
+				u32 size;
+			};
+
+			CookedTexture() = default;
+			~CookedTexture() = default;
+
+			// pixels is RGBA8, one image per face (1 for a 2D texture, 6 for a cube in +X -X +Y -Y +Z -Z order)
+			bool Cook(const u8* const* faces, u32 faceCount, u32 width, u32 height, const CookOptions& options, const CookSource& source = CookSource());
+			bool Cook(const u8* pixels, u32 width, u32 height, const CookOptions& options, const CookSource& source = CookSource()) { return Cook(&pixels, 1, width, height, options, source); }
+
+			bool Save(const String& filePath) const;
+			bool Load(const String& filePath);
+
+			// Expands every level to RGBA8, for devices without block compression support
+			void Decompress();
+
+			TextureFormat GetFormat() const { return m_Format; }
+			bool IsSRGB() const { return m_SRGB; }
+			u32 GetWidth() const { return m_Width; }
+			u32 GetHeight() const { return m_Height; }
+			u32 GetFaceCount() const { return m_FaceCount; }
+			u32 GetMipCount() const { return m_MipCount; }
+			const CookSource& GetSource() const { return m_Source; }
+
+			const Level& GetLevel(u32 face, u32 mip) const { return m_Levels[face * m_MipCount + mip]; }
+			const u8* GetLevelData(u32 face, u32 mip) const { return GetPayload() + GetLevel(face, mip).offset; }
+
+			// All levels, laid out as described by GetLevel
+			const u8* GetPayload() const { return m_Data.data() + m_PayloadOffset; }
+			u32 GetPayloadSize() const { return static_cast<u32>(m_Data.size() - m_PayloadOffset); }
+
+			bool Empty() const { return m_Data.empty(); }
+
+			// Cooks an image file (anything LoadImageFromFile reads, except HDR) to cookedPath
+			static bool CookFile(const String& sourcePath, const String& cookedPath, const CookOptions& options);
+
+			// foo/bar.png -> foo/bar.ltex
+			static String GetCookedPath(const String& sourcePath);
+
+			// True if filePath is itself cooked, or has an up to date cooked file next to it.
+			// A cooked file is stale once the source file's size or modification time differs from the ones it
+			// was cooked from. checkContent also compares the source's hash, which costs a read of the whole
+			// file, for the editor and cook tools. Loading only does the cheap check.
+			static bool FindCooked(const String& filePath, String& outCookedPath, bool checkContent = false);
+
+			// Content hash of a file on disk (FNV-1a), 0 if it can't be read
+			static u64 HashSource(const String& physicalPath);
+			static CookSource DescribeSource(const String& physicalPath);
+
+			static bool IsCompressedFormat(TextureFormat format);
+			static u32 GetLevelSize(TextureFormat format, u32 width, u32 height);
+
+			// One 4x4 block of RGBA8 texels
+			static void EncodeBlock(TextureFormat format, const u8* rgba, u8* block);
+			static void DecodeBlock(TextureFormat format, const u8* block, u8* rgba);
+
+		private:
+			void Clear();
+			bool Parse();
+			void Assemble(const std::vector<std::vector<u8>>& levels);
+
+			std::vector<u8> m_Data;
+			std::vector<Level> m_Levels;
+			u32 m_PayloadOffset = 0;
+
+			TextureFormat m_Format = TextureFormat::NONE;
+			bool m_SRGB = false;
+			u32 m_Width = 0;
+			u32 m_Height = 0;
+			u32 m_FaceCount = 0;
+			u32 m_MipCount = 0;
+			CookSource m_Source;
+		};
+	}
+}
@@ -55,21 +55,74 @@ namespace Lumos
 				m_DepthTexture = TextureDepth::Create(m_Width, m_Height);
 			}
 
-			m_Formats[0] = TextureFormat::RGBA32;
-			m_Formats[1] = TextureFormat::RGBA32;
-			m_Formats[2] = TextureFormat::RGBA32;
-			m_Formats[3] = TextureFormat::RGBA32;
-			m_Formats[4] = TextureFormat::RGBA32;
-
-			m_ScreenTex[SCREENTEX_COLOUR]->BuildTexture(m_Formats[0], m_Width, m_Height, false, false);
-			m_ScreenTex[SCREENTEX_POSITION]->BuildTexture(m_Formats[1], m_Width, m_Height, false, false);
-			m_ScreenTex[SCREENTEX_NORMALS]->BuildTexture(m_Formats[2], m_Width, m_Height, false, false);
-			m_ScreenTex[SCREENTEX_PBR]->BuildTexture(m_Formats[3], m_Width, m_Height, false, false);
-			m_ScreenTex[SCREENTEX_OFFSCREEN0]->BuildTexture(m_Formats[4], m_Width, m_Height, false, false);
+			m_Formats[SCREENTEX_DEPTH] = TextureFormat::DEPTH;
+			m_Formats[SCREENTEX_COLOUR] = TextureFormat::RGBA8;
+			m_Formats[SCREENTEX_NORMALS] = TextureFormat::RGBA16;
+			m_Formats[SCREENTEX_PBR] = TextureFormat::RGBA16;
+			m_Formats[SCREENTEX_OFFSCREEN0] = TextureFormat::RGBA32;
+			m_Formats[SCREENTEX_OFFSCREEN1] = TextureFormat::RGBA32;
+
+			m_ScreenTex[SCREENTEX_COLOUR]->BuildTexture(m_Formats[SCREENTEX_COLOUR], m_Width, m_Height, false, false);
+			m_ScreenTex[SCREENTEX_NORMALS]->BuildTexture(m_Formats[SCREENTEX_NORMALS], m_Width, m_Height, false, false);
+			m_ScreenTex[SCREENTEX_PBR]->BuildTexture(m_Formats[SCREENTEX_PBR], m_Width, m_Height, false, false);
+			m_ScreenTex[SCREENTEX_OFFSCREEN0]->BuildTexture(m_Formats[SCREENTEX_OFFSCREEN0], m_Width, m_Height, false, false);
 
 			m_DepthTexture->Resize(m_Width, m_Height);
 		}
 
+		u32 GBuffer::GetMemoryUsage() const
+		{
+			// Colour is RGBA8, normals and PBR RGBA16F, depth counted as 32 bit
+			const u32 bytesPerPixel = 4 + 8 + 8 + 4;
+			return m_Width * m_Height * bytesPerPixel;
+		}
+
+		Maths::Vector2 GBuffer::EncodeNormal(const Maths::Vector3& normal)
+		{
+			// Project onto the octahedron |x| + |y| + |z| = 1 and fold the lower half over the diagonals
+			const float invL1 = 1.0f / (Maths::Abs(normal.x) + Maths::Abs(normal.y) + Maths::Abs(normal.z));
+			Maths::Vector2 encoded(normal.x * invL1, normal.y * invL1);
+
+			if (normal.z < 0.0f)
+			{
+				const Maths::Vector2 folded(1.0f - Maths::Abs(encoded.y), 1.0f - Maths::Abs(encoded.x));
+				encoded.x = encoded.x >= 0.0f ? folded.x : -folded.x;
+				encoded.y = encoded.y >= 0.0f ? folded.y : -folded.y;
+			}
+
+			return encoded;
+		}
+
+		Maths::Vector3 GBuffer::DecodeNormal(const Maths::Vector2& encoded)
+		{
+			Maths::Vector3 normal(encoded.x, encoded.y, 1.0f - Maths::Abs(encoded.x) - Maths::Abs(encoded.y));
+			const float fold = Maths::Max(-normal.z, 0.0f);
+			normal.x += normal.x >= 0.0f ? -fold : fold;
+			normal.y += normal.y >= 0.0f ? -fold : fold;
+
+			return normal.Normalized();
+		}
+
+		Maths::Matrix4 GBuffer::BuildScreenToWorld(const Maths::Matrix4& projView)
+		{
+			const bool zeroToOne = (Maths::Matrix4::CONFIG_CLIP_CONTROL & CLIP_CONTROL_ZO_BIT) != 0;
+
+			// Texture coordinates and sampled depth to normalised device coordinates
+			const Maths::Matrix4 screenToNDC(
+				2.0f, 0.0f, 0.0f, -1.0f,
+				0.0f, 2.0f, 0.0f, -1.0f,
+				0.0f, 0.0f, zeroToOne ? 1.0f : 2.0f, zeroToOne ? 0.0f : -1.0f,
+				0.0f, 0.0f, 0.0f, 1.0f);
+
+			return projView.Inverse() * screenToNDC;
+		}
+
+		Maths::Vector3 GBuffer::ReconstructPosition(const Maths::Matrix4& screenToWorld, const Maths::Vector2& uv, float depth)
+		{
+			const Maths::Vector4 position = screenToWorld * Maths::Vector4(uv.x, uv.y, depth, 1.0f);
+			return position.ToVector3() / position.w;
+		}
+
 		void GBuffer::Bind(i32 mode)
 		{
 		}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lmpch.h"
+#include "Maths/Maths.h"
 
 namespace Lumos
 {
@@ -15,15 +16,16 @@ namespace Lumos
 		{
 			SCREENTEX_DEPTH = 0,	//Depth Buffer
 			SCREENTEX_STENCIL = 0,	//Stencil Buffer (Same Tex as Depth)
-			SCREENTEX_COLOUR = 1,	//Main Render
-			SCREENTEX_POSITION = 2,	//Deferred Render - World Space Positions
-			SCREENTEX_NORMALS = 3,	//Deferred Render - World Space Normals
-			SCREENTEX_PBR = 4,	//Metallic/Roughness/Ao Stored Here
-			SCREENTEX_OFFSCREEN0 = 5,	//Extra Textures for multipass post processing
-			SCREENTEX_OFFSCREEN1 = 6,    //Or Displaying scene in editor mode
+			SCREENTEX_COLOUR = 1,	//Main Render - Albedo
+			SCREENTEX_NORMALS = 2,	//Deferred Render - Octahedral World Space Normals (xy), Emissive red/green (zw)
+			SCREENTEX_PBR = 3,	//Metallic/Roughness/Ao Stored Here, Emissive blue (w)
+			SCREENTEX_OFFSCREEN0 = 4,	//Extra Textures for multipass post processing
+			SCREENTEX_OFFSCREEN1 = 5,    //Or Displaying scene in editor mode
 			SCREENTEX_MAX
 		};
 
+		// World space positions are not stored, the lighting pass rebuilds them from the depth buffer
+
 		class LUMOS_EXPORT GBuffer
 		{
 		public:
@@ -44,6 +46,17 @@ namespace Lumos
 			_FORCE_INLINE_ TextureDepth* GetDepthTexture() const { return m_DepthTexture; };
 			_FORCE_INLINE_ TextureFormat GetTextureFormat(u32 index) const { return m_Formats[index]; };
 
+			// Bytes used by the G-buffer targets and depth at the current size
+			u32 GetMemoryUsage() const;
+
+			// Encoding shared with DeferredColour.frag / DeferredLight.frag
+			static Maths::Vector2 EncodeNormal(const Maths::Vector3& normal);
+			static Maths::Vector3 DecodeNormal(const Maths::Vector2& encoded);
+
+			// Maps a texel's (u, v, depth) straight to world space, the API's depth range is folded in
+			static Maths::Matrix4 BuildScreenToWorld(const Maths::Matrix4& projView);
+			static Maths::Vector3 ReconstructPosition(const Maths::Matrix4& screenToWorld, const Maths::Vector2& uv, float depth);
+
 		private:
 			void Init();
 
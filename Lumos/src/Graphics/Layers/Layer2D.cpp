@@ -39,6 +39,11 @@ namespace Lumos
 		m_Renderer->Render(scene);
 	}
 
+	void Layer2D::OnImGui()
+	{
+		m_Renderer->OnImGui();
+	}
+
     bool Layer2D::OnwindowResizeEvent(WindowResizeEvent & e)
     {
 		m_Renderer->OnResize(e.GetWidth(), e.GetHeight());
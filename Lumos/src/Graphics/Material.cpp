@@ -1,5 +1,6 @@
 #include "lmpch.h"
 #include "Material.h"
+#include "MaterialTable.h"
 #include "Graphics/API/DescriptorSet.h"
 #include "Graphics/API/Pipeline.h"
 #include "Graphics/API/UniformBuffer.h"
@@ -44,6 +45,9 @@ namespace Lumos
 
     Material::~Material()
     {
+        if (IsInTable() && MaterialTable::Exists())
+            MaterialTable::Instance()->Unregister(this);
+
         delete m_DescriptorSet;
         delete m_MaterialProperties;
         delete m_MaterialPropertiesBuffer;
@@ -141,6 +145,9 @@ namespace Lumos
 
         if(m_MaterialPropertiesBuffer)
             m_MaterialPropertiesBuffer->SetData(m_MaterialBufferSize, *&m_MaterialBufferData);
+
+        if(IsInTable())
+            MaterialTable::Instance()->UpdateProperties(this);
     }
 
     void Material::CreateDescriptorSet(Graphics::Pipeline* pipeline, int layoutID, bool pbr)
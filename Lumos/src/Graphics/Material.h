@@ -14,6 +14,8 @@ namespace Lumos
 		class UniformBuffer;
 	}
 
+#define MATERIAL_TABLE_INVALID_PAGE 0xffffffff
+
 const float PBR_WORKFLOW_SEPARATE_TEXTURES  = 0.0f;
 const float PBR_WORKFLOW_METALLIC_ROUGHNESS = 1.0f;
 const float PBR_WORKFLOW_SPECULAR_GLOSINESS = 2.0f;
@@ -84,6 +86,9 @@ const float PBR_WORKFLOW_SPECULAR_GLOSINESS = 2.0f;
 		int								GetRenderFlags()	const { return m_RenderFlags; }
 		const String&					GetName()			const { return m_Name; }
 		MaterialProperties*				GetProperties()		const { return m_MaterialProperties; }
+		u32								GetTablePage()		const { return m_TablePage; }
+		u32								GetTableIndex()		const { return m_TableIndex; }
+		bool							IsInTable()			const { return m_TablePage != MATERIAL_TABLE_INVALID_PAGE; }
         
         static void InitDefaultTexture();
         static void ReleaseDefaultTexture();
@@ -98,6 +103,13 @@ const float PBR_WORKFLOW_SPECULAR_GLOSINESS = 2.0f;
 		u32									m_MaterialBufferSize;
         u8*									m_MaterialBufferData;
 		String								m_Name;
+
+		// Slot in the MaterialTable, written by MaterialTable::Register
+		u32									m_TablePage = MATERIAL_TABLE_INVALID_PAGE;
+		u32									m_TableIndex = 0;
+		u32									m_TableTextures[6] = {};
+
+		friend class MaterialTable;
         
         static Ref<Graphics::Texture2D> s_DefaultTexture;
 	};
@@ -0,0 +1,303 @@
+#include "lmpch.h"
+#include "MaterialTable.h"
+#include "Graphics/API/DescriptorSet.h"
+#include "Graphics/API/Pipeline.h"
+#include "Graphics/API/UniformBuffer.h"
+#include "Graphics/API/Texture.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	MaterialTable::MaterialTable()
+	{
+		uint32_t whiteTextureData = 0xffffffff;
+		m_DefaultTexture = Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromSource(1, 1, &whiteTextureData));
+	}
+
+	MaterialTable::~MaterialTable()
+	{
+		for (auto page : m_Pages)
+		{
+			delete page->descriptorSet;
+			delete page->buffer;
+			delete[] page->materials;
+			delete page;
+		}
+
+		m_Pages.clear();
+	}
+
+	MaterialTable::Page* MaterialTable::CreatePage()
+	{
+		Page* page = lmnew Page();
+
+		for (u32 i = 0; i < MATERIAL_TABLE_TEXTURES; i++)
+		{
+			page->textures[i] = m_DefaultTexture;
+			page->textureRefs[i] = 0;
+		}
+
+		page->materials = lmnew MaterialShaderData[MATERIAL_TABLE_MATERIALS]();
+
+		page->buffer = Graphics::UniformBuffer::Create();
+		page->buffer->Init(sizeof(MaterialShaderData) * MATERIAL_TABLE_MATERIALS, nullptr);
+
+		m_Pages.push_back(page);
+		return page;
+	}
+
+	u32 MaterialTable::FindPage(Graphics::Texture2D** textures, u32 count)
+	{
+		for (u32 p = 0; p < static_cast<u32>(m_Pages.size()); p++)
+		{
+			auto page = m_Pages[p];
+			if (page->freeMaterials.empty() && page->materialCount >= MATERIAL_TABLE_MATERIALS)
+				continue;
+
+			u32 missing = 0;
+			for (u32 i = 0; i < count; i++)
+			{
+				bool found = false;
+				for (u32 slot = 1; slot < page->textureCount; slot++)
+				{
+					if (page->textures[slot].get() == textures[i])
+					{
+						found = true;
+						break;
+					}
+				}
+
+				if (!found)
+					missing++;
+			}
+
+			u32 freeSlots = MATERIAL_TABLE_TEXTURES - page->textureCount;
+			for (u32 slot = 1; slot < page->textureCount; slot++)
+			{
+				if (page->textureRefs[slot] == 0)
+					freeSlots++;
+			}
+
+			if (missing <= freeSlots)
+				return p;
+		}
+
+		CreatePage();
+		return static_cast<u32>(m_Pages.size()) - 1;
+	}
+
+	u32 MaterialTable::AcquireTexture(Page* page, const Ref<Graphics::Texture2D>& texture)
+	{
+		if (!texture)
+			return 0;
+
+		u32 freeSlot = 0;
+		for (u32 slot = 1; slot < page->textureCount; slot++)
+		{
+			if (page->textures[slot] == texture && page->textureRefs[slot] > 0)
+			{
+				page->textureRefs[slot]++;
+				return slot;
+			}
+
+			if (freeSlot == 0 && page->textureRefs[slot] == 0)
+				freeSlot = slot;
+		}
+
+		if (freeSlot == 0)
+		{
+			LUMOS_ASSERT(page->textureCount < MATERIAL_TABLE_TEXTURES, "Material table page full");
+			freeSlot = page->textureCount++;
+		}
+
+		page->textures[freeSlot] = texture;
+		page->textureRefs[freeSlot] = 1;
+		page->texturesDirty = true;
+
+		return freeSlot;
+	}
+
+	void MaterialTable::ReleaseTexture(Page* page, u32 slot)
+	{
+		if (slot == 0 || page->textureRefs[slot] == 0)
+			return;
+
+		if (--page->textureRefs[slot] == 0)
+		{
+			page->textures[slot] = m_DefaultTexture;
+			page->texturesDirty = true;
+		}
+	}
+
+	void MaterialTable::Register(Material* material)
+	{
+		Unregister(material);
+
+		auto& textures = material->GetTextures();
+		Ref<Graphics::Texture2D> materialTextures[6] = { textures.albedo, textures.metallic, textures.roughness, textures.normal, textures.ao, textures.emissive };
+
+		Graphics::Texture2D* unique[6];
+		u32 uniqueCount = 0;
+		for (auto& texture : materialTextures)
+		{
+			if (!texture)
+				continue;
+
+			bool duplicate = false;
+			for (u32 i = 0; i < uniqueCount; i++)
+				duplicate |= unique[i] == texture.get();
+
+			if (!duplicate)
+				unique[uniqueCount++] = texture.get();
+		}
+
+		u32 pageIndex = FindPage(unique, uniqueCount);
+		Page* page = m_Pages[pageIndex];
+
+		u32 index;
+		if (!page->freeMaterials.empty())
+		{
+			index = page->freeMaterials.back();
+			page->freeMaterials.pop_back();
+		}
+		else
+			index = page->materialCount++;
+
+		material->m_TablePage = pageIndex;
+		material->m_TableIndex = index;
+
+		for (u32 i = 0; i < 6; i++)
+			material->m_TableTextures[i] = AcquireTexture(page, materialTextures[i]);
+
+		auto properties = material->GetProperties();
+		if (!textures.albedo)
+			properties->usingAlbedoMap = 0.0f;
+		if (!textures.metallic)
+			properties->usingMetallicMap = 0.0f;
+		if (!textures.roughness)
+			properties->usingRoughnessMap = 0.0f;
+		if (!textures.normal)
+			properties->usingNormalMap = 0.0f;
+		if (!textures.ao)
+			properties->usingAOMap = 0.0f;
+		if (!textures.emissive)
+			properties->usingEmissiveMap = 0.0f;
+
+		WriteMaterial(material);
+	}
+
+	void MaterialTable::Unregister(Material* material)
+	{
+		if (material->m_TablePage == MATERIAL_TABLE_INVALID_PAGE)
+			return;
+
+		Page* page = m_Pages[material->m_TablePage];
+
+		for (u32 i = 0; i < 6; i++)
+			ReleaseTexture(page, material->m_TableTextures[i]);
+
+		page->freeMaterials.push_back(material->m_TableIndex);
+		material->m_TablePage = MATERIAL_TABLE_INVALID_PAGE;
+	}
+
+	void MaterialTable::UpdateProperties(Material* material)
+	{
+		if (material->m_TablePage == MATERIAL_TABLE_INVALID_PAGE)
+			return;
+
+		WriteMaterial(material);
+	}
+
+	void MaterialTable::WriteMaterial(Material* material)
+	{
+		Page* page = m_Pages[material->m_TablePage];
+		MaterialShaderData& data = page->materials[material->m_TableIndex];
+
+		data.properties   = *material->GetProperties();
+		data.albedoMap    = material->m_TableTextures[0];
+		data.metallicMap  = material->m_TableTextures[1];
+		data.roughnessMap = material->m_TableTextures[2];
+		data.normalMap    = material->m_TableTextures[3];
+		data.aoMap        = material->m_TableTextures[4];
+		data.emissiveMap  = material->m_TableTextures[5];
+
+		page->buffersDirty = true;
+	}
+
+	Graphics::DescriptorSet* MaterialTable::GetDescriptorSet(u32 pageIndex, Graphics::Pipeline* pipeline, u32 layoutIndex)
+	{
+		Page* page = m_Pages[pageIndex];
+
+		if (page->buffersDirty)
+		{
+			page->buffer->SetData(sizeof(MaterialShaderData) * MATERIAL_TABLE_MATERIALS, page->materials);
+			page->buffersDirty = false;
+		}
+
+		if (page->pipeline != pipeline)
+		{
+			delete page->descriptorSet;
+
+			Graphics::DescriptorInfo info;
+			info.pipeline = pipeline;
+			info.layoutIndex = layoutIndex;
+			info.shader = pipeline->GetShader();
+
+			page->descriptorSet = Graphics::DescriptorSet::Create(info);
+			page->pipeline = pipeline;
+			page->texturesDirty = true;
+		}
+
+		if (page->texturesDirty)
+		{
+			std::vector<Graphics::ImageInfo> imageInfos;
+			std::vector<Graphics::BufferInfo> bufferInfos;
+
+			Graphics::ImageInfo imageInfo = {};
+			imageInfo.binding = 0;
+			imageInfo.name = "u_Textures";
+			imageInfo.count = MATERIAL_TABLE_TEXTURES;
+			for (auto& texture : page->textures)
+				imageInfo.texture.push_back(texture.get());
+			imageInfos.push_back(imageInfo);
+
+			Graphics::BufferInfo bufferInfo = {};
+			bufferInfo.buffer = page->buffer;
+			bufferInfo.offset = 0;
+			bufferInfo.size = sizeof(MaterialShaderData) * MATERIAL_TABLE_MATERIALS;
+			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
+			bufferInfo.binding = 2;
+			bufferInfo.shaderType = Graphics::ShaderType::FRAGMENT;
+			bufferInfo.name = "UniformMaterialData";
+			bufferInfo.systemUniforms = false;
+			bufferInfos.push_back(bufferInfo);
+
+			page->descriptorSet->Update(imageInfos, bufferInfos);
+			page->texturesDirty = false;
+		}
+
+		return page->descriptorSet;
+	}
+
+	void MaterialTable::OnImGui()
+	{
+		ImGui::Text("Pages : %u", GetPageCount());
+
+		for (u32 i = 0; i < static_cast<u32>(m_Pages.size()); i++)
+		{
+			auto page = m_Pages[i];
+
+			u32 usedTextures = 0;
+			for (u32 slot = 1; slot < page->textureCount; slot++)
+			{
+				if (page->textureRefs[slot] > 0)
+					usedTextures++;
+			}
+
+			ImGui::Text("Page %u : %u/%u materials, %u/%u textures", i,
+				page->materialCount - static_cast<u32>(page->freeMaterials.size()), MATERIAL_TABLE_MATERIALS,
+				usedTextures, MATERIAL_TABLE_TEXTURES - 1);
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "lmpch.h"
+#include "Material.h"
+#include "Utilities/TSingleton.h"
+
+// Must match DeferredColour.frag
+#define MATERIAL_TABLE_TEXTURES 16
+#define MATERIAL_TABLE_MATERIALS 128
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class Pipeline;
+		class DescriptorSet;
+		class UniformBuffer;
+	}
+
+	// std140 layout of one entry in the material buffer
+	struct MaterialShaderData
+	{
+		MaterialProperties properties;
+		u32 albedoMap;
+		u32 metallicMap;
+		u32 roughnessMap;
+		u32 normalMap;
+		u32 aoMap;
+		u32 emissiveMap;
+		u32 padding[2];
+	};
+
+	// Global texture table and material parameter buffer. Materials are packed into pages that
+	// each own MATERIAL_TABLE_TEXTURES texture slots and MATERIAL_TABLE_MATERIALS parameter slots,
+	// so a renderer binds one descriptor set per page and pushes the material index per draw.
+	// Pages keep the sampler array small enough for GL's per stage texture unit limit; slot 0
+	// of every page is the default white texture.
+	class LUMOS_EXPORT MaterialTable : public TSingleton<MaterialTable>
+	{
+		friend class TSingleton<MaterialTable>;
+	public:
+		MaterialTable();
+		~MaterialTable();
+
+		void Register(Material* material);
+		void Unregister(Material* material);
+		void UpdateProperties(Material* material);
+
+		// Uploads dirty parameter buffers and returns the page's set for the given pipeline layout
+		Graphics::DescriptorSet* GetDescriptorSet(u32 page, Graphics::Pipeline* pipeline, u32 layoutIndex);
+
+		u32 GetPageCount() const { return static_cast<u32>(m_Pages.size()); }
+
+		void OnImGui();
+
+		static bool Exists() { return m_pInstance != nullptr; }
+
+	private:
+		struct Page
+		{
+			Ref<Graphics::Texture2D> textures[MATERIAL_TABLE_TEXTURES];
+			u32 textureRefs[MATERIAL_TABLE_TEXTURES];
+			u32 textureCount = 1;
+
+			MaterialShaderData* materials = nullptr;
+			std::vector<u32> freeMaterials;
+			u32 materialCount = 0;
+
+			Graphics::UniformBuffer* buffer = nullptr;
+			Graphics::DescriptorSet* descriptorSet = nullptr;
+			Graphics::Pipeline* pipeline = nullptr;
+			bool texturesDirty = true;
+			bool buffersDirty = true;
+		};
+
+		Page* CreatePage();
+		u32 FindPage(Graphics::Texture2D** textures, u32 count);
+		u32 AcquireTexture(Page* page, const Ref<Graphics::Texture2D>& texture);
+		void ReleaseTexture(Page* page, u32 slot);
+		void WriteMaterial(Material* material);
+
+		std::vector<Page*> m_Pages;
+		Ref<Graphics::Texture2D> m_DefaultTexture;
+	};
+}
@@ -11,7 +11,7 @@ namespace Lumos
 		}
 
 		Mesh::Mesh(const Mesh& mesh)
-			: m_VertexArray(mesh.m_VertexArray), m_IndexBuffer(mesh.m_IndexBuffer), m_ArrayCleanUp(false), m_TextureCleanUp(false), m_BoundingBox(mesh.m_BoundingBox)
+			: m_VertexArray(mesh.m_VertexArray), m_IndexBuffer(mesh.m_IndexBuffer), m_ArrayCleanUp(false), m_TextureCleanUp(false), m_BoundingBox(mesh.m_BoundingBox), m_BVH(mesh.m_BVH)
 		{
 		}
 
@@ -24,6 +24,12 @@ namespace Lumos
 		{
 		}
 
+		void Mesh::BuildBVH(const Vertex* vertices, const u32* indices, u32 numIndices)
+		{
+			m_BVH = CreateRef<Maths::TriangleBVH>();
+			m_BVH->Build(vertices, sizeof(Vertex), indices, numIndices);
+		}
+
 		void Mesh::Draw()
 		{
 			m_VertexArray->Bind();
@@ -6,6 +6,7 @@
 #include "Graphics/API/CommandBuffer.h"
 #include "Graphics/API/DescriptorSet.h"
 #include "Maths/Maths.h"
+#include "Maths/BVH.h"
 
 #include <array>
 
@@ -93,6 +94,10 @@ namespace Lumos
 			Ref<IndexBuffer> GetIndexBuffer() const { return m_IndexBuffer; }
 			Ref<Maths::BoundingBox> GetBoundingBox() const { return m_BoundingBox; }
 
+			// Triangle BVH for ray casts, meshes built without one are picked by their bounding box
+			void BuildBVH(const Vertex* vertices, const u32* indices, u32 numIndices);
+			const Ref<Maths::TriangleBVH>& GetBVH() const { return m_BVH; }
+
 			bool& GetActive() { return m_Active; }
 
 		protected:
@@ -106,6 +111,7 @@ namespace Lumos
 			Ref<IndexBuffer> m_IndexBuffer;
 
 			Ref<Maths::BoundingBox> m_BoundingBox;
+			Ref<Maths::TriangleBVH> m_BVH;
 
 			bool m_ArrayCleanUp;
 			bool m_TextureCleanUp;
@@ -506,7 +506,9 @@ namespace Lumos
 			Ref<IndexBuffer> ib;
 			ib.reset(IndexBuffer::Create(indices.data(), static_cast<u32>(indices.size())));
 
-			return lmnew Mesh(va, ib, boundingBox);
+			Mesh* mesh = lmnew Mesh(va, ib, boundingBox);
+			mesh->BuildBVH(data.data(), indices.data(), static_cast<u32>(indices.size()));
+			return mesh;
 		}
 
 		Mesh* CreateIcoSphere(u32 radius, u32 subdivision)
@@ -745,7 +747,9 @@ namespace Lumos
 			Ref<IndexBuffer> ib;
 			ib.reset(IndexBuffer::Create(indices.data(), static_cast<u32>(indices.size())));
 
-			return lmnew Mesh(va, ib, boundingBox);
+			Mesh* mesh = lmnew Mesh(va, ib, boundingBox);
+			mesh->BuildBVH(data.data(), indices.data(), static_cast<u32>(indices.size()));
+			return mesh;
 		}
 	}
 
@@ -909,7 +913,9 @@ namespace Lumos
 		Ref<IndexBuffer> ib;
 		ib.reset(IndexBuffer::Create(indices.data(), static_cast<u32>(indices.size())));
 
-		return lmnew Mesh(va, ib, boundingBox);
+		Mesh* mesh = lmnew Mesh(va, ib, boundingBox);
+		mesh->BuildBVH(data.data(), indices.data(), static_cast<u32>(indices.size()));
+		return mesh;
 	}
 
 	Graphics::Mesh* Graphics::CreatePrimative(PrimitiveType type)
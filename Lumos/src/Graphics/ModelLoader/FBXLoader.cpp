@@ -2,10 +2,12 @@
 #include "ModelLoader.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/Material.h"
+#include "Graphics/Animation/Animator.h"
 #include "Core/OS/FileSystem.h"
 
 #include "ECS/Component/MeshComponent.h"
 #include "ECS/Component/MaterialComponent.h"
+#include "ECS/Component/AnimatorComponent.h"
 
 #include "Graphics/API/Texture.h"
 #include "Maths/Maths.h"
@@ -127,6 +129,210 @@ namespace Lumos
         return Maths::Quaternion(float(quat.x), float(quat.y), float(quat.z), float(quat.w));
     }
 
+    // ofbx matrices are column major
+    Maths::Matrix3x4 ToLumosMatrix(const ofbx::Matrix& matrix)
+    {
+        float values[16];
+        for (int i = 0; i < 16; i++)
+            values[i] = float(matrix.m[i]);
+
+        return Maths::Matrix3x4(Maths::Matrix4(values).Transpose());
+    }
+
+    struct FBXSkin
+    {
+        Ref<Graphics::Skeleton> skeleton;
+        Ref<Graphics::Animator> animator;
+
+        // Source node of each joint, and the joint of each node
+        std::vector<const ofbx::Object*> joints;
+        std::unordered_map<const ofbx::Object*, u32> jointOfObject;
+    };
+
+    // One skeleton for the whole file: every node a cluster links to, plus the nodes above it so no transform is lost
+    static bool LoadFBXSkeleton(const ofbx::IScene* scene, FBXSkin& skin)
+    {
+        std::vector<const ofbx::Object*> objects;
+        std::unordered_map<const ofbx::Object*, u32> indexOfObject;
+        std::unordered_map<const ofbx::Object*, Maths::Matrix3x4> inverseBindMatrices;
+
+        for (int i = 0; i < scene->getMeshCount(); i++)
+        {
+            const ofbx::Skin* fbxSkin = scene->getMesh(i)->getGeometry() ? scene->getMesh(i)->getGeometry()->getSkin() : nullptr;
+            if (!fbxSkin)
+                continue;
+
+            for (int c = 0; c < fbxSkin->getClusterCount(); c++)
+            {
+                const ofbx::Cluster* cluster = fbxSkin->getCluster(c);
+                const ofbx::Object* link = cluster->getLink();
+                if (!link)
+                    continue;
+
+                if (inverseBindMatrices.find(link) == inverseBindMatrices.end())
+                    inverseBindMatrices[link] = ToLumosMatrix(cluster->getTransformLinkMatrix()).Inverse() * ToLumosMatrix(cluster->getTransformMatrix());
+
+                for (const ofbx::Object* object = link; object && object->getType() != ofbx::Object::Type::ROOT; object = object->getParent())
+                {
+                    if (indexOfObject.find(object) != indexOfObject.end())
+                        break;
+
+                    indexOfObject[object] = static_cast<u32>(objects.size());
+                    objects.push_back(object);
+                }
+            }
+        }
+
+        if (objects.empty())
+            return false;
+
+        std::vector<i32> parents(objects.size(), -1);
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            auto parent = indexOfObject.find(objects[i]->getParent());
+            if (parent != indexOfObject.end())
+                parents[i] = static_cast<i32>(parent->second);
+        }
+
+        std::vector<u32> order;
+        Graphics::Skeleton::SortParentsFirst(parents, order);
+
+        skin.skeleton = CreateRef<Graphics::Skeleton>();
+        for (u32 index : order)
+        {
+            const ofbx::Object* object = objects[index];
+            const i32 parent = parents[index] < 0 ? -1 : static_cast<i32>(skin.jointOfObject[objects[parents[index]]]);
+
+            Graphics::JointPose pose;
+            ToLumosMatrix(object->getLocalTransform()).Decompose(pose.position, pose.rotation, pose.scale);
+
+            auto inverseBindMatrix = inverseBindMatrices.find(object);
+            skin.jointOfObject[object] = skin.skeleton->AddJoint(object->name, parent, pose, inverseBindMatrix != inverseBindMatrices.end() ? inverseBindMatrix->second : Maths::Matrix3x4());
+            skin.joints.push_back(object);
+        }
+
+        skin.animator = CreateRef<Graphics::Animator>(skin.skeleton);
+        return true;
+    }
+
+    static void LoadFBXSkinWeights(const ofbx::Geometry* geometry, const FBXSkin& skin, int vertexCount, std::vector<Graphics::SkinWeights>& weights)
+    {
+        const ofbx::Skin* fbxSkin = geometry->getSkin();
+        if (!fbxSkin)
+            return;
+
+        std::vector<std::vector<u32>> joints(vertexCount);
+        std::vector<std::vector<float>> jointWeights(vertexCount);
+
+        for (int c = 0; c < fbxSkin->getClusterCount(); c++)
+        {
+            const ofbx::Cluster* cluster = fbxSkin->getCluster(c);
+            auto joint = skin.jointOfObject.find(cluster->getLink());
+            if (joint == skin.jointOfObject.end())
+                continue;
+
+            const int* indices = cluster->getIndices();
+            const double* clusterWeights = cluster->getWeights();
+            for (int i = 0; i < cluster->getIndicesCount(); i++)
+            {
+                if (indices[i] < 0 || indices[i] >= vertexCount)
+                    continue;
+
+                joints[indices[i]].push_back(joint->second);
+                jointWeights[indices[i]].push_back(float(clusterWeights[i]));
+            }
+        }
+
+        weights.resize(vertexCount);
+        for (int i = 0; i < vertexCount; i++)
+            weights[i] = Graphics::SkinWeights::Create(joints[i].data(), jointWeights[i].data(), static_cast<u32>(joints[i].size()));
+    }
+
+    // Every animation stack becomes a clip, sampled through ofbx so pre-rotations and pivots are baked in
+    static void LoadFBXAnimations(const ofbx::IScene* scene, FBXSkin& skin)
+    {
+        const float frameRate = scene->getSceneFrameRate() > 0.0f ? scene->getSceneFrameRate() : 30.0f;
+
+        for (int i = 0; i < scene->getAnimationStackCount(); i++)
+        {
+            const ofbx::AnimationStack* stack = scene->getAnimationStack(i);
+            const ofbx::AnimationLayer* layer = stack->getLayer(0);
+            if (!layer)
+                continue;
+
+            double from = 0.0;
+            double to = 0.0;
+            const ofbx::TakeInfo* takeInfo = scene->getTakeInfo(stack->name);
+            if (takeInfo)
+            {
+                from = takeInfo->local_time_from;
+                to = takeInfo->local_time_to;
+            }
+            else
+            {
+                for (int n = 0; const ofbx::AnimationCurveNode* curveNode = layer->getCurveNode(n); n++)
+                {
+                    for (int c = 0; c < 3; c++)
+                    {
+                        const ofbx::AnimationCurve* curve = curveNode->getCurve(c);
+                        if (curve && curve->getKeyCount() > 0)
+                            to = Maths::Max(to, ofbx::fbxTimeToSeconds(curve->getKeyTime()[curve->getKeyCount() - 1]));
+                    }
+                }
+            }
+
+            const float duration = float(to - from);
+            if (duration <= 0.0f)
+                continue;
+
+            const u32 keyCount = static_cast<u32>(Maths::Ceil(duration * frameRate)) + 1;
+            std::vector<Graphics::AnimationTrack> tracks;
+
+            for (u32 joint = 0; joint < skin.joints.size(); joint++)
+            {
+                const ofbx::Object* object = skin.joints[joint];
+                const ofbx::AnimationCurveNode* translationNode = layer->getCurveNode(*object, "Lcl Translation");
+                const ofbx::AnimationCurveNode* rotationNode = layer->getCurveNode(*object, "Lcl Rotation");
+                const ofbx::AnimationCurveNode* scalingNode = layer->getCurveNode(*object, "Lcl Scaling");
+                if (!translationNode && !rotationNode && !scalingNode)
+                    continue;
+
+                Graphics::AnimationTrack track;
+                track.joint = joint;
+
+                for (u32 key = 0; key < keyCount; key++)
+                {
+                    const float time = Maths::Min(static_cast<float>(key) / frameRate, duration);
+                    const ofbx::Vec3 translation = translationNode ? translationNode->getNodeLocalTransform(from + time) : object->getLocalTranslation();
+                    const ofbx::Vec3 rotation = rotationNode ? rotationNode->getNodeLocalTransform(from + time) : object->getLocalRotation();
+                    const ofbx::Vec3 scaling = scalingNode ? scalingNode->getNodeLocalTransform(from + time) : object->getLocalScaling();
+
+                    Graphics::JointPose pose;
+                    ToLumosMatrix(object->evalLocal(translation, rotation, scaling)).Decompose(pose.position, pose.rotation, pose.scale);
+
+                    track.positionTimes.push_back(time);
+                    track.positions.push_back(pose.position);
+                    track.rotationTimes.push_back(time);
+                    track.rotations.push_back(pose.rotation);
+                    track.scaleTimes.push_back(time);
+                    track.scales.push_back(pose.scale);
+                }
+
+                tracks.push_back(std::move(track));
+            }
+
+            if (tracks.empty())
+                continue;
+
+            auto clip = CreateRef<Graphics::AnimationClip>();
+            clip->Build(stack->name, *skin.skeleton, tracks, duration);
+            skin.animator->AddClip(clip);
+        }
+
+        if (!skin.animator->GetClips().empty())
+            skin.animator->Play(0);
+    }
+
 	entt::entity ModelLoader::LoadFBX(const String& path, entt::registry& registry)
 	{
 		std::string err;
@@ -163,6 +369,11 @@ namespace Lumos
 		auto entity = registry.create();
         registry.emplace<Maths::Transform>(entity);
 
+        FBXSkin skin;
+        const bool hasSkeleton = LoadFBXSkeleton(scene, skin);
+        if (hasSkeleton)
+            LoadFBXAnimations(scene, skin);
+
         int c = scene->getMeshCount();
         for (int i = 0; i < c; ++i)
         {
@@ -219,10 +430,14 @@ namespace Lumos
                 indicesArray[i] = index;
             }
 
+            std::vector<Graphics::SkinWeights> weights;
+            if (hasSkeleton)
+                LoadFBXSkinWeights(geom, skin, vertex_count, weights);
+
 			Ref<Graphics::VertexArray> va;
 			va.reset(Graphics::VertexArray::Create());
 			va->Bind();
-			Graphics::VertexBuffer* buffer = Graphics::VertexBuffer::Create(Graphics::BufferUsage::STATIC);
+			Graphics::VertexBuffer* buffer = Graphics::VertexBuffer::Create(weights.empty() ? Graphics::BufferUsage::STATIC : Graphics::BufferUsage::DYNAMIC);
 			buffer->SetData(sizeof(Graphics::Vertex) * vertex_count, tempvertices);
 
 			Graphics::BufferLayout layout;
@@ -356,37 +571,50 @@ namespace Lumos
                 pbrMaterial->SetMaterialProperites(properties);
             }
 
-			auto mesh = CreateRef<Graphics::Mesh>(va, ib, boundingBox);
+			Ref<Graphics::Mesh> mesh;
+			if (weights.empty())
+				mesh = CreateRef<Graphics::Mesh>(va, ib, boundingBox);
+			else
+			{
+				auto skinnedMesh = CreateRef<Graphics::SkinnedMesh>(va, ib, boundingBox, tempvertices, weights.data(), u32(vertex_count));
+				skin.animator->AddMesh(skinnedMesh);
+				mesh = skinnedMesh;
+			}
+			mesh->BuildBVH(tempvertices, indicesArray, numIndices);
 			if (c == 1)
 			{
-                registry.emplace<MeshComponent>(entity, mesh);
+                registry.emplace<MeshComponent>(entity, mesh).SetSource(path, i);
                 registry.get_or_emplace<Maths::Transform>(entity);
                 registry.emplace<NameComponent>(entity, fbx_mesh->name);
 
                 if(material)
                     registry.emplace<MaterialComponent>(entity, pbrMaterial);
 
-                auto& transform = registry.get<Maths::Transform>(entity);
+                // Skinned vertices end up in the scene's space, the mesh node's transform doesn't apply
+                if (weights.empty())
+                {
+                    auto& transform = registry.get<Maths::Transform>(entity);
 
-                auto object = fbx_mesh;
-                ofbx::Vec3 p = object->getLocalTranslation();
+                    auto object = fbx_mesh;
+                    ofbx::Vec3 p = object->getLocalTranslation();
 
-                const Maths::Matrix3 gInvert = Maths::Matrix3(-1.0,0.0,0.0,0.0,0.0,1.0,0.0,1.0,0.0);
-                Maths::Vector3 pos = (Maths::Vector3(static_cast<float>(p.x), static_cast<float>(p.y),  static_cast<float>(p.z)));
-                transform.SetLocalPosition(FixOrientation(pos));
+                    const Maths::Matrix3 gInvert = Maths::Matrix3(-1.0,0.0,0.0,0.0,0.0,1.0,0.0,1.0,0.0);
+                    Maths::Vector3 pos = (Maths::Vector3(static_cast<float>(p.x), static_cast<float>(p.y),  static_cast<float>(p.z)));
+                    transform.SetLocalPosition(FixOrientation(pos));
 
-                ofbx::Vec3 r = object->getLocalRotation();
-                Maths::Vector3 rot = FixOrientation(Maths::Vector3(static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.z)));
-                transform.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(rot.x, rot.y, rot.z));
+                    ofbx::Vec3 r = object->getLocalRotation();
+                    Maths::Vector3 rot = FixOrientation(Maths::Vector3(static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.z)));
+                    transform.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(rot.x, rot.y, rot.z));
 
-                ofbx::Vec3 s = object->getLocalScaling();
-                Maths::Vector3 scl = Maths::Vector3(static_cast<float>(s.x), static_cast<float>(s.y), static_cast<float>(s.z));
-                transform.SetLocalScale(scl);
+                    ofbx::Vec3 s = object->getLocalScaling();
+                    Maths::Vector3 scl = Maths::Vector3(static_cast<float>(s.x), static_cast<float>(s.y), static_cast<float>(s.z));
+                    transform.SetLocalScale(scl);
+                }
 			}
 			else
 			{
 				auto meshEntity = registry.create();
-				registry.emplace<MeshComponent>(meshEntity, mesh);
+				registry.emplace<MeshComponent>(meshEntity, mesh).SetSource(path, i);
 				registry.emplace<Maths::Transform>(meshEntity);
 				registry.emplace<Hierarchy>(meshEntity, entity);
                 registry.emplace<NameComponent>(meshEntity, fbx_mesh->name);
@@ -394,21 +622,25 @@ namespace Lumos
                 if(material)
                     registry.emplace<MaterialComponent>(meshEntity, pbrMaterial);
 
-                auto& transform = registry.get<Maths::Transform>(meshEntity);
+                // Skinned vertices end up in the scene's space, the mesh node's transform doesn't apply
+                if (weights.empty())
+                {
+                    auto& transform = registry.get<Maths::Transform>(meshEntity);
 
-                auto object = fbx_mesh;
-                ofbx::Vec3 p = object->getLocalTranslation();
-                const Maths::Matrix3 gInvert = Maths::Matrix3(-1.0,0.0,0.0,0.0,0.0,1.0,0.0,1.0,0.0);
-                Maths::Vector3 pos =  (Maths::Vector3(static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)));// * settings->customScale());
-                transform.SetLocalPosition(FixOrientation(pos));
+                    auto object = fbx_mesh;
+                    ofbx::Vec3 p = object->getLocalTranslation();
+                    const Maths::Matrix3 gInvert = Maths::Matrix3(-1.0,0.0,0.0,0.0,0.0,1.0,0.0,1.0,0.0);
+                    Maths::Vector3 pos =  (Maths::Vector3(static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z)));// * settings->customScale());
+                    transform.SetLocalPosition(FixOrientation(pos));
 
-                ofbx::Vec3 r = object->getLocalRotation();
-                Maths::Vector3 rot = FixOrientation(Maths::Vector3(static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.z)));
-                transform.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(rot.x, rot.y, rot.z));
+                    ofbx::Vec3 r = object->getLocalRotation();
+                    Maths::Vector3 rot = FixOrientation(Maths::Vector3(static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.z)));
+                    transform.SetLocalOrientation(Maths::Quaternion::EulerAnglesToQuaternion(rot.x, rot.y, rot.z));
 
-                ofbx::Vec3 s = object->getLocalScaling();
-                Maths::Vector3 scl = Maths::Vector3(static_cast<float>(s.x), static_cast<float>(s.y), static_cast<float>(s.z));
-                transform.SetLocalScale(scl);
+                    ofbx::Vec3 s = object->getLocalScaling();
+                    Maths::Vector3 scl = Maths::Vector3(static_cast<float>(s.x), static_cast<float>(s.y), static_cast<float>(s.z));
+                    transform.SetLocalScale(scl);
+                }
 			}
 
             if(generatedTangents)
@@ -417,6 +649,9 @@ namespace Lumos
 			delete[] indicesArray;
         }
 
+        if (hasSkeleton && !skin.animator->GetMeshes().empty())
+            registry.emplace<AnimatorComponent>(entity, skin.animator);
+
 		return entity;
 	}
 
@@ -2,9 +2,11 @@
 #include "ModelLoader.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/Material.h"
+#include "Graphics/Animation/Animator.h"
 
 #include "ECS/Component/MeshComponent.h"
 #include "ECS/Component/MaterialComponent.h"
+#include "ECS/Component/AnimatorComponent.h"
 
 #include "Graphics/API/Texture.h"
 #include "Maths/Maths.h"
@@ -94,6 +96,247 @@ namespace Lumos
 		}
 	}
 
+	// Reads components values per element of an accessor as floats, converting integer types
+	// (normalised when the accessor is) and honouring the buffer view's stride
+	static void ReadAccessor(const tinygltf::Model& model, int accessorIndex, u32 components, std::vector<float>& values)
+	{
+		values.clear();
+		if (accessorIndex < 0 || accessorIndex >= static_cast<int>(model.accessors.size()))
+			return;
+
+		const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+		values.resize(accessor.count * components, 0.0f);
+		if (accessor.bufferView < 0)
+			return;
+
+		const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+		const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+		const int stride = accessor.ByteStride(bufferView);
+		if (stride <= 0)
+			return;
+
+		const u32 accessorComponents = static_cast<u32>(GLTF_COMPONENT_LENGTH_LOOKUP.at(accessor.type));
+		const size_t componentSize = ComponentSize.at(accessor.componentType);
+		const u8* data = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
+
+		for (size_t i = 0; i < accessor.count; i++)
+		{
+			const u8* element = data + i * stride;
+			for (u32 c = 0; c < Maths::Min(components, accessorComponents); c++)
+			{
+				const u8* value = element + c * componentSize;
+				float result = 0.0f;
+
+				switch (accessor.componentType)
+				{
+				case TINYGLTF_COMPONENT_TYPE_FLOAT: result = *reinterpret_cast<const float*>(value); break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: result = accessor.normalized ? *value / 255.0f : *value; break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: result = accessor.normalized ? *reinterpret_cast<const u16*>(value) / 65535.0f : *reinterpret_cast<const u16*>(value); break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: result = static_cast<float>(*reinterpret_cast<const u32*>(value)); break;
+				case TINYGLTF_COMPONENT_TYPE_BYTE: result = accessor.normalized ? Maths::Max(*reinterpret_cast<const i8*>(value) / 127.0f, -1.0f) : *reinterpret_cast<const i8*>(value); break;
+				case TINYGLTF_COMPONENT_TYPE_SHORT: result = accessor.normalized ? Maths::Max(*reinterpret_cast<const i16*>(value) / 32767.0f, -1.0f) : *reinterpret_cast<const i16*>(value); break;
+				default: break;
+				}
+
+				values[i * components + c] = result;
+			}
+		}
+	}
+
+	static Graphics::JointPose GetNodePose(const tinygltf::Node& node)
+	{
+		Graphics::JointPose pose;
+
+		if (!node.matrix.empty())
+		{
+			float matrix[16];
+			for (int i = 0; i < 16; i++)
+				matrix[i] = static_cast<float>(node.matrix[i]);
+
+			Maths::Matrix3x4(Maths::Matrix4(matrix).Transpose()).Decompose(pose.position, pose.rotation, pose.scale);
+			return pose;
+		}
+
+		if (!node.translation.empty())
+			pose.position = Maths::Vector3(static_cast<float>(node.translation[0]), static_cast<float>(node.translation[1]), static_cast<float>(node.translation[2]));
+		if (!node.rotation.empty())
+			pose.rotation = Maths::Quaternion(static_cast<float>(node.rotation[3]), static_cast<float>(node.rotation[0]), static_cast<float>(node.rotation[1]), static_cast<float>(node.rotation[2]));
+		if (!node.scale.empty())
+			pose.scale = Maths::Vector3(static_cast<float>(node.scale[0]), static_cast<float>(node.scale[1]), static_cast<float>(node.scale[2]));
+
+		return pose;
+	}
+
+	struct GLTFSkin
+	{
+		Ref<Graphics::Skeleton> skeleton;
+		Ref<Graphics::Animator> animator;
+
+		// Skeleton joint of each node, -1 for nodes outside the skin
+		std::vector<i32> nodeToJoint;
+
+		// Skeleton joint of each entry of the skin's joint list, which JOINTS_0 indexes
+		std::vector<u32> skinToJoint;
+	};
+
+	std::vector<GLTFSkin> LoadSkins(tinygltf::Model& model)
+	{
+		std::vector<GLTFSkin> skins;
+		skins.reserve(model.skins.size());
+
+		std::vector<i32> nodeParents(model.nodes.size(), -1);
+		for (size_t i = 0; i < model.nodes.size(); i++)
+		{
+			for (int child : model.nodes[i].children)
+				nodeParents[child] = static_cast<i32>(i);
+		}
+
+		for (tinygltf::Skin& gltfSkin : model.skins)
+		{
+			const u32 jointCount = static_cast<u32>(gltfSkin.joints.size());
+
+			std::unordered_map<int, u32> jointOfNode;
+			for (u32 i = 0; i < jointCount; i++)
+				jointOfNode[gltfSkin.joints[i]] = i;
+
+			std::vector<i32> parents(jointCount, -1);
+			for (u32 i = 0; i < jointCount; i++)
+			{
+				auto parent = jointOfNode.find(nodeParents[gltfSkin.joints[i]]);
+				if (parent != jointOfNode.end())
+					parents[i] = static_cast<i32>(parent->second);
+			}
+
+			std::vector<u32> order;
+			Graphics::Skeleton::SortParentsFirst(parents, order);
+
+			std::vector<float> inverseBindMatrices;
+			ReadAccessor(model, gltfSkin.inverseBindMatrices, 16, inverseBindMatrices);
+
+			GLTFSkin skin;
+			skin.skeleton = CreateRef<Graphics::Skeleton>();
+			skin.nodeToJoint.assign(model.nodes.size(), -1);
+			skin.skinToJoint.resize(jointCount);
+
+			for (u32 i = 0; i < jointCount; i++)
+				skin.skinToJoint[order[i]] = i;
+
+			for (u32 joint : order)
+			{
+				const int node = gltfSkin.joints[joint];
+				const i32 parent = parents[joint] < 0 ? -1 : static_cast<i32>(skin.skinToJoint[parents[joint]]);
+
+				Maths::Matrix3x4 inverseBindMatrix;
+				if (inverseBindMatrices.size() >= (joint + 1) * 16)
+					inverseBindMatrix = Maths::Matrix3x4(Maths::Matrix4(&inverseBindMatrices[joint * 16]).Transpose());
+
+				skin.nodeToJoint[node] = static_cast<i32>(skin.skeleton->AddJoint(model.nodes[node].name, parent, GetNodePose(model.nodes[node]), inverseBindMatrix));
+			}
+
+			// Nodes above the root joint still move it, bake them into the skeleton
+			if (jointCount > 0)
+			{
+				Maths::Matrix3x4 rootTransform;
+				for (i32 node = nodeParents[gltfSkin.joints[order[0]]]; node >= 0; node = nodeParents[node])
+				{
+					const Graphics::JointPose pose = GetNodePose(model.nodes[node]);
+					rootTransform = Maths::Matrix3x4(pose.position, pose.rotation, pose.scale) * rootTransform;
+				}
+				skin.skeleton->SetRootTransform(rootTransform);
+			}
+
+			skin.animator = CreateRef<Graphics::Animator>(skin.skeleton);
+			skins.push_back(skin);
+		}
+
+		return skins;
+	}
+
+	void LoadAnimations(tinygltf::Model& model, std::vector<GLTFSkin>& skins)
+	{
+		std::vector<float> times;
+		std::vector<float> values;
+
+		for (size_t animationIndex = 0; animationIndex < model.animations.size(); animationIndex++)
+		{
+			tinygltf::Animation& animation = model.animations[animationIndex];
+			const String name = animation.name.empty() ? "Animation " + StringFormat::ToString(static_cast<u32>(animationIndex)) : animation.name;
+
+			for (auto& skin : skins)
+			{
+				std::vector<Graphics::AnimationTrack> tracks;
+				std::unordered_map<u32, size_t> trackOfJoint;
+				float duration = 0.0f;
+
+				for (auto& channel : animation.channels)
+				{
+					if (channel.target_node < 0 || channel.sampler < 0 || skin.nodeToJoint[channel.target_node] < 0)
+						continue;
+
+					const bool isPosition = channel.target_path == "translation";
+					const bool isRotation = channel.target_path == "rotation";
+					const bool isScale = channel.target_path == "scale";
+					if (!isPosition && !isRotation && !isScale)
+						continue;
+
+					const tinygltf::AnimationSampler& sampler = animation.samplers[channel.sampler];
+					const u32 components = isRotation ? 4 : 3;
+					ReadAccessor(model, sampler.input, 1, times);
+					ReadAccessor(model, sampler.output, components, values);
+
+					// Cubic spline keys are in-tangent, value, out-tangent, only the value is kept
+					const bool cubic = sampler.interpolation == "CUBICSPLINE";
+					const size_t stride = cubic ? 3 : 1;
+					const size_t offset = cubic ? 1 : 0;
+					const size_t keyCount = Maths::Min(times.size(), values.size() / (components * stride));
+					if (keyCount == 0)
+						continue;
+
+					const u32 joint = static_cast<u32>(skin.nodeToJoint[channel.target_node]);
+					auto found = trackOfJoint.find(joint);
+					if (found == trackOfJoint.end())
+					{
+						found = trackOfJoint.emplace(joint, tracks.size()).first;
+						tracks.emplace_back();
+						tracks.back().joint = joint;
+					}
+
+					Graphics::AnimationTrack& track = tracks[found->second];
+					track.step = sampler.interpolation == "STEP";
+
+					std::vector<float>& keyTimes = isPosition ? track.positionTimes : isRotation ? track.rotationTimes : track.scaleTimes;
+					keyTimes.assign(times.begin(), times.begin() + keyCount);
+
+					for (size_t key = 0; key < keyCount; key++)
+					{
+						const float* value = &values[(key * stride + offset) * components];
+						if (isPosition)
+							track.positions.emplace_back(value[0], value[1], value[2]);
+						else if (isRotation)
+							track.rotations.emplace_back(value[3], value[0], value[1], value[2]);
+						else
+							track.scales.emplace_back(value[0], value[1], value[2]);
+					}
+
+					duration = Maths::Max(duration, times[keyCount - 1]);
+				}
+
+				if (tracks.empty())
+					continue;
+
+				auto clip = CreateRef<Graphics::AnimationClip>();
+				clip->Build(name, *skin.skeleton, tracks, duration);
+				skin.animator->AddClip(clip);
+			}
+		}
+
+		for (auto& skin : skins)
+		{
+			if (!skin.animator->GetClips().empty())
+				skin.animator->Play(0);
+		}
+	}
+
 	std::vector<Ref<Material>> LoadMaterials(tinygltf::Model &gltfModel)
     {
 		std::vector<Ref<Graphics::Texture2D>> loadedTextures;
@@ -237,7 +480,7 @@ namespace Lumos
         return loadedMaterials;
     }
     
-	std::vector<Graphics::Mesh*> LoadMesh(tinygltf::Model& model, tinygltf::Mesh& mesh, std::vector<Ref<Material>>& materials)
+	std::vector<Graphics::Mesh*> LoadMesh(tinygltf::Model& model, tinygltf::Mesh& mesh, std::vector<Ref<Material>>& materials, const GLTFSkin* skin)
     {
         std::vector<Graphics::Mesh*> meshes;
         
@@ -252,6 +495,9 @@ namespace Lumos
             size_t maxNumVerts = 0;
             
             Ref<Maths::BoundingBox> boundingBox = CreateRef<Maths::BoundingBox>();
+
+            std::vector<float> skinJoints;
+            std::vector<float> skinWeights;
            
             for (auto& attribute : primitive.attributes)
             {
@@ -336,12 +582,44 @@ namespace Lumos
                         tempvertices[p].Tangent = ToVector(uvs[p]);
                     }
                 }
+
+                // -------- Skin attributes -----------
+
+                else if (attribute.first == "JOINTS_0")
+                {
+                    ReadAccessor(model, attribute.second, 4, skinJoints);
+                }
+
+                else if (attribute.first == "WEIGHTS_0")
+                {
+                    ReadAccessor(model, attribute.second, 4, skinWeights);
+                }
+            }
+
+            // Joints index the skin's joint list, the skeleton stores them parents first
+            std::vector<Graphics::SkinWeights> weights;
+            if (skin && !skinJoints.empty() && !skinWeights.empty())
+            {
+                weights.resize(numVertices);
+                const u32 skinJointCount = static_cast<u32>(skin->skinToJoint.size());
+                const size_t count = Maths::Min<size_t>(numVertices, Maths::Min(skinJoints.size(), skinWeights.size()) / 4);
+
+                for (size_t p = 0; p < count; p++)
+                {
+                    u32 joints[4];
+                    for (u32 k = 0; k < 4; k++)
+                    {
+                        const u32 joint = static_cast<u32>(skinJoints[p * 4 + k]);
+                        joints[k] = joint < skinJointCount ? skin->skinToJoint[joint] : 0;
+                    }
+                    weights[p] = Graphics::SkinWeights::Create(joints, &skinWeights[p * 4], 4);
+                }
             }
 
             Ref<Graphics::VertexArray> va;
             va.reset(Graphics::VertexArray::Create());
             
-			Graphics::VertexBuffer* buffer = Graphics::VertexBuffer::Create(Graphics::BufferUsage::STATIC);
+			Graphics::VertexBuffer* buffer = Graphics::VertexBuffer::Create(weights.empty() ? Graphics::BufferUsage::STATIC : Graphics::BufferUsage::DYNAMIC);
             buffer->SetData(sizeof(Graphics::Vertex) * numVertices, tempvertices);
             
             Graphics::BufferLayout layout;
@@ -393,7 +671,12 @@ namespace Lumos
             Ref<Graphics::IndexBuffer> ib;
             ib.reset(Graphics::IndexBuffer::Create(indicesArray, numVertices));
 
-            auto lMesh = lmnew Graphics::Mesh(va, ib, boundingBox);
+            Graphics::Mesh* lMesh;
+            if (weights.empty())
+                lMesh = lmnew Graphics::Mesh(va, ib, boundingBox);
+            else
+                lMesh = lmnew Graphics::SkinnedMesh(va, ib, boundingBox, tempvertices, weights.data(), numVertices);
+            lMesh->BuildBVH(tempvertices, indicesArray, numVertices);
             
             delete[] tempvertices;
             delete[] indicesArray;
@@ -404,7 +687,7 @@ namespace Lumos
         return meshes;
     }
     
-    void LoadNode(int nodeIndex, entt::entity parent, tinygltf::Model& model, std::vector<Ref<Material>>& materials, std::vector<std::vector<Graphics::Mesh*>>& meshes, entt::registry& registry)
+    void LoadNode(const String& path, int nodeIndex, entt::entity parent, entt::entity root, tinygltf::Model& model, std::vector<Ref<Material>>& materials, std::vector<std::vector<Graphics::Mesh*>>& meshes, std::vector<GLTFSkin>& skins, entt::registry& registry)
     {
         if (nodeIndex < 0)
         {
@@ -430,21 +713,29 @@ namespace Lumos
             {
                 auto subname = node.name;
                 auto submeshEntity = registry.create();
-                auto lMesh = Ref<Graphics::Mesh>(meshes);
-                                
-                registry.emplace<MeshComponent>(submeshEntity, lMesh);
+
+                // Skinned vertices end up in the model's space, the node's own transform doesn't apply
+                auto skinnedMesh = node.skin >= 0 ? dynamic_cast<Graphics::SkinnedMesh*>(meshes) : nullptr;
+                Ref<Graphics::Mesh> lMesh;
+                if (skinnedMesh)
+                {
+                    Ref<Graphics::SkinnedMesh> skinned(skinnedMesh);
+                    skins[node.skin].animator->AddMesh(skinned);
+                    lMesh = skinned;
+                }
+                else
+                    lMesh = Ref<Graphics::Mesh>(meshes);
+
+                // Primitive index in the low bits so the source identifies one primitive of one glTF mesh
+                registry.emplace<MeshComponent>(submeshEntity, lMesh).SetSource(path, (u32(node.mesh) << 16) | u32(subIndex));
                 registry.emplace<Maths::Transform>(submeshEntity);
                 if(!subname.empty())
                     registry.emplace<NameComponent>(submeshEntity, subname);
-				registry.emplace<Hierarchy>(submeshEntity, meshEntity);
+				registry.emplace<Hierarchy>(submeshEntity, skinnedMesh ? root : meshEntity);
 
                 int materialIndex = model.meshes[node.mesh].primitives[subIndex].material;
                 if(materialIndex >= 0)
                     registry.emplace<MaterialComponent>(submeshEntity, materials[materialIndex]);
-
-                /*if (node.skin >= 0)
-                {
-                }*/
                 
                 subIndex++;
 
@@ -477,7 +768,7 @@ namespace Lumos
         {
             for (int child : node.children)
             {
-                LoadNode(child, meshEntity, model, materials, meshes, registry);
+                LoadNode(path, child, meshEntity, root, model, materials, meshes, skins, registry);
             }
         }
     }
@@ -528,17 +819,46 @@ namespace Lumos
 		registry.emplace<Maths::Transform>(entity);
         registry.emplace<NameComponent>(entity, name);
 
+        auto skins = LoadSkins(model);
+        LoadAnimations(model, skins);
+
+        // Skin each mesh is bound to, for remapping its joint indices
+        std::vector<int> meshSkins(model.meshes.size(), -1);
+        for (auto& node : model.nodes)
+        {
+            if (node.mesh >= 0 && node.skin >= 0 && meshSkins[node.mesh] < 0)
+                meshSkins[node.mesh] = node.skin;
+        }
+
         auto meshes = std::vector<std::vector<Graphics::Mesh*>>();
         
-        for (auto& mesh : model.meshes)
+        for (size_t i = 0; i < model.meshes.size(); i++)
         {
-            meshes.emplace_back(LoadMesh(model,mesh,LoadedMaterials));
+            meshes.emplace_back(LoadMesh(model, model.meshes[i], LoadedMaterials, meshSkins[i] >= 0 ? &skins[meshSkins[i]] : nullptr));
         }
         
         const tinygltf::Scene &gltfScene = model.scenes[Lumos::Maths::Max(0, model.defaultScene)];
         for (size_t i = 0; i < gltfScene.nodes.size(); i++)
         {
-            LoadNode(gltfScene.nodes[i], entity, model, LoadedMaterials, meshes, registry);
+            LoadNode(path, gltfScene.nodes[i], entity, entity, model, LoadedMaterials, meshes, skins, registry);
+        }
+
+        // The first skin animates from the model's entity, any others from a child each
+        for (size_t i = 0; i < skins.size(); i++)
+        {
+            if (skins[i].animator->GetMeshes().empty())
+                continue;
+
+            auto animatorEntity = entity;
+            if (registry.has<AnimatorComponent>(entity))
+            {
+                animatorEntity = registry.create();
+                registry.emplace<Maths::Transform>(animatorEntity);
+                registry.emplace<NameComponent>(animatorEntity, "Skin " + StringFormat::ToString(static_cast<u32>(i)));
+                registry.emplace<Hierarchy>(animatorEntity, entity);
+            }
+
+            registry.emplace<AnimatorComponent>(animatorEntity, skins[i].animator);
         }
         
 		return entity;
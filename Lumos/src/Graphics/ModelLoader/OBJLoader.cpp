@@ -64,6 +64,7 @@ namespace Lumos
         auto entity = registry.create();
 		registry.emplace<NameComponent>(entity, name);
 		bool singleMesh = shapes.size() == 1;
+		u32 subMeshIndex = 0;
 
 		for (const auto& shape : shapes)
 		{
@@ -213,16 +214,17 @@ namespace Lumos
 			ib.reset(Graphics::IndexBuffer::Create(indices, numIndices));
 
 			auto mesh = CreateRef<Graphics::Mesh>(va, ib, boundingBox);
+			mesh->BuildBVH(vertices, indices, numIndices);
 			if (singleMesh)
 			{
-				registry.emplace<MeshComponent>(entity, mesh);
+				registry.emplace<MeshComponent>(entity, mesh).SetSource(path, subMeshIndex);
 				registry.emplace<MaterialComponent>(entity, pbrMaterial);
                 registry.get_or_emplace<Maths::Transform>(entity);
 			}
 			else
 			{
 				auto meshEntity = registry.create();
-				registry.emplace<MeshComponent>(meshEntity, mesh);
+				registry.emplace<MeshComponent>(meshEntity, mesh).SetSource(path, subMeshIndex);
 				registry.emplace<MaterialComponent>(meshEntity, pbrMaterial);
 				registry.emplace<Maths::Transform>(meshEntity);
 				registry.emplace<Hierarchy>(meshEntity, entity);
@@ -230,6 +232,7 @@ namespace Lumos
 
 			delete[] vertices;
 			delete[] indices;
+			subMeshIndex++;
 		}
 
 		return entity;
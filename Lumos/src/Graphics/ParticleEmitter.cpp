@@ -1,16 +1,24 @@
 #include "lmpch.h"
 #include "ParticleEmitter.h"
-#include "Material.h"
-#include "Camera/Camera.h"
-#include "Mesh.h"
+#include "Renderable2D.h"
 #include "API/Texture.h"
 #include "Utilities/RandomNumberGenerator.h"
+#include "Utilities/Timer.h"
 #include "Maths/BoundingBox.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Core/OS/Memory.h"
+
+#include <imgui/imgui.h>
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
 
 namespace Lumos
 {
 
-	ParticleEmitter::ParticleEmitter()
+	ParticleEmitter::ParticleEmitter(u32 maxParticles)
 	: m_EmitterLifeTime(10.0f)
 	, m_NextParticleTime(0.0f)
 	, m_ParticleRate(0.04f)
@@ -31,79 +39,318 @@ namespace Lumos
 	, m_LifeLengthVariance(1.0f)
 	, m_NumTextureRows(1)
 	, m_Texture(nullptr)
+	, m_Colour(Maths::Vector4(1.0f))
+	, m_SortParticles(false)
+	{
+		SetMaxParticles(maxParticles);
+	}
+
+	ParticleEmitter::~ParticleEmitter()
 	{
+		SetMaxParticles(0);
 	}
 
-	ParticleEmitter::~ParticleEmitter() = default;
+	void ParticleEmitter::SetMaxParticles(u32 maxParticles)
+	{
+		float** arrays[] = { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Age, &m_Life, &m_ParticleScale, &m_Frame };
+
+		for (auto array : arrays)
+		{
+			if (*array)
+				Memory::AlignedFree(*array);
+			*array = nullptr;
+		}
+
+		m_Count = 0;
+		m_Capacity = maxParticles;
+		m_BoundingBox.Clear();
+
+		if (maxParticles == 0)
+			return;
+
+		const u32 paddedSize = ((maxParticles + 3) & ~3u) * sizeof(float);
 
-	Maths::BoundingBox* ParticleEmitter::CalculateBoundingBox() const
+		for (auto array : arrays)
+		{
+			*array = static_cast<float*>(Memory::AlignedAlloc(paddedSize, 16));
+			memset(*array, 0, paddedSize);
+		}
+	}
+
+	void ParticleEmitter::Emit(u32 count)
 	{
-		Maths::BoundingBox* box = lmnew Maths::BoundingBox();
+		auto& rand = RandomNumberGenerator32::Rand;
+		count = Maths::Min(count, m_Capacity - m_Count);
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			u32 index = m_Count++;
+
+			Maths::Vector3 position = m_Position + Maths::Vector3(rand(-m_Area.x, m_Area.x), rand(-m_Area.y, m_Area.y), rand(-m_Area.z, m_Area.z));
+			m_PositionX[index] = position.x;
+			m_PositionY[index] = position.y;
+			m_PositionZ[index] = position.z;
+			m_VelocityX[index] = m_InitialVelocity.x + rand(m_VelocityVarianceX.x, m_VelocityVarianceX.y);
+			m_VelocityY[index] = m_InitialVelocity.y + rand(m_VelocityVarianceY.x, m_VelocityVarianceY.y);
+			m_VelocityZ[index] = m_InitialVelocity.z + rand(m_VelocityVarianceZ.x, m_VelocityVarianceZ.y);
+			m_Age[index] = 0.0f;
+			m_Life[index] = m_ParticleLife * rand(m_LifeLengthVariance, 1.0f);
+			m_ParticleScale[index] = m_Scale * rand(m_ScaleVariance, 1.0f);
+			m_Frame[index] = 0.0f;
+
+			m_BoundingBox.Merge(position);
+		}
+	}
 
-		Maths::Vector3 vel = m_InitialVelocity + Maths::Vector3(m_VelocityVarianceX.y, m_VelocityVarianceY.y, m_VelocityVarianceZ.y);
-		Maths::Vector3 pos = m_Position + Maths::Vector3(m_PositionVarianceX.y, m_PositionVarianceY.y, m_PositionVarianceZ.y);
+	void ParticleEmitter::Integrate(u32 begin, u32 end, float dt, Maths::BoundingBox& bounds)
+	{
+		const float gravity = GRAVITY * m_GravityEffect * dt;
+		const float stageCount = float(m_NumTextureRows * m_NumTextureRows);
 
-		box->Merge(pos + vel * m_ParticleLife);
+		u32 i = begin;
 
-		vel = m_InitialVelocity + Maths::Vector3(m_VelocityVarianceX.x, m_VelocityVarianceY.x, m_VelocityVarianceZ.x);
-		pos = m_Position + Maths::Vector3(m_PositionVarianceX.x, m_PositionVarianceY.x, m_PositionVarianceZ.x);
+#ifdef LUMOS_SSE
+		const __m128 dtV = _mm_set1_ps(dt);
+		const __m128 gravityV = _mm_set1_ps(gravity);
+		const __m128 stagesV = _mm_set1_ps(stageCount);
+		const __m128 lastStageV = _mm_set1_ps(stageCount - 1.0f);
+		__m128 minX = _mm_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+		__m128 maxX = _mm_set1_ps(-FLT_MAX), maxY = maxX, maxZ = maxX;
 
-		box->Merge(pos + vel * m_ParticleLife);
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 vx = _mm_load_ps(m_VelocityX + i);
+			__m128 vy = _mm_add_ps(_mm_load_ps(m_VelocityY + i), gravityV);
+			__m128 vz = _mm_load_ps(m_VelocityZ + i);
+			_mm_store_ps(m_VelocityY + i, vy);
+
+			__m128 px = _mm_add_ps(_mm_load_ps(m_PositionX + i), _mm_mul_ps(vx, dtV));
+			__m128 py = _mm_add_ps(_mm_load_ps(m_PositionY + i), _mm_mul_ps(vy, dtV));
+			__m128 pz = _mm_add_ps(_mm_load_ps(m_PositionZ + i), _mm_mul_ps(vz, dtV));
+			_mm_store_ps(m_PositionX + i, px);
+			_mm_store_ps(m_PositionY + i, py);
+			_mm_store_ps(m_PositionZ + i, pz);
+
+			__m128 age = _mm_add_ps(_mm_load_ps(m_Age + i), dtV);
+			_mm_store_ps(m_Age + i, age);
+
+			// Atlas frame = min(floor(age / life * stages), stages - 1), age is never negative so truncation is floor
+			__m128 progress = _mm_mul_ps(_mm_div_ps(age, _mm_load_ps(m_Life + i)), stagesV);
+			__m128 frame = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(progress)), lastStageV);
+			_mm_store_ps(m_Frame + i, frame);
+
+			minX = _mm_min_ps(minX, px); maxX = _mm_max_ps(maxX, px);
+			minY = _mm_min_ps(minY, py); maxY = _mm_max_ps(maxY, py);
+			minZ = _mm_min_ps(minZ, pz); maxZ = _mm_max_ps(maxZ, pz);
+		}
 
-		box->Merge(Maths::Vector3(0.0f));
+		if (i > begin)
+		{
+			alignas(16) float lo[3][4];
+			alignas(16) float hi[3][4];
+			_mm_store_ps(lo[0], minX); _mm_store_ps(lo[1], minY); _mm_store_ps(lo[2], minZ);
+			_mm_store_ps(hi[0], maxX); _mm_store_ps(hi[1], maxY); _mm_store_ps(hi[2], maxZ);
 
-		//TODO: More Accurate box;
+			for (u32 lane = 0; lane < 4; lane++)
+			{
+				bounds.Merge(Maths::Vector3(lo[0][lane], lo[1][lane], lo[2][lane]));
+				bounds.Merge(Maths::Vector3(hi[0][lane], hi[1][lane], hi[2][lane]));
+			}
+		}
+#endif
 
-		return box;
+		for (; i < end; ++i)
+		{
+			m_VelocityY[i] += gravity;
+			m_PositionX[i] += m_VelocityX[i] * dt;
+			m_PositionY[i] += m_VelocityY[i] * dt;
+			m_PositionZ[i] += m_VelocityZ[i] * dt;
+			m_Age[i] += dt;
+			m_Frame[i] = Maths::Min(std::floor(m_Age[i] / m_Life[i] * stageCount), stageCount - 1.0f);
+
+			bounds.Merge(Maths::Vector3(m_PositionX[i], m_PositionY[i], m_PositionZ[i]));
+		}
 	}
 
 	void ParticleEmitter::Update(float dt)
 	{
-		m_NextParticleTime -= dt;
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
 
-		if (m_NextParticleTime <= 0.0f)
+		const u32 jobCount = (m_Count + PARTICLE_JOB_SIZE - 1) / PARTICLE_JOB_SIZE;
+		m_JobBounds.resize(jobCount);
+
+		if (jobCount > 1)
 		{
-			for (u32 i = 0; i < m_NumLaunchParticles; ++i)
+			System::JobSystem::Dispatch(jobCount, 1, [&](JobDispatchArgs args)
 			{
-//				m_Particles.push_back(CreateRef<Particle>(m_Position + Maths::Vector3(Lumos::RandomNumberGenerator32::Rand(-m_Area.x, m_Area.x),Lumos::RandomNumberGenerator32::Rand(-m_Area.y, m_Area.y),Lumos::RandomNumberGenerator32::Rand(-m_Area.z, m_Area.z)), m_InitialVelocity + Maths::Vector3(Lumos::RandomNumberGenerator32::Rand(m_VelocityVarianceX.x,m_VelocityVarianceX.y),Lumos::RandomNumberGenerator32::Rand(m_VelocityVarianceY.x, m_VelocityVarianceY.y),Lumos::RandomNumberGenerator32::Rand(m_VelocityVarianceZ.x, m_VelocityVarianceZ.y)), m_GravityEffect, m_ParticleLife * Lumos::RandomNumberGenerator32::Rand(m_LifeLengthVariance,1.0f), m_Scale * Lumos::RandomNumberGenerator32::Rand(m_ScaleVariance,1.0f)));
+				u32 begin = args.jobIndex * PARTICLE_JOB_SIZE;
+				m_JobBounds[args.jobIndex].Clear();
+				Integrate(begin, Maths::Min(begin + PARTICLE_JOB_SIZE, m_Count), dt, m_JobBounds[args.jobIndex]);
+			});
+
+			System::JobSystem::Wait();
+		}
+		else if (jobCount == 1)
+		{
+			m_JobBounds[0].Clear();
+			Integrate(0, m_Count, dt, m_JobBounds[0]);
+		}
+
+		// Swap remove dead particles, order is not preserved
+		for (u32 i = 0; i < m_Count;)
+		{
+			if (m_Age[i] < m_Life[i])
+			{
+				++i;
+				continue;
 			}
 
-			m_NextParticleTime += m_ParticleRate;
+			u32 last = --m_Count;
+			m_PositionX[i] = m_PositionX[last];
+			m_PositionY[i] = m_PositionY[last];
+			m_PositionZ[i] = m_PositionZ[last];
+			m_VelocityX[i] = m_VelocityX[last];
+			m_VelocityY[i] = m_VelocityY[last];
+			m_VelocityZ[i] = m_VelocityZ[last];
+			m_Age[i] = m_Age[last];
+			m_Life[i] = m_Life[last];
+			m_ParticleScale[i] = m_ParticleScale[last];
+			m_Frame[i] = m_Frame[last];
+		}
+
+		// Bounds are from before the cull, dead particles only make them slightly conservative
+		m_BoundingBox.Clear();
+		for (auto& bounds : m_JobBounds)
+		{
+			if (bounds.Defined())
+				m_BoundingBox.Merge(bounds);
+		}
+
+		m_NextParticleTime -= dt;
+
+		while (m_NextParticleTime <= 0.0f)
+		{
+			Emit(m_NumLaunchParticles);
+			m_NextParticleTime += Maths::Max(m_ParticleRate, 0.0001f);
 		}
 
-		for (auto it = m_Particles.begin(); it != m_Particles.end();)
+		if (m_BoundingBox.Defined())
 		{
-			if (!(*it)->Update(dt, m_NumTextureRows))
-				it = m_Particles.erase(it);
-			else
-				++it;
+			// Billboards extend up to half their scale around the particle centre
+			Maths::Vector3 extent = Maths::Vector3(m_Scale * 0.5f);
+			m_BoundingBox.min_ -= extent;
+			m_BoundingBox.max_ += extent;
 		}
 
+		m_UpdateTime = timer.GetMS(1000.0f);
 	}
 
-	void ParticleEmitter::Render(Material* material, Camera* camera, Mesh* quad)
+	void ParticleEmitter::BuildVertices(Graphics::VertexData* vertices, const Maths::Vector3& cameraPosition, const Maths::Vector3& cameraRight, const Maths::Vector3& cameraUp, const Maths::Vector3& cameraForward, float textureID)
 	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		const u32* order = nullptr;
+
+		if (m_SortParticles && m_Count > 1)
+		{
+			m_SortOrder.resize(m_Count);
+			m_SortDepth.resize(m_Count);
+
+			for (u32 i = 0; i < m_Count; ++i)
+			{
+				m_SortOrder[i] = i;
+				m_SortDepth[i] = (m_PositionX[i] - cameraPosition.x) * cameraForward.x + (m_PositionY[i] - cameraPosition.y) * cameraForward.y + (m_PositionZ[i] - cameraPosition.z) * cameraForward.z;
+			}
+
+			// Back to front for alpha blending
+			std::sort(m_SortOrder.begin(), m_SortOrder.end(), [this](u32 a, u32 b) { return m_SortDepth[a] > m_SortDepth[b]; });
+			order = m_SortOrder.data();
+		}
+
+		const u32 rows = Maths::Max(m_NumTextureRows, 1u);
+		const float frameSize = 1.0f / float(rows);
+		const Maths::Vector2 tid = Maths::Vector2(textureID, 0.0f);
+
+		const u32 jobCount = (m_Count + PARTICLE_JOB_SIZE - 1) / PARTICLE_JOB_SIZE;
+
+		auto buildJob = [&](JobDispatchArgs args)
+		{
+			u32 begin = args.jobIndex * PARTICLE_JOB_SIZE;
+			u32 end = Maths::Min(begin + PARTICLE_JOB_SIZE, m_Count);
+			Graphics::VertexData* vertex = vertices + begin * 4;
+
+			for (u32 j = begin; j < end; ++j)
+			{
+				u32 i = order ? order[j] : j;
+
+				Maths::Vector3 centre = Maths::Vector3(m_PositionX[i], m_PositionY[i], m_PositionZ[i]);
+				Maths::Vector3 right = cameraRight * (m_ParticleScale[i] * 0.5f);
+				Maths::Vector3 up = cameraUp * (m_ParticleScale[i] * 0.5f);
+
+				u32 frame = static_cast<u32>(m_Frame[i]);
+				float u0 = float(frame % rows) * frameSize;
+				float v0 = float(frame / rows) * frameSize;
+				float u1 = u0 + frameSize;
+				float v1 = v0 + frameSize;
+
+				Maths::Vector4 colour = m_Colour;
+				colour.w *= 1.0f - m_Age[i] / m_Life[i];
+
+				vertex->vertex = centre - right - up;
+				vertex->uv = Maths::Vector2(u0, v1);
+				vertex->tid = tid;
+				vertex->color = colour;
+				vertex++;
+
+				vertex->vertex = centre + right - up;
+				vertex->uv = Maths::Vector2(u1, v1);
+				vertex->tid = tid;
+				vertex->color = colour;
+				vertex++;
+
+				vertex->vertex = centre + right + up;
+				vertex->uv = Maths::Vector2(u1, v0);
+				vertex->tid = tid;
+				vertex->color = colour;
+				vertex++;
+
+				vertex->vertex = centre - right + up;
+				vertex->uv = Maths::Vector2(u0, v0);
+				vertex->tid = tid;
+				vertex->color = colour;
+				vertex++;
+			}
+		};
+
+		if (jobCount > 1)
+		{
+			System::JobSystem::Dispatch(jobCount, 1, buildJob);
+			System::JobSystem::Wait();
+		}
+		else if (jobCount == 1)
+			buildJob({ 0, 0 });
+
+		m_BuildTime = timer.GetMS(1000.0f);
 	}
 
-	Maths::Matrix4 ParticleEmitter::UpdateModelViewMatrix(const Maths::Matrix4& viewMatrix, Particle* particle)
+	void ParticleEmitter::OnImGui()
 	{
-		Maths::Matrix4 mvMatrix;
-		mvMatrix.ToIdentity();
-
-		//mvMatrix = Maths::Matrix4::Translation(particle->GetPosition());
-		//mvMatrix[0] = viewMatrix[0];
-		//mvMatrix[1] = viewMatrix[4];
-		//mvMatrix[2] = viewMatrix[8];
-		//mvMatrix[4] = viewMatrix[1];
-		//mvMatrix[5] = viewMatrix[5];
-		//mvMatrix[6] = viewMatrix[9];
-		//mvMatrix[8] = viewMatrix[2];
-		//mvMatrix[9] = viewMatrix[6];
-		//mvMatrix[10] = viewMatrix[10];
-		//mvMatrix = mvMatrix * Maths::Matrix4::Rotation(particle->GetRotation(), Maths::Vector3(0.0f, 0.0f, 1.0f)) * Maths::Matrix4::Scale(Maths::Vector3(particle->GetScale()));
-		//mvMatrix = viewMatrix * mvMatrix;
-
-		return mvMatrix;
+		ImGui::Text("Particles : %u / %u", m_Count, m_Capacity);
+		ImGui::Text("Update : %.3f ms, Build : %.3f ms", m_UpdateTime, m_BuildTime);
+
+		ImGui::DragFloat("Particle Rate", &m_ParticleRate, 0.001f, 0.0001f, 10.0f);
+		int launch = int(m_NumLaunchParticles);
+		if (ImGui::DragInt("Launch Count", &launch, 1.0f, 0, int(m_Capacity)))
+			m_NumLaunchParticles = u32(launch);
+		ImGui::DragFloat("Particle Life", &m_ParticleLife, 0.01f, 0.01f, 100.0f);
+		ImGui::DragFloat("Gravity Effect", &m_GravityEffect, 0.01f);
+		ImGui::DragFloat("Scale", &m_Scale, 0.01f, 0.0f, 100.0f);
+		ImGui::DragFloat3("Area", &m_Area.x, 0.01f);
+		ImGui::DragFloat3("Initial Velocity", &m_InitialVelocity.x, 0.01f);
+		ImGui::ColorEdit4("Colour", &m_Colour.x);
+		ImGui::Checkbox("Depth Sort", &m_SortParticles);
 	}
 
     float ParticleEmitter::GetEmitterLifeTime() const
@@ -225,14 +472,4 @@ namespace Lumos
     {
         ParticleEmitter::m_Texture = texture;
     }
-
-    const std::vector<Ref<Particle>> &ParticleEmitter::GetParticles() const
-    {
-        return m_Particles;
-    }
-
-    void ParticleEmitter::SetParticles(const std::vector<Ref<Particle>> &particles)
-    {
-        ParticleEmitter::m_Particles = particles;
-    }
-}
+}
\ No newline at end of file
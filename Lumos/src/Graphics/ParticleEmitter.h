@@ -1,37 +1,49 @@
 #pragma once
 #include "lmpch.h"
 #include "Maths/Maths.h"
-#include "Particle.h"
+
+#define GRAVITY -9.8f
+#define PARTICLE_JOB_SIZE 16384
 
 namespace Lumos
 {
-	class Material;
-	class Camera;
-	class Mesh;
-	class VertexArray;
-    
     namespace Graphics
     {
         class Texture2D;
+		struct VertexData;
     }
 
-    namespace Maths
-	{
-		class BoundingBox;
-	}
-	
+	// Particles are stored structure of arrays in a fixed size pool. Dead particles are swap removed,
+	// and the integrate/age kernel runs in SIMD blocks of four spread over the job system.
 	class LUMOS_EXPORT ParticleEmitter
 	{
 	public:
 
-		ParticleEmitter();
+		ParticleEmitter(u32 maxParticles = 1024);
 		~ParticleEmitter();
-		Maths::BoundingBox* CalculateBoundingBox() const;
 
-		static Maths::Matrix4 UpdateModelViewMatrix(const Maths::Matrix4& viewMatrix, Particle* particle);
+		// Bounds of the live particles, updated by the simulation kernel
+		const Maths::BoundingBox& GetBoundingBox() const { return m_BoundingBox; }
 
 		void Update(float dt);
-		void Render(Material* material, Camera* camera, Mesh* quad);
+
+		// Writes four camera facing vertices per live particle, optionally sorted back to front
+		void BuildVertices(Graphics::VertexData* vertices, const Maths::Vector3& cameraPosition, const Maths::Vector3& cameraRight, const Maths::Vector3& cameraUp, const Maths::Vector3& cameraForward, float textureID);
+
+		u32 GetParticleCount() const { return m_Count; }
+		u32 GetMaxParticles() const { return m_Capacity; }
+		void SetMaxParticles(u32 maxParticles);
+
+		bool GetSortParticles() const { return m_SortParticles; }
+		void SetSortParticles(bool sort) { m_SortParticles = sort; }
+
+		const Maths::Vector4& GetColour() const { return m_Colour; }
+		void SetColour(const Maths::Vector4& colour) { m_Colour = colour; }
+
+		float GetUpdateTime() const { return m_UpdateTime; }
+		float GetBuildTime() const { return m_BuildTime; }
+
+		void OnImGui();
 
 		float GetEmitterLifeTime() const;
 		void SetEmitterLifeTime(float emitterLifeTime);
@@ -69,10 +81,9 @@ namespace Lumos
 		Graphics::Texture2D* GetTexture() const;
 		void SetTexture(Graphics::Texture2D *m_Texture);
 
-		const std::vector<Ref<Particle>>& GetParticles() const;
-		void SetParticles(const std::vector<Ref<Particle>>& particles);
-
 	private:
+		void Emit(u32 count);
+		void Integrate(u32 begin, u32 end, float dt, Maths::BoundingBox& bounds);
 
 		float m_EmitterLifeTime;
 		float m_NextParticleTime;
@@ -179,8 +190,29 @@ namespace Lumos
 		u32 m_NumTextureRows;
 
 		Graphics::Texture2D* m_Texture;
-		std::vector<Ref<Particle>> m_Particles;
-
-
+		Maths::Vector4 m_Colour;
+		bool m_SortParticles;
+
+		// Structure of arrays pool, each array is 16 byte aligned and padded to a multiple of four
+		float* m_PositionX = nullptr;
+		float* m_PositionY = nullptr;
+		float* m_PositionZ = nullptr;
+		float* m_VelocityX = nullptr;
+		float* m_VelocityY = nullptr;
+		float* m_VelocityZ = nullptr;
+		float* m_Age = nullptr;
+		float* m_Life = nullptr;
+		float* m_ParticleScale = nullptr;
+		float* m_Frame = nullptr;
+		u32 m_Count = 0;
+		u32 m_Capacity = 0;
+
+		Maths::BoundingBox m_BoundingBox;
+		std::vector<Maths::BoundingBox> m_JobBounds;
+		std::vector<u32> m_SortOrder;
+		std::vector<float> m_SortDepth;
+
+		float m_UpdateTime = 0.0f;
+		float m_BuildTime = 0.0f;
 	};
 }
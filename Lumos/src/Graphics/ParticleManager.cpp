@@ -1,18 +1,19 @@
 #include "lmpch.h"
 #include "ParticleManager.h"
-#include "Material.h"
-#include "Particle.h"
-#include "API/Shader.h"
-#include "Camera/Camera.h"
-#include "API/Renderer.h"
-#include "Mesh.h"
-#include "MeshFactory.h"
+#include "ECS/Component/ParticleComponent.h"
+#include "Maths/Transform.h"
+#include "Utilities/TimeStep.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
 
 namespace Lumos
 {
 
 	ParticleManager::ParticleManager()
 	{
+		m_DebugName = "Particle Manager";
 	}
 
 	ParticleManager::~ParticleManager()
@@ -24,16 +25,70 @@ namespace Lumos
 		m_Emitters.push_back(emitter);
 	}
 
-	void ParticleManager::Render(Camera* camera)
+	void ParticleManager::OnInit()
+	{
+	}
+
+	void ParticleManager::DeclareAccess(SystemAccess& access)
 	{
+		// Emitters follow their entity, so this runs after physics has moved it
+		access.Read<Maths::Transform>().Write<ParticleComponent>().Write<ParticleManager>();
 	}
 
-	void ParticleManager::Update(float dt)
+	void ParticleManager::OnUpdate(const TimeStep& timeStep, Scene* scene)
 	{
-		for (auto emitter : m_Emitters)
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		const float dt = timeStep.GetSeconds();
+
+		m_EmitterCount = 0;
+		m_ParticleCount = 0;
+
+		for (auto& emitter : m_Emitters)
 		{
 			emitter->Update(dt);
+
+			m_EmitterCount++;
+			m_ParticleCount += emitter->GetParticleCount();
+		}
+
+		if (scene)
+		{
+			auto& registry = scene->GetRegistry();
+			auto view = registry.view<ParticleComponent>();
+
+			for (auto entity : view)
+			{
+				auto& component = view.get<ParticleComponent>(entity);
+				auto& emitter = component.GetParticleEmitter();
+
+				if (!emitter)
+					continue;
+
+				auto transform = registry.try_get<Maths::Transform>(entity);
+				if (transform)
+					emitter->SetPosition(transform->GetWorldPosition() + component.GetPositionOffset());
+
+				emitter->Update(dt);
+
+				m_EmitterCount++;
+				m_ParticleCount += emitter->GetParticleCount();
+			}
 		}
 
+		m_UpdateTime = timer.GetMS(1000.0f);
+	}
+
+	void ParticleManager::OnImGui()
+	{
+		ImGui::TextUnformatted("Particle Manager");
+		ImGui::Text("Emitters : %u", m_EmitterCount);
+		ImGui::Text("Particles : %u", m_ParticleCount);
+		ImGui::Text("Update : %.3f ms", m_UpdateTime);
+	}
+
+	void ParticleManager::OnDebugDraw()
+	{
 	}
 }
@@ -2,12 +2,12 @@
 #include "lmpch.h"
 #include "Maths/Maths.h"
 #include "ParticleEmitter.h"
+#include "ECS/ISystem.h"
 
 namespace Lumos
 {
-	class Camera;
-
-	class LUMOS_EXPORT ParticleManager
+	// Simulates every ParticleComponent in the scene plus any emitters added directly
+	class LUMOS_EXPORT ParticleManager : public ISystem
 	{
 	public:
 
@@ -15,12 +15,19 @@ namespace Lumos
 		~ParticleManager();
 
         void Add(Ref<ParticleEmitter> emitter);
-		void Render(Camera* camera);
 
-		void Update(float dt);
+		void OnInit() override;
+		void OnUpdate(const TimeStep& timeStep, Scene* scene) override;
+		void OnImGui() override;
+		void OnDebugDraw() override;
+		void DeclareAccess(SystemAccess& access) override;
 
 	private:
 
 		std::vector<Ref<ParticleEmitter>> m_Emitters;
+
+		u32 m_EmitterCount = 0;
+		u32 m_ParticleCount = 0;
+		float m_UpdateTime = 0.0f;
 	};
 }
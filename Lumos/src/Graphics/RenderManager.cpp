@@ -1,6 +1,7 @@
 #include "lmpch.h"
 #include "RenderManager.h"
 #include "GBuffer.h"
+#include "Renderers/OcclusionCuller.h"
 
 namespace Lumos
 {
@@ -11,9 +12,10 @@ namespace Lumos
 			SetScreenBufferSize(width, height);
 
 			m_GBuffer = lmnew GBuffer(width, height);
+			m_OcclusionCuller = lmnew OcclusionCuller();
 			Reset();
 		}
-		RenderManager::~RenderManager() { delete m_GBuffer; }
+		RenderManager::~RenderManager() { delete m_GBuffer; delete m_OcclusionCuller; }
 
 		void RenderManager::OnResize(u32 width, u32 height)
 		{
@@ -10,6 +10,7 @@ namespace Lumos
 		class GBuffer;
 		class ShadowRenderer;
 		class SkyboxRenderer;
+		class OcclusionCuller;
 
 		class LUMOS_EXPORT RenderManager
 		{
@@ -28,6 +29,7 @@ namespace Lumos
 			u32 GetNumShadowMaps() const { return m_NumShadowMaps; };
 			TextureDepthArray* GetShadowTexture() const { return m_ShadowTexture; };
 			GBuffer* GetGBuffer() const { return m_GBuffer; }
+			OcclusionCuller* GetOcclusionCuller() const { return m_OcclusionCuller; }
 
 			void SetReflectSkyBox(bool reflect) { m_ReflectSkyBox = reflect; }
 			void SetUseShadowMap(bool shadow) { m_UseShadowMap = shadow; }
@@ -48,6 +50,7 @@ namespace Lumos
 			Texture* m_ScreenTexture = nullptr;
 
 			GBuffer* m_GBuffer = nullptr;
+			OcclusionCuller* m_OcclusionCuller = nullptr;
 
 			ShadowRenderer* m_ShadowRenderer = nullptr;
 
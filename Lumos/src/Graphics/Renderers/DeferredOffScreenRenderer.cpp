@@ -11,9 +11,11 @@
 #include "Core/Profiler.h"
 
 #include "Graphics/RenderManager.h"
+#include "Graphics/Renderers/OcclusionCuller.h"
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/Material.h"
+#include "Graphics/MaterialTable.h"
 #include "Graphics/GBuffer.h"
 
 #include "Graphics/API/Shader.h"
@@ -26,6 +28,7 @@
 #include "Graphics/API/RenderPass.h"
 #include "Graphics/API/Pipeline.h"
 #include "Graphics/API/GraphicsContext.h"
+#include "Graphics/API/DescriptorSet.h"
 
 #include <imgui/imgui.h>
 
@@ -66,6 +69,9 @@ namespace Lumos
 			delete m_DeferredCommandBuffers;
 			delete m_DefaultMaterial;
 
+			delete[] m_MaterialPushConstant->data;
+			delete m_MaterialPushConstant;
+
 			delete[] m_VSSystemUniformBuffer;
 
 			for (auto& commandBuffer : m_CommandBuffers)
@@ -120,17 +126,16 @@ namespace Lumos
 
 			m_RenderPass = Graphics::RenderPass::Create();
 
-			AttachmentInfo textureTypesOffScreen[5] = 
+			AttachmentInfo textureTypesOffScreen[4] = 
 			{
 				{ TextureType::COLOUR, Application::Instance()->GetRenderManager()->GetGBuffer()->GetTextureFormat(SCREENTEX_COLOUR) },
-				{ TextureType::COLOUR, Application::Instance()->GetRenderManager()->GetGBuffer()->GetTextureFormat(SCREENTEX_POSITION) },
 				{ TextureType::COLOUR, Application::Instance()->GetRenderManager()->GetGBuffer()->GetTextureFormat(SCREENTEX_NORMALS) },
 				{ TextureType::COLOUR, Application::Instance()->GetRenderManager()->GetGBuffer()->GetTextureFormat(SCREENTEX_PBR) },
 				{ TextureType::DEPTH, TextureFormat::DEPTH }
 			};
 
 			Graphics::RenderpassInfo renderpassCIOffScreen{};
-			renderpassCIOffScreen.attachmentCount = 5;
+			renderpassCIOffScreen.attachmentCount = 4;
 			renderpassCIOffScreen.textureType = textureTypesOffScreen;
 
 			m_RenderPass->Init(renderpassCIOffScreen);
@@ -146,11 +151,17 @@ namespace Lumos
 			m_DeferredCommandBuffers = Graphics::CommandBuffer::Create();
 			m_DeferredCommandBuffers->Init(true);
 
+			m_MaterialPushConstant = lmnew Graphics::PushConstant();
+			m_MaterialPushConstant->type = Graphics::PushConstantDataType::UINT;
+			m_MaterialPushConstant->size = sizeof(u32);
+			m_MaterialPushConstant->data = lmnew u8[sizeof(u32)];
+			m_MaterialPushConstant->shaderStage = ShaderType::FRAGMENT;
+
 			CreatePipeline();
 			CreateBuffer();
 			CreateFBO();
 
-			m_DefaultMaterial->CreateDescriptorSet(m_Pipeline, 1);
+			MaterialTable::Instance()->Register(m_DefaultMaterial);
 
 			m_ClearColour = Maths::Vector4(0.1f, 0.1f, 0.1f, 1.0f);
 		}
@@ -164,6 +175,7 @@ namespace Lumos
 
             auto& registry = scene->GetRegistry();
             auto group = registry.group<MeshComponent>(entt::get<Maths::Transform>);
+            auto occlusionCuller = Application::Instance()->GetRenderManager()->GetOcclusionCuller();
 
             for(auto entity : group)
             {
@@ -180,6 +192,9 @@ namespace Lumos
                     if (inside == Maths::Intersection::OUTSIDE)
 						continue;
 
+                    if (!occlusionCuller->IsVisible(scene, entity))
+                        continue;
+
                     auto meshPtr = mesh.GetMesh();
                     auto materialComponent = registry.try_get<MaterialComponent>(entity);
                     Material* material = nullptr;
@@ -187,9 +202,9 @@ namespace Lumos
                     {
                         material = materialComponent->GetMaterial().get();
 
-                        if (material->GetDescriptorSet() == nullptr || material->GetPipeline() != m_Pipeline || materialComponent->GetTexturesUpdated())
+                        if (!material->IsInTable() || materialComponent->GetTexturesUpdated())
                         {
-                            material->CreateDescriptorSet(m_Pipeline, 1);
+                            MaterialTable::Instance()->Register(material);
                             materialComponent->SetTexturesUpdated(false);
                         }
                     }
@@ -205,6 +220,14 @@ namespace Lumos
                 }
 			}
 
+			// Group draws by material table page so the page set only changes between groups
+			std::stable_sort(m_CommandQueue.begin(), m_CommandQueue.end(), [this](const RenderCommand& a, const RenderCommand& b)
+			{
+				auto pageA = a.material ? a.material->GetTablePage() : m_DefaultMaterial->GetTablePage();
+				auto pageB = b.material ? b.material->GetTablePage() : m_DefaultMaterial->GetTablePage();
+				return pageA < pageB;
+			});
+
 			SetSystemUniforms(m_Shader);
 
 			Present();
@@ -290,14 +313,30 @@ namespace Lumos
 		{
             m_Pipeline->SetActive(m_DeferredCommandBuffers);
 
+			auto materialTable = MaterialTable::Instance();
+			u32 currentPage = MATERIAL_TABLE_INVALID_PAGE;
+			Graphics::DescriptorSet* pageDescriptorSet = nullptr;
+			std::vector<Graphics::PushConstant> pushConstants = { *m_MaterialPushConstant };
+
             for (u32 i = 0; i < static_cast<u32>(m_CommandQueue.size()); i++)
             {
-                auto command = m_CommandQueue[i];
+                auto& command = m_CommandQueue[i];
 				Mesh* mesh = command.mesh;
+				Material* material = command.material ? command.material : m_DefaultMaterial;
 
 				uint32_t dynamicOffset = i * static_cast<uint32_t>(m_DynamicAlignment);
 
-				std::vector<Graphics::DescriptorSet*> descriptorSets = { m_Pipeline->GetDescriptorSet(), command.material ? command.material->GetDescriptorSet() : m_DefaultMaterial->GetDescriptorSet() };
+				if (material->GetTablePage() != currentPage)
+				{
+					currentPage = material->GetTablePage();
+					pageDescriptorSet = materialTable->GetDescriptorSet(currentPage, m_Pipeline, 1);
+				}
+
+				u32 materialIndex = material->GetTableIndex();
+				memcpy(m_MaterialPushConstant->data, &materialIndex, sizeof(u32));
+				pageDescriptorSet->SetPushConstants(pushConstants);
+
+				std::vector<Graphics::DescriptorSet*> descriptorSets = { m_Pipeline->GetDescriptorSet(), pageDescriptorSet };
 
 				mesh->GetVertexArray()->Bind(m_DeferredCommandBuffers);
 				mesh->GetIndexBuffer()->Bind(m_DeferredCommandBuffers);
@@ -317,12 +356,7 @@ namespace Lumos
 				{ Graphics::DescriptorType::UNIFORM_BUFFER, MAX_OBJECTS },
 				{ Graphics::DescriptorType::UNIFORM_BUFFER, MAX_OBJECTS },
 				{ Graphics::DescriptorType::UNIFORM_BUFFER_DYNAMIC, MAX_OBJECTS },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_OBJECTS },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_OBJECTS },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_OBJECTS },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_OBJECTS },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_OBJECTS },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_OBJECTS }
+				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_OBJECTS * MATERIAL_TABLE_TEXTURES }
 			};
 
 			std::vector<Graphics::DescriptorLayoutInfo> layoutInfo =
@@ -333,13 +367,9 @@ namespace Lumos
 
 			std::vector<Graphics::DescriptorLayoutInfo> layoutInfoMesh =
 			{
-				{ Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 0 },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 1 },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 2 },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 3 },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 4 },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 5 },
-				{ Graphics::DescriptorType::UNIFORM_BUFFER, Graphics::ShaderType::FRAGMENT, 6 },
+				{ Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 0, MATERIAL_TABLE_TEXTURES },
+				// GL shares uniform block slots between sets, so skip the slots used by set 0
+				{ Graphics::DescriptorType::UNIFORM_BUFFER, Graphics::ShaderType::FRAGMENT, 2 },
 			};
 
 			auto attributeDescriptions = Vertex::getAttributeDescriptions();
@@ -368,12 +398,13 @@ namespace Lumos
 			pipelineCI.numLayoutBindings = static_cast<u32>(poolInfo.size());
 			pipelineCI.typeCounts = poolInfo.data();
 			pipelineCI.strideSize = sizeof(Vertex);
-			pipelineCI.numColorAttachments = 6;
+			pipelineCI.numColorAttachments = 3;
 			pipelineCI.polygonMode = Graphics::PolygonMode::Fill;
 			pipelineCI.cullMode = Graphics::CullMode::BACK;
 			pipelineCI.transparencyEnabled = false;
 			pipelineCI.depthBiasEnabled = false;
 			pipelineCI.maxObjects = MAX_OBJECTS;
+			pipelineCI.pushConstants = { *m_MaterialPushConstant };
 
 			m_Pipeline = Graphics::Pipeline::Create(pipelineCI);
 		}
@@ -427,13 +458,12 @@ namespace Lumos
 
 		void DeferredOffScreenRenderer::CreateFBO()
 		{
-			const u32 attachmentCount = 5;
+			const u32 attachmentCount = 4;
 			TextureType attachmentTypes[attachmentCount];
 			attachmentTypes[0] = TextureType::COLOUR;
 			attachmentTypes[1] = TextureType::COLOUR;
 			attachmentTypes[2] = TextureType::COLOUR;
-			attachmentTypes[3] = TextureType::COLOUR;
-			attachmentTypes[4] = TextureType::DEPTH;
+			attachmentTypes[3] = TextureType::DEPTH;
 
 			FramebufferInfo bufferInfo{};
 			bufferInfo.width = m_ScreenBufferWidth;
@@ -444,10 +474,9 @@ namespace Lumos
 
 			Texture* attachments[attachmentCount];
 			attachments[0] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_COLOUR);
-			attachments[1] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_POSITION);
-			attachments[2] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_NORMALS);
-			attachments[3] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_PBR);
-			attachments[4] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetDepthTexture();
+			attachments[1] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_NORMALS);
+			attachments[2] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_PBR);
+			attachments[3] = Application::Instance()->GetRenderManager()->GetGBuffer()->GetDepthTexture();
 			bufferInfo.attachments = attachments;
 
 			m_FBO = Framebuffer::Create(bufferInfo);
@@ -469,6 +498,18 @@ namespace Lumos
 		void DeferredOffScreenRenderer::OnImGui()
 		{
 			ImGui::TextUnformatted("Deferred Offscreen Renderer");
+
+			if (ImGui::TreeNode("Material Table"))
+			{
+				MaterialTable::Instance()->OnImGui();
+				ImGui::TreePop();
+			}
+
+			if (ImGui::TreeNode("Occlusion Culling"))
+			{
+				Application::Instance()->GetRenderManager()->GetOcclusionCuller()->OnImGui();
+				ImGui::TreePop();
+			}
 		}
 	}
 }
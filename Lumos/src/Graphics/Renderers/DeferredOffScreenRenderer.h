@@ -63,6 +63,7 @@ namespace Lumos
 			Maths::Vector4 m_ClearColour;
 
 			Material* m_DefaultMaterial;
+			Graphics::PushConstant* m_MaterialPushConstant = nullptr;
 
 			UniformBuffer* m_UniformBuffer;
 			UniformBuffer* m_ModelUniformBuffer;
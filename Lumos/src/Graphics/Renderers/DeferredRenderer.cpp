@@ -2,6 +2,7 @@
 #include "DeferredRenderer.h"
 #include "DeferredOffScreenRenderer.h"
 #include "ShadowRenderer.h"
+#include "LightClusterGrid.h"
 
 #include "App/Scene.h"
 #include "App/Application.h"
@@ -27,11 +28,11 @@
 #include "Graphics/API/RenderPass.h"
 #include "Graphics/API/Pipeline.h"
 #include "Graphics/API/GraphicsContext.h"
+#include "Graphics/API/DescriptorSet.h"
 #include "Graphics/Environment.h"
 
 #include <imgui/imgui.h>
 
-#define MAX_LIGHTS 32
 #define MAX_SHADOWMAPS 16
 
 namespace Lumos
@@ -40,16 +41,19 @@ namespace Lumos
 	{
 		enum PSSystemUniformIndices : i32
 		{
-			PSSystemUniformIndex_Lights = 0,
-			PSSystemUniformIndex_CameraPosition,
+			PSSystemUniformIndex_CameraPosition = 0,
 			PSSystemUniformIndex_ViewMatrix, 
 			PSSystemUniformIndex_ShadowTransforms,
 			PSSystemUniformIndex_ShadowSplitDepths,
 			PSSystemUniformIndex_BiasMatrix, 
+			PSSystemUniformIndex_ClusterProjView,
+			PSSystemUniformIndex_ScreenToWorld,
+			PSSystemUniformIndex_ClusterParams,
 			PSSystemUniformIndex_LightCount,
 			PSSystemUniformIndex_ShadowCount,
 			PSSystemUniformIndex_RenderMode,
 			PSSystemUniformIndex_cubemapMipLevels,
+			PSSystemUniformIndex_DirectionalLightCount,
 			PSSystemUniformIndex_Size
 		};
 
@@ -65,6 +69,11 @@ namespace Lumos
 			delete m_Shader;
 			delete m_UniformBuffer;
 			delete m_LightUniformBuffer;
+			delete m_ClusterLightBuffer;
+			delete m_ClusterBuffer;
+			delete m_ClusterIndexBuffer;
+			lmdel m_ClusterGrid;
+			delete[] m_LightData;
 			delete m_RenderPass;
 			delete m_Pipeline;
 			delete m_ScreenQuad;
@@ -131,6 +140,9 @@ namespace Lumos
 			m_PreintegratedFG = Scope<Texture2D>(Texture2D::CreateFromFile("PreintegratedFG", "/CoreTextures/PreintegratedFG.tga", param));
 
 			m_LightUniformBuffer = nullptr;
+			m_ClusterLightBuffer = nullptr;
+			m_ClusterBuffer = nullptr;
+			m_ClusterIndexBuffer = nullptr;
 			m_UniformBuffer = nullptr;
 
 			m_ScreenQuad = Graphics::CreateQuad();
@@ -138,22 +150,28 @@ namespace Lumos
 			m_DescriptorSet = nullptr;
 			
 			// Pixel/fragment shader System uniforms
-			m_PSSystemUniformBufferSize = sizeof(Light) * MAX_LIGHTS + sizeof(Maths::Vector4) + sizeof(Maths::Matrix4) * 2 + (sizeof(Maths::Matrix4) + sizeof(Maths::Vector4)) * MAX_SHADOWMAPS + sizeof(int) * 4;
+			m_PSSystemUniformBufferSize = sizeof(Maths::Vector4) * 2 + sizeof(Maths::Matrix4) * 4 + (sizeof(Maths::Matrix4) + sizeof(Maths::Vector4)) * MAX_SHADOWMAPS + sizeof(int) * 8;
 			m_PSSystemUniformBuffer = lmnew u8[m_PSSystemUniformBufferSize];
 			memset(m_PSSystemUniformBuffer, 0, m_PSSystemUniformBufferSize);
 			m_PSSystemUniformBufferOffsets.resize(PSSystemUniformIndex_Size);
 
 			// Per Scene System Uniforms
-			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_Lights]				= 0;
-			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition]		= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_Lights] + sizeof(Light) * MAX_LIGHTS;
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition]		= 0;
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ViewMatrix]			= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition] + sizeof(Maths::Vector4);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowTransforms]	= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ViewMatrix] + sizeof(Maths::Matrix4);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowSplitDepths]	= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowTransforms] + sizeof(Maths::Matrix4) * MAX_SHADOWMAPS;
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_BiasMatrix]			= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowSplitDepths] + sizeof(Maths::Vector4) * MAX_SHADOWMAPS;
-			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_LightCount]			= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_BiasMatrix] + sizeof(Maths::Matrix4);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ClusterProjView]	= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_BiasMatrix] + sizeof(Maths::Matrix4);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ScreenToWorld]		= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ClusterProjView] + sizeof(Maths::Matrix4);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ClusterParams]		= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ScreenToWorld] + sizeof(Maths::Matrix4);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_LightCount]			= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ClusterParams] + sizeof(Maths::Vector4);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowCount]		= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_LightCount] + sizeof(int);
 			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_RenderMode]			= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ShadowCount] + sizeof(int);
             m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_cubemapMipLevels]	= m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_RenderMode] + sizeof(int);
+			m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_DirectionalLightCount] = m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_cubemapMipLevels] + sizeof(int);
+
+			m_LightData = lmnew Light[MAX_CLUSTERED_LIGHTS];
+			m_ClusterGrid = lmnew LightClusterGrid();
 
 			m_RenderPass = Graphics::RenderPass::Create();
 
@@ -301,30 +319,68 @@ namespace Lumos
             auto group = registry.group<Graphics::Light>(entt::get<Maths::Transform>);
 
             u32 numLights = 0;
+			u32 numDirectionalLights = 0;
 
 			auto& frustum = m_Camera->GetFrustum();
-			
-			for(auto entity : group)
+
+			// Directional lights go first and are applied everywhere, the rest are clustered
+			for (int pass = 0; pass < 2; pass++)
 			{
-				const auto &[light, trans] = group.get<Graphics::Light, Maths::Transform>(entity);
-                light.m_Position = trans.GetWorldPosition();
-            
-				if (light.m_Type != float(LightType::DirectionalLight))
-                {
-					auto inside = frustum.IsInsideFast(Maths::Sphere(light.m_Position.ToVector3(), light.m_Radius));
+				for (auto entity : group)
+				{
+					const auto &[light, trans] = group.get<Graphics::Light, Maths::Transform>(entity);
+					bool directional = light.m_Type == float(LightType::DirectionalLight);
 
-					if (inside == Maths::Intersection::OUTSIDE)
+					if (directional != (pass == 0))
 						continue;
+
+					if (numLights >= MAX_CLUSTERED_LIGHTS)
+						break;
+
+					light.m_Position = trans.GetWorldPosition();
+
+					if (!directional)
+					{
+						auto inside = frustum.IsInsideFast(Maths::Sphere(light.m_Position.ToVector3(), light.m_Radius));
+
+						if (inside == Maths::Intersection::OUTSIDE)
+							continue;
+					}
+
+					Maths::Vector3 forward = Maths::Vector3::FORWARD;
+					forward = trans.GetWorldOrientation() * forward;
+
+					light.m_Direction = forward.Normalized();
+
+					m_LightData[numLights++] = light;
+
+					if (directional)
+						numDirectionalLights++;
 				}
+			}
 
-				Maths::Vector3 forward = Maths::Vector3::FORWARD;
-				forward = trans.GetWorldOrientation() * forward;
+			m_LightCount = numLights;
 
-				light.m_Direction = forward.Normalized();
+			Maths::Matrix4 projView = m_Camera->GetProjectionMatrix() * m_Camera->GetViewMatrix();
+			Maths::Vector4 clusterParams = Maths::Vector4(0.0f, 0.0f, 0.0f, m_HeatmapScale);
+			m_ClusterIndexCount = 0;
 
-				memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_Lights] + sizeof(Graphics::Light) * numLights, &light, sizeof(Graphics::Light));
-				numLights++;
+			// Orthographic projections fall back to looping over every light
+			if (!m_Camera->IsOrthographic())
+			{
+				m_ClusterGrid->Build(m_LightData, numLights, numDirectionalLights, m_Camera->GetViewMatrix(), m_Camera->GetProjectionMatrix(), m_Camera->GetNear(), m_Camera->GetFar());
+				clusterParams.x = m_ClusterGrid->GetSliceParams().x;
+				clusterParams.y = m_ClusterGrid->GetSliceParams().y;
+				clusterParams.z = m_ClusterGrid->GetOverflowed() ? 0.0f : 1.0f;
+				m_ClusterIndexCount = m_ClusterGrid->GetIndexCount();
 			}
+
+			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ClusterProjView], &projView, sizeof(Maths::Matrix4));
+
+			Maths::Matrix4 screenToWorld = GBuffer::BuildScreenToWorld(projView);
+			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ScreenToWorld], &screenToWorld, sizeof(Maths::Matrix4));
+			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_ClusterParams], &clusterParams, sizeof(Maths::Vector4));
+			memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_DirectionalLightCount], &numDirectionalLights, sizeof(int));
             
             Maths::Vector4 cameraPos = Maths::Vector4(m_Camera->GetPosition());
             memcpy(m_PSSystemUniformBuffer + m_PSSystemUniformBufferOffsets[PSSystemUniformIndex_CameraPosition], &cameraPos, sizeof(Maths::Vector4));
@@ -367,6 +423,15 @@ namespace Lumos
 		void DeferredRenderer::SetSystemUniforms(Shader* shader) const
 		{
 			m_LightUniformBuffer->SetData(m_PSSystemUniformBufferSize, *&m_PSSystemUniformBuffer);
+
+			if (m_LightCount > 0)
+				m_ClusterLightBuffer->SetData(sizeof(Light) * m_LightCount, m_LightData);
+
+			m_ClusterBuffer->SetData(sizeof(u32) * CLUSTER_COUNT, m_ClusterGrid->GetClusterData());
+
+			// Indices are packed four to a word, round up to the std140 array stride
+			if (m_ClusterIndexCount > 0)
+				m_ClusterIndexBuffer->SetData((m_ClusterIndexCount + 15) & ~15, m_ClusterGrid->GetIndexData());
 		}
 
 		void DeferredRenderer::Present()
@@ -400,13 +465,15 @@ namespace Lumos
 				{ Graphics::DescriptorType::IMAGE_SAMPLER , 1 },
 				{ Graphics::DescriptorType::IMAGE_SAMPLER , 1 },
 				{ Graphics::DescriptorType::IMAGE_SAMPLER , 1 },
-				{ Graphics::DescriptorType::UNIFORM_BUFFER, 1 }
+				{ Graphics::DescriptorType::UNIFORM_BUFFER, 4 }
 			};
 
 			std::vector<Graphics::DescriptorLayoutInfo> layoutInfo =
 			{
 				{ Graphics::DescriptorType::UNIFORM_BUFFER, Graphics::ShaderType::FRAGMENT, 0 },
-
+				{ Graphics::DescriptorType::UNIFORM_BUFFER, Graphics::ShaderType::FRAGMENT, 1 },
+				{ Graphics::DescriptorType::UNIFORM_BUFFER, Graphics::ShaderType::FRAGMENT, 2 },
+				{ Graphics::DescriptorType::UNIFORM_BUFFER, Graphics::ShaderType::FRAGMENT, 3 },
 			};
 
 			std::vector<Graphics::DescriptorLayoutInfo> layoutInfoMesh =
@@ -495,6 +562,7 @@ namespace Lumos
 			case 5 : return "Emissive";
 			case 6 : return "Normal";
             case 7 : return "Shadow Cascades";
+			case 8 : return "Light Clusters";
 			default: return "Lighting";
 			}
 		}
@@ -523,7 +591,7 @@ namespace Lumos
 			ImGui::PushItemWidth(-1);
 			if (ImGui::BeginMenu(RenderModeToString(m_RenderMode).c_str()))
 			{
-                const int numRenderModes = 8;
+                const int numRenderModes = 9;
                 
                 for(int i = 0; i < numRenderModes; i++)
                 {
@@ -534,9 +602,31 @@ namespace Lumos
 			ImGui::PopItemWidth();
 			ImGui::NextColumn();
 
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Heatmap Scale");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::DragFloat("##HeatmapScale", &m_HeatmapScale, 1.0f, 1.0f, 256.0f);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Lights");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%u / %u", m_LightCount, MAX_CLUSTERED_LIGHTS);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
 			ImGui::Columns(1);
 			ImGui::Separator();
 			ImGui::PopStyleVar();
+
+			if (ImGui::TreeNode("Light Clusters"))
+			{
+				m_ClusterGrid->OnImGui();
+				ImGui::TreePop();
+			}
 		}
 
 		void DeferredRenderer::CreateFramebuffers()
@@ -596,6 +686,44 @@ namespace Lumos
 
 			bufferInfos.push_back(bufferInfo);
 
+			if (m_ClusterLightBuffer == nullptr)
+			{
+				m_ClusterLightBuffer = Graphics::UniformBuffer::Create();
+				m_ClusterLightBuffer->Init(sizeof(Light) * MAX_CLUSTERED_LIGHTS, nullptr);
+
+				m_ClusterBuffer = Graphics::UniformBuffer::Create();
+				m_ClusterBuffer->Init(sizeof(u32) * CLUSTER_COUNT, nullptr);
+
+				m_ClusterIndexBuffer = Graphics::UniformBuffer::Create();
+				m_ClusterIndexBuffer->Init(MAX_CLUSTER_LIGHT_INDICES, nullptr);
+			}
+
+			Graphics::BufferInfo lightsBufferInfo = {};
+			lightsBufferInfo.name = "UniformBufferClusterLights";
+			lightsBufferInfo.buffer = m_ClusterLightBuffer;
+			lightsBufferInfo.offset = 0;
+			lightsBufferInfo.size = sizeof(Light) * MAX_CLUSTERED_LIGHTS;
+			lightsBufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
+			lightsBufferInfo.binding = 1;
+			lightsBufferInfo.shaderType = ShaderType::FRAGMENT;
+			lightsBufferInfo.systemUniforms = false;
+
+			Graphics::BufferInfo clusterBufferInfo = lightsBufferInfo;
+			clusterBufferInfo.name = "UniformBufferClusters";
+			clusterBufferInfo.buffer = m_ClusterBuffer;
+			clusterBufferInfo.size = sizeof(u32) * CLUSTER_COUNT;
+			clusterBufferInfo.binding = 2;
+
+			Graphics::BufferInfo indexBufferInfo = lightsBufferInfo;
+			indexBufferInfo.name = "UniformBufferClusterIndices";
+			indexBufferInfo.buffer = m_ClusterIndexBuffer;
+			indexBufferInfo.size = MAX_CLUSTER_LIGHT_INDICES;
+			indexBufferInfo.binding = 3;
+
+			bufferInfos.push_back(lightsBufferInfo);
+			bufferInfos.push_back(clusterBufferInfo);
+			bufferInfos.push_back(indexBufferInfo);
+
 			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 		}
 
@@ -630,9 +758,10 @@ namespace Lumos
 			imageInfo.name = "uColourSampler";
 
 			Graphics::ImageInfo imageInfo2 = {};
-			imageInfo2.texture = { Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_POSITION) };
+			imageInfo2.texture = { Application::Instance()->GetRenderManager()->GetGBuffer()->GetDepthTexture() };
 			imageInfo2.binding = 1;
-			imageInfo2.name = "uPositionSampler";
+			imageInfo2.type = TextureType::DEPTH;
+			imageInfo2.name = "uDepthSampler";
 
 			Graphics::ImageInfo imageInfo3 = {};
 			imageInfo3.texture = { Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_NORMALS) };
@@ -671,12 +800,6 @@ namespace Lumos
 				imageInfo8.name = "uShadowMap";
 			}
 
-			Graphics::ImageInfo imageInfo9 = {};
-			imageInfo9.texture = { Application::Instance()->GetRenderManager()->GetGBuffer()->GetDepthTexture() };
-			imageInfo9.binding = 8;
-			imageInfo9.type = TextureType::DEPTH;
-			imageInfo9.name = "uDepthSampler";
-
 			bufferInfos.push_back(imageInfo);
 			bufferInfos.push_back(imageInfo2);
 			bufferInfos.push_back(imageInfo3);
@@ -18,6 +18,8 @@ namespace Lumos
 		class ShadowRenderer;
 		class Framebuffer;
 		class DeferredOffScreenRenderer;
+		class LightClusterGrid;
+		struct Light;
 
 		class LUMOS_EXPORT DeferredRenderer : public Renderer3D
 		{
@@ -69,6 +71,15 @@ namespace Lumos
 
 			UniformBuffer* m_UniformBuffer;
 			UniformBuffer* m_LightUniformBuffer;
+			UniformBuffer* m_ClusterLightBuffer;
+			UniformBuffer* m_ClusterBuffer;
+			UniformBuffer* m_ClusterIndexBuffer;
+
+			LightClusterGrid* m_ClusterGrid;
+			Light* m_LightData;
+			u32 m_LightCount = 0;
+			u32 m_ClusterIndexCount = 0;
+			float m_HeatmapScale = 32.0f;
 
 			std::vector<Framebuffer*> m_Framebuffers;
 			std::vector<CommandBuffer*> m_CommandBuffers;
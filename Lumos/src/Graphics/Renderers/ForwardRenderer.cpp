@@ -23,6 +23,7 @@
 
 #include "App/Application.h"
 #include "Graphics/RenderManager.h"
+#include "Graphics/Renderers/OcclusionCuller.h"
 #include "Graphics/Camera/Camera.h"
 
 namespace Lumos
@@ -74,6 +75,7 @@ namespace Lumos
                 auto& registry = scene->GetRegistry();
                 
                 auto group = registry.group<MeshComponent>(entt::get<Maths::Transform>);
+                auto occlusionCuller = Application::Instance()->GetRenderManager()->GetOcclusionCuller();
 
                 for(auto entity : group)
                 {
@@ -90,6 +92,9 @@ namespace Lumos
 						if (inside == Maths::Intersection::OUTSIDE)
 							continue;
 
+						if (!occlusionCuller->IsVisible(scene, entity))
+							continue;
+
                         auto meshPtr = mesh.GetMesh();
                         auto materialComponent = registry.try_get<MaterialComponent>(entity);
                         Material* material = nullptr;
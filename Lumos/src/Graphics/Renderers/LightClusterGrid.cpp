@@ -0,0 +1,223 @@
+#include "lmpch.h"
+#include "LightClusterGrid.h"
+#include "Graphics/Light.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Utilities/Timer.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		LightClusterGrid::LightClusterGrid()
+		{
+			memset(m_ClusterData, 0, sizeof(m_ClusterData));
+			memset(m_ClusterCounts, 0, sizeof(m_ClusterCounts));
+			memset(m_IndexData, 0, sizeof(m_IndexData));
+
+			m_LightBounds.reserve(MAX_CLUSTERED_LIGHTS);
+		}
+
+		void LightClusterGrid::UpdateClusterBounds(float p00, float p11, float zNear, float zFar)
+		{
+			m_P00 = p00;
+			m_P11 = p11;
+			m_Near = zNear;
+			m_Far = zFar;
+
+			const float logRatio = log(zFar / zNear);
+			m_SliceParams.x = float(CLUSTER_GRID_Z) / logRatio;
+			m_SliceParams.y = -float(CLUSTER_GRID_Z) * log(zNear) / logRatio;
+
+			for (u32 z = 0; z < CLUSTER_GRID_Z; z++)
+			{
+				float sliceNear = zNear * pow(zFar / zNear, float(z) / float(CLUSTER_GRID_Z));
+				float sliceFar  = zNear * pow(zFar / zNear, float(z + 1) / float(CLUSTER_GRID_Z));
+
+				for (u32 y = 0; y < CLUSTER_GRID_Y; y++)
+				{
+					float ndcY0 = float(y) / float(CLUSTER_GRID_Y) * 2.0f - 1.0f;
+					float ndcY1 = float(y + 1) / float(CLUSTER_GRID_Y) * 2.0f - 1.0f;
+
+					for (u32 x = 0; x < CLUSTER_GRID_X; x++)
+					{
+						float ndcX0 = float(x) / float(CLUSTER_GRID_X) * 2.0f - 1.0f;
+						float ndcX1 = float(x + 1) / float(CLUSTER_GRID_X) * 2.0f - 1.0f;
+
+						// Tile corners at both slice depths, ndc = view * P / depth
+						float xs[4] = { ndcX0 * sliceNear / p00, ndcX1 * sliceNear / p00, ndcX0 * sliceFar / p00, ndcX1 * sliceFar / p00 };
+						float ys[4] = { ndcY0 * sliceNear / p11, ndcY1 * sliceNear / p11, ndcY0 * sliceFar / p11, ndcY1 * sliceFar / p11 };
+
+						auto& bounds = m_ClusterBounds[x + y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y];
+						bounds.min = Maths::Vector3(Maths::Min(Maths::Min(xs[0], xs[1]), Maths::Min(xs[2], xs[3])), Maths::Min(Maths::Min(ys[0], ys[1]), Maths::Min(ys[2], ys[3])), sliceNear);
+						bounds.max = Maths::Vector3(Maths::Max(Maths::Max(xs[0], xs[1]), Maths::Max(xs[2], xs[3])), Maths::Max(Maths::Max(ys[0], ys[1]), Maths::Max(ys[2], ys[3])), sliceFar);
+					}
+				}
+			}
+		}
+
+		static u32 NDCToTile(float ndc, u32 tileCount)
+		{
+			float tile = (ndc * 0.5f + 0.5f) * float(tileCount);
+			return static_cast<u32>(Maths::Clamp(tile, 0.0f, float(tileCount - 1)));
+		}
+
+		void LightClusterGrid::Build(const Light* lights, u32 lightCount, u32 firstLocalLight, const Maths::Matrix4& view, const Maths::Matrix4& proj, float zNear, float zFar)
+		{
+			LUMOS_PROFILE_FUNC;
+			Timer timer;
+
+			// Depth along the view direction, independent of handedness
+			const float depthScale = proj.m32_;
+			const float p00 = proj.m00_;
+			const float p11 = proj.m11_;
+
+			if (p00 != m_P00 || p11 != m_P11 || zNear != m_Near || zFar != m_Far)
+				UpdateClusterBounds(p00, p11, zNear, zFar);
+
+			m_LightBounds.clear();
+
+			for (u32 i = firstLocalLight; i < lightCount; i++)
+			{
+				const Light& light = lights[i];
+				Maths::Vector4 viewPos = view * Maths::Vector4(light.m_Position.x, light.m_Position.y, light.m_Position.z, 1.0f);
+
+				LightBounds bounds;
+				bounds.centre = Maths::Vector3(viewPos.x, viewPos.y, viewPos.z * depthScale);
+				bounds.radius = light.m_Radius;
+				bounds.index = i;
+
+				float minDepth = bounds.centre.z - bounds.radius;
+				float maxDepth = bounds.centre.z + bounds.radius;
+
+				if (maxDepth < zNear || minDepth > zFar)
+					continue;
+
+				bounds.minTile[2] = minDepth <= zNear ? 0 : static_cast<u32>(Maths::Clamp(log(minDepth) * m_SliceParams.x + m_SliceParams.y, 0.0f, float(CLUSTER_GRID_Z - 1)));
+				bounds.maxTile[2] = static_cast<u32>(Maths::Clamp(log(Maths::Min(maxDepth, zFar)) * m_SliceParams.x + m_SliceParams.y, 0.0f, float(CLUSTER_GRID_Z - 1)));
+
+				if (minDepth <= zNear)
+				{
+					// Sphere crosses the near plane so its projection is unbounded
+					bounds.minTile[0] = 0;
+					bounds.minTile[1] = 0;
+					bounds.maxTile[0] = CLUSTER_GRID_X - 1;
+					bounds.maxTile[1] = CLUSTER_GRID_Y - 1;
+				}
+				else
+				{
+					float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+
+					for (u32 c = 0; c < 8; c++)
+					{
+						float x = bounds.centre.x + ((c & 1) ? bounds.radius : -bounds.radius);
+						float y = bounds.centre.y + ((c & 2) ? bounds.radius : -bounds.radius);
+						float depth = (c & 4) ? maxDepth : minDepth;
+
+						float ndcX = x * p00 / depth;
+						float ndcY = y * p11 / depth;
+
+						minX = Maths::Min(minX, ndcX);
+						maxX = Maths::Max(maxX, ndcX);
+						minY = Maths::Min(minY, ndcY);
+						maxY = Maths::Max(maxY, ndcY);
+					}
+
+					if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+						continue;
+
+					bounds.minTile[0] = NDCToTile(minX, CLUSTER_GRID_X);
+					bounds.maxTile[0] = NDCToTile(maxX, CLUSTER_GRID_X);
+					bounds.minTile[1] = NDCToTile(minY, CLUSTER_GRID_Y);
+					bounds.maxTile[1] = NDCToTile(maxY, CLUSTER_GRID_Y);
+				}
+
+				m_LightBounds.push_back(bounds);
+			}
+
+			// Each slice is built independently into its own list, then the lists are concatenated
+			System::JobSystem::Dispatch(CLUSTER_GRID_Z, 1, [&](JobDispatchArgs args)
+			{
+				u32 z = args.jobIndex;
+				auto& sliceIndices = m_SliceIndices[z];
+				sliceIndices.clear();
+
+				for (u32 y = 0; y < CLUSTER_GRID_Y; y++)
+				{
+					for (u32 x = 0; x < CLUSTER_GRID_X; x++)
+					{
+						u32 clusterIndex = x + y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+						auto& cluster = m_ClusterBounds[clusterIndex];
+						u32 count = 0;
+
+						for (auto& light : m_LightBounds)
+						{
+							if (z < light.minTile[2] || z > light.maxTile[2] || y < light.minTile[1] || y > light.maxTile[1] || x < light.minTile[0] || x > light.maxTile[0])
+								continue;
+
+							// Sphere vs cluster AABB
+							Maths::Vector3 closest = Maths::Vector3(
+								Maths::Clamp(light.centre.x, cluster.min.x, cluster.max.x),
+								Maths::Clamp(light.centre.y, cluster.min.y, cluster.max.y),
+								Maths::Clamp(light.centre.z, cluster.min.z, cluster.max.z));
+
+							if ((closest - light.centre).LengthSquared() > light.radius * light.radius)
+								continue;
+
+							sliceIndices.push_back(static_cast<u8>(light.index));
+							count++;
+						}
+
+						m_ClusterCounts[clusterIndex] = static_cast<u16>(count);
+					}
+				}
+			});
+
+			System::JobSystem::Wait();
+
+			m_IndexCount = 0;
+			m_MaxLightsPerCluster = 0;
+			m_Overflowed = false;
+
+			for (u32 z = 0; z < CLUSTER_GRID_Z; z++)
+			{
+				u32 sliceOffset = 0;
+				auto& sliceIndices = m_SliceIndices[z];
+
+				for (u32 tile = 0; tile < CLUSTER_GRID_X * CLUSTER_GRID_Y; tile++)
+				{
+					u32 clusterIndex = tile + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+					u32 count = m_ClusterCounts[clusterIndex];
+
+					if (m_IndexCount + count > MAX_CLUSTER_LIGHT_INDICES)
+					{
+						m_Overflowed = true;
+						count = MAX_CLUSTER_LIGHT_INDICES - m_IndexCount;
+					}
+
+					if (count > 0)
+						memcpy(m_IndexData + m_IndexCount, sliceIndices.data() + sliceOffset, count);
+
+					m_ClusterData[clusterIndex] = m_IndexCount | (count << 16);
+					m_MaxLightsPerCluster = Maths::Max(m_MaxLightsPerCluster, count);
+
+					m_IndexCount += count;
+					sliceOffset += m_ClusterCounts[clusterIndex];
+				}
+			}
+
+			m_BuildTime = timer.GetMS(1000.0f);
+		}
+
+		void LightClusterGrid::OnImGui()
+		{
+			ImGui::Text("Grid : %u x %u x %u", CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z);
+			ImGui::Text("Visible Local Lights : %u", static_cast<u32>(m_LightBounds.size()));
+			ImGui::Text("Light Indices : %u / %u%s", m_IndexCount, MAX_CLUSTER_LIGHT_INDICES, m_Overflowed ? " (overflow)" : "");
+			ImGui::Text("Max Lights Per Cluster : %u", m_MaxLightsPerCluster);
+			ImGui::Text("Build Time : %.3f ms", m_BuildTime);
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "lmpch.h"
+#include "Maths/Maths.h"
+
+// Must match DeferredLight.frag
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+#define MAX_CLUSTERED_LIGHTS 256
+#define MAX_CLUSTER_LIGHT_INDICES 16384
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		struct Light;
+
+		// Froxel grid over the view frustum (screen tiles x exponential depth slices).
+		// Each cluster stores an offset/count pair into a compact list of light indices,
+		// packed as (offset | count << 16) and u8 indices so both fit in uniform buffers.
+		class LUMOS_EXPORT LightClusterGrid
+		{
+		public:
+			LightClusterGrid();
+			~LightClusterGrid() = default;
+
+			// Lights before firstLocalLight (directional) are skipped, they affect every cluster
+			void Build(const Light* lights, u32 lightCount, u32 firstLocalLight, const Maths::Matrix4& view, const Maths::Matrix4& proj, float zNear, float zFar);
+
+			const u32* GetClusterData() const { return m_ClusterData; }
+			const u8* GetIndexData() const { return m_IndexData; }
+
+			// x : slice scale, y : slice bias for slice = log(depth) * x + y
+			const Maths::Vector4& GetSliceParams() const { return m_SliceParams; }
+
+			u32 GetIndexCount() const { return m_IndexCount; }
+			u32 GetMaxLightsPerCluster() const { return m_MaxLightsPerCluster; }
+			bool GetOverflowed() const { return m_Overflowed; }
+			float GetBuildTime() const { return m_BuildTime; }
+
+			void OnImGui();
+
+		private:
+			struct ClusterBounds
+			{
+				Maths::Vector3 min;
+				Maths::Vector3 max;
+			};
+
+			struct LightBounds
+			{
+				Maths::Vector3 centre;
+				float radius;
+				u32 index;
+				u32 minTile[3];
+				u32 maxTile[3];
+			};
+
+			void UpdateClusterBounds(float p00, float p11, float zNear, float zFar);
+
+			ClusterBounds m_ClusterBounds[CLUSTER_COUNT];
+			u32 m_ClusterData[CLUSTER_COUNT];
+			u16 m_ClusterCounts[CLUSTER_COUNT];
+			u8 m_IndexData[MAX_CLUSTER_LIGHT_INDICES];
+			std::vector<u8> m_SliceIndices[CLUSTER_GRID_Z];
+			std::vector<LightBounds> m_LightBounds;
+
+			Maths::Vector4 m_SliceParams;
+			float m_P00 = 0.0f;
+			float m_P11 = 0.0f;
+			float m_Near = 0.0f;
+			float m_Far = 0.0f;
+
+			u32 m_IndexCount = 0;
+			u32 m_MaxLightsPerCluster = 0;
+			bool m_Overflowed = false;
+			float m_BuildTime = 0.0f;
+		};
+	}
+}
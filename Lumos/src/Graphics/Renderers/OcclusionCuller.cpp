@@ -0,0 +1,468 @@
+#include "lmpch.h"
+#include "OcclusionCuller.h"
+#include "App/Scene.h"
+#include "Graphics/Camera/Camera.h"
+#include "Graphics/Mesh.h"
+#include "ECS/Component/MeshComponent.h"
+#include "ECS/Component/OccluderComponent.h"
+#include "Maths/Transform.h"
+#include "Core/Profiler.h"
+#include "Utilities/Timer.h"
+
+#include <imgui/imgui.h>
+
+#ifdef LUMOS_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		namespace
+		{
+			struct ClipVertex
+			{
+				float x;
+				float y;
+				float w;
+				bool outline; // Edge from this vertex to the next
+			};
+
+			// Sutherland-Hodgman against w >= zNear, a triangle comes out as up to four vertices.
+			// The edge cut along the near plane is an outline edge.
+			u32 ClipNear(const ClipVertex* in, float zNear, ClipVertex* out)
+			{
+				u32 count = 0;
+				for (u32 i = 0; i < 3; i++)
+				{
+					const ClipVertex& a = in[i];
+					const ClipVertex& b = in[(i + 1) % 3];
+					const bool aInside = a.w >= zNear;
+					const bool bInside = b.w >= zNear;
+
+					if (aInside)
+						out[count++] = a;
+
+					if (aInside != bInside)
+					{
+						const float t = (zNear - a.w) / (b.w - a.w);
+						out[count++] = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, zNear, aInside ? true : a.outline };
+					}
+				}
+
+				return count;
+			}
+
+			// Orientation of a triangle in homogeneous clip space, valid even when it crosses w = 0
+			float Facing(const Maths::Vector4& a, const Maths::Vector4& b, const Maths::Vector4& c)
+			{
+				return a.x * (b.y * c.w - b.w * c.y) - a.y * (b.x * c.w - b.w * c.x) + a.w * (b.x * c.y - b.y * c.x);
+			}
+		}
+
+		OcclusionCuller::OcclusionCuller(u32 width, u32 height)
+		{
+			Resize(width, height);
+		}
+
+		OcclusionCuller::~OcclusionCuller()
+		{
+			System::JobSystem::Wait(m_Context);
+		}
+
+		void OcclusionCuller::Resize(u32 width, u32 height)
+		{
+			m_Width = Maths::Max(width, 4u);
+			m_Height = Maths::Max(height, 4u);
+			m_Levels.clear();
+
+			u32 levelWidth = m_Width;
+			u32 levelHeight = m_Height;
+			while (true)
+			{
+				DepthLevel level;
+				level.width = levelWidth;
+				level.height = levelHeight;
+
+				// Rows padded to whole SSE registers, the rasteriser writes four pixels at a time
+				level.stride = (levelWidth + 3) & ~3u;
+				level.depth.assign(level.stride * levelHeight, 0.0f);
+				m_Levels.push_back(std::move(level));
+
+				if (levelWidth == 1 && levelHeight == 1)
+					break;
+
+				levelWidth = (levelWidth + 1) / 2;
+				levelHeight = (levelHeight + 1) / 2;
+			}
+
+			m_Scene = nullptr;
+		}
+
+		void OcclusionCuller::BeginFrame(const Maths::Matrix4& viewProjection, float zNear)
+		{
+			m_ViewProjection = viewProjection;
+			m_Near = Maths::Max(zNear, 1e-4f);
+			m_OccluderCount = 0;
+			m_OccluderTriangleCount = 0;
+
+			std::fill(m_Levels[0].depth.begin(), m_Levels[0].depth.end(), 0.0f);
+		}
+
+		void OcclusionCuller::RasteriseOccluder(const Maths::Vector3* positions, const u32* indices, u32 indexCount, const u32* adjacency, const Maths::Matrix4& transform)
+		{
+			const Maths::Matrix4 worldViewProjection = m_ViewProjection * transform;
+			const float halfWidth = 0.5f * static_cast<float>(m_Width);
+			const float halfHeight = 0.5f * static_cast<float>(m_Height);
+			const u32 triangleCount = indexCount / 3;
+
+			// An edge is on the outline when it's open or its two triangles face opposite ways
+			if (adjacency)
+			{
+				m_Facing.resize(triangleCount);
+				for (u32 triangle = 0; triangle < triangleCount; triangle++)
+				{
+					const u32* triangleIndices = indices + triangle * 3;
+					m_Facing[triangle] = Facing(worldViewProjection * Maths::Vector4(positions[triangleIndices[0]], 1.0f),
+						worldViewProjection * Maths::Vector4(positions[triangleIndices[1]], 1.0f),
+						worldViewProjection * Maths::Vector4(positions[triangleIndices[2]], 1.0f));
+				}
+			}
+
+			for (u32 triangle = 0; triangle < triangleCount; triangle++)
+			{
+				const u32 i = triangle * 3;
+				ClipVertex clip[3];
+				for (u32 k = 0; k < 3; k++)
+				{
+					const Maths::Vector4 v = worldViewProjection * Maths::Vector4(positions[indices[i + k]], 1.0f);
+					bool outline = true;
+					if (adjacency && adjacency[i + k] != ~0u)
+						outline = (m_Facing[triangle] > 0.0f) != (m_Facing[adjacency[i + k]] > 0.0f) || m_Facing[adjacency[i + k]] == 0.0f;
+
+					clip[k] = { v.x, v.y, v.w, outline };
+				}
+
+				// Wholly off one side of the screen
+				if ((clip[0].x > clip[0].w && clip[1].x > clip[1].w && clip[2].x > clip[2].w) ||
+					(clip[0].x < -clip[0].w && clip[1].x < -clip[1].w && clip[2].x < -clip[2].w) ||
+					(clip[0].y > clip[0].w && clip[1].y > clip[1].w && clip[2].y > clip[2].w) ||
+					(clip[0].y < -clip[0].w && clip[1].y < -clip[1].w && clip[2].y < -clip[2].w))
+					continue;
+
+				ClipVertex clipped[4];
+				const u32 count = ClipNear(clip, m_Near, clipped);
+				if (count < 3)
+					continue;
+
+				ScreenVertex screen[4];
+				for (u32 k = 0; k < count; k++)
+				{
+					const float invW = 1.0f / clipped[k].w;
+					screen[k] = { (clipped[k].x * invW + 1.0f) * halfWidth, (clipped[k].y * invW + 1.0f) * halfHeight, invW };
+				}
+
+				// Fanned, the diagonals are inside the polygon
+				for (u32 k = 2; k < count; k++)
+				{
+					const u32 outline = (k == 2 && clipped[0].outline ? 1u : 0u) | (clipped[k - 1].outline ? 2u : 0u) | (k == count - 1 && clipped[k].outline ? 4u : 0u);
+					RasteriseTriangle(screen[0], screen[k - 1], screen[k], outline);
+				}
+
+				m_OccluderTriangleCount++;
+			}
+		}
+
+		void OcclusionCuller::RasteriseTriangle(const ScreenVertex& v0, const ScreenVertex& in1, const ScreenVertex& in2, u32 outlineEdges)
+		{
+			float area = (in1.x - v0.x) * (in2.y - v0.y) - (in1.y - v0.y) * (in2.x - v0.x);
+			if (Maths::Abs(area) < 1e-6f)
+				return;
+
+			// Occluders are double sided, wind everything the same way
+			const bool flip = area < 0.0f;
+			const ScreenVertex& v1 = flip ? in2 : in1;
+			const ScreenVertex& v2 = flip ? in1 : in2;
+			if (flip)
+				outlineEdges = ((outlineEdges & 1) << 2) | (outlineEdges & 2) | ((outlineEdges & 4) >> 2);
+			area = Maths::Abs(area);
+
+			const int minX = Maths::Max(0, static_cast<int>(floorf(Maths::Min(v0.x, Maths::Min(v1.x, v2.x)))));
+			const int maxX = Maths::Min(static_cast<int>(m_Width) - 1, static_cast<int>(ceilf(Maths::Max(v0.x, Maths::Max(v1.x, v2.x)))));
+			const int minY = Maths::Max(0, static_cast<int>(floorf(Maths::Min(v0.y, Maths::Min(v1.y, v2.y)))));
+			const int maxY = Maths::Min(static_cast<int>(m_Height) - 1, static_cast<int>(ceilf(Maths::Max(v0.y, Maths::Max(v1.y, v2.y)))));
+			if (minX > maxX || minY > maxY)
+				return;
+
+			// Edge functions e = a * x + b * y + c, positive inside. e12 weights v0, e20 weights v1 and e01 weights v2.
+			const float a01 = v0.y - v1.y, b01 = v1.x - v0.x, c01 = -(a01 * v0.x + b01 * v0.y);
+			const float a12 = v1.y - v2.y, b12 = v2.x - v1.x, c12 = -(a12 * v1.x + b12 * v1.y);
+			const float a20 = v2.y - v0.y, b20 = v0.x - v2.x, c20 = -(a20 * v2.x + b20 * v2.y);
+
+			// 1 / w is linear in screen space, as a plane z = za * x + zb * y + zc
+			const float invArea = 1.0f / area;
+			const float z1 = (v1.invW - v0.invW) * invArea;
+			const float z2 = (v2.invW - v0.invW) * invArea;
+			const float za = z1 * a20 + z2 * a01;
+			const float zb = z1 * b20 + z2 * b01;
+
+			// Evaluated at pixel centres, so outline edges move in by half a pixel to only keep pixels the
+			// triangle covers whole, and depth takes the farthest value over the pixel. Otherwise a gap
+			// thinner than a pixel between two occluders would hide whatever shows through it.
+			const float zc = v0.invW + z1 * c20 + z2 * c01 - 0.5f * (Maths::Abs(za) + Maths::Abs(zb));
+			const float inset01 = (outlineEdges & 1) ? 0.5f * (Maths::Abs(a01) + Maths::Abs(b01)) : 0.0f;
+			const float inset12 = (outlineEdges & 2) ? 0.5f * (Maths::Abs(a12) + Maths::Abs(b12)) : 0.0f;
+			const float inset20 = (outlineEdges & 4) ? 0.5f * (Maths::Abs(a20) + Maths::Abs(b20)) : 0.0f;
+
+			DepthLevel& level = m_Levels[0];
+
+#ifdef LUMOS_SSE
+			const int startX = minX & ~3;
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+			const __m128 a01v = _mm_set1_ps(a01), a12v = _mm_set1_ps(a12), a20v = _mm_set1_ps(a20), zav = _mm_set1_ps(za);
+
+			for (int y = minY; y <= maxY; y++)
+			{
+				const float py = static_cast<float>(y) + 0.5f;
+				const __m128 row01 = _mm_set1_ps(b01 * py + c01 - inset01);
+				const __m128 row12 = _mm_set1_ps(b12 * py + c12 - inset12);
+				const __m128 row20 = _mm_set1_ps(b20 * py + c20 - inset20);
+				const __m128 rowZ = _mm_set1_ps(zb * py + zc);
+				float* row = level.depth.data() + y * level.stride;
+
+				for (int x = startX; x <= maxX; x += 4)
+				{
+					const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+					const __m128 e01 = _mm_add_ps(_mm_mul_ps(a01v, px), row01);
+					const __m128 e12 = _mm_add_ps(_mm_mul_ps(a12v, px), row12);
+					const __m128 e20 = _mm_add_ps(_mm_mul_ps(a20v, px), row20);
+					const __m128 inside = _mm_and_ps(_mm_cmpge_ps(e01, zero), _mm_and_ps(_mm_cmpge_ps(e12, zero), _mm_cmpge_ps(e20, zero)));
+					if (_mm_movemask_ps(inside) == 0)
+						continue;
+
+					const __m128 depth = _mm_add_ps(_mm_mul_ps(zav, px), rowZ);
+					const __m128 previous = _mm_loadu_ps(row + x);
+					const __m128 nearest = _mm_max_ps(previous, depth);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+				}
+			}
+#else
+			for (int y = minY; y <= maxY; y++)
+			{
+				const float py = static_cast<float>(y) + 0.5f;
+				float* row = level.depth.data() + y * level.stride;
+
+				for (int x = minX; x <= maxX; x++)
+				{
+					const float px = static_cast<float>(x) + 0.5f;
+					if (a01 * px + b01 * py + c01 < inset01 || a12 * px + b12 * py + c12 < inset12 || a20 * px + b20 * py + c20 < inset20)
+						continue;
+
+					row[x] = Maths::Max(row[x], za * px + zb * py + zc);
+				}
+			}
+#endif
+		}
+
+		void OcclusionCuller::BuildHiZ()
+		{
+			LUMOS_PROFILE_FUNC;
+
+			// Each texel keeps the farthest depth of the four below it, odd edges fold the last texel in
+			for (size_t i = 1; i < m_Levels.size(); i++)
+			{
+				const DepthLevel& source = m_Levels[i - 1];
+				DepthLevel& target = m_Levels[i];
+
+				for (u32 y = 0; y < target.height; y++)
+				{
+					const float* row0 = source.depth.data() + (2 * y) * source.stride;
+					const float* row1 = source.depth.data() + Maths::Min(2 * y + 1, source.height - 1) * source.stride;
+					float* out = target.depth.data() + y * target.stride;
+					u32 x = 0;
+
+#ifdef LUMOS_SSE
+					for (; 2 * x + 8 <= source.width; x += 4)
+					{
+						const __m128 m0 = _mm_min_ps(_mm_loadu_ps(row0 + 2 * x), _mm_loadu_ps(row1 + 2 * x));
+						const __m128 m1 = _mm_min_ps(_mm_loadu_ps(row0 + 2 * x + 4), _mm_loadu_ps(row1 + 2 * x + 4));
+						_mm_storeu_ps(out + x, _mm_min_ps(_mm_shuffle_ps(m0, m1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(3, 1, 3, 1))));
+					}
+#endif
+					for (; x < target.width; x++)
+					{
+						const u32 x0 = 2 * x;
+						const u32 x1 = Maths::Min(x0 + 1, source.width - 1);
+						out[x] = Maths::Min(Maths::Min(row0[x0], row0[x1]), Maths::Min(row1[x0], row1[x1]));
+					}
+				}
+			}
+		}
+
+		bool OcclusionCuller::IsVisible(const Maths::BoundingBox& worldBox) const
+		{
+			const float halfWidth = 0.5f * static_cast<float>(m_Width);
+			const float halfHeight = 0.5f * static_cast<float>(m_Height);
+
+			float minX = Maths::M_INFINITY, minY = Maths::M_INFINITY, maxX = -Maths::M_INFINITY, maxY = -Maths::M_INFINITY;
+			float nearestW = Maths::M_INFINITY;
+
+			for (u32 i = 0; i < 8; i++)
+			{
+				const Maths::Vector3 corner((i & 1) ? worldBox.max_.x : worldBox.min_.x, (i & 2) ? worldBox.max_.y : worldBox.min_.y, (i & 4) ? worldBox.max_.z : worldBox.min_.z);
+				const Maths::Vector4 clip = m_ViewProjection * Maths::Vector4(corner, 1.0f);
+				if (clip.w < m_Near)
+					return true;
+
+				const float invW = 1.0f / clip.w;
+				const float x = (clip.x * invW + 1.0f) * halfWidth;
+				const float y = (clip.y * invW + 1.0f) * halfHeight;
+				minX = Maths::Min(minX, x);
+				maxX = Maths::Max(maxX, x);
+				minY = Maths::Min(minY, y);
+				maxY = Maths::Max(maxY, y);
+				nearestW = Maths::Min(nearestW, clip.w);
+			}
+
+			if (maxX < 0.0f || maxY < 0.0f || minX > static_cast<float>(m_Width) || minY > static_cast<float>(m_Height))
+				return true;
+
+			int x0 = Maths::Max(0, static_cast<int>(floorf(minX)));
+			int y0 = Maths::Max(0, static_cast<int>(floorf(minY)));
+			int x1 = Maths::Min(static_cast<int>(m_Width) - 1, static_cast<int>(floorf(maxX)));
+			int y1 = Maths::Min(static_cast<int>(m_Height) - 1, static_cast<int>(floorf(maxY)));
+
+			// Coarsest level where the rectangle spans at most 4 x 4 texels
+			u32 levelIndex = 0;
+			while (levelIndex + 1 < m_Levels.size() && (x1 - x0 > 3 || y1 - y0 > 3))
+			{
+				x0 >>= 1;
+				y0 >>= 1;
+				x1 >>= 1;
+				y1 >>= 1;
+				levelIndex++;
+			}
+
+			const DepthLevel& level = m_Levels[levelIndex];
+			float farthest = Maths::M_INFINITY;
+			for (int y = y0; y <= y1; y++)
+			{
+				const float* row = level.depth.data() + y * level.stride;
+				for (int x = x0; x <= x1; x++)
+					farthest = Maths::Min(farthest, row[x]);
+			}
+
+			return 1.0f / nearestW >= farthest;
+		}
+
+		void OcclusionCuller::Build(Scene* scene)
+		{
+			LUMOS_PROFILE_FUNC;
+
+			m_Scene = nullptr;
+			m_OccluderCount = 0;
+			m_OccluderTriangleCount = 0;
+			m_TestedCount = 0;
+			m_OccludedCount = 0;
+
+			if (!m_Enabled || !scene)
+				return;
+
+			auto& registry = scene->GetRegistry();
+			auto cameraView = registry.view<Camera>();
+			if (cameraView.empty())
+				return;
+
+			Camera& camera = registry.get<Camera>(cameraView.front());
+			const Maths::Frustum& frustum = camera.GetFrustum();
+
+			Timer timer;
+			BeginFrame(camera.GetProjectionMatrix() * camera.GetViewMatrix(), camera.GetNear());
+
+			auto occluders = registry.view<OccluderComponent, Maths::Transform>();
+			for (auto entity : occluders)
+			{
+				auto& occluder = occluders.get<OccluderComponent>(entity);
+				if (!occluder.GetActive() || occluder.GetTriangleCount() == 0)
+					continue;
+
+				auto& transform = occluders.get<Maths::Transform>(entity).GetWorldMatrix();
+				if (frustum.IsInsideFast(occluder.GetBoundingBox().Transformed(transform)) == Maths::Intersection::OUTSIDE)
+					continue;
+
+				RasteriseOccluder(occluder.GetPositions().data(), occluder.GetIndices().data(), static_cast<u32>(occluder.GetIndices().size()), occluder.GetAdjacency().data(), transform);
+				m_OccluderCount++;
+			}
+
+			m_RasteriseTime = timer.GetMS(1000.0f);
+
+			Timer hiZTimer;
+			BuildHiZ();
+			m_HiZTime = hiZTimer.GetMS(1000.0f);
+
+			// World matrices are updated lazily, so they are gathered here before the jobs read them
+			Timer testTimer;
+			m_Occludees.clear();
+			m_Visible.assign(registry.size(), 1);
+
+			auto group = registry.group<MeshComponent>(entt::get<Maths::Transform>);
+			for (auto entity : group)
+			{
+				const auto& [mesh, transform] = group.get<MeshComponent, Maths::Transform>(entity);
+				if (!mesh.GetMesh() || !mesh.GetMesh()->GetBoundingBox())
+					continue;
+
+				const u32 index = static_cast<u32>(entt::to_integral(entity) & entt::entt_traits<std::underlying_type_t<entt::entity>>::entity_mask);
+				if (index < m_Visible.size())
+					m_Occludees.push_back({ index, &transform.GetWorldMatrix(), mesh.GetMesh()->GetBoundingBox().get() });
+			}
+
+			const u32 count = static_cast<u32>(m_Occludees.size());
+			System::JobSystem::Dispatch(m_Context, count, 64, [this, &frustum](JobDispatchArgs args)
+			{
+				const Occludee& occludee = m_Occludees[args.jobIndex];
+				const Maths::BoundingBox worldBox = occludee.boundingBox->Transformed(*occludee.transform);
+
+				// Out of the frustum is left to the renderers, 2 marks it so it isn't counted as tested
+				if (frustum.IsInsideFast(worldBox) == Maths::Intersection::OUTSIDE)
+					m_Visible[occludee.index] = 2;
+				else
+					m_Visible[occludee.index] = IsVisible(worldBox) ? 1 : 0;
+			});
+			System::JobSystem::Wait(m_Context);
+
+			for (auto& occludee : m_Occludees)
+			{
+				if (m_Visible[occludee.index] == 2)
+					continue;
+
+				m_TestedCount++;
+				if (m_Visible[occludee.index] == 0)
+					m_OccludedCount++;
+			}
+
+			m_TestTime = testTimer.GetMS(1000.0f);
+			m_Scene = scene;
+		}
+
+		bool OcclusionCuller::IsVisible(const Scene* scene, entt::entity entity) const
+		{
+			if (!m_Enabled || scene != m_Scene)
+				return true;
+
+			const u32 index = static_cast<u32>(entt::to_integral(entity) & entt::entt_traits<std::underlying_type_t<entt::entity>>::entity_mask);
+			return index >= m_Visible.size() || m_Visible[index] != 0;
+		}
+
+		void OcclusionCuller::OnImGui()
+		{
+			ImGui::Checkbox("Enabled", &m_Enabled);
+			ImGui::Text("Depth Buffer : %u x %u, %u levels", m_Width, m_Height, GetLevelCount());
+			ImGui::Text("Occluders : %u (%u triangles)", m_OccluderCount, m_OccluderTriangleCount);
+			ImGui::Text("Occluded : %u / %u (%.1f%%)", m_OccludedCount, m_TestedCount, m_TestedCount ? 100.0f * m_OccludedCount / m_TestedCount : 0.0f);
+			ImGui::Text("Rasterise : %.3f ms, HiZ : %.3f ms, Test : %.3f ms", m_RasteriseTime, m_HiZTime, m_TestTime);
+		}
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "lmpch.h"
+#include "Maths/Maths.h"
+#include "Core/JobSystem.h"
+
+#include <entt/entt.hpp>
+
+namespace Lumos
+{
+	class Scene;
+
+	namespace Graphics
+	{
+		// Software occlusion culling. OccluderComponents are rasterised into a small depth buffer on the
+		// CPU, a hierarchical-Z pyramid is built from it and the bounding box of every mesh in the view is
+		// tested against the pyramid on the job system, before the renderers submit anything.
+		// Depth is stored as 1 / w, so it interpolates linearly over the screen and reads the same under
+		// any projection convention. Larger is nearer, 0 is empty.
+		class LUMOS_EXPORT OcclusionCuller
+		{
+		public:
+			OcclusionCuller(u32 width = 256, u32 height = 128);
+			~OcclusionCuller();
+
+			void Resize(u32 width, u32 height);
+
+			// Rasterises the scene's occluders from its camera and tests every MeshComponent, once a frame
+			void Build(Scene* scene);
+
+			// False only for entities of the last built scene found hidden behind its occluders
+			bool IsVisible(const Scene* scene, entt::entity entity) const;
+
+			// Lower level steps Build is made of, usable without a scene
+			void BeginFrame(const Maths::Matrix4& viewProjection, float zNear);
+
+			// Coverage is conservative, only pixels wholly inside the occluder's outline are written.
+			// adjacency (see OccluderComponent) lets edges inside that outline be drawn without cracks,
+			// without it every triangle is shrunk on its own.
+			void RasteriseOccluder(const Maths::Vector3* positions, const u32* indices, u32 indexCount, const u32* adjacency, const Maths::Matrix4& transform);
+			void BuildHiZ();
+
+			// Conservative, a box crossing the near plane or leaving the screen is always visible.
+			// Only reads the pyramid, safe to call from worker threads after BuildHiZ.
+			bool IsVisible(const Maths::BoundingBox& worldBox) const;
+
+			u32 GetWidth() const { return m_Width; }
+			u32 GetHeight() const { return m_Height; }
+			u32 GetLevelCount() const { return static_cast<u32>(m_Levels.size()); }
+			u32 GetLevelWidth(u32 level) const { return m_Levels[level].width; }
+			u32 GetLevelHeight(u32 level) const { return m_Levels[level].height; }
+			u32 GetLevelStride(u32 level) const { return m_Levels[level].stride; }
+			const float* GetLevelDepth(u32 level) const { return m_Levels[level].depth.data(); }
+
+			bool& GetEnabled() { return m_Enabled; }
+
+			u32 GetOccluderCount() const { return m_OccluderCount; }
+			u32 GetOccluderTriangleCount() const { return m_OccluderTriangleCount; }
+			u32 GetTestedCount() const { return m_TestedCount; }
+			u32 GetOccludedCount() const { return m_OccludedCount; }
+			float GetRasteriseTime() const { return m_RasteriseTime; }
+			float GetHiZTime() const { return m_HiZTime; }
+			float GetTestTime() const { return m_TestTime; }
+
+			void OnImGui();
+
+		private:
+			struct ScreenVertex
+			{
+				float x;
+				float y;
+				float invW;
+			};
+
+			struct DepthLevel
+			{
+				u32 width = 0;
+				u32 height = 0;
+				u32 stride = 0;
+				std::vector<float> depth;
+			};
+
+			struct Occludee
+			{
+				u32 index;
+				const Maths::Matrix4* transform;
+				const Maths::BoundingBox* boundingBox;
+			};
+
+			// outlineEdges bit n set when the edge from vertex n is on the outline and gets shrunk
+			void RasteriseTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, u32 outlineEdges);
+
+			std::vector<DepthLevel> m_Levels;
+			u32 m_Width = 0;
+			u32 m_Height = 0;
+
+			Maths::Matrix4 m_ViewProjection;
+			float m_Near = 0.0f;
+
+			// Visibility of the last build, by entity index
+			const Scene* m_Scene = nullptr;
+			std::vector<u8> m_Visible;
+			std::vector<Occludee> m_Occludees;
+			std::vector<float> m_Facing;
+			System::JobSystem::Context m_Context;
+
+			bool m_Enabled = true;
+			u32 m_OccluderCount = 0;
+			u32 m_OccluderTriangleCount = 0;
+			u32 m_TestedCount = 0;
+			u32 m_OccludedCount = 0;
+			float m_RasteriseTime = 0.0f;
+			float m_HiZTime = 0.0f;
+			float m_TestTime = 0.0f;
+		};
+	}
+}
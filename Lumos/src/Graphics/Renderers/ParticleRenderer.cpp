@@ -0,0 +1,475 @@
+#include "lmpch.h"
+#include "ParticleRenderer.h"
+#include "Graphics/API/Shader.h"
+#include "Graphics/API/Framebuffer.h"
+#include "Graphics/API/Texture.h"
+#include "Graphics/API/UniformBuffer.h"
+#include "Graphics/API/Renderer.h"
+#include "Graphics/API/CommandBuffer.h"
+#include "Graphics/API/Swapchain.h"
+#include "Graphics/API/RenderPass.h"
+#include "Graphics/API/Pipeline.h"
+#include "Graphics/API/IndexBuffer.h"
+#include "Graphics/API/VertexArray.h"
+#include "Graphics/GBuffer.h"
+#include "Graphics/RenderManager.h"
+#include "Graphics/Renderable2D.h"
+#include "Graphics/ParticleEmitter.h"
+#include "Graphics/Camera/Camera.h"
+#include "ECS/Component/ParticleComponent.h"
+#include "App/Scene.h"
+#include "App/Application.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		ParticleRenderer::ParticleRenderer(u32 width, u32 height, bool renderToGBuffer)
+		{
+			m_Pipeline = nullptr;
+
+			Renderer3D::SetScreenBufferSize(width, height);
+			ParticleRenderer::Init();
+			ParticleRenderer::SetRenderToGBufferTexture(renderToGBuffer);
+		}
+
+		ParticleRenderer::~ParticleRenderer()
+		{
+			for (auto& [emitter, resources] : m_EmitterResources)
+			{
+				delete resources.vertexArray;
+				delete resources.descriptorSet;
+			}
+
+			m_EmitterResources.clear();
+
+			delete m_IndexBuffer;
+			delete m_UniformBuffer;
+			delete m_Pipeline;
+			delete m_RenderPass;
+			delete m_Shader;
+
+			for (auto& commandBuffer : m_CommandBuffers)
+			{
+				delete commandBuffer;
+			}
+
+			for (auto& fbo : m_Framebuffers)
+			{
+				delete fbo;
+			}
+
+			m_Framebuffers.clear();
+			m_CommandBuffers.clear();
+		}
+
+		void ParticleRenderer::Init()
+		{
+			LUMOS_PROFILE_FUNC;
+			m_Shader = Shader::CreateFromFile("Batch2D", "/CoreShaders/");
+
+			m_CommandBuffers.resize(Renderer::GetSwapchain()->GetSwapchainBufferCount());
+
+			for (auto& commandBuffer : m_CommandBuffers)
+			{
+				commandBuffer = Graphics::CommandBuffer::Create();
+				commandBuffer->Init(true);
+			}
+
+			m_RenderPass = Graphics::RenderPass::Create();
+			AttachmentInfo textureTypes[2] =
+			{
+				{ TextureType::COLOUR, TextureFormat::RGBA8 },
+				{ TextureType::DEPTH , TextureFormat::DEPTH }
+			};
+
+			Graphics::RenderpassInfo renderpassCI;
+			renderpassCI.attachmentCount = 2;
+			renderpassCI.textureType = textureTypes;
+			renderpassCI.clear = false;
+
+			m_RenderPass->Init(renderpassCI);
+
+			CreateGraphicsPipeline();
+
+			m_UniformBuffer = Graphics::UniformBuffer::Create();
+			m_UniformBuffer->Init(sizeof(UniformBufferObject), nullptr);
+
+			std::vector<Graphics::BufferInfo> bufferInfos;
+
+			Graphics::BufferInfo bufferInfo;
+			bufferInfo.buffer = m_UniformBuffer;
+			bufferInfo.offset = 0;
+			bufferInfo.size = sizeof(UniformBufferObject);
+			bufferInfo.type = Graphics::DescriptorType::UNIFORM_BUFFER;
+			bufferInfo.shaderType = ShaderType::VERTEX;
+			bufferInfo.systemUniforms = false;
+			bufferInfo.name = "UniformBufferObject";
+			bufferInfo.binding = 0;
+
+			bufferInfos.push_back(bufferInfo);
+
+			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
+
+			uint32_t whiteTextureData = 0xffffffff;
+			m_DefaultTexture = Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromSource(1, 1, &whiteTextureData));
+
+			CreateFramebuffers();
+		}
+
+		void ParticleRenderer::ResizeIndexBuffer(u32 particleCount)
+		{
+			if (particleCount <= m_IndexBufferParticles)
+				return;
+
+			delete m_IndexBuffer;
+
+			const u32 indexCount = particleCount * 6;
+			u32* indices = lmnew u32[indexCount];
+
+			u32 offset = 0;
+			for (u32 i = 0; i < indexCount; i += 6)
+			{
+				indices[i] = offset + 0;
+				indices[i + 1] = offset + 1;
+				indices[i + 2] = offset + 2;
+
+				indices[i + 3] = offset + 2;
+				indices[i + 4] = offset + 3;
+				indices[i + 5] = offset + 0;
+
+				offset += 4;
+			}
+
+			m_IndexBuffer = IndexBuffer::Create(indices, indexCount);
+			m_IndexBufferParticles = particleCount;
+
+			delete[] indices;
+		}
+
+		ParticleRenderer::EmitterResources& ParticleRenderer::GetResources(ParticleEmitter* emitter)
+		{
+			auto& resources = m_EmitterResources[emitter];
+
+			if (resources.capacity != emitter->GetMaxParticles())
+			{
+				delete resources.vertexArray;
+
+				Graphics::BufferLayout layout;
+				layout.Push<Maths::Vector3>("POSITION");
+				layout.Push<Maths::Vector2>("TEXCOORD");
+				layout.Push<Maths::Vector2>("ID");
+				layout.Push<Maths::Vector4>("COLOUR");
+
+				resources.vertexArray = Graphics::VertexArray::Create();
+				resources.vertexArray->Bind();
+				VertexBuffer* buffer = VertexBuffer::Create(BufferUsage::DYNAMIC);
+				buffer->Resize(emitter->GetMaxParticles() * 4 * RENDERER2D_VERTEX_SIZE);
+				buffer->SetLayout(layout);
+				resources.vertexArray->PushBuffer(buffer);
+				resources.vertexArray->Unbind();
+
+				resources.capacity = emitter->GetMaxParticles();
+			}
+
+			Texture* texture = emitter->GetTexture() ? static_cast<Texture*>(emitter->GetTexture()) : m_DefaultTexture.get();
+
+			if (!resources.descriptorSet || resources.texture != texture)
+			{
+				if (!resources.descriptorSet)
+				{
+					Graphics::DescriptorInfo info{};
+					info.pipeline = m_Pipeline;
+					info.layoutIndex = 1;
+					info.shader = m_Shader;
+					resources.descriptorSet = Graphics::DescriptorSet::Create(info);
+				}
+
+				std::vector<Graphics::ImageInfo> imageInfos;
+
+				Graphics::ImageInfo imageInfo = {};
+				imageInfo.binding = 0;
+				imageInfo.name = "textures";
+				imageInfo.texture = { texture };
+				imageInfo.count = 1;
+				imageInfos.push_back(imageInfo);
+
+				resources.descriptorSet->Update(imageInfos);
+				resources.texture = texture;
+			}
+
+			resources.lastUsedFrame = m_FrameIndex;
+			return resources;
+		}
+
+		void ParticleRenderer::BeginScene(Scene* scene)
+		{
+			auto& registry = scene->GetRegistry();
+
+			auto cameraView = registry.view<Camera>();
+			if (!cameraView.empty())
+			{
+				m_Camera = &registry.get<Camera>(cameraView.front());
+			}
+
+			const Maths::Matrix4& view = m_Camera->GetViewMatrix();
+			m_ProjView = m_Camera->GetProjectionMatrix() * view;
+
+			// Rows of the view rotation are the camera axes in world space
+			m_CameraRight = Maths::Vector3(view.m00_, view.m01_, view.m02_);
+			m_CameraUp = Maths::Vector3(view.m10_, view.m11_, view.m12_);
+			m_CameraForward = -Maths::Vector3(view.m20_, view.m21_, view.m22_);
+			m_CameraPosition = m_Camera->GetPosition();
+			m_Frustum = m_Camera->GetFrustum();
+		}
+
+		void ParticleRenderer::RenderScene(Scene* scene)
+		{
+			LUMOS_PROFILE_FUNC;
+			Timer timer;
+
+			m_FrameIndex++;
+			m_Draws.clear();
+			m_ParticleCount = 0;
+
+			auto& registry = scene->GetRegistry();
+			auto view = registry.view<ParticleComponent>();
+
+			for (auto entity : view)
+			{
+				auto& emitter = view.get<ParticleComponent>(entity).GetParticleEmitter();
+
+				if (!emitter || emitter->GetParticleCount() == 0)
+					continue;
+
+				if (m_Draws.size() >= MAX_PARTICLE_EMITTERS)
+					break;
+
+				if (m_Frustum.IsInside(emitter->GetBoundingBox()) == Maths::Intersection::OUTSIDE)
+					continue;
+
+				auto& resources = GetResources(emitter.get());
+
+				resources.vertexArray->Bind();
+				VertexData* vertices = resources.vertexArray->GetBuffer()->GetPointer<VertexData>();
+				emitter->BuildVertices(vertices, m_CameraPosition, m_CameraRight, m_CameraUp, m_CameraForward, 1.0f);
+				resources.vertexArray->GetBuffer()->ReleasePointer();
+				resources.vertexArray->Unbind();
+
+				ResizeIndexBuffer(emitter->GetParticleCount());
+
+				m_Draws.push_back({ &resources, emitter->GetParticleCount() });
+				m_ParticleCount += emitter->GetParticleCount();
+			}
+
+			// Release buffers of emitters that have been destroyed or stayed culled
+			for (auto it = m_EmitterResources.begin(); it != m_EmitterResources.end();)
+			{
+				if (m_FrameIndex - it->second.lastUsedFrame > 120)
+				{
+					delete it->second.vertexArray;
+					delete it->second.descriptorSet;
+					it = m_EmitterResources.erase(it);
+				}
+				else
+					++it;
+			}
+
+			m_BuildTime = timer.GetMS(1000.0f);
+
+			m_CurrentBufferID = 0;
+			if (!m_RenderTexture)
+				m_CurrentBufferID = Renderer::GetSwapchain()->GetCurrentBufferId();
+
+			Begin();
+			Present();
+			End();
+
+			if (!m_RenderTexture)
+				Renderer::Present((m_CommandBuffers[Renderer::GetSwapchain()->GetCurrentBufferId()]));
+		}
+
+		void ParticleRenderer::Begin()
+		{
+			m_CommandBuffers[m_CurrentBufferID]->BeginRecording();
+
+			m_RenderPass->BeginRenderpass(m_CommandBuffers[m_CurrentBufferID], Maths::Vector4(0.0f), m_Framebuffers[m_CurrentBufferID], Graphics::INLINE, m_ScreenBufferWidth, m_ScreenBufferHeight);
+		}
+
+		void ParticleRenderer::Present()
+		{
+			if (m_Draws.empty())
+				return;
+
+			auto commandBuffer = m_CommandBuffers[m_CurrentBufferID];
+
+			m_UniformBuffer->SetData(sizeof(UniformBufferObject), &m_ProjView);
+			m_Pipeline->SetActive(commandBuffer);
+
+			for (auto& draw : m_Draws)
+			{
+				std::vector<Graphics::DescriptorSet*> descriptorSets = { m_Pipeline->GetDescriptorSet(), draw.resources->descriptorSet };
+
+				draw.resources->vertexArray->Bind(commandBuffer);
+				m_IndexBuffer->Bind(commandBuffer);
+
+				Renderer::BindDescriptorSets(m_Pipeline, commandBuffer, 0, descriptorSets);
+				Renderer::DrawIndexed(commandBuffer, DrawType::TRIANGLE, draw.particleCount * 6);
+
+				draw.resources->vertexArray->Unbind();
+				m_IndexBuffer->Unbind();
+			}
+		}
+
+		void ParticleRenderer::End()
+		{
+			m_RenderPass->EndRenderpass(m_CommandBuffers[m_CurrentBufferID]);
+			m_CommandBuffers[m_CurrentBufferID]->EndRecording();
+
+			if (m_RenderTexture)
+				m_CommandBuffers[m_CurrentBufferID]->Execute(true);
+		}
+
+		void ParticleRenderer::CreateGraphicsPipeline()
+		{
+			std::vector<Graphics::DescriptorPoolInfo> poolInfo =
+			{
+				{ Graphics::DescriptorType::UNIFORM_BUFFER, 1 },
+				{ Graphics::DescriptorType::IMAGE_SAMPLER, MAX_PARTICLE_EMITTERS * 16 }
+			};
+
+			std::vector<Graphics::DescriptorLayoutInfo> layoutInfo =
+			{
+				{ Graphics::DescriptorType::UNIFORM_BUFFER, Graphics::ShaderType::VERTEX, 0 }
+			};
+
+			std::vector<Graphics::DescriptorLayoutInfo> layoutInfoMesh =
+			{
+				 { Graphics::DescriptorType::IMAGE_SAMPLER,Graphics::ShaderType::FRAGMENT , 0, 16 }
+			};
+
+			auto attributeDescriptions = VertexData::getAttributeDescriptions();
+
+			std::vector<Graphics::DescriptorLayout> descriptorLayouts;
+
+			Graphics::DescriptorLayout sceneDescriptorLayout;
+			sceneDescriptorLayout.count = static_cast<u32>(layoutInfo.size());
+			sceneDescriptorLayout.layoutInfo = layoutInfo.data();
+
+			descriptorLayouts.push_back(sceneDescriptorLayout);
+
+			Graphics::DescriptorLayout meshDescriptorLayout;
+			meshDescriptorLayout.count = static_cast<u32>(layoutInfoMesh.size());
+			meshDescriptorLayout.layoutInfo = layoutInfoMesh.data();
+
+			descriptorLayouts.push_back(meshDescriptorLayout);
+
+			Graphics::PipelineInfo pipelineCI;
+			pipelineCI.pipelineName = "ParticleRenderer";
+			pipelineCI.shader = m_Shader;
+			pipelineCI.renderpass = m_RenderPass;
+			pipelineCI.numVertexLayout = static_cast<u32>(attributeDescriptions.size());
+			pipelineCI.descriptorLayouts = descriptorLayouts;
+			pipelineCI.vertexLayout = attributeDescriptions.data();
+			pipelineCI.numLayoutBindings = static_cast<u32>(poolInfo.size());
+			pipelineCI.typeCounts = poolInfo.data();
+			pipelineCI.strideSize = sizeof(VertexData);
+			pipelineCI.numColorAttachments = 1;
+			pipelineCI.polygonMode = Graphics::PolygonMode::Fill;
+			pipelineCI.cullMode = Graphics::CullMode::NONE;
+			pipelineCI.transparencyEnabled = true;
+			pipelineCI.depthBiasEnabled = false;
+			pipelineCI.maxObjects = MAX_PARTICLE_EMITTERS;
+
+			m_Pipeline = Graphics::Pipeline::Create(pipelineCI);
+		}
+
+		void ParticleRenderer::SetRenderTarget(Texture* texture)
+		{
+			m_RenderTexture = texture;
+
+			for (auto fbo : m_Framebuffers)
+				delete fbo;
+			m_Framebuffers.clear();
+
+			CreateFramebuffers();
+		}
+
+		void ParticleRenderer::SetRenderToGBufferTexture(bool set)
+		{
+			if (set)
+			{
+				m_RenderToGBufferTexture = true;
+				m_RenderTexture = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_OFFSCREEN0);
+
+				for (auto fbo : m_Framebuffers)
+					delete fbo;
+				m_Framebuffers.clear();
+
+				CreateFramebuffers();
+			}
+		}
+
+		void ParticleRenderer::OnResize(u32 width, u32 height)
+		{
+			for (auto fbo : m_Framebuffers)
+				delete fbo;
+			m_Framebuffers.clear();
+
+			if (m_RenderToGBufferTexture)
+				m_RenderTexture = Application::Instance()->GetRenderManager()->GetGBuffer()->GetTexture(SCREENTEX_OFFSCREEN0);
+
+			SetScreenBufferSize(width, height);
+
+			CreateFramebuffers();
+		}
+
+		void ParticleRenderer::CreateFramebuffers()
+		{
+			TextureType attachmentTypes[2];
+			attachmentTypes[0] = TextureType::COLOUR;
+			attachmentTypes[1] = TextureType::DEPTH;
+
+			Texture* attachments[2];
+			FramebufferInfo bufferInfo{};
+			bufferInfo.width = m_ScreenBufferWidth;
+			bufferInfo.height = m_ScreenBufferHeight;
+			bufferInfo.attachmentCount = 2;
+			bufferInfo.renderPass = m_RenderPass;
+			bufferInfo.attachmentTypes = attachmentTypes;
+
+			attachments[1] = dynamic_cast<Texture*>(Application::Instance()->GetRenderManager()->GetGBuffer()->GetDepthTexture());
+
+			if (m_RenderTexture)
+			{
+				attachments[0] = m_RenderTexture;
+				bufferInfo.attachments = attachments;
+				bufferInfo.screenFBO = false;
+				m_Framebuffers.emplace_back(Framebuffer::Create(bufferInfo));
+			}
+			else
+			{
+				for (uint32_t i = 0; i < Renderer::GetSwapchain()->GetSwapchainBufferCount(); i++)
+				{
+					bufferInfo.screenFBO = true;
+					attachments[0] = Renderer::GetSwapchain()->GetImage(i);
+					bufferInfo.attachments = attachments;
+
+					m_Framebuffers.emplace_back(Framebuffer::Create(bufferInfo));
+				}
+			}
+		}
+
+		void ParticleRenderer::OnImGui()
+		{
+			ImGui::TextUnformatted("Particle Renderer");
+			ImGui::Text("Emitters Drawn : %u", static_cast<u32>(m_Draws.size()));
+			ImGui::Text("Particles Drawn : %u", m_ParticleCount);
+			ImGui::Text("Vertex Build : %.3f ms", m_BuildTime);
+		}
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "lmpch.h"
+#include "Renderer3D.h"
+
+#define MAX_PARTICLE_EMITTERS 64
+
+namespace Lumos
+{
+	class ParticleEmitter;
+
+	namespace Graphics
+	{
+		class Shader;
+		class UniformBuffer;
+		class CommandBuffer;
+		class VertexArray;
+		class IndexBuffer;
+		class Texture2D;
+
+		// Draws every ParticleComponent as camera facing billboards, one indexed draw per emitter.
+		// Billboards are expanded on the job system into a per emitter vertex buffer and rendered
+		// with the Batch2D shader over the scene colour and depth.
+		class LUMOS_EXPORT ParticleRenderer : public Renderer3D
+		{
+		public:
+			ParticleRenderer(u32 width, u32 height, bool renderToGBuffer = false);
+			~ParticleRenderer();
+
+			void Init() override;
+			void BeginScene(Scene* scene) override;
+			void OnResize(u32 width, u32 height) override;
+			void CreateGraphicsPipeline();
+			void CreateFramebuffers();
+
+			void Begin() override;
+			void Submit(const RenderCommand& command) override {};
+			void SubmitMesh(Mesh* mesh, Material* material, const Maths::Matrix4& transform, const Maths::Matrix4& textureMatrix) override {};
+			void EndScene() override {};
+			void End() override;
+			void Present() override;
+			void RenderScene(Scene* scene) override;
+
+			void SetRenderTarget(Texture* texture) override;
+			void SetRenderToGBufferTexture(bool set) override;
+			void OnImGui() override;
+
+			struct UniformBufferObject
+			{
+				Maths::Matrix4 projView;
+			};
+
+		private:
+			struct EmitterResources
+			{
+				VertexArray* vertexArray = nullptr;
+				DescriptorSet* descriptorSet = nullptr;
+				Texture* texture = nullptr;
+				u32 capacity = 0;
+				u32 lastUsedFrame = 0;
+			};
+
+			struct EmitterDraw
+			{
+				EmitterResources* resources;
+				u32 particleCount;
+			};
+
+			EmitterResources& GetResources(ParticleEmitter* emitter);
+			void ResizeIndexBuffer(u32 particleCount);
+
+			UniformBuffer* m_UniformBuffer = nullptr;
+			IndexBuffer* m_IndexBuffer = nullptr;
+			u32 m_IndexBufferParticles = 0;
+
+			std::vector<CommandBuffer*> m_CommandBuffers;
+			std::vector<Framebuffer*> m_Framebuffers;
+			u32 m_CurrentBufferID = 0;
+
+			std::unordered_map<ParticleEmitter*, EmitterResources> m_EmitterResources;
+			std::vector<EmitterDraw> m_Draws;
+			Ref<Texture2D> m_DefaultTexture;
+
+			Maths::Matrix4 m_ProjView;
+			Maths::Vector3 m_CameraPosition;
+			Maths::Vector3 m_CameraRight;
+			Maths::Vector3 m_CameraUp;
+			Maths::Vector3 m_CameraForward;
+			Maths::Frustum m_Frustum;
+
+			u32 m_FrameIndex = 0;
+			u32 m_ParticleCount = 0;
+			float m_BuildTime = 0.0f;
+		};
+	}
+}
@@ -20,7 +20,11 @@
 #include "Graphics/Renderable2D.h"
 #include "Graphics/Camera/Camera.h"
 #include "Maths/Transform.h"
+#include "Core/JobSystem.h"
 #include "Core/Profiler.h"
+#include "Utilities/Timer.h"
+
+#include <imgui/imgui.h>
 
 namespace Lumos
 {
@@ -28,8 +32,8 @@ namespace Lumos
 	{    
 		Renderer2D::Renderer2D(u32 width, u32 height, bool renderToGBuffer, bool clear, bool triangleIndicies, bool renderToDepth) : m_IndexCount(0), m_RenderTexture(nullptr), m_Buffer(nullptr), m_Clear(clear), m_RenderToDepthTexture(renderToDepth)
 		{
-            m_Limits.SetMaxQuads(10000);
-            m_Limits.MaxQuads = 16;//Renderer::GetCapabilities().MaxTextureUnits;
+            m_Limits.SetMaxQuads(RENDERER2D_MAX_BATCH_QUADS);
+            m_Limits.MaxTextures = 16;//Renderer::GetCapabilities().MaxTextureUnits;
 
             Renderer2D::SetScreenBufferSize(width, height);
 			Renderer2D::Init(triangleIndicies);
@@ -38,9 +42,12 @@ namespace Lumos
 
 		Renderer2D::~Renderer2D()
 		{
+			for (auto& [key, chunk] : m_StaticChunks)
+				ClearStaticChunk(chunk);
+
+			delete m_StaticCommandBuffer;
 			delete m_IndexBuffer;
 			delete m_Pipeline;
-			delete m_DescriptorSet;
 			delete m_RenderPass;
 			delete m_Shader;
 			delete m_UniformBuffer;
@@ -53,6 +60,9 @@ namespace Lumos
 			for (int i = 0; i < m_Limits.MaxBatchDrawCalls; i++)
 				delete m_VertexArrays[i];
 
+			for (int i = 0; i < m_Limits.MaxBatchDrawCalls; i++)
+				delete m_DescriptorSets[i];
+
 			for (int i = 0; i < m_Limits.MaxBatchDrawCalls; i++)
 				delete m_SecondaryCommandBuffers[i];
 
@@ -112,6 +122,9 @@ namespace Lumos
 				cmdBuffer->Init(false);
 			}
 
+			m_StaticCommandBuffer = Graphics::CommandBuffer::Create();
+			m_StaticCommandBuffer->Init(false);
+
 			CreateGraphicsPipeline();
 
 			uint32_t bufferSize = static_cast<uint32_t>(sizeof(UniformBufferObject));
@@ -133,29 +146,9 @@ namespace Lumos
 
 			m_Pipeline->GetDescriptorSet()->Update(bufferInfos);
 
-			Graphics::DescriptorInfo info{};
-			info.pipeline = m_Pipeline;
-			info.layoutIndex = 1; //?
-			info.shader = m_Shader;
-			m_DescriptorSet = Graphics::DescriptorSet::Create(info);
-
-			Graphics::BufferLayout layout;
-			layout.Push<Maths::Vector3>("POSITION"); // Position
-			layout.Push<Maths::Vector2>("TEXCOORD"); // UV
-			layout.Push<Maths::Vector2>("ID"); // Texture Index
-			layout.Push<Maths::Vector4>("COLOUR"); // Colour
-
-			m_VertexArrays.resize(m_Limits.MaxBatchDrawCalls);
-
-			for (auto& vertexArray : m_VertexArrays)
-			{
-				vertexArray = Graphics::VertexArray::Create();
-				vertexArray->Bind();
-				VertexBuffer* buffer = VertexBuffer::Create(BufferUsage::DYNAMIC);
-				buffer->Resize(m_Limits.BufferSize);
-				buffer->SetLayout(layout);
-				vertexArray->PushBuffer(buffer);
-			}
+			// Vertex buffers and texture sets are created the first time a batch index is used
+			m_DescriptorSets.resize(m_Limits.MaxBatchDrawCalls, nullptr);
+			m_VertexArrays.resize(m_Limits.MaxBatchDrawCalls, nullptr);
 
 			u32* indices = lmnew u32[m_Limits.IndiciesSize];
 
@@ -189,6 +182,44 @@ namespace Lumos
 			m_ClearColour = Maths::Vector4(0.2f, 0.2f, 0.2f, 1.0f);
 		}
 
+		VertexArray* Renderer2D::GetVertexArray(u32 index)
+		{
+			if (!m_VertexArrays[index])
+			{
+				Graphics::BufferLayout layout;
+				layout.Push<Maths::Vector3>("POSITION"); // Position
+				layout.Push<Maths::Vector2>("TEXCOORD"); // UV
+				layout.Push<Maths::Vector2>("ID"); // Texture Index
+				layout.Push<Maths::Vector4>("COLOUR"); // Colour
+
+				auto vertexArray = Graphics::VertexArray::Create();
+				vertexArray->Bind();
+				VertexBuffer* buffer = VertexBuffer::Create(BufferUsage::DYNAMIC);
+				buffer->Resize(m_Limits.BufferSize);
+				buffer->SetLayout(layout);
+				vertexArray->PushBuffer(buffer);
+
+				m_VertexArrays[index] = vertexArray;
+			}
+
+			return m_VertexArrays[index];
+		}
+
+		DescriptorSet* Renderer2D::GetDescriptorSet(u32 index)
+		{
+			// One set per batch, so updating the textures of a later batch can't affect one already recorded
+			if (!m_DescriptorSets[index])
+			{
+				Graphics::DescriptorInfo info{};
+				info.pipeline = m_Pipeline;
+				info.layoutIndex = 1;
+				info.shader = m_Shader;
+				m_DescriptorSets[index] = Graphics::DescriptorSet::Create(info);
+			}
+
+			return m_DescriptorSets[index];
+		}
+
 		void Renderer2D::Submit(Renderable2D* renderable, const Maths::Matrix4& transform)
 		{
             if(m_IndexCount >= m_Limits.IndiciesSize)
@@ -287,8 +318,8 @@ namespace Lumos
 
 			m_RenderPass->BeginRenderpass(m_CommandBuffers[m_CurrentBufferID], m_ClearColour, m_Framebuffers[m_CurrentBufferID], Graphics::SECONDARY, m_ScreenBufferWidth, m_ScreenBufferHeight);
 
-			m_VertexArrays[m_BatchDrawCallIndex]->Bind(m_CommandBuffers[m_CurrentBufferID]);
-            m_Buffer = m_VertexArrays[m_BatchDrawCallIndex]->GetBuffer()->GetPointer<VertexData>();
+			GetVertexArray(m_BatchDrawCallIndex)->Bind(m_CommandBuffers[m_CurrentBufferID]);
+            m_Buffer = GetVertexArray(m_BatchDrawCallIndex)->GetBuffer()->GetPointer<VertexData>();
 		}
 
 		void Renderer2D::Begin()
@@ -305,8 +336,8 @@ namespace Lumos
 			m_Sprites.clear();
             m_Triangles.clear();
 
-			m_VertexArrays[m_BatchDrawCallIndex]->Bind(m_CommandBuffers[m_CurrentBufferID]);
-			m_Buffer = m_VertexArrays[m_BatchDrawCallIndex]->GetBuffer()->GetPointer<VertexData>();
+			GetVertexArray(m_BatchDrawCallIndex)->Bind(m_CommandBuffers[m_CurrentBufferID]);
+			m_Buffer = GetVertexArray(m_BatchDrawCallIndex)->GetBuffer()->GetPointer<VertexData>();
 		}
 
 		void Renderer2D::SetSystemUniforms(Shader* shader) const
@@ -342,20 +373,22 @@ namespace Lumos
 			currentCMDBuffer->UpdateViewport(m_ScreenBufferWidth, m_ScreenBufferHeight);
 			m_Pipeline->SetActive(currentCMDBuffer);
 
-			m_VertexArrays[m_BatchDrawCallIndex]->GetBuffer()->ReleasePointer();
-			m_VertexArrays[m_BatchDrawCallIndex]->Unbind();
+			VertexArray* vertexArray = GetVertexArray(m_BatchDrawCallIndex);
+			vertexArray->Bind();
+			vertexArray->GetBuffer()->ReleasePointer();
+			vertexArray->Unbind();
 
 			m_IndexBuffer->SetCount(m_IndexCount);
 
-			std::vector<Graphics::DescriptorSet*> descriptors = { m_Pipeline->GetDescriptorSet(), m_DescriptorSet };
+			std::vector<Graphics::DescriptorSet*> descriptors = { m_Pipeline->GetDescriptorSet(), GetDescriptorSet(m_BatchDrawCallIndex) };
 
-			m_VertexArrays[m_BatchDrawCallIndex]->Bind(currentCMDBuffer);
+			vertexArray->Bind(currentCMDBuffer);
 			m_IndexBuffer->Bind(currentCMDBuffer);
 
 			Renderer::BindDescriptorSets(m_Pipeline, currentCMDBuffer, 0, descriptors);
 			Renderer::DrawIndexed(currentCMDBuffer, DrawType::TRIANGLE, m_IndexCount);
 
-			m_VertexArrays[m_BatchDrawCallIndex]->Unbind();
+			vertexArray->Unbind();
 			m_IndexBuffer->Unbind();
 
 			m_IndexCount = 0;
@@ -383,31 +416,279 @@ namespace Lumos
 		void Renderer2D::Render(Scene* scene)
 		{
 			LUMOS_PROFILE_FUNC;
-			Begin();
+			BuildSpriteBatches(scene);
+
+			m_CurrentBufferID = 0;
+			if (!m_RenderTexture)
+				m_CurrentBufferID = Renderer::GetSwapchain()->GetCurrentBufferId();
+
+			m_CommandBuffers[m_CurrentBufferID]->BeginRecording();
+			m_RenderPass->BeginRenderpass(m_CommandBuffers[m_CurrentBufferID], m_ClearColour, m_Framebuffers[m_CurrentBufferID], Graphics::SECONDARY, m_ScreenBufferWidth, m_ScreenBufferHeight);
 
 			SetSystemUniforms(m_Shader);
-			
-            auto& registry = scene->GetRegistry();
-            auto group = registry.group<Graphics::Sprite>(entt::get<Maths::Transform>);
-            for(auto entity: group)
-            {
-                const auto &[sprite, trans] = group.get<Graphics::Sprite, Maths::Transform>(entity);
-                
-				auto bb = Maths::BoundingBox(Maths::Rect(sprite.GetPosition(), sprite.GetPosition() + sprite.GetScale()));
-				bb.Transform(trans.GetWorldMatrix());
-                auto inside = m_Frustum.IsInside(bb);
-                
-				if (inside == Maths::Intersection::OUTSIDE)
-					continue;
-                
-                Submit(reinterpret_cast<Renderable2D*>(&sprite), trans.GetWorldMatrix());
-            };
 
-			Present();
+			// Static chunks go first, dynamic sprites are drawn over them
+			DrawStaticChunks();
+
+			for (auto& batch : m_SpriteBatches)
+			{
+				m_Textures = batch.textures;
+				m_IndexCount = batch.count * 6;
+				Present();
+			}
+
+			m_Textures.clear();
 
 			End();
 		}
 
+		static void GetSpriteCorners(const Renderable2D& sprite, const Maths::Matrix4& world, Maths::Vector3* corners)
+		{
+			const Maths::Vector2 min = sprite.GetPosition();
+			const Maths::Vector2 max = sprite.GetPosition() + sprite.GetScale();
+
+			corners[0] = world * Maths::Vector3(min.x, min.y, 0.0f);
+			corners[1] = world * Maths::Vector3(max.x, min.y, 0.0f);
+			corners[2] = world * Maths::Vector3(max.x, max.y, 0.0f);
+			corners[3] = world * Maths::Vector3(min.x, max.y, 0.0f);
+		}
+
+		static VertexData* WriteSpriteVertices(VertexData* buffer, const Maths::Vector3* corners, const Renderable2D* sprite, const AtlasRegion* region, float textureSlot)
+		{
+			const Maths::Vector4& colour = sprite->GetColour();
+			const std::vector<Maths::Vector2>& uv = sprite->GetUVs();
+			const Maths::Vector2 tid = Maths::Vector2(textureSlot, 0.0f);
+
+			Maths::Vector2 uvOffset = Maths::Vector2(0.0f, 0.0f);
+			Maths::Vector2 uvScale = Maths::Vector2(1.0f, 1.0f);
+			if (region && region->atlased)
+			{
+				uvOffset = region->uvOffset;
+				uvScale = region->uvScale;
+			}
+
+			for (u32 v = 0; v < 4; v++)
+			{
+				buffer->vertex = corners[v];
+				buffer->uv = uvOffset + uv[v] * uvScale;
+				buffer->tid = tid;
+				buffer->color = colour;
+				buffer++;
+			}
+
+			return buffer;
+		}
+
+		static u32 LayerSortKey(float layer)
+		{
+			// Flips the float bits so unsigned comparison matches float ordering
+			u32 bits;
+			memcpy(&bits, &layer, sizeof(u32));
+			return (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+		}
+
+		void Renderer2D::BuildSpriteBatches(Scene* scene)
+		{
+			LUMOS_PROFILE_FUNC;
+			Timer timer;
+
+			m_FrameIndex++;
+			m_SpriteBatches.clear();
+			m_SpriteJobs.clear();
+			m_SpriteOrder.clear();
+
+			auto& registry = scene->GetRegistry();
+
+			if (m_StaticRegistry != &registry)
+			{
+				InvalidateStaticChunks();
+				m_StaticRegistry = &registry;
+			}
+
+			// Baked chunks keep using their textures even while off screen
+			for (auto& [key, chunk] : m_StaticChunks)
+			{
+				for (auto region : chunk.regions)
+					region->lastUsedFrame = m_FrameIndex;
+			}
+
+			m_TextureAtlas.ReleaseUnused(m_FrameIndex, RENDERER2D_ATLAS_RETAIN_FRAMES);
+
+			auto group = registry.group<Graphics::Sprite>(entt::get<Maths::Transform>);
+
+			const entt::entity* entities = group.data();
+			const u32 spriteCount = static_cast<u32>(group.size());
+			m_SpriteCount = spriteCount;
+
+			m_SpriteItems.resize(spriteCount);
+
+			const u32 cullJobCount = (spriteCount + RENDERER2D_SPRITE_JOB_SIZE - 1) / RENDERER2D_SPRITE_JOB_SIZE;
+			const bool rebakeAll = m_RebakeAllStatic;
+			m_RebakeAllStatic = false;
+
+			m_DirtySprites.resize(cullJobCount);
+			m_StaticCounts.assign(cullJobCount, 0);
+
+			if (cullJobCount > 0)
+			{
+				System::JobSystem::Dispatch(cullJobCount, 1, [&](JobDispatchArgs args)
+				{
+					const u32 begin = args.jobIndex * RENDERER2D_SPRITE_JOB_SIZE;
+					const u32 end = Maths::Min(begin + RENDERER2D_SPRITE_JOB_SIZE, spriteCount);
+
+					auto& dirtySprites = m_DirtySprites[args.jobIndex];
+					dirtySprites.clear();
+
+					for (u32 i = begin; i < end; i++)
+					{
+						const auto& [sprite, transform] = group.get<Graphics::Sprite, Maths::Transform>(entities[i]);
+						const Maths::Matrix4& world = transform.GetWorldMatrix();
+
+						auto& item = m_SpriteItems[i];
+						item.isStatic = sprite.GetStatic();
+
+						// Dirty dynamic sprites are still reported in case they were static before
+						if (sprite.GetDirty() || (item.isStatic && (rebakeAll || transform.HasUpdated())))
+							dirtySprites.push_back(entities[i]);
+
+						if (item.isStatic)
+						{
+							item.visible = false;
+							m_StaticCounts[args.jobIndex]++;
+							continue;
+						}
+
+						GetSpriteCorners(sprite, world, item.corners);
+
+						item.visible = m_Frustum.IsInside(Maths::BoundingBox(item.corners, 4)) != Maths::Intersection::OUTSIDE;
+						item.sprite = &sprite;
+						item.layer = world.m23_;
+
+						// Read only lookup, textures seen for the first time are added after the jobs finish
+						item.region = sprite.GetTexture() ? m_TextureAtlas.Find(sprite.GetTexture()) : nullptr;
+					}
+				});
+
+				System::JobSystem::Wait();
+			}
+
+			u32 staticCount = 0;
+			for (auto count : m_StaticCounts)
+				staticCount += count;
+
+			UpdateStaticChunks(registry, staticCount);
+
+			if (spriteCount == 0)
+			{
+				m_BuildTime = timer.GetMS(1000.0f);
+				return;
+			}
+
+			for (u32 i = 0; i < spriteCount; i++)
+			{
+				auto& item = m_SpriteItems[i];
+				if (!item.visible)
+					continue;
+
+				if (!item.region && item.sprite->GetTexture())
+					item.region = m_TextureAtlas.Add(item.sprite->GetTextureRef());
+
+				const u64 textureKey = item.region ? item.region->sortID : 0;
+				m_SpriteOrder.emplace_back((u64(LayerSortKey(item.layer)) << 32) | textureKey, i);
+			}
+
+			m_TextureAtlas.Upload();
+
+			// Scenes rarely change layers or textures, so the order is usually already sorted
+			if (!std::is_sorted(m_SpriteOrder.begin(), m_SpriteOrder.end()))
+				std::sort(m_SpriteOrder.begin(), m_SpriteOrder.end());
+
+			const u32 visibleCount = static_cast<u32>(m_SpriteOrder.size());
+			m_SpriteSlots.resize(visibleCount);
+
+			AtlasRegion* lastRegion = nullptr;
+			float lastSlot = 0.0f;
+			u32 dropped = 0;
+
+			for (u32 p = 0; p < visibleCount; p++)
+			{
+				auto& item = m_SpriteItems[m_SpriteOrder[p].second];
+				Texture* texture = item.region ? item.region->texture : nullptr;
+
+				if (m_SpriteBatches.empty() || m_SpriteBatches.back().count >= m_Limits.MaxQuads)
+				{
+					if (m_SpriteBatches.size() >= m_Limits.MaxBatchDrawCalls)
+					{
+						dropped = visibleCount - p;
+						break;
+					}
+
+					m_SpriteBatches.push_back({ p, 0, {}, nullptr });
+					lastRegion = nullptr;
+				}
+
+				if (texture && item.region != lastRegion)
+				{
+					item.region->lastUsedFrame = m_FrameIndex;
+
+					auto* batch = &m_SpriteBatches.back();
+					auto it = std::find(batch->textures.begin(), batch->textures.end(), texture);
+					if (it == batch->textures.end())
+					{
+						if (batch->textures.size() >= m_Limits.MaxTextures)
+						{
+							if (m_SpriteBatches.size() >= m_Limits.MaxBatchDrawCalls)
+							{
+								dropped = visibleCount - p;
+								break;
+							}
+
+							m_SpriteBatches.push_back({ p, 0, {}, nullptr });
+							batch = &m_SpriteBatches.back();
+						}
+
+						batch->textures.push_back(texture);
+						it = batch->textures.end() - 1;
+					}
+
+					lastRegion = item.region;
+					lastSlot = static_cast<float>(it - batch->textures.begin() + 1);
+				}
+
+				m_SpriteSlots[p] = texture ? lastSlot : 0.0f;
+				m_SpriteBatches.back().count++;
+			}
+
+			if (dropped > 0)
+				LUMOS_LOG_WARN("Renderer2D batch limit reached, {0} sprites dropped", dropped);
+
+			for (u32 b = 0; b < static_cast<u32>(m_SpriteBatches.size()); b++)
+			{
+				auto& batch = m_SpriteBatches[b];
+				batch.vertices = GetVertexArray(b)->GetBuffer()->GetPointer<VertexData>();
+
+				for (u32 begin = batch.first; begin < batch.first + batch.count; begin += RENDERER2D_SPRITE_JOB_SIZE)
+					m_SpriteJobs.push_back({ b, begin, Maths::Min(begin + RENDERER2D_SPRITE_JOB_SIZE, batch.first + batch.count) });
+			}
+
+			System::JobSystem::Dispatch(static_cast<u32>(m_SpriteJobs.size()), 1, [&](JobDispatchArgs args)
+			{
+				const auto& job = m_SpriteJobs[args.jobIndex];
+				const auto& batch = m_SpriteBatches[job.batch];
+				VertexData* buffer = batch.vertices + (job.begin - batch.first) * 4;
+
+				for (u32 p = job.begin; p < job.end; p++)
+				{
+					const auto& item = m_SpriteItems[m_SpriteOrder[p].second];
+					buffer = WriteSpriteVertices(buffer, item.corners, item.sprite, item.region, m_SpriteSlots[p]);
+				}
+			});
+
+			System::JobSystem::Wait();
+
+			m_BuildTime = timer.GetMS(1000.0f);
+		}
+
 		float Renderer2D::SubmitTexture(Texture* texture)
 		{
 			float result = 0.0f;
@@ -474,7 +755,7 @@ namespace Lumos
 			std::vector<Graphics::DescriptorPoolInfo> poolInfo =
 			{
 				{ Graphics::DescriptorType::UNIFORM_BUFFER, m_Limits.MaxBatchDrawCalls },
-				{ Graphics::DescriptorType::IMAGE_SAMPLER, m_Limits.MaxBatchDrawCalls }
+				{ Graphics::DescriptorType::IMAGE_SAMPLER, (m_Limits.MaxBatchDrawCalls + RENDERER2D_MAX_STATIC_BATCHES) * m_Limits.MaxTextures }
 			};
 
 			std::vector<Graphics::DescriptorLayoutInfo> layoutInfo =
@@ -518,7 +799,7 @@ namespace Lumos
 			pipelineCI.cullMode = Graphics::CullMode::BACK;
 			pipelineCI.transparencyEnabled = true;
 			pipelineCI.depthBiasEnabled = false;
-			pipelineCI.maxObjects = m_Limits.MaxBatchDrawCalls;
+			pipelineCI.maxObjects = m_Limits.MaxBatchDrawCalls + RENDERER2D_MAX_STATIC_BATCHES;
 
 			m_Pipeline = Graphics::Pipeline::Create(pipelineCI);
 		}
@@ -563,7 +844,7 @@ namespace Lumos
 			}
 		}
 
-		void Renderer2D::UpdateDesciptorSet() const
+		void Renderer2D::UpdateDesciptorSet()
 		{
 			if (m_Textures.empty())
 				return;
@@ -578,7 +859,7 @@ namespace Lumos
 
 			imageInfos.push_back(imageInfo);
 
-			m_DescriptorSet->Update(imageInfos);
+			GetDescriptorSet(m_BatchDrawCallIndex)->Update(imageInfos);
 		}
 
 		void Renderer2D::SetRenderTarget(Texture* texture)
@@ -615,8 +896,8 @@ namespace Lumos
             m_Sprites.clear();
             m_Triangles.clear();
             
-            m_VertexArrays[m_BatchDrawCallIndex]->Bind();
-            m_Buffer = m_VertexArrays[m_BatchDrawCallIndex]->GetBuffer()->GetPointer<VertexData>();
+            GetVertexArray(m_BatchDrawCallIndex)->Bind();
+            m_Buffer = GetVertexArray(m_BatchDrawCallIndex)->GetBuffer()->GetPointer<VertexData>();
         }
     
         void Renderer2D::SubmitTriangles()
@@ -624,5 +905,331 @@ namespace Lumos
             for(auto& triangle : m_Triangles)
                 SubmitInternal(triangle);
         }
+
+		u64 Renderer2D::GetStaticChunkKey(const Maths::Vector3& position) const
+		{
+			const i32 x = static_cast<i32>(floor(position.x / m_StaticChunkSize));
+			const i32 y = static_cast<i32>(floor(position.y / m_StaticChunkSize));
+			return (u64(u32(x)) << 32) | u64(u32(y));
+		}
+
+		void Renderer2D::SetStaticChunkSize(float size)
+		{
+			m_StaticChunkSize = Maths::Max(size, 0.01f);
+			InvalidateStaticChunks();
+		}
+
+		void Renderer2D::InvalidateStaticChunks()
+		{
+			for (auto& [key, chunk] : m_StaticChunks)
+				ClearStaticChunk(chunk);
+
+			m_StaticChunks.clear();
+			m_StaticSprites.clear();
+			m_VisibleChunks.clear();
+			m_RebakeAllStatic = true;
+		}
+
+		void Renderer2D::ClearStaticChunk(StaticChunk& chunk)
+		{
+			for (auto& batch : chunk.batches)
+			{
+				delete batch.vertexArray;
+				delete batch.descriptorSet;
+			}
+
+			m_StaticBatchCount -= static_cast<u32>(chunk.batches.size());
+			chunk.batches.clear();
+			chunk.regions.clear();
+		}
+
+		void Renderer2D::UpdateStaticChunks(entt::registry& registry, u32 staticCount)
+		{
+			LUMOS_PROFILE_FUNC;
+
+			auto removeSprite = [&](entt::entity entity, u64 key)
+			{
+				auto chunkIt = m_StaticChunks.find(key);
+				if (chunkIt == m_StaticChunks.end())
+					return;
+
+				auto& sprites = chunkIt->second.sprites;
+				auto it = std::find(sprites.begin(), sprites.end(), entity);
+				if (it != sprites.end())
+				{
+					*it = sprites.back();
+					sprites.pop_back();
+				}
+
+				chunkIt->second.dirty = true;
+			};
+
+			for (auto& dirtySprites : m_DirtySprites)
+			{
+				for (auto entity : dirtySprites)
+				{
+					auto& sprite = registry.get<Graphics::Sprite>(entity);
+					auto& transform = registry.get<Maths::Transform>(entity);
+
+					sprite.SetDirty(false);
+
+					auto existing = m_StaticSprites.find(entity);
+
+					if (!sprite.GetStatic())
+					{
+						if (existing != m_StaticSprites.end())
+						{
+							removeSprite(entity, existing->second);
+							m_StaticSprites.erase(existing);
+						}
+						continue;
+					}
+
+					transform.SetHasUpdated(false);
+
+					Maths::Vector3 corners[4];
+					GetSpriteCorners(sprite, transform.GetWorldMatrix(), corners);
+					const u64 key = GetStaticChunkKey(corners[0]);
+
+					if (existing != m_StaticSprites.end())
+					{
+						if (existing->second == key)
+						{
+							m_StaticChunks[key].dirty = true;
+							continue;
+						}
+
+						removeSprite(entity, existing->second);
+						existing->second = key;
+					}
+					else
+						m_StaticSprites.emplace(entity, key);
+
+					auto& chunk = m_StaticChunks[key];
+					chunk.sprites.push_back(entity);
+					chunk.dirty = true;
+				}
+
+				dirtySprites.clear();
+			}
+
+			// Fewer static sprites than tracked means some were destroyed or lost their sprite
+			if (m_StaticSprites.size() != staticCount)
+			{
+				for (auto it = m_StaticSprites.begin(); it != m_StaticSprites.end();)
+				{
+					const entt::entity entity = it->first;
+					if (registry.valid(entity) && registry.has<Graphics::Sprite, Maths::Transform>(entity) && registry.get<Graphics::Sprite>(entity).GetStatic())
+					{
+						++it;
+						continue;
+					}
+
+					removeSprite(entity, it->second);
+					it = m_StaticSprites.erase(it);
+				}
+			}
+
+			m_StaticBakeCount = 0;
+			m_VisibleChunks.clear();
+
+			for (auto it = m_StaticChunks.begin(); it != m_StaticChunks.end();)
+			{
+				auto& chunk = it->second;
+
+				if (chunk.dirty)
+				{
+					ClearStaticChunk(chunk);
+
+					if (chunk.sprites.empty())
+					{
+						it = m_StaticChunks.erase(it);
+						continue;
+					}
+
+					BakeStaticChunk(registry, chunk);
+					m_StaticBakeCount++;
+				}
+
+				if (m_Frustum.IsInside(chunk.bounds) != Maths::Intersection::OUTSIDE)
+					m_VisibleChunks.push_back(&chunk);
+
+				++it;
+			}
+		}
+
+		void Renderer2D::BakeStaticChunk(entt::registry& registry, StaticChunk& chunk)
+		{
+			LUMOS_PROFILE_FUNC;
+			const u32 spriteCount = static_cast<u32>(chunk.sprites.size());
+
+			std::vector<SpriteItem> items(spriteCount);
+			std::vector<std::pair<u64, u32>> order;
+			order.reserve(spriteCount);
+
+			chunk.bounds.Clear();
+
+			for (u32 i = 0; i < spriteCount; i++)
+			{
+				auto& sprite = registry.get<Graphics::Sprite>(chunk.sprites[i]);
+				const Maths::Matrix4& world = registry.get<Maths::Transform>(chunk.sprites[i]).GetWorldMatrix();
+
+				auto& item = items[i];
+				GetSpriteCorners(sprite, world, item.corners);
+				item.sprite = &sprite;
+				item.layer = world.m23_;
+				item.region = sprite.GetTexture() ? m_TextureAtlas.Add(sprite.GetTextureRef()) : nullptr;
+
+				for (u32 v = 0; v < 4; v++)
+					chunk.bounds.Merge(item.corners[v]);
+
+				const u64 textureKey = item.region ? item.region->sortID : 0;
+				order.emplace_back((u64(LayerSortKey(item.layer)) << 32) | textureKey, i);
+			}
+
+			m_TextureAtlas.Upload();
+
+			std::sort(order.begin(), order.end());
+
+			Graphics::BufferLayout layout;
+			layout.Push<Maths::Vector3>("POSITION"); // Position
+			layout.Push<Maths::Vector2>("TEXCOORD"); // UV
+			layout.Push<Maths::Vector2>("ID"); // Texture Index
+			layout.Push<Maths::Vector4>("COLOUR"); // Colour
+
+			std::vector<VertexData> vertices;
+			std::vector<Texture*> textures;
+
+			auto flush = [&]()
+			{
+				if (vertices.empty())
+					return;
+
+				if (m_StaticBatchCount >= RENDERER2D_MAX_STATIC_BATCHES)
+				{
+					LUMOS_LOG_WARN("Renderer2D static batch limit reached, static sprites dropped");
+					vertices.clear();
+					textures.clear();
+					return;
+				}
+
+				StaticBatch batch;
+				batch.count = static_cast<u32>(vertices.size() / 4);
+
+				batch.vertexArray = Graphics::VertexArray::Create();
+				batch.vertexArray->Bind();
+				VertexBuffer* buffer = VertexBuffer::Create(BufferUsage::STATIC);
+				buffer->SetData(static_cast<u32>(vertices.size() * sizeof(VertexData)), vertices.data());
+				buffer->SetLayout(layout);
+				batch.vertexArray->PushBuffer(buffer);
+				batch.vertexArray->Unbind();
+
+				Graphics::DescriptorInfo info{};
+				info.pipeline = m_Pipeline;
+				info.layoutIndex = 1;
+				info.shader = m_Shader;
+				batch.descriptorSet = Graphics::DescriptorSet::Create(info);
+
+				if (!textures.empty())
+				{
+					std::vector<Graphics::ImageInfo> imageInfos;
+
+					Graphics::ImageInfo imageInfo = {};
+					imageInfo.binding = 0;
+					imageInfo.name = "textures";
+					imageInfo.texture = textures;
+					imageInfo.count = static_cast<int>(textures.size());
+					imageInfos.push_back(imageInfo);
+
+					batch.descriptorSet->Update(imageInfos);
+				}
+
+				chunk.batches.push_back(batch);
+				m_StaticBatchCount++;
+
+				vertices.clear();
+				textures.clear();
+			};
+
+			vertices.reserve(spriteCount * 4);
+
+			for (auto& [key, index] : order)
+			{
+				const auto& item = items[index];
+				Texture* texture = item.region ? item.region->texture : nullptr;
+
+				if (vertices.size() / 4 >= m_Limits.MaxQuads)
+					flush();
+
+				float slot = 0.0f;
+				if (texture)
+				{
+					auto it = std::find(textures.begin(), textures.end(), texture);
+					if (it == textures.end())
+					{
+						if (textures.size() >= m_Limits.MaxTextures)
+							flush();
+
+						textures.push_back(texture);
+						it = textures.end() - 1;
+					}
+
+					slot = static_cast<float>(it - textures.begin() + 1);
+
+					if (std::find(chunk.regions.begin(), chunk.regions.end(), item.region) == chunk.regions.end())
+						chunk.regions.push_back(item.region);
+				}
+
+				vertices.resize(vertices.size() + 4);
+				WriteSpriteVertices(&vertices[vertices.size() - 4], item.corners, item.sprite, item.region, slot);
+			}
+
+			flush();
+			chunk.dirty = false;
+		}
+
+		void Renderer2D::DrawStaticChunks()
+		{
+			if (m_VisibleChunks.empty())
+				return;
+
+			Graphics::CommandBuffer* commandBuffer = m_StaticCommandBuffer;
+
+			commandBuffer->BeginRecordingSecondary(m_RenderPass, m_Framebuffers[m_CurrentBufferID]);
+			commandBuffer->UpdateViewport(m_ScreenBufferWidth, m_ScreenBufferHeight);
+			m_Pipeline->SetActive(commandBuffer);
+
+			for (auto chunk : m_VisibleChunks)
+			{
+				for (auto& batch : chunk->batches)
+				{
+					std::vector<Graphics::DescriptorSet*> descriptors = { m_Pipeline->GetDescriptorSet(), batch.descriptorSet };
+
+					batch.vertexArray->Bind(commandBuffer);
+					m_IndexBuffer->SetCount(batch.count * 6);
+					m_IndexBuffer->Bind(commandBuffer);
+
+					Renderer::BindDescriptorSets(m_Pipeline, commandBuffer, 0, descriptors);
+					Renderer::DrawIndexed(commandBuffer, DrawType::TRIANGLE, batch.count * 6);
+
+					batch.vertexArray->Unbind();
+					m_IndexBuffer->Unbind();
+				}
+			}
+
+			commandBuffer->EndRecording();
+			commandBuffer->ExecuteSecondary(m_CommandBuffers[m_CurrentBufferID]);
+		}
+
+		void Renderer2D::OnImGui()
+		{
+			ImGui::TextUnformatted("Renderer2D");
+			ImGui::Text("Sprites : %u (%u visible)", m_SpriteCount, static_cast<u32>(m_SpriteOrder.size()));
+			ImGui::Text("Batches : %u", static_cast<u32>(m_SpriteBatches.size()));
+			ImGui::Text("Static Chunks : %u (%u visible, %u batches)", static_cast<u32>(m_StaticChunks.size()), static_cast<u32>(m_VisibleChunks.size()), m_StaticBatchCount);
+			ImGui::Text("Static Sprites : %u (%u chunks rebaked)", static_cast<u32>(m_StaticSprites.size()), m_StaticBakeCount);
+			ImGui::Text("Build Time : %.3f ms", m_BuildTime);
+			m_TextureAtlas.OnImGui();
+		}
 	}
 }
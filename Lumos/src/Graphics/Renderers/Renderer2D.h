@@ -2,8 +2,16 @@
 #include "lmpch.h"
 #include "Graphics/Renderable2D.h"
 #include "Graphics/API/BufferLayout.h"
+#include "Graphics/TextureAtlas.h"
 #include "Maths/Maths.h"
 
+#include <entt/entt.hpp>
+
+#define RENDERER2D_MAX_BATCH_QUADS 65536
+#define RENDERER2D_MAX_STATIC_BATCHES 1024
+#define RENDERER2D_SPRITE_JOB_SIZE 4096
+#define RENDERER2D_ATLAS_RETAIN_FRAMES 600
+
 namespace Lumos
 {
 	class Scene;
@@ -91,7 +99,7 @@ namespace Lumos
 
 			void CreateGraphicsPipeline();
 			void CreateFramebuffers();
-			void UpdateDesciptorSet() const;
+			void UpdateDesciptorSet();
         
             void FlushAndReset();
             void SubmitTriangles();
@@ -99,16 +107,81 @@ namespace Lumos
 			Shader* GetShader() const { return m_Shader; }
             void SetCamera(Camera* camera) { m_Camera = camera; }
 
+			void OnImGui();
+
+			// World space size of a static chunk side, 16 units holds 32x32 tiles of half a unit
+			float GetStaticChunkSize() const { return m_StaticChunkSize; }
+			void SetStaticChunkSize(float size);
+
+			// Drops every baked chunk so all static sprites are rebaked next frame
+			void InvalidateStaticChunks();
+
 		private:
         
             void SubmitInternal(const TriangleInfo& triangle);
+
+			// Culls, sorts by layer then texture and writes the vertices of every sprite in the scene.
+			// Culling and vertex generation run on the job system, each job writing its own range.
+			void BuildSpriteBatches(Scene* scene);
+
+			VertexArray* GetVertexArray(u32 index);
+			DescriptorSet* GetDescriptorSet(u32 index);
+
+			struct SpriteItem
+			{
+				Maths::Vector3 corners[4];
+				const Renderable2D* sprite;
+				AtlasRegion* region;
+				float layer;
+				bool visible;
+				bool isStatic;
+			};
+
+			struct SpriteBatch
+			{
+				u32 first;
+				u32 count;
+				std::vector<Texture*> textures;
+				VertexData* vertices;
+			};
+
+			struct SpriteJob
+			{
+				u32 batch;
+				u32 begin;
+				u32 end;
+			};
+
+			struct StaticBatch
+			{
+				VertexArray* vertexArray;
+				DescriptorSet* descriptorSet;
+				u32 count;
+			};
+
+			// Static sprites are grouped spatially into chunks whose vertices stay on the GPU
+			// until one of their sprites changes
+			struct StaticChunk
+			{
+				std::vector<entt::entity> sprites;
+				std::vector<StaticBatch> batches;
+				std::vector<AtlasRegion*> regions;
+				Maths::BoundingBox bounds;
+				bool dirty = true;
+			};
+
+			void UpdateStaticChunks(entt::registry& registry, u32 staticCount);
+			void BakeStaticChunk(entt::registry& registry, StaticChunk& chunk);
+			void ClearStaticChunk(StaticChunk& chunk);
+			void DrawStaticChunks();
+			u64 GetStaticChunkKey(const Maths::Vector3& position) const;
         
 			std::vector<Renderable2D*> m_Sprites;
 			u32 m_ScreenBufferWidth{}, m_ScreenBufferHeight{};
 
 			RenderPass* m_RenderPass{};
 			Pipeline* m_Pipeline{};
-			DescriptorSet* m_DescriptorSet{};
+			std::vector<DescriptorSet*> m_DescriptorSets;
 			UniformBuffer* m_UniformBuffer{};
 			std::vector<CommandBuffer*> m_CommandBuffers;
 			std::vector<CommandBuffer*> m_SecondaryCommandBuffers;
@@ -143,6 +216,28 @@ namespace Lumos
             bool m_RenderToDepthTexture;
             Render2DLimits m_Limits;
             Camera* m_Camera = nullptr;
+
+			TextureAtlas m_TextureAtlas;
+			std::vector<SpriteItem> m_SpriteItems;
+			std::vector<std::pair<u64, u32>> m_SpriteOrder;
+			std::vector<float> m_SpriteSlots;
+			std::vector<SpriteBatch> m_SpriteBatches;
+			std::vector<SpriteJob> m_SpriteJobs;
+			u32 m_FrameIndex = 0;
+			u32 m_SpriteCount = 0;
+			float m_BuildTime = 0.0f;
+
+			std::unordered_map<u64, StaticChunk> m_StaticChunks;
+			std::unordered_map<entt::entity, u64> m_StaticSprites;
+			std::vector<std::vector<entt::entity>> m_DirtySprites;
+			std::vector<u32> m_StaticCounts;
+			std::vector<StaticChunk*> m_VisibleChunks;
+			CommandBuffer* m_StaticCommandBuffer = nullptr;
+			entt::registry* m_StaticRegistry = nullptr;
+			float m_StaticChunkSize = 16.0f;
+			u32 m_StaticBatchCount = 0;
+			u32 m_StaticBakeCount = 0;
+			bool m_RebakeAllStatic = false;
 		};
 	}
 }
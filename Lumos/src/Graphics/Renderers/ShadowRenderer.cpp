@@ -51,7 +51,7 @@ namespace Lumos
 			m_Shader = Shader::CreateFromFile("Shadow", "/CoreShaders/");
 			if (texture == nullptr)
 			{
-				m_ShadowTex = TextureDepthArray::Create(m_ShadowMapSize, m_ShadowMapSize, m_ShadowMapNum);
+				m_ShadowTex = TextureDepthArray::Create(m_ShadowMapSize, m_ShadowMapSize, m_ShadowMapNum * 2);
 				m_DeleteTexture = true;
 			}
 			else
@@ -68,7 +68,7 @@ namespace Lumos
 			if (m_DeleteTexture)
 				delete m_ShadowTex;
 
-			for (u32 i = 0; i < m_ShadowMapNum; ++i)
+			for (u32 i = 0; i < m_ShadowMapNum * 2; ++i)
 			{
 				delete m_ShadowFramebuffer[i];
 			}
@@ -113,6 +113,8 @@ namespace Lumos
 			// Per Scene System Uniforms
 			m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionViewMatrix] = 0;
 
+			InvalidateStaticCache();
+
 			m_RenderPass = Graphics::RenderPass::Create();
 			AttachmentInfo textureTypes[1] =
 			{
@@ -140,7 +142,6 @@ namespace Lumos
 
 		void ShadowRenderer::Begin()
 		{
-			m_CommandQueue.clear();
 			m_CommandBuffer->BeginRecording();
 			m_CommandBuffer->UpdateViewport(m_ShadowMapSize, m_ShadowMapSize);
 		}
@@ -163,15 +164,14 @@ namespace Lumos
 		void ShadowRenderer::Present()
 		{
 			LUMOS_PROFILE_FUNC;
-			int index = 0;
 
 			m_RenderPass->BeginRenderpass(m_CommandBuffer, Maths::Vector4(0.0f), m_ShadowFramebuffer[m_Layer], Graphics::INLINE, m_ShadowMapSize, m_ShadowMapSize);
 
 			m_Pipeline->SetActive(m_CommandBuffer);
 
-			for (auto& command : m_CommandQueue)
+			for (auto index : m_LayerCommands[m_Layer])
 			{
-				Mesh* mesh = command.mesh;
+				Mesh* mesh = m_CommandQueue[index].mesh;
 
 				const uint32_t dynamicOffset = index * static_cast<uint32_t>(m_DynamicAlignment);
 
@@ -186,7 +186,7 @@ namespace Lumos
 				mesh->GetVertexArray()->Unbind();
 				mesh->GetIndexBuffer()->Unbind();
 
-				index++;
+				m_DrawCount++;
 			}
 
 			m_RenderPass->EndRenderpass(m_CommandBuffer);
@@ -209,56 +209,244 @@ namespace Lumos
 			m_ShadowMapSize = size;
 		}
 
+		void ShadowRenderer::InvalidateStaticCache()
+		{
+			m_ForceStaticUpdate = true;
+
+			for (u32 i = 0; i < SHADOWMAP_MAX; i++)
+			{
+				m_StaticCacheDirty[i] = true;
+				m_DynamicLayerEmpty[i] = false;
+				m_StaticRefreshFrame[i] = 0;
+			}
+		}
+
+		u32 ShadowRenderer::GetCascadeUpdateInterval(u32 cascade) const
+		{
+			// The two nearest cascades update every frame, then every 2, 4, 8... frames
+			if (!m_StaggerUpdates || cascade < 2)
+				return 1;
+
+			return 1u << Maths::Min(cascade - 1, 4u);
+		}
+
+		static bool CasterInCascade(const Maths::Matrix4& projView, const Maths::BoundingBox& bounds)
+		{
+			// Only the light space xy extent matters, casters in front of the near plane still cast
+			float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+
+			for (u32 c = 0; c < 8; c++)
+			{
+				Maths::Vector4 corner = Maths::Vector4(
+					(c & 1) ? bounds.max_.x : bounds.min_.x,
+					(c & 2) ? bounds.max_.y : bounds.min_.y,
+					(c & 4) ? bounds.max_.z : bounds.min_.z,
+					1.0f);
+
+				Maths::Vector4 clip = projView * corner;
+
+				minX = Maths::Min(minX, clip.x);
+				maxX = Maths::Max(maxX, clip.x);
+				minY = Maths::Min(minY, clip.y);
+				maxY = Maths::Max(maxY, clip.y);
+			}
+
+			return !(maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f);
+		}
+
+		void ShadowRenderer::MarkCascadesDirty(const Maths::BoundingBox& bounds)
+		{
+			for (u32 i = 0; i < m_ShadowMapNum; i++)
+			{
+				if (!m_StaticCacheDirty[i] && CasterInCascade(m_ShadowProjView[i], bounds))
+					m_StaticCacheDirty[i] = true;
+			}
+		}
+
+		void ShadowRenderer::UpdateCasters(Scene* scene)
+		{
+			LUMOS_PROFILE_FUNC;
+			auto& registry = scene->GetRegistry();
+			auto group = registry.group<MeshComponent>(entt::get<Maths::Transform>);
+
+			m_DynamicCasterCount = 0;
+
+			for (auto entity : group)
+			{
+				const auto &[mesh, trans] = group.get<MeshComponent, Maths::Transform>(entity);
+
+				if (!mesh.GetMesh() || !mesh.GetMesh()->GetActive())
+					continue;
+
+				if (m_CommandQueue.size() >= MAX_OBJECTS)
+					break;
+
+				auto& worldTransform = trans.GetWorldMatrix();
+				auto it = m_Casters.find(entity);
+
+				if (it == m_Casters.end())
+				{
+					// New casters start out dynamic so spawning objects don't flush the cache
+					ShadowCaster caster;
+					caster.transform = worldTransform;
+					caster.bounds = mesh.GetMesh()->GetBoundingBox()->Transformed(worldTransform);
+					it = m_Casters.emplace(entity, caster).first;
+				}
+				else
+				{
+					auto& caster = it->second;
+
+					if (!(caster.transform == worldTransform))
+					{
+						// Started moving, remove it from the static layers it was baked into
+						if (!caster.dynamic)
+							MarkCascadesDirty(caster.bounds);
+
+						caster.dynamic = true;
+						caster.stillFrames = 0;
+						caster.transform = worldTransform;
+						caster.bounds = mesh.GetMesh()->GetBoundingBox()->Transformed(worldTransform);
+					}
+					else if (caster.dynamic && ++caster.stillFrames >= SHADOW_CACHE_STATIC_FRAMES)
+					{
+						caster.dynamic = false;
+						caster.staticSinceFrame = m_FrameIndex;
+						MarkCascadesDirty(caster.bounds);
+					}
+				}
+
+				auto& caster = it->second;
+				caster.lastSeenFrame = m_FrameIndex;
+				caster.commandIndex = static_cast<u32>(m_CommandQueue.size());
+
+				if (caster.dynamic)
+					m_DynamicCasterCount++;
+
+				SubmitMesh(mesh.GetMesh(), nullptr, worldTransform, Maths::Matrix4());
+			}
+
+			// Destroyed or deactivated casters
+			for (auto it = m_Casters.begin(); it != m_Casters.end();)
+			{
+				if (it->second.lastSeenFrame != m_FrameIndex)
+				{
+					if (!it->second.dynamic)
+						MarkCascadesDirty(it->second.bounds);
+
+					it = m_Casters.erase(it);
+				}
+				else
+					++it;
+			}
+		}
+
 		void ShadowRenderer::RenderScene(Scene* scene)
 		{
 			LUMOS_PROFILE_FUNC;
 
-			memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionViewMatrix], m_ShadowProjView, sizeof(Maths::Matrix4) * SHADOWMAP_MAX);
+			m_FrameIndex++;
+			m_CommandQueue.clear();
+
+			if (m_ShadowMapsInvalidated || !m_CachingEnabled)
+			{
+				InvalidateStaticCache();
+				m_ShadowMapsInvalidated = false;
+			}
+
+			UpdateCasters(scene);
+
+			bool refreshStatic[SHADOWMAP_MAX];
 
-			Begin();
-            
-            auto& registry = scene->GetRegistry();
-                                    
-            auto group = registry.group<MeshComponent>(entt::get<Maths::Transform>);
-            
 			for (u32 i = 0; i < m_ShadowMapNum; ++i)
 			{
-				m_Layer = i;
+				bool boundsChanged = !(m_CascadeProjView[i] == m_ShadowProjView[i]);
+				bool scheduled = (m_FrameIndex + i) % GetCascadeUpdateInterval(i) == 0;
 
-				Maths::Frustum f;
-				f.Define(m_ShadowProjView[i]);
+				refreshStatic[i] = m_ForceStaticUpdate || ((boundsChanged || m_StaticCacheDirty[i]) && scheduled);
 
-                for(auto entity : group)
-                {
-                    const auto &[mesh, trans] = group.get<MeshComponent, Maths::Transform>(entity);
+				if (refreshStatic[i])
+				{
+					// The dynamic layer is always rendered with the same matrix as the static layer
+					if (boundsChanged)
+						m_DynamicLayerEmpty[i] = false;
 
-                    if (mesh.GetMesh() && mesh.GetMesh()->GetActive())
-                    {
-                        auto& worldTransform = trans.GetWorldMatrix();
+					m_ShadowProjView[i] = m_CascadeProjView[i];
+					m_StaticCacheDirty[i] = false;
+					m_StaticRefreshFrame[i] = m_FrameIndex;
+				}
+			}
 
-						auto bb = mesh.GetMesh()->GetBoundingBox();
-						auto bbCopy = bb->Transformed(worldTransform);
-						auto inside = f.IsInsideFast(bbCopy);
+			m_ForceStaticUpdate = false;
 
-						//Todo fix for open
-						//if (inside == Maths::Intersection::OUTSIDE)
-						//	continue;
-            
-                        SubmitMesh(mesh.GetMesh(), nullptr, worldTransform, Maths::Matrix4());
-					}
-                }
+			for (u32 i = 0; i < m_ShadowMapNum * 2; ++i)
+				m_LayerCommands[i].clear();
 
-				SetSystemUniforms(m_Shader);
+			for (auto& [entity, caster] : m_Casters)
+			{
+				// With caching off everything goes through the static layers every frame
+				bool dynamic = caster.dynamic && m_CachingEnabled;
 
-				u32 layer = static_cast<u32>(m_Layer);
-				memcpy(m_PushConstant->data, &layer, sizeof(u32));
+				for (u32 i = 0; i < m_ShadowMapNum; ++i)
+				{
+					// Newly static casters stay in the dynamic layer until the cascade has baked them
+					bool dynamicLayer = dynamic || m_StaticRefreshFrame[i] < caster.staticSinceFrame;
+
+					if (!dynamicLayer && !refreshStatic[i])
+						continue;
+
+					if (CasterInCascade(m_ShadowProjView[i], caster.bounds))
+						m_LayerCommands[dynamicLayer ? m_ShadowMapNum + i : i].push_back(caster.commandIndex);
+				}
+			}
+
+			m_StaticLayersRendered = 0;
+			m_DynamicLayersRendered = 0;
+			m_DrawCount = 0;
+
+			bool renderLayer[SHADOWMAP_MAX * 2];
+			bool anyLayer = false;
+
+			for (u32 i = 0; i < m_ShadowMapNum; ++i)
+			{
+				renderLayer[i] = refreshStatic[i];
+
+				// Empty dynamic layers only need clearing once
+				bool dynamicEmpty = m_LayerCommands[m_ShadowMapNum + i].empty();
+				renderLayer[m_ShadowMapNum + i] = !dynamicEmpty || !m_DynamicLayerEmpty[i];
+				m_DynamicLayerEmpty[i] = dynamicEmpty;
+
+				anyLayer |= renderLayer[i] || renderLayer[m_ShadowMapNum + i];
+			}
+
+			if (!anyLayer)
+				return;
+
+			memcpy(m_VSSystemUniformBuffer + m_VSSystemUniformBufferOffsets[VSSystemUniformIndex_ProjectionViewMatrix], m_ShadowProjView, sizeof(Maths::Matrix4) * SHADOWMAP_MAX);
+			SetSystemUniforms(m_Shader);
+
+			Begin();
+
+			for (u32 i = 0; i < m_ShadowMapNum * 2; ++i)
+			{
+				if (!renderLayer[i])
+					continue;
+
+				m_Layer = i;
+
+				u32 cascade = i % m_ShadowMapNum;
+				memcpy(m_PushConstant->data, &cascade, sizeof(u32));
 				std::vector<Graphics::PushConstant> pcVector;
 				pcVector.push_back(*m_PushConstant);
 				m_Pipeline->GetDescriptorSet()->SetPushConstants(pcVector);
 
 				Present();
 
+				if (i < m_ShadowMapNum)
+					m_StaticLayersRendered++;
+				else
+					m_DynamicLayersRendered++;
 			}
+
 			End();
 		}
 
@@ -362,19 +550,31 @@ namespace Lumos
 				//Extend the Z depths to catch shadow casters outside view frustum
 				radius = Maths::Max(radius, sceneBoundingRadius);
 
+				// Snap the centre to whole texel steps in light space so the cascade matrix only changes in
+				// discrete increments, padding the radius by one step to keep the frustum slice covered
+				float snapStep = 2.0f * radius / float(m_ShadowMapSize) * float(SHADOW_CACHE_SNAP_TEXELS);
+				radius += snapStep;
+
 				Maths::Vector3 maxExtents = Maths::Vector3(radius);
 				Maths::Vector3 minExtents = -maxExtents;
 
 				Maths::Vector3 lightDir = -light->m_Direction.ToVector3();
 				lightDir.Normalize();
 				Maths::Matrix4 lightViewMatrix = Maths::Quaternion::LookAt(frustumCenter - lightDir * -minExtents.z, frustumCenter).RotationMatrix4();
+
+				Maths::Vector4 lightSpaceCenter = lightViewMatrix.Inverse() * Maths::Vector4(frustumCenter, 1.0f);
+				lightSpaceCenter.x = std::floor(lightSpaceCenter.x / snapStep) * snapStep;
+				lightSpaceCenter.y = std::floor(lightSpaceCenter.y / snapStep) * snapStep;
+				lightSpaceCenter.z = std::floor(lightSpaceCenter.z / snapStep) * snapStep;
+				frustumCenter = (lightViewMatrix * lightSpaceCenter).ToVector3();
+
                 lightViewMatrix.SetTranslation(frustumCenter);
 
 				Maths::Matrix4 lightOrthoMatrix = Maths::Matrix4::Orthographic(minExtents.x, maxExtents.x, minExtents.y, maxExtents.y, -(maxExtents.z - minExtents.z), maxExtents.z - minExtents.z);
 
 				// Store split distance and matrix in cascade
 				m_SplitDepth[i] = Maths::Vector4((m_Camera->GetNear() + splitDist * clipRange) * -1.0f);
-				m_ShadowProjView[i] = lightOrthoMatrix * lightViewMatrix.Inverse();
+				m_CascadeProjView[i] = lightOrthoMatrix * lightViewMatrix.Inverse();
 			}
 #ifdef THREAD_CASCADE_GEN
 			);
@@ -388,7 +588,7 @@ namespace Lumos
 			{
 				m_ShadowMapsInvalidated = false;
 
-				for (u32 i = 0; i < m_ShadowMapNum; ++i)
+				for (u32 i = 0; i < m_ShadowMapNum * 2; ++i)
 				{
 					const u32 attachmentCount = 1;
 					TextureType attachmentTypes[attachmentCount];
@@ -452,6 +652,7 @@ namespace Lumos
 			pipelineCI.transparencyEnabled = false;
 			pipelineCI.depthBiasEnabled = true;
 			pipelineCI.maxObjects = MAX_OBJECTS;
+			pipelineCI.pushConstants = { *m_PushConstant };
 
 			m_Pipeline = Graphics::Pipeline::Create(pipelineCI);
 		}
@@ -534,6 +735,14 @@ namespace Lumos
 		void ShadowRenderer::OnImGui()
 		{
 			ImGui::TextUnformatted("Shadow Renderer");
+
+			if (ImGui::Checkbox("Cache Static Casters", &m_CachingEnabled))
+				InvalidateStaticCache();
+			ImGui::Checkbox("Stagger Distant Cascades", &m_StaggerUpdates);
+			ImGui::Text("Casters : %u (%u dynamic)", static_cast<u32>(m_Casters.size()), m_DynamicCasterCount);
+			ImGui::Text("Layers Rendered : %u static, %u dynamic", m_StaticLayersRendered, m_DynamicLayersRendered);
+			ImGui::Text("Draw Calls : %u", m_DrawCount);
+
 			if (ImGui::TreeNode("Texture"))
 			{
 				static int index = 0;
@@ -541,7 +750,7 @@ namespace Lumos
 				ImGui::InputInt("Texture Array Index", &index);
 
 				index = Maths::Max(0, index);
-				index = Maths::Min(index, 3);
+				index = Maths::Min(index, int(m_ShadowMapNum * 2) - 1);
 				bool flipImage = Graphics::GraphicsContext::GetContext()->FlipImGUITexture();
 
 				ImGui::Image(m_ShadowTex->GetHandleArray(u32(index)), ImVec2(128, 128), ImVec2(0.0f, flipImage ? 1.0f : 0.0f), ImVec2(1.0f, flipImage ? 0.0f : 1.0f));
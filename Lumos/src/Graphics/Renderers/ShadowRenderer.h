@@ -6,6 +6,11 @@
 #include <entt/entt.hpp>
 #define SHADOWMAP_MAX 16
 
+// Cascade centres are snapped to this many texels so cached layers stay valid while the camera moves
+#define SHADOW_CACHE_SNAP_TEXELS 8
+// Frames a caster must stay still before it is baked back into the static layers
+#define SHADOW_CACHE_STATIC_FRAMES 60
+
 namespace Lumos
 {
 	class RenderList;
@@ -28,6 +33,10 @@ namespace Lumos
 
 		typedef std::vector<RenderCommand> CommandQueue;
 
+		// Cascaded shadow maps with cached static layers. The depth array holds 2 * numMaps layers:
+		// [0, numMaps) static casters, only re-rendered when the cascade bounds, light or static casters
+		// change, and [numMaps, 2 * numMaps) moving casters, re-rendered every frame. Lighting takes the
+		// nearest depth of the two. Distant cascades refresh their static layer on a staggered schedule.
 		class LUMOS_EXPORT ShadowRenderer : public Renderer3D
 		{
 		public:
@@ -80,6 +89,7 @@ namespace Lumos
 			void CreateFramebuffers();
 			void CreateUniformBuffer();
 			void UpdateCascades(Scene* scene);
+			void InvalidateStaticCache();
 
 			void SetLightEntity(entt::entity entity) { m_LightEntity = entity; }
 
@@ -88,13 +98,28 @@ namespace Lumos
 		protected:
 
 			void SetSystemUniforms(Shader* shader);
+			void UpdateCasters(Scene* scene);
+			void MarkCascadesDirty(const Maths::BoundingBox& bounds);
+			u32 GetCascadeUpdateInterval(u32 cascade) const;
+
+			struct ShadowCaster
+			{
+				Maths::Matrix4 transform;
+				Maths::BoundingBox bounds;
+				u32 stillFrames = 0;
+				u32 lastSeenFrame = 0;
+				u32 commandIndex = 0;
+				u32 staticSinceFrame = 0;
+				bool dynamic = true;
+			};
 
 			TextureDepthArray* m_ShadowTex;
 			u32		        m_ShadowMapNum;
 			u32		        m_ShadowMapSize;
 			bool		    m_ShadowMapsInvalidated;
-			Framebuffer*    m_ShadowFramebuffer[SHADOWMAP_MAX]{};
+			Framebuffer*    m_ShadowFramebuffer[SHADOWMAP_MAX * 2]{};
 			Maths::Matrix4	m_ShadowProjView[SHADOWMAP_MAX];
+			Maths::Matrix4	m_CascadeProjView[SHADOWMAP_MAX];
 			Maths::Vector4  m_SplitDepth[SHADOWMAP_MAX];
 			Graphics::PushConstant* m_PushConstant = nullptr;
 			bool			m_DeleteTexture = false;
@@ -107,6 +132,21 @@ namespace Lumos
 
 			u32 m_Layer = 0;
 
+			std::unordered_map<entt::entity, ShadowCaster> m_Casters;
+			std::vector<u32> m_LayerCommands[SHADOWMAP_MAX * 2];
+			bool m_StaticCacheDirty[SHADOWMAP_MAX];
+			u32 m_StaticRefreshFrame[SHADOWMAP_MAX];
+			bool m_DynamicLayerEmpty[SHADOWMAP_MAX];
+			bool m_ForceStaticUpdate = true;
+			bool m_CachingEnabled = true;
+			bool m_StaggerUpdates = true;
+			u32 m_FrameIndex = 0;
+
+			u32 m_StaticLayersRendered = 0;
+			u32 m_DynamicLayersRendered = 0;
+			u32 m_DrawCount = 0;
+			u32 m_DynamicCasterCount = 0;
+
 			size_t m_DynamicAlignment = 0;
 			UniformBufferModel uboDataDynamic;
 		};
@@ -42,6 +42,7 @@ namespace Lumos
             Maths::Vector2 max = {((index.x + spriteSize.x) * cellSize.x) / texture->GetWidth() , ((index.y+ spriteSize.y) * cellSize.y) / texture->GetHeight() };
             
             m_UVs = GetUVs(min, max);
+            m_Dirty = true;
         }
 
 		void Sprite::OnImGui()
@@ -54,7 +55,8 @@ namespace Lumos
 			ImGui::TextUnformatted("Position");
 			ImGui::NextColumn();
 			ImGui::PushItemWidth(-1);
-			ImGui::InputFloat2("##Position", Maths::ValuePointer(m_Position));
+			if (ImGui::InputFloat2("##Position", Maths::ValuePointer(m_Position)))
+				m_Dirty = true;
 
 			ImGui::PopItemWidth();
 			ImGui::NextColumn();
@@ -63,7 +65,8 @@ namespace Lumos
 			ImGui::TextUnformatted("Scale");
 			ImGui::NextColumn();
 			ImGui::PushItemWidth(-1);
-			ImGui::InputFloat2("##Scale", Maths::ValuePointer(m_Scale));
+			if (ImGui::InputFloat2("##Scale", Maths::ValuePointer(m_Scale)))
+				m_Dirty = true;
 
 			ImGui::PopItemWidth();
 			ImGui::NextColumn();
@@ -72,7 +75,18 @@ namespace Lumos
 			ImGui::TextUnformatted("Colour");
 			ImGui::NextColumn();
 			ImGui::PushItemWidth(-1);
-			ImGui::ColorEdit4("##Colour", Maths::ValuePointer(m_Colour));
+			if (ImGui::ColorEdit4("##Colour", Maths::ValuePointer(m_Colour)))
+				m_Dirty = true;
+
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Static");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			if (ImGui::Checkbox("##Static", &m_Static))
+				m_Dirty = true;
 
 			ImGui::PopItemWidth();
 			ImGui::NextColumn();
@@ -20,11 +20,23 @@ namespace Lumos
 			Sprite(const Maths::Vector2& position = Maths::Vector2(0.0f,0.0f), const Maths::Vector2& scale = Maths::Vector2(1.0f,1.0f), const Maths::Vector4& colour = Maths::Vector4(1.0f));
 			Sprite(const Ref<Texture2D>& texture, const Maths::Vector2& position, const Maths::Vector2& scale, const Maths::Vector4& colour);
 			virtual ~Sprite();
-			void SetPosition(const Maths::Vector2& vector2) { m_Position = vector2; };
+			void SetPosition(const Maths::Vector2& vector2) { m_Position = vector2; m_Dirty = true; };
         
             void SetSpriteSheet(const Ref<Texture2D>& texture, const Maths::Vector2& index, const Maths::Vector2& cellSize, const Maths::Vector2& spriteSize);
-            void SetTexture(const Ref<Texture2D>& texture) { m_Texture = texture; }
+            void SetTexture(const Ref<Texture2D>& texture) { m_Texture = texture; m_Dirty = true; }
 			void OnImGui();
+
+			// Static sprites are baked into cached chunks by Renderer2D instead of being rebuilt every frame.
+			// Their chunk is rebuilt when the sprite changes or its transform is updated.
+			bool GetStatic() const { return m_Static; }
+			void SetStatic(bool isStatic) { m_Static = isStatic; m_Dirty = true; }
+
+			bool GetDirty() const { return m_Dirty; }
+			void SetDirty(bool dirty) { m_Dirty = dirty; }
+
+		private:
+			bool m_Static = false;
+			bool m_Dirty = true;
 		};
 	}
 }
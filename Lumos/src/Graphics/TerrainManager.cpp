@@ -0,0 +1,87 @@
+#include "lmpch.h"
+#include "TerrainManager.h"
+#include "ChunkedTerrain.h"
+#include "Camera/Camera.h"
+#include "ECS/Component/TerrainComponent.h"
+#include "Maths/Transform.h"
+#include "Utilities/TimeStep.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	TerrainManager::TerrainManager()
+	{
+		m_DebugName = "Terrain Manager";
+	}
+
+	TerrainManager::~TerrainManager()
+	{
+	}
+
+	void TerrainManager::OnInit()
+	{
+	}
+
+	void TerrainManager::DeclareAccess(SystemAccess& access)
+	{
+		// Creates and destroys tile entities and uploads their meshes
+		access.Exclusive();
+	}
+
+	void TerrainManager::OnUpdate(const TimeStep&, Scene* scene)
+	{
+		LUMOS_PROFILE_FUNC;
+		Timer timer;
+
+		m_TerrainCount = 0;
+		m_ResidentTiles = 0;
+		m_ResidentBytes = 0;
+
+		if (!scene)
+			return;
+
+		auto& registry = scene->GetRegistry();
+		auto cameraView = registry.view<Camera>();
+		if (cameraView.empty())
+			return;
+
+		const Maths::Vector3 cameraPosition = registry.get<Camera>(cameraView.front()).GetPosition();
+
+		auto view = registry.view<TerrainComponent>();
+		for (auto entity : view)
+		{
+			auto& terrain = view.get<TerrainComponent>(entity).GetTerrain();
+			if (!terrain)
+				continue;
+
+			Maths::Vector3 viewerPosition = cameraPosition;
+			auto transform = registry.try_get<Maths::Transform>(entity);
+			if (transform)
+				viewerPosition = transform->GetWorldMatrix().Inverse() * cameraPosition;
+
+			terrain->Update(registry, entity, viewerPosition);
+
+			m_TerrainCount++;
+			m_ResidentTiles += terrain->GetResidentTileCount();
+			m_ResidentBytes += terrain->GetResidentBytes();
+		}
+
+		m_UpdateTime = timer.GetMS(1000.0f);
+	}
+
+	void TerrainManager::OnImGui()
+	{
+		ImGui::TextUnformatted("Terrain Manager");
+		ImGui::Text("Terrains : %u", m_TerrainCount);
+		ImGui::Text("Resident Tiles : %u", m_ResidentTiles);
+		ImGui::Text("Resident Memory : %.2f MB", static_cast<double>(m_ResidentBytes) / (1024.0 * 1024.0));
+		ImGui::Text("Update : %.3f ms", m_UpdateTime);
+	}
+
+	void TerrainManager::OnDebugDraw()
+	{
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "lmpch.h"
+#include "ECS/ISystem.h"
+
+namespace Lumos
+{
+	// Streams the tiles of every TerrainComponent in the scene around the scene's camera
+	class LUMOS_EXPORT TerrainManager : public ISystem
+	{
+	public:
+		TerrainManager();
+		~TerrainManager();
+
+		void OnInit() override;
+		void OnUpdate(const TimeStep& timeStep, Scene* scene) override;
+		void OnImGui() override;
+		void OnDebugDraw() override;
+		void DeclareAccess(SystemAccess& access) override;
+
+	private:
+		u32 m_TerrainCount = 0;
+		u32 m_ResidentTiles = 0;
+		u64 m_ResidentBytes = 0;
+		float m_UpdateTime = 0.0f;
+	};
+}
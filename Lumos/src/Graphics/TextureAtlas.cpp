@@ -0,0 +1,185 @@
+#include "lmpch.h"
+#include "TextureAtlas.h"
+#include "Graphics/API/Texture.h"
+#include "Graphics/API/GraphicsContext.h"
+#include "Utilities/LoadImage.h"
+#include "Core/Profiler.h"
+
+#include <imgui/imgui.h>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		TextureAtlas::~TextureAtlas()
+		{
+			for (auto page : m_Pages)
+			{
+				delete page->texture;
+				delete[] page->pixels;
+				delete page;
+			}
+
+			m_Pages.clear();
+			m_Regions.clear();
+		}
+
+		AtlasRegion* TextureAtlas::Find(Texture2D* texture) const
+		{
+			auto it = m_Regions.find(texture);
+			if (it == m_Regions.end())
+				return nullptr;
+
+			return const_cast<AtlasRegion*>(&it->second);
+		}
+
+		AtlasRegion* TextureAtlas::Add(const Ref<Texture2D>& texture)
+		{
+			LUMOS_PROFILE_FUNC;
+			if (auto region = Find(texture.get()))
+				return region;
+
+			AtlasRegion& region = m_Regions[texture.get()];
+			region.source = texture;
+			region.texture = texture.get();
+
+			const String& filePath = texture->GetFilepath();
+			const bool small = texture->GetWidth() <= TEXTURE_ATLAS_MAX_TEXTURE_SIZE && texture->GetHeight() <= TEXTURE_ATLAS_MAX_TEXTURE_SIZE;
+
+			if (small && !filePath.empty() && filePath != "NULL")
+			{
+				u32 width = 0, height = 0, bits = 0;
+				bool isHDR = false;
+
+				// Match the orientation the API specific texture loaders use
+				const bool flipY = GraphicsContext::GetRenderAPI() == RenderAPI::OPENGL;
+				u8* pixels = LoadImageFromFile(filePath, &width, &height, &bits, &isHDR, flipY);
+
+				if (pixels)
+				{
+					if (bits == 32 && !isHDR && width == texture->GetWidth() && height == texture->GetHeight())
+						Pack(region, pixels, width, height);
+
+					delete[] pixels;
+				}
+			}
+
+			if (!region.atlased)
+				region.sortID = m_NextSortID++;
+
+			return &region;
+		}
+
+		bool TextureAtlas::Pack(AtlasRegion& region, const u8* pixels, u32 width, u32 height)
+		{
+			const int paddedWidth = int(width) + TEXTURE_ATLAS_PADDING * 2;
+			const int paddedHeight = int(height) + TEXTURE_ATLAS_PADDING * 2;
+
+			int x = 0, y = 0;
+			u32 pageIndex = 0;
+			for (; pageIndex < static_cast<u32>(m_Pages.size()); pageIndex++)
+			{
+				if (m_Pages[pageIndex]->allocator.Allocate(paddedWidth, paddedHeight, x, y))
+					break;
+			}
+
+			if (pageIndex == static_cast<u32>(m_Pages.size()))
+			{
+				Page* page = lmnew Page();
+				page->allocator.Reset(TEXTURE_ATLAS_SIZE, TEXTURE_ATLAS_SIZE);
+				page->pixels = lmnew u8[TEXTURE_ATLAS_SIZE * TEXTURE_ATLAS_SIZE * 4];
+				memset(page->pixels, 0, TEXTURE_ATLAS_SIZE * TEXTURE_ATLAS_SIZE * 4);
+				page->texture = Texture2D::CreateFromSource(TEXTURE_ATLAS_SIZE, TEXTURE_ATLAS_SIZE, page->pixels,
+					TextureParameters(TextureFormat::RGBA, TextureFilter::NEAREST, TextureFilter::NEAREST, TextureWrap::CLAMP), TextureLoadOptions(false, false, false));
+				page->sortID = m_NextSortID++;
+				m_Pages.push_back(page);
+
+				if (!page->allocator.Allocate(paddedWidth, paddedHeight, x, y))
+					return false;
+			}
+
+			Page* page = m_Pages[pageIndex];
+			Blit(page, pixels, width, height, x, y);
+
+			page->regionCount++;
+			page->dirty = true;
+
+			region.texture = page->texture;
+			region.page = pageIndex;
+			region.sortID = page->sortID;
+			region.uvOffset = Maths::Vector2(float(x + TEXTURE_ATLAS_PADDING), float(y + TEXTURE_ATLAS_PADDING)) / float(TEXTURE_ATLAS_SIZE);
+			region.uvScale = Maths::Vector2(float(width), float(height)) / float(TEXTURE_ATLAS_SIZE);
+			region.atlased = true;
+
+			return true;
+		}
+
+		void TextureAtlas::Blit(Page* page, const u8* pixels, u32 width, u32 height, int x, int y)
+		{
+			const u32 rowSize = width * 4;
+			const u32 pageRowSize = TEXTURE_ATLAS_SIZE * 4;
+
+			// The padding repeats the edge texels so filtering at the border doesn't bleed
+			for (int row = -TEXTURE_ATLAS_PADDING; row < int(height) + TEXTURE_ATLAS_PADDING; row++)
+			{
+				const u32 srcRow = static_cast<u32>(Maths::Clamp(row, 0, int(height) - 1));
+				const u8* src = pixels + srcRow * rowSize;
+				u8* dst = page->pixels + (y + TEXTURE_ATLAS_PADDING + row) * pageRowSize + (x + TEXTURE_ATLAS_PADDING) * 4;
+
+				memcpy(dst, src, rowSize);
+
+				for (int p = 1; p <= TEXTURE_ATLAS_PADDING; p++)
+				{
+					memcpy(dst - p * 4, src, 4);
+					memcpy(dst + rowSize + (p - 1) * 4, src + rowSize - 4, 4);
+				}
+			}
+		}
+
+		void TextureAtlas::Upload()
+		{
+			for (auto page : m_Pages)
+			{
+				if (!page->dirty)
+					continue;
+
+				page->texture->SetData(page->pixels);
+				page->dirty = false;
+			}
+		}
+
+		void TextureAtlas::ReleaseUnused(u32 frame, u32 retainFrames)
+		{
+			for (auto it = m_Regions.begin(); it != m_Regions.end();)
+			{
+				if (frame - it->second.lastUsedFrame <= retainFrames)
+				{
+					++it;
+					continue;
+				}
+
+				if (it->second.atlased)
+				{
+					Page* page = m_Pages[it->second.page];
+					if (--page->regionCount == 0)
+						page->allocator.Reset(TEXTURE_ATLAS_SIZE, TEXTURE_ATLAS_SIZE);
+				}
+
+				it = m_Regions.erase(it);
+			}
+		}
+
+		void TextureAtlas::OnImGui()
+		{
+			u32 atlased = 0;
+			for (auto& [texture, region] : m_Regions)
+			{
+				if (region.atlased)
+					atlased++;
+			}
+
+			ImGui::Text("Atlas Pages : %u (%i x %i)", GetPageCount(), TEXTURE_ATLAS_SIZE, TEXTURE_ATLAS_SIZE);
+			ImGui::Text("Textures : %u (%u atlased)", GetRegionCount(), atlased);
+		}
+	}
+}
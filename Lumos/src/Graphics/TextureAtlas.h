@@ -0,0 +1,74 @@
+#pragma once
+#include "lmpch.h"
+#include "Maths/Maths.h"
+#include "Maths/AreaAllocator.h"
+
+#define TEXTURE_ATLAS_SIZE 2048
+#define TEXTURE_ATLAS_MAX_TEXTURE_SIZE 256
+#define TEXTURE_ATLAS_PADDING 1
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		class Texture;
+		class Texture2D;
+
+		// Where a sprite texture ends up. Atlased textures point at their page and remap
+		// uv = uvOffset + uv * uvScale, others point at the original texture with identity uvs.
+		// Regions sharing a page share a sort id so the renderer can batch them together.
+		struct AtlasRegion
+		{
+			Ref<Texture2D> source;
+			Texture* texture = nullptr;
+			Maths::Vector2 uvOffset = Maths::Vector2(0.0f, 0.0f);
+			Maths::Vector2 uvScale = Maths::Vector2(1.0f, 1.0f);
+			u32 sortID = 0;
+			u32 page = 0;
+			u32 lastUsedFrame = 0;
+			bool atlased = false;
+		};
+
+		// Packs small file backed textures into shared pages using Maths::AreaAllocator.
+		// Pixels are reloaded from the texture's file, since textures cannot be read back.
+		class LUMOS_EXPORT TextureAtlas
+		{
+		public:
+			TextureAtlas() = default;
+			~TextureAtlas();
+
+			// Safe to call from several threads as long as no Add/ReleaseUnused runs at the same time
+			AtlasRegion* Find(Texture2D* texture) const;
+			AtlasRegion* Add(const Ref<Texture2D>& texture);
+
+			// Uploads pages that changed since the last call
+			void Upload();
+
+			// Drops regions that have not been drawn for retainFrames frames, resetting empty pages
+			void ReleaseUnused(u32 frame, u32 retainFrames);
+
+			u32 GetPageCount() const { return static_cast<u32>(m_Pages.size()); }
+			u32 GetRegionCount() const { return static_cast<u32>(m_Regions.size()); }
+
+			void OnImGui();
+
+		private:
+			struct Page
+			{
+				Texture2D* texture = nullptr;
+				u8* pixels = nullptr;
+				Maths::AreaAllocator allocator;
+				u32 regionCount = 0;
+				u32 sortID = 0;
+				bool dirty = true;
+			};
+
+			bool Pack(AtlasRegion& region, const u8* pixels, u32 width, u32 height);
+			void Blit(Page* page, const u8* pixels, u32 width, u32 height, int x, int y);
+
+			std::unordered_map<Texture2D*, AtlasRegion> m_Regions;
+			std::vector<Page*> m_Pages;
+			u32 m_NextSortID = 1;
+		};
+	}
+}
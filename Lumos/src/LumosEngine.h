@@ -12,6 +12,7 @@
 #include "Physics/LumosPhysicsEngine/SphereCollisionShape.h"
 #include "Physics/LumosPhysicsEngine/CuboidCollisionShape.h"
 #include "Physics/LumosPhysicsEngine/PyramidCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/HullCollisionShape.h"
 #include "Physics/LumosPhysicsEngine/DistanceConstraint.h"
 #include "Physics/LumosPhysicsEngine/SpringConstraint.h"
 #include "Physics/LumosPhysicsEngine/WeldConstraint.h"
@@ -32,11 +33,13 @@
 #include "Graphics/Mesh.h"
 #include "Graphics/ModelLoader/ModelLoader.h"
 #include "Graphics/Material.h"
-#include "Graphics/Particle.h"
+#include "Graphics/ParticleEmitter.h"
 #include "Graphics/Water.h"
 #include "Graphics/Sprite.h"
 #include "Graphics/GBuffer.h"
 #include "Graphics/Terrain.h"
+#include "Graphics/ChunkedTerrain.h"
+#include "Graphics/Animation/Animator.h"
 #include "Graphics/Light.h"
 #include "Graphics/Environment.h"
 
@@ -57,6 +60,8 @@
 
 //Managers
 #include "Graphics/ParticleManager.h"
+#include "Graphics/TerrainManager.h"
+#include "Graphics/Animation/AnimationManager.h"
 
 //Maths
 #include "Maths/Maths.h"
@@ -96,6 +101,7 @@
 #include "Graphics/Renderers/ForwardRenderer.h"
 #include "Graphics/Renderers/ShadowRenderer.h"
 #include "Graphics/Renderers/GridRenderer.h"
+#include "Graphics/Renderers/ParticleRenderer.h"
 #include "Graphics/Renderers/SkyboxRenderer.h"
 #include "Graphics/RenderManager.h"
 
@@ -0,0 +1,423 @@
+#include "lmpch.h"
+#include "Maths/BVH.h"
+
+namespace Lumos::Maths
+{
+    static const u32 SAH_BINS = 16;
+
+    // Traversal keeps one stack entry per level, so depth is capped well below its size
+    static const u32 MAX_DEPTH = 60;
+
+    static float HalfArea(const Vector3& min, const Vector3& max)
+    {
+        const Vector3 extent = max - min;
+        return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+    }
+
+    static void Grow(Vector3& min, Vector3& max, const Vector3& pointMin, const Vector3& pointMax)
+    {
+        min = Vector3(Min(min.x, pointMin.x), Min(min.y, pointMin.y), Min(min.z, pointMin.z));
+        max = Vector3(Max(max.x, pointMax.x), Max(max.y, pointMax.y), Max(max.z, pointMax.z));
+    }
+
+    void BVH::Clear()
+    {
+        nodes_.clear();
+        indices_.clear();
+    }
+
+    void BVH::Build(const BoundingBox* bounds, u32 count, u32 maxLeafSize)
+    {
+        Clear();
+
+        if (count == 0)
+            return;
+
+        indices_.resize(count);
+        std::vector<Vector3> centroids(count);
+        for (u32 i = 0; i < count; i++)
+        {
+            indices_[i] = i;
+            centroids[i] = (bounds[i].min_ + bounds[i].max_) * 0.5f;
+        }
+
+        nodes_.reserve(count * 2);
+        nodes_.push_back({ Vector3(0.0f), 0, Vector3(0.0f), count });
+        UpdateNodeBounds(nodes_[0], bounds);
+
+        // Explicit stack of (node, depth) so very large meshes cannot overflow the call stack
+        std::vector<std::pair<u32, u32>> pending;
+        pending.emplace_back(0, 0);
+
+        while (!pending.empty())
+        {
+            const auto [nodeIndex, depth] = pending.back();
+            pending.pop_back();
+
+            if (depth >= MAX_DEPTH)
+                continue;
+
+            Subdivide(nodeIndex, bounds, centroids.data(), maxLeafSize);
+
+            const Node& node = nodes_[nodeIndex];
+            if (node.count == 0)
+            {
+                pending.emplace_back(node.first, depth + 1);
+                pending.emplace_back(node.first + 1, depth + 1);
+            }
+        }
+
+        nodes_.shrink_to_fit();
+    }
+
+    void BVH::UpdateNodeBounds(Node& node, const BoundingBox* bounds)
+    {
+        node.min = Vector3(M_INFINITY);
+        node.max = Vector3(-M_INFINITY);
+
+        for (u32 i = 0; i < node.count; i++)
+        {
+            const BoundingBox& box = bounds[indices_[node.first + i]];
+            Grow(node.min, node.max, box.min_, box.max_);
+        }
+    }
+
+    void BVH::Subdivide(u32 nodeIndex, const BoundingBox* bounds, const Vector3* centroids, u32 maxLeafSize)
+    {
+        const u32 first = nodes_[nodeIndex].first;
+        const u32 count = nodes_[nodeIndex].count;
+
+        if (count <= 1)
+            return;
+
+        Vector3 centroidMin(M_INFINITY);
+        Vector3 centroidMax(-M_INFINITY);
+        for (u32 i = 0; i < count; i++)
+        {
+            const Vector3& centroid = centroids[indices_[first + i]];
+            Grow(centroidMin, centroidMax, centroid, centroid);
+        }
+
+        struct Bin
+        {
+            Vector3 min = Vector3(M_INFINITY);
+            Vector3 max = Vector3(-M_INFINITY);
+            u32 count = 0;
+        };
+
+        float bestCost = M_INFINITY;
+        int bestAxis = -1;
+        u32 bestPlane = 0;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float lo = (&centroidMin.x)[axis];
+            const float extent = (&centroidMax.x)[axis] - lo;
+            if (extent <= 0.0f)
+                continue;
+
+            Bin bins[SAH_BINS];
+            const float scale = SAH_BINS / extent;
+            for (u32 i = 0; i < count; i++)
+            {
+                const u32 index = indices_[first + i];
+                const u32 bin = Min(SAH_BINS - 1, static_cast<u32>(((&centroids[index].x)[axis] - lo) * scale));
+                bins[bin].count++;
+                Grow(bins[bin].min, bins[bin].max, bounds[index].min_, bounds[index].max_);
+            }
+
+            // Sweep from both ends to get the cost of splitting after each bin
+            float leftArea[SAH_BINS - 1], rightArea[SAH_BINS - 1];
+            u32 leftCount[SAH_BINS - 1], rightCount[SAH_BINS - 1];
+            Vector3 leftMin(M_INFINITY), leftMax(-M_INFINITY), rightMin(M_INFINITY), rightMax(-M_INFINITY);
+            u32 leftSum = 0, rightSum = 0;
+
+            for (u32 i = 0; i < SAH_BINS - 1; i++)
+            {
+                leftSum += bins[i].count;
+                leftCount[i] = leftSum;
+                if (bins[i].count)
+                    Grow(leftMin, leftMax, bins[i].min, bins[i].max);
+                leftArea[i] = leftSum ? HalfArea(leftMin, leftMax) : 0.0f;
+
+                const u32 j = SAH_BINS - 1 - i;
+                rightSum += bins[j].count;
+                rightCount[j - 1] = rightSum;
+                if (bins[j].count)
+                    Grow(rightMin, rightMax, bins[j].min, bins[j].max);
+                rightArea[j - 1] = rightSum ? HalfArea(rightMin, rightMax) : 0.0f;
+            }
+
+            for (u32 i = 0; i < SAH_BINS - 1; i++)
+            {
+                const float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+                if (leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestPlane = i;
+                }
+            }
+        }
+
+        // All centroids coincide, nothing to split on
+        if (bestAxis < 0)
+            return;
+
+        // Keep small nodes as leaves unless splitting is clearly cheaper than testing them all
+        const Node& node = nodes_[nodeIndex];
+        const float leafCost = count * HalfArea(node.min, node.max);
+        if (count <= maxLeafSize && bestCost >= leafCost)
+            return;
+
+        const float lo = (&centroidMin.x)[bestAxis];
+        const float scale = SAH_BINS / ((&centroidMax.x)[bestAxis] - lo);
+
+        u32 i = first;
+        u32 j = first + count - 1;
+        while (i <= j)
+        {
+            const u32 bin = Min(SAH_BINS - 1, static_cast<u32>(((&centroids[indices_[i]].x)[bestAxis] - lo) * scale));
+            if (bin <= bestPlane)
+                i++;
+            else
+            {
+                std::swap(indices_[i], indices_[j]);
+                if (j == 0)
+                    break;
+                j--;
+            }
+        }
+
+        const u32 leftCount = i - first;
+        if (leftCount == 0 || leftCount == count)
+            return;
+
+        const u32 leftIndex = static_cast<u32>(nodes_.size());
+        nodes_.push_back({ Vector3(0.0f), first, Vector3(0.0f), leftCount });
+        nodes_.push_back({ Vector3(0.0f), i, Vector3(0.0f), count - leftCount });
+        UpdateNodeBounds(nodes_[leftIndex], bounds);
+        UpdateNodeBounds(nodes_[leftIndex + 1], bounds);
+
+        nodes_[nodeIndex].first = leftIndex;
+        nodes_[nodeIndex].count = 0;
+    }
+
+    void BVH::Refit(const BoundingBox* bounds)
+    {
+        // Children are always stored after their parent, so a reverse walk sees them first
+        for (size_t i = nodes_.size(); i-- > 0;)
+        {
+            Node& node = nodes_[i];
+            if (node.count > 0)
+            {
+                UpdateNodeBounds(node, bounds);
+                continue;
+            }
+
+            const Node& left = nodes_[node.first];
+            const Node& right = nodes_[node.first + 1];
+            node.min = left.min;
+            node.max = left.max;
+            Grow(node.min, node.max, right.min, right.max);
+        }
+    }
+
+    void TriangleBVH::Build(const void* vertexData, u32 vertexStride, const u32* indexData, u32 indexCount)
+    {
+        const u32 triangleCount = indexCount / 3;
+        const unsigned char* vertices = static_cast<const unsigned char*>(vertexData);
+        auto position = [&](u32 index) -> const Vector3& { return *reinterpret_cast<const Vector3*>(vertices + index * vertexStride); };
+
+        std::vector<BoundingBox> boxes(triangleCount);
+        bounds_.Clear();
+
+        for (u32 i = 0; i < triangleCount; i++)
+        {
+            const Vector3& v0 = position(indexData[i * 3]);
+            const Vector3& v1 = position(indexData[i * 3 + 1]);
+            const Vector3& v2 = position(indexData[i * 3 + 2]);
+
+            boxes[i].Define(v0);
+            boxes[i].Merge(v1);
+            boxes[i].Merge(v2);
+            bounds_.Merge(boxes[i]);
+        }
+
+        bvh_.Build(boxes.data(), triangleCount);
+
+        const auto& order = bvh_.GetIndices();
+        triangles_.resize(triangleCount);
+        triangleIndices_.assign(order.begin(), order.end());
+
+        for (u32 i = 0; i < triangleCount; i++)
+        {
+            const u32 triangle = order[i];
+            const Vector3& v0 = position(indexData[triangle * 3]);
+            triangles_[i].v0 = v0;
+            triangles_[i].edge1 = position(indexData[triangle * 3 + 1]) - v0;
+            triangles_[i].edge2 = position(indexData[triangle * 3 + 2]) - v0;
+        }
+    }
+
+    float TriangleBVH::Intersect(const Triangle& triangle, const Ray& ray, float& u, float& v)
+    {
+        // Möller & Trumbore as in Ray::HitDistance, without the backface test
+        const Vector3 p = ray.direction_.CrossProduct(triangle.edge2);
+        const float det = triangle.edge1.DotProduct(p);
+        if (Abs(det) < M_EPSILON)
+            return M_INFINITY;
+
+        const float invDet = 1.0f / det;
+        const Vector3 t = ray.origin_ - triangle.v0;
+        u = t.DotProduct(p) * invDet;
+        if (u < 0.0f || u > 1.0f)
+            return M_INFINITY;
+
+        const Vector3 q = t.CrossProduct(triangle.edge1);
+        v = ray.direction_.DotProduct(q) * invDet;
+        if (v < 0.0f || u + v > 1.0f)
+            return M_INFINITY;
+
+        const float distance = triangle.edge2.DotProduct(q) * invDet;
+        return distance >= 0.0f ? distance : M_INFINITY;
+    }
+
+    void TriangleBVH::TestLeaf(const Ray& ray, u32 first, u32 count, RayHit& hit) const
+    {
+        for (u32 i = first; i < first + count; i++)
+        {
+            float u, v;
+            const float distance = Intersect(triangles_[i], ray, u, v);
+            if (distance < hit.distance)
+            {
+                hit.distance = distance;
+                hit.primitive = triangleIndices_[i];
+                hit.barycentric = Vector2(u, v);
+
+                Vector3 normal = triangles_[i].edge1.CrossProduct(triangles_[i].edge2).Normalized();
+                hit.normal = normal.DotProduct(ray.direction_) > 0.0f ? -normal : normal;
+            }
+        }
+    }
+
+    bool TriangleBVH::Raycast(const Ray& ray, RayHit& hit, float maxDistance) const
+    {
+        hit = RayHit();
+        hit.distance = maxDistance;
+
+        bvh_.Traverse(ray, maxDistance, [&](u32 first, u32 count, float& distance)
+        {
+            TestLeaf(ray, first, count, hit);
+            distance = hit.distance;
+            return false;
+        });
+
+        if (hit.primitive == ~0u)
+        {
+            hit.distance = M_INFINITY;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool TriangleBVH::AnyHit(const Ray& ray, float maxDistance) const
+    {
+        bool found = false;
+
+        bvh_.Traverse(ray, maxDistance, [&](u32 first, u32 count, float& distance)
+        {
+            for (u32 i = first; i < first + count; i++)
+            {
+                float u, v;
+                if (Intersect(triangles_[i], ray, u, v) < distance)
+                {
+                    found = true;
+                    return true;
+                }
+            }
+
+            return false;
+        });
+
+        return found;
+    }
+
+    void TriangleBVH::Raycast(const Ray* rays, u32 count, RayHit* hits) const
+    {
+        const auto& nodes = bvh_.GetNodes();
+
+        for (u32 i = 0; i < count; i++)
+            hits[i] = RayHit();
+
+        if (nodes.empty())
+            return;
+
+        // Packets of up to 64 rays, tracked as a bit mask of the rays still inside each subtree
+        for (u32 base = 0; base < count; base += 64)
+        {
+            const u32 packetSize = Min(64u, count - base);
+            Vector3 invDirections[64];
+            for (u32 i = 0; i < packetSize; i++)
+                invDirections[i] = BVH::InverseDirection(rays[base + i].direction_);
+
+            const u64 allRays = packetSize == 64 ? ~0ull : ((1ull << packetSize) - 1);
+
+            struct Entry { u32 node; u64 mask; };
+            Entry stack[MAX_DEPTH * 2 + 4];
+            u32 stackSize = 0;
+            stack[stackSize++] = { 0, allRays };
+
+            while (stackSize > 0)
+            {
+                const Entry entry = stack[--stackSize];
+                const BVH::Node& node = nodes[entry.node];
+
+                // Drop rays that miss this node or already hit something closer
+                u64 mask = 0;
+                u32 nearestRay = 0;
+                for (u32 i = 0; i < packetSize; i++)
+                {
+                    if (!(entry.mask & (1ull << i)))
+                        continue;
+
+                    if (BVH::IntersectNode(node, rays[base + i].origin_, invDirections[i], hits[base + i].distance) != M_INFINITY)
+                    {
+                        if (!mask)
+                            nearestRay = i;
+                        mask |= 1ull << i;
+                    }
+                }
+
+                if (!mask)
+                    continue;
+
+                if (node.count > 0)
+                {
+                    for (u32 i = 0; i < packetSize; i++)
+                    {
+                        if (mask & (1ull << i))
+                            TestLeaf(rays[base + i], node.first, node.count, hits[base + i]);
+                    }
+                    continue;
+                }
+
+                // Order the children by the first active ray, coherent rays mostly agree
+                const Ray& ray = rays[base + nearestRay];
+                const float leftDistance = BVH::IntersectNode(nodes[node.first], ray.origin_, invDirections[nearestRay], M_INFINITY);
+                const float rightDistance = BVH::IntersectNode(nodes[node.first + 1], ray.origin_, invDirections[nearestRay], M_INFINITY);
+                const bool leftFirst = leftDistance <= rightDistance;
+
+                stack[stackSize++] = { leftFirst ? node.first + 1 : node.first, mask };
+                stack[stackSize++] = { leftFirst ? node.first : node.first + 1, mask };
+            }
+        }
+
+        for (u32 i = 0; i < count; i++)
+        {
+            if (hits[i].primitive == ~0u)
+                hits[i].distance = M_INFINITY;
+        }
+    }
+}
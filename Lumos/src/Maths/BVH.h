@@ -0,0 +1,181 @@
+#pragma once
+#include "Maths/Vector2.h"
+#include "Maths/Vector3.h"
+#include "Maths/Ray.h"
+#include "Maths/BoundingBox.h"
+
+namespace Lumos::Maths
+{
+    /// Result of a ray query against a BVH.
+    struct RayHit
+    {
+        /// Distance along the ray, infinity when nothing was hit.
+        float distance = M_INFINITY;
+        /// Index of the primitive hit, in the order it was passed to Build.
+        u32 primitive = ~0u;
+        /// Unit normal of the hit face, facing back along the ray.
+        Vector3 normal;
+        /// Barycentric coordinates of the hit point on the triangle's second and third vertex.
+        Vector2 barycentric;
+
+        bool Hit() const { return distance < M_INFINITY; }
+    };
+
+    /// Bounding volume hierarchy over axis aligned boxes, built with the binned surface area heuristic
+    /// into a flat node array. Children of an interior node are stored next to each other.
+    class LUMOS_EXPORT BVH
+    {
+    public:
+        struct Node
+        {
+            Vector3 min;
+            /// First primitive for a leaf, left child for an interior node (right child is first + 1).
+            u32 first;
+            Vector3 max;
+            /// Number of primitives, zero for interior nodes.
+            u32 count;
+        };
+
+        /// Build over count boxes. Leaves are split while the SAH estimate says it pays off.
+        void Build(const BoundingBox* bounds, u32 count, u32 maxLeafSize = 4);
+        /// Recompute node bounds for moved primitives without changing the tree.
+        void Refit(const BoundingBox* bounds);
+        void Clear();
+
+        const std::vector<Node>& GetNodes() const { return nodes_; }
+        /// Primitive indices in leaf order, leaves reference ranges of this array.
+        const std::vector<u32>& GetIndices() const { return indices_; }
+        bool Empty() const { return nodes_.empty(); }
+
+        /// Entry distance of the ray into the node, or infinity if it misses or starts beyond maxDistance.
+        static float IntersectNode(const Node& node, const Vector3& origin, const Vector3& invDirection, float maxDistance)
+        {
+            const float tx1 = (node.min.x - origin.x) * invDirection.x, tx2 = (node.max.x - origin.x) * invDirection.x;
+            float tmin = Min(tx1, tx2), tmax = Max(tx1, tx2);
+            const float ty1 = (node.min.y - origin.y) * invDirection.y, ty2 = (node.max.y - origin.y) * invDirection.y;
+            tmin = Max(tmin, Min(ty1, ty2)); tmax = Min(tmax, Max(ty1, ty2));
+            const float tz1 = (node.min.z - origin.z) * invDirection.z, tz2 = (node.max.z - origin.z) * invDirection.z;
+            tmin = Max(tmin, Min(tz1, tz2)); tmax = Min(tmax, Max(tz1, tz2));
+
+            if (tmax >= Max(tmin, 0.0f) && tmin < maxDistance)
+                return Max(tmin, 0.0f);
+
+            return M_INFINITY;
+        }
+
+        static Vector3 InverseDirection(const Vector3& direction)
+        {
+            return Vector3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        }
+
+        /// Visit leaves front to back. leaf(first, count, maxDistance) tests the primitives in
+        /// indices [first, first + count), may shorten maxDistance and returns true to stop early.
+        template<typename LeafFunc>
+        void Traverse(const Ray& ray, float& maxDistance, LeafFunc&& leaf) const
+        {
+            if (nodes_.empty())
+                return;
+
+            const Vector3 invDirection = InverseDirection(ray.direction_);
+            if (IntersectNode(nodes_[0], ray.origin_, invDirection, maxDistance) == M_INFINITY)
+                return;
+
+            struct Entry { u32 node; float distance; };
+            Entry stack[64];
+            u32 stackSize = 0;
+            u32 current = 0;
+
+            while (true)
+            {
+                const Node& node = nodes_[current];
+                if (node.count > 0)
+                {
+                    if (leaf(node.first, node.count, maxDistance))
+                        return;
+                }
+                else
+                {
+                    u32 nearChild = node.first;
+                    u32 farChild = node.first + 1;
+                    float nearDistance = IntersectNode(nodes_[nearChild], ray.origin_, invDirection, maxDistance);
+                    float farDistance = IntersectNode(nodes_[farChild], ray.origin_, invDirection, maxDistance);
+
+                    if (farDistance < nearDistance)
+                    {
+                        std::swap(nearChild, farChild);
+                        std::swap(nearDistance, farDistance);
+                    }
+
+                    if (nearDistance != M_INFINITY)
+                    {
+                        if (farDistance != M_INFINITY)
+                            stack[stackSize++] = { farChild, farDistance };
+
+                        current = nearChild;
+                        continue;
+                    }
+                }
+
+                // Pop the next subtree still closer than the best hit so far
+                bool found = false;
+                while (stackSize > 0)
+                {
+                    const Entry& entry = stack[--stackSize];
+                    if (entry.distance < maxDistance)
+                    {
+                        current = entry.node;
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (!found)
+                    return;
+            }
+        }
+
+    private:
+        void UpdateNodeBounds(Node& node, const BoundingBox* bounds);
+        void Subdivide(u32 nodeIndex, const BoundingBox* bounds, const Vector3* centroids, u32 maxLeafSize);
+
+        std::vector<Node> nodes_;
+        std::vector<u32> indices_;
+    };
+
+    /// BVH over the triangles of indexed geometry, for exact ray casts against meshes.
+    /// Triangles are copied into leaf order so a leaf reads one contiguous range.
+    class LUMOS_EXPORT TriangleBVH
+    {
+    public:
+        /// Build from indexed triangles, the position is read from the start of each vertex.
+        void Build(const void* vertexData, u32 vertexStride, const u32* indexData, u32 indexCount);
+
+        /// Closest hit within maxDistance. Triangles are double sided.
+        bool Raycast(const Ray& ray, RayHit& hit, float maxDistance = M_INFINITY) const;
+        /// Whether anything is hit within maxDistance, stops at the first hit found.
+        bool AnyHit(const Ray& ray, float maxDistance = M_INFINITY) const;
+        /// Closest hits for a batch of rays, traversing the tree once for the whole packet.
+        /// Coherent rays (e.g. from one camera) share most node visits.
+        void Raycast(const Ray* rays, u32 count, RayHit* hits) const;
+
+        u32 GetTriangleCount() const { return static_cast<u32>(triangles_.size()); }
+        u32 GetNodeCount() const { return static_cast<u32>(bvh_.GetNodes().size()); }
+        const BoundingBox& GetBounds() const { return bounds_; }
+
+    private:
+        struct Triangle
+        {
+            Vector3 v0;
+            Vector3 edge1;
+            Vector3 edge2;
+        };
+
+        static float Intersect(const Triangle& triangle, const Ray& ray, float& u, float& v);
+        void TestLeaf(const Ray& ray, u32 first, u32 count, RayHit& hit) const;
+
+        BVH bvh_;
+        std::vector<Triangle> triangles_;
+        std::vector<u32> triangleIndices_;
+        BoundingBox bounds_;
+    };
+}
@@ -48,6 +48,11 @@ namespace Lumos
 		m_UpdateAccum = 0.0f;
 	}
 
+	void B2PhysicsEngine::DeclareAccess(SystemAccess& access)
+	{
+		access.Write<Physics2DComponent>().Write<Maths::Transform>().Write<B2PhysicsEngine>();
+	}
+
 	void B2PhysicsEngine::OnUpdate(const TimeStep& timeStep, Scene* scene)
 	{
 		LUMOS_PROFILE_FUNC;
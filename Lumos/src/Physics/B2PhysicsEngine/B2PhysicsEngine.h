@@ -36,6 +36,7 @@ namespace Lumos
 		bool IsPaused() const { return m_Paused; }
 
         void OnDebugDraw() override;
+		void DeclareAccess(SystemAccess& access) override;
     
         u32 GetDebugDrawFlags();
         void SetDebugDrawFlags(u32 flags);
@@ -2,6 +2,7 @@
 #include "CapsuleCollisionShape.h"
 #include "PhysicsObject3D.h"
 #include "Maths/Matrix3.h"
+#include "Graphics/Renderers/DebugRenderer.h"
 
 
 namespace Lumos
@@ -21,7 +22,7 @@ namespace Lumos
 	Maths::Matrix3 CapsuleCollisionShape::BuildInverseInertia(float invMass) const
 	{
         Maths::Vector3 halfExtents(m_Radius, m_Radius,m_Radius);
-        halfExtents.x += m_Height / 2.0f;
+        halfExtents.y += m_Height / 2.0f;
 
         float lx = 2.0f * (halfExtents.x);
         float ly = 2.0f * (halfExtents.y);
@@ -60,19 +61,43 @@ namespace Lumos
 			transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
 
 		Maths::Vector3 pos = transform.Translation();
+		Maths::Vector3 halfSegment = transform * Maths::Vector3(0.0f, m_Height * 0.5f / m_Radius, 0.0f) - pos;
+
+		if (Maths::Vector3::Dot(axis, halfSegment) < 0.0f)
+			halfSegment = -halfSegment;
 
 		if (out_min)
-			*out_min = pos - axis * m_Radius;
+			*out_min = pos - halfSegment - axis * m_Radius;
 
 		if (out_max)
-			*out_max = pos + axis * m_Radius;
+			*out_max = pos + halfSegment + axis * m_Radius;
+	}
+
+	Maths::Vector3 CapsuleCollisionShape::GetLocalSupport(const Maths::Vector3& localDirection) const
+	{
+		// Unit sphere swept along the local Y axis
+		Maths::Vector3 support = localDirection.NormalizedOrDefault(Maths::Vector3(1.0f, 0.0f, 0.0f));
+		support.y += (localDirection.y >= 0.0f ? 0.5f : -0.5f) * m_Height / m_Radius;
+		return support;
 	}
 
 	void CapsuleCollisionShape::GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
 	{
 		if (out_face)
 		{
-			out_face->push_back(currentObject->GetPosition() + axis * m_Radius);
+			Maths::Matrix4 transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
+			Maths::Vector3 pos = transform.Translation();
+			Maths::Vector3 halfSegment = transform * Maths::Vector3(0.0f, m_Height * 0.5f / m_Radius, 0.0f) - pos;
+
+			// A capsule lying flat against a face touches it along its whole segment, so both ends
+			// are returned to keep it from rocking on a single contact
+			const float alignment = Maths::Vector3::Dot(axis, halfSegment);
+			const float tolerance = 0.05f * m_Radius;
+
+			if (alignment > -tolerance)
+				out_face->push_back(pos + halfSegment + axis * m_Radius);
+			if (alignment < tolerance)
+				out_face->push_back(pos - halfSegment + axis * m_Radius);
 		}
 
 		if (out_normal)
@@ -83,5 +108,19 @@ namespace Lumos
 
 	void CapsuleCollisionShape::DebugDraw(const PhysicsObject3D* currentObject) const
 	{
+		Maths::Matrix4 transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
+
+		Maths::Vector3 pos = transform.Translation();
+		Maths::Vector3 halfSegment = transform * Maths::Vector3(0.0f, m_Height * 0.5f / m_Radius, 0.0f) - pos;
+		Maths::Vector3 side = currentObject->GetOrientation().RotationMatrix() * Maths::Vector3(m_Radius, 0.0f, 0.0f);
+		Maths::Vector3 front = currentObject->GetOrientation().RotationMatrix() * Maths::Vector3(0.0f, 0.0f, m_Radius);
+
+		DebugRenderer::DebugDraw(Maths::Sphere(pos + halfSegment, m_Radius), Maths::Vector4(1.0f, 1.0f, 1.0f, 0.2f));
+		DebugRenderer::DebugDraw(Maths::Sphere(pos - halfSegment, m_Radius), Maths::Vector4(1.0f, 1.0f, 1.0f, 0.2f));
+
+		DebugRenderer::DrawThickLine(pos - halfSegment + side, pos + halfSegment + side, 0.02f, Maths::Vector4(1.0f, 0.3f, 1.0f, 1.0f));
+		DebugRenderer::DrawThickLine(pos - halfSegment - side, pos + halfSegment - side, 0.02f, Maths::Vector4(1.0f, 0.3f, 1.0f, 1.0f));
+		DebugRenderer::DrawThickLine(pos - halfSegment + front, pos + halfSegment + front, 0.02f, Maths::Vector4(1.0f, 0.3f, 1.0f, 1.0f));
+		DebugRenderer::DrawThickLine(pos - halfSegment - front, pos + halfSegment - front, 0.02f, Maths::Vector4(1.0f, 0.3f, 1.0f, 1.0f));
 	}
 }
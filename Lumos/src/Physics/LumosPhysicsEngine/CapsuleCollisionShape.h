@@ -20,12 +20,14 @@ namespace Lumos
 
 		virtual void GetMinMaxVertexOnAxis(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const override;
 		virtual void GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const override;
+		virtual Maths::Vector3 GetLocalSupport(const Maths::Vector3& localDirection) const override;
 
 		virtual void DebugDraw(const PhysicsObject3D* currentObject) const override;
 
 		//Get/Set Sphere Radius
-		void SetRadius(float radius) { m_Radius = radius; }
+		void SetRadius(float radius) { m_Radius = radius; m_LocalTransform = Maths::Matrix4::Scale(Maths::Vector3(m_Radius)); }
 		float GetRadius() const  { return m_Radius; }
+		float GetHeight() const  { return m_Height; }
 
 		float GetSize() const override { return m_Radius; }
 
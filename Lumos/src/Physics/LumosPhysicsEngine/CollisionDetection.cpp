@@ -2,29 +2,662 @@
 #include "CollisionDetection.h"
 
 #include "SphereCollisionShape.h"
+#include "CapsuleCollisionShape.h"
+#include "Maths/Matrix3x4.h"
 
 namespace Lumos
 {
+	namespace
+	{
+		const u32 MaxGJKIterations = 64;
+		const u32 MaxEPAIterations = 64;
+		const u32 MaxTOIIterations = 32;
+		const float GJKTolerance = 1e-6f;
+		const float EPATolerance = 1e-4f;
+		const float EPAVisibleTolerance = 1e-5f;
+		// Below this the cores are treated as touching and EPA measures the full shapes instead
+		const float CoreOverlapDistance = 1e-4f;
+
+		struct SupportPoint
+		{
+			Maths::Vector3 point; // onA - onB
+			Maths::Vector3 onA;
+			Maths::Vector3 onB;
+		};
+
+		// A shape placed in the world. Spheres and capsules keep their radius apart from a point /
+		// segment core so GJK converges on them in a couple of iterations.
+		struct ConvexObject
+		{
+			const CollisionShape* shape;
+			Maths::Matrix3x4 transform;
+			Maths::Matrix3 worldToLocal;
+			Maths::Vector3 coreStart;
+			Maths::Vector3 coreEnd;
+			float margin = 0.0f;
+			bool hasCore = false;
+
+			ConvexObject(const PhysicsObject3D* obj, const CollisionShape* collisionShape)
+				: shape(collisionShape)
+			{
+				Maths::Matrix4 wsTransform = obj->GetWorldSpaceTransform() * shape->GetLocalTransform();
+				transform = Maths::Matrix3x4(wsTransform);
+				worldToLocal = wsTransform.ToMatrix3().Transpose();
+
+				switch (shape->GetType())
+				{
+				case CollisionSphere:
+					hasCore = true;
+					margin = static_cast<const SphereCollisionShape*>(shape)->GetRadius();
+					coreStart = coreEnd = wsTransform.Translation();
+					break;
+				case CollisionCapsule:
+				{
+					auto capsule = static_cast<const CapsuleCollisionShape*>(shape);
+					const float halfHeight = capsule->GetHeight() * 0.5f / capsule->GetRadius();
+					hasCore = true;
+					margin = capsule->GetRadius();
+					coreStart = transform * Maths::Vector3(0.0f, -halfHeight, 0.0f);
+					coreEnd = transform * Maths::Vector3(0.0f, halfHeight, 0.0f);
+					break;
+				}
+				default:
+					break;
+				}
+			}
+
+			void Translate(const Maths::Vector3& offset)
+			{
+				transform.SetTranslation(transform.Translation() + offset);
+				coreStart += offset;
+				coreEnd += offset;
+			}
+
+			Maths::Vector3 Support(const Maths::Vector3& direction, bool includeMargin) const
+			{
+				if (!hasCore)
+					return transform * shape->GetLocalSupport(worldToLocal * direction);
+
+				Maths::Vector3 point = Maths::Vector3::Dot(direction, coreEnd - coreStart) > 0.0f ? coreEnd : coreStart;
+				if (includeMargin)
+					point += direction.NormalizedOrDefault(Maths::Vector3(1.0f, 0.0f, 0.0f)) * margin;
+				return point;
+			}
+		};
+
+		SupportPoint GetSupport(const ConvexObject& a, const ConvexObject& b, const Maths::Vector3& direction, bool includeMargin)
+		{
+			SupportPoint support;
+			support.onA = a.Support(direction, includeMargin);
+			support.onB = b.Support(-direction, includeMargin);
+			support.point = support.onA - support.onB;
+			return support;
+		}
+
+		struct Simplex
+		{
+			SupportPoint points[4];
+			float weights[4];
+			u32 count = 0;
+
+			void Keep(u32 i0, float w0)
+			{
+				points[0] = points[i0];
+				weights[0] = w0;
+				count = 1;
+			}
+
+			void Keep(u32 i0, u32 i1, float w0, float w1)
+			{
+				SupportPoint p0 = points[i0], p1 = points[i1];
+				points[0] = p0; points[1] = p1;
+				weights[0] = w0; weights[1] = w1;
+				count = 2;
+			}
+
+			void Keep(u32 i0, u32 i1, u32 i2, float w0, float w1, float w2)
+			{
+				SupportPoint p0 = points[i0], p1 = points[i1], p2 = points[i2];
+				points[0] = p0; points[1] = p1; points[2] = p2;
+				weights[0] = w0; weights[1] = w1; weights[2] = w2;
+				count = 3;
+			}
+
+			void GetClosestPoints(Maths::Vector3& onA, Maths::Vector3& onB) const
+			{
+				onA = Maths::Vector3(0.0f);
+				onB = Maths::Vector3(0.0f);
+				for (u32 i = 0; i < count; i++)
+				{
+					onA += points[i].onA * weights[i];
+					onB += points[i].onB * weights[i];
+				}
+			}
+		};
+
+		// Closest point to the origin on the segment / triangle / tetrahedron, reducing the simplex to the
+		// feature it lies on (Ericson, Real-Time Collision Detection 5.1)
+		Maths::Vector3 SolveSegment(Simplex& simplex, u32 i0, u32 i1)
+		{
+			const Maths::Vector3 a = simplex.points[i0].point;
+			const Maths::Vector3 ab = simplex.points[i1].point - a;
+			const float lengthSq = ab.LengthSquared();
+			const float t = lengthSq > 0.0f ? -Maths::Vector3::Dot(a, ab) / lengthSq : 0.0f;
+
+			if (t <= 0.0f)
+			{
+				simplex.Keep(i0, 1.0f);
+				return a;
+			}
+
+			if (t >= 1.0f)
+			{
+				simplex.Keep(i1, 1.0f);
+				return simplex.points[0].point;
+			}
+
+			simplex.Keep(i0, i1, 1.0f - t, t);
+			return a + ab * t;
+		}
+
+		Maths::Vector3 SolveTriangle(Simplex& simplex, u32 i0, u32 i1, u32 i2)
+		{
+			const Maths::Vector3 a = simplex.points[i0].point;
+			const Maths::Vector3 b = simplex.points[i1].point;
+			const Maths::Vector3 c = simplex.points[i2].point;
+			const Maths::Vector3 ab = b - a;
+			const Maths::Vector3 ac = c - a;
+
+			const float d1 = -Maths::Vector3::Dot(ab, a);
+			const float d2 = -Maths::Vector3::Dot(ac, a);
+			if (d1 <= 0.0f && d2 <= 0.0f)
+			{
+				simplex.Keep(i0, 1.0f);
+				return a;
+			}
+
+			const float d3 = -Maths::Vector3::Dot(ab, b);
+			const float d4 = -Maths::Vector3::Dot(ac, b);
+			if (d3 >= 0.0f && d4 <= d3)
+			{
+				simplex.Keep(i1, 1.0f);
+				return b;
+			}
+
+			const float vc = d1 * d4 - d3 * d2;
+			if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+				return SolveSegment(simplex, i0, i1);
+
+			const float d5 = -Maths::Vector3::Dot(ab, c);
+			const float d6 = -Maths::Vector3::Dot(ac, c);
+			if (d6 >= 0.0f && d5 <= d6)
+			{
+				simplex.Keep(i2, 1.0f);
+				return c;
+			}
+
+			const float vb = d5 * d2 - d1 * d6;
+			if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+				return SolveSegment(simplex, i0, i2);
+
+			const float va = d3 * d6 - d5 * d4;
+			if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+				return SolveSegment(simplex, i1, i2);
+
+			const float sum = va + vb + vc;
+			if (sum <= 0.0f)
+			{
+				// Degenerate triangle, use its longest edge
+				const float ab2 = ab.LengthSquared(), ac2 = ac.LengthSquared(), bc2 = (c - b).LengthSquared();
+				if (ab2 >= ac2 && ab2 >= bc2)
+					return SolveSegment(simplex, i0, i1);
+				return ac2 >= bc2 ? SolveSegment(simplex, i0, i2) : SolveSegment(simplex, i1, i2);
+			}
+
+			const float v = vb / sum;
+			const float w = vc / sum;
+			simplex.Keep(i0, i1, i2, 1.0f - v - w, v, w);
+			return a + ab * v + ac * w;
+		}
+
+		Maths::Vector3 SolveTetrahedron(Simplex& simplex)
+		{
+			static const u32 faces[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+
+			Simplex best;
+			Maths::Vector3 closest;
+			float bestDistSq = FLT_MAX;
+			bool outside = false;
+
+			for (auto& face : faces)
+			{
+				const Maths::Vector3& a = simplex.points[face[0]].point;
+				const Maths::Vector3 normal = Maths::Vector3::Cross(simplex.points[face[1]].point - a, simplex.points[face[2]].point - a);
+				const float originSide = -Maths::Vector3::Dot(normal, a);
+				const float oppositeSide = Maths::Vector3::Dot(normal, simplex.points[face[3]].point - a);
+
+				// Flat tetrahedrons count as outside every face, EPA could not orient them
+				if (originSide * oppositeSide > 0.0f && fabs(oppositeSide) > EPATolerance * normal.Length())
+					continue;
+
+				outside = true;
+				Simplex candidate = simplex;
+				const Maths::Vector3 point = SolveTriangle(candidate, face[0], face[1], face[2]);
+				const float distSq = point.LengthSquared();
+				if (distSq < bestDistSq)
+				{
+					bestDistSq = distSq;
+					best = candidate;
+					closest = point;
+				}
+			}
+
+			if (!outside)
+				return Maths::Vector3(0.0f);
+
+			simplex = best;
+			return closest;
+		}
+
+		// Returns true if the shapes overlap, otherwise closest is the point of A - B nearest the origin.
+		// With earlyOut the search stops as soon as a seperating plane is found.
+		bool GJK(const ConvexObject& a, const ConvexObject& b, bool includeMargin, bool earlyOut, Simplex& simplex, Maths::Vector3& closest)
+		{
+			Maths::Vector3 direction = a.transform.Translation() - b.transform.Translation();
+			if (direction.LengthSquared() < GJKTolerance)
+				direction = Maths::Vector3(1.0f, 0.0f, 0.0f);
+
+			simplex.points[0] = GetSupport(a, b, -direction, includeMargin);
+			simplex.weights[0] = 1.0f;
+			simplex.count = 1;
+			closest = simplex.points[0].point;
+
+			for (u32 iteration = 0; iteration < MaxGJKIterations; iteration++)
+			{
+				const float distSq = closest.LengthSquared();
+				if (distSq < GJKTolerance * GJKTolerance)
+					return true;
+
+				const SupportPoint support = GetSupport(a, b, -closest, includeMargin);
+				const float progress = distSq - Maths::Vector3::Dot(closest, support.point);
+
+				if (earlyOut && Maths::Vector3::Dot(closest, support.point) > 0.0f)
+					return false;
+
+				// No more progress. Within EPATolerance of the origin counts as touching, the search direction
+				// is too noisy there to keep going.
+				if (progress <= GJKTolerance * distSq)
+					return distSq < EPATolerance * EPATolerance;
 
-	CollisionDetection::CollisionDetection()
+				for (u32 i = 0; i < simplex.count; i++)
+				{
+					if ((simplex.points[i].point - support.point).LengthSquared() < GJKTolerance * GJKTolerance)
+						return distSq < EPATolerance * EPATolerance;
+				}
+
+				simplex.points[simplex.count++] = support;
+
+				switch (simplex.count)
+				{
+				case 2: closest = SolveSegment(simplex, 0, 1); break;
+				case 3: closest = SolveTriangle(simplex, 0, 1, 2); break;
+				default: closest = SolveTetrahedron(simplex); break;
+				}
+
+				if (simplex.count == 4)
+					return true;
+			}
+
+			return closest.LengthSquared() < EPATolerance * EPATolerance;
+		}
+
+		// Grows a simplex that touches the origin into a tetrahedron around it
+		bool BuildTetrahedron(const ConvexObject& a, const ConvexObject& b, Simplex& simplex)
+		{
+			static const Maths::Vector3 axes[6] = {
+				Maths::Vector3(1.0f, 0.0f, 0.0f), Maths::Vector3(-1.0f, 0.0f, 0.0f),
+				Maths::Vector3(0.0f, 1.0f, 0.0f), Maths::Vector3(0.0f, -1.0f, 0.0f),
+				Maths::Vector3(0.0f, 0.0f, 1.0f), Maths::Vector3(0.0f, 0.0f, -1.0f) };
+
+			if (simplex.count == 1)
+			{
+				for (auto& axis : axes)
+				{
+					SupportPoint support = GetSupport(a, b, axis, true);
+					if ((support.point - simplex.points[0].point).LengthSquared() > EPATolerance)
+					{
+						simplex.points[simplex.count++] = support;
+						break;
+					}
+				}
+			}
+
+			if (simplex.count == 2)
+			{
+				const Maths::Vector3 line = simplex.points[1].point - simplex.points[0].point;
+				Maths::Vector3 perpendicular = Maths::Vector3::Cross(line, fabs(line.x) < 0.57f ? axes[0] : axes[2]);
+				for (u32 i = 0; i < 4 && simplex.count == 2; i++)
+				{
+					SupportPoint support = GetSupport(a, b, perpendicular, true);
+					if (Maths::Vector3::Cross(support.point - simplex.points[0].point, line).LengthSquared() > EPATolerance * line.LengthSquared())
+						simplex.points[simplex.count++] = support;
+					perpendicular = i == 1 ? Maths::Vector3::Cross(line, perpendicular) : -perpendicular;
+				}
+			}
+
+			if (simplex.count == 3)
+			{
+				const Maths::Vector3 normal = Maths::Vector3::Cross(simplex.points[1].point - simplex.points[0].point, simplex.points[2].point - simplex.points[0].point);
+				for (float sign : { 1.0f, -1.0f })
+				{
+					SupportPoint support = GetSupport(a, b, normal * sign, true);
+					if (fabs(Maths::Vector3::Dot(support.point - simplex.points[0].point, normal)) > EPATolerance * normal.Length())
+					{
+						simplex.points[simplex.count++] = support;
+						break;
+					}
+				}
+			}
+
+			return simplex.count == 4;
+		}
+
+		struct EPAFace
+		{
+			u32 index[3];
+			Maths::Vector3 normal;
+			float distance;
+		};
+
+		// Expanding polytope from a tetrahedron containing the origin. Finds the face of A - B nearest
+		// the origin, whose normal and distance are the penetration normal and depth.
+		bool EPA(const ConvexObject& a, const ConvexObject& b, const Simplex& simplex, CollisionData* out_coldata)
+		{
+			const u32 MaxVertices = MaxEPAIterations + 4;
+			const u32 MaxFaces = MaxVertices * 2;
+
+			SupportPoint vertices[MaxVertices];
+			EPAFace faces[MaxFaces];
+			std::pair<u32, u32> horizon[MaxFaces];
+			u32 vertexCount = 4, faceCount = 0;
+
+			Maths::Vector3 centre(0.0f);
+			for (u32 i = 0; i < 4; i++)
+			{
+				vertices[i] = simplex.points[i];
+				centre += vertices[i].point * 0.25f;
+			}
+
+			auto addFace = [&](u32 i0, u32 i1, u32 i2)
+			{
+				EPAFace& face = faces[faceCount++];
+				face.index[0] = i0; face.index[1] = i1; face.index[2] = i2;
+				face.normal = Maths::Vector3::Cross(vertices[i1].point - vertices[i0].point, vertices[i2].point - vertices[i0].point).NormalizedOrDefault();
+				// Slivers have no usable normal, never pick them as the closest face
+				face.distance = face.normal == Maths::Vector3::ZERO ? FLT_MAX : Maths::Vector3::Dot(face.normal, vertices[i0].point);
+			};
+
+			static const u32 tetrahedron[4][3] = { { 0, 1, 2 }, { 0, 3, 1 }, { 0, 2, 3 }, { 1, 3, 2 } };
+			for (auto& tri : tetrahedron)
+			{
+				addFace(tri[0], tri[1], tri[2]);
+				EPAFace& face = faces[faceCount - 1];
+				if (Maths::Vector3::Dot(face.normal, vertices[tri[0]].point - centre) < 0.0f)
+				{
+					std::swap(face.index[1], face.index[2]);
+					face.normal = -face.normal;
+					face.distance = -face.distance;
+				}
+			}
+
+			auto findClosestFace = [&]()
+			{
+				u32 closest = 0;
+				for (u32 i = 1; i < faceCount; i++)
+				{
+					if (faces[i].distance < faces[closest].distance)
+						closest = i;
+				}
+				return closest;
+			};
+
+			for (u32 iteration = 0; iteration < MaxEPAIterations; iteration++)
+			{
+				const EPAFace& closest = faces[findClosestFace()];
+				const SupportPoint support = GetSupport(a, b, closest.normal, true);
+				if (Maths::Vector3::Dot(closest.normal, support.point) - closest.distance < EPATolerance || vertexCount == MaxVertices)
+					break;
+
+				// Remove every face the new point can see, keeping the edges around the hole
+				u32 horizonCount = 0;
+				for (u32 i = 0; i < faceCount;)
+				{
+					// Faces the point only grazes are kept, removing them can leave a hole that is not a disk
+					if (Maths::Vector3::Dot(faces[i].normal, support.point - vertices[faces[i].index[0]].point) <= EPAVisibleTolerance)
+					{
+						i++;
+						continue;
+					}
+
+					for (u32 e = 0; e < 3; e++)
+					{
+						const std::pair<u32, u32> edge(faces[i].index[e], faces[i].index[(e + 1) % 3]);
+						bool shared = false;
+						for (u32 h = 0; h < horizonCount; h++)
+						{
+							if (horizon[h].first == edge.second && horizon[h].second == edge.first)
+							{
+								horizon[h] = horizon[--horizonCount];
+								shared = true;
+								break;
+							}
+						}
+
+						if (!shared)
+							horizon[horizonCount++] = edge;
+					}
+
+					faces[i] = faces[--faceCount];
+				}
+
+				if (horizonCount == 0 || faceCount + horizonCount > MaxFaces)
+					break;
+
+				vertices[vertexCount] = support;
+				for (u32 h = 0; h < horizonCount; h++)
+					addFace(horizon[h].first, horizon[h].second, vertexCount);
+				vertexCount++;
+			}
+
+			if (faceCount == 0)
+				return false;
+
+			const EPAFace& face = faces[findClosestFace()];
+			if (face.distance == FLT_MAX)
+				return false;
+
+			const SupportPoint& v0 = vertices[face.index[0]];
+			const SupportPoint& v1 = vertices[face.index[1]];
+			const SupportPoint& v2 = vertices[face.index[2]];
+
+			// Barycentric coordinates of the origin's projection onto the face give the witness points
+			const Maths::Vector3 projection = face.normal * face.distance;
+			const Maths::Vector3 e0 = v1.point - v0.point, e1 = v2.point - v0.point, ep = projection - v0.point;
+			const float d00 = Maths::Vector3::Dot(e0, e0), d01 = Maths::Vector3::Dot(e0, e1), d11 = Maths::Vector3::Dot(e1, e1);
+			const float d20 = Maths::Vector3::Dot(ep, e0), d21 = Maths::Vector3::Dot(ep, e1);
+			const float denom = d00 * d11 - d01 * d01;
+
+			float v = 0.0f, w = 0.0f;
+			if (fabs(denom) > FLT_EPSILON)
+			{
+				v = (d11 * d20 - d01 * d21) / denom;
+				w = (d00 * d21 - d01 * d20) / denom;
+			}
+			const float u = 1.0f - v - w;
+
+			if (out_coldata)
+			{
+				// A - B is nearest the origin along the face normal, so B lies that way from A
+				out_coldata->normal = face.normal;
+				out_coldata->penetration = -face.distance;
+				out_coldata->pointOnA = v0.onA * u + v1.onA * v + v2.onA * w;
+				out_coldata->pointOnB = v0.onB * u + v1.onB * v + v2.onB * w;
+				out_coldata->pointOnPlane = out_coldata->pointOnA;
+			}
+
+			return true;
+		}
+	}
+
+	bool CollisionDetection::CheckCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
 	{
-		//max actual size
-		unsigned int maxSize = CollisionShapeTypeMax | (CollisionShapeTypeMax >> 1);
-		m_CollisionCheckFunctions = lmnew CollisionCheckFunc[maxSize];
-		std::fill(m_CollisionCheckFunctions, m_CollisionCheckFunctions + maxSize, &CollisionDetection::InvalidCheckCollision);
-
-		m_CollisionCheckFunctions[CollisionSphere] = &CollisionDetection::CheckSphereCollision;
-		m_CollisionCheckFunctions[CollisionCuboid] = &CollisionDetection::CheckPolyhedronCollision;
-		m_CollisionCheckFunctions[CollisionSphere | CollisionCuboid] = &CollisionDetection::CheckPolyhedronSphereCollision;
+		const ConvexObject a(obj1, shape1);
+		const ConvexObject b(obj2, shape2);
+		const float margin = a.margin + b.margin;
+
+		Simplex simplex;
+		Maths::Vector3 closest;
+
+		if (margin > 0.0f)
+		{
+			// Curved shapes : the cores only need to come within the summed radius
+			if (!GJK(a, b, false, false, simplex, closest))
+			{
+				const float distance = closest.Length();
+				if (distance > margin)
+					return false;
+
+				if (distance > CoreOverlapDistance)
+				{
+					if (out_coldata)
+					{
+						Maths::Vector3 coreOnA, coreOnB;
+						simplex.GetClosestPoints(coreOnA, coreOnB);
+
+						out_coldata->normal = -closest / distance;
+						out_coldata->penetration = distance - margin;
+						out_coldata->pointOnA = coreOnA + out_coldata->normal * a.margin;
+						out_coldata->pointOnB = coreOnB - out_coldata->normal * b.margin;
+						out_coldata->pointOnPlane = out_coldata->pointOnA;
+					}
+					return true;
+				}
+			}
+
+			// The cores overlap, run the full shapes through EPA
+			if (!GJK(a, b, true, false, simplex, closest))
+				return false;
+		}
+		else if (!GJK(a, b, false, out_coldata == nullptr, simplex, closest))
+			return false;
+
+		if (simplex.count < 4 && !BuildTetrahedron(a, b, simplex))
+			return false;
+
+		return EPA(a, b, simplex, out_coldata);
 	}
 
+	float CollisionDetection::GetDistance(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, Maths::Vector3* out_pointOnA, Maths::Vector3* out_pointOnB) const
+	{
+		const ConvexObject a(obj1, shape1);
+		const ConvexObject b(obj2, shape2);
+
+		Simplex simplex;
+		Maths::Vector3 closest;
+		if (GJK(a, b, false, false, simplex, closest))
+			return 0.0f;
+
+		const float coreDistance = closest.Length();
+		const float distance = coreDistance - a.margin - b.margin;
+		if (distance <= 0.0f)
+			return 0.0f;
 
-	bool CollisionDetection::InvalidCheckCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
+		Maths::Vector3 onA, onB;
+		simplex.GetClosestPoints(onA, onB);
+
+		const Maths::Vector3 normal = -closest / coreDistance;
+		if (out_pointOnA)
+			*out_pointOnA = onA + normal * a.margin;
+		if (out_pointOnB)
+			*out_pointOnB = onB - normal * b.margin;
+
+		return distance;
+	}
+
+	bool CollisionDetection::TimeOfImpact(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, const Maths::Vector3& motion, float tolerance, float* out_toi, CollisionData* out_coldata) const
 	{
-		LUMOS_LOG_CRITICAL("Invalid Collision type specified");
+		ConvexObject a(obj1, shape1);
+		const ConvexObject b(obj2, shape2);
+
+		// Conservative advancement. Under pure translation the distance is convex in t, so stepping by
+		// distance / closing speed along the current normal never passes the first contact.
+		float t = 0.0f;
+		for (u32 i = 0; i < MaxTOIIterations; i++)
+		{
+			Simplex simplex;
+			Maths::Vector3 closest;
+
+			// Overlaps are left to the discrete narrowphase, advancement stops short of them
+			if (GJK(a, b, false, false, simplex, closest))
+				return false;
+
+			const float coreDistance = closest.Length();
+			const float distance = coreDistance - a.margin - b.margin;
+			const Maths::Vector3 normal = -closest / coreDistance;
+
+			if (distance <= tolerance || i == MaxTOIIterations - 1)
+			{
+				if (out_coldata)
+				{
+					Maths::Vector3 onA, onB;
+					simplex.GetClosestPoints(onA, onB);
+
+					out_coldata->normal = normal;
+					out_coldata->penetration = Maths::Max(distance, 0.0f);
+					out_coldata->pointOnA = onA + normal * a.margin;
+					out_coldata->pointOnB = onB - normal * b.margin;
+					out_coldata->pointOnPlane = out_coldata->pointOnB;
+				}
+
+				if (out_toi)
+					*out_toi = t;
+				return true;
+			}
+
+			const float closingSpeed = Maths::Vector3::Dot(motion, normal);
+			if (closingSpeed <= 0.0f)
+				return false;
+
+			const float step = (distance - tolerance * 0.5f) / closingSpeed;
+			if (t + step > 1.0f)
+				return false;
+
+			t += step;
+			a.Translate(motion * step);
+		}
+
 		return false;
 	}
 
+	bool CollisionDetection::CheckCollisionSAT(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
+	{
+		const bool sphere1 = shape1->GetType() == CollisionSphere;
+		const bool sphere2 = shape2->GetType() == CollisionSphere;
+
+		if (shape1->GetType() == CollisionCapsule || shape2->GetType() == CollisionCapsule)
+		{
+			LUMOS_LOG_CRITICAL("Invalid Collision type specified");
+			return false;
+		}
+
+		if (sphere1 && sphere2)
+			return CheckSphereCollision(obj1, obj2, shape1, shape2, out_coldata);
+		if (sphere1 || sphere2)
+			return CheckPolyhedronSphereCollision(obj1, obj2, shape1, shape2, out_coldata);
+
+		return CheckPolyhedronCollision(obj1, obj2, shape1, shape2, out_coldata);
+	}
+
 	bool CollisionDetection::CheckSphereCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const
 	{
 		CollisionData colData;
@@ -33,6 +666,9 @@ namespace Lumos
 		if (!CheckCollisionAxis(axis, obj1, obj2, shape1, shape2, &colData))
 			return false;
 
+		colData.pointOnA = obj1->GetPosition() + colData.normal * static_cast<const SphereCollisionShape*>(shape1)->GetRadius();
+		colData.pointOnB = obj2->GetPosition() - colData.normal * static_cast<const SphereCollisionShape*>(shape2)->GetRadius();
+
 		if (out_coldata)
 			*out_coldata = colData;
 
@@ -207,12 +843,21 @@ namespace Lumos
 		shape1->GetIncidentReferencePolygon(obj1, coldata.normal, &polygon1, &normal1, &adjPlanes1);
 		shape2->GetIncidentReferencePolygon(obj2, -coldata.normal, &polygon2, &normal2, &adjPlanes2);
 
+		// Curved shapes have no faces to clip against and only return their support points
 		if (polygon1.empty() || polygon2.empty())
 			return false;
-		else if (polygon1.size() == 1)
-			manifold->AddContact(polygon1.front(), polygon1.front() - coldata.normal * coldata.penetration, coldata.normal, coldata.penetration);
-		else if (polygon2.size() == 1)
-			manifold->AddContact(polygon2.front() + coldata.normal * coldata.penetration, polygon2.front(), coldata.normal, coldata.penetration);
+		else if (adjPlanes1.empty() && adjPlanes2.empty())
+			manifold->AddContact(coldata.pointOnA, coldata.pointOnA - coldata.normal * coldata.penetration, coldata.normal, coldata.penetration);
+		else if (adjPlanes1.empty())
+		{
+			for (const Maths::Vector3& point : polygon1)
+				manifold->AddContact(point, point - coldata.normal * coldata.penetration, coldata.normal, coldata.penetration);
+		}
+		else if (adjPlanes2.empty())
+		{
+			for (const Maths::Vector3& point : polygon2)
+				manifold->AddContact(point + coldata.normal * coldata.penetration, point, coldata.normal, coldata.penetration);
+		}
 		else 
 		{
 			bool flipped;
@@ -5,8 +5,6 @@
 #include "Manifold.h"
 #include "Utilities/TSingleton.h"
 
-#define CALL_MEMBER_FN(instance, ptrToMemberFn)  ((instance).*(ptrToMemberFn))
-
 namespace Lumos
 {
 	struct LUMOS_EXPORT CollisionData
@@ -14,27 +12,37 @@ namespace Lumos
 		float penetration;
 		Maths::Vector3 normal;
 		Maths::Vector3 pointOnPlane;
+
+		// Deepest point of each object inside the other, used for contacts between two curved shapes
+		Maths::Vector3 pointOnA;
+		Maths::Vector3 pointOnB;
 	};
 
+	// Narrowphase for any pair of convex shapes. Overlap and separation come from GJK on the shapes'
+	// support functions and penetration from EPA, so a new shape only needs GetLocalSupport.
+	// Spheres and capsules are run through GJK as a point / segment plus a radius, which keeps their
+	// results exact and only falls back to EPA when the cores themselves overlap.
 	class LUMOS_EXPORT CollisionDetection : public TSingleton<CollisionDetection>
 	{
 		friend class TSingleton<CollisionDetection>;
-		typedef  bool (CollisionDetection::*CollisionCheckFunc)(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata) const;
-
-		CollisionCheckFunc* m_CollisionCheckFunctions;
 
 	public:
-		CollisionDetection();
-		~CollisionDetection()
-		{
-			if (m_CollisionCheckFunctions)	
-				delete[] m_CollisionCheckFunctions;
-		}
+		CollisionDetection() = default;
+		~CollisionDetection() = default;
 
-		_FORCE_INLINE_ bool CheckCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const 
-		{
-			return CALL_MEMBER_FN(*this, m_CollisionCheckFunctions[shape1->GetType() | shape2->GetType()])(obj1, obj2, shape1, shape2, out_coldata);
-		}
+		// Normal points from obj1 to obj2 and penetration is negative while overlapping
+		bool CheckCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
+
+		// Seperating axis test used before GJK / EPA. Handles spheres and any shape with faces, not capsules.
+		bool CheckCollisionSAT(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
+
+		// Distance between the shapes' surfaces, 0 if they overlap. Closest points are written when apart.
+		float GetDistance(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, Maths::Vector3* out_pointOnA = nullptr, Maths::Vector3* out_pointOnB = nullptr) const;
+
+		// Sweeps obj1 by motion from its current position against obj2 held still. On a hit out_toi is the
+		// fraction of motion travelled before the surfaces come within tolerance, and out_coldata holds the
+		// contact normal, the closest points and the remaining gap as a positive penetration.
+		bool TimeOfImpact(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, const Maths::Vector3& motion, float tolerance, float* out_toi, CollisionData* out_coldata = nullptr) const;
 
 		bool BuildCollisionManifold(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, const CollisionData& coldata, Manifold* out_manifold) const;
 
@@ -108,7 +116,6 @@ namespace Lumos
 		bool CheckPolyhedronCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
 		bool CheckPolyhedronSphereCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
 		bool CheckSphereCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const ;
-		bool InvalidCheckCollision(const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata = nullptr) const;
 		static bool CheckCollisionAxis(const Maths::Vector3& axis, const PhysicsObject3D* obj1, const PhysicsObject3D* obj2, const CollisionShape* shape1, const CollisionShape* shape2, CollisionData* out_coldata);
 
 		static Maths::Vector3 GetClosestPointOnEdges(const Maths::Vector3& target, const std::vector<CollisionEdge>& edges);
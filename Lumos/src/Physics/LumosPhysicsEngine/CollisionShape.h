@@ -21,6 +21,7 @@ namespace Lumos
 		CollisionSphere = 2,
 		CollisionPyramid = 3,
         CollisionCapsule = 4,
+		CollisionHull = 5,
 		CollisionShapeTypeMax
 	};
 
@@ -58,6 +59,11 @@ namespace Lumos
 			const Maths::Vector3& axis, Maths::Vector3* out_min,
 			Maths::Vector3* out_max) const = 0;
 
+		// Get the furthest point of the shape along a direction
+		//	- Direction and result are in the shape's own space, before m_LocalTransform is applied.
+		//    This is all GJK / EPA need to know about a shape.
+		virtual Maths::Vector3 GetLocalSupport(const Maths::Vector3& localDirection) const = 0;
+
 		// Get all data needed to build manifold
 		//	- Computes the face that is closest to parallel to that of the given axis,
 		//    returning the face (as a list of vertices), face normal and the planes
@@ -69,6 +75,7 @@ namespace Lumos
 			std::vector<Maths::Plane>* out_adjacent_planes) const = 0;
 
 		void SetLocalTransform(const Maths::Matrix4& transform){ m_LocalTransform = transform; }
+		const Maths::Matrix4& GetLocalTransform() const { return m_LocalTransform; }
 
 		_FORCE_INLINE_ CollisionShapeType GetType() const { return m_Type; }
 
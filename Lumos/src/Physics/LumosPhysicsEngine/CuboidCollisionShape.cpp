@@ -99,6 +99,14 @@ namespace Lumos
 		
 	}
 
+	Maths::Vector3 CuboidCollisionShape::GetLocalSupport(const Maths::Vector3& localDirection) const
+	{
+		// Corner of the unit cube hull, no need to walk its vertices
+		return Maths::Vector3(localDirection.x >= 0.0f ? 1.0f : -1.0f,
+			localDirection.y >= 0.0f ? 1.0f : -1.0f,
+			localDirection.z >= 0.0f ? 1.0f : -1.0f);
+	}
+
 	void CuboidCollisionShape::GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
 	{
 		Maths::Matrix4 wsTransform;
@@ -0,0 +1,237 @@
+#include "lmpch.h"
+#include "HullCollisionShape.h"
+#include "PhysicsObject3D.h"
+#include "Maths/Matrix3.h"
+#include "Graphics/Renderers/DebugRenderer.h"
+
+namespace Lumos
+{
+	HullCollisionShape::HullCollisionShape(const Ref<Hull>& hull)
+		: m_Hull(hull)
+	{
+		m_Type = CollisionShapeType::CollisionHull;
+		ComputeBounds();
+	}
+
+	HullCollisionShape::HullCollisionShape(const std::vector<Maths::Vector3>& points)
+		: m_Hull(CreateRef<Hull>())
+	{
+		for (auto& point : points)
+			m_Hull->AddVertex(point);
+
+		m_Type = CollisionShapeType::CollisionHull;
+		ComputeBounds();
+	}
+
+	HullCollisionShape::~HullCollisionShape()
+	{
+	}
+
+	void HullCollisionShape::ComputeBounds()
+	{
+		Maths::Vector3 minPoint(FLT_MAX), maxPoint(-FLT_MAX);
+		m_Radius = 0.0f;
+
+		for (size_t i = 0; i < m_Hull->GetNumVertices(); ++i)
+		{
+			const Maths::Vector3& pos = m_Hull->GetVertex(static_cast<int>(i)).pos;
+			minPoint = Maths::Vector3(Maths::Min(minPoint.x, pos.x), Maths::Min(minPoint.y, pos.y), Maths::Min(minPoint.z, pos.z));
+			maxPoint = Maths::Vector3(Maths::Max(maxPoint.x, pos.x), Maths::Max(maxPoint.y, pos.y), Maths::Max(maxPoint.z, pos.z));
+			m_Radius = Maths::Max(m_Radius, pos.Length());
+		}
+
+		m_HalfExtents = m_Hull->GetNumVertices() > 0 ? (maxPoint - minPoint) * 0.5f : Maths::Vector3(0.0f);
+	}
+
+	Maths::Matrix3 HullCollisionShape::BuildInverseInertia(float invMass) const
+	{
+		// Approximated by the hull's bounding box
+		Maths::Matrix3 inertia;
+
+		Maths::Vector3 dimsSq = (m_HalfExtents + m_HalfExtents);
+		dimsSq = dimsSq * dimsSq;
+
+		inertia.m00_ = 12.f * invMass * 1.f / (dimsSq.y + dimsSq.z);
+		inertia.m11_ = 12.f * invMass * 1.f / (dimsSq.x + dimsSq.z);
+		inertia.m22_ = 12.f * invMass * 1.f / (dimsSq.x + dimsSq.y);
+
+		return inertia;
+	}
+
+	void HullCollisionShape::GetCollisionAxes(const PhysicsObject3D* currentObject, std::vector<Maths::Vector3>* out_axes) const
+	{
+		if (out_axes)
+		{
+			Maths::Matrix3 normalMatrix = (currentObject->GetWorldSpaceTransform() * m_LocalTransform).ToMatrix3().Inverse().Transpose();
+			for (size_t i = 0; i < m_Hull->GetNumFaces(); ++i)
+			{
+				Maths::Vector3 axis = normalMatrix * m_Hull->GetFace(static_cast<int>(i)).normal;
+				axis.Normalize();
+
+				bool duplicate = false;
+				for (const Maths::Vector3& existing : *out_axes)
+				{
+					if (fabs(Maths::Vector3::Dot(axis, existing)) >= 0.9999f)
+					{
+						duplicate = true;
+						break;
+					}
+				}
+
+				if (!duplicate)
+					out_axes->push_back(axis);
+			}
+		}
+	}
+
+	void HullCollisionShape::GetEdges(const PhysicsObject3D* currentObject, std::vector<CollisionEdge>* out_edges) const
+	{
+		if (out_edges)
+		{
+			Maths::Matrix4 transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
+			for (unsigned int i = 0; i < m_Hull->GetNumEdges(); ++i)
+			{
+				const HullEdge& edge = m_Hull->GetEdge(i);
+				Maths::Vector3 A = transform * m_Hull->GetVertex(edge.vStart).pos;
+				Maths::Vector3 B = transform * m_Hull->GetVertex(edge.vEnd).pos;
+
+				out_edges->emplace_back(A, B);
+			}
+		}
+	}
+
+	void HullCollisionShape::GetMinMaxVertexOnAxis(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const
+	{
+		Maths::Matrix4 wsTransform;
+
+		if (currentObject == nullptr)
+			wsTransform = m_LocalTransform;
+		else
+			wsTransform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
+
+		Maths::Matrix3 invNormalMatrix = Maths::Matrix3::Transpose(wsTransform.ToMatrix3());
+		Maths::Vector3 local_axis = invNormalMatrix * axis;
+
+		int vMin, vMax;
+
+		m_Hull->GetMinMaxVerticesInAxis(local_axis, &vMin, &vMax);
+
+		if (out_min) *out_min = wsTransform * m_Hull->GetVertex(vMin).pos;
+		if (out_max) *out_max = wsTransform * m_Hull->GetVertex(vMax).pos;
+	}
+
+	Maths::Vector3 HullCollisionShape::GetLocalSupport(const Maths::Vector3& localDirection) const
+	{
+		int vMax;
+		m_Hull->GetMinMaxVerticesInAxis(localDirection, nullptr, &vMax);
+		return m_Hull->GetVertex(vMax).pos;
+	}
+
+	void HullCollisionShape::GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
+	{
+		Maths::Matrix4 wsTransform;
+
+		if (currentObject == nullptr)
+			wsTransform = m_LocalTransform;
+		else
+			wsTransform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
+
+		Maths::Matrix3 transposeMatrix = Maths::Matrix3::Transpose(wsTransform.ToMatrix3());
+		Maths::Matrix3 normalMatrix = wsTransform.ToMatrix3().Inverse().Transpose();
+
+		Maths::Vector3 local_axis = transposeMatrix * axis;
+
+		int minVertex, maxVertex;
+		m_Hull->GetMinMaxVerticesInAxis(local_axis, &minVertex, &maxVertex);
+
+		const HullVertex& vert = m_Hull->GetVertex(maxVertex);
+
+		// Without faces the hull touches through its furthest vertex, like a sphere
+		if (vert.enclosing_faces.empty())
+		{
+			if (out_face)
+				out_face->push_back(wsTransform * vert.pos);
+
+			if (out_normal)
+				*out_normal = axis;
+
+			return;
+		}
+
+		const HullFace* best_face = nullptr;
+		float best_correlation = -FLT_MAX;
+		for (int faceIdx : vert.enclosing_faces)
+		{
+			const HullFace* face = &m_Hull->GetFace(faceIdx);
+			Maths::Vector3 wsNormal = normalMatrix * face->normal;
+			wsNormal.Normalize();
+			float temp_correlation = Maths::Vector3::Dot(axis, wsNormal);
+			if (temp_correlation > best_correlation)
+			{
+				best_correlation = temp_correlation;
+				best_face = face;
+			}
+		}
+
+		if (out_normal)
+		{
+			*out_normal = normalMatrix * best_face->normal;
+			(*out_normal).Normalize();
+		}
+
+		if (out_face)
+		{
+			for (int vertIdx : best_face->vert_ids)
+			{
+				const HullVertex& currentVert = m_Hull->GetVertex(vertIdx);
+				out_face->push_back(wsTransform * currentVert.pos);
+			}
+		}
+
+		if (out_adjacent_planes)
+		{
+			//Add the reference face itself to the list of adjacent planes
+			Maths::Vector3 wsPointOnPlane = wsTransform * m_Hull->GetVertex(m_Hull->GetEdge(best_face->edge_ids[0]).vStart).pos;
+			Maths::Vector3 planeNrml = -(normalMatrix * best_face->normal);
+			planeNrml.Normalize();
+			float planeDist = -Maths::Vector3::Dot(planeNrml, wsPointOnPlane);
+
+			out_adjacent_planes->emplace_back(planeNrml, planeDist);
+
+			for (int edgeIdx : best_face->edge_ids)
+			{
+				const HullEdge& edge = m_Hull->GetEdge(edgeIdx);
+
+				wsPointOnPlane = wsTransform * m_Hull->GetVertex(edge.vStart).pos;
+
+				for (int adjFaceIdx : edge.enclosing_faces)
+				{
+					if (adjFaceIdx != best_face->idx)
+					{
+						const HullFace& adjFace = m_Hull->GetFace(adjFaceIdx);
+
+						planeNrml = -(normalMatrix * adjFace.normal);
+						planeNrml.Normalize();
+						planeDist = -Maths::Vector3::Dot(planeNrml, wsPointOnPlane);
+
+						out_adjacent_planes->emplace_back(planeNrml, planeDist);
+					}
+				}
+			}
+		}
+	}
+
+	void HullCollisionShape::DebugDraw(const PhysicsObject3D* currentObject) const
+	{
+		Maths::Matrix4 transform = currentObject->GetWorldSpaceTransform() * m_LocalTransform;
+
+		if (m_Hull->GetNumEdges() == 0)
+		{
+			for (size_t i = 0; i < m_Hull->GetNumVertices(); ++i)
+				DebugRenderer::DrawPoint(transform * m_Hull->GetVertex(static_cast<int>(i)).pos, 0.02f, Maths::Vector4(0.7f, 0.2f, 0.7f, 1.0f));
+			return;
+		}
+
+		m_Hull->DebugDraw(transform);
+	}
+}
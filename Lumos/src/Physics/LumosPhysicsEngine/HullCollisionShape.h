@@ -0,0 +1,42 @@
+#pragma once
+#include "lmpch.h"
+#include "CollisionShape.h"
+#include "Hull.h"
+
+namespace Lumos
+{
+	// Any convex polyhedron. A hull built with faces gets face clipped contacts like the cuboid,
+	// a hull of vertices only (e.g. a mesh's points) collides through its support points alone.
+	class LUMOS_EXPORT HullCollisionShape : public CollisionShape
+	{
+	public:
+		explicit HullCollisionShape(const Ref<Hull>& hull);
+		explicit HullCollisionShape(const std::vector<Maths::Vector3>& points);
+		~HullCollisionShape();
+
+		//Collision Shape Functionality
+		virtual Maths::Matrix3 BuildInverseInertia(float invMass) const override;
+
+		virtual void GetCollisionAxes(const PhysicsObject3D* currentObject, std::vector<Maths::Vector3>* out_axes) const override;
+		virtual void GetEdges(const PhysicsObject3D* currentObject, std::vector<CollisionEdge>* out_edges) const override;
+
+		virtual void GetMinMaxVertexOnAxis(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const override;
+		virtual void GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const override;
+		virtual Maths::Vector3 GetLocalSupport(const Maths::Vector3& localDirection) const override;
+
+		virtual void DebugDraw(const PhysicsObject3D* currentObject) const override;
+
+		const Ref<Hull>& GetHull() const { return m_Hull; }
+		const Maths::Vector3& GetHalfExtents() const { return m_HalfExtents; }
+
+		virtual float GetSize() const override { return m_Radius; }
+
+	protected:
+		void ComputeBounds();
+
+	protected:
+		Ref<Hull> m_Hull;
+		Maths::Vector3 m_HalfExtents;
+		float m_Radius;
+	};
+}
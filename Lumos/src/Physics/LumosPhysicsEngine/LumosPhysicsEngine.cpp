@@ -57,6 +57,11 @@ namespace Lumos
 		CollisionDetection::Release();
 	}
 
+	void LumosPhysicsEngine::DeclareAccess(SystemAccess& access)
+	{
+		access.Write<Physics3DComponent>().Write<Maths::Transform>().Write<LumosPhysicsEngine>();
+	}
+
 	void LumosPhysicsEngine::OnUpdate(const TimeStep& timeStep, Scene* scene)
 	{
         LUMOS_PROFILE_BLOCK("LumosPhysicsEngine::OnUpdate");
@@ -130,9 +135,19 @@ namespace Lumos
 		
 		//Solve collision constraints
 		SolveConstraints();
+
+		m_ContinuousObjects.clear();
+		for (auto& obj : m_PhysicsObjects)
+		{
+			if (obj->GetContinuousCollision() && !obj->GetIsStatic() && obj->IsAwake() && obj->GetCollisionShape())
+				m_ContinuousObjects.push_back({ obj.get(), obj->GetPosition() });
+		}
 		
 		//Update movement
 		UpdatePhysicsObjects();
+
+		//Catch fast objects that passed through something
+		ContinuousCollisions();
 	}
 
 	void LumosPhysicsEngine::UpdatePhysicsObjects()
@@ -287,7 +302,7 @@ namespace Lumos
 
 				if (shapeA && shapeB)
 				{
-					// Detects if the objects are colliding - Seperating Axis Theorem
+					// Detects if the objects are colliding - GJK / EPA
 					if (CollisionDetection::Instance()->CheckCollision(cp.pObjectA, cp.pObjectB, shapeA.get(), shapeB.get(), &colData))
 					{
 						// Check to see if any of the objects have collision callbacks that dont
@@ -325,6 +340,100 @@ namespace Lumos
 		}
 	}
 
+	void LumosPhysicsEngine::ContinuousCollisions()
+	{
+		m_ContinuousHits = 0;
+
+		for (auto& continuous : m_ContinuousObjects)
+		{
+			PhysicsObject3D* obj = continuous.object;
+			Maths::Vector3 motion = obj->GetPosition() - continuous.start;
+
+			// An object moving less than half its thickness still overlaps anything it crossed
+			const Maths::Vector3 size = obj->GetLocalBoundingBox().Size();
+			const float thickness = Maths::Min(size.x, Maths::Min(size.y, size.z));
+			if (motion.LengthSquared() <= Maths::Squared(thickness * 0.5f))
+				continue;
+
+			// Orientation keeps its integrated value, only the translation is swept
+			obj->SetPosition(continuous.start);
+
+			float timeLeft = s_UpdateTimestep;
+			for (u32 i = 0; i < CONTINUOUS_SUBSTEPS && timeLeft > 0.0f; i++)
+			{
+				timeLeft = SweepContinuousObject(obj, motion, timeLeft);
+
+				// The rest of the step carries on with the velocity left after the contact
+				motion = obj->GetLinearVelocity() * timeLeft;
+			}
+		}
+	}
+
+	float LumosPhysicsEngine::SweepContinuousObject(PhysicsObject3D* obj, const Maths::Vector3& motion, float timeStep)
+	{
+		const float tolerance = 0.005f;
+
+		// Candidates are whatever the swept bounds touch, other objects are held at their end of step positions
+		Maths::BoundingBox swept = obj->GetWorldSpaceAABB();
+		swept.Merge(Maths::BoundingBox(swept.min_ + motion, swept.max_ + motion));
+
+		CollisionDetection* detection = CollisionDetection::Instance();
+		PhysicsObject3D* hitObject = nullptr;
+		CollisionData hitData;
+		float hitTime = 1.0f;
+
+		for (auto& other : m_PhysicsObjects)
+		{
+			if (other.get() == obj || !other->GetCollisionShape())
+				continue;
+
+			if (swept.IsInside(other->GetWorldSpaceAABB()) == Maths::OUTSIDE)
+				continue;
+
+			float toi;
+			CollisionData colData;
+			if (detection->TimeOfImpact(obj, other.get(), obj->GetCollisionShape().get(), other->GetCollisionShape().get(), motion, tolerance, &toi, &colData) && toi < hitTime)
+			{
+				hitTime = toi;
+				hitObject = other.get();
+				hitData = colData;
+			}
+		}
+
+		bool handleCollision = hitObject != nullptr;
+		if (handleCollision)
+		{
+			const bool okA = obj->FireOnCollisionEvent(obj, hitObject);
+			const bool okB = hitObject->FireOnCollisionEvent(hitObject, obj);
+			handleCollision = okA && okB;
+		}
+
+		if (!handleCollision)
+		{
+			obj->SetPosition(obj->GetPosition() + motion);
+			return 0.0f;
+		}
+
+		obj->SetPosition(obj->GetPosition() + motion * hitTime);
+		m_ContinuousHits++;
+
+		// Resolve the contact on its own, the gap is passed as a positive penetration so it only removes
+		// the approaching velocity
+		Manifold* manifold = lmnew Manifold();
+		manifold->Initiate(obj, hitObject);
+		manifold->AddContact(hitData.pointOnA, hitData.pointOnB, hitData.normal, hitData.penetration);
+
+		manifold->PreSolverStep(timeStep);
+		for (size_t i = 0; i < SOLVER_ITERATIONS; ++i)
+			manifold->ApplyImpulse();
+
+		obj->FireOnCollisionManifoldCallback(obj, hitObject, manifold);
+		hitObject->FireOnCollisionManifoldCallback(hitObject, obj, manifold);
+		m_Manifolds.push_back(manifold);
+
+		return timeStep * (1.0f - hitTime);
+	}
+
 	void LumosPhysicsEngine::SolveConstraints()
 	{
 		for (Manifold* m : m_Manifolds) m->PreSolverStep(s_UpdateTimestep);
@@ -387,6 +496,14 @@ namespace Lumos
 		ImGui::PopItemWidth();
 		ImGui::NextColumn();
 
+		ImGui::AlignTextToFramePadding();
+		ImGui::TextUnformatted("Number Of Continuous Hits");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		ImGui::Text("%5.2i", GetNumberContinuousHits());
+		ImGui::PopItemWidth();
+		ImGui::NextColumn();
+
 		ImGui::AlignTextToFramePadding();
 		ImGui::TextUnformatted("Number Of Constraints");
 		ImGui::NextColumn();
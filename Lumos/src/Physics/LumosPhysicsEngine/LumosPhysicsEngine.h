@@ -12,6 +12,7 @@ namespace Lumos
 {
 
 #define SOLVER_ITERATIONS 50
+#define CONTINUOUS_SUBSTEPS 4
 
 	enum class LUMOS_EXPORT IntegrationType
 	{
@@ -73,6 +74,7 @@ namespace Lumos
 
 		int GetNumberCollisionPairs() const { return static_cast<int>(m_BroadphaseCollisionPairs.size()); }
 		int GetNumberPhysicsObjects() const { return static_cast<int>(m_PhysicsObjects.size()); }
+		int GetNumberContinuousHits() const { return m_ContinuousHits; }
 
 		IntegrationType GetIntegrationType() const { return m_IntegrationType; }
 		void SetIntegrationType(const IntegrationType& type){ m_IntegrationType = type; }
@@ -81,6 +83,7 @@ namespace Lumos
         
 		void OnImGui() override;
         void OnDebugDraw() override;
+		void DeclareAccess(SystemAccess& access) override;
     
         void SetDebugDrawFlags(u32 flags) { m_DebugDrawFlags = flags; }
         u32 GetDebugDrawFlags() const { return m_DebugDrawFlags; }
@@ -103,6 +106,11 @@ namespace Lumos
 		//Solves all engine constraints (constraints and manifolds)
 		void SolveConstraints();
 
+		//Sweeps objects flagged for continuous collision that moved further than their size this step,
+		//sub-stepping them alone from each time of impact
+		void ContinuousCollisions();
+		float SweepContinuousObject(PhysicsObject3D* obj, const Maths::Vector3& motion, float timeStep);
+
 	protected:
 		bool		m_IsPaused;
 		float		m_UpdateAccum;
@@ -112,6 +120,14 @@ namespace Lumos
 		std::vector<Ref<PhysicsObject3D>> m_PhysicsObjects;
 		std::vector<CollisionPair>  m_BroadphaseCollisionPairs;
 
+		struct ContinuousObject
+		{
+			PhysicsObject3D* object;
+			Maths::Vector3 start;
+		};
+		std::vector<ContinuousObject> m_ContinuousObjects;
+		int m_ContinuousHits = 0;
+
 		std::vector<Constraint*>	m_Constraints;			// Misc constraints between pairs of objects
 		std::vector<Manifold*>		m_Manifolds;			// Contact constraints between pairs of objects
 		std::mutex					m_ManifoldsMutex;
@@ -20,6 +20,7 @@ namespace Lumos
 		, m_Torque(0.0f, 0.0f, 0.0f)
 		, m_InvInertia(Maths::Matrix3::ZERO)
 		, m_OnCollisionCallback(nullptr)
+		, m_ContinuousCollision(false)
 	{
 		m_localBoundingBox.Define(Maths::Vector3(-0.5f), Maths::Vector3(0.5f));
 	}
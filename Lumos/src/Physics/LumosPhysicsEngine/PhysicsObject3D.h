@@ -92,6 +92,10 @@ namespace Lumos
 
 		void SetCollisionShape(const Ref<CollisionShape>& colShape) { m_CollisionShape = colShape; AutoResizeBoundingBox(); }
 
+		//Sweeps the object through each step so it can't pass through thin geometry when moving fast
+		void SetContinuousCollision(bool continuous) { m_ContinuousCollision = continuous; }
+		bool GetContinuousCollision() const { return m_ContinuousCollision; }
+
 		//<---------- CALLBACKS ------------>
 		void SetOnCollisionCallback(PhysicsCollisionCallback& callback) { m_OnCollisionCallback = callback; }
 
@@ -153,6 +157,7 @@ namespace Lumos
 		Ref<CollisionShape> m_CollisionShape;
 		PhysicsCollisionCallback m_OnCollisionCallback;
 		std::vector<OnCollisionManifoldCallback> m_onCollisionManifoldCallbacks; //!< Collision callbacks post manifold generation
+		bool m_ContinuousCollision;
 
 	};
 }
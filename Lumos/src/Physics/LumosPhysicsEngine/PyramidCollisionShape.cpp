@@ -111,6 +111,13 @@ namespace Lumos
 		if (out_max) *out_max = wsTransform * m_PyramidHull->GetVertex(vMax).pos;
 	}
 
+	Maths::Vector3 PyramidCollisionShape::GetLocalSupport(const Maths::Vector3& localDirection) const
+	{
+		int vMax;
+		m_PyramidHull->GetMinMaxVerticesInAxis(localDirection, nullptr, &vMax);
+		return m_PyramidHull->GetVertex(vMax).pos;
+	}
+
 	void PyramidCollisionShape::GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
 	{
 		Maths::Matrix4 wsTransform;
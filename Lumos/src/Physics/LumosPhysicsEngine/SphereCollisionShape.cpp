@@ -66,6 +66,11 @@ namespace Lumos
 			*out_max = pos + axis * m_Radius;
 	}
 
+	Maths::Vector3 SphereCollisionShape::GetLocalSupport(const Maths::Vector3& localDirection) const
+	{
+		return localDirection.NormalizedOrDefault(Maths::Vector3(1.0f, 0.0f, 0.0f));
+	}
+
 	void SphereCollisionShape::GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const
 	{
 		if (out_face)
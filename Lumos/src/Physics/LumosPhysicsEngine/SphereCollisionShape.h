@@ -21,6 +21,7 @@ namespace Lumos
 
 		virtual void GetMinMaxVertexOnAxis(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, Maths::Vector3* out_min, Maths::Vector3* out_max) const override;
 		virtual void GetIncidentReferencePolygon(const PhysicsObject3D* currentObject, const Maths::Vector3& axis, std::list<Maths::Vector3>* out_face, Maths::Vector3* out_normal, std::vector<Maths::Plane>* out_adjacent_planes) const override;
+		virtual Maths::Vector3 GetLocalSupport(const Maths::Vector3& localDirection) const override;
 
 		virtual void DebugDraw(const PhysicsObject3D* currentObject) const override;
 
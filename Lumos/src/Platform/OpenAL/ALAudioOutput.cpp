@@ -0,0 +1,90 @@
+#include "lmpch.h"
+#include "ALAudioOutput.h"
+#include "Audio/AudioMixer.h"
+#include "Maths/Maths.h"
+
+namespace Lumos
+{
+	ALAudioOutput::~ALAudioOutput()
+	{
+		Close();
+	}
+
+	bool ALAudioOutput::Open(u32 sampleRate, u32 channels)
+	{
+		m_Device = alcOpenDevice(nullptr);
+		if (!m_Device)
+			return false;
+
+		m_Context = alcCreateContext(m_Device, nullptr);
+		alcMakeContextCurrent(m_Context);
+
+		m_SampleRate = sampleRate;
+		m_Channels = channels;
+
+		alGenSources(1, &m_Source);
+		alSourcei(m_Source, AL_SOURCE_RELATIVE, AL_TRUE);
+		alGenBuffers(NUM_OUTPUT_BUFFERS, m_Buffers);
+
+		for (u32 i = 0; i < NUM_OUTPUT_BUFFERS; i++)
+			m_FreeBuffers[i] = m_Buffers[i];
+		m_FreeBufferCount = NUM_OUTPUT_BUFFERS;
+
+		return true;
+	}
+
+	void ALAudioOutput::Close()
+	{
+		if (!m_Device)
+			return;
+
+		alSourceStop(m_Source);
+		alSourcei(m_Source, AL_BUFFER, 0);
+		alDeleteSources(1, &m_Source);
+		alDeleteBuffers(NUM_OUTPUT_BUFFERS, m_Buffers);
+
+		alcMakeContextCurrent(nullptr);
+		alcDestroyContext(m_Context);
+		alcCloseDevice(m_Device);
+
+		m_Context = nullptr;
+		m_Device = nullptr;
+	}
+
+	u32 ALAudioOutput::GetWritableFrames(u32)
+	{
+		ALint processed = 0;
+		alGetSourcei(m_Source, AL_BUFFERS_PROCESSED, &processed);
+
+		for (ALint i = 0; i < processed; i++)
+		{
+			ALuint buffer;
+			alSourceUnqueueBuffers(m_Source, 1, &buffer);
+			m_FreeBuffers[m_FreeBufferCount++] = buffer;
+		}
+
+		return m_FreeBufferCount * AUDIO_MIX_BLOCK_FRAMES;
+	}
+
+	void ALAudioOutput::Write(const float* samples, u32 frames)
+	{
+		if (m_FreeBufferCount == 0)
+			return;
+
+		const u32 count = frames * m_Channels;
+		m_Samples.resize(count);
+
+		for (u32 i = 0; i < count; i++)
+			m_Samples[i] = static_cast<i16>(Maths::Clamp(samples[i], -1.0f, 1.0f) * 32767.0f);
+
+		ALuint buffer = m_FreeBuffers[--m_FreeBufferCount];
+		alBufferData(buffer, m_Channels == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16, m_Samples.data(), count * sizeof(i16), static_cast<ALsizei>(m_SampleRate));
+		alSourceQueueBuffers(m_Source, 1, &buffer);
+
+		// Restarts after an underrun as well as on the first block
+		ALint state = 0;
+		alGetSourcei(m_Source, AL_SOURCE_STATE, &state);
+		if (state != AL_PLAYING)
+			alSourcePlay(m_Source);
+	}
+}
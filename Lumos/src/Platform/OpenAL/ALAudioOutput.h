@@ -0,0 +1,42 @@
+#pragma once
+
+#include "lmpch.h"
+
+#include "Audio/AudioOutput.h"
+
+#include <AL/al.h>
+#include <AL/alc.h>
+
+#define NUM_OUTPUT_BUFFERS 4
+
+namespace Lumos
+{
+	// Plays the software mix through a single streaming OpenAL source, one buffer per block
+	class ALAudioOutput : public AudioOutput
+	{
+	public:
+		ALAudioOutput() = default;
+		~ALAudioOutput();
+
+		bool Open(u32 sampleRate, u32 channels) override;
+		void Close() override;
+
+		// Follows the device clock, one block per buffer the source has finished with
+		u32 GetWritableFrames(u32 requestedFrames) override;
+
+		void Write(const float* samples, u32 frames) override;
+		const char* GetName() const override { return "OpenAL"; }
+
+	private:
+		ALCdevice* m_Device = nullptr;
+		ALCcontext* m_Context = nullptr;
+		ALuint m_Source = 0;
+		ALuint m_Buffers[NUM_OUTPUT_BUFFERS] = {};
+		ALuint m_FreeBuffers[NUM_OUTPUT_BUFFERS] = {};
+		u32 m_FreeBufferCount = 0;
+
+		std::vector<i16> m_Samples;
+		u32 m_SampleRate = 0;
+		u32 m_Channels = 0;
+	};
+}
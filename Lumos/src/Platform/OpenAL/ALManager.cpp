@@ -1,9 +1,11 @@
 #include "lmpch.h"
 #include "ALManager.h"
 #include "ALSoundNode.h"
+#include "ALSound.h"
 #include "Maths/Maths.h"
 #include "Graphics/Camera/Camera.h"
 #include "Utilities/TimeStep.h"
+#include "Core/Profiler.h"
 
 #include <imgui/imgui.h>
 
@@ -18,8 +20,24 @@ namespace Lumos
             m_DebugName = "OpenAL Audio";
 		}
 
+		// Score multiplier for voices already playing, stops two similar voices trading the source every frame
+		static const float VOICE_HYSTERESIS = 1.1f;
+
+		static u64 GetCellKey(i32 x, i32 y, i32 z)
+		{
+			return (static_cast<u64>(static_cast<u32>(x) & 0x1FFFFF) << 42) | (static_cast<u64>(static_cast<u32>(y) & 0x1FFFFF) << 21) | (static_cast<u64>(static_cast<u32>(z) & 0x1FFFFF));
+		}
+
+		static i32 GetCell(float value, float cellSize)
+		{
+			return static_cast<i32>(floorf(value / cellSize));
+		}
+
 		ALManager::~ALManager()
         {
+			if (!m_Sources.empty())
+				alDeleteSources(static_cast<ALsizei>(m_Sources.size()), m_Sources.data());
+
             alcDestroyContext(m_Context);
             alcCloseDevice(m_Device);
         }
@@ -40,16 +58,175 @@ namespace Lumos
 
             alcMakeContextCurrent(m_Context);
             alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
+
+			// Devices may offer fewer sources than requested, generate until one fails
+			for (int i = 0; i < m_NumChannels; i++)
+			{
+				ALuint source = 0;
+				alGenSources(1, &source);
+				if (alGetError() != AL_NO_ERROR)
+					break;
+
+				m_Sources.push_back(source);
+			}
+
+			if (static_cast<int>(m_Sources.size()) < m_NumChannels)
+				LUMOS_LOG_WARN("Only {0} of {1} audio channels available", m_Sources.size(), m_NumChannels);
+
+			m_NumChannels = static_cast<int>(m_Sources.size());
+			m_FreeSources = m_Sources;
         }
 
+		bool ALManager::IsDeviceAvailable()
+		{
+			ALCdevice* device = alcOpenDevice(nullptr);
+			if (!device)
+				return false;
+
+			alcCloseDevice(device);
+			return true;
+		}
+
+		Sound* ALManager::CreateSound(const String& name, const String& extension)
+		{
+			return lmnew ALSound(name, extension);
+		}
+
+		SoundNode* ALManager::CreateSoundNode()
+		{
+			return lmnew ALSoundNode();
+		}
+
+		void ALManager::ReleaseSource(ALuint source)
+		{
+			if (source)
+				m_FreeSources.push_back(source);
+		}
+
         void ALManager::OnUpdate(const TimeStep& dt, Scene* scene)
         {
 			UpdateListener();
+			UpdateVoices();
 
 			for (auto node : m_SoundNodes)
-				node->OnUpdate(dt.GetElapsedMillis());
+				node->OnUpdate(dt.GetMillis());
         }
 
+		void ALManager::BuildGrid()
+		{
+			for (auto& cell : m_Grid)
+				cell.second.clear();
+			m_GlobalNodes.clear();
+			m_MaxRadius = 0.0f;
+
+			for (auto soundNode : m_SoundNodes)
+			{
+				auto node = static_cast<ALSoundNode*>(soundNode);
+				if (!node->IsPlaying())
+					continue;
+
+				if (node->GetIsGlobal())
+				{
+					m_GlobalNodes.push_back(node);
+					continue;
+				}
+
+				const Maths::Vector3 position = node->GetPosition();
+				m_Grid[GetCellKey(GetCell(position.x, m_GridCellSize), GetCell(position.y, m_GridCellSize), GetCell(position.z, m_GridCellSize))].push_back(node);
+				m_MaxRadius = Maths::Max(m_MaxRadius, node->GetRadius());
+			}
+		}
+
+		void ALManager::UpdateVoices()
+		{
+			LUMOS_PROFILE_FUNC;
+
+			BuildGrid();
+
+			m_Voices.clear();
+
+			for (auto node : m_GlobalNodes)
+				m_Voices.push_back({ node, node->GetAudibility(Maths::Vector3(0.0f)) });
+
+			// Only cells within reach of the loudest radius can hold audible nodes, the rest stay virtual untouched
+			if (m_Listener)
+			{
+				const Maths::Vector3 listener = m_Listener->GetPosition();
+				const i32 minX = GetCell(listener.x - m_MaxRadius, m_GridCellSize), maxX = GetCell(listener.x + m_MaxRadius, m_GridCellSize);
+				const i32 minY = GetCell(listener.y - m_MaxRadius, m_GridCellSize), maxY = GetCell(listener.y + m_MaxRadius, m_GridCellSize);
+				const i32 minZ = GetCell(listener.z - m_MaxRadius, m_GridCellSize), maxZ = GetCell(listener.z + m_MaxRadius, m_GridCellSize);
+
+				const bool scanCells = static_cast<size_t>(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1) <= m_Grid.size();
+
+				auto scoreCell = [&](const std::vector<ALSoundNode*>& cell)
+				{
+					for (auto node : cell)
+					{
+						const float score = node->GetAudibility(listener);
+						if (score > 0.0f)
+							m_Voices.push_back({ node, node->IsVirtual() ? score : score * VOICE_HYSTERESIS });
+					}
+				};
+
+				if (scanCells)
+				{
+					for (i32 x = minX; x <= maxX; x++)
+						for (i32 y = minY; y <= maxY; y++)
+							for (i32 z = minZ; z <= maxZ; z++)
+							{
+								auto it = m_Grid.find(GetCellKey(x, y, z));
+								if (it != m_Grid.end())
+									scoreCell(it->second);
+							}
+				}
+				else
+				{
+					// Fewer occupied cells than cells in range, walk the occupied ones instead
+					for (auto& cell : m_Grid)
+						scoreCell(cell.second);
+				}
+			}
+
+			const size_t realCount = Maths::Min(m_Voices.size(), m_Sources.size());
+			if (realCount < m_Voices.size())
+				std::nth_element(m_Voices.begin(), m_Voices.begin() + realCount, m_Voices.end(), [](const Voice& a, const Voice& b) { return a.score > b.score; });
+
+			// Demote everything outside the top N first so its source can be reused below
+			for (auto soundNode : m_SoundNodes)
+			{
+				auto node = static_cast<ALSoundNode*>(soundNode);
+				if (node->IsVirtual())
+					continue;
+
+				bool keep = false;
+				for (size_t i = 0; i < realCount; i++)
+				{
+					if (m_Voices[i].node == node)
+					{
+						keep = true;
+						break;
+					}
+				}
+
+				if (!keep)
+					ReleaseSource(node->MakeVirtual());
+			}
+
+			for (size_t i = 0; i < realCount; i++)
+			{
+				auto node = m_Voices[i].node;
+				if (node->IsVirtual() && !m_FreeSources.empty())
+				{
+					node->MakeReal(m_FreeSources.back());
+					m_FreeSources.pop_back();
+				}
+			}
+
+			m_RealVoices = static_cast<u32>(m_Sources.size() - m_FreeSources.size());
+			m_VirtualVoices = static_cast<u32>(m_SoundNodes.size()) - m_RealVoices;
+			m_CulledVoices = static_cast<u32>(m_SoundNodes.size() - m_Voices.size());
+		}
+
 		void ALManager::UpdateListener()
 		{
 			if (m_Listener)
@@ -96,6 +273,46 @@ namespace Lumos
 			ImGui::PopItemWidth();
 			ImGui::NextColumn();
 
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Streaming Sources");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%5.2u", m_Streamer.GetStreamCount());
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Real Voices");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%5.2u", m_RealVoices);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Virtual Voices");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%5.2u", m_VirtualVoices);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Inaudible Voices");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::Text("%5.2u", m_CulledVoices);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
+			ImGui::AlignTextToFramePadding();
+			ImGui::TextUnformatted("Grid Cell Size");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			ImGui::DragFloat("##GridCellSize", &m_GridCellSize, 1.0f, 1.0f, 1000.0f);
+			ImGui::PopItemWidth();
+			ImGui::NextColumn();
+
 			ImGui::AlignTextToFramePadding();
 			ImGui::TextUnformatted("Number Of Channels");
 			ImGui::NextColumn();
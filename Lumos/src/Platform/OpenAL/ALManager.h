@@ -6,6 +6,8 @@
 
 namespace Lumos
 {
+	class ALSoundNode;
+
     namespace Audio
     {
         class ALManager : public AudioManager
@@ -19,11 +21,43 @@ namespace Lumos
 			void UpdateListener();
 			void OnImGui() override;
 
+			Sound* CreateSound(const String& name, const String& extension) override;
+			SoundNode* CreateSoundNode() override;
+
+			static bool IsDeviceAvailable();
+
+			// Returns a source taken from a node to the pool
+			void ReleaseSource(ALuint source);
+
         private:
+			struct Voice
+			{
+				ALSoundNode* node;
+				float score;
+			};
+
+			void UpdateVoices();
+			void BuildGrid();
+
             ALCcontext* m_Context;
 		    ALCdevice* m_Device;
 
             int m_NumChannels = 0;
+
+			// Sources generated up front, m_NumChannels is the voice limit
+			std::vector<ALuint> m_Sources;
+			std::vector<ALuint> m_FreeSources;
+
+			// Uniform grid over the node positions, rebuilt every frame since nodes move freely
+			std::unordered_map<u64, std::vector<ALSoundNode*>> m_Grid;
+			std::vector<ALSoundNode*> m_GlobalNodes;
+			std::vector<Voice> m_Voices;
+			float m_GridCellSize = 32.0f;
+			float m_MaxRadius = 0.0f;
+
+			u32 m_RealVoices = 0;
+			u32 m_VirtualVoices = 0;
+			u32 m_CulledVoices = 0;
 		};
     }
 }
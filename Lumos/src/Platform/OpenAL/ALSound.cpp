@@ -3,11 +3,27 @@
 
 #include "Audio/WavLoader.h"
 #include "Audio/OggLoader.h"
+#include "Audio/AudioStream.h"
 
 namespace Lumos
 {
     ALSound::ALSound(const String& fileName, const String& format) : m_Format(0)
 	{
+		m_FilePath = fileName;
+		m_Extension = format;
+
+		// Only the header is read here, long files are decoded by each playing node instead
+		AudioStream* stream = AudioStream::Create(fileName, format);
+		if (stream && stream->GetFormat().Size > SOUND_STREAM_THRESHOLD)
+		{
+			m_Data = stream->GetFormat();
+			m_Streaming = true;
+			delete stream;
+			return;
+		}
+
+		delete stream;
+
 		if (format == "wav")
 			m_Data = LoadWav(fileName);
 		else if(format == "ogg")
@@ -19,7 +35,8 @@ namespace Lumos
 
 	ALSound::~ALSound()
 	{
-		alDeleteBuffers(1, &m_Buffer);
+		if (m_Buffer)
+			alDeleteBuffers(1, &m_Buffer);
 	}
 
 	ALenum ALSound::GetOALFormat(u32 bitRate, u32 channels)
@@ -15,9 +15,11 @@ namespace Lumos
 		virtual ~ALSound();
 
 		unsigned int GetBuffer() const { return m_Buffer; }
-	private:
+
 		static ALenum GetOALFormat(u32 bitRate, u32 channels);
-		unsigned int m_Buffer;
+
+	private:
+		unsigned int m_Buffer = 0;
 		int	    m_Format;
 	};
 }
\ No newline at end of file
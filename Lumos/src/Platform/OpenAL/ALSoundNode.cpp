@@ -10,17 +10,60 @@
 namespace Lumos
 {
 	ALSoundNode::ALSoundNode()
+		: m_Source(0)
 	{
-		alGenSources(1, &m_Source);
+		// Sources are handed out by the voice manager, nodes start out virtual
+		m_Virtual = true;
 	}
 
 	ALSoundNode::~ALSoundNode()
 	{
-		alDeleteSources(1, &m_Source);
+		auto audioManager = Application::Instance()->GetSystem<AudioManager>();
+		if (!audioManager)
+			return;
+
+		if (m_Source)
+			static_cast<Audio::ALManager*>(audioManager)->ReleaseSource(MakeVirtual());
+
+		audioManager->RemoveSoundNode(this);
 	}
 
 	void ALSoundNode::OnUpdate(float msec)
 	{
+		if (!IsPlaying())
+			return;
+
+		// Playback position is tracked for every node so a virtual voice resumes where it would be
+		if (!m_Paused)
+			m_StreamPos += msec * m_Pitch;
+
+		if (m_Source && !m_StreamBuffer)
+		{
+			ALint state = 0;
+			ALfloat offset = 0.0f;
+			alGetSourcei(m_Source, AL_SOURCE_STATE, &state);
+			alGetSourcef(m_Source, AL_SEC_OFFSET, &offset);
+
+			if (state == AL_STOPPED)
+				m_Stopped = true;
+			else
+				m_StreamPos = offset * 1000.0;
+		}
+
+		const double length = m_Sound->GetLength();
+		if (m_StreamPos >= length && length > 0.0)
+		{
+			if (m_IsLooping)
+				m_StreamPos = fmod(m_StreamPos, length);
+			else if (!m_Source)
+				m_Stopped = true;
+		}
+
+		m_TimeLeft = Maths::Max(0.0, length - m_StreamPos);
+
+		if (!m_Source)
+			return;
+
 		alSourcef(m_Source, AL_GAIN, m_Volume);
 		alSourcef(m_Source, AL_PITCH, m_Pitch);
 		alSourcef(m_Source, AL_MAX_DISTANCE, m_Radius);
@@ -50,37 +93,194 @@ namespace Lumos
 		alSourcefv(m_Source, AL_POSITION, reinterpret_cast<float*>(&position));
 		alSourcefv(m_Source, AL_VELOCITY, reinterpret_cast<float*>(&velocity));
 
+		if (m_StreamBuffer)
+			UpdateStream();
 	}
 
 	void ALSoundNode::Pause()
 	{
-		alSourcePause(m_Source);
+		if (m_Source)
+			alSourcePause(m_Source);
 		m_Paused = true;
 	}
 
 	void ALSoundNode::Resume()
 	{
-		alSourcePlay(m_Source);
 		m_Paused = false;
+
+		if (m_Stopped)
+		{
+			// Restart from the beginning, as alSourcePlay does on a stopped source
+			m_Stopped = false;
+			m_StreamPos = 0.0;
+
+			if (m_Source && m_Sound)
+			{
+				StopStream();
+				StartPlayback();
+			}
+		}
+		else if (m_Source)
+			alSourcePlay(m_Source);
 	}
 
 	void ALSoundNode::Stop()
 	{
-		alSourceStop(m_Source);
+		if (m_Source)
+			alSourceStop(m_Source);
+		m_Stopped = true;
 	}
 
 	void ALSoundNode::SetSound(Sound * s)
 	{
+		StopStream();
+
 		m_Sound = s;
+		m_Stopped = false;
+		m_StreamPos = 0.0;
+
 		if (m_Sound)
 		{
 			m_TimeLeft = m_Sound->GetLength();
+
+			if (m_Source)
+				StartPlayback();
+		}
+	}
+
+	void ALSoundNode::MakeReal(ALuint source)
+	{
+		m_Source = source;
+		m_Virtual = false;
+
+		alSourcef(m_Source, AL_GAIN, m_Volume);
+		alSourcef(m_Source, AL_PITCH, m_Pitch);
+		StartPlayback();
+	}
+
+	ALuint ALSoundNode::MakeVirtual()
+	{
+		ALuint source = m_Source;
+
+		StopStream();
+		alSourceStop(source);
+		alSourcei(source, AL_BUFFER, 0);
+
+		m_Source = 0;
+		m_Virtual = true;
+		return source;
+	}
+
+	void ALSoundNode::StartPlayback()
+	{
+		alSourcef(m_Source, AL_MAX_DISTANCE, m_Radius);
+		alSourcef(m_Source, AL_ROLLOFF_FACTOR, 1.0f);
+		alSourcef(m_Source, AL_REFERENCE_DISTANCE, m_ReferenceDistance);
+
+		if (m_Sound->IsStreaming())
+		{
+			StartStream();
+		}
+		else
+		{
+			alSourceStop(m_Source);
 			alSourcei(m_Source, AL_BUFFER, static_cast<ALSound*>(m_Sound)->GetBuffer());
-			alSourcef(m_Source, AL_MAX_DISTANCE, m_Radius);
-			alSourcef(m_Source, AL_ROLLOFF_FACTOR, 1.0f);
-			alSourcef(m_Source, AL_REFERENCE_DISTANCE, m_ReferenceDistance);
 			alSourcei(m_Source, AL_LOOPING, m_IsLooping ? 1 : 0);
-			alSourcePlay(m_Source);
+			alSourcef(m_Source, AL_SEC_OFFSET, static_cast<float>(m_StreamPos * 0.001));
+
+			if (!m_Paused && !m_Stopped)
+				alSourcePlay(m_Source);
+		}
+	}
+
+	void ALSoundNode::StartStream()
+	{
+		AudioStream* stream = m_Sound->OpenStream();
+		if (!stream)
+			return;
+
+		// Continue from where the voice was when it went virtual
+		if (m_StreamPos > 0.0)
+			stream->Seek(m_StreamPos);
+
+		const AudioData& format = stream->GetFormat();
+		m_StreamFormat = ALSound::GetOALFormat(format.BitRate, format.Channels);
+
+		m_StreamBuffer = lmnew AudioStreamBuffer();
+		m_StreamBuffer->stream = stream;
+		m_StreamBuffer->looping = m_IsLooping;
+
+		alGenBuffers(NUM_STREAM_BUFFERS, m_StreamBuffers);
+		for (u32 i = 0; i < NUM_STREAM_BUFFERS; i++)
+			m_FreeBuffers[i] = m_StreamBuffers[i];
+		m_FreeBufferCount = NUM_STREAM_BUFFERS;
+
+		// Looping is handled by the decoder rewinding, the source only ever sees a queue
+		alSourceStop(m_Source);
+		alSourcei(m_Source, AL_BUFFER, 0);
+		alSourcei(m_Source, AL_LOOPING, 0);
+
+		Application::Instance()->GetSystem<AudioManager>()->GetStreamer().Register(m_StreamBuffer);
+	}
+
+	void ALSoundNode::StopStream()
+	{
+		if (!m_StreamBuffer)
+			return;
+
+		Application::Instance()->GetSystem<AudioManager>()->GetStreamer().Unregister(m_StreamBuffer);
+
+		alSourceStop(m_Source);
+		alSourcei(m_Source, AL_BUFFER, 0);
+		alDeleteBuffers(NUM_STREAM_BUFFERS, m_StreamBuffers);
+		m_FreeBufferCount = 0;
+
+		delete m_StreamBuffer->stream;
+		delete m_StreamBuffer;
+		m_StreamBuffer = nullptr;
+	}
+
+	void ALSoundNode::UpdateStream()
+	{
+		ALint processed = 0;
+		alGetSourcei(m_Source, AL_BUFFERS_PROCESSED, &processed);
+
+		for (ALint i = 0; i < processed; i++)
+		{
+			ALuint buffer;
+			alSourceUnqueueBuffers(m_Source, 1, &buffer);
+			m_FreeBuffers[m_FreeBufferCount++] = buffer;
+		}
+
+		m_StreamBuffer->looping = m_IsLooping;
+
+		bool consumed = false;
+		while (m_FreeBufferCount > 0 && m_StreamBuffer->GetReadyCount() > 0)
+		{
+			u32 size = 0;
+			const u8* data = m_StreamBuffer->GetChunk(size);
+
+			ALuint buffer = m_FreeBuffers[--m_FreeBufferCount];
+			alBufferData(buffer, m_StreamFormat, data, size, static_cast<ALsizei>(m_Sound->GetFrequency()));
+			alSourceQueueBuffers(m_Source, 1, &buffer);
+
+			m_StreamBuffer->PopChunk();
+			consumed = true;
 		}
+
+		if (consumed)
+			Application::Instance()->GetSystem<AudioManager>()->GetStreamer().Notify();
+
+		// Starts playback once the first chunk is queued and restarts it after an underrun
+		ALint state = 0;
+		ALint queued = 0;
+		alGetSourcei(m_Source, AL_SOURCE_STATE, &state);
+		alGetSourcei(m_Source, AL_BUFFERS_QUEUED, &queued);
+
+		if (state != AL_PLAYING && state != AL_PAUSED && !m_Paused && !m_Stopped && queued > 0)
+			alSourcePlay(m_Source);
+
+		if (queued == 0 && m_StreamBuffer->finished && m_StreamBuffer->GetReadyCount() == 0)
+			m_Stopped = true;
 	}
-}
+}
\ No newline at end of file
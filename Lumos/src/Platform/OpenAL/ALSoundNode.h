@@ -3,6 +3,7 @@
 #include "lmpch.h"
 
 #include "Audio/SoundNode.h"
+#include "Audio/AudioStream.h"
 
 #include <AL/al.h>
 
@@ -22,8 +23,27 @@ namespace Lumos
 		void Stop() override;
 		void SetSound(Sound *s) override;
 
+		bool IsPlaying() const override { return m_Sound && !m_Stopped; }
+
+		// Voice management, the node keeps the source until MakeVirtual hands it back
+		void MakeReal(ALuint source);
+		ALuint MakeVirtual();
+
 	private:
+		void StartPlayback();
+		void StartStream();
+		void StopStream();
+		void UpdateStream();
+
 		ALuint m_Source;
 		ALuint m_StreamBuffers[NUM_STREAM_BUFFERS];
+
+		// Buffers not currently queued on the source
+		ALuint m_FreeBuffers[NUM_STREAM_BUFFERS];
+		u32 m_FreeBufferCount = 0;
+
+		AudioStreamBuffer* m_StreamBuffer = nullptr;
+		ALenum m_StreamFormat = 0;
+		bool m_Stopped = false;
 	};
 }
\ No newline at end of file
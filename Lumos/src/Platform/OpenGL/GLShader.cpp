@@ -4,6 +4,7 @@
 #include "Platform/OpenGL/GL.h"
 #include "Core/VFS.h"
 #include "Core/OS/FileSystem.h"
+#include "Utilities/Timer.h"
 
 enum root_signature_spaces {
     PUSH_CONSTANT_REGISTER_SPACE = 0,
@@ -77,18 +78,92 @@ namespace Lumos
 
 		void GLShader::Init()
 		{
-			std::map<ShaderType, String>* sources = lmnew std::map<ShaderType, String>();
-			PreProcess(m_Source, sources);
-			
-            //sources = files
-            
+			Timer timer;
+
+			// Warm starts take the GLSL, the reflected declarations and the linked program from the cache,
+			// so the .shader file is only hashed, never preprocessed, cross compiled or parsed.
+			GLShaderCacheEntry cache;
+			const String cachePath = GLShaderCache::IsEnabled() ? GLShaderCache::GetCachePath(m_Path, m_Name) : "";
+			const bool cacheValid = !cachePath.empty() && GLShaderCache::Load(cachePath, cache) && cache.sourceHash != 0
+				&& cache.sourceHash == GLShaderCache::HashSources(m_Source, m_Path, cache.stageFiles);
+
+			if (!cacheValid)
+			{
+				cache = GLShaderCacheEntry();
+
+				PreProcess(m_Source, &cache.sources);
+
+				for (auto& file : cache.sources)
+					cache.stageFiles.push_back(file.second);
+				cache.sourceHash = GLShaderCache::HashSources(m_Source, m_Path, cache.stageFiles);
+
+				CrossCompile(&cache.sources, cache.uniformBlocks);
+				CollectDeclarations(&cache.sources, cache.declarations);
+			}
+
+			ParseDeclarations(cache.sources, cache.declarations);
+			m_UniformBlockNames = cache.uniformBlocks;
+
+			for (auto& source : cache.sources)
+			{
+				m_ShaderTypes.push_back(source.first);
+			}
+
+			const String driver = GetDriverString();
+			bool save = !cacheValid;
+
+			if (cacheValid && cache.driver == driver && LoadProgramBinary(cache.binaryFormat, cache.binary))
+			{
+				Debug::Log::Info("Loaded cached shader: {0} ({1} ms)", m_Name, timer.GetMS(1000.0f));
+			}
+			else
+			{
+				GLShaderErrorInfo error;
+				m_Handle = Compile(&cache.sources, error);
+
+				if (!m_Handle)
+				{
+					Debug::Log::Error("{0} - {1}", error.message[error.shader], m_Name);
+					save = false;
+				}
+				else
+				{
+					Debug::Log::Info("Successfully compiled shader: {0} ({1} ms)", m_Name, timer.GetMS(1000.0f));
+
+					cache.driver = driver;
+					if (GetProgramBinary(cache.binaryFormat, cache.binary))
+						save = true;
+				}
+			}
+
+			if (save && !cachePath.empty() && cache.sourceHash != 0 && !GLShaderCache::Save(cachePath, cache))
+				LUMOS_LOG_WARN("Failed to write shader cache {0}", cachePath);
+
+			//LUMOS_ASSERT(m_Handle, "");
+
+			ResolveUniforms();
+			ValidateUniforms();
+            CreateLocations();
+		}
+
+		void GLShader::CrossCompile(std::map<ShaderType, String>* sources, std::vector<String>& uniformBlocks) const
+		{
             for (auto& file : *sources)
             {
-                auto fileSize = FileSystem::GetFileSize(m_Path + file.second); //TODO: once process
-                u32* source = reinterpret_cast<u32*>(FileSystem::ReadFile(m_Path + file.second));
+                String physicalPath;
+                if (!VFS::Get()->ResolvePhysicalPath(m_Path + file.second, physicalPath))
+                {
+                    Debug::Log::Error("Failed to find {0} - {1}", file.second, m_Name);
+                    file.second.clear();
+                    continue;
+                }
+
+                auto fileSize = FileSystem::GetFileSize(physicalPath);
+                u32* source = reinterpret_cast<u32*>(FileSystem::ReadFile(physicalPath));
                 std::vector<unsigned int> spv(source, source + fileSize / sizeof(unsigned int));
+                delete[] source;
 
-                spirv_cross::CompilerGLSL* glsl = new spirv_cross::CompilerGLSL(std::move(spv));
+                spirv_cross::CompilerGLSL* glsl = lmnew spirv_cross::CompilerGLSL(std::move(spv));
             
                 // The SPIR-V is now parsed, and we can perform reflection on it.
                 spirv_cross::ShaderResources resources = glsl->get_shader_resources();
@@ -146,36 +221,15 @@ namespace Lumos
                 // Compile to GLSL, ready to give to GL driver.
                 String glslSource = glsl->compile();
                 file.second = glslSource;
-            
-                m_pShaderCompilers.push_back(glsl);
-            }
-        
-            Parse(sources);
 
-			for (auto& source : *sources)
-			{
-				m_ShaderTypes.push_back(source.first);
-			}
-
-			GLShaderErrorInfo error;
-			m_Handle = Compile(sources, error);
+                for (const auto& uniformBuffer : resources.uniform_buffers)
+                {
+                    if (glsl->get_type(uniformBuffer.type_id).basetype == spirv_cross::SPIRType::Struct)
+                        uniformBlocks.push_back(uniformBuffer.name);
+                }
 
-			if (!m_Handle)
-            {
-                Debug::Log::Error("{0} - {1}", error.message[error.shader], m_Name);
-            }
-            else
-            {
-                Debug::Log::Info("Successfully compiled shader: {0}", m_Name);
+                delete glsl;
             }
-
-			//LUMOS_ASSERT(m_Handle, "");
-
-			ResolveUniforms();
-			ValidateUniforms();
-            CreateLocations();
-
-			delete sources;
 		}
 
 		void GLShader::Shutdown() const
@@ -185,17 +239,9 @@ namespace Lumos
         
         bool GLShader::CreateLocations()
         {
-            for(auto& compiler : m_pShaderCompilers)
+            for (auto& name : m_UniformBlockNames)
             {
-                const spirv_cross::ShaderResources shaderResources = compiler->get_shader_resources();
-
-                for (const auto &itUniform : shaderResources.uniform_buffers)
-                {
-                    if (compiler->get_type(itUniform.type_id).basetype == spirv_cross::SPIRType::Struct)
-                    {
-                        SetUniformLocation(itUniform.name.c_str());
-                    }
-                }
+                SetUniformLocation(name.c_str());
             }
             return true;
         }
@@ -372,6 +418,9 @@ namespace Lumos
 			for (unsigned int shader : shaders)
 				glAttachShader(program, shader);
 
+			if (SupportsProgramBinary())
+				GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+
 			GLCall(glLinkProgram(program));
 
 			GLint result;
@@ -405,6 +454,74 @@ namespace Lumos
 			return program;
 		}
 
+		bool GLShader::SupportsProgramBinary()
+		{
+#ifndef LUMOS_PLATFORM_MOBILE
+			if (!glad_glGetProgramBinary || !glad_glProgramBinary || !glad_glProgramParameteri)
+				return false;
+#endif
+			GLint formats = 0;
+			GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+			return formats > 0;
+		}
+
+		String GLShader::GetDriverString()
+		{
+			String driver;
+			for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+			{
+				const char* value = reinterpret_cast<const char*>(glGetString(name));
+				driver += value ? value : "";
+				driver += "|";
+			}
+			return driver;
+		}
+
+		bool GLShader::LoadProgramBinary(u32 format, const std::vector<u8>& binary)
+		{
+			if (binary.empty() || !SupportsProgramBinary())
+				return false;
+
+			GLCall(u32 program = glCreateProgram());
+
+			// Drivers reject binaries from other builds of themselves, that is not an error
+			glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+			while (glGetError() != GL_NO_ERROR)
+				;
+
+			GLint result = GL_FALSE;
+			GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+			if (result == GL_FALSE)
+			{
+				LUMOS_LOG_WARN("Cached program binary rejected for {0}, recompiling", m_Name);
+				GLCall(glDeleteProgram(program));
+				return false;
+			}
+
+			m_Handle = program;
+			return true;
+		}
+
+		bool GLShader::GetProgramBinary(u32& format, std::vector<u8>& binary) const
+		{
+			binary.clear();
+			if (!SupportsProgramBinary())
+				return false;
+
+			GLint length = 0;
+			GLCall(glGetProgramiv(m_Handle, GL_PROGRAM_BINARY_LENGTH, &length));
+			if (length <= 0)
+				return false;
+
+			GLenum binaryFormat = 0;
+			binary.resize(length);
+			GLCall(glGetProgramBinary(m_Handle, length, &length, &binaryFormat, binary.data()));
+			binary.resize(length);
+			format = binaryFormat;
+
+			return !binary.empty();
+		}
+
 		GLenum TypeToGL(ShaderType type)
 		{
 			switch (type)
@@ -497,21 +614,45 @@ namespace Lumos
 		}
 
 		void GLShader::Parse(std::map<ShaderType, String>* sources)
+		{
+			std::vector<GLShaderCacheDeclaration> declarations;
+			CollectDeclarations(sources, declarations);
+			ParseDeclarations(*sources, declarations);
+		}
+
+		void GLShader::CollectDeclarations(std::map<ShaderType, String>* sources, std::vector<GLShaderCacheDeclaration>& declarations)
 		{
 			for (auto& source : *sources)
 			{
-				m_UniformBuffers[source.first].push_back(lmnew GLShaderUniformBufferDeclaration("Global", static_cast<u32>(source.first)));
-
 				const char* token;
 				const char* str;
 
 				str = source.second.c_str();
 				while ((token = FindToken(str, "struct")))
-					ParseUniformStruct(GetBlock(token, &str), source.first);
+					declarations.push_back({ source.first, true, GetBlock(token, &str) });
 
 				str = source.second.c_str();
 				while ((token = FindToken(str, "uniform")))
-					ParseUniform(GetStatement(token, &str), source.first);
+					declarations.push_back({ source.first, false, GetStatement(token, &str) });
+			}
+		}
+
+		void GLShader::ParseDeclarations(const std::map<ShaderType, String>& sources, const std::vector<GLShaderCacheDeclaration>& declarations)
+		{
+			for (auto& source : sources)
+			{
+				m_UniformBuffers[source.first].push_back(lmnew GLShaderUniformBufferDeclaration("Global", static_cast<u32>(source.first)));
+
+				for (auto& declaration : declarations)
+				{
+					if (declaration.type != source.first)
+						continue;
+
+					if (declaration.isStruct)
+						ParseUniformStruct(declaration.statement, source.first);
+					else
+						ParseUniform(declaration.statement, source.first);
+				}
 			}
 		}
 
@@ -5,6 +5,7 @@
 #include "GLShaderUniform.h"
 #include "GLShaderResource.h"
 #include "GLUniformBuffer.h"
+#include "GLShaderCache.h"
 
 #include <spirv_glsl.hpp>
 
@@ -47,7 +48,7 @@ namespace Lumos
             std::map<uint32_t, std::string> m_names;
             std::map<uint32_t, uint32_t> m_uniformBlockLocations;
             std::map<uint32_t, uint32_t> m_sampledImageLocations;
-            std::vector<spirv_cross::CompilerGLSL*> m_pShaderCompilers;
+            std::vector<String> m_UniformBlockNames;
         
             void* GetHandle() const override { return (void*)(size_t)m_Handle; }
         
@@ -80,12 +81,21 @@ namespace Lumos
 			static void PreProcess(const String& source, std::map<ShaderType, String>* sources);
 			static void ReadShaderFile(std::vector<String> lines, std::map<ShaderType, String>* shaders);
 
+			void CrossCompile(std::map<ShaderType, String>* sources, std::vector<String>& uniformBlocks) const;
+
 			void Parse(std::map<ShaderType, String>* sources);
+			static void CollectDeclarations(std::map<ShaderType, String>* sources, std::vector<GLShaderCacheDeclaration>& declarations);
+			void ParseDeclarations(const std::map<ShaderType, String>& sources, const std::vector<GLShaderCacheDeclaration>& declarations);
 			void ParseUniform(const String& statement, ShaderType type);
 			void ParseUniformStruct(const String& block, ShaderType shaderType);
 
 			static bool IsTypeStringResource(const String& type);
 
+			bool LoadProgramBinary(u32 format, const std::vector<u8>& binary);
+			bool GetProgramBinary(u32& format, std::vector<u8>& binary) const;
+			static bool SupportsProgramBinary();
+			static String GetDriverString();
+
 			ShaderStruct* FindStruct(const String& name);
 
 			void ResolveUniforms();
@@ -0,0 +1,245 @@
+#include "lmpch.h"
+#include "GLShaderCache.h"
+#include "Core/VFS.h"
+#include "Core/OS/FileSystem.h"
+
+#define SHADER_CACHE_MAGIC (u32('L') | (u32('G') << 8) | (u32('S') << 16) | (u32('C') << 24))
+// Also bump when the GLSL cross compile options in GLShader::Init change
+#define SHADER_CACHE_VERSION 1
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		bool GLShaderCache::s_Enabled = true;
+
+		struct ShaderCacheHeader
+		{
+			u32 magic;
+			u32 version;
+			u64 sourceHash;
+			u32 stageFileCount;
+			u32 sourceCount;
+			u32 declarationCount;
+			u32 uniformBlockCount;
+			u32 binaryFormat;
+			u32 binarySize;
+		};
+
+		class ShaderCacheWriter
+		{
+		public:
+			explicit ShaderCacheWriter(std::vector<u8>& data) : m_Data(data) {}
+
+			void WriteBytes(const void* bytes, size_t size)
+			{
+				const size_t offset = m_Data.size();
+				m_Data.resize(offset + size);
+				if (size > 0)
+					memcpy(m_Data.data() + offset, bytes, size);
+			}
+
+			template<typename T>
+			void Write(const T& value) { WriteBytes(&value, sizeof(T)); }
+
+			void WriteString(const String& string)
+			{
+				Write(static_cast<u32>(string.size()));
+				WriteBytes(string.data(), string.size());
+			}
+
+		private:
+			std::vector<u8>& m_Data;
+		};
+
+		class ShaderCacheReader
+		{
+		public:
+			ShaderCacheReader(const u8* data, size_t size) : m_Data(data), m_Size(size) {}
+
+			bool ReadBytes(void* bytes, size_t size)
+			{
+				if (m_Offset + size > m_Size)
+					return false;
+
+				if (size > 0)
+					memcpy(bytes, m_Data + m_Offset, size);
+				m_Offset += size;
+				return true;
+			}
+
+			template<typename T>
+			bool Read(T& value) { return ReadBytes(&value, sizeof(T)); }
+
+			bool ReadString(String& string)
+			{
+				u32 length;
+				if (!Read(length) || m_Offset + length > m_Size)
+					return false;
+
+				string.assign(reinterpret_cast<const char*>(m_Data + m_Offset), length);
+				m_Offset += length;
+				return true;
+			}
+
+		private:
+			const u8* m_Data;
+			size_t m_Size;
+			size_t m_Offset = 0;
+		};
+
+		u64 GLShaderCache::Hash(const void* data, size_t size, u64 seed)
+		{
+			const u8* bytes = static_cast<const u8*>(data);
+			u64 hash = seed;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		u64 GLShaderCache::HashSources(const String& shaderSource, const String& shaderPath, const std::vector<String>& stageFiles)
+		{
+			u64 hash = Hash(shaderSource.data(), shaderSource.size());
+
+			for (auto& file : stageFiles)
+			{
+				String physicalPath;
+				if (!VFS::Get()->ResolvePhysicalPath(shaderPath + file, physicalPath))
+					return 0;
+
+				const i64 size = FileSystem::GetFileSize(physicalPath);
+				u8* data = FileSystem::ReadFile(physicalPath);
+				if (!data)
+					return 0;
+
+				hash = Hash(file.data(), file.size(), hash);
+				hash = Hash(data, static_cast<size_t>(size), hash);
+				delete[] data;
+			}
+
+			return hash;
+		}
+
+		String GLShaderCache::GetCachePath(const String& shaderPath, const String& name)
+		{
+			// Asset folders can be read only or shared between builds, so like the Vulkan pipeline cache the
+			// file goes in the working directory. The folder's hash keeps same named shaders apart.
+			char hash[17];
+			snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(Hash(shaderPath.data(), shaderPath.size())));
+			return name + "." + hash + ".glcache";
+		}
+
+		bool GLShaderCache::Load(const String& filePath, GLShaderCacheEntry& entry)
+		{
+			if (!FileSystem::FileExists(filePath))
+				return false;
+
+			const i64 size = FileSystem::GetFileSize(filePath);
+			if (size < static_cast<i64>(sizeof(ShaderCacheHeader)))
+				return false;
+
+			std::vector<u8> data(static_cast<size_t>(size));
+			if (!FileSystem::ReadFile(filePath, data.data(), size))
+				return false;
+
+			ShaderCacheReader reader(data.data(), data.size());
+
+			ShaderCacheHeader header;
+			reader.Read(header);
+			if (header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION)
+			{
+				LUMOS_LOG_WARN("Ignoring shader cache {0}, wrong version", filePath);
+				return false;
+			}
+
+			entry = GLShaderCacheEntry();
+			entry.sourceHash = header.sourceHash;
+			entry.binaryFormat = header.binaryFormat;
+
+			entry.stageFiles.resize(header.stageFileCount);
+			for (auto& file : entry.stageFiles)
+			{
+				if (!reader.ReadString(file))
+					return false;
+			}
+
+			for (u32 i = 0; i < header.sourceCount; i++)
+			{
+				u32 type;
+				String source;
+				if (!reader.Read(type) || !reader.ReadString(source))
+					return false;
+				entry.sources[static_cast<ShaderType>(type)] = std::move(source);
+			}
+
+			entry.declarations.resize(header.declarationCount);
+			for (auto& declaration : entry.declarations)
+			{
+				u32 type;
+				u8 isStruct;
+				if (!reader.Read(type) || !reader.Read(isStruct) || !reader.ReadString(declaration.statement))
+					return false;
+				declaration.type = static_cast<ShaderType>(type);
+				declaration.isStruct = isStruct != 0;
+			}
+
+			entry.uniformBlocks.resize(header.uniformBlockCount);
+			for (auto& block : entry.uniformBlocks)
+			{
+				if (!reader.ReadString(block))
+					return false;
+			}
+
+			if (!reader.ReadString(entry.driver))
+				return false;
+
+			entry.binary.resize(header.binarySize);
+			return reader.ReadBytes(entry.binary.data(), header.binarySize);
+		}
+
+		bool GLShaderCache::Save(const String& filePath, const GLShaderCacheEntry& entry)
+		{
+			std::vector<u8> data;
+			ShaderCacheWriter writer(data);
+
+			ShaderCacheHeader header;
+			header.magic = SHADER_CACHE_MAGIC;
+			header.version = SHADER_CACHE_VERSION;
+			header.sourceHash = entry.sourceHash;
+			header.stageFileCount = static_cast<u32>(entry.stageFiles.size());
+			header.sourceCount = static_cast<u32>(entry.sources.size());
+			header.declarationCount = static_cast<u32>(entry.declarations.size());
+			header.uniformBlockCount = static_cast<u32>(entry.uniformBlocks.size());
+			header.binaryFormat = entry.binaryFormat;
+			header.binarySize = static_cast<u32>(entry.binary.size());
+			writer.Write(header);
+
+			for (auto& file : entry.stageFiles)
+				writer.WriteString(file);
+
+			for (auto& source : entry.sources)
+			{
+				writer.Write(static_cast<u32>(source.first));
+				writer.WriteString(source.second);
+			}
+
+			for (auto& declaration : entry.declarations)
+			{
+				writer.Write(static_cast<u32>(declaration.type));
+				writer.Write(static_cast<u8>(declaration.isStruct));
+				writer.WriteString(declaration.statement);
+			}
+
+			for (auto& block : entry.uniformBlocks)
+				writer.WriteString(block);
+
+			writer.WriteString(entry.driver);
+			writer.WriteBytes(entry.binary.data(), entry.binary.size());
+
+			return FileSystem::WriteFile(filePath, data.data(), static_cast<u32>(data.size()));
+		}
+	}
+}
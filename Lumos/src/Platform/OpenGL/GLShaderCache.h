@@ -0,0 +1,60 @@
+#pragma once
+#include "lmpch.h"
+#include "Graphics/API/Shader.h"
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		// A struct block or uniform statement found by GLShader::Parse, replayed instead of scanning the sources
+		struct GLShaderCacheDeclaration
+		{
+			ShaderType type;
+			bool isStruct;
+			String statement;
+		};
+
+		struct GLShaderCacheEntry
+		{
+			// Hash of the .shader file and every stage file it lists
+			u64 sourceHash = 0;
+			std::vector<String> stageFiles;
+
+			// Cross compiled GLSL per stage, and the declarations and uniform blocks reflected from it
+			std::map<ShaderType, String> sources;
+			std::vector<GLShaderCacheDeclaration> declarations;
+			std::vector<String> uniformBlocks;
+
+			// GL_VENDOR, GL_RENDERER and GL_VERSION of the driver the binary came from
+			String driver;
+			u32 binaryFormat = 0;
+			std::vector<u8> binary;
+		};
+
+		// On disk cache of everything GLShader::Init produces before linking, plus the linked program binary.
+		// Nothing here touches GL, the binary is stored as an opaque blob.
+		class LUMOS_EXPORT GLShaderCache
+		{
+		public:
+			static const u64 HASH_SEED = 14695981039346656037ull;
+
+			// FNV-1a, pass the previous result as seed to chain several buffers
+			static u64 Hash(const void* data, size_t size, u64 seed = HASH_SEED);
+
+			// Hashes the .shader source and the stage files read through the VFS. Returns 0 if a stage file is missing.
+			static u64 HashSources(const String& shaderSource, const String& shaderPath, const std::vector<String>& stageFiles);
+
+			// Path of the cache file for a shader, in the working directory and named after the shader and its folder
+			static String GetCachePath(const String& shaderPath, const String& name);
+
+			static bool Load(const String& filePath, GLShaderCacheEntry& entry);
+			static bool Save(const String& filePath, const GLShaderCacheEntry& entry);
+
+			static bool IsEnabled() { return s_Enabled; }
+			static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+
+		private:
+			static bool s_Enabled;
+		};
+	}
+}
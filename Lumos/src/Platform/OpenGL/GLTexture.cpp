@@ -4,11 +4,65 @@
 #include "Platform/OpenGL/GLTools.h"
 #include "Platform/OpenGL/GLShader.h"
 #include "Utilities/LoadImage.h"
+#include "Graphics/CookedTexture.h"
 
 namespace Lumos
 {
 	namespace Graphics
 	{
+		static bool SupportsCookedFormat(TextureFormat format, bool srgb)
+		{
+#ifdef LUMOS_PLATFORM_MOBILE
+			return !CookedTexture::IsCompressedFormat(format);
+#else
+			switch (format)
+			{
+			case TextureFormat::BC1:
+			case TextureFormat::BC3:	return GLAD_GL_EXT_texture_compression_s3tc && (!srgb || GLAD_GL_EXT_texture_sRGB);
+			case TextureFormat::BC5:	return true;
+			case TextureFormat::BC7:	return GLAD_GL_ARB_texture_compression_bptc || GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 2);
+			default:					return true;
+			}
+#endif
+		}
+
+		static u32 CookedFormatToGL(TextureFormat format, bool srgb)
+		{
+			switch (format)
+			{
+#ifndef LUMOS_PLATFORM_MOBILE
+			case TextureFormat::BC1:	return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+			case TextureFormat::BC3:	return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			case TextureFormat::BC5:	return GL_COMPRESSED_RG_RGTC2;
+			case TextureFormat::BC7:	return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+#endif
+			default:					return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+			}
+		}
+
+		// Uploads every mip of each face of a cooked texture to the bound texture. Targets are
+		// GL_TEXTURE_2D, or GL_TEXTURE_CUBE_MAP_POSITIVE_X for the first face of a cube.
+		static void UploadCooked(u32 target, CookedTexture& cooked)
+		{
+			if (!SupportsCookedFormat(cooked.GetFormat(), cooked.IsSRGB()))
+				cooked.Decompress();
+
+			const u32 internalFormat = CookedFormatToGL(cooked.GetFormat(), cooked.IsSRGB());
+			const bool compressed = CookedTexture::IsCompressedFormat(cooked.GetFormat());
+
+			for (u32 face = 0; face < cooked.GetFaceCount(); face++)
+			{
+				for (u32 mip = 0; mip < cooked.GetMipCount(); mip++)
+				{
+					const CookedTexture::Level& level = cooked.GetLevel(face, mip);
+					if (compressed)
+						GLCall(glCompressedTexImage2D(target + face, mip, internalFormat, level.width, level.height, 0, level.size, cooked.GetLevelData(face, mip)));
+					else
+						GLCall(glTexImage2D(target + face, mip, internalFormat, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, cooked.GetLevelData(face, mip)));
+				}
+			}
+		}
+
 		GLTexture2D::GLTexture2D() : m_Width(0), m_Height(0)
 		{
 			glGenTextures(1, &m_Handle);
@@ -67,6 +121,11 @@ namespace Lumos
 			{
 				if (m_FileName != "")
 				{
+					String cookedPath;
+					CookedTexture cooked;
+					if (CookedTexture::FindCooked(m_FileName, cookedPath) && cooked.Load(cookedPath) && cooked.GetFaceCount() == 1)
+						return LoadCooked(cooked);
+
 					pixels = LoadTextureData();
 				}
 			}
@@ -76,6 +135,29 @@ namespace Lumos
 			return handle;
 		}
 
+		u32 GLTexture2D::LoadCooked(CookedTexture& cooked)
+		{
+			m_Width = cooked.GetWidth();
+			m_Height = cooked.GetHeight();
+
+			u32 handle;
+			GLCall(glGenTextures(1, &handle));
+			GLCall(glBindTexture(GL_TEXTURE_2D, handle));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_Parameters.minFilter == TextureFilter::LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_Parameters.magFilter == TextureFilter::LINEAR ? GL_LINEAR : GL_NEAREST));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GLTools::TextureWrapToGL(m_Parameters.wrap)));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GLTools::TextureWrapToGL(m_Parameters.wrap)));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, cooked.GetMipCount() - 1));
+
+			UploadCooked(GL_TEXTURE_2D, cooked);
+			m_Parameters.format = cooked.GetFormat();
+#ifdef LUMOS_DEBUG
+			GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+#endif
+
+			return handle;
+		}
+
 		void GLTexture2D::SetData(const void* pixels)
 		{
 			GLCall(glBindTexture(GL_TEXTURE_2D, m_Handle));
@@ -183,7 +265,7 @@ namespace Lumos
 
 		GLTextureCube::~GLTextureCube()
 		{
-			GLCall(glDeleteTextures(m_NumMips, &m_Handle));
+			GLCall(glDeleteTextures(1, &m_Handle));
 		}
 
 		void GLTextureCube::Bind(u32 slot) const
@@ -200,8 +282,33 @@ namespace Lumos
 
 		u32 GLTextureCube::LoadFromSingleFile()
 		{
-			// TODO: Implement
-			return 0;
+			// Only cooked cubes can be loaded from a single file
+			String cookedPath;
+			CookedTexture cooked;
+			if (!CookedTexture::FindCooked(m_Files[0], cookedPath) || !cooked.Load(cookedPath) || cooked.GetFaceCount() != 6)
+			{
+				LUMOS_LOG_ERROR("Failed to load cube map {0}", m_Files[0]);
+				return 0;
+			}
+
+			m_Width = cooked.GetWidth();
+			m_Height = cooked.GetHeight();
+			m_Size = m_Width;
+			m_NumMips = cooked.GetMipCount();
+
+			u32 result;
+			GLCall(glGenTextures(1, &result));
+			GLCall(glBindTexture(GL_TEXTURE_CUBE_MAP, result));
+			GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+			GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+			GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE));
+			GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, m_NumMips - 1));
+
+			UploadCooked(GL_TEXTURE_CUBE_MAP_POSITIVE_X, cooked);
+
+			return result;
 		}
 
 		u32 GLTextureCube::LoadFromMultipleFiles()
@@ -6,6 +6,8 @@ namespace Lumos
 {
 	namespace Graphics
 	{
+		class CookedTexture;
+
 		class GLTexture2D : public Texture2D
 		{
 		public:
@@ -40,6 +42,7 @@ namespace Lumos
 
 		private:
 			u32 Load(void* data);
+			u32 LoadCooked(CookedTexture& cooked);
 
 			String m_Name;
 			String m_FileName;
@@ -78,7 +81,7 @@ namespace Lumos
 			static TextureCube* CreateFromVCrossFuncGL(const String* files, u32 mips, InputFormat format);
             
 		private:
-			static u32 LoadFromSingleFile();
+			u32 LoadFromSingleFile();
 			u32 LoadFromMultipleFiles();
 			u32 LoadFromVCross(u32 mips);
 
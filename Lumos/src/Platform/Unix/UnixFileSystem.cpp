@@ -48,14 +48,25 @@ namespace Lumos
         return buffer.st_size;
     }
 
+    i64 FileSystem::GetModifiedTime(const String& path)
+    {
+        struct stat buffer;
+        if (stat(path.c_str(), &buffer) != 0)
+            return 0;
+#ifdef LUMOS_PLATFORM_MACOS
+        return i64(buffer.st_mtimespec.tv_sec) * 1000000000 + buffer.st_mtimespec.tv_nsec;
+#else
+        return i64(buffer.st_mtim.tv_sec) * 1000000000 + buffer.st_mtim.tv_nsec;
+#endif
+    }
+
     bool FileSystem::ReadFile(const String& path, void* buffer, i64 size)
     {
         if(!FileExists(path))
             return false;
         if(size < 0)
             size = GetFileSize(path);
-        buffer = new u8[size + 1];
-        FILE* file = fopen(path.c_str(), "r");
+        FILE* file = fopen(path.c_str(), "rb");
         bool result = false;
         if(file)
         {
@@ -101,12 +112,14 @@ namespace Lumos
         return success ? result : String();
     }
 
-    bool FileSystem::WriteFile(const String& path, u8* buffer)
+    bool FileSystem::WriteFile(const String& path, u8* buffer, u32 size)
     {
         FILE* file = fopen(path.c_str(), "wb");
-        size_t size = fwrite(buffer, 1, sizeof(buffer), file);
+        if(!file)
+            return false;
+        size_t written = fwrite(buffer, 1, size, file);
         fclose(file);
-        return size > 0;
+        return written == size;
     }
 
     bool FileSystem::WriteTextFile(const String& path, const String& text)
@@ -17,24 +17,40 @@ namespace Lumos
 		}
 
 		VKBuffer::~VKBuffer()
+		{
+			Release();
+		}
+
+		void VKBuffer::Release()
 		{
 			if (m_Buffer)
 			{
+				// Command buffers recorded this frame can still reference the buffer, e.g. when SetData
+				// recreates a vertex buffer that was already drawn
+				VkBuffer buffer = m_Buffer;
+				auto allocation = m_Allocation;
 #ifdef USE_VMA_ALLOCATOR
-                vmaDestroyBuffer(VKDevice::Instance()->GetAllocator(), m_Buffer, m_Allocation);
+				VKDevice::Instance()->DeferDelete([buffer, allocation]() { vmaDestroyBuffer(VKDevice::Instance()->GetAllocator(), buffer, allocation); });
 #else
-				vkDestroyBuffer(VKDevice::Device(), m_Buffer, nullptr);
-
-				if (m_Memory)
+				VKDevice::Instance()->DeferDelete([buffer, allocation]() mutable
 				{
-					vkFreeMemory(VKDevice::Device(), m_Memory, nullptr);
-				}
+					vkDestroyBuffer(VKDevice::Device(), buffer, nullptr);
+					VKDevice::Instance()->GetMemoryManager()->Free(allocation);
+				});
+				m_Allocation = VKAllocation();
+				m_Memory = VK_NULL_HANDLE;
 #endif
+				m_Buffer = VK_NULL_HANDLE;
+				m_Mapped = nullptr;
 			}
 		}
 
-		void VKBuffer::Init(VkBufferUsageFlags usage, uint32_t size, const void* data)
+		void VKBuffer::Init(VkBufferUsageFlags usage, uint32_t size, const void* data, bool deviceLocal)
 		{
+			Release();
+
+			m_Size = size;
+
 			VkBufferCreateInfo bufferInfo = {};
 			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 			bufferInfo.size = size;
@@ -46,27 +62,41 @@ namespace Lumos
             vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
             vmaCreateBuffer(VKDevice::Instance()->GetAllocator(), &bufferInfo, &vmaAllocInfo, &m_Buffer, &m_Allocation, nullptr);
 #else
+			m_DeviceLocal = deviceLocal;
+
+			if (m_DeviceLocal)
+				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
 			VK_CHECK_RESULT(vkCreateBuffer(VKDevice::Device(), &bufferInfo, nullptr, &m_Buffer));
 
 			VkMemoryRequirements memRequirements;
 			vkGetBufferMemoryRequirements(VKDevice::Device(), m_Buffer, &memRequirements);
 
-			VkMemoryAllocateInfo allocInfo = {};
-			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocInfo.allocationSize = memRequirements.size;
-			allocInfo.memoryTypeIndex = VKTools::FindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			// Host visible memory stays persistently mapped by the memory manager
+			VkMemoryPropertyFlags properties = m_DeviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			m_Allocation = VKDevice::Instance()->GetMemoryManager()->Allocate(memRequirements, properties);
+			m_Memory = m_Allocation.memory;
 
-			VK_CHECK_RESULT(vkAllocateMemory(VKDevice::Device(), &allocInfo, nullptr, &m_Memory));
-
-			vkBindBufferMemory(VKDevice::Device(), m_Buffer, m_Memory, 0);
+			vkBindBufferMemory(VKDevice::Device(), m_Buffer, m_Memory, m_Allocation.offset);
 #endif
 
+			m_DesciptorBufferInfo.buffer = m_Buffer;
+			m_DesciptorBufferInfo.offset = 0;
+			m_DesciptorBufferInfo.range = size;
+
 			if(data != nullptr)
 				SetData(size, data);
 		}
 
 		void VKBuffer::SetData(uint32_t size, const void* data)
 		{
+#ifndef USE_VMA_ALLOCATOR
+			if (m_DeviceLocal)
+			{
+				VKDevice::Instance()->GetMemoryManager()->UploadToBuffer(m_Buffer, 0, data, size);
+				return;
+			}
+#endif
 			Map(size, 0);
 			memcpy(m_Mapped, data, size);
 			UnMap();
@@ -76,11 +106,14 @@ namespace Lumos
 		{
 #ifdef USE_VMA_ALLOCATOR
 			VkResult res = static_cast<VkResult>(vmaMapMemory(VKDevice::Instance()->GetAllocator(), m_Allocation, &m_Mapped));
-#else
-			VkResult res = vkMapMemory(VKDevice::Device(), m_Memory, offset, size, 0, &m_Mapped);
-#endif
 			if (res != VK_SUCCESS)
 				LUMOS_LOG_CRITICAL("[VULKAN] Failed to map buffer");
+#else
+			if (!m_Allocation.mapped)
+				LUMOS_LOG_CRITICAL("[VULKAN] Failed to map buffer");
+			else
+				m_Mapped = m_Allocation.mapped + offset;
+#endif
 		}
 
 		void VKBuffer::UnMap()
@@ -89,23 +122,16 @@ namespace Lumos
 			{
 #ifdef USE_VMA_ALLOCATOR
 				vmaUnmapMemory(VKDevice::Instance()->GetAllocator(), m_Allocation);
-#else
-				vkUnmapMemory(VKDevice::Device(), m_Memory);
 #endif
 				m_Mapped = nullptr;
 			}
 		}
 
+		// Without VMA host visible memory is always allocated coherent, so there is nothing to flush or invalidate
 		void VKBuffer::Flush(VkDeviceSize size, VkDeviceSize offset)
 		{
 #ifdef USE_VMA_ALLOCATOR
 			vmaFlushAllocation(VKDevice::Instance()->GetAllocator(), m_Allocation, offset, size);
-#else
-			VkMappedMemoryRange mappedRange = {};
-			mappedRange.memory = m_Memory;
-			mappedRange.offset = offset;
-			mappedRange.size = size;
-			vkFlushMappedMemoryRanges(VKDevice::Device(), 1, &mappedRange);
 #endif
 		}
 		
@@ -113,12 +139,6 @@ namespace Lumos
 		{
 #ifdef USE_VMA_ALLOCATOR
 			vmaInvalidateAllocation(VKDevice::Instance()->GetAllocator(), m_Allocation, offset, size);
-#else
-			VkMappedMemoryRange mappedRange = {};
-			mappedRange.memory = m_Memory;
-			mappedRange.offset = offset;
-			mappedRange.size = size;
-			vkInvalidateMappedMemoryRanges(VKDevice::Device(), 1, &mappedRange);
 #endif
 		}
 	}
@@ -4,6 +4,8 @@
 
 #ifdef USE_VMA_ALLOCATOR
 #include <vulkan/vk_mem_alloc.h>
+#else
+#include "VKMemoryManager.h"
 #endif
 
 namespace Lumos
@@ -17,7 +19,9 @@ namespace Lumos
 			VKBuffer();
 			virtual ~VKBuffer();
 
-			void Init(VkBufferUsageFlags usage, uint32_t size, const void* data);
+			// Device local buffers are filled through the staging ring and can't be mapped
+			void Init(VkBufferUsageFlags usage, uint32_t size, const void* data, bool deviceLocal = false);
+			void Release();
 
 			void SetData(uint32_t size, const void* data);
 			const VkBuffer& GetBuffer() const { return m_Buffer; }
@@ -36,10 +40,13 @@ namespace Lumos
 			VkDeviceSize m_Size = 0;
 			VkDeviceSize m_Alignment = 0;
 			void* m_Mapped = nullptr;
+			bool m_DeviceLocal = false;
 
 #ifdef USE_VMA_ALLOCATOR
             VmaAllocation m_Allocation{};
 			VmaAllocation m_MappedAllocation{};
+#else
+			VKAllocation m_Allocation{};
 #endif
 		};
 	}
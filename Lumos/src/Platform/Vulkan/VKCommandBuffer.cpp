@@ -102,6 +102,11 @@ namespace Lumos
 				if (!signalSemaphore)
 					signalSemaphoreCount = 0;
 
+#ifndef USE_VMA_ALLOCATOR
+				// Staged buffer uploads must land before anything recorded against them runs
+				VKDevice::Instance()->GetMemoryManager()->FlushUploads();
+#endif
+
 				VkSubmitInfo submitInfo{};
 				submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 				submitInfo.pNext = VK_NULL_HANDLE;
@@ -470,6 +470,12 @@ namespace Lumos
                     }
                 }
             }
+#else
+            if (ImGui::TreeNode("Memory"))
+            {
+                VKDevice::Instance()->GetMemoryManager()->OnImGui();
+                ImGui::TreePop();
+            }
 #endif
 		}
         
@@ -4,6 +4,10 @@
 #include "Core/Version.h"
 #include "VKDevice.h"
 #include "VKRenderer.h"
+#include "VKPipeline.h"
+#include "Core/OS/FileSystem.h"
+
+#define PIPELINE_CACHE_FILE "PipelineCache.bin"
 
 namespace Lumos
 {
@@ -170,6 +174,15 @@ namespace Lumos
 			deviceFeatures.fillModeNonSolid = VK_TRUE;
 			deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+			// The material table indexes its sampler array with a per draw push constant
+			VkPhysicalDeviceFeatures supportedFeatures;
+			vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+			deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+
+			// Cooked textures are uploaded block compressed when the device can sample BC formats
+			deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+			m_TextureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+
 			auto& layers = m_VKContext->GetLayerNames();
 
 			const std::vector<const char*> deviceExtensions = 
@@ -239,6 +252,8 @@ namespace Lumos
             {
 				Debug::Log::Critical("[VULKAN] Failed to create VMA allocator");
             }
+#else
+			m_MemoryManager = lmnew VKMemoryManager(m_Device, m_PhysicalDevice, m_GraphicsQueueFamilyIndex, m_GraphicsQueue);
 #endif
 
 			return VK_SUCCESS;
@@ -246,10 +261,16 @@ namespace Lumos
 
 		void VKDevice::Unload()
 		{
+			FlushDeletions();
+			SavePipelineCache();
+			VKPipeline::LogStats("shutdown");
+
 			vkDestroyPipelineCache(m_Device, m_PipelineCache, VK_NULL_HANDLE);
 
 #ifdef USE_VMA_ALLOCATOR
 			vmaDestroyAllocator(m_Allocator);
+#else
+			delete m_MemoryManager;
 #endif
 
 			vkDestroyDevice(m_Device, VK_NULL_HANDLE);
@@ -257,6 +278,32 @@ namespace Lumos
 
 		}
 
+		void VKDevice::DeferDelete(std::function<void()> func)
+		{
+			std::lock_guard<std::mutex> lock(m_DeletionMutex);
+			m_DeletionQueues[m_DeletionFrame].push_back(std::move(func));
+		}
+
+		void VKDevice::OnNewFrame()
+		{
+			// Every submission waits for the queue to go idle, so the oldest frame's work is long done
+			std::vector<std::function<void()>> deletions;
+			{
+				std::lock_guard<std::mutex> lock(m_DeletionMutex);
+				m_DeletionFrame = (m_DeletionFrame + 1) % DELETION_QUEUE_FRAMES;
+				deletions.swap(m_DeletionQueues[m_DeletionFrame]);
+			}
+
+			for (auto& func : deletions)
+				func();
+		}
+
+		void VKDevice::FlushDeletions()
+		{
+			for (u32 i = 0; i < DELETION_QUEUE_FRAMES; i++)
+				OnNewFrame();
+		}
+
 		bool VKDevice::MemoryTypeFromProperties(uint32_t typeBits, VkMemoryPropertyFlags reqMask, uint32_t * typeIndex)
 		{
 			for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
@@ -274,12 +321,77 @@ namespace Lumos
 			return false;
 		}
 
+		// Layout of the header every driver writes at the start of vkGetPipelineCacheData
+		struct PipelineCacheHeader
+		{
+			u32 headerLength;
+			u32 headerVersion;
+			u32 vendorID;
+			u32 deviceID;
+			u8 pipelineCacheUUID[VK_UUID_SIZE];
+		};
+
 		void VKDevice::CreatePipelineCache()
 		{
+			u8* cacheData = nullptr;
+			i64 cacheSize = FileSystem::GetFileSize(PIPELINE_CACHE_FILE);
+
+			if (cacheSize >= static_cast<i64>(sizeof(PipelineCacheHeader)))
+			{
+				cacheData = FileSystem::ReadFile(PIPELINE_CACHE_FILE);
+
+				// Data from a different driver or GPU is rejected, drivers are not required to validate it
+				PipelineCacheHeader header;
+				if (cacheData)
+					memcpy(&header, cacheData, sizeof(PipelineCacheHeader));
+
+				if (!cacheData ||
+					header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+					header.vendorID != m_PhysicalDeviceProperties.vendorID ||
+					header.deviceID != m_PhysicalDeviceProperties.deviceID ||
+					memcmp(header.pipelineCacheUUID, m_PhysicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+				{
+					Debug::Log::Warning("[VULKAN] Pipeline cache {0} does not match this device, discarding", PIPELINE_CACHE_FILE);
+					delete[] cacheData;
+					cacheData = nullptr;
+				}
+			}
+
+			m_PipelineCacheWarm = cacheData != nullptr;
+
 			VkPipelineCacheCreateInfo pipelineCacheCI{};
 			pipelineCacheCI.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
 			pipelineCacheCI.pNext = NULL;
-			vkCreatePipelineCache(m_Device, &pipelineCacheCI, VK_NULL_HANDLE, &m_PipelineCache);
+			pipelineCacheCI.initialDataSize = m_PipelineCacheWarm ? static_cast<size_t>(cacheSize) : 0;
+			pipelineCacheCI.pInitialData = cacheData;
+
+			if (vkCreatePipelineCache(m_Device, &pipelineCacheCI, VK_NULL_HANDLE, &m_PipelineCache) != VK_SUCCESS && m_PipelineCacheWarm)
+			{
+				Debug::Log::Warning("[VULKAN] Failed to create pipeline cache from {0}, starting cold", PIPELINE_CACHE_FILE);
+				m_PipelineCacheWarm = false;
+				pipelineCacheCI.initialDataSize = 0;
+				pipelineCacheCI.pInitialData = nullptr;
+				vkCreatePipelineCache(m_Device, &pipelineCacheCI, VK_NULL_HANDLE, &m_PipelineCache);
+			}
+
+			delete[] cacheData;
+		}
+
+		void VKDevice::SavePipelineCache()
+		{
+			if (!m_PipelineCache)
+				return;
+
+			size_t cacheSize = 0;
+			if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &cacheSize, nullptr) != VK_SUCCESS || cacheSize == 0)
+				return;
+
+			std::vector<u8> cacheData(cacheSize);
+			if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &cacheSize, cacheData.data()) != VK_SUCCESS)
+				return;
+
+			if (!FileSystem::WriteFile(PIPELINE_CACHE_FILE, cacheData.data(), static_cast<u32>(cacheSize)))
+				Debug::Log::Warning("[VULKAN] Failed to write pipeline cache {0}", PIPELINE_CACHE_FILE);
 		}
 	}
 }
@@ -3,12 +3,16 @@
 #include "VK.h"
 #include "VKContext.h"
 
+#include <mutex>
+
 #ifdef USE_VMA_ALLOCATOR
 #ifdef LUMOS_DEBUG
 #define VMA_DEBUG_MARGIN 16
 #define VMA_DEBUG_DETECT_CORRUPTION 1
 #endif
 #include <vulkan/vk_mem_alloc.h>
+#else
+#include "VKMemoryManager.h"
 #endif
 
 namespace Lumos
@@ -38,6 +42,7 @@ namespace Lumos
 			void Unload();
 			bool MemoryTypeFromProperties(uint32_t typeBits, VkMemoryPropertyFlags reqMask, uint32_t* typeIndex);
 			void CreatePipelineCache();
+			void SavePipelineCache();
 
 			VkDevice GetDevice()							const { return m_Device; };
 			VkPhysicalDevice GetGPU()						const { return m_PhysicalDevice; };
@@ -50,14 +55,25 @@ namespace Lumos
 
 			VkPhysicalDeviceProperties GetGPUProperties()	const { return m_PhysicalDeviceProperties; };
 			VkPipelineCache GetPipelineCache() 			    const { return m_PipelineCache; }
+			bool GetPipelineCacheWarm()						const { return m_PipelineCacheWarm; }
+			bool SupportsTextureCompressionBC()				const { return m_TextureCompressionBC; }
 
 			VKContext* GetVKContext() 						const { return m_VKContext; }
             
 #ifdef USE_VMA_ALLOCATOR
             VmaAllocator GetAllocator()                     const { return m_Allocator; }
+#else
+			VKMemoryManager* GetMemoryManager()				const { return m_MemoryManager; }
 #endif
 
 			VkSurfaceKHR CreatePlatformSurface(VkInstance vkInstance, Window* window);
+
+			// Queues the destruction of a resource the frame being recorded may still use. It runs
+			// DELETION_QUEUE_FRAMES frames later, once those command buffers have finished on the GPU
+			void DeferDelete(std::function<void()> func);
+			// Called by the renderer as a new frame begins
+			void OnNewFrame();
+			void FlushDeletions();
             
 			static VkDevice Device() { return VKDevice::Instance()->GetDevice(); }
 		private:
@@ -73,12 +89,21 @@ namespace Lumos
 			VkQueue m_GraphicsQueue{};
 			VkQueue m_PresentQueue{};
 			VkPipelineCache m_PipelineCache{};
+			bool m_PipelineCacheWarm = false;
+			bool m_TextureCompressionBC = false;
 			VkDescriptorPool m_DescriptorPool{};
 
 			VKContext* m_VKContext;
+
+			static const u32 DELETION_QUEUE_FRAMES = 2;
+			std::vector<std::function<void()>> m_DeletionQueues[DELETION_QUEUE_FRAMES];
+			u32 m_DeletionFrame = 0;
+			std::mutex m_DeletionMutex;
             
 #ifdef USE_VMA_ALLOCATOR
             VmaAllocator m_Allocator{};
+#else
+			VKMemoryManager* m_MemoryManager = nullptr;
 #endif
 		};
 	}
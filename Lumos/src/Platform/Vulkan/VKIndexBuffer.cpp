@@ -7,12 +7,14 @@ namespace Lumos
 {
 	namespace Graphics
 	{
-		VKIndexBuffer::VKIndexBuffer(u16* data, u32 count, BufferUsage bufferUsage) : VKBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, count * sizeof(u16), data), m_Size(count * sizeof(u16)), m_Count(count), m_Usage(bufferUsage)
+		VKIndexBuffer::VKIndexBuffer(u16* data, u32 count, BufferUsage bufferUsage) : VKBuffer(), m_Size(count * sizeof(u16)), m_Count(count), m_Usage(bufferUsage)
 		{
+			VKBuffer::Init(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_Size, data, m_Usage == BufferUsage::STATIC);
 		}
 
-		VKIndexBuffer::VKIndexBuffer(u32* data, u32 count, BufferUsage bufferUsage) : VKBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, count * sizeof(u32), data) , m_Size(count * sizeof(u32)), m_Count(count), m_Usage(bufferUsage)
+		VKIndexBuffer::VKIndexBuffer(u32* data, u32 count, BufferUsage bufferUsage) : VKBuffer(), m_Size(count * sizeof(u32)), m_Count(count), m_Usage(bufferUsage)
 		{
+			VKBuffer::Init(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, m_Size, data, m_Usage == BufferUsage::STATIC);
 		}
 
 		VKIndexBuffer::~VKIndexBuffer()
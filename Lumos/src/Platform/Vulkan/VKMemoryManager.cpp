@@ -0,0 +1,454 @@
+#include "lmpch.h"
+#include "VKMemoryManager.h"
+#include "VKTools.h"
+
+#include <imgui/imgui.h>
+
+#define MEMORY_BLOCK_SIZE (64 * 1024 * 1024)
+#define STAGING_BUFFER_SIZE (32 * 1024 * 1024)
+#define STAGING_ALIGNMENT 16
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		VKMemoryBlock::VKMemoryBlock(VkDeviceMemory memory, VkDeviceSize size, u8* mapped, bool dedicated)
+			: m_Memory(memory), m_Size(size), m_Mapped(mapped), m_Dedicated(dedicated)
+		{
+			InsertFree(0, size);
+		}
+
+		bool VKMemoryBlock::Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset)
+		{
+			// Smallest free range first, alignment padding can push a candidate over so keep looking
+			for (auto it = m_FreeBySize.lower_bound(size); it != m_FreeBySize.end(); ++it)
+			{
+				VkDeviceSize rangeOffset = it->second;
+				VkDeviceSize rangeSize = it->first;
+				VkDeviceSize alignedOffset = AlignUp(rangeOffset, alignment);
+				VkDeviceSize padding = alignedOffset - rangeOffset;
+
+				if (padding + size > rangeSize)
+					continue;
+
+				EraseFree(m_FreeByOffset.find(rangeOffset));
+
+				if (padding > 0)
+					InsertFree(rangeOffset, padding);
+
+				VkDeviceSize remaining = rangeSize - padding - size;
+				if (remaining > 0)
+					InsertFree(alignedOffset + size, remaining);
+
+				m_Used += size;
+				m_AllocationCount++;
+				outOffset = alignedOffset;
+				return true;
+			}
+
+			return false;
+		}
+
+		void VKMemoryBlock::Free(VkDeviceSize offset, VkDeviceSize size)
+		{
+			m_Used -= size;
+			m_AllocationCount--;
+
+			// Merge with the free ranges either side
+			auto next = m_FreeByOffset.lower_bound(offset);
+			if (next != m_FreeByOffset.end() && offset + size == next->first)
+			{
+				size += next->second;
+				EraseFree(next);
+			}
+
+			auto prev = m_FreeByOffset.lower_bound(offset);
+			if (prev != m_FreeByOffset.begin())
+			{
+				--prev;
+				if (prev->first + prev->second == offset)
+				{
+					offset = prev->first;
+					size += prev->second;
+					EraseFree(prev);
+				}
+			}
+
+			InsertFree(offset, size);
+		}
+
+		void VKMemoryBlock::InsertFree(VkDeviceSize offset, VkDeviceSize size)
+		{
+			m_FreeByOffset[offset] = size;
+			m_FreeBySize.emplace(size, offset);
+		}
+
+		void VKMemoryBlock::EraseFree(std::map<VkDeviceSize, VkDeviceSize>::iterator it)
+		{
+			auto range = m_FreeBySize.equal_range(it->second);
+			for (auto sizeIt = range.first; sizeIt != range.second; ++sizeIt)
+			{
+				if (sizeIt->second == it->first)
+				{
+					m_FreeBySize.erase(sizeIt);
+					break;
+				}
+			}
+
+			m_FreeByOffset.erase(it);
+		}
+
+		VKMemoryManager::VKMemoryManager(VkDevice device, VkPhysicalDevice physicalDevice, u32 queueFamilyIndex, VkQueue queue)
+			: m_Device(device), m_Queue(queue), m_BlockSize(MEMORY_BLOCK_SIZE), m_StagingSize(STAGING_BUFFER_SIZE)
+		{
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+
+			VkCommandPoolCreateInfo commandPoolCI{};
+			commandPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			commandPoolCI.queueFamilyIndex = queueFamilyIndex;
+			commandPoolCI.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			VK_CHECK_RESULT(vkCreateCommandPool(m_Device, &commandPoolCI, nullptr, &m_UploadCommandPool));
+
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandPool = m_UploadCommandPool;
+			allocInfo.commandBufferCount = 1;
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(m_Device, &allocInfo, &m_UploadCommandBuffer));
+
+			VkFenceCreateInfo fenceCI{};
+			fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			VK_CHECK_RESULT(vkCreateFence(m_Device, &fenceCI, nullptr, &m_UploadFence));
+
+			VkBufferCreateInfo bufferInfo{};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = m_StagingSize;
+			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			VK_CHECK_RESULT(vkCreateBuffer(m_Device, &bufferInfo, nullptr, &m_StagingBuffer));
+
+			VkMemoryRequirements memRequirements;
+			vkGetBufferMemoryRequirements(m_Device, m_StagingBuffer, &memRequirements);
+			m_StagingAllocation = Allocate(memRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			vkBindBufferMemory(m_Device, m_StagingBuffer, m_StagingAllocation.memory, m_StagingAllocation.offset);
+		}
+
+		VKMemoryManager::~VKMemoryManager()
+		{
+			FlushUploads();
+
+			vkDestroyBuffer(m_Device, m_StagingBuffer, nullptr);
+			Free(m_StagingAllocation);
+
+			vkDestroyFence(m_Device, m_UploadFence, nullptr);
+			vkDestroyCommandPool(m_Device, m_UploadCommandPool, nullptr);
+
+			for (auto& pool : m_Pools)
+			{
+				for (auto block : pool.blocks)
+				{
+					if (!block)
+						continue;
+
+					if (block->GetAllocationCount() > 0)
+						Debug::Log::Warning("[VULKAN] {0} allocations still alive in memory type {1}", block->GetAllocationCount(), pool.memoryType);
+
+					if (block->GetMapped())
+						vkUnmapMemory(m_Device, block->GetMemory());
+					vkFreeMemory(m_Device, block->GetMemory(), nullptr);
+					delete block;
+				}
+			}
+		}
+
+		bool VKMemoryManager::FindMemoryType(u32 typeBits, VkMemoryPropertyFlags properties, u32& outType) const
+		{
+			for (u32 i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+			{
+				if ((typeBits & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+				{
+					outType = i;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		u32 VKMemoryManager::GetPoolIndex(u32 memoryType, bool image)
+		{
+			// Buffers and images live in separate blocks so bufferImageGranularity never applies
+			for (u32 i = 0; i < m_Pools.size(); i++)
+			{
+				if (m_Pools[i].memoryType == memoryType && m_Pools[i].image == image)
+					return i;
+			}
+
+			m_Pools.push_back({ memoryType, image, {} });
+			return static_cast<u32>(m_Pools.size() - 1);
+		}
+
+		VKAllocation VKMemoryManager::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool image)
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+			VKAllocation allocation;
+
+			u32 memoryType;
+			if (!FindMemoryType(requirements.memoryTypeBits, properties, memoryType))
+			{
+				Debug::Log::Critical("[VULKAN] Failed to find suitable memory type!");
+				return allocation;
+			}
+
+			u32 poolIndex = GetPoolIndex(memoryType, image);
+			auto& pool = m_Pools[poolIndex];
+
+			for (u32 i = 0; i < pool.blocks.size(); i++)
+			{
+				auto block = pool.blocks[i];
+				if (block && block->Allocate(requirements.size, requirements.alignment, allocation.offset))
+				{
+					allocation.memory = block->GetMemory();
+					allocation.mapped = block->GetMapped() ? block->GetMapped() + allocation.offset : nullptr;
+					allocation.size = requirements.size;
+					allocation.poolIndex = poolIndex;
+					allocation.blockIndex = i;
+					return allocation;
+				}
+			}
+
+			// Anything bigger than half a block gets a dedicated block that is released with it
+			const bool dedicated = requirements.size > m_BlockSize / 2;
+			VkDeviceSize blockSize = dedicated ? requirements.size : m_BlockSize;
+
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = blockSize;
+			allocInfo.memoryTypeIndex = memoryType;
+
+			VkDeviceMemory memory;
+			if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+			{
+				Debug::Log::Critical("[VULKAN] Failed to allocate {0} bytes of device memory", blockSize);
+				return allocation;
+			}
+
+			u8* mapped = nullptr;
+			if (m_MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+				VK_CHECK_RESULT(vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&mapped)));
+
+			auto block = lmnew VKMemoryBlock(memory, blockSize, mapped, dedicated);
+
+			u32 blockIndex = static_cast<u32>(pool.blocks.size());
+			for (u32 i = 0; i < pool.blocks.size(); i++)
+			{
+				if (!pool.blocks[i])
+				{
+					blockIndex = i;
+					break;
+				}
+			}
+
+			if (blockIndex == pool.blocks.size())
+				pool.blocks.push_back(block);
+			else
+				pool.blocks[blockIndex] = block;
+
+			block->Allocate(requirements.size, requirements.alignment, allocation.offset);
+			allocation.memory = memory;
+			allocation.mapped = mapped ? mapped + allocation.offset : nullptr;
+			allocation.size = requirements.size;
+			allocation.poolIndex = poolIndex;
+			allocation.blockIndex = blockIndex;
+
+			return allocation;
+		}
+
+		void VKMemoryManager::Free(VKAllocation& allocation)
+		{
+			if (!allocation.IsValid())
+				return;
+
+			std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+			auto& block = m_Pools[allocation.poolIndex].blocks[allocation.blockIndex];
+			block->Free(allocation.offset, allocation.size);
+
+			if (block->GetAllocationCount() == 0 && block->IsDedicated())
+			{
+				if (block->GetMapped())
+					vkUnmapMemory(m_Device, block->GetMemory());
+				vkFreeMemory(m_Device, block->GetMemory(), nullptr);
+				delete block;
+				block = nullptr;
+			}
+
+			allocation = VKAllocation();
+		}
+
+		VkDeviceSize VKMemoryManager::ReserveStaging(VkDeviceSize size)
+		{
+			VkDeviceSize offset = AlignUp(m_StagingHead, STAGING_ALIGNMENT);
+
+			if (offset + size > m_StagingSize)
+			{
+				FlushUploads();
+				offset = 0;
+			}
+
+			m_StagingHead = offset + size;
+			return offset;
+		}
+
+		void VKMemoryManager::BeginUploads()
+		{
+			if (m_PendingUploads > 0)
+				return;
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(m_UploadCommandBuffer, &beginInfo));
+		}
+
+		void VKMemoryManager::UploadToBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size)
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+			const u8* src = static_cast<const u8*>(data);
+
+			// Larger than the ring: stream it through in ring sized chunks
+			while (size > 0)
+			{
+				VkDeviceSize chunkSize = std::min(size, m_StagingSize);
+				VkDeviceSize stagingOffset = ReserveStaging(chunkSize);
+
+				memcpy(m_StagingAllocation.mapped + stagingOffset, src, chunkSize);
+
+				BeginUploads();
+
+				VkBufferCopy copyRegion{};
+				copyRegion.srcOffset = stagingOffset;
+				copyRegion.dstOffset = dstOffset;
+				copyRegion.size = chunkSize;
+				vkCmdCopyBuffer(m_UploadCommandBuffer, m_StagingBuffer, dstBuffer, 1, &copyRegion);
+
+				m_PendingUploads++;
+				m_TotalUploaded += chunkSize;
+
+				src += chunkSize;
+				dstOffset += chunkSize;
+				size -= chunkSize;
+			}
+		}
+
+		bool VKMemoryManager::StageData(const void* data, VkDeviceSize size, VkDeviceSize& outOffset)
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+			if (size > m_StagingSize)
+				return false;
+
+			outOffset = ReserveStaging(size);
+			memcpy(m_StagingAllocation.mapped + outOffset, data, size);
+			m_TotalUploaded += size;
+
+			return true;
+		}
+
+		void VKMemoryManager::FlushUploads()
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+			if (m_PendingUploads > 0)
+			{
+				VkMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+				vkCmdPipelineBarrier(m_UploadCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+				VK_CHECK_RESULT(vkEndCommandBuffer(m_UploadCommandBuffer));
+
+				VkSubmitInfo submitInfo{};
+				submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+				submitInfo.commandBufferCount = 1;
+				submitInfo.pCommandBuffers = &m_UploadCommandBuffer;
+
+				VK_CHECK_RESULT(vkQueueSubmit(m_Queue, 1, &submitInfo, m_UploadFence));
+				VK_CHECK_RESULT(vkWaitForFences(m_Device, 1, &m_UploadFence, VK_TRUE, UINT64_MAX));
+				VK_CHECK_RESULT(vkResetFences(m_Device, 1, &m_UploadFence));
+				VK_CHECK_RESULT(vkResetCommandBuffer(m_UploadCommandBuffer, 0));
+
+				m_PendingUploads = 0;
+				m_UploadSubmits++;
+			}
+
+			m_StagingHead = 0;
+		}
+
+		void VKMemoryManager::OnImGui()
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+
+			const float toMB = 1.0f / (1024.0f * 1024.0f);
+
+			std::vector<VkDeviceSize> heapUsage(m_MemoryProperties.memoryHeapCount, 0);
+
+			for (auto& pool : m_Pools)
+			{
+				VkDeviceSize size = 0, used = 0, largestFree = 0;
+				u32 blockCount = 0, allocationCount = 0, freeRanges = 0;
+
+				for (auto block : pool.blocks)
+				{
+					if (!block)
+						continue;
+
+					blockCount++;
+					size += block->GetSize();
+					used += block->GetUsed();
+					largestFree = std::max(largestFree, block->GetLargestFree());
+					allocationCount += block->GetAllocationCount();
+					freeRanges += block->GetFreeRangeCount();
+				}
+
+				heapUsage[m_MemoryProperties.memoryTypes[pool.memoryType].heapIndex] += size;
+
+				auto propertyFlags = m_MemoryProperties.memoryTypes[pool.memoryType].propertyFlags;
+				String name = fmt::format("Type {} {}{}{}", pool.memoryType, pool.image ? "Images " : "Buffers ",
+					(propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) ? "DEVICE_LOCAL " : "",
+					(propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ? "HOST_VISIBLE" : "");
+
+				if (ImGui::TreeNode(name.c_str()))
+				{
+					VkDeviceSize freeSize = size - used;
+					float fragmentation = freeSize > 0 ? 1.0f - float(largestFree) / float(freeSize) : 0.0f;
+
+					ImGui::Text("Blocks : %u", blockCount);
+					ImGui::Text("Allocations : %u", allocationCount);
+					ImGui::Text("Used : %.2f / %.2f MB", float(used) * toMB, float(size) * toMB);
+					ImGui::Text("Free Ranges : %u", freeRanges);
+					ImGui::Text("Largest Free Range : %.2f MB", float(largestFree) * toMB);
+					ImGui::Text("Fragmentation : %.1f%%", fragmentation * 100.0f);
+					ImGui::TreePop();
+				}
+			}
+
+			for (u32 heapIndex = 0; heapIndex < m_MemoryProperties.memoryHeapCount; heapIndex++)
+			{
+				auto& heap = m_MemoryProperties.memoryHeaps[heapIndex];
+				ImGui::Text("Heap %u%s : %.2f / %.2f MB", heapIndex, (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " (DEVICE_LOCAL)" : "",
+					float(heapUsage[heapIndex]) * toMB, float(heap.size) * toMB);
+			}
+
+			ImGui::Text("Staging : %.2f MB uploaded in %u submits", float(m_TotalUploaded) * toMB, m_UploadSubmits);
+		}
+	}
+}
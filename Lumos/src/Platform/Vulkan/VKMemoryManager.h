@@ -0,0 +1,111 @@
+#pragma once
+#include "VK.h"
+
+#include <mutex>
+
+namespace Lumos
+{
+	namespace Graphics
+	{
+		struct VKAllocation
+		{
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize offset = 0;
+			VkDeviceSize size = 0;
+			u8* mapped = nullptr;
+			u32 poolIndex = 0;
+			u32 blockIndex = 0;
+
+			bool IsValid() const { return memory != VK_NULL_HANDLE; }
+		};
+
+		// One vkAllocateMemory block that hands out ranges with best-fit and
+		// coalesces neighbouring free ranges on release
+		class VKMemoryBlock
+		{
+		public:
+			VKMemoryBlock(VkDeviceMemory memory, VkDeviceSize size, u8* mapped, bool dedicated = false);
+
+			bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset);
+			void Free(VkDeviceSize offset, VkDeviceSize size);
+
+			VkDeviceMemory GetMemory()		const { return m_Memory; }
+			VkDeviceSize GetSize()			const { return m_Size; }
+			VkDeviceSize GetUsed()			const { return m_Used; }
+			VkDeviceSize GetLargestFree()	const { return m_FreeBySize.empty() ? 0 : m_FreeBySize.rbegin()->first; }
+			u32 GetFreeRangeCount()			const { return static_cast<u32>(m_FreeByOffset.size()); }
+			u32 GetAllocationCount()		const { return m_AllocationCount; }
+			u8* GetMapped()					const { return m_Mapped; }
+			bool IsDedicated()				const { return m_Dedicated; }
+
+		private:
+			void InsertFree(VkDeviceSize offset, VkDeviceSize size);
+			void EraseFree(std::map<VkDeviceSize, VkDeviceSize>::iterator it);
+
+			VkDeviceMemory m_Memory;
+			VkDeviceSize m_Size;
+			VkDeviceSize m_Used = 0;
+			u32 m_AllocationCount = 0;
+			u8* m_Mapped;
+			bool m_Dedicated;
+
+			std::map<VkDeviceSize, VkDeviceSize> m_FreeByOffset;
+			std::multimap<VkDeviceSize, VkDeviceSize> m_FreeBySize;
+		};
+
+		class VKMemoryManager
+		{
+		public:
+			VKMemoryManager(VkDevice device, VkPhysicalDevice physicalDevice, u32 queueFamilyIndex, VkQueue queue);
+			~VKMemoryManager();
+
+			VKAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool image = false);
+			void Free(VKAllocation& allocation);
+
+			// Copies data into a device local buffer through the staging ring. Copies are batched
+			// and submitted by FlushUploads, which runs before any other queue submission
+			void UploadToBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+			// Stages data for an immediate copy by the caller (e.g. buffer to image)
+			bool StageData(const void* data, VkDeviceSize size, VkDeviceSize& outOffset);
+			void FlushUploads();
+
+			VkBuffer GetStagingBuffer() const { return m_StagingBuffer; }
+
+			void OnImGui();
+
+		private:
+			struct MemoryPool
+			{
+				u32 memoryType;
+				bool image;
+				std::vector<VKMemoryBlock*> blocks;
+			};
+
+			u32 GetPoolIndex(u32 memoryType, bool image);
+			VkDeviceSize ReserveStaging(VkDeviceSize size);
+			bool FindMemoryType(u32 typeBits, VkMemoryPropertyFlags properties, u32& outType) const;
+
+			void BeginUploads();
+
+			VkDevice m_Device;
+			VkQueue m_Queue;
+			VkPhysicalDeviceMemoryProperties m_MemoryProperties;
+
+			std::vector<MemoryPool> m_Pools;
+			std::recursive_mutex m_Mutex;
+
+			VkBuffer m_StagingBuffer = VK_NULL_HANDLE;
+			VKAllocation m_StagingAllocation;
+			VkDeviceSize m_StagingHead = 0;
+			VkCommandPool m_UploadCommandPool = VK_NULL_HANDLE;
+			VkCommandBuffer m_UploadCommandBuffer = VK_NULL_HANDLE;
+			VkFence m_UploadFence = VK_NULL_HANDLE;
+			u32 m_PendingUploads = 0;
+
+			VkDeviceSize m_BlockSize;
+			VkDeviceSize m_StagingSize;
+			VkDeviceSize m_TotalUploaded = 0;
+			u32 m_UploadSubmits = 0;
+		};
+	}
+}
@@ -5,13 +5,32 @@
 #include "VKRenderpass.h"
 #include "VKShader.h"
 #include "VKTools.h"
+#include "VKInitialisers.h"
 #include "Graphics/API/DescriptorSet.h"
+#include "Utilities/Timer.h"
 
 
 namespace Lumos
 {
 	namespace Graphics
 	{
+		std::unordered_map<String, VKPipeline::SharedObject<VkDescriptorSetLayout>> VKPipeline::s_DescriptorLayoutCache;
+		std::unordered_map<String, VKPipeline::SharedObject<VkPipelineLayout>> VKPipeline::s_PipelineLayoutCache;
+		std::unordered_map<String, VKPipeline::SharedObject<VkPipeline>> VKPipeline::s_PipelineCache;
+
+		u32 VKPipeline::s_PipelinesCreated = 0;
+		u32 VKPipeline::s_PipelinesShared = 0;
+		u32 VKPipeline::s_LayoutsShared = 0;
+		double VKPipeline::s_PipelineCreationTime = 0.0;
+
+		// Cache keys hold the raw bytes of every value the Vulkan object is created from, so a lookup
+		// compares the whole state rather than trusting a hash
+		template<typename... T>
+		static void AppendKey(String& key, const T&... values)
+		{
+			(key.append(reinterpret_cast<const char*>(&values), sizeof(values)), ...);
+		}
+
 		VKPipeline::VKPipeline(const PipelineInfo& pipelineCI)
 		{
 			Init(pipelineCI);
@@ -40,6 +59,8 @@ namespace Lumos
 
 				setLayoutBindings.reserve(descriptorLayout.count);
 
+				String layoutKey;
+
 				for (u32 i = 0; i < descriptorLayout.count; i++)
 				{
 					auto info = descriptorLayout.layoutInfo[i];
@@ -51,6 +72,19 @@ namespace Lumos
 					setLayoutBinding.descriptorCount = info.count;
 
 					setLayoutBindings.push_back(setLayoutBinding);
+
+					AppendKey(layoutKey, info.type, info.stage, info.size, info.count);
+				}
+
+				m_DescriptorLayoutKeys.push_back(layoutKey);
+
+				auto cached = s_DescriptorLayoutCache.find(layoutKey);
+				if (cached != s_DescriptorLayoutCache.end())
+				{
+					cached->second.refCount++;
+					m_DescriptorLayouts.push_back(cached->second.handle);
+					s_LayoutsShared++;
+					continue;
 				}
 
 				// Pipeline layout
@@ -62,17 +96,47 @@ namespace Lumos
 				VkDescriptorSetLayout layout;
 				vkCreateDescriptorSetLayout(VKDevice::Instance()->GetDevice(), &descriptorLayoutCI, VK_NULL_HANDLE, &layout);
 
+				s_DescriptorLayoutCache[layoutKey] = { layout, 1 };
 				m_DescriptorLayouts.push_back(layout);
 			}
 
-			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
-			pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-			pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(m_DescriptorLayouts.size());
-			pipelineLayoutCreateInfo.pSetLayouts = m_DescriptorLayouts.data();
+			for (auto& layoutKey : m_DescriptorLayoutKeys)
+			{
+				AppendKey(m_PipelineLayoutKey, layoutKey.size());
+				m_PipelineLayoutKey += layoutKey;
+			}
 
-			auto result = vkCreatePipelineLayout(VKDevice::Instance()->GetDevice(), &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &m_PipelineLayout);
-			if (result != VK_SUCCESS)
-				return false;
+			std::vector<VkPushConstantRange> pushConstantRanges;
+			u32 pushConstantOffset = 0;
+			for (auto& pushConstant : pipelineCI.pushConstants)
+			{
+				pushConstantRanges.push_back(VKInitialisers::pushConstantRange(VKTools::ShaderTypeToVK(pushConstant.shaderStage), pushConstant.size, pushConstantOffset));
+				pushConstantOffset += pushConstant.size;
+
+				AppendKey(m_PipelineLayoutKey, pushConstant.shaderStage, pushConstant.size);
+			}
+
+			auto cachedLayout = s_PipelineLayoutCache.find(m_PipelineLayoutKey);
+			if (cachedLayout != s_PipelineLayoutCache.end())
+			{
+				cachedLayout->second.refCount++;
+				m_PipelineLayout = cachedLayout->second.handle;
+			}
+			else
+			{
+				VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+				pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+				pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(m_DescriptorLayouts.size());
+				pipelineLayoutCreateInfo.pSetLayouts = m_DescriptorLayouts.data();
+				pipelineLayoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+				pipelineLayoutCreateInfo.pPushConstantRanges = pushConstantRanges.data();
+
+				auto result = vkCreatePipelineLayout(VKDevice::Instance()->GetDevice(), &pipelineLayoutCreateInfo, VK_NULL_HANDLE, &m_PipelineLayout);
+				if (result != VK_SUCCESS)
+					return false;
+
+				s_PipelineLayoutCache[m_PipelineLayoutKey] = { m_PipelineLayout, 1 };
+			}
 
 			std::vector<VkDescriptorPoolSize> poolSizes;
 			poolSizes.reserve(pipelineCI.numLayoutBindings);
@@ -102,6 +166,36 @@ namespace Lumos
 
 			m_DescriptorSet = lmnew VKDescriptorSet(info);
 
+			auto renderpass = static_cast<VKRenderpass*>(pipelineCI.renderpass)->GetRenderpass();
+
+			// Shaders are keyed by their code, so separate shader objects loading the same SPIR-V share pipelines
+			const String& stageCode = static_cast<VKShader*>(pipelineCI.shader)->GetStageCode();
+			const bool dynamicLineWidth = pipelineCI.lineWidth > 0.0f;
+
+			m_PipelineKey = m_PipelineLayoutKey;
+			AppendKey(m_PipelineKey, stageCode.size());
+			m_PipelineKey += stageCode;
+			AppendKey(m_PipelineKey, renderpass, pipelineCI.strideSize, pipelineCI.drawType, pipelineCI.polygonMode, pipelineCI.cullMode);
+			AppendKey(m_PipelineKey, pipelineCI.numColorAttachments, pipelineCI.transparencyEnabled, pipelineCI.depthBiasEnabled, dynamicLineWidth);
+
+			for (u32 i = 0; i < pipelineCI.numVertexLayout; i++)
+			{
+				auto& vertexLayout = pipelineCI.vertexLayout[i];
+				AppendKey(m_PipelineKey, vertexLayout.binding, vertexLayout.location, vertexLayout.format, vertexLayout.offset);
+			}
+
+			if (pipelineCI.lineWidth > 0.0f)
+				m_LineWidth = pipelineCI.lineWidth;
+
+			auto cachedPipeline = s_PipelineCache.find(m_PipelineKey);
+			if (cachedPipeline != s_PipelineCache.end())
+			{
+				cachedPipeline->second.refCount++;
+				m_Pipeline = cachedPipeline->second.handle;
+				s_PipelinesShared++;
+				return true;
+			}
+
 			// Pipeline
 			VkDynamicState dynamicStateEnables[VK_DYNAMIC_STATE_RANGE_SIZE];
 			VkPipelineDynamicStateCreateInfo dynamicStateCI{};
@@ -234,7 +328,6 @@ namespace Lumos
             if(pipelineCI.lineWidth > 0.0f)
             {
                 dynamicStateEnables[dynamicStateCI.dynamicStateCount++] = VK_DYNAMIC_STATE_LINE_WIDTH;
-                m_LineWidth = pipelineCI.lineWidth;
             }
 
 			if (pipelineCI.depthBiasEnabled)
@@ -286,10 +379,15 @@ namespace Lumos
 			graphicsPipelineCI.pDepthStencilState = &ds;
 			graphicsPipelineCI.pStages = static_cast<VKShader*>(pipelineCI.shader)->GetShaderStages();
 			graphicsPipelineCI.stageCount = static_cast<VKShader*>(pipelineCI.shader)->GetStageCount();
-			graphicsPipelineCI.renderPass = static_cast<VKRenderpass*>(pipelineCI.renderpass)->GetRenderpass();
+			graphicsPipelineCI.renderPass = renderpass;
 			graphicsPipelineCI.subpass = 0;
 
+			Timer timer;
 			VK_CHECK_RESULT(vkCreateGraphicsPipelines(VKDevice::Instance()->GetDevice(), VKDevice::Instance()->GetPipelineCache(), 1, &graphicsPipelineCI, VK_NULL_HANDLE, &m_Pipeline));
+			s_PipelineCreationTime += timer.GetMS(1000.0);
+			s_PipelinesCreated++;
+
+			s_PipelineCache[m_PipelineKey] = { m_Pipeline, 1 };
 
 			return true;
 		}
@@ -297,12 +395,30 @@ namespace Lumos
 		void VKPipeline::Unload() const
 		{
 			vkDestroyDescriptorPool(VKDevice::Instance()->GetDevice(), m_DescriptorPool, VK_NULL_HANDLE);
-			vkDestroyPipelineLayout(VKDevice::Instance()->GetDevice(), m_PipelineLayout, VK_NULL_HANDLE);
 
-			for (auto& descriptorLayout : m_DescriptorLayouts)
-				vkDestroyDescriptorSetLayout(VKDevice::Instance()->GetDevice(), descriptorLayout, VK_NULL_HANDLE);
+			auto pipelineLayout = s_PipelineLayoutCache.find(m_PipelineLayoutKey);
+			if (pipelineLayout != s_PipelineLayoutCache.end() && --pipelineLayout->second.refCount == 0)
+			{
+				vkDestroyPipelineLayout(VKDevice::Instance()->GetDevice(), pipelineLayout->second.handle, VK_NULL_HANDLE);
+				s_PipelineLayoutCache.erase(pipelineLayout);
+			}
 
-			vkDestroyPipeline(VKDevice::Instance()->GetDevice(), m_Pipeline, VK_NULL_HANDLE);
+			for (auto& layoutKey : m_DescriptorLayoutKeys)
+			{
+				auto descriptorLayout = s_DescriptorLayoutCache.find(layoutKey);
+				if (descriptorLayout != s_DescriptorLayoutCache.end() && --descriptorLayout->second.refCount == 0)
+				{
+					vkDestroyDescriptorSetLayout(VKDevice::Instance()->GetDevice(), descriptorLayout->second.handle, VK_NULL_HANDLE);
+					s_DescriptorLayoutCache.erase(descriptorLayout);
+				}
+			}
+
+			auto pipeline = s_PipelineCache.find(m_PipelineKey);
+			if (pipeline != s_PipelineCache.end() && --pipeline->second.refCount == 0)
+			{
+				vkDestroyPipeline(VKDevice::Instance()->GetDevice(), pipeline->second.handle, VK_NULL_HANDLE);
+				s_PipelineCache.erase(pipeline);
+			}
 		}
 
 		void VKPipeline::SetActive(CommandBuffer* cmdBuffer)
@@ -323,6 +439,12 @@ namespace Lumos
 			return set;
 		}
         
+		void VKPipeline::LogStats(const char* stage)
+		{
+			Debug::Log::Info("[VULKAN] Pipeline cache ({0}, {1}) : {2} pipelines compiled in {3} ms, {4} pipelines and {5} descriptor layouts shared",
+				VKDevice::Instance()->GetPipelineCacheWarm() ? "warm" : "cold", stage, s_PipelinesCreated, s_PipelineCreationTime, s_PipelinesShared, s_LayoutsShared);
+		}
+
         void VKPipeline::MakeDefault()
         {
             CreateFunc = CreateFuncVulkan;
@@ -35,11 +35,34 @@ namespace Lumos
 			Shader* GetShader()	const override { return m_Shader; }
 
             static void MakeDefault();
+			// stage names the point of the run the totals cover, "startup" or "shutdown"
+			static void LogStats(const char* stage);
+
         protected:
             static Pipeline* CreateFuncVulkan(const PipelineInfo& pipelineCI);
             
 		private:
-		
+			template<typename T>
+			struct SharedObject
+			{
+				T handle;
+				u32 refCount;
+			};
+
+			// Identical layouts and pipelines requested by different renderers share one Vulkan object
+			static std::unordered_map<String, SharedObject<VkDescriptorSetLayout>> s_DescriptorLayoutCache;
+			static std::unordered_map<String, SharedObject<VkPipelineLayout>> s_PipelineLayoutCache;
+			static std::unordered_map<String, SharedObject<VkPipeline>> s_PipelineCache;
+
+			static u32 s_PipelinesCreated;
+			static u32 s_PipelinesShared;
+			static u32 s_LayoutsShared;
+			static double s_PipelineCreationTime;
+
+			std::vector<String> m_DescriptorLayoutKeys;
+			String m_PipelineLayoutKey;
+			String m_PipelineKey;
+
 			VkVertexInputBindingDescription m_VertexBindingDescription;
 			VkPipelineLayout m_PipelineLayout;
 			VkDescriptorPool m_DescriptorPool;
@@ -3,6 +3,7 @@
 #include "VKDevice.h"
 #include "VKShader.h"
 #include "VKDescriptorSet.h"
+#include "VKPipeline.h"
 
 namespace Lumos
 {
@@ -66,6 +67,13 @@ namespace Lumos
 		void VKRenderer::PresentInternal()
         {
 			m_Swapchain->Present(m_ImageAvailableSemaphore[m_CurrentSemaphoreIndex]);
+
+			// Every renderer has built its pipelines by the end of the first frame
+			if (!m_StartupStatsLogged)
+			{
+				VKPipeline::LogStats("startup");
+				m_StartupStatsLogged = true;
+			}
         }
 
 		void VKRenderer::OnResize(u32 width, u32 height)
@@ -93,6 +101,8 @@ namespace Lumos
 
 		void VKRenderer::Begin()
 		{
+			VKDevice::Instance()->OnNewFrame();
+
 			m_CurrentSemaphoreIndex = 0;
 			auto result = m_Swapchain->AcquireNextImage(m_ImageAvailableSemaphore[m_CurrentSemaphoreIndex]);
 
@@ -129,6 +139,7 @@ namespace Lumos
 				for (auto& pc : vkDesSet->GetPushConstants())
 				{
 					vkCmdPushConstants(static_cast<Graphics::VKCommandBuffer*>(cmdBuffer)->GetCommandBuffer(), static_cast<Graphics::VKPipeline*>(pipeline)->GetPipelineLayout(), VKTools::ShaderTypeToVK(pc.shaderStage), index, pc.size, pc.data);
+					index += pc.size;
 				}
 
 				numDesciptorSets++;
@@ -58,6 +58,7 @@ namespace Lumos
 
 			VkSemaphore m_ImageAvailableSemaphore[NUM_SEMAPHORES];
 			u32 m_CurrentSemaphoreIndex = 0;
+			bool m_StartupStatsLogged = false;
 
 			String m_RendererTitle;
 			u32 m_Width, m_Height;
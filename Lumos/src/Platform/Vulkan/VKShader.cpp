@@ -63,6 +63,10 @@ namespace Lumos
 
 				VK_CHECK_RESULT(vkCreateShaderModule(VKDevice::Instance()->GetDevice(), &vertexShaderCI, nullptr, &m_ShaderStages[currentShaderStage].module));
 
+				m_StageCode.append(reinterpret_cast<const char*>(&m_ShaderStages[currentShaderStage].stage), sizeof(VkShaderStageFlagBits));
+				m_StageCode.append(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+				m_StageCode.append(reinterpret_cast<const char*>(source), fileSize);
+
                 delete[] source;
 
 				currentShaderStage++;
@@ -19,6 +19,9 @@ namespace Lumos
 			VkPipelineShaderStageCreateInfo* GetShaderStages() const;
 			uint32_t GetStageCount() const;
 
+			// Stage types and SPIR-V of every stage, equal for shaders loaded from the same code
+			const String& GetStageCode() const { return m_StageCode; }
+
 			void Bind() const override {};
 			void Unbind() const override {};
 
@@ -48,6 +51,7 @@ namespace Lumos
 			String 								m_Name;
 			String								m_FilePath;
 			String 								m_Source;
+			String								m_StageCode;
 			std::vector<ShaderType> 			m_ShaderTypes;
 		};
 	}
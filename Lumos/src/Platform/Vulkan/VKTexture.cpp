@@ -4,6 +4,7 @@
 #include "Utilities/LoadImage.h"
 #include "VKTools.h"
 #include "VKBuffer.h"
+#include "Graphics/CookedTexture.h"
 
 namespace Lumos
 {
@@ -126,6 +127,74 @@ namespace Lumos
 #endif
 		}
 
+		// Creates an image holding every face and mip of a cooked texture, left ready to sample.
+		// Decompresses on the CPU first when the device has no BC support.
+#ifdef USE_VMA_ALLOCATOR
+		static VkFormat CreateCookedImage(CookedTexture& cooked, VkImage& image, VkDeviceMemory& imageMemory, VmaAllocation& allocation)
+#else
+		static VkFormat CreateCookedImage(CookedTexture& cooked, VkImage& image, VkDeviceMemory& imageMemory)
+#endif
+		{
+			if (CookedTexture::IsCompressedFormat(cooked.GetFormat()) && !VKDevice::Instance()->SupportsTextureCompressionBC())
+				cooked.Decompress();
+
+			// Sampled as UNORM like the other colour textures, the shaders apply the gamma
+			const VkFormat format = VKTools::TextureFormatToVK(cooked.GetFormat(), false);
+			const u32 faceCount = cooked.GetFaceCount();
+			const u32 mipCount = cooked.GetMipCount();
+			const VkImageCreateFlags flags = faceCount == 6 ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+
+#ifdef USE_VMA_ALLOCATOR
+			Graphics::CreateImage(cooked.GetWidth(), cooked.GetHeight(), mipCount, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image,
+				imageMemory, faceCount, flags, allocation);
+#else
+			Graphics::CreateImage(cooked.GetWidth(), cooked.GetHeight(), mipCount, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory, faceCount, flags);
+#endif
+
+			VKBuffer* stagingBuffer = lmnew VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, cooked.GetPayloadSize(), cooked.GetPayload());
+
+			std::vector<VkBufferImageCopy> bufferCopyRegions;
+			for (u32 face = 0; face < faceCount; face++)
+			{
+				for (u32 mip = 0; mip < mipCount; mip++)
+				{
+					const CookedTexture::Level& level = cooked.GetLevel(face, mip);
+
+					VkBufferImageCopy bufferCopyRegion = {};
+					bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+					bufferCopyRegion.imageSubresource.mipLevel = mip;
+					bufferCopyRegion.imageSubresource.baseArrayLayer = face;
+					bufferCopyRegion.imageSubresource.layerCount = 1;
+					bufferCopyRegion.imageExtent.width = level.width;
+					bufferCopyRegion.imageExtent.height = level.height;
+					bufferCopyRegion.imageExtent.depth = 1;
+					bufferCopyRegion.bufferOffset = level.offset;
+
+					bufferCopyRegions.push_back(bufferCopyRegion);
+				}
+			}
+
+			VkImageSubresourceRange subresourceRange = {};
+			subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			subresourceRange.baseMipLevel = 0;
+			subresourceRange.levelCount = mipCount;
+			subresourceRange.layerCount = faceCount;
+
+			VkCommandBuffer cmdBuffer = VKTools::BeginSingleTimeCommands();
+
+			VKTools::SetImageLayout(cmdBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
+			vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer->GetBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(bufferCopyRegions.size()), bufferCopyRegions.data());
+			VKTools::SetImageLayout(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange);
+
+			VKTools::EndSingleTimeCommands(cmdBuffer);
+
+			delete stagingBuffer;
+
+			return format;
+		}
+
 		VKTexture2D::VKTexture2D(u32 width, u32 height, void* data, TextureParameters parameters, TextureLoadOptions loadOptions)
 			: m_FileName("NULL"), m_TextureImage(VK_NULL_HANDLE), m_TextureImageView(VK_NULL_HANDLE), m_TextureSampler(VK_NULL_HANDLE)
 		{
@@ -136,7 +205,7 @@ namespace Lumos
 			m_Data = static_cast<u8*>(data);
 			Load();
 
-			m_TextureImageView = Graphics::CreateImageView(m_TextureImage, VK_FORMAT_R8G8B8A8_UNORM, m_MipLevels, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+			m_TextureImageView = Graphics::CreateImageView(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format, false), m_MipLevels, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 1);
 			m_TextureSampler = Graphics::CreateTextureSampler(VKTools::TextureFilterToVK(m_Parameters.magFilter), VKTools::TextureFilterToVK(m_Parameters.minFilter), 0.0f, static_cast<float>(m_MipLevels), true, VKDevice::Instance()->GetGPUProperties().limits.maxSamplerAnisotropy, VKTools::TextureWrapToVK(m_Parameters.wrap), VKTools::TextureWrapToVK(m_Parameters.wrap), VKTools::TextureWrapToVK(m_Parameters.wrap));
 
 			UpdateDescriptor();
@@ -153,7 +222,7 @@ namespace Lumos
 			if (!m_DeleteImage)
 				return;
 
-			m_TextureImageView = Graphics::CreateImageView(m_TextureImage, VK_FORMAT_R8G8B8A8_UNORM, m_MipLevels, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+			m_TextureImageView = Graphics::CreateImageView(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format, false), m_MipLevels, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 1);
 			m_TextureSampler = Graphics::CreateTextureSampler(VKTools::TextureFilterToVK(m_Parameters.magFilter), VKTools::TextureFilterToVK(m_Parameters.minFilter), 0.0f, static_cast<float>(m_MipLevels), true, VKDevice::Instance()->GetGPUProperties().limits.maxSamplerAnisotropy, VKTools::TextureWrapToVK(m_Parameters.wrap), VKTools::TextureWrapToVK(m_Parameters.wrap), VKTools::TextureWrapToVK(m_Parameters.wrap));
 
 			UpdateDescriptor();
@@ -346,6 +415,25 @@ namespace Lumos
 
 		bool VKTexture2D::Load()
 		{
+			String cookedPath;
+			if (m_Data == nullptr && CookedTexture::FindCooked(m_FileName, cookedPath))
+			{
+				CookedTexture cooked;
+				if (cooked.Load(cookedPath) && cooked.GetFaceCount() == 1)
+				{
+#ifdef USE_VMA_ALLOCATOR
+					CreateCookedImage(cooked, m_TextureImage, m_TextureImageMemory, m_Allocation);
+#else
+					CreateCookedImage(cooked, m_TextureImage, m_TextureImageMemory);
+#endif
+					m_Width = cooked.GetWidth();
+					m_Height = cooked.GetHeight();
+					m_MipLevels = cooked.GetMipCount();
+					m_Parameters.format = cooked.GetFormat();
+					return true;
+				}
+			}
+
 			u32 texWidth, texHeight, bits;
 			u8* pixels;
 
@@ -373,7 +461,21 @@ namespace Lumos
 
 			m_MipLevels = static_cast<uint32_t>(std::floor(std::log2(Maths::Max(texWidth, texHeight)))) + 1;
 
-			VKBuffer* stagingBuffer = lmnew VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, static_cast<u32>(imageSize), pixels);
+			VKBuffer* stagingBuffer = nullptr;
+			VkBuffer stagingHandle = VK_NULL_HANDLE;
+			VkDeviceSize stagingOffset = 0;
+
+#ifndef USE_VMA_ALLOCATOR
+			// Use the shared staging ring when the image fits, avoiding a buffer and allocation per texture
+			auto memoryManager = VKDevice::Instance()->GetMemoryManager();
+			if (memoryManager->StageData(pixels, imageSize, stagingOffset))
+				stagingHandle = memoryManager->GetStagingBuffer();
+#endif
+			if (!stagingHandle)
+			{
+				stagingBuffer = lmnew VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, static_cast<u32>(imageSize), pixels);
+				stagingHandle = stagingBuffer->GetBuffer();
+			}
 
 			if (m_Data == nullptr)
 				delete[] pixels;
@@ -387,7 +489,7 @@ namespace Lumos
 #endif
 
 			VKTools::TransitionImageLayout(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_MipLevels);
-			VKTools::CopyBufferToImage(stagingBuffer->GetBuffer(), m_TextureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+			VKTools::CopyBufferToImage(stagingHandle, m_TextureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), stagingOffset);
 			VKTools::TransitionImageLayout(m_TextureImage, VKTools::TextureFormatToVK(m_Parameters.format), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_MipLevels);
 
 			delete stagingBuffer;
@@ -397,6 +499,23 @@ namespace Lumos
 			return true;
 		}
 
+		void VKTexture2D::SetData(const void* pixels)
+		{
+			// Replaces the whole image, so the previous contents can be discarded
+			VkDeviceSize imageSize = VkDeviceSize(m_Width * m_Height * 4);
+			VKBuffer* stagingBuffer = lmnew VKBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, static_cast<u32>(imageSize), pixels);
+
+			VkFormat format = VKTools::TextureFormatToVK(m_Parameters.format);
+
+			VKTools::TransitionImageLayout(m_TextureImage, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_MipLevels);
+			VKTools::CopyBufferToImage(stagingBuffer->GetBuffer(), m_TextureImage, m_Width, m_Height);
+			VKTools::TransitionImageLayout(m_TextureImage, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_MipLevels);
+
+			delete stagingBuffer;
+
+			GenerateMipmaps(m_TextureImage, format, m_Width, m_Height, m_MipLevels);
+		}
+
 		VKTextureCube::VKTextureCube(u32 size): m_ImageLayout()
 		{
 		}
@@ -430,6 +549,33 @@ namespace Lumos
 			m_ImageLayout()
 		{
 			m_Files[0] = filepath;
+
+			// Only cooked cubes can be loaded from a single file
+			String cookedPath;
+			CookedTexture cooked;
+			if (!CookedTexture::FindCooked(filepath, cookedPath) || !cooked.Load(cookedPath) || cooked.GetFaceCount() != 6)
+			{
+				LUMOS_LOG_ERROR("Failed to load cube map {0}", filepath);
+				m_DeleteImage = false;
+				return;
+			}
+
+#ifdef USE_VMA_ALLOCATOR
+			const VkFormat format = CreateCookedImage(cooked, m_TextureImage, m_TextureImageMemory, m_Allocation);
+#else
+			const VkFormat format = CreateCookedImage(cooked, m_TextureImage, m_TextureImageMemory);
+#endif
+			m_Width = cooked.GetWidth();
+			m_Height = cooked.GetHeight();
+			m_Size = m_Width;
+			m_NumMips = cooked.GetMipCount();
+			m_Parameters.format = cooked.GetFormat();
+			m_ImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			m_TextureSampler = Graphics::CreateTextureSampler(VK_FILTER_LINEAR, VK_FILTER_LINEAR, 0.0f, static_cast<float>(m_NumMips), true, VKDevice::Instance()->GetGPUProperties().limits.maxSamplerAnisotropy, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT);
+			m_TextureImageView = Graphics::CreateImageView(m_TextureImage, format, m_NumMips, VK_IMAGE_VIEW_TYPE_CUBE, VK_IMAGE_ASPECT_COLOR_BIT, 6);
+
+			UpdateDescriptor();
 		}
 
 		VKTextureCube::~VKTextureCube()
@@ -679,7 +825,7 @@ namespace Lumos
 		{
 			m_Descriptor.sampler = m_TextureSampler;
 			m_Descriptor.imageView = m_TextureImageView;
-			m_Descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			m_Descriptor.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 		}
 
 		void VKTextureDepth::Resize(u32 width, u32 height)
@@ -24,7 +24,7 @@ namespace Lumos
 			void Bind(u32 slot = 0) const override {};
 			void Unbind(u32 slot = 0) const override {};
 
-			virtual void SetData(const void* pixels) override {};
+			virtual void SetData(const void* pixels) override;
 
 			virtual void* GetHandle() const override { return (void*)&m_Descriptor; }
 
@@ -108,12 +108,12 @@ namespace Lumos
 				VKDevice::Instance()->GetVKContext()->GetCommandPool()->GetCommandPool(), 1, &commandBuffer);
         }
 
-        void VKTools::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+        void VKTools::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset)
         {
             VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
 
             VkBufferImageCopy region;
-            region.bufferOffset = 0;
+            region.bufferOffset = bufferOffset;
             region.bufferRowLength = 0;
             region.bufferImageHeight = 0;
             region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -519,6 +519,10 @@ namespace Lumos
                 case TextureFormat::RGBA16:             return VK_FORMAT_R16G16B16A16_SFLOAT;
 				case TextureFormat::RGB32:              return VK_FORMAT_R32G32B32_SFLOAT;
 				case TextureFormat::RGBA32:             return VK_FORMAT_R32G32B32A32_SFLOAT;
+				case TextureFormat::BC1:                return srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+				case TextureFormat::BC3:                return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+				case TextureFormat::BC5:                return VK_FORMAT_BC5_UNORM_BLOCK;
+				case TextureFormat::BC7:                return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
                 default: LUMOS_LOG_CRITICAL("[Texture] Unsupported image bit-depth!");  return VK_FORMAT_R8G8B8A8_UNORM;
             }
         }
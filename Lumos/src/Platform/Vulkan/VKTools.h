@@ -32,7 +32,7 @@ namespace Lumos
 			VkCommandBuffer BeginSingleTimeCommands();
 			void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
 
-			void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+			void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0);
 			void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
 			bool HasStencilComponent(VkFormat format);
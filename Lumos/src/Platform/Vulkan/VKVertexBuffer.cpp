@@ -26,7 +26,7 @@ namespace Lumos
 		{
 			m_Size = size;
 
-			VKBuffer::Init(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size, nullptr);
+			VKBuffer::Init(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size, nullptr, m_Usage == BufferUsage::STATIC);
 		}
 
 		void VKVertexBuffer::SetLayout(const Graphics::BufferLayout& bufferLayout)
@@ -36,13 +36,13 @@ namespace Lumos
 
 		void VKVertexBuffer::SetData(u32 size, const void* data)
 		{
-			VKBuffer::Init(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size, data);
+			VKBuffer::Init(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size, data, m_Usage == BufferUsage::STATIC);
 		}
 
 
 		void VKVertexBuffer::SetDataSub(u32 size, const void* data, u32 offset)
 		{
-			VKBuffer::Init(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size, data);
+			VKBuffer::Init(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, size, data, m_Usage == BufferUsage::STATIC);
 		}
 
 		void* VKVertexBuffer::GetPointerInternal()
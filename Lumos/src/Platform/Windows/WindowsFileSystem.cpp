@@ -54,6 +54,18 @@ namespace Lumos
 		return result;
 	}
 
+	i64 FileSystem::GetModifiedTime(const String& path)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &data))
+			return 0;
+
+		ULARGE_INTEGER time;
+		time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+		time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+		return static_cast<i64>(time.QuadPart);
+	}
+
 	bool FileSystem::ReadFile(const String& path, void* buffer, i64 size)
 	{
 		const HANDLE file = OpenFileForReading(path);
@@ -95,13 +107,12 @@ namespace Lumos
 		return success ? result : String();
 	}
 
-	bool FileSystem::WriteFile(const String& path, u8* buffer)
+	bool FileSystem::WriteFile(const String& path, u8* buffer, u32 size)
 	{
-		const HANDLE file = CreateFile(path.c_str(), GENERIC_WRITE, NULL, nullptr, CREATE_NEW | OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		const HANDLE file = CreateFile(path.c_str(), GENERIC_WRITE, NULL, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
 		if (file == INVALID_HANDLE_VALUE)
 			return false;
 
-		const i64 size = GetFileSizeInternal(file);
 		DWORD written;
 		const bool result = ::WriteFile(file, buffer, static_cast<DWORD>(size), &written, nullptr) != 0;
 		CloseHandle(file);
@@ -110,7 +121,7 @@ namespace Lumos
 
 	bool FileSystem::WriteTextFile(const String& path, const String& text)
 	{
-		return WriteFile(path, (u8*)&text[0]);
+		return WriteFile(path, (u8*)&text[0], static_cast<u32>(text.size()));
 	}
 }
 
@@ -124,6 +124,14 @@ namespace Lumos
         return buffer.st_size;
     }
 
+    i64 FileSystem::GetModifiedTime(const String& path)
+    {
+        struct stat buffer;
+        if (stat(path.c_str(), &buffer) != 0)
+            return 0;
+        return i64(buffer.st_mtimespec.tv_sec) * 1000000000 + buffer.st_mtimespec.tv_nsec;
+    }
+
     bool FileSystem::ReadFile(const String& path, void* buffer, i64 size)
     {
         if(!FileExists(path))
@@ -172,12 +180,14 @@ namespace Lumos
         return success ? result : String();
     }
 
-    bool FileSystem::WriteFile(const String& path, u8* buffer)
+    bool FileSystem::WriteFile(const String& path, u8* buffer, u32 size)
     {
         FILE* file = fopen(path.c_str(), "wb");
-        size_t size = fwrite(buffer, 1, sizeof(buffer), file);
+        if(!file)
+            return false;
+        size_t written = fwrite(buffer, 1, size, file);
         fclose(file);
-        return size > 0;
+        return written == size;
     }
 
     bool FileSystem::WriteTextFile(const String& path, const String& text)
@@ -5,10 +5,13 @@
 #include "Core/VFS.h"
 #include "App/Scene.h"
 #include "App/Application.h"
+#include "App/SceneManager.h"
 #include "App/Engine.h"
 #include "Core/OS/Input.h"
 #include "ScriptComponent.h"
 #include "App/SceneGraph.h"
+#include "App/EntityIndex.h"
+#include "App/SceneRaycast.h"
 #include "Graphics/Camera/ThirdPersonCamera.h"
 
 #include "ECS/Component/Components.h"
@@ -20,6 +23,8 @@
 #include "Graphics/API/Texture.h"
 #include "Graphics/ModelLoader/ModelLoader.h"
 #include "Utilities/RandomNumberGenerator.h"
+#include "Utilities/Timer.h"
+#include "Core/Profiler.h"
 
 #include "ImGuiLua.h"
 #include "PhysicsLua.h"
@@ -85,7 +90,13 @@ namespace Lumos
 
 	void LuaManager::OnInit()
 	{
-        m_State.open_libraries(sol::lib::base, sol::lib::package, sol::lib::math, sol::lib::table);
+        m_State.open_libraries(sol::lib::base, sol::lib::package, sol::lib::math, sol::lib::table, sol::lib::coroutine, sol::lib::string);
+
+        // Only valid inside a script's Run coroutine, the scheduler skips the script until the wait expires
+        m_State.script(R"(
+            function wait(seconds) coroutine.yield(seconds or 0, 0) end
+            function wait_frames(frames) coroutine.yield(0, frames or 1) end
+        )");
 
         BindInputLua(m_State);
 		BindMathsLua(m_State);
@@ -100,21 +111,160 @@ namespace Lumos
 	{
 	}
 
+    static const float s_TierIntervals[] = { 0.0f, 100.0f, 1000.0f };
+
     void LuaManager::OnUpdate(Scene* scene)
     {
+        LUMOS_PROFILE_FUNC;
         auto& registry = scene->GetRegistry();
                                          
         auto view = registry.view<ScriptComponent>();
+
+        m_FrameScriptTime = 0.0f;
+        m_UpdatedScripts = 0;
+        m_ResumedScripts = 0;
+        m_LuaCalls = 0;
     
         if (view.empty())
             return;
 
-        float dt = Engine::Instance()->GetTimeStep().GetElapsedMillis();
-        
+        // Component OnUpdate(dt) receives the frame delta (or the time since its tier last ran) in ms.
+        // It used to be handed GetElapsedMillis, the time since startup, which the tiers can't accumulate.
+        const float dt = Engine::Instance()->GetTimeStep().GetMillis();
+
+        // Each tier passes the time accumulated since it last ran
+        bool tierDue[static_cast<u32>(ScriptUpdateRate::Count)];
+        float tierDt[static_cast<u32>(ScriptUpdateRate::Count)];
+        for (u32 i = 0; i < static_cast<u32>(ScriptUpdateRate::Count); i++)
+        {
+            m_TierTime[i] += dt;
+            tierDue[i] = m_TierTime[i] >= s_TierIntervals[i];
+            tierDt[i] = m_TierTime[i];
+            if (tierDue[i])
+                m_TierTime[i] = 0.0f;
+        }
+
+        for (auto& [name, group] : m_Groups)
+            group.scripts.clear();
+
         for (auto entity : view)
         {
-            auto& luaScript = registry.get<ScriptComponent>(entity);
-            luaScript.Update(dt);
+            auto& luaScript = view.get<ScriptComponent>(entity);
+
+            if (luaScript.HasCoroutine())
+            {
+                Timer timer;
+                if (luaScript.UpdateCoroutine(dt * 0.001f))
+                {
+                    luaScript.RecordTime(timer.GetMS(1000.0f), m_ScriptBudget);
+                    m_FrameScriptTime += luaScript.GetLastTime();
+                    m_ResumedScripts++;
+                    m_LuaCalls++;
+                }
+            }
+
+            const u32 tier = static_cast<u32>(luaScript.GetUpdateRate());
+            if (!tierDue[tier])
+                continue;
+
+            if (luaScript.GetUpdateGroupFunction().valid())
+            {
+                auto& group = m_Groups[luaScript.GetFilePath() + "#" + std::to_string(tier)];
+                if (group.scripts.empty())
+                    group.function = luaScript.GetUpdateGroupFunction();
+                group.scripts.push_back(&luaScript);
+                continue;
+            }
+
+            if (!luaScript.HasUpdate())
+                continue;
+
+            Timer timer;
+            luaScript.Update(tierDt[tier]);
+            luaScript.RecordTime(timer.GetMS(1000.0f), m_ScriptBudget);
+            m_FrameScriptTime += luaScript.GetLastTime();
+            m_UpdatedScripts++;
+            m_LuaCalls++;
+        }
+
+        for (auto it = m_Groups.begin(); it != m_Groups.end();)
+        {
+            auto& group = it->second;
+            if (group.scripts.empty())
+            {
+                // Keep the table while the tier is just waiting for its next update
+                if (tierDue[static_cast<u32>(ScriptUpdateRate::OneHz)])
+                    it = m_Groups.erase(it);
+                else
+                    ++it;
+                continue;
+            }
+
+            if (!group.environments.valid())
+                group.environments = m_State.create_table(static_cast<int>(group.scripts.size()), 0);
+
+            // Reuse the table, only clearing entries left over from a larger group
+            const u32 count = static_cast<u32>(group.scripts.size());
+            for (u32 i = 0; i < count; i++)
+                group.environments[i + 1] = group.scripts[i]->GetSolEnvironment();
+            for (u32 i = count; i < group.tableSize; i++)
+                group.environments[i + 1] = sol::lua_nil;
+            group.tableSize = count;
+
+            const u32 tier = static_cast<u32>(group.scripts[0]->GetUpdateRate());
+
+            Timer timer;
+            sol::protected_function_result result = group.function.call(group.environments, tierDt[tier]);
+            const float time = timer.GetMS(1000.0f);
+
+            if (!result.valid())
+            {
+                sol::error err = result;
+                Debug::Log::Error("Failed to Execute Script Lua OnUpdateGroup" );
+                Debug::Log::Error("Error : {0}", err.what());
+            }
+
+            // Split the call's cost evenly so grouped scripts are budgeted like the rest
+            for (auto script : group.scripts)
+                script->RecordTime(time / float(count), m_ScriptBudget);
+
+            m_FrameScriptTime += time;
+            m_UpdatedScripts += count;
+            m_LuaCalls++;
+            ++it;
+        }
+    }
+
+    void LuaManager::OnImGui()
+    {
+        ImGui::Text("Lua Calls : %u (%u updated, %u resumed)", m_LuaCalls, m_UpdatedScripts, m_ResumedScripts);
+        ImGui::Text("Script Time : %.3f ms (scene %.3f ms)", m_FrameScriptTime, m_SceneScriptTime);
+
+        if (m_FrameScriptTime + m_SceneScriptTime > m_FrameBudget)
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Over frame budget");
+
+        ImGui::DragFloat("Script Budget (ms)", &m_ScriptBudget, 0.01f, 0.0f, 16.0f);
+        ImGui::DragFloat("Frame Budget (ms)", &m_FrameBudget, 0.1f, 0.0f, 33.0f);
+
+        auto scene = Application::Instance()->GetSceneManager()->GetCurrentScene();
+        if (!scene)
+            return;
+
+        auto& registry = scene->GetRegistry();
+        auto view = registry.view<ScriptComponent>();
+
+        if (ImGui::TreeNode("Over Budget"))
+        {
+            for (auto entity : view)
+            {
+                auto& script = view.get<ScriptComponent>(entity);
+                if (!script.GetOverBudget())
+                    continue;
+
+                auto name = registry.try_get<NameComponent>(entity);
+                ImGui::Text("%s (%s) : %.3f ms avg, %.3f ms peak", name ? name->name.c_str() : "Entity", script.GetFilePath().c_str(), script.GetAverageTime(), script.GetPeakTime());
+            }
+            ImGui::TreePop();
         }
     }
 
@@ -133,6 +283,7 @@ namespace Lumos
 		windowProperties.RenderAPI = m_State.get<int>("renderAPI");
 		windowProperties.Fullscreen = m_State.get<bool>("fullscreen");
 		windowProperties.Borderless = m_State.get<bool>("borderless");
+		windowProperties.AudioBackend = m_State["audioBackend"].get_or(0);
     
         windowProperties.FilePath = file;
 
@@ -141,16 +292,86 @@ namespace Lumos
 
     entt::entity GetEntityByName( entt::registry& registry, const std::string& name )
     {
-        entt::entity e = entt::null;
-        registry.view<NameComponent>().each([&]( const entt::entity& entity, const NameComponent& component )
+        auto index = EntityIndex::Get(registry);
+        if (index)
+            return index->FindByName(name);
+
+        // Registry without an index yet, e.g. while a scene script is loading
+        auto view = registry.view<NameComponent>();
+        for (size_t i = 0; i < view.size(); i++)
+        {
+            if (view.raw()[i].name == name)
+                return view.data()[i];
+        }
+
+        return entt::null;
+    }
+
+    static sol::as_table_t<std::vector<entt::entity>> GetEntitiesByName( entt::registry& registry, const std::string& name )
+    {
+        auto index = EntityIndex::Get(registry);
+        return sol::as_table(index ? index->FindAllByName(name) : std::vector<entt::entity>());
+    }
+
+    static sol::as_table_t<std::vector<entt::entity>> GetEntitiesByNamePrefix( entt::registry& registry, const std::string& prefix )
+    {
+        std::vector<entt::entity> entities;
+        auto index = EntityIndex::Get(registry);
+        if (index)
+            index->FindByNamePrefix(prefix, entities);
+        return sol::as_table(std::move(entities));
+    }
+
+    static sol::as_table_t<std::vector<entt::entity>> GetEntitiesByTag( entt::registry& registry, const std::string& tag )
+    {
+        auto index = EntityIndex::Get(registry);
+        return sol::as_table(index ? index->FindAllByTag(tag) : std::vector<entt::entity>());
+    }
+
+    // Returns nil on a miss, otherwise a table with entity, distance, position and normal
+    static sol::object Raycast( entt::registry& registry, const Maths::Vector3& origin, const Maths::Vector3& direction, sol::optional<float> maxDistance, sol::this_state s )
+    {
+        auto raycast = SceneRaycast::Get(registry);
+        RaycastHit hit;
+        if (!raycast || !raycast->Raycast(Maths::Ray(origin, direction), hit, maxDistance.value_or(Maths::M_INFINITY)))
+            return sol::lua_nil;
+
+        sol::state_view lua(s);
+        sol::table result = lua.create_table();
+        result["entity"] = hit.entity;
+        result["distance"] = hit.distance;
+        result["position"] = hit.position;
+        result["normal"] = hit.normal;
+        return result;
+    }
+
+    // Name and tag writes from Lua go through registry.patch, so on_update keeps the EntityIndex current.
+    // Scripts only see the current scene, the entity is found from the component's place in its storage.
+    // A component outside it is written directly, and the index rebuilds on its next query.
+    template<typename Component, typename Func>
+    static void PatchComponent(Component& component, Func func)
+    {
+        auto scene = Application::Instance()->GetSceneManager()->GetCurrentScene();
+        if (scene)
         {
-            if ( name == component.name )
+            auto& registry = scene->GetRegistry();
+            auto view = registry.view<Component>();
+            const Component* components = view.raw();
+            if (&component >= components && &component < components + view.size())
             {
-                e = entity;
+                registry.patch<Component>(view.data()[&component - components], func);
+                return;
             }
-        });
+        }
+
+        func(component);
 
-        return e;
+        if (scene)
+        {
+            auto index = EntityIndex::Get(scene->GetRegistry());
+            if (index)
+                index->MarkDirty();
+        }
     }
 
     void LuaManager::BindLogLua(sol::state& state)
@@ -330,20 +551,154 @@ namespace Lumos
         return Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromFile(name, path, Graphics::TextureParameters(filter, filter, wrapMode)));
     }
 
+    static entt::registry* CheckRegistry(lua_State* L, int index)
+    {
+        if (!sol::stack::check<entt::registry>(L, index))
+            luaL_argerror(L, index, "Registry expected");
+        return &sol::stack::get<entt::registry&>(L, index);
+    }
+
+    // Sets the array entries from first on to nil, up to the first one already nil
+    static void ClearTableFrom(lua_State* L, int index, u32 first)
+    {
+        for (u32 i = first; lua_rawgeti(L, index, i) != LUA_TNIL; i++)
+        {
+            lua_pop(L, 1);
+            lua_pushnil(L);
+            lua_rawseti(L, index, i);
+        }
+        lua_pop(L, 1);
+    }
+
+    // Bulk access, one call copies a vector of every Transform into or out of a flat Lua array of
+    // x, y, z triples in storage order, instead of a sol2 round trip per entity and per component.
+    // An optional third table receives the matching entities. Entries left over from a call that saw
+    // more transforms are cleared, so tables can be reused. Returns the number of transforms.
+    template<const Maths::Vector3& (Maths::Transform::*Get)() const>
+    static int LuaGetTransformVectors(lua_State* L)
+    {
+        auto registry = CheckRegistry(L, 1);
+        luaL_checktype(L, 2, LUA_TTABLE);
+
+        auto view = registry->view<Maths::Transform>();
+        const Maths::Transform* transforms = view.raw();
+        const u32 count = static_cast<u32>(view.size());
+
+        for (u32 i = 0; i < count; i++)
+        {
+            const Maths::Vector3& value = (transforms[i].*Get)();
+            lua_pushnumber(L, value.x);
+            lua_rawseti(L, 2, i * 3 + 1);
+            lua_pushnumber(L, value.y);
+            lua_rawseti(L, 2, i * 3 + 2);
+            lua_pushnumber(L, value.z);
+            lua_rawseti(L, 2, i * 3 + 3);
+        }
+        ClearTableFrom(L, 2, count * 3 + 1);
+
+        if (lua_istable(L, 3))
+        {
+            const entt::entity* entities = view.data();
+            for (u32 i = 0; i < count; i++)
+            {
+                lua_pushinteger(L, static_cast<lua_Integer>(entt::to_integral(entities[i])));
+                lua_rawseti(L, 3, i + 1);
+            }
+            ClearTableFrom(L, 3, count + 1);
+        }
+
+        lua_pushinteger(L, count);
+        return 1;
+    }
+
+    // Writes triples back in the same order as the matching Get. The table must hold a triple for
+    // every transform, and the entities table Get filled can be passed to check the order still
+    // matches. Raises an error, writing nothing, when either doesn't. Returns the number written.
+    template<void (Maths::Transform::*Set)(const Maths::Vector3&)>
+    static int LuaSetTransformVectors(lua_State* L)
+    {
+        auto registry = CheckRegistry(L, 1);
+        luaL_checktype(L, 2, LUA_TTABLE);
+
+        auto view = registry->view<Maths::Transform>();
+        Maths::Transform* transforms = view.raw();
+        const u32 count = static_cast<u32>(view.size());
+
+        if (lua_rawlen(L, 2) != count * 3)
+            return luaL_error(L, "Expected %d values for %d transforms, got %d", count * 3, count, static_cast<int>(lua_rawlen(L, 2)));
+
+        if (!lua_isnoneornil(L, 3))
+        {
+            luaL_checktype(L, 3, LUA_TTABLE);
+            if (lua_rawlen(L, 3) != count)
+                return luaL_error(L, "Expected %d entities, got %d", count, static_cast<int>(lua_rawlen(L, 3)));
+
+            const entt::entity* entities = view.data();
+            for (u32 i = 0; i < count; i++)
+            {
+                lua_rawgeti(L, 3, i + 1);
+                const bool match = lua_tointeger(L, -1) == static_cast<lua_Integer>(entt::to_integral(entities[i]));
+                lua_pop(L, 1);
+                if (!match)
+                    return luaL_error(L, "Entity %d does not match the registry's transform order", i + 1);
+            }
+        }
+
+        for (u32 i = 0; i < count; i++)
+        {
+            Maths::Vector3 value;
+            lua_rawgeti(L, 2, i * 3 + 1);
+            value.x = static_cast<float>(lua_tonumber(L, -1));
+            lua_rawgeti(L, 2, i * 3 + 2);
+            value.y = static_cast<float>(lua_tonumber(L, -1));
+            lua_rawgeti(L, 2, i * 3 + 3);
+            value.z = static_cast<float>(lua_tonumber(L, -1));
+            lua_pop(L, 3);
+
+            (transforms[i].*Set)(value);
+        }
+
+        lua_pushinteger(L, count);
+        return 1;
+    }
+
     void LuaManager::BindECSLua(sol::state& state)
     {
         sol::usertype<entt::registry> reg_type = state.new_usertype< entt::registry >( "Registry" );
         reg_type.set_function( "Create", static_cast< entt::entity( entt::registry::* )() >( &entt::registry::create ) );
         reg_type.set_function( "Destroy", static_cast< void( entt::registry::* )( entt::entity ) >( &entt::registry::destroy ) );
         reg_type.set_function( "Valid", &entt::registry::valid );
+        reg_type.set_function( "GetPositions", &LuaGetTransformVectors<&Maths::Transform::GetLocalPosition> );
+        reg_type.set_function( "SetPositions", &LuaSetTransformVectors<&Maths::Transform::SetLocalPosition> );
+        reg_type.set_function( "GetScales", &LuaGetTransformVectors<&Maths::Transform::GetLocalScale> );
+        reg_type.set_function( "SetScales", &LuaSetTransformVectors<&Maths::Transform::SetLocalScale> );
 
         state.set_function( "GetEntityByName", &GetEntityByName );
+        state.set_function( "GetEntitiesByName", &GetEntitiesByName );
+        state.set_function( "GetEntitiesByNamePrefix", &GetEntitiesByNamePrefix );
+        state.set_function( "GetEntitiesByTag", &GetEntitiesByTag );
+        state.set_function( "Raycast", &Raycast );
         
         sol::usertype< NameComponent > nameComponent_type = state.new_usertype< NameComponent >( "NameComponent" );
-        nameComponent_type["name"] = &NameComponent::name;
+        nameComponent_type["name"] = sol::property( []( NameComponent& component ) { return component.name; },
+            []( NameComponent& component, const std::string& name ) { PatchComponent(component, [&]( NameComponent& patched ) { patched.name = name; }); } );
         REGISTER_COMPONENT_WITH_ECS( state, NameComponent, static_cast< NameComponent&( entt::registry::* )( const entt::entity )> ( &entt::registry::emplace< NameComponent > ) );
+
+        sol::usertype< TagComponent > tagComponent_type = state.new_usertype< TagComponent >( "TagComponent" );
+        tagComponent_type["tag"] = sol::property( []( TagComponent& component ) { return component.tag; },
+            []( TagComponent& component, const std::string& tag ) { PatchComponent(component, [&]( TagComponent& patched ) { patched.tag = tag; }); } );
+        REGISTER_COMPONENT_WITH_ECS( state, TagComponent, static_cast< TagComponent&( entt::registry::* )( const entt::entity )> ( &entt::registry::emplace< TagComponent > ) );
         
+        state.new_enum<ScriptUpdateRate>("ScriptUpdateRate",
+            {
+                { "EveryFrame", ScriptUpdateRate::EveryFrame },
+                { "TenHz", ScriptUpdateRate::TenHz },
+                { "OneHz", ScriptUpdateRate::OneHz }
+            });
+
         sol::usertype< ScriptComponent > script_type = state.new_usertype< ScriptComponent >( "ScriptComponent", sol::constructors<sol::types<String, Scene*>>() );
+        script_type.set_function("SetUpdateRate", &ScriptComponent::SetUpdateRate);
+        script_type.set_function("GetUpdateRate", &ScriptComponent::GetUpdateRate);
         REGISTER_COMPONENT_WITH_ECS( state, ScriptComponent, static_cast< ScriptComponent&( entt::registry::* )( const entt::entity, String&&, Scene*&& )> ( &entt::registry::emplace< ScriptComponent, String, Scene* > ) );
         
         using namespace Maths;
@@ -352,6 +707,8 @@ namespace Lumos
         using namespace Graphics;
         sol::usertype< Sprite > sprite_type = state.new_usertype< Sprite >( "Sprite", sol::constructors<sol::types<Maths::Vector2, Maths::Vector2, Maths::Vector4>, Sprite(const Ref<Graphics::Texture2D>&, const Maths::Vector2&, const Maths::Vector2&, const Maths::Vector4&)>() );
         sprite_type.set_function("SetTexture", &Sprite::SetTexture);
+        sprite_type.set_function("SetStatic", &Sprite::SetStatic);
+        sprite_type.set_function("GetStatic", &Sprite::GetStatic);
     
         REGISTER_COMPONENT_WITH_ECS( state, Sprite, static_cast<Sprite&( entt::registry::* )( const entt::entity, const Vector2&,  const Vector2&,  const Vector4& )> ( &entt::registry::emplace<Sprite, const Vector2&,  const Vector2&,   const Vector4& > ) );
     
@@ -359,6 +716,7 @@ namespace Lumos
         
         sol::usertype< MeshComponent > meshComponent_type = state.new_usertype< MeshComponent >( "MeshComponent" );
         meshComponent_type["SetMesh"] = &MeshComponent::SetMesh;
+        meshComponent_type["SetPrimitive"] = &MeshComponent::SetPrimitive;
         
         REGISTER_COMPONENT_WITH_ECS( state, MeshComponent, static_cast<MeshComponent&( entt::registry::* )( const entt::entity )> ( &entt::registry::emplace<MeshComponent > ) );
     
@@ -437,10 +795,15 @@ namespace Lumos
     {
         sol::usertype<Scene> scene_type = state.new_usertype< Scene >( "Scene" );
         scene_type.set_function( "GetRegistry", &Scene::GetRegistry );
+        scene_type.set_function( "SaveLevelSnapshot", &Scene::SaveLevelSnapshot );
+        scene_type.set_function( "ResetLevel", &Scene::ResetLevel );
 
         sol::usertype< Graphics::Texture2D > texture2D_type = state.new_usertype< Graphics::Texture2D >( "Texture2D" );
         texture2D_type.set_function("CreateFromFile", &Graphics::Texture2D::CreateFromFile);
     
         state.set_function("Rand", &LuaRand);
+
+        static Timer s_Timer;
+        state.set_function("GetTimeMS", []() -> double { return s_Timer.GetMS(1000.0); });
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "lmpch.h"
 #include "Utilities/TSingleton.h"
+#include "ScriptComponent.h"
 
 #include <sol/sol.hpp>
 #include <entt/entt.hpp>
@@ -47,6 +48,7 @@ struct _ECS_export_view< entt::type_list< Component... >, entt::type_list < Excl
 
 		void OnInit();
         void OnUpdate(Scene* scene);
+        void OnImGui();
 
         void BindECSLua(sol::state& state);
         void BindLogLua(sol::state& state);
@@ -57,7 +59,34 @@ struct _ECS_export_view< entt::type_list< Component... >, entt::type_list < Excl
 
 		WindowProperties LoadConfigFile(const String& file);
 
+        // Per script and per frame budgets in ms, scripts over budget are reported in the editor
+        float GetScriptBudget() const { return m_ScriptBudget; }
+        void SetScriptBudget(float budget) { m_ScriptBudget = budget; }
+        float GetFrameBudget() const { return m_FrameBudget; }
+        void SetFrameBudget(float budget) { m_FrameBudget = budget; }
+
+        void SetSceneScriptTime(float ms) { m_SceneScriptTime = ms; }
+
 	private:
+        struct ScriptGroup
+        {
+            sol::protected_function function;
+            sol::table environments;
+            std::vector<ScriptComponent*> scripts;
+            u32 tableSize = 0;
+        };
+
 		sol::state m_State;
+
+        std::unordered_map<String, ScriptGroup> m_Groups;
+        float m_TierTime[static_cast<u32>(ScriptUpdateRate::Count)] = {};
+
+        float m_ScriptBudget = 0.25f;
+        float m_FrameBudget = 2.0f;
+        float m_FrameScriptTime = 0.0f;
+        float m_SceneScriptTime = 0.0f;
+        u32 m_UpdatedScripts = 0;
+        u32 m_ResumedScripts = 0;
+        u32 m_LuaCalls = 0;
 	};
 }
@@ -63,7 +63,23 @@ namespace Lumos
 
 
         m_UpdateFunc = m_Env["OnUpdate"];
+        m_UpdateGroupFunc = m_Env["OnUpdateGroup"];
 
+        // Scripts can pick their tier with a global, e.g. UpdateRate = ScriptUpdateRate.TenHz
+        sol::optional<ScriptUpdateRate> updateRate = m_Env["UpdateRate"];
+        if (updateRate)
+            m_UpdateRate = updateRate.value();
+
+        m_Coroutine = sol::coroutine();
+        m_WaitTime = 0.0f;
+        m_WaitFrames = 0;
+
+        sol::function runFunc = m_Env["Run"];
+        if (runFunc)
+        {
+            m_Thread = sol::thread::create(LuaManager::Instance()->GetState());
+            m_Coroutine = sol::coroutine(m_Thread.state(), runFunc);
+        }
     }
 
     void ScriptComponent::Update(float dt)
@@ -80,6 +96,58 @@ namespace Lumos
         }
     }
 
+    bool ScriptComponent::UpdateCoroutine(float dt)
+    {
+        if (!m_Coroutine.valid())
+            return false;
+
+        if (m_WaitFrames > 0)
+        {
+            m_WaitFrames--;
+            return false;
+        }
+
+        if (m_WaitTime > 0.0f)
+        {
+            m_WaitTime -= dt;
+            if (m_WaitTime > 0.0f)
+                return false;
+        }
+
+        sol::protected_function_result result = m_Coroutine();
+
+        if (!result.valid())
+        {
+            sol::error err = result;
+            Debug::Log::Error("Failed to Execute Script Lua Run coroutine" );
+            Debug::Log::Error("Error : {0}", err.what());
+            m_Coroutine = sol::coroutine();
+            return true;
+        }
+
+        if (result.status() != sol::call_status::yielded)
+        {
+            // Run returned, nothing left to resume
+            m_Coroutine = sol::coroutine();
+            return true;
+        }
+
+        // wait() and wait_frames() yield (seconds, frames)
+        sol::optional<float> seconds = result.get<sol::optional<float>>(0);
+        sol::optional<int> frames = result.get<sol::optional<int>>(1);
+        m_WaitTime = seconds ? seconds.value() : 0.0f;
+        m_WaitFrames = frames ? static_cast<u32>(Maths::Max(frames.value(), 0)) : 0;
+        return true;
+    }
+
+    void ScriptComponent::RecordTime(float ms, float budget)
+    {
+        m_LastTime = ms;
+        m_AverageTime = m_AverageTime * 0.9f + ms * 0.1f;
+        m_PeakTime = Maths::Max(m_PeakTime * 0.99f, ms);
+        m_OverBudget = m_AverageTime > budget;
+    }
+
     void ScriptComponent::Reload()
     {
         if(m_Env && m_Env["OnRelease"])
@@ -6,6 +6,15 @@ namespace Lumos
 {    
 	class Scene;
 
+    // Update tiers, scripts in a slower tier are updated together once their interval has passed
+    enum class ScriptUpdateRate : u8
+    {
+        EveryFrame = 0,
+        TenHz,
+        OneHz,
+        Count
+    };
+
     class LUMOS_EXPORT ScriptComponent
     {
     public:
@@ -15,6 +24,9 @@ namespace Lumos
         
 		void Init();
 		void Update(float dt);
+
+        // Resumes the script's Run coroutine once its wait() / wait_frames() has expired, returns true if it ran
+        bool UpdateCoroutine(float dt);
         void Reload();
         void Load(const String& fileName);
 
@@ -26,6 +38,23 @@ namespace Lumos
         void SetFilePath(const String& path) { m_FileName = path; }
     
         const std::vector<std::string>& GetErrors() const { return m_Errors; }
+
+        ScriptUpdateRate GetUpdateRate() const { return m_UpdateRate; }
+        void SetUpdateRate(ScriptUpdateRate rate) { m_UpdateRate = rate; }
+
+        bool HasUpdate() const { return m_UpdateFunc.valid(); }
+        bool HasCoroutine() const { return m_Coroutine.valid(); }
+        bool IsWaiting() const { return m_WaitFrames > 0 || m_WaitTime > 0.0f; }
+
+        // Scripts defining OnUpdateGroup(scripts, dt) are updated with one call per script file
+        const sol::protected_function& GetUpdateGroupFunction() const { return m_UpdateGroupFunc; }
+
+        // Timings in ms, the average is a running average over the last few updates
+        void RecordTime(float ms, float budget);
+        float GetLastTime() const { return m_LastTime; }
+        float GetAverageTime() const { return m_AverageTime; }
+        float GetPeakTime() const { return m_PeakTime; }
+        bool GetOverBudget() const { return m_OverBudget; }
         
 	private:
 
@@ -36,5 +65,18 @@ namespace Lumos
         
         sol::environment m_Env;
         sol::protected_function m_UpdateFunc;
+        sol::protected_function m_UpdateGroupFunc;
+
+        sol::thread m_Thread;
+        sol::coroutine m_Coroutine;
+        float m_WaitTime = 0.0f;
+        u32 m_WaitFrames = 0;
+
+        ScriptUpdateRate m_UpdateRate = ScriptUpdateRate::EveryFrame;
+
+        float m_LastTime = 0.0f;
+        float m_AverageTime = 0.0f;
+        float m_PeakTime = 0.0f;
+        bool m_OverBudget = false;
     };
 }
@@ -5,6 +5,9 @@
 #include "Scenes/SceneModelViewer.h"
 #include "Scenes/Scene2D.h"
 #include "Scenes/MaterialTest.h"
+#include "Scenes/LightStressTest.h"
+#include "Scenes/ParticleStressTest.h"
+#include "Scenes/SpriteStressTest.h"
 
 using namespace Lumos;
 
@@ -34,6 +37,9 @@ public:
 		GetSceneManager()->EnqueueScene<Scene3D>("Physics Scene");
 		GetSceneManager()->EnqueueScene<GraphicsScene>("Terrain Test");
 		GetSceneManager()->EnqueueScene<MaterialTest>("Material Test");
+		GetSceneManager()->EnqueueScene<LightStressTest>("Light Stress Test");
+		GetSceneManager()->EnqueueScene<ParticleStressTest>("Particle Stress Test");
+		GetSceneManager()->EnqueueScene<SpriteStressTest>("Sprite Stress Test");
 		GetSceneManager()->SwitchScene(2);
         GetSceneManager()->ApplySceneSwitch();
 	}
@@ -77,59 +77,44 @@ void GraphicsScene::LoadModels()
 	//HeightMap
 	m_Terrain = m_Registry.create(); // EntityManager::Instance()->CreateEntity("heightmap");
 	m_Registry.emplace<Maths::Transform>(m_Terrain, Matrix4::Scale(Maths::Vector3(1.0f)));
-	m_Registry.emplace<TextureMatrixComponent>(m_Terrain, Matrix4::Scale(Maths::Vector3(1.0f, 1.0f, 1.0f)));
 	m_Registry.emplace<NameComponent>(m_Terrain, "HeightMap");
-    Lumos::Ref<Graphics::Mesh> terrain = Lumos::Ref<Graphics::Mesh>(new Terrain());
 
 	auto material = Lumos::CreateRef<Material>();
 	material->LoadMaterial("checkerboard", "/CoreTextures/checkerboard.tga");
 
-	m_Registry.emplace<MaterialComponent>(m_Terrain, material);
-	m_Registry.emplace<MeshComponent>(m_Terrain, terrain);
+	auto terrain = Lumos::CreateRef<ChunkedTerrain>(m_TerrainSettings);
+	terrain->SetMaterial(material);
 
+	m_Registry.emplace<TerrainComponent>(m_Terrain, terrain);
 }
 
-int width = 500;
-int height = 500;
-int lowside = 50;
-int lowscale = 10;
-float xRand = 1.0f;
-float yRand = 150.0f;
-float zRand = 1.0f;
-float texRandX = 1.0f / 16.0f;
-float texRandZ = 1.0f / 16.0f;
-
 void GraphicsScene::OnImGui()
 {
     ImGui::Begin("Terrain");
 
-	ImGui::SliderInt("Width", &width, 1, 5000);
-	ImGui::SliderInt("Height", &height, 1, 5000);
-	ImGui::SliderInt("lowside", &lowside, 1, 300);
-	ImGui::SliderInt("lowscale", &lowscale, 1, 300);
-
-	ImGui::SliderFloat("xRand", &xRand, 0.0f, 300.0f);
-	ImGui::SliderFloat("yRand", &yRand, 0.0f, 300.0f);
-	ImGui::SliderFloat("zRand", &zRand, 0.0f, 300.0f);
-
-	ImGui::InputFloat("texRandX", &texRandX);
-	ImGui::InputFloat("texRandZ", &texRandZ);
+	ImGui::DragFloat("Tile Size", &m_TerrainSettings.tileSize, 1.0f, 8.0f, 1024.0f);
+	int resolution = static_cast<int>(m_TerrainSettings.tileResolution);
+	if (ImGui::SliderInt("Tile Resolution", &resolution, 4, 256))
+		m_TerrainSettings.tileResolution = Maths::NextPowerOfTwo(static_cast<u32>(resolution));
+	int lodCount = static_cast<int>(m_TerrainSettings.lodCount);
+	if (ImGui::SliderInt("Levels", &lodCount, 1, 8))
+		m_TerrainSettings.lodCount = static_cast<u32>(lodCount);
+	ImGui::DragFloat("Level Distance", &m_TerrainSettings.lodDistance, 1.0f, 8.0f, 4096.0f);
+	ImGui::DragFloat("View Distance", &m_TerrainSettings.viewDistance, 8.0f, 64.0f, 16384.0f);
+
+	ImGui::SliderFloat("Height Scale", &m_TerrainSettings.heightScale, 0.0f, 300.0f);
+	ImGui::SliderFloat("Sample Spacing", &m_TerrainSettings.sampleSpacing, 0.1f, 16.0f);
+	ImGui::SliderFloat("Low Scale", &m_TerrainSettings.lowScale, 1.0f, 300.0f);
+	ImGui::InputFloat("Texture Scale", &m_TerrainSettings.textureScale);
     
     if(ImGui::Button("Rebuild Terrain"))
     {
-		m_Registry.destroy(m_Terrain);
+		auto& terrain = m_Registry.get<TerrainComponent>(m_Terrain).GetTerrain();
+		if (terrain)
+			terrain->Clear(m_Registry);
 
-		m_Terrain = m_Registry.create();
-		m_Registry.emplace<Maths::Transform>(m_Terrain, Matrix4::Scale(Maths::Vector3(1.0f)));
-		m_Registry.emplace<TextureMatrixComponent>(m_Terrain, Matrix4::Scale(Maths::Vector3(1.0f, 1.0f, 1.0f)));
-		m_Registry.emplace<NameComponent>(m_Terrain, "HeightMap");
-		Lumos::Ref<Graphics::Mesh> terrain = Lumos::Ref<Graphics::Mesh>(new Terrain(width, height, lowside, lowscale, xRand, yRand, zRand, texRandX, texRandZ));
-
-		auto material = Lumos::CreateRef<Material>();
-		material->LoadMaterial("checkerboard", "/CoreTextures/checkerboard.tga");
-
-		m_Registry.emplace<MaterialComponent>(m_Terrain, material);
-		m_Registry.emplace<MeshComponent>(m_Terrain, terrain);
+		m_Registry.destroy(m_Terrain);
+		LoadModels();
     }
     
     ImGui::End();
@@ -17,5 +17,6 @@ public:
 private:
     
     entt::entity m_Terrain;
+	Lumos::TerrainSettings m_TerrainSettings;
 
 };
@@ -0,0 +1,140 @@
+#include "LightStressTest.h"
+#include "Graphics/MeshFactory.h"
+
+using namespace Lumos;
+using namespace Maths;
+
+LightStressTest::LightStressTest(const String& SceneName)
+	: Scene(SceneName)
+{
+}
+
+LightStressTest::~LightStressTest()
+{
+}
+
+void LightStressTest::OnInit()
+{
+	Scene::OnInit();
+
+	LoadModels();
+	LoadLights();
+
+	m_SceneBoundingRadius = 40.0f;
+
+	auto environment = m_Registry.create();
+	m_Registry.emplace<Graphics::Environment>(environment, "/Textures/cubemap/Arches_E_PineTree", 11, 3072, 4096, ".tga");
+	m_Registry.emplace<NameComponent>(environment, "Environment");
+
+	auto lightEntity = m_Registry.create();
+	m_Registry.emplace<Graphics::Light>(lightEntity, Maths::Vector3(26.0f, 22.0f, 48.5f), Maths::Vector4(1.0f), 0.1f);
+	m_Registry.emplace<Maths::Transform>(lightEntity, Matrix4::Translation(Maths::Vector3(26.0f, 22.0f, 48.5f)) * Maths::Quaternion::LookAt(Maths::Vector3(26.0f, 22.0f, 48.5f), Maths::Vector3::ZERO).RotationMatrix4());
+	m_Registry.emplace<NameComponent>(lightEntity, "Light");
+
+	auto cameraEntity = m_Registry.create();
+	auto& camera = m_Registry.emplace<Camera>(cameraEntity, -30.0f, 0.0f, Maths::Vector3(0.0f, 25.0f, 40.0f), 60.0f, 0.1f, 1000.0f, (float)m_ScreenWidth / (float)m_ScreenHeight);
+	m_Registry.emplace<NameComponent>(cameraEntity, "Camera");
+	Application::Instance()->GetSystem<AudioManager>()->SetListener(&camera);
+
+	bool editor = false;
+
+#ifdef LUMOS_EDITOR
+	editor = true;
+#endif
+
+	Application::Instance()->PushLayer(new Layer3D(new Graphics::DeferredRenderer(m_ScreenWidth, m_ScreenHeight, editor), "Deferred"));
+	Application::Instance()->PushLayer(new Layer3D(new Graphics::SkyboxRenderer(m_ScreenWidth, m_ScreenHeight, editor), "Skybox"));
+}
+
+void LightStressTest::OnUpdate(const TimeStep& timeStep)
+{
+	Scene::OnUpdate(timeStep);
+
+	if (!m_AnimateLights)
+		return;
+
+	m_Time += timeStep.GetSeconds();
+
+	int index = 0;
+	auto group = m_Registry.group<Graphics::Light>(entt::get<Maths::Transform>);
+	for (auto entity : group)
+	{
+		const auto& [light, transform] = group.get<Graphics::Light, Maths::Transform>(entity);
+		if (light.m_Type != float(Graphics::LightType::PointLight))
+			continue;
+
+		// Each light orbits the centre at its own radius and speed
+		float ring = 4.0f + float(index % 25) * 1.2f;
+		float angle = m_Time * (0.2f + float(index % 7) * 0.05f) + float(index) * 2.399f;
+		transform.SetLocalPosition(Maths::Vector3(cos(angle) * ring, 1.0f + float(index % 3), sin(angle) * ring));
+		index++;
+	}
+}
+
+void LightStressTest::Render2D()
+{
+}
+
+void LightStressTest::OnCleanupScene()
+{
+	Scene::OnCleanupScene();
+}
+
+void LightStressTest::LoadModels()
+{
+	auto ground = m_Registry.create();
+	m_Registry.emplace<Maths::Transform>(ground, Matrix4::Scale(Maths::Vector3(40.0f, 0.5f, 40.0f)));
+	m_Registry.emplace<MeshComponent>(ground, AssetsManager::DefaultModels()->Get("Cube"));
+	m_Registry.emplace<NameComponent>(ground, "Ground");
+
+	auto groundMaterial = CreateRef<Material>();
+	MaterialProperties properties;
+	properties.albedoColour = Vector4(0.8f, 0.8f, 0.8f, 1.0f);
+	properties.roughnessColour = Vector4(0.7f);
+	properties.metallicColour = Vector4(0.05f);
+	properties.usingAlbedoMap = 0.0f;
+	properties.usingRoughnessMap = 0.0f;
+	properties.usingNormalMap = 0.0f;
+	properties.usingMetallicMap = 0.0f;
+	groundMaterial->SetMaterialProperites(properties);
+	m_Registry.emplace<MaterialComponent>(ground, groundMaterial);
+
+	int numObjects = 0;
+	for (int x = -8; x <= 8; x += 2)
+	{
+		for (int z = -8; z <= 8; z += 2)
+		{
+			auto obj = m_Registry.create();
+			m_Registry.emplace<Maths::Transform>(obj, Matrix4::Translation(Maths::Vector3(float(x) * 3.0f, 1.5f, float(z) * 3.0f)) * Matrix4::Scale(Maths::Vector3(0.6f, 1.0f, 0.6f)));
+			m_Registry.emplace<MeshComponent>(obj, AssetsManager::DefaultModels()->Get("Cube"));
+			m_Registry.emplace<MaterialComponent>(obj, groundMaterial);
+			m_Registry.emplace<NameComponent>(obj, "Pillar" + StringFormat::ToString(numObjects++));
+		}
+	}
+}
+
+void LightStressTest::LoadLights()
+{
+	for (int i = 0; i < m_LightCount; i++)
+	{
+		float hue = float(i) / float(m_LightCount);
+		Maths::Vector4 colour = Maths::Vector4(
+			Maths::Clamp(Maths::Abs(hue * 6.0f - 3.0f) - 1.0f, 0.0f, 1.0f),
+			Maths::Clamp(2.0f - Maths::Abs(hue * 6.0f - 2.0f), 0.0f, 1.0f),
+			Maths::Clamp(2.0f - Maths::Abs(hue * 6.0f - 4.0f), 0.0f, 1.0f),
+			1.0f);
+
+		auto lightEntity = m_Registry.create();
+		m_Registry.emplace<Graphics::Light>(lightEntity, Maths::Vector3(0.0f), colour, 2.0f, Graphics::LightType::PointLight, Maths::Vector3(0.0f), m_LightRadius);
+		m_Registry.emplace<Maths::Transform>(lightEntity);
+		m_Registry.emplace<NameComponent>(lightEntity, "Point Light" + StringFormat::ToString(i));
+	}
+}
+
+void LightStressTest::OnImGui()
+{
+	ImGui::Begin("Light Stress Test");
+	ImGui::Text("Point Lights : %i", m_LightCount);
+	ImGui::Checkbox("Animate Lights", &m_AnimateLights);
+	ImGui::End();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <LumosEngine.h>
+
+class LightStressTest : public Lumos::Scene
+{
+public:
+	LightStressTest(const String& SceneName);
+	virtual ~LightStressTest();
+
+	virtual void OnInit() override;
+	virtual void OnCleanupScene() override;
+	virtual void OnUpdate(const Lumos::TimeStep& timeStep) override;
+	virtual void Render2D() override;
+	virtual void OnImGui() override;
+	void LoadModels();
+	void LoadLights();
+
+private:
+	int m_LightCount = 250;
+	float m_LightRadius = 4.0f;
+	float m_Time = 0.0f;
+	bool m_AnimateLights = true;
+};
@@ -0,0 +1,111 @@
+#include "ParticleStressTest.h"
+#include "Graphics/MeshFactory.h"
+#include "Graphics/Renderers/ParticleRenderer.h"
+
+using namespace Lumos;
+using namespace Maths;
+
+ParticleStressTest::ParticleStressTest(const String& SceneName)
+	: Scene(SceneName)
+{
+}
+
+ParticleStressTest::~ParticleStressTest()
+{
+}
+
+void ParticleStressTest::OnInit()
+{
+	Scene::OnInit();
+
+	LoadEmitters();
+
+	m_SceneBoundingRadius = 40.0f;
+
+	auto environment = m_Registry.create();
+	m_Registry.emplace<Graphics::Environment>(environment, "/Textures/cubemap/Arches_E_PineTree", 11, 3072, 4096, ".tga");
+	m_Registry.emplace<NameComponent>(environment, "Environment");
+
+	auto lightEntity = m_Registry.create();
+	m_Registry.emplace<Graphics::Light>(lightEntity, Maths::Vector3(26.0f, 22.0f, 48.5f), Maths::Vector4(1.0f), 1.0f);
+	m_Registry.emplace<Maths::Transform>(lightEntity, Matrix4::Translation(Maths::Vector3(26.0f, 22.0f, 48.5f)) * Maths::Quaternion::LookAt(Maths::Vector3(26.0f, 22.0f, 48.5f), Maths::Vector3::ZERO).RotationMatrix4());
+	m_Registry.emplace<NameComponent>(lightEntity, "Light");
+
+	auto ground = m_Registry.create();
+	m_Registry.emplace<Maths::Transform>(ground, Matrix4::Scale(Maths::Vector3(40.0f, 0.5f, 40.0f)));
+	m_Registry.emplace<MeshComponent>(ground, AssetsManager::DefaultModels()->Get("Cube"));
+	m_Registry.emplace<NameComponent>(ground, "Ground");
+
+	auto cameraEntity = m_Registry.create();
+	auto& camera = m_Registry.emplace<Camera>(cameraEntity, -20.0f, 0.0f, Maths::Vector3(0.0f, 20.0f, 60.0f), 60.0f, 0.1f, 1000.0f, (float)m_ScreenWidth / (float)m_ScreenHeight);
+	m_Registry.emplace<NameComponent>(cameraEntity, "Camera");
+	Application::Instance()->GetSystem<AudioManager>()->SetListener(&camera);
+
+	bool editor = false;
+
+#ifdef LUMOS_EDITOR
+	editor = true;
+#endif
+
+	Application::Instance()->PushLayer(new Layer3D(new Graphics::DeferredRenderer(m_ScreenWidth, m_ScreenHeight, editor), "Deferred"));
+	Application::Instance()->PushLayer(new Layer3D(new Graphics::SkyboxRenderer(m_ScreenWidth, m_ScreenHeight, editor), "Skybox"));
+	Application::Instance()->PushLayer(new Layer3D(new Graphics::ParticleRenderer(m_ScreenWidth, m_ScreenHeight, editor), "Particles"));
+}
+
+void ParticleStressTest::OnUpdate(const TimeStep& timeStep)
+{
+	Scene::OnUpdate(timeStep);
+}
+
+void ParticleStressTest::Render2D()
+{
+}
+
+void ParticleStressTest::OnCleanupScene()
+{
+	Scene::OnCleanupScene();
+}
+
+void ParticleStressTest::LoadEmitters()
+{
+	// Spawn rate is chosen so each pool stays close to full once the first particles start dying
+	const float particleLife = 3.0f;
+	const float particleRate = 0.01f;
+	const u32 launchCount = u32(float(m_ParticlesPerEmitter) * particleRate / particleLife);
+
+	for (int i = 0; i < m_EmitterCount; i++)
+	{
+		float hue = float(i) / float(m_EmitterCount);
+		Maths::Vector4 colour = Maths::Vector4(
+			Maths::Clamp(Maths::Abs(hue * 6.0f - 3.0f) - 1.0f, 0.0f, 1.0f),
+			Maths::Clamp(2.0f - Maths::Abs(hue * 6.0f - 2.0f), 0.0f, 1.0f),
+			Maths::Clamp(2.0f - Maths::Abs(hue * 6.0f - 4.0f), 0.0f, 1.0f),
+			0.8f);
+
+		auto emitter = CreateRef<ParticleEmitter>(u32(m_ParticlesPerEmitter));
+		emitter->SetParticleLife(particleLife);
+		emitter->SetParticleRate(particleRate);
+		emitter->SetNumLaunchParticles(launchCount);
+		emitter->SetInitialVelocity(Maths::Vector3(0.0f, 8.0f, 0.0f));
+		emitter->SetGravityEffect(0.5f);
+		emitter->SetScale(0.1f);
+		emitter->SetArea(Maths::Vector3(0.5f));
+		emitter->SetColour(colour);
+
+		float x = float(i % 4) * 10.0f - 15.0f;
+		float z = float(i / 4) * 10.0f - 15.0f;
+
+		auto entity = m_Registry.create();
+		m_Registry.emplace<Maths::Transform>(entity, Matrix4::Translation(Maths::Vector3(x, 1.0f, z)));
+		m_Registry.emplace<ParticleComponent>(entity, emitter);
+		m_Registry.emplace<NameComponent>(entity, "Emitter" + StringFormat::ToString(i));
+	}
+}
+
+void ParticleStressTest::OnImGui()
+{
+	ImGui::Begin("Particle Stress Test");
+	ImGui::Text("Emitters : %i", m_EmitterCount);
+	ImGui::Text("Max Particles : %i", m_EmitterCount * m_ParticlesPerEmitter);
+	ImGui::End();
+}
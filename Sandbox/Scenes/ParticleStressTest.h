@@ -0,0 +1,20 @@
+#pragma once
+#include <LumosEngine.h>
+
+class ParticleStressTest : public Lumos::Scene
+{
+public:
+	ParticleStressTest(const String& SceneName);
+	virtual ~ParticleStressTest();
+
+	virtual void OnInit() override;
+	virtual void OnCleanupScene() override;
+	virtual void OnUpdate(const Lumos::TimeStep& timeStep) override;
+	virtual void Render2D() override;
+	virtual void OnImGui() override;
+	void LoadEmitters();
+
+private:
+	int m_EmitterCount = 16;
+	int m_ParticlesPerEmitter = 65536;
+};
@@ -0,0 +1,90 @@
+#include "SpriteStressTest.h"
+
+using namespace Lumos;
+using namespace Maths;
+
+SpriteStressTest::SpriteStressTest(const String& SceneName)
+	: Scene(SceneName)
+{
+}
+
+SpriteStressTest::~SpriteStressTest()
+{
+}
+
+void SpriteStressTest::OnInit()
+{
+	Scene::OnInit();
+
+	Application::Instance()->GetSystem<LumosPhysicsEngine>()->SetPaused(true);
+
+	LoadTiles();
+
+	auto cameraEntity = m_Registry.create();
+	auto& camera = m_Registry.emplace<Camera>(cameraEntity, static_cast<float>(m_ScreenWidth) / static_cast<float>(m_ScreenHeight), 100.0f);
+	camera.SetCameraController(CreateRef<CameraController2D>());
+	camera.SetIsOrthographic(true);
+	m_Registry.emplace<NameComponent>(cameraEntity, "Camera");
+
+	auto audioSystem = Application::Instance()->GetSystem<AudioManager>();
+	if (audioSystem)
+		Application::Instance()->GetSystem<AudioManager>()->SetListener(&camera);
+
+	bool editor = false;
+
+#ifdef LUMOS_EDITOR
+	editor = true;
+#endif
+
+	Application::Instance()->PushLayer(new Layer2D(new Graphics::Renderer2D(m_ScreenWidth, m_ScreenHeight, editor, true, false, false)));
+}
+
+void SpriteStressTest::OnUpdate(const TimeStep& timeStep)
+{
+	Scene::OnUpdate(timeStep);
+}
+
+void SpriteStressTest::OnCleanupScene()
+{
+	Scene::OnCleanupScene();
+}
+
+void SpriteStressTest::LoadTiles()
+{
+	// Two small textures, both end up in the same atlas page so the map draws in a few batches
+	Ref<Graphics::Texture2D> textures[2] =
+	{
+		Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromFile("block", "/Textures/Test2D/block.png")),
+		Ref<Graphics::Texture2D>(Graphics::Texture2D::CreateFromFile("block_solid", "/Textures/Test2D/block_solid.png"))
+	};
+
+	const Vector2 origin = Vector2(-m_TilesX * m_TileSize * 0.5f, -m_TilesY * m_TileSize * 0.5f);
+
+	for (int y = 0; y < m_TilesY; y++)
+	{
+		for (int x = 0; x < m_TilesX; x++)
+		{
+			float shade = 0.6f + 0.4f * float((x * 7 + y * 13) % 5) / 4.0f;
+
+			auto tile = m_Registry.create();
+			auto& sprite = m_Registry.emplace<Graphics::Sprite>(tile, textures[(x + y) % 2], origin + Vector2(float(x), float(y)) * m_TileSize, Vector2(m_TileSize, m_TileSize), Vector4(shade, shade, shade, 1.0f));
+			sprite.SetStatic(m_StaticTiles);
+			m_Registry.emplace<Maths::Transform>(tile);
+		}
+	}
+}
+
+void SpriteStressTest::OnImGui()
+{
+	ImGui::Begin("Sprite Stress Test");
+	ImGui::Text("Tiles : %i", m_TilesX * m_TilesY);
+
+	// Toggle between baked chunks and the streaming batcher to compare
+	if (ImGui::Checkbox("Static Tiles", &m_StaticTiles))
+	{
+		auto view = m_Registry.view<Graphics::Sprite>();
+		for (auto entity : view)
+			view.get<Graphics::Sprite>(entity).SetStatic(m_StaticTiles);
+	}
+	ImGui::End();
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <LumosEngine.h>
+
+class SpriteStressTest : public Lumos::Scene
+{
+public:
+	explicit SpriteStressTest(const String& SceneName);
+	virtual ~SpriteStressTest();
+
+	virtual void OnInit() override;
+	virtual void OnCleanupScene() override;
+	virtual void OnUpdate(const Lumos::TimeStep& timeStep) override;
+	virtual void OnImGui() override;
+	void LoadTiles();
+
+private:
+	int m_TilesX = 512;
+	int m_TilesY = 400;
+	float m_TileSize = 0.5f;
+	bool m_StaticTiles = true;
+};
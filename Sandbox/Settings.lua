@@ -7,5 +7,7 @@ borderless=false
 vsync=true
 title="Sandbox"
 renderAPI=0
+audioBackend=0
 
--- OpenGL = 0, Vulkan = 1, Direct3D = 2
\ No newline at end of file
+-- OpenGL = 0, Vulkan = 1, Direct3D = 2
+-- Audio : Default = 0, OpenAL = 1, Mixer to OpenAL = 2, Mixer to null output = 3, Mixer to AudioCapture.wav = 4
\ No newline at end of file
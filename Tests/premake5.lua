@@ -0,0 +1,195 @@
+IncludeDir = {}
+IncludeDir["GLFW"] = "../Dependencies/glfw/include/"
+IncludeDir["Glad"] = "../Lumos/external/glad/include/"
+IncludeDir["lua"] = "../Dependencies/lua/src/"
+IncludeDir["stb"] = "../Lumos/external/stb/"
+IncludeDir["OpenAL"] = "../Dependencies/OpenAL/include/"
+IncludeDir["Box2D"] = "../Dependencies/Box2D/"
+IncludeDir["Dependencies"] = "../Dependencies/"
+IncludeDir["vulkan"] = "../Dependencies/vulkan/"
+IncludeDir["jsonhpp"] = "../Lumos/external/jsonhpp/"
+IncludeDir["Lumos"] = "../Lumos/src"
+IncludeDir["External"] = "../Lumos/external/"
+IncludeDir["ImGui"] = "../Dependencies/imgui/"
+IncludeDir["freetype"] = "../Dependencies/freetype/include"
+IncludeDir["SpirvCross"] = "../Dependencies/SPIRV-Cross"
+
+-- Headless tests of engine systems that don't need a window or a graphics device
+project "Tests"
+	kind "ConsoleApp"
+	language "C++"
+
+	files
+	{
+		"src/**.h",
+		"src/**.cpp"
+	}
+
+	includedirs
+	{
+		"src/"
+	}
+
+	sysincludedirs
+	{
+		"%{IncludeDir.GLFW}",
+		"%{IncludeDir.Glad}",
+		"%{IncludeDir.lua}",
+		"%{IncludeDir.stb}",
+		"%{IncludeDir.ImGui}",
+		"%{IncludeDir.OpenAL}",
+		"%{IncludeDir.Box2D}",
+		"%{IncludeDir.vulkan}",
+		"%{IncludeDir.Dependencies}",
+		"%{IncludeDir.External}",
+		"%{IncludeDir.jsonhpp}",
+		"%{IncludeDir.freetype}",
+		"%{IncludeDir.SpirvCross}",
+		"%{IncludeDir.Lumos}",
+	}
+
+	links
+	{
+		"Lumos",
+		"lua",
+		"Box2D",
+		"imgui",
+		"freetype",
+		"SpirvCross"
+	}
+
+	cwd = os.getcwd() .. "/.."
+
+	filter "system:windows"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		defines
+		{
+			"LUMOS_PLATFORM_WINDOWS",
+			"LUMOS_RENDER_API_OPENGL",
+			"LUMOS_RENDER_API_VULKAN",
+			"VK_USE_PLATFORM_WIN32_KHR",
+			"WIN32_LEAN_AND_MEAN",
+			"_CRT_SECURE_NO_WARNINGS",
+			"_DISABLE_EXTENDED_ALIGNED_STORAGE",
+			"_SILENCE_CXX17_ITERATOR_BASE_CLASS_DEPRECATION_WARNING",
+			"LUMOS_ROOT_DIR="  .. cwd,
+			"LUMOS_VOLK",
+			"LUMOS_SSE"
+		}
+
+		libdirs
+		{
+			"../Dependencies/OpenAL/libs/Win32"
+		}
+
+		links
+		{
+			"glfw",
+			"OpenGL32",
+			"OpenAL32"
+		}
+
+		buildoptions
+		{
+			"/MP"
+		}
+
+	filter "system:macosx"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+		editandcontinue "Off"
+
+		defines
+		{
+			"LUMOS_PLATFORM_MACOS",
+			"LUMOS_PLATFORM_UNIX",
+			"LUMOS_RENDER_API_OPENGL",
+			"LUMOS_RENDER_API_VULKAN",
+			"VK_EXT_metal_surface",
+			"LUMOS_IMGUI",
+			"LUMOS_ROOT_DIR="  .. cwd,
+			"LUMOS_VOLK",
+			"LUMOS_SSE"
+		}
+
+		linkoptions
+		{
+			"-framework OpenGL",
+			"-framework Cocoa",
+			"-framework IOKit",
+			"-framework CoreVideo",
+			"-framework OpenAL",
+			"-framework QuartzCore"
+		}
+
+		links
+		{
+			"glfw",
+		}
+
+		SetRecommendedXcodeSettings()
+
+	filter "system:linux"
+		cppdialect "C++17"
+		staticruntime "On"
+		systemversion "latest"
+
+		defines
+		{
+			"LUMOS_PLATFORM_LINUX",
+			"LUMOS_PLATFORM_UNIX",
+			"LUMOS_RENDER_API_OPENGL",
+			"LUMOS_RENDER_API_VULKAN",
+			"VK_USE_PLATFORM_XCB_KHR",
+			"LUMOS_IMGUI",
+			"LUMOS_ROOT_DIR="  .. cwd,
+			"LUMOS_VOLK"
+		}
+
+		buildoptions
+		{
+			"-fpermissive",
+			"-Wattributes",
+			"-fPIC",
+			"-Wignored-attributes"
+		}
+
+		links
+		{
+			"glfw",
+		}
+
+		links { "X11", "pthread", "dl", "atomic", "stdc++fs"}
+
+		linkoptions { "-L%{cfg.targetdir}", "-Wl,-rpath=\\$$ORIGIN" }
+
+		if _OPTIONS["arch"] ~= "arm" then
+			buildoptions
+			{
+				"-msse4.1",
+			}
+
+			defines { "LUMOS_SSE" ,"USE_VMA_ALLOCATOR"}
+		end
+
+	filter "configurations:Debug"
+		defines "LUMOS_DEBUG"
+		optimize "Off"
+		symbols "On"
+		runtime "Debug"
+
+	filter "configurations:Release"
+		defines "LUMOS_RELEASE"
+		optimize "On"
+		symbols "On"
+		runtime "Release"
+
+	filter "configurations:Production"
+		defines "LUMOS_PRODUCTION"
+		symbols "Off"
+		optimize "Full"
+		runtime "Release"
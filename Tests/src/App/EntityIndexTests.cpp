@@ -0,0 +1,133 @@
+#include "Test.h"
+#include "App/EntityIndex.h"
+#include "App/SceneGraph.h"
+
+#include <algorithm>
+
+using namespace Lumos;
+
+namespace
+{
+	entt::entity CreateNamed(entt::registry& registry, const String& name)
+	{
+		auto entity = registry.create();
+		registry.emplace<NameComponent>(entity, name);
+		return entity;
+	}
+
+	std::vector<entt::entity> FindPrefix(EntityIndex& index, const String& prefix)
+	{
+		std::vector<entt::entity> entities;
+		index.FindByNamePrefix(prefix, entities);
+		return entities;
+	}
+
+	bool IsSorted(const std::vector<entt::entity>& entities)
+	{
+		return std::is_sorted(entities.begin(), entities.end(), [](entt::entity a, entt::entity b) { return entt::registry::entity(a) < entt::registry::entity(b); });
+	}
+}
+
+TEST_CASE("Entity index finds exact names and tags")
+{
+	entt::registry registry;
+	auto& index = registry.set<EntityIndex>();
+
+	// Some entities exist before the index, the rest are added after
+	auto player = CreateNamed(registry, "Player");
+	auto enemyA = CreateNamed(registry, "Enemy");
+	index.Init(registry);
+	auto enemyB = CreateNamed(registry, "Enemy");
+	registry.emplace<TagComponent>(enemyA, "Hostile");
+	registry.emplace<TagComponent>(enemyB, "Hostile");
+
+	CHECK(EntityIndex::Get(registry) == &index);
+	CHECK(index.FindByName("Player") == player);
+	CHECK(index.FindByName("player") == entt::null);
+	CHECK(index.FindByName("Play") == entt::null);
+	CHECK(index.FindAllByName("Enemy").size() == 2);
+	CHECK(index.FindAllByName("Missing").empty());
+	CHECK(index.FindAllByTag("Hostile").size() == 2);
+
+	// Destroying the lowest id hands FindByName to the next one
+	CHECK(index.FindByName("Enemy") == enemyA);
+	registry.destroy(enemyA);
+	CHECK(index.FindByName("Enemy") == enemyB);
+	CHECK(index.FindAllByTag("Hostile").size() == 1);
+
+	registry.remove<TagComponent>(enemyB);
+	CHECK(index.FindAllByTag("Hostile").empty());
+}
+
+TEST_CASE("Entity index prefix search ignores case")
+{
+	entt::registry registry;
+	auto& index = registry.set<EntityIndex>();
+	index.Init(registry);
+
+	auto lampB = CreateNamed(registry, "lamp");
+	auto lampA = CreateNamed(registry, "Lamp_02");
+	auto lampC = CreateNamed(registry, "LAMP_01");
+	auto lampD = CreateNamed(registry, "Lamp_02");
+	CreateNamed(registry, "Lantern");
+	CreateNamed(registry, "Table");
+
+	// Folded name order, the two Lamp_02 entities in id order
+	const std::vector<entt::entity> expected = { lampB, lampC, lampA, lampD };
+	CHECK(FindPrefix(index, "lamp") == expected);
+	CHECK(FindPrefix(index, "LaMp") == expected);
+	CHECK(FindPrefix(index, "lamp_") == std::vector<entt::entity>({ lampC, lampA, lampD }));
+	CHECK(FindPrefix(index, "la").size() == 5);
+	CHECK(FindPrefix(index, "").size() == 6);
+	CHECK(FindPrefix(index, "lamps").empty());
+	CHECK(FindPrefix(index, "z").empty());
+
+	// Appends to what is passed in
+	std::vector<entt::entity> entities = { lampA };
+	index.FindByNamePrefix("table", entities);
+	CHECK(entities.size() == 2);
+}
+
+TEST_CASE("Entity index follows renames")
+{
+	entt::registry registry;
+	auto& index = registry.set<EntityIndex>();
+	index.Init(registry);
+
+	std::vector<entt::entity> entities;
+	for (u32 i = 0; i < 8; i++)
+		entities.push_back(CreateNamed(registry, i % 2 ? "Odd" : "Even"));
+
+	// Renamed through the registry, the index updates straight away
+	registry.patch<NameComponent>(entities[2], [](NameComponent& name) { name.name = "Odd"; });
+	registry.replace<NameComponent>(entities[1], "Renamed");
+	CHECK(index.FindAllByName("Even").size() == 3);
+	CHECK(index.FindAllByName("Odd").size() == 4);
+	CHECK(index.FindByName("Renamed") == entities[1]);
+	CHECK(FindPrefix(index, "even").size() == 3);
+
+	// The rename added entities[2] last, it still sorts by id
+	CHECK(index.FindByName("Odd") == entities[2]);
+	CHECK(IsSorted(index.FindAllByName("Odd")));
+
+	// Renaming the only entity with a name drops the name from prefix searches too
+	registry.replace<NameComponent>(entities[1], "Odd");
+	CHECK(index.FindAllByName("Renamed").empty());
+	CHECK(FindPrefix(index, "ren").empty());
+	CHECK(index.FindByName("Odd") == entities[1]);
+
+	// Moves the last entity into its place in the storage
+	registry.destroy(entities[3]);
+
+	// Written directly, the index is stale until marked dirty
+	registry.get<NameComponent>(entities[0]).name = "Direct";
+	CHECK(index.FindByName("Direct") == entt::null);
+	index.MarkDirty();
+	CHECK(index.FindByName("Direct") == entities[0]);
+	CHECK(index.FindAllByName("Even").size() == 2);
+
+	// A rebuild reads the storage in its own order, the lists come back the same
+	CHECK(index.FindAllByName("Odd").size() == 4);
+	CHECK(IsSorted(index.FindAllByName("Odd")));
+	CHECK(index.FindByName("Odd") == entities[1]);
+}
@@ -0,0 +1,280 @@
+#include "Test.h"
+#include "App/SceneRaycast.h"
+#include "ECS/Component/MeshComponent.h"
+#include "Maths/Transform.h"
+
+#include <random>
+
+using namespace Lumos;
+
+namespace
+{
+	// CPU side mesh for ray casts, no vertex or index buffers behind it
+	class TestMesh : public Graphics::Mesh
+	{
+	public:
+		TestMesh(const std::vector<Graphics::Vertex>& vertices, const std::vector<u32>& indices, bool buildBVH)
+		{
+			m_BoundingBox = CreateRef<Maths::BoundingBox>();
+			for (auto& vertex : vertices)
+				m_BoundingBox->Merge(vertex.Position);
+
+			if (buildBVH)
+				BuildBVH(vertices.data(), indices.data(), static_cast<u32>(indices.size()));
+		}
+	};
+
+	struct Instance
+	{
+		entt::entity entity;
+		bool hasBVH;
+		std::vector<Maths::Vector3> triangles;
+		Maths::BoundingBox bounds;
+		Maths::Matrix3x4 worldToLocal;
+	};
+
+	struct TestScene
+	{
+		entt::registry registry;
+		SceneRaycast* raycast = nullptr;
+		std::vector<Graphics::Vertex> vertices;
+		std::vector<u32> indices;
+		Ref<Graphics::Mesh> mesh;
+		Ref<Graphics::Mesh> boxMesh;
+		std::vector<Instance> instances;
+		float extent;
+
+		// A grid of instances sharing one mesh of 300 small triangles, every tenth only has its bounding box
+		TestScene(u32 gridSize, u32 seed)
+			: extent(gridSize * 6.0f)
+		{
+			raycast = &registry.set<SceneRaycast>();
+			raycast->Init(registry);
+
+			std::mt19937 engine(seed);
+			std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+			for (u32 i = 0; i < 300; i++)
+			{
+				const Maths::Vector3 centre(unit(engine), unit(engine), unit(engine));
+				for (u32 k = 0; k < 3; k++)
+				{
+					Graphics::Vertex vertex;
+					vertex.Position = centre + Maths::Vector3(unit(engine), unit(engine), unit(engine)) * 0.3f;
+					indices.push_back(static_cast<u32>(vertices.size()));
+					vertices.push_back(vertex);
+				}
+			}
+			mesh = CreateRef<TestMesh>(vertices, indices, true);
+			boxMesh = CreateRef<TestMesh>(vertices, indices, false);
+
+			for (u32 i = 0; i < gridSize * gridSize * gridSize; i++)
+			{
+				const Maths::Vector3 position(float(i % gridSize) * 6.0f, float((i / gridSize) % gridSize) * 6.0f, float(i / (gridSize * gridSize)) * 6.0f);
+				auto entity = registry.create();
+				const bool hasBVH = i % 10 != 0;
+				registry.emplace<MeshComponent>(entity, hasBVH ? mesh : boxMesh);
+				instances.emplace_back();
+				instances.back().entity = entity;
+				instances.back().hasBVH = hasBVH;
+				Move(static_cast<u32>(instances.size() - 1), position + Maths::Vector3(unit(engine), unit(engine), unit(engine)), unit(engine) * 180.0f, 1.0f + unit(engine) * 0.5f);
+			}
+		}
+
+		// Places the instance in world space and keeps a world space copy of its triangles for brute force
+		void Move(u32 index, const Maths::Vector3& position, float angle, float scale)
+		{
+			const Maths::Matrix4 world = Maths::Matrix4::Translation(position) * Maths::Quaternion(angle, Maths::Vector3(1.0f, 2.0f, 3.0f).Normalized()).RotationMatrix4() * Maths::Matrix4::Scale(Maths::Vector3(scale, scale * 1.5f, scale));
+			registry.emplace_or_replace<Maths::Transform>(instances[index].entity, world);
+
+			auto& instance = instances[index];
+			instance.worldToLocal = Maths::Matrix3x4(world).Inverse();
+			instance.triangles.clear();
+			instance.bounds = Maths::BoundingBox();
+			for (auto& vertex : vertices)
+			{
+				instance.triangles.push_back(world * vertex.Position);
+				instance.bounds.Merge(instance.triangles.back());
+			}
+
+			if (!instance.hasBVH)
+				instance.bounds = mesh->GetBoundingBox()->Transformed(world);
+		}
+
+		// Brute force closest hit over every triangle of every instance, or the local bounding box for those without a BVH
+		RaycastHit Raycast(const Maths::Ray& ray) const
+		{
+			RaycastHit closest;
+			for (auto& instance : instances)
+			{
+				if (!registry.valid(instance.entity))
+					continue;
+
+				float distance = ray.HitDistance(instance.bounds);
+				if (distance >= closest.distance)
+					continue;
+
+				if (!instance.hasBVH)
+					distance = ray.Transformed(instance.worldToLocal).HitDistance(*mesh->GetBoundingBox());
+				else
+				{
+					distance = Maths::M_INFINITY;
+					for (size_t t = 0; t < instance.triangles.size(); t += 3)
+					{
+						const auto& v = instance.triangles;
+						distance = Maths::Min(distance, Maths::Min(ray.HitDistance(v[t], v[t + 1], v[t + 2]), ray.HitDistance(v[t], v[t + 2], v[t + 1])));
+					}
+				}
+
+				if (distance < closest.distance)
+				{
+					closest.entity = instance.entity;
+					closest.distance = distance;
+				}
+			}
+			return closest;
+		}
+
+		std::vector<Maths::Ray> CreateRays(u32 count, u32 seed) const
+		{
+			std::mt19937 engine(seed);
+			std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+			std::vector<Maths::Ray> rays;
+			for (u32 i = 0; i < count; i++)
+			{
+				const Maths::Vector3 origin = Maths::Vector3(unit(engine), unit(engine), unit(engine)) * extent * 1.5f;
+				const Maths::Vector3 target = Maths::Vector3(unit(engine) + 1.0f, unit(engine) + 1.0f, unit(engine) + 1.0f) * extent * 0.5f;
+				rays.emplace_back(origin, target - origin);
+			}
+			return rays;
+		}
+
+		// Compares the scene's closest hits, any hits and batched hits against brute force
+		u32 Compare(const std::vector<Maths::Ray>& rays, u32& hits)
+		{
+			u32 mismatches = 0;
+			hits = 0;
+
+			std::vector<RaycastHit> batch(rays.size());
+			raycast->Raycast(rays.data(), static_cast<u32>(rays.size()), batch.data());
+
+			for (size_t r = 0; r < rays.size(); r++)
+			{
+				const Maths::Ray& ray = rays[r];
+				const RaycastHit expected = Raycast(ray);
+
+				RaycastHit hit;
+				const bool found = raycast->Raycast(ray, hit);
+				mismatches += found != expected.Hit() || hit.entity != expected.entity;
+				mismatches += raycast->AnyHit(ray) != found;
+				mismatches += batch[r].entity != hit.entity || batch[r].distance != hit.distance;
+
+				if (!found)
+					continue;
+
+				hits++;
+				mismatches += Maths::Abs(hit.distance - expected.distance) > 1e-3f * Maths::Max(1.0f, expected.distance);
+				mismatches += (hit.position - ray.origin_ - ray.direction_ * hit.distance).Length() > 1e-3f;
+				mismatches += Maths::Abs(hit.normal.Length() - 1.0f) > 1e-3f || hit.normal.DotProduct(ray.direction_) > 0.0f;
+
+				// Nothing closer than the hit, and a limit past it still finds it
+				RaycastHit limited;
+				mismatches += raycast->Raycast(ray, limited, hit.distance * 0.99f);
+				mismatches += raycast->AnyHit(ray, hit.distance * 0.99f);
+				mismatches += !raycast->AnyHit(ray, hit.distance * 1.01f + 1e-3f);
+			}
+
+			return mismatches;
+		}
+	};
+}
+
+TEST_CASE("Scene raycast matches brute force over mesh instances")
+{
+	TestScene scene(6, 1);
+	const std::vector<Maths::Ray> rays = scene.CreateRays(300, 2);
+
+	u32 hits;
+	CHECK(scene.Compare(rays, hits) == 0);
+	CHECK(scene.raycast->GetInstanceCount() == scene.instances.size());
+	printf("    %zu instances, %u of %zu rays hit\n", scene.instances.size(), hits, rays.size());
+	CHECK(hits > rays.size() / 4);
+	CHECK(hits < rays.size());
+}
+
+TEST_CASE("Scene raycast follows moved, added and removed meshes")
+{
+	TestScene scene(4, 3);
+	const std::vector<Maths::Ray> rays = scene.CreateRays(300, 4);
+	u32 hits;
+	REQUIRE(scene.Compare(rays, hits) == 0);
+
+	// Transforms don't signal the registry when they change, MarkMoved refits the tree
+	std::mt19937 engine(5);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	for (u32 i = 0; i < scene.instances.size(); i += 2)
+		scene.Move(i, Maths::Vector3(unit(engine), unit(engine), unit(engine)) * 12.0f + Maths::Vector3(12.0f), unit(engine) * 180.0f, 1.5f);
+	scene.raycast->MarkMoved();
+	CHECK(scene.Compare(rays, hits) == 0);
+	CHECK(hits > 0);
+
+	// Removing the mesh that was hit first lets the ray through to the next one
+	RaycastHit hit;
+	u32 ray = 0;
+	while (!scene.raycast->Raycast(rays[ray], hit))
+		ray++;
+	scene.registry.destroy(hit.entity);
+
+	RaycastHit next;
+	scene.raycast->Raycast(rays[ray], next);
+	CHECK(next.entity != hit.entity);
+	CHECK(!next.Hit() || next.distance >= hit.distance);
+	CHECK(scene.raycast->GetInstanceCount() == scene.instances.size() - 1);
+	CHECK(scene.Compare(rays, hits) == 0);
+
+	// A new mesh in front of the camera is picked up without being told
+	auto entity = scene.registry.create();
+	scene.registry.emplace<Maths::Transform>(entity, Maths::Matrix4::Translation(rays[ray].origin_ + rays[ray].direction_ * 0.5f * hit.distance));
+	scene.registry.emplace<MeshComponent>(entity, scene.boxMesh);
+	CHECK(scene.raycast->Raycast(rays[ray], next));
+	CHECK(next.entity == entity);
+
+	// Inactive meshes are skipped
+	scene.boxMesh->GetActive() = false;
+	CHECK(!scene.raycast->Raycast(rays[ray], next) || next.entity != entity);
+	scene.boxMesh->GetActive() = true;
+}
+
+TEST_CASE("Scene raycast picks in well under a millisecond")
+{
+	// 1000 instances of 300 triangles
+	TestScene scene(10, 6);
+	std::vector<Maths::Ray> rays;
+	std::mt19937 engine(7);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	// Mouse picks, from a camera outside the grid
+	const Maths::Vector3 eye(-20.0f, 30.0f, 90.0f);
+	for (u32 i = 0; i < 1000; i++)
+		rays.emplace_back(eye, Maths::Vector3(27.0f + unit(engine) * 30.0f, 27.0f + unit(engine) * 30.0f, 27.0f) - eye);
+
+	// The first query builds the top level tree
+	RaycastHit hit;
+	scene.raycast->Raycast(rays[0], hit);
+	const float buildTime = scene.raycast->GetLastQueryTime();
+
+	float total = 0.0f, slowest = 0.0f;
+	u32 hits = 0;
+	for (auto& ray : rays)
+	{
+		hits += scene.raycast->Raycast(ray, hit);
+		total += scene.raycast->GetLastQueryTime();
+		slowest = Maths::Max(slowest, scene.raycast->GetLastQueryTime());
+	}
+
+	const float average = total / rays.size();
+	printf("    %zu instances, first query %.3f ms, pick average %.4f ms, slowest %.4f ms, %u of %zu hit\n", scene.instances.size(), buildTime, average,
+		slowest, hits, rays.size());
+	CHECK(hits > rays.size() / 2);
+	CHECK(average < 1.0f);
+}
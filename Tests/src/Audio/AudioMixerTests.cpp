@@ -0,0 +1,347 @@
+#include "Test.h"
+#include "Audio/AudioMixer.h"
+#include "Audio/AudioOutput.h"
+#include "Maths/Maths.h"
+
+#include <fstream>
+#include <random>
+
+using namespace Lumos;
+
+namespace
+{
+	const u32 SampleRate = 48000;
+	const u32 BlockSamples = AUDIO_MIX_BLOCK_FRAMES * AUDIO_MIX_CHANNELS;
+
+	std::vector<float> RandomSamples(u32 count, u32 seed)
+	{
+		std::mt19937 engine(seed);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		std::vector<float> samples(count);
+		for (auto& sample : samples)
+			sample = distribution(engine);
+		return samples;
+	}
+
+	// One frame at a time, the way the mixer's scalar path resamples and ramps, with the wrap
+	// and end checks the mixer does between its runs
+	bool MixReference(MixerVoice& voice, float* out)
+	{
+		const u32 lastFrame = voice.FrameCount - 1;
+		float gainStep[AUDIO_MIX_CHANNELS];
+		for (u32 c = 0; c < AUDIO_MIX_CHANNELS; c++)
+			gainStep[c] = (voice.TargetGain[c] - voice.Gain[c]) / float(AUDIO_MIX_BLOCK_FRAMES);
+
+		bool playing = true;
+		for (u32 i = 0; i < AUDIO_MIX_BLOCK_FRAMES; i++)
+		{
+			if (voice.Position >= lastFrame)
+			{
+				if (!voice.Looping)
+				{
+					playing = false;
+					break;
+				}
+				voice.Position = fmod(voice.Position, double(lastFrame));
+			}
+
+			const u32 index = Maths::Min(static_cast<u32>(voice.Position), lastFrame - 1);
+			const float fraction = static_cast<float>(voice.Position - index);
+			const float* a = voice.Samples + index * voice.Channels;
+			const float* b = a + voice.Channels;
+
+			out[i * 2] += (a[0] + (b[0] - a[0]) * fraction) * (voice.Gain[0] + gainStep[0] * i);
+			out[i * 2 + 1] += (a[voice.Channels - 1] + (b[voice.Channels - 1] - a[voice.Channels - 1]) * fraction) * (voice.Gain[1] + gainStep[1] * i);
+			voice.Position += voice.Step;
+		}
+
+		for (u32 c = 0; c < AUDIO_MIX_CHANNELS; c++)
+			voice.Gain[c] = voice.TargetGain[c];
+
+		return playing;
+	}
+
+	template<typename T>
+	T ReadValue(std::ifstream& file)
+	{
+		T value = 0;
+		file.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return value;
+	}
+}
+
+TEST_CASE("Audio mixer matches a scalar reference")
+{
+	// Built with LUMOS_SSE the mixer runs four frames at a time, the odd lengths between wraps
+	// leave tails for its scalar loop
+	std::vector<float> mono = RandomSamples(1001, 1);
+	std::vector<float> stereo = RandomSamples(1377 * 2, 2);
+
+	// The last frame repeats the first, as looping sources do. A frame that lands within rounding of
+	// the wrap then reads the same whether the mixer or the reference wraps it first
+	mono.back() = mono.front();
+	stereo[1376 * 2] = stereo[0];
+	stereo[1376 * 2 + 1] = stereo[1];
+	const double steps[] = { 1.0, 0.5, 0.731, 1.25, 2.9 };
+
+	std::vector<MixerVoice> voices;
+	for (u32 i = 0; i < 10; i++)
+	{
+		MixerVoice voice;
+		voice.Channels = i % 2 + 1;
+		voice.Samples = voice.Channels == 2 ? stereo.data() : mono.data();
+		voice.FrameCount = voice.Channels == 2 ? 1377 : 1001;
+		voice.Step = steps[i % 5];
+		voice.Position = i * 37.3;
+		voice.Looping = i < 8;
+		voices.push_back(voice);
+	}
+	std::vector<MixerVoice> reference = voices;
+
+	AudioMixer mixer(SampleRate);
+	float maxError = 0.0f;
+	u32 ended = 0;
+	std::vector<float> expected(BlockSamples);
+
+	for (u32 block = 0; block < 12; block++)
+	{
+		mixer.BeginBlock();
+		std::fill(expected.begin(), expected.end(), 0.0f);
+
+		for (size_t v = 0; v < voices.size(); v++)
+		{
+			// New targets every block, so every block ramps
+			for (u32 c = 0; c < AUDIO_MIX_CHANNELS; c++)
+				voices[v].TargetGain[c] = reference[v].TargetGain[c] = 0.1f + 0.05f * float((block * 3 + v + c * 5) % 7);
+
+			const bool playing = mixer.MixVoice(voices[v]);
+			CHECK(playing == MixReference(reference[v], expected.data()));
+			CHECK(std::abs(voices[v].Position - reference[v].Position) < 1e-6);
+			ended += !playing;
+		}
+
+		const float* mixed = mixer.EndBlock();
+		for (u32 s = 0; s < BlockSamples; s++)
+			maxError = Maths::Max(maxError, std::abs(mixed[s] - expected[s]));
+	}
+
+	printf("    max difference %g\n", maxError);
+	CHECK(ended > 0);
+
+	// The mixer adds its gain step up over the block instead of multiplying it out, which rounds
+	// a little differently across ten voices
+	CHECK(maxError < 1e-4f);
+}
+
+TEST_CASE("Audio mixer loops voices cleanly and ends one shots")
+{
+	// One period of a sine, the frame after the last repeats the first as the wrap expects
+	const u32 period = 300;
+	std::vector<float> sine(period + 1);
+	for (u32 i = 0; i <= period; i++)
+		sine[i] = sinf(2.0f * Maths::M_PI * float(i) / float(period));
+
+	AudioMixer mixer(SampleRate);
+
+	MixerVoice looping;
+	looping.Samples = sine.data();
+	looping.FrameCount = period + 1;
+	looping.Step = 0.9;
+	looping.Looping = true;
+	looping.Gain[0] = looping.Gain[1] = looping.TargetGain[0] = looping.TargetGain[1] = 1.0f;
+
+	// A continuous sine never moves more than its slope allows from one frame to the next
+	const float maxStep = 2.0f * Maths::M_PI / float(period) * float(looping.Step) * 1.01f;
+	float largestStep = 0.0f;
+	float previous = 0.0f;
+	for (u32 block = 0; block < 8; block++)
+	{
+		mixer.BeginBlock();
+		CHECK(mixer.MixVoice(looping));
+		const float* mixed = mixer.EndBlock();
+
+		for (u32 i = 0; i < AUDIO_MIX_BLOCK_FRAMES; i++)
+		{
+			if (block > 0 || i > 0)
+				largestStep = Maths::Max(largestStep, std::abs(mixed[i * 2] - previous));
+			previous = mixed[i * 2];
+		}
+	}
+	CHECK(largestStep <= maxStep);
+	CHECK(looping.Position < period);
+
+	// 700 source frames at step 1 end inside the second block, silent after that
+	std::vector<float> ones(700, 1.0f);
+	MixerVoice oneShot;
+	oneShot.Samples = ones.data();
+	oneShot.FrameCount = 700;
+	oneShot.Gain[0] = oneShot.Gain[1] = oneShot.TargetGain[0] = oneShot.TargetGain[1] = 1.0f;
+
+	mixer.BeginBlock();
+	CHECK(mixer.MixVoice(oneShot));
+	mixer.EndBlock();
+
+	mixer.BeginBlock();
+	CHECK(!mixer.MixVoice(oneShot));
+	const float* mixed = mixer.EndBlock();
+
+	const u32 remaining = 699 - AUDIO_MIX_BLOCK_FRAMES;
+	u32 wrong = 0;
+	for (u32 i = 0; i < AUDIO_MIX_BLOCK_FRAMES; i++)
+		wrong += mixed[i * 2] != (i < remaining ? 1.0f : 0.0f);
+	CHECK(wrong == 0);
+}
+
+TEST_CASE("Audio mixer ramps gains to their targets over a block")
+{
+	std::vector<float> ones(4096, 1.0f);
+	AudioMixer mixer(SampleRate);
+
+	MixerVoice voice;
+	voice.Samples = ones.data();
+	voice.FrameCount = 4096;
+	voice.Gain[0] = 0.0f;
+	voice.Gain[1] = 1.0f;
+	voice.TargetGain[0] = 1.0f;
+	voice.TargetGain[1] = 0.25f;
+
+	mixer.BeginBlock();
+	mixer.MixVoice(voice);
+	const float* mixed = mixer.EndBlock();
+
+	const float step[2] = { 1.0f / AUDIO_MIX_BLOCK_FRAMES, -0.75f / AUDIO_MIX_BLOCK_FRAMES };
+	const u32 last = AUDIO_MIX_BLOCK_FRAMES - 1;
+
+	// The block starts at the old gain and its last frame is one step short of the target
+	CHECK_CLOSE(mixed[0], 0.0f, 1e-6f);
+	CHECK_CLOSE(mixed[1], 1.0f, 1e-6f);
+	CHECK_CLOSE(mixed[last * 2], 1.0f - step[0], 1e-5f);
+	CHECK_CLOSE(mixed[last * 2 + 1], 0.25f - step[1], 1e-5f);
+	CHECK(voice.Gain[0] == voice.TargetGain[0]);
+	CHECK(voice.Gain[1] == voice.TargetGain[1]);
+
+	u32 notMonotonic = 0;
+	for (u32 i = 1; i < AUDIO_MIX_BLOCK_FRAMES; i++)
+		notMonotonic += mixed[i * 2] < mixed[(i - 1) * 2] || mixed[i * 2 + 1] > mixed[(i - 1) * 2 + 1];
+	CHECK(notMonotonic == 0);
+
+	// The next block carries on from the target without a jump
+	mixer.BeginBlock();
+	mixer.MixVoice(voice);
+	mixed = mixer.EndBlock();
+	CHECK_CLOSE(mixed[0], 1.0f, 1e-6f);
+	CHECK_CLOSE(mixed[1], 0.25f, 1e-6f);
+}
+
+TEST_CASE("Audio limiter keeps the master bus within one")
+{
+	const std::vector<float> loud = RandomSamples(48000, 3);
+	AudioMixer mixer(SampleRate);
+	mixer.AddEffect(0, lmnew LimiterEffect());
+	const u32 music = mixer.AddBus("Music");
+	mixer.SetBusVolume(music, 3.0f);
+
+	std::vector<MixerVoice> voices(16);
+	for (u32 i = 0; i < voices.size(); i++)
+	{
+		voices[i].Samples = loud.data() + i * 100;
+		voices[i].FrameCount = 40000;
+		voices[i].Looping = true;
+		voices[i].Bus = i % 2 ? music : 0;
+		voices[i].TargetGain[0] = voices[i].TargetGain[1] = 2.0f;
+	}
+
+	float peak = 0.0f;
+	for (u32 block = 0; block < 16; block++)
+	{
+		mixer.BeginBlock();
+		for (auto& voice : voices)
+			mixer.MixVoice(voice);
+
+		const float* mixed = mixer.EndBlock();
+		for (u32 s = 0; s < BlockSamples; s++)
+			peak = Maths::Max(peak, std::abs(mixed[s]));
+	}
+
+	CHECK(peak > 0.9f);
+	CHECK(peak <= 1.0f);
+
+	// Below the knee nothing changes
+	float quiet[BlockSamples];
+	for (u32 s = 0; s < BlockSamples; s++)
+		quiet[s] = (s % 2 ? -0.5f : 0.5f) * float(s) / BlockSamples;
+
+	float limited[BlockSamples];
+	memcpy(limited, quiet, sizeof(quiet));
+	LimiterEffect limiter;
+	limiter.Process(limited, AUDIO_MIX_BLOCK_FRAMES, SampleRate);
+	CHECK(memcmp(limited, quiet, sizeof(quiet)) == 0);
+}
+
+TEST_CASE("Wav file output writes a header matching its frames")
+{
+	const char* path = "MixerOutputTest.wav";
+	const u32 blocks = 5;
+
+	NullAudioOutput null;
+	CHECK(null.Open(SampleRate, AUDIO_MIX_CHANNELS));
+	CHECK(null.GetWritableFrames(123) == 123);
+
+	std::vector<float> block(BlockSamples);
+	for (u32 s = 0; s < BlockSamples; s++)
+		block[s] = s % 2 ? -2.0f : 0.5f;
+
+	{
+		WavFileAudioOutput output(path);
+		REQUIRE(output.Open(SampleRate, AUDIO_MIX_CHANNELS));
+		for (u32 i = 0; i < blocks; i++)
+		{
+			output.Write(block.data(), AUDIO_MIX_BLOCK_FRAMES);
+			null.Write(block.data(), AUDIO_MIX_BLOCK_FRAMES);
+		}
+		output.Close();
+	}
+	null.Close();
+
+	const u32 dataSize = blocks * BlockSamples * sizeof(i16);
+
+	std::ifstream file(path, std::ios::binary);
+	REQUIRE(file.is_open());
+
+	char tag[5] = {};
+	file.read(tag, 4);
+	CHECK(strcmp(tag, "RIFF") == 0);
+	CHECK(ReadValue<u32>(file) == 36 + dataSize);
+	file.read(tag, 4);
+	CHECK(strcmp(tag, "WAVE") == 0);
+	file.read(tag, 4);
+	CHECK(strcmp(tag, "fmt ") == 0);
+	CHECK(ReadValue<u32>(file) == 16);
+	CHECK(ReadValue<u16>(file) == 1);
+	CHECK(ReadValue<u16>(file) == AUDIO_MIX_CHANNELS);
+	CHECK(ReadValue<u32>(file) == SampleRate);
+	CHECK(ReadValue<u32>(file) == SampleRate * AUDIO_MIX_CHANNELS * 2);
+	CHECK(ReadValue<u16>(file) == AUDIO_MIX_CHANNELS * 2);
+	CHECK(ReadValue<u16>(file) == 16);
+	file.read(tag, 4);
+	CHECK(strcmp(tag, "data") == 0);
+	CHECK(ReadValue<u32>(file) == dataSize);
+
+	// Samples out of range are clamped
+	CHECK(ReadValue<i16>(file) == i16(0.5f * 32767.0f));
+	CHECK(ReadValue<i16>(file) == -32767);
+
+	file.seekg(0, std::ios::end);
+	CHECK(static_cast<u32>(file.tellg()) == 44 + dataSize);
+
+	file.close();
+	std::remove(path);
+}
+
+TEST_CASE("Audio mixer benchmark")
+{
+	const double voiceBlocksPerMS = AudioMixer::Benchmark(64, 500);
+	printf("    %.0f voice blocks per ms, %.0f voices in real time\n", voiceBlocksPerMS, voiceBlocksPerMS * AUDIO_MIX_BLOCK_FRAMES / (SampleRate / 1000.0));
+	CHECK(voiceBlocksPerMS > 0.0);
+}
@@ -0,0 +1,173 @@
+#include "Test.h"
+#include "Audio/AudioStream.h"
+#include "Audio/AudioOutput.h"
+#include "Audio/MixerSound.h"
+
+#include <fstream>
+
+using namespace Lumos;
+
+namespace
+{
+	const u32 SampleRate = 44100;
+	const u32 Channels = 2;
+
+	// Left counts up and right counts down, so a skipped, repeated or swapped frame shows
+	i16 LeftSample(u32 frame) { return static_cast<i16>(frame % 30000); }
+	i16 RightSample(u32 frame) { return static_cast<i16>(-static_cast<i32>(frame % 30000)); }
+
+	void WriteTestWav(const String& path, u32 frames)
+	{
+		std::ofstream file(path.c_str(), std::ios::out | std::ios::binary);
+
+		const u32 dataSize = frames * Channels * 2;
+		const u32 riffSize = 36 + dataSize;
+		const u32 fmtSize = 16;
+		const u16 format = 1;
+		const u16 channels = Channels;
+		const u32 byteRate = SampleRate * Channels * 2;
+		const u16 blockAlign = Channels * 2;
+		const u16 bitsPerSample = 16;
+
+		file.write("RIFF", 4);
+		file.write(reinterpret_cast<const char*>(&riffSize), 4);
+		file.write("WAVEfmt ", 8);
+		file.write(reinterpret_cast<const char*>(&fmtSize), 4);
+		file.write(reinterpret_cast<const char*>(&format), 2);
+		file.write(reinterpret_cast<const char*>(&channels), 2);
+		file.write(reinterpret_cast<const char*>(&SampleRate), 4);
+		file.write(reinterpret_cast<const char*>(&byteRate), 4);
+		file.write(reinterpret_cast<const char*>(&blockAlign), 2);
+		file.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
+		file.write("data", 4);
+		file.write(reinterpret_cast<const char*>(&dataSize), 4);
+
+		for (u32 frame = 0; frame < frames; frame++)
+		{
+			const i16 samples[2] = { LeftSample(frame), RightSample(frame) };
+			file.write(reinterpret_cast<const char*>(samples), sizeof(samples));
+		}
+	}
+
+	// Drains the ring like a sound node, checking every frame follows the last one
+	u32 Drain(AudioStreamer& streamer, AudioStreamBuffer& buffer, AudioOutput& output, u32 fileFrames, u32 framesToRead, bool& continuous, u32& maxReady)
+	{
+		std::vector<float> samples;
+		u32 frame = 0;
+
+		for (u32 spins = 0; frame < framesToRead && spins < 1000000; spins++)
+		{
+			const u32 ready = buffer.GetReadyCount();
+			maxReady = std::max(maxReady, ready);
+
+			if (ready == 0)
+			{
+				if (buffer.finished.load(std::memory_order_acquire) && buffer.GetReadyCount() == 0)
+					break;
+
+				std::this_thread::yield();
+				continue;
+			}
+
+			u32 size = 0;
+			const i16* data = reinterpret_cast<const i16*>(buffer.GetChunk(size));
+
+			if (size % (Channels * 2) != 0)
+				continuous = false;
+
+			for (u32 i = 0; i < size / (Channels * 2); i++, frame++)
+			{
+				const u32 fileFrame = frame % fileFrames;
+				if (data[i * 2] != LeftSample(fileFrame) || data[i * 2 + 1] != RightSample(fileFrame))
+					continuous = false;
+			}
+
+			samples.clear();
+			MixerSound::ConvertSamples(reinterpret_cast<const u8*>(data), size, 16, samples);
+			output.Write(samples.data(), static_cast<u32>(samples.size() / Channels));
+
+			buffer.PopChunk();
+			streamer.Notify();
+		}
+
+		return frame;
+	}
+}
+
+TEST_CASE("Audio streamer decodes a wav through a bounded ring")
+{
+	const String path = "StreamerTest.wav";
+	const u32 fileFrames = SampleRate * 5;
+	WriteTestWav(path, fileFrames);
+
+	NullAudioOutput output;
+	REQUIRE(output.Open(SampleRate, Channels));
+
+	AudioStreamer streamer;
+	auto buffer = lmnew AudioStreamBuffer();
+	buffer->stream = AudioStream::Create(path, "wav");
+	REQUIRE(buffer->stream && buffer->stream->IsValid());
+	CHECK(buffer->stream->GetFormat().Channels == Channels);
+	CHECK(buffer->stream->GetFormat().BitRate == 16);
+
+	streamer.Register(buffer);
+	CHECK(streamer.GetStreamCount() == 1);
+
+	bool continuous = true;
+	u32 maxReady = 0;
+	const u32 frames = Drain(streamer, *buffer, output, fileFrames, fileFrames * 2, continuous, maxReady);
+
+	// The whole file came through once, in order, then the stream stopped
+	CHECK(frames == fileFrames);
+	CHECK(continuous);
+	CHECK(buffer->finished.load());
+
+	// Memory per stream is the ring, whatever the file length
+	CHECK(maxReady <= AUDIO_STREAM_CHUNKS);
+	CHECK(sizeof(AudioStreamBuffer) < fileFrames * Channels * 2 / 4);
+
+	streamer.Unregister(buffer);
+	CHECK(streamer.GetStreamCount() == 0);
+
+	delete buffer->stream;
+	lmdel buffer;
+	output.Close();
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Audio streamer loops without a gap at the wrap")
+{
+	const String path = "StreamerLoopTest.wav";
+
+	// Not a multiple of the chunk size, so the wrap lands inside a chunk
+	const u32 fileFrames = SampleRate + 1234;
+	WriteTestWav(path, fileFrames);
+
+	NullAudioOutput output;
+	REQUIRE(output.Open(SampleRate, Channels));
+
+	AudioStreamer streamer;
+	auto buffer = lmnew AudioStreamBuffer();
+	buffer->stream = AudioStream::Create(path, "wav");
+	buffer->looping = true;
+	REQUIRE(buffer->stream && buffer->stream->IsValid());
+
+	streamer.Register(buffer);
+
+	bool continuous = true;
+	u32 maxReady = 0;
+	const u32 framesToRead = fileFrames * 3 + 100;
+	const u32 frames = Drain(streamer, *buffer, output, fileFrames, framesToRead, continuous, maxReady);
+
+	CHECK(frames >= framesToRead);
+	CHECK(continuous);
+	CHECK(!buffer->finished.load());
+	CHECK(maxReady <= AUDIO_STREAM_CHUNKS);
+
+	streamer.Unregister(buffer);
+
+	delete buffer->stream;
+	lmdel buffer;
+	output.Close();
+	std::remove(path.c_str());
+}
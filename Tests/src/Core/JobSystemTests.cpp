@@ -0,0 +1,52 @@
+#include "Test.h"
+#include "Core/JobSystem.h"
+
+using namespace Lumos;
+
+namespace
+{
+	// Each job dispatches fanout children and waits on them, so every level waits inside a job
+	void RunTree(u32 depth, u32 fanout, std::atomic<u32>& visited)
+	{
+		visited.fetch_add(1);
+		if (depth == 0)
+			return;
+
+		System::JobSystem::Context context;
+		for (u32 i = 0; i < fanout; i++)
+			System::JobSystem::Execute(context, [depth, fanout, &visited]() { RunTree(depth - 1, fanout, visited); });
+
+		System::JobSystem::Wait(context);
+	}
+}
+
+TEST_CASE("Job system dispatch runs every index once")
+{
+	const u32 jobCount = 10000;
+	std::vector<std::atomic<u32>> runs(jobCount);
+
+	// More groups than the queue holds, so Dispatch also runs some of them while pushing
+	System::JobSystem::Context context;
+	System::JobSystem::Dispatch(context, jobCount, 16, [&runs](JobDispatchArgs args) { runs[args.jobIndex].fetch_add(1); });
+	System::JobSystem::Wait(context);
+
+	CHECK(!System::JobSystem::IsBusy(context));
+
+	u32 once = 0;
+	for (auto& count : runs)
+		once += count.load() == 1 ? 1 : 0;
+	CHECK(once == jobCount);
+}
+
+TEST_CASE("Job system jobs can wait on the jobs they dispatch")
+{
+	// 1 + 3 + 9 + 27 + 81 + 243 jobs, with five levels of jobs waiting inside jobs
+	const u32 depth = 5;
+	std::atomic<u32> visited { 0 };
+
+	System::JobSystem::Context context;
+	System::JobSystem::Execute(context, [&visited]() { RunTree(depth, 3, visited); });
+	System::JobSystem::Wait(context);
+
+	CHECK(visited.load() == 364);
+}
@@ -0,0 +1,204 @@
+#include "Test.h"
+#include "ECS/SystemManager.h"
+#include "Utilities/TimeStep.h"
+
+#include <spdlog/sinks/ostream_sink.h>
+#include <sstream>
+
+using namespace Lumos;
+
+namespace
+{
+	struct Position {};
+	struct Velocity {};
+
+	std::vector<String> s_Updated;
+
+	// Each N is its own system type, access declares what it touches
+	template<int N>
+	class TestSystem : public ISystem
+	{
+	public:
+		TestSystem(const char* name, std::function<void(SystemAccess&)> access)
+			: m_Access(std::move(access))
+		{
+			m_DebugName = name;
+		}
+
+		void OnInit() override {}
+		void OnUpdate(const TimeStep&, Scene*) override { s_Updated.push_back(m_DebugName); }
+		void OnImGui() override {}
+		void OnDebugDraw() override {}
+		void DeclareAccess(SystemAccess& access) override { m_Access(access); }
+
+	private:
+		std::function<void(SystemAccess&)> m_Access;
+	};
+
+	using A = TestSystem<0>;
+	using B = TestSystem<1>;
+	using C = TestSystem<2>;
+	using D = TestSystem<3>;
+
+	String GetOrder(SystemManager& systems)
+	{
+		String order;
+		for (auto system : systems.GetUpdateOrder())
+			order += system->GetName();
+		return order;
+	}
+
+	// Runs a serial update and returns the systems in the order they ran
+	String Update(SystemManager& systems)
+	{
+		s_Updated.clear();
+		systems.SetParallel(false);
+		systems.OnUpdate(TimeStep(0.016f), nullptr);
+
+		String order;
+		for (auto& name : s_Updated)
+			order += name;
+		return order;
+	}
+
+	// Collects what is logged to the core logger while alive
+	class LogCapture
+	{
+	public:
+		LogCapture() : m_Sink(std::make_shared<spdlog::sinks::ostream_sink_mt>(m_Stream))
+		{
+			Debug::Log::GetCoreLogger()->sinks().push_back(m_Sink);
+		}
+
+		~LogCapture()
+		{
+			auto& sinks = Debug::Log::GetCoreLogger()->sinks();
+			sinks.erase(std::find(sinks.begin(), sinks.end(), m_Sink));
+		}
+
+		String GetText() const { return m_Stream.str(); }
+
+	private:
+		std::ostringstream m_Stream;
+		std::shared_ptr<spdlog::sinks::ostream_sink_mt> m_Sink;
+	};
+}
+
+TEST_CASE("System graph keeps registration order for conflicting systems")
+{
+	// Registered in the opposite order to their type ids
+	SystemManager systems;
+	systems.RegisterSystem<C>("C", [](SystemAccess& access) { access.Write<Position>(); });
+	systems.RegisterSystem<B>("B", [](SystemAccess& access) { access.Read<Position>(); });
+	systems.RegisterSystem<A>("A", [](SystemAccess& access) { access.Write<Position>(); });
+
+	CHECK(GetOrder(systems) == "CBA");
+	CHECK(Update(systems) == "CBA");
+	CHECK((systems.RunsBefore<C, B>()));
+	CHECK((systems.RunsBefore<B, A>()));
+	CHECK((systems.RunsBefore<C, A>()));
+	CHECK(!(systems.RunsBefore<A, C>()));
+
+	// Systems that declare nothing are exclusive, after everything before them and before everything after
+	systems.RegisterSystem<D>("D", [](SystemAccess& access) { access.Exclusive(); });
+	CHECK(GetOrder(systems) == "CBAD");
+	CHECK((systems.RunsBefore<A, D>()));
+
+	systems.RemoveSystem<B>();
+	CHECK(GetOrder(systems) == "CAD");
+	CHECK(Update(systems) == "CAD");
+}
+
+TEST_CASE("System graph constraints reverse registration order")
+{
+	SystemManager systems;
+	systems.RegisterSystem<A>("A", [](SystemAccess& access) { access.Write<Position>(); });
+	systems.RegisterSystem<B>("B", [](SystemAccess& access) { access.Write<Position>().Before<A>(); });
+	systems.RegisterSystem<C>("C", [](SystemAccess& access) { access.Read<Velocity>(); });
+	systems.RegisterSystem<D>("D", [](SystemAccess& access) { access.Write<Velocity>(); });
+
+	CHECK(GetOrder(systems) == "BACD");
+	CHECK((systems.RunsBefore<B, A>()));
+	CHECK(!(systems.RunsBefore<A, B>()));
+
+	// After works from the other side, and only the pair it names moves
+	SystemManager after;
+	after.RegisterSystem<A>("A", [](SystemAccess& access) { access.Write<Position>().After<C>(); });
+	after.RegisterSystem<B>("B", [](SystemAccess& access) { access.Read<Velocity>(); });
+	after.RegisterSystem<C>("C", [](SystemAccess& access) { access.Read<Position>(); });
+	after.RegisterSystem<D>("D", [](SystemAccess& access) { access.Write<Velocity>(); });
+
+	CHECK(Update(after) == "BCAD");
+	CHECK((after.RunsBefore<C, A>()));
+	CHECK((after.RunsBefore<B, D>()));
+	CHECK(!(after.RunsBefore<A, C>()));
+
+	// Registration order puts A before B before C through their conflicts, which C running before A
+	// contradicts. The conflicts are ordered around the constraint instead
+	SystemManager chain;
+	chain.RegisterSystem<A>("A", [](SystemAccess& access) { access.Write<Position>(); });
+	chain.RegisterSystem<B>("B", [](SystemAccess& access) { access.Read<Position>().Read<Velocity>(); });
+	chain.RegisterSystem<C>("C", [](SystemAccess& access) { access.Write<Velocity>().Before<A>(); });
+
+	CHECK(GetOrder(chain) == "BCA");
+	CHECK((chain.RunsBefore<C, A>()));
+	CHECK((chain.RunsBefore<B, C>()));
+	CHECK((chain.RunsBefore<B, A>()));
+}
+
+TEST_CASE("System graph reports and ignores constraint cycles")
+{
+	SystemManager systems;
+	systems.RegisterSystem<A>("A", [](SystemAccess& access) { access.Write<Position>().Before<C>(); });
+	systems.RegisterSystem<B>("B", [](SystemAccess& access) { access.Write<Position>().Before<A>(); });
+	systems.RegisterSystem<C>("C", [](SystemAccess& access) { access.Read<Velocity>().Before<B>(); });
+
+	String order;
+	String log;
+	{
+		LogCapture capture;
+		order = GetOrder(systems);
+		log = capture.GetText();
+	}
+
+	// Every constraint is dropped, the conflict falls back to registration order
+	CHECK(log.find("cycle") != String::npos);
+	CHECK(order == "ABC");
+	CHECK((systems.RunsBefore<A, B>()));
+	CHECK(!(systems.RunsBefore<C, B>()));
+	CHECK(!(systems.RunsBefore<A, C>()));
+	CHECK(Update(systems) == "ABC");
+
+	// Only reported when the graph is rebuilt
+	LogCapture capture;
+	Update(systems);
+	CHECK(capture.GetText().empty());
+}
+
+TEST_CASE("System graph leaves independent systems unordered")
+{
+	SystemManager systems;
+	systems.RegisterSystem<A>("A", [](SystemAccess& access) { access.Read<Position>(); });
+	systems.RegisterSystem<B>("B", [](SystemAccess& access) { access.Read<Position>().Read<Velocity>(); });
+	systems.RegisterSystem<C>("C", [](SystemAccess& access) { access.Write<Velocity>(); });
+	systems.RegisterSystem<D>("D", [](SystemAccess& access) { access.Read<Position>().MainThread(); });
+
+	CHECK(GetOrder(systems) == "ABCD");
+
+	// Readers of the same component, and main thread systems, don't wait on each other
+	CHECK(!(systems.RunsBefore<A, B>()));
+	CHECK(!(systems.RunsBefore<B, A>()));
+	CHECK(!(systems.RunsBefore<A, D>()));
+	CHECK(!(systems.RunsBefore<D, A>()));
+	CHECK(!(systems.RunsBefore<A, C>()));
+	CHECK(!(systems.RunsBefore<C, A>()));
+	CHECK(!(systems.RunsBefore<C, D>()));
+
+	// The one conflict, B reads what C writes
+	CHECK((systems.RunsBefore<B, C>()));
+
+	// Unregistered systems are never ordered
+	systems.RemoveSystem<D>();
+	CHECK(!(systems.RunsBefore<A, D>()));
+	CHECK(Update(systems) == "ABC");
+}
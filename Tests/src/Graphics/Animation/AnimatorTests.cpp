@@ -0,0 +1,295 @@
+#include "Test.h"
+#include "Graphics/Animation/Animator.h"
+#include "Core/JobSystem.h"
+#include "Utilities/Timer.h"
+
+using namespace Lumos;
+using namespace Lumos::Graphics;
+
+namespace
+{
+	const u32 JointCount = 60;
+	const u32 VertexCount = 5000;
+	const float ClipDuration = 2.0f;
+	const u32 KeysPerSecond = 60;
+
+	// Binary tree of joints 10cm apart, with inverse binds taken from its bind pose
+	Ref<Skeleton> CreateSkeleton()
+	{
+		Skeleton tree;
+		for (u32 j = 0; j < JointCount; j++)
+		{
+			JointPose pose;
+			pose.position = Maths::Vector3(0.0f, j ? 0.1f : 0.0f, 0.0f);
+			tree.AddJoint("Joint" + std::to_string(j), j == 0 ? -1 : i32((j - 1) / 2), pose, Maths::Matrix3x4());
+		}
+
+		std::vector<JointPose> bind(JointCount);
+		std::vector<Maths::Matrix3x4> model(JointCount);
+		tree.GetBindPose(bind.data());
+		tree.GetModelPose(bind.data(), model.data());
+
+		auto skeleton = CreateRef<Skeleton>();
+		for (u32 j = 0; j < JointCount; j++)
+			skeleton->AddJoint(tree.GetJoint(j).name, tree.GetJoint(j).parent, bind[j], model[j].Inverse());
+
+		return skeleton;
+	}
+
+	// Raw keys for every joint, as a model loader would hand them over
+	std::vector<AnimationTrack> CreateTracks()
+	{
+		std::vector<AnimationTrack> tracks;
+		const u32 keyCount = u32(ClipDuration * KeysPerSecond);
+
+		for (u32 j = 0; j < JointCount; j++)
+		{
+			AnimationTrack track;
+			track.joint = j;
+			for (u32 k = 0; k <= keyCount; k++)
+			{
+				const float time = float(k) / KeysPerSecond;
+				track.positionTimes.push_back(time);
+				track.positions.push_back(Maths::Vector3(0.02f * sinf(time * 3.0f + j), j ? 0.1f : 0.5f * time, 0.0f));
+				track.rotationTimes.push_back(time);
+				track.rotations.push_back(Maths::Quaternion::EulerAnglesToQuaternion(20.0f * sinf(time * 2.0f + j), 30.0f * cosf(time + j * 0.3f), 0.0f));
+			}
+			tracks.push_back(track);
+		}
+
+		return tracks;
+	}
+
+	struct SkinnedMeshData
+	{
+		std::vector<Vertex> vertices;
+		std::vector<SkinWeights> weights;
+	};
+
+	SkinnedMeshData CreateMeshData()
+	{
+		SkinnedMeshData data;
+		data.vertices.resize(VertexCount);
+		data.weights.resize(VertexCount);
+
+		for (u32 v = 0; v < VertexCount; v++)
+		{
+			data.vertices[v].Position = Maths::Vector3(sinf(v * 0.1f), v * 0.001f, cosf(v * 0.07f));
+			data.vertices[v].Normal = Maths::Vector3(0.0f, 1.0f, 0.0f);
+			data.vertices[v].Tangent = Maths::Vector3(1.0f, 0.0f, 0.0f);
+
+			const u32 joints[4] = { v % JointCount, (v * 7) % JointCount, (v * 13) % JointCount, (v * 31) % JointCount };
+			const float weights[4] = { 0.5f, 0.3f, 0.15f, 0.05f };
+			data.weights[v] = SkinWeights::Create(joints, weights, 4);
+		}
+
+		return data;
+	}
+
+	// No GPU buffers, Upload does nothing without a vertex array
+	Ref<SkinnedMesh> CreateMesh(SkinnedMeshData& data)
+	{
+		Ref<VertexArray> vertexArray;
+		Ref<IndexBuffer> indexBuffer;
+		return CreateRef<SkinnedMesh>(vertexArray, indexBuffer, CreateRef<Maths::BoundingBox>(), data.vertices.data(), data.weights.data(), VertexCount);
+	}
+
+	float RotationError(const Maths::Quaternion& a, const Maths::Quaternion& b)
+	{
+		return 1.0f - std::abs(a.DotProduct(b));
+	}
+}
+
+TEST_CASE("Skeleton joints are sorted parents first")
+{
+	const std::vector<i32> parents = { 3, -1, 1, 1, 0 };
+	std::vector<u32> order;
+	Skeleton::SortParentsFirst(parents, order);
+
+	REQUIRE(order.size() == parents.size());
+
+	std::vector<u32> position(parents.size());
+	for (u32 i = 0; i < order.size(); i++)
+		position[order[i]] = i;
+
+	for (u32 i = 0; i < parents.size(); i++)
+	{
+		if (parents[i] >= 0)
+			CHECK(position[parents[i]] < position[i]);
+	}
+}
+
+TEST_CASE("Compressed clips stay close to the raw keys")
+{
+	auto skeleton = CreateSkeleton();
+	const auto tracks = CreateTracks();
+
+	AnimationClip clip;
+	clip.Build("Walk", *skeleton, tracks, ClipDuration);
+
+	std::vector<JointPose> sampled(JointCount), reference(JointCount);
+	std::vector<Maths::Matrix3x4> sampledModel(JointCount), referenceModel(JointCount);
+	float maxError = 0.0f;
+	float maxRotationError = 0.0f;
+
+	const u32 keyCount = u32(ClipDuration * KeysPerSecond);
+	for (u32 k = 0; k < 240; k++)
+	{
+		const float time = k * ClipDuration / 239.0f;
+		clip.Sample(time, sampled.data());
+
+		// Linear and spherical interpolation of the raw keys
+		const float key = time * KeysPerSecond;
+		const u32 first = Maths::Min(u32(key), keyCount - 1);
+		const float alpha = key - first;
+		for (u32 j = 0; j < JointCount; j++)
+		{
+			reference[j].position = tracks[j].positions[first].Lerp(tracks[j].positions[first + 1], alpha);
+			reference[j].rotation = tracks[j].rotations[first].Slerp(tracks[j].rotations[first + 1], alpha);
+			maxRotationError = Maths::Max(maxRotationError, RotationError(sampled[j].rotation, reference[j].rotation));
+		}
+
+		// Errors add up down the hierarchy, so positions are compared in model space
+		skeleton->GetModelPose(sampled.data(), sampledModel.data());
+		skeleton->GetModelPose(reference.data(), referenceModel.data());
+		for (u32 j = 0; j < JointCount; j++)
+			maxError = Maths::Max(maxError, (sampledModel[j].Translation() - referenceModel[j].Translation()).Length());
+	}
+
+	printf("    %u -> %u bytes, max joint error %.5f m, max rotation error %.2e\n", clip.GetUncompressedSize(), clip.GetCompressedSize(), maxError, maxRotationError);
+
+	CHECK(clip.GetCompressedSize() < clip.GetUncompressedSize());
+	CHECK(maxError < 0.01f);
+}
+
+TEST_CASE("Skinned vertices match a scalar reference")
+{
+	auto skeleton = CreateSkeleton();
+	auto clip = CreateRef<AnimationClip>();
+	clip->Build("Walk", *skeleton, CreateTracks(), ClipDuration);
+
+	SkinnedMeshData data = CreateMeshData();
+	auto mesh = CreateMesh(data);
+
+	Animator animator(skeleton);
+	animator.AddClip(clip);
+	animator.AddMesh(mesh);
+	animator.Play(0);
+	animator.Update(0.37f);
+
+	const auto& skinMatrices = animator.GetSkinMatrices();
+	const auto& skinned = mesh->GetSkinnedVertices();
+	const Maths::BoundingBox& bounds = *mesh->GetBoundingBox();
+
+	float maxError = 0.0f;
+	u32 outside = 0;
+	for (u32 v = 0; v < VertexCount; v++)
+	{
+		Maths::Vector3 position(0.0f);
+		for (u32 k = 0; k < 4; k++)
+			position += (skinMatrices[data.weights[v].joints[k]] * data.vertices[v].Position) * data.weights[v].weights[k];
+
+		maxError = Maths::Max(maxError, (position - skinned[v].Position).Length());
+		if (bounds.IsInside(skinned[v].Position) == Maths::Intersection::OUTSIDE)
+			outside++;
+	}
+
+	CHECK(maxError < 1e-4f);
+	CHECK(outside == 0);
+}
+
+TEST_CASE("Animation layers respect joint masks and weights")
+{
+	auto skeleton = CreateSkeleton();
+	auto tracks = CreateTracks();
+
+	auto walk = CreateRef<AnimationClip>();
+	walk->Build("Walk", *skeleton, tracks, ClipDuration);
+
+	for (auto& track : tracks)
+	{
+		for (auto& rotation : track.rotations)
+			rotation = Maths::Quaternion::EulerAnglesToQuaternion(0.0f, 90.0f, 0.0f);
+	}
+
+	auto wave = CreateRef<AnimationClip>();
+	wave->Build("Wave", *skeleton, tracks, ClipDuration);
+
+	Animator animator(skeleton);
+	animator.AddClip(walk);
+	animator.AddClip(wave);
+	animator.Play(0);
+	animator.Play(1, 1, 1.0f);
+
+	// Only the second half of the joints is in the upper layer
+	animator.GetLayer(1).jointWeights.assign(JointCount, 0.0f);
+	for (u32 j = JointCount / 2; j < JointCount; j++)
+		animator.GetLayer(1).jointWeights[j] = 1.0f;
+	animator.Update(0.5f);
+
+	std::vector<JointPose> walkPose(JointCount), wavePose(JointCount);
+	walk->Sample(0.5f, walkPose.data());
+	wave->Sample(0.5f, wavePose.data());
+
+	float maskError = 0.0f;
+	for (u32 j = 0; j < JointCount; j++)
+		maskError = Maths::Max(maskError, RotationError(animator.GetLocalPose()[j].rotation, j < JointCount / 2 ? walkPose[j].rotation : wavePose[j].rotation));
+
+	animator.GetLayer(1).jointWeights.clear();
+	animator.GetLayer(1).weight = 0.5f;
+	animator.Update(0.0f);
+
+	float blendError = 0.0f;
+	for (u32 j = 0; j < JointCount; j++)
+		blendError = Maths::Max(blendError, RotationError(animator.GetLocalPose()[j].rotation, walkPose[j].rotation.Nlerp(wavePose[j].rotation, 0.5f, true)));
+
+	CHECK(maskError < 1e-6f);
+	CHECK(blendError < 1e-6f);
+}
+
+TEST_CASE("Posing and skinning characters on the job system")
+{
+	auto skeleton = CreateSkeleton();
+	auto clip = CreateRef<AnimationClip>();
+	clip->Build("Walk", *skeleton, CreateTracks(), ClipDuration);
+
+	SkinnedMeshData data = CreateMeshData();
+
+	const u32 characterCount = 256;
+	std::vector<Ref<Animator>> animators;
+	std::vector<Ref<SkinnedMesh>> meshes;
+	for (u32 i = 0; i < characterCount; i++)
+	{
+		auto animator = CreateRef<Animator>(skeleton);
+		animator->AddClip(clip);
+		meshes.push_back(CreateMesh(data));
+		animator->AddMesh(meshes.back());
+		animator->Play(0);
+		animators.push_back(animator);
+	}
+
+	Timer timer;
+	float start = timer.GetMS(1000.0f);
+	for (auto& animator : animators)
+		animator->Update(0.016f);
+	const float serial = timer.GetMS(1000.0f) - start;
+
+	// Every character is independent, so they can all update at once
+	start = timer.GetMS(1000.0f);
+	System::JobSystem::Context context;
+	System::JobSystem::Dispatch(context, characterCount, 1, [&animators](JobDispatchArgs args) { animators[args.jobIndex]->Update(0.016f); });
+	System::JobSystem::Wait(context);
+	const float parallel = timer.GetMS(1000.0f) - start;
+
+	printf("    one character (%u joints, %u vertices): pose %.3f ms, skin %.3f ms\n", JointCount, VertexCount, animators[0]->GetPoseTime(), animators[0]->GetSkinTime());
+	printf("    %u characters: serial %.2f ms, job system %.2f ms (%u threads)\n", characterCount, serial, parallel, System::JobSystem::GetThreadCount());
+
+	// All of them at the same time in the clip, so they all end up in the same pose
+	u32 different = 0;
+	for (auto& mesh : meshes)
+	{
+		if (memcmp(mesh->GetSkinnedVertices().data(), meshes[0]->GetSkinnedVertices().data(), VertexCount * sizeof(Vertex)) != 0)
+			different++;
+	}
+	CHECK(different == 0);
+}
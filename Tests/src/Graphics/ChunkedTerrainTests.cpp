@@ -0,0 +1,158 @@
+#include "Test.h"
+#include "Graphics/ChunkedTerrain.h"
+
+using namespace Lumos;
+
+namespace
+{
+	// Grid vertices come first in a tile, x major, skirts after them
+	const Graphics::Vertex& GridVertex(const TerrainTileData& tile, u32 side, u32 x, u32 z)
+	{
+		return tile.vertices[x * side + z];
+	}
+
+	struct SeamError
+	{
+		float position = 0.0f;
+		float normal = 0.0f;
+	};
+
+	// Compares the edge of a it shares with its neighbour b, offset one tile along x or z
+	SeamError CompareSeam(const TerrainTileData& a, const TerrainTileData& b, u32 side, float tileSize, bool alongX)
+	{
+		SeamError error;
+		const Maths::Vector3 offset = alongX ? Maths::Vector3(tileSize, 0.0f, 0.0f) : Maths::Vector3(0.0f, 0.0f, tileSize);
+
+		for (u32 i = 0; i < side; i++)
+		{
+			const Graphics::Vertex& va = alongX ? GridVertex(a, side, side - 1, i) : GridVertex(a, side, i, side - 1);
+			const Graphics::Vertex& vb = alongX ? GridVertex(b, side, 0, i) : GridVertex(b, side, i, 0);
+
+			error.position = Maths::Max(error.position, (va.Position - offset - vb.Position).Length());
+			error.normal = Maths::Max(error.normal, (va.Normal - vb.Normal).Length());
+		}
+
+		return error;
+	}
+}
+
+TEST_CASE("Terrain tiles share their edges with same level neighbours")
+{
+	const TerrainSettings settings;
+	const ChunkedTerrain terrain(settings);
+
+	for (u32 lod = 0; lod < settings.lodCount; lod++)
+	{
+		const u32 side = (settings.tileResolution >> lod) + 1;
+
+		TerrainTileData tile, right, forward;
+		terrain.BuildTile({ -1, 2 }, lod, tile);
+		terrain.BuildTile({ 0, 2 }, lod, right);
+		terrain.BuildTile({ -1, 3 }, lod, forward);
+
+		REQUIRE(tile.vertices.size() >= side * side);
+		CHECK(tile.indices.size() % 3 == 0);
+		CHECK(*std::max_element(tile.indices.begin(), tile.indices.end()) < tile.vertices.size());
+
+		const SeamError alongX = CompareSeam(tile, right, side, settings.tileSize, true);
+		const SeamError alongZ = CompareSeam(tile, forward, side, settings.tileSize, false);
+
+		printf("    level %u: position error %g / %g, normal error %g / %g\n", lod, alongX.position, alongZ.position, alongX.normal, alongZ.normal);
+
+		// Both tiles sample GetHeight at the same world points, only the tile space offset can round
+		CHECK(alongX.position < 1e-4f);
+		CHECK(alongZ.position < 1e-4f);
+		CHECK(alongX.normal < 1e-5f);
+		CHECK(alongZ.normal < 1e-5f);
+	}
+}
+
+TEST_CASE("Coarser terrain levels match the finer edge at the vertices they keep")
+{
+	const TerrainSettings settings;
+	const ChunkedTerrain terrain(settings);
+
+	const u32 fineSide = settings.tileResolution + 1;
+	TerrainTileData fine;
+	terrain.BuildTile({ 0, 0 }, 0, fine);
+
+	for (u32 lod = 1; lod < settings.lodCount; lod++)
+	{
+		const u32 ratio = 1u << lod;
+		const u32 coarseSide = (settings.tileResolution >> lod) + 1;
+
+		TerrainTileData coarse;
+		terrain.BuildTile({ 1, 0 }, lod, coarse);
+
+		// The vertices in between differ, that gap is what the skirts hide
+		float maxError = 0.0f;
+		for (u32 i = 0; i < coarseSide; i++)
+		{
+			const float fineHeight = GridVertex(fine, fineSide, fineSide - 1, i * ratio).Position.y;
+			const float coarseHeight = GridVertex(coarse, coarseSide, 0, i).Position.y;
+			maxError = Maths::Max(maxError, std::abs(fineHeight - coarseHeight));
+		}
+
+		CHECK(maxError < 1e-4f);
+	}
+}
+
+TEST_CASE("Terrain level selection has hysteresis at the boundaries")
+{
+	const TerrainSettings settings;
+	const ChunkedTerrain terrain(settings);
+
+	const float boundary = settings.lodDistance;
+
+	CHECK(terrain.SelectLod(0.0f) == 0);
+	CHECK(terrain.SelectLod(boundary - 1.0f) == 0);
+	CHECK(terrain.SelectLod(boundary + 1.0f) == 1);
+	CHECK(terrain.SelectLod(boundary * 2.0f + 1.0f) == 2);
+	CHECK(terrain.SelectLod(1e6f) == settings.lodCount - 1);
+
+	// A viewer moving back and forth across a boundary keeps whichever level the tile has
+	for (u32 lod : { 0u, 1u })
+	{
+		u32 current = lod;
+		u32 changes = 0;
+		for (u32 i = 0; i < 100; i++)
+		{
+			const float distance = boundary + ((i & 1) ? 5.0f : -5.0f);
+			const u32 next = terrain.SelectLod(distance, current);
+			changes += next != current;
+			current = next;
+		}
+
+		CHECK(changes == 0);
+	}
+
+	// Going well past the boundary still switches
+	CHECK(terrain.SelectLod(boundary * 1.15f, 0) == 1);
+	CHECK(terrain.SelectLod(boundary * 0.85f, 1) == 0);
+}
+
+TEST_CASE("Terrain tiles are selected nearest first within the view distance")
+{
+	const TerrainSettings settings;
+	const ChunkedTerrain terrain(settings);
+
+	std::vector<TerrainTileRequest> tiles;
+	terrain.SelectTiles(Maths::Vector3(1000.0f, 60.0f, -300.0f), tiles);
+
+	REQUIRE(!tiles.empty());
+	CHECK(tiles.size() <= settings.maxResidentTiles);
+	CHECK(tiles.front().lod == 0);
+
+	u32 unordered = 0;
+	u32 outOfRange = 0;
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		if (i > 0 && tiles[i].distance < tiles[i - 1].distance)
+			unordered++;
+		if (tiles[i].distance > settings.viewDistance)
+			outOfRange++;
+	}
+
+	CHECK(unordered == 0);
+	CHECK(outOfRange == 0);
+}
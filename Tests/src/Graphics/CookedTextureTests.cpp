@@ -0,0 +1,274 @@
+#include "Test.h"
+#include "Graphics/CookedTexture.h"
+#include "Core/OS/FileSystem.h"
+#include "Maths/Maths.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace Lumos;
+using Graphics::TextureFormat;
+
+namespace
+{
+	const char* SourcePath = "CookedTextureTest.tga";
+	const char* CookedPath = "CookedTextureTest.ltex";
+
+	const u32 ImageSize = 8;
+
+	// Uncompressed 32 bit TGA, each texel's blue channel set to seed
+	void WriteImage(u8 seed, u32 size = ImageSize)
+	{
+		u8 header[18] = {};
+		header[2] = 2;
+		header[12] = u8(size);
+		header[14] = u8(size);
+		header[16] = 32;
+		header[17] = 8;
+
+		std::vector<u8> pixels(size * size * 4);
+		for (u32 i = 0; i < size * size; i++)
+		{
+			pixels[i * 4 + 0] = seed;
+			pixels[i * 4 + 1] = u8(i * 4);
+			pixels[i * 4 + 2] = u8(i * 8);
+			pixels[i * 4 + 3] = 255;
+		}
+
+		std::ofstream file(SourcePath, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+	}
+
+	bool Cook()
+	{
+		Graphics::CookOptions options;
+		options.format = TextureFormat::RGBA8;
+		return Graphics::CookedTexture::CookFile(SourcePath, CookedPath, options);
+	}
+
+	bool IsUpToDate(bool checkContent = false)
+	{
+		String cookedPath;
+		return Graphics::CookedTexture::FindCooked(SourcePath, cookedPath, checkContent) && cookedPath == CookedPath;
+	}
+
+	void SetModifiedTime(std::filesystem::file_time_type time)
+	{
+		std::filesystem::last_write_time(SourcePath, time);
+	}
+
+	const TextureFormat BlockFormats[] = { TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC5, TextureFormat::BC7 };
+
+	const char* GetName(TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1: return "BC1";
+		case TextureFormat::BC3: return "BC3";
+		case TextureFormat::BC5: return "BC5";
+		case TextureFormat::BC7: return "BC7";
+		default: return "?";
+		}
+	}
+
+	// The channels a format keeps, BC1 keeps alpha only as on or off
+	u32 GetChannelCount(TextureFormat format)
+	{
+		return format == TextureFormat::BC5 ? 2 : format == TextureFormat::BC1 ? 3 : 4;
+	}
+
+	// Root mean square error over the channels the format keeps
+	float RMSE(TextureFormat format, const u8* a, const u8* b, u32 texels)
+	{
+		const u32 channels = GetChannelCount(format);
+		double sum = 0.0;
+		for (u32 i = 0; i < texels; i++)
+		{
+			for (u32 c = 0; c < channels; c++)
+			{
+				const double difference = double(a[i * 4 + c]) - double(b[i * 4 + c]);
+				sum += difference * difference;
+			}
+		}
+		return float(sqrt(sum / (texels * channels)));
+	}
+
+	// Smooth gradients with a little noise, what most of a photo or a normal map looks like up close
+	void CreateImage(u32 width, u32 height, u32 seed, std::vector<u8>& rgba)
+	{
+		std::mt19937 engine(seed);
+		std::uniform_int_distribution<int> noise(-6, 6);
+
+		rgba.resize(width * height * 4);
+		for (u32 y = 0; y < height; y++)
+		{
+			for (u32 x = 0; x < width; x++)
+			{
+				u8* texel = &rgba[(y * width + x) * 4];
+				texel[0] = u8(Maths::Clamp(int(x * 255 / width) + noise(engine), 0, 255));
+				texel[1] = u8(Maths::Clamp(int(y * 255 / height) + noise(engine), 0, 255));
+				texel[2] = u8(Maths::Clamp(128 + int(64.0f * sinf(x * 0.3f + y * 0.2f)) + noise(engine), 0, 255));
+				texel[3] = u8(Maths::Clamp(255 - int((x + y) * 128 / (width + height)), 0, 255));
+			}
+		}
+	}
+}
+
+TEST_CASE("Cooked textures go stale when their source changes")
+{
+	WriteImage(10);
+	REQUIRE(Cook());
+	CHECK(IsUpToDate());
+	CHECK(IsUpToDate(true));
+
+	Graphics::CookedTexture cooked;
+	REQUIRE(cooked.Load(CookedPath));
+	CHECK(cooked.GetSource().hash == Graphics::CookedTexture::HashSource(SourcePath));
+	CHECK(cooked.GetSource().modifiedTime == FileSystem::GetModifiedTime(SourcePath));
+
+	const auto cookedTime = std::filesystem::last_write_time(SourcePath);
+
+	// Only touched, the cheap check can't tell it apart from an edit
+	SetModifiedTime(cookedTime + std::chrono::hours(1));
+	CHECK(!IsUpToDate());
+
+	// Same size and time, different content. Only the content check notices
+	WriteImage(20);
+	SetModifiedTime(cookedTime);
+	CHECK(IsUpToDate());
+	CHECK(!IsUpToDate(true));
+
+	REQUIRE(Cook());
+	CHECK(IsUpToDate(true));
+
+	WriteImage(20, ImageSize * 2);
+	SetModifiedTime(std::filesystem::last_write_time(SourcePath) + std::chrono::hours(1));
+	CHECK(!IsUpToDate());
+
+	// Without its source the cooked file is used as it is
+	std::remove(SourcePath);
+	CHECK(IsUpToDate());
+
+	std::remove(CookedPath);
+	CHECK(!IsUpToDate());
+}
+
+TEST_CASE("Block encoders round trip flat and two colour blocks")
+{
+	for (TextureFormat format : BlockFormats)
+	{
+		// Flat blocks of colours that BC1's 565 endpoints can hold exactly come back exactly
+		const u8 colours[][4] = { { 0, 0, 0, 255 }, { 255, 255, 255, 255 }, { 255, 0, 0, 255 }, { 66, 130, 173, 255 } };
+		u32 maxError = 0;
+		for (auto& colour : colours)
+		{
+			u8 rgba[64], block[16], decoded[64];
+			for (u32 i = 0; i < 16; i++)
+				memcpy(rgba + i * 4, colour, 4);
+
+			Graphics::CookedTexture::EncodeBlock(format, rgba, block);
+			Graphics::CookedTexture::DecodeBlock(format, block, decoded);
+
+			for (u32 i = 0; i < 64; i++)
+			{
+				if (i % 4 < GetChannelCount(format))
+					maxError = Maths::Max(maxError, u32(std::abs(int(rgba[i]) - int(decoded[i]))));
+			}
+		}
+
+		// Two colours in a checker, both of them endpoints
+		u8 rgba[64], block[16], decoded[64];
+		for (u32 i = 0; i < 16; i++)
+		{
+			const u8 value = ((i + i / 4) % 2) ? 255 : 0;
+			rgba[i * 4 + 0] = value;
+			rgba[i * 4 + 1] = 255 - value;
+			rgba[i * 4 + 2] = value;
+			rgba[i * 4 + 3] = 255;
+		}
+		Graphics::CookedTexture::EncodeBlock(format, rgba, block);
+		Graphics::CookedTexture::DecodeBlock(format, block, decoded);
+		const float checkerError = RMSE(format, rgba, decoded, 16);
+
+		printf("    %s: flat max error %u, checker error %.2f\n", GetName(format), maxError, checkerError);
+		CHECK(maxError <= 1);
+		CHECK(checkerError < 1.0f);
+	}
+
+	// BC1 keeps texels with alpha under half as transparent black
+	u8 rgba[64], block[8], decoded[64];
+	for (u32 i = 0; i < 16; i++)
+	{
+		rgba[i * 4 + 0] = 200;
+		rgba[i * 4 + 1] = 100;
+		rgba[i * 4 + 2] = 50;
+		rgba[i * 4 + 3] = i < 5 ? 0 : 255;
+	}
+	Graphics::CookedTexture::EncodeBlock(TextureFormat::BC1, rgba, block);
+	Graphics::CookedTexture::DecodeBlock(TextureFormat::BC1, block, decoded);
+
+	u32 wrongAlpha = 0;
+	for (u32 i = 0; i < 16; i++)
+		wrongAlpha += decoded[i * 4 + 3] != rgba[i * 4 + 3];
+	CHECK(wrongAlpha == 0);
+}
+
+TEST_CASE("Cooked levels decompress close to the source image")
+{
+	// Not a multiple of the block size, so the edge blocks repeat their last row and column
+	const u32 width = 70;
+	const u32 height = 37;
+	std::vector<u8> rgba;
+	CreateImage(width, height, 5, rgba);
+
+	// Bounds on the top level error for this image, a little above what the encoders reach. The noise
+	// costs the colour formats most, the BC7 encoder only uses mode 6 so every block has a single line
+	const float maxErrors[] = { 7.0f, 6.0f, 2.0f, 5.0f };
+
+	for (u32 f = 0; f < 4; f++)
+	{
+		const TextureFormat format = BlockFormats[f];
+
+		Graphics::CookOptions options;
+		options.format = format;
+		options.sRGB = false;
+
+		Graphics::CookedTexture cooked;
+		REQUIRE(cooked.Cook(rgba.data(), width, height, options));
+		CHECK(cooked.GetMipCount() == 7);
+		CHECK(cooked.GetLevel(0, 0).size == Graphics::CookedTexture::GetLevelSize(format, width, height));
+		CHECK(cooked.GetLevel(0, 6).width == 1);
+
+		// Every level of the compressed file decodes to the same texels Decompress produces
+		Graphics::CookedTexture decompressed = cooked;
+		decompressed.Decompress();
+		REQUIRE(decompressed.GetFormat() == TextureFormat::RGBA8);
+		REQUIRE(decompressed.GetMipCount() == cooked.GetMipCount());
+
+		u32 mismatches = 0;
+		for (u32 mip = 0; mip < cooked.GetMipCount(); mip++)
+		{
+			const auto& level = cooked.GetLevel(0, mip);
+			const u32 blocksWide = (level.width + 3) / 4;
+			const u32 blockSize = level.size / (blocksWide * ((level.height + 3) / 4));
+
+			for (u32 y = 0; y < level.height; y++)
+			{
+				for (u32 x = 0; x < level.width; x++)
+				{
+					u8 texels[64];
+					Graphics::CookedTexture::DecodeBlock(format, cooked.GetLevelData(0, mip) + ((y / 4) * blocksWide + x / 4) * blockSize, texels);
+					if (memcmp(texels + ((y % 4) * 4 + x % 4) * 4, decompressed.GetLevelData(0, mip) + (y * level.width + x) * 4, 4) != 0)
+						mismatches++;
+				}
+			}
+		}
+		CHECK(mismatches == 0);
+
+		const float error = RMSE(format, rgba.data(), decompressed.GetLevelData(0, 0), width * height);
+		printf("    %s: top level error %.2f\n", GetName(format), error);
+		CHECK(error < maxErrors[f]);
+	}
+}
@@ -0,0 +1,120 @@
+#include "Test.h"
+#include "Graphics/GBuffer.h"
+#include "Maths/MathDefs.h"
+
+#include <random>
+
+using namespace Lumos;
+
+namespace
+{
+	double Dot(const Maths::Vector3& a, const Maths::Vector3& b)
+	{
+		return double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z;
+	}
+
+	// In double, float acos can't resolve angles this small
+	float AngleBetween(const Maths::Vector3& a, const Maths::Vector3& b)
+	{
+		const double cosine = Dot(a, b) / std::sqrt(Dot(a, a) * Dot(b, b));
+		return float(std::acos(Maths::Min(1.0, cosine)) * 57.29577951308232);
+	}
+
+	// The normals target is RGBA16F. FloatToHalf truncates where the GPU rounds, so this is the worse case.
+	Maths::Vector2 StoreHalf(const Maths::Vector2& value)
+	{
+		return Maths::Vector2(Maths::HalfToFloat(Maths::FloatToHalf(value.x)), Maths::HalfToFloat(Maths::FloatToHalf(value.y)));
+	}
+
+	// Largest distance between a point and the one rebuilt from its depth, relative to its distance from the camera.
+	// Far away this is bound by the float depth itself, one step in it spans about 0.1% of the distance at 500m.
+	float MaxReconstructionError(bool zeroToOne)
+	{
+		Maths::Matrix4::SetUpCoordSystem(false, zeroToOne);
+
+		const Maths::Vector3 cameraPosition(3.0f, -2.0f, 5.0f);
+		const Maths::Matrix4 projection = Maths::Matrix4::Perspective(0.1f, 1000.0f, 16.0f / 9.0f, 60.0f);
+		const Maths::Matrix4 view = (Maths::Matrix4::Translation(cameraPosition) * Maths::Quaternion::EulerAnglesToQuaternion(10.0f, 40.0f, 0.0f).RotationMatrix4()).Inverse();
+		const Maths::Matrix4 projView = projection * view;
+		const Maths::Matrix4 screenToWorld = Graphics::GBuffer::BuildScreenToWorld(projView);
+
+		std::mt19937 engine(7);
+		std::normal_distribution<float> normal(0.0f, 1.0f);
+		std::uniform_real_distribution<float> distance(0.2f, 500.0f);
+
+		float maxError = 0.0f;
+		for (u32 i = 0; i < 100000; i++)
+		{
+			const Maths::Vector3 direction = Maths::Vector3(normal(engine), normal(engine), normal(engine)).Normalized();
+			const Maths::Vector3 world = cameraPosition + direction * distance(engine);
+
+			const Maths::Vector4 clip = projView * Maths::Vector4(world, 1.0f);
+			if (clip.w <= 0.1f)
+				continue;
+
+			const Maths::Vector3 ndc = clip.ToVector3() / clip.w;
+			if (std::abs(ndc.x) > 1.0f || std::abs(ndc.y) > 1.0f)
+				continue;
+
+			// What the depth buffer holds for the point under each convention
+			const float depth = zeroToOne ? ndc.z : ndc.z * 0.5f + 0.5f;
+			const Maths::Vector2 uv(ndc.x * 0.5f + 0.5f, ndc.y * 0.5f + 0.5f);
+
+			const Maths::Vector3 rebuilt = Graphics::GBuffer::ReconstructPosition(screenToWorld, uv, depth);
+			maxError = Maths::Max(maxError, (rebuilt - world).Length() / (world - cameraPosition).Length());
+		}
+
+		return maxError;
+	}
+}
+
+TEST_CASE("Octahedral normals survive half float storage")
+{
+	std::mt19937 engine(7);
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+
+	// The axes land on the octahedron's corners and folds, where encodings are most likely to break
+	std::vector<Maths::Vector3> normals = {
+		Maths::Vector3(1.0f, 0.0f, 0.0f), Maths::Vector3(-1.0f, 0.0f, 0.0f),
+		Maths::Vector3(0.0f, 1.0f, 0.0f), Maths::Vector3(0.0f, -1.0f, 0.0f),
+		Maths::Vector3(0.0f, 0.0f, 1.0f), Maths::Vector3(0.0f, 0.0f, -1.0f)
+	};
+
+	for (u32 i = 0; i < 100000; i++)
+		normals.push_back(Maths::Vector3(normal(engine), normal(engine), normal(engine)).Normalized());
+
+	float maxError = 0.0f;
+	float maxHalfError = 0.0f;
+	u32 outOfRange = 0;
+
+	for (auto& n : normals)
+	{
+		const Maths::Vector2 encoded = Graphics::GBuffer::EncodeNormal(n);
+		if (std::abs(encoded.x) > 1.0f + Maths::M_EPSILON || std::abs(encoded.y) > 1.0f + Maths::M_EPSILON)
+			outOfRange++;
+
+		maxError = Maths::Max(maxError, AngleBetween(n, Graphics::GBuffer::DecodeNormal(encoded)));
+		maxHalfError = Maths::Max(maxHalfError, AngleBetween(n, Graphics::GBuffer::DecodeNormal(StoreHalf(encoded))));
+	}
+
+	printf("    max error %.5f degrees, %.4f after half float storage\n", maxError, maxHalfError);
+
+	CHECK(outOfRange == 0);
+	CHECK(maxError < 0.001f);
+	CHECK(maxHalfError < 0.15f);
+}
+
+TEST_CASE("Positions rebuilt from depth match the originals")
+{
+	const int clipControl = Maths::Matrix4::CONFIG_CLIP_CONTROL;
+
+	const float negativeOneToOne = MaxReconstructionError(false);
+	const float zeroToOne = MaxReconstructionError(true);
+
+	Maths::Matrix4::CONFIG_CLIP_CONTROL = clipControl;
+
+	printf("    max relative error %.2e with -1 to 1 depth, %.2e with 0 to 1\n", negativeOneToOne, zeroToOne);
+
+	CHECK(negativeOneToOne < 2e-3f);
+	CHECK(zeroToOne < 2e-3f);
+}
@@ -0,0 +1,233 @@
+#include "Test.h"
+#include "Graphics/Renderers/OcclusionCuller.h"
+#include "ECS/Component/OccluderComponent.h"
+#include "Utilities/Timer.h"
+
+#include <random>
+
+using namespace Lumos;
+
+namespace
+{
+	const u32 BufferWidth = 256;
+	const u32 BufferHeight = 128;
+
+	Maths::Matrix4 CreateProjection()
+	{
+		return Maths::Matrix4::Perspective(0.1f, 1000.0f, 16.0f / 9.0f, 60.0f);
+	}
+
+	void Rasterise(Graphics::OcclusionCuller& culler, const OccluderComponent& occluder)
+	{
+		culler.RasteriseOccluder(occluder.GetPositions().data(), occluder.GetIndices().data(), static_cast<u32>(occluder.GetIndices().size()), occluder.GetAdjacency().data(), Maths::Matrix4());
+	}
+
+	bool RayHitsBox(const Maths::Vector3& origin, const Maths::Vector3& direction, const Maths::BoundingBox& box, float maxDistance)
+	{
+		float nearest = 0.0f;
+		float farthest = maxDistance;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float inverse = 1.0f / direction[axis];
+			float t0 = (box.min_[axis] - origin[axis]) * inverse;
+			float t1 = (box.max_[axis] - origin[axis]) * inverse;
+			if (t0 > t1)
+				std::swap(t0, t1);
+
+			nearest = Maths::Max(nearest, t0);
+			farthest = Maths::Min(farthest, t1);
+			if (nearest > farthest)
+				return false;
+		}
+		return true;
+	}
+
+	// Ground truth, a 7 x 7 x 7 grid of points on the box, any of them in the frustum with a clear line to the eye
+	bool IsSeen(const Maths::BoundingBox& box, const Maths::Vector3& eye, const Maths::Frustum& frustum, const std::vector<Maths::BoundingBox>& blockers)
+	{
+		const Maths::Vector3 size = box.max_ - box.min_;
+		for (u32 s = 0; s < 343; s++)
+		{
+			const Maths::Vector3 point = box.min_ + Maths::Vector3(size.x * (s % 7) / 6.0f, size.y * ((s / 7) % 7) / 6.0f, size.z * (s / 49) / 6.0f);
+			if (frustum.IsInside(point) == Maths::OUTSIDE)
+				continue;
+
+			Maths::Vector3 direction = point - eye;
+			const float distance = direction.Length();
+			direction /= distance;
+
+			bool blocked = false;
+			for (size_t k = 0; k < blockers.size() && !blocked; k++)
+			{
+				if (&blockers[k] != &box && RayHitsBox(eye, direction, blockers[k], distance - 1e-3f))
+					blocked = true;
+			}
+
+			if (!blocked)
+				return true;
+		}
+
+		return false;
+	}
+}
+
+TEST_CASE("Occlusion culler hides boxes behind a wall only")
+{
+	Graphics::OcclusionCuller culler(BufferWidth, BufferHeight);
+	const OccluderComponent wall(Maths::BoundingBox(Maths::Vector3(-10.0f, -10.0f, -10.5f), Maths::Vector3(10.0f, 10.0f, -10.0f)));
+
+	culler.BeginFrame(CreateProjection(), 0.1f);
+	Rasterise(culler, wall);
+	culler.BuildHiZ();
+
+	CHECK(culler.IsVisible(Maths::BoundingBox(Maths::Vector3(-1.0f, -1.0f, -9.9f), Maths::Vector3(1.0f, 1.0f, -9.5f))));
+	CHECK(!culler.IsVisible(Maths::BoundingBox(Maths::Vector3(-1.0f, -1.0f, -20.0f), Maths::Vector3(1.0f, 1.0f, -19.0f))));
+
+	// Sticking out past the wall's edge
+	CHECK(culler.IsVisible(Maths::BoundingBox(Maths::Vector3(9.8f, -1.0f, -30.0f), Maths::Vector3(30.0f, 1.0f, -29.0f))));
+
+	// Crossing the near plane
+	CHECK(culler.IsVisible(Maths::BoundingBox(Maths::Vector3(-1.0f, -1.0f, -20.0f), Maths::Vector3(1.0f, 1.0f, 1.0f))));
+}
+
+TEST_CASE("Occlusion culler pyramid keeps the farthest depth")
+{
+	Graphics::OcclusionCuller culler(BufferWidth, BufferHeight);
+	const OccluderComponent near(Maths::BoundingBox(Maths::Vector3(-4.0f, -2.0f, -6.0f), Maths::Vector3(1.0f, 3.0f, -5.0f)));
+	const OccluderComponent far(Maths::BoundingBox(Maths::Vector3(-30.0f, -20.0f, -60.0f), Maths::Vector3(25.0f, 10.0f, -50.0f)));
+
+	culler.BeginFrame(CreateProjection(), 0.1f);
+	Rasterise(culler, near);
+	Rasterise(culler, far);
+	culler.BuildHiZ();
+
+	REQUIRE(culler.GetLevelCount() > 1);
+
+	u32 mismatches = 0;
+	for (u32 level = 1; level < culler.GetLevelCount(); level++)
+	{
+		const float* source = culler.GetLevelDepth(level - 1);
+		const float* target = culler.GetLevelDepth(level);
+
+		for (u32 y = 0; y < culler.GetLevelHeight(level); y++)
+		{
+			for (u32 x = 0; x < culler.GetLevelWidth(level); x++)
+			{
+				// Odd sizes fold the last row and column into the texel before
+				float farthest = FLT_MAX;
+				for (u32 sy = 2 * y; sy <= Maths::Min(2 * y + 1, culler.GetLevelHeight(level - 1) - 1); sy++)
+				{
+					for (u32 sx = 2 * x; sx <= Maths::Min(2 * x + 1, culler.GetLevelWidth(level - 1) - 1); sx++)
+						farthest = Maths::Min(farthest, source[sy * culler.GetLevelStride(level - 1) + sx]);
+				}
+
+				if (target[y * culler.GetLevelStride(level) + x] != farthest)
+					mismatches++;
+			}
+		}
+	}
+
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE("Occlusion culler walking through a city never hides a visible box")
+{
+	// 16 x 16 blocks of buildings with 6m streets, and small props scattered in the streets and yards
+	std::vector<Maths::BoundingBox> buildings;
+	std::vector<Maths::BoundingBox> props;
+	std::mt19937 engine(7);
+	auto random = [&engine](float min, float max) { return std::uniform_real_distribution<float>(min, max)(engine); };
+
+	for (int bx = -8; bx < 8; bx++)
+	{
+		for (int bz = -16; bz < 0; bz++)
+		{
+			const float x = bx * 26.0f + 3.0f;
+			const float z = bz * 26.0f + 3.0f;
+			buildings.push_back(Maths::BoundingBox(Maths::Vector3(x, 0.0f, z), Maths::Vector3(x + 20.0f, random(8.0f, 40.0f), z + 20.0f)));
+
+			for (u32 k = 0; k < 16; k++)
+			{
+				const float px = x + random(-3.0f, 23.0f);
+				const float pz = z + random(-3.0f, 23.0f);
+				const float size = random(0.3f, 2.0f);
+				const Maths::BoundingBox prop(Maths::Vector3(px, 0.0f, pz), Maths::Vector3(px + size, size, pz + size));
+				if (buildings.back().IsInside(prop) == Maths::OUTSIDE)
+					props.push_back(prop);
+			}
+		}
+	}
+
+	// Buildings are tested against each other as well
+	std::vector<Maths::BoundingBox> occludees = props;
+	occludees.insert(occludees.end(), buildings.begin(), buildings.end());
+
+	std::vector<OccluderComponent> occluders;
+	for (auto& building : buildings)
+		occluders.emplace_back(building);
+
+	Graphics::OcclusionCuller culler(BufferWidth, BufferHeight);
+	const Maths::Matrix4 projection = CreateProjection();
+	Maths::Frustum frustum;
+
+	// 0 hidden, 1 visible, 2 outside the frustum
+	std::vector<u8> visible(occludees.size());
+	System::JobSystem::Context context;
+
+	const u32 frameCount = 64;
+	float rasteriseTime = 0.0f, hiZTime = 0.0f, testTime = 0.0f;
+	u64 tested = 0, culled = 0, falseCulls = 0;
+
+	for (u32 frame = 0; frame < frameCount; frame++)
+	{
+		// Walking down a street, turning around
+		const Maths::Vector3 eye(2.0f, 1.7f, 1.0f - frame * 2.0f);
+		const Maths::Matrix4 view = Maths::Matrix4(Maths::Quaternion(-5.625f * frame, Maths::Vector3(0.0f, 1.0f, 0.0f)).RotationMatrix()) * Maths::Matrix4::Translation(-eye);
+		const Maths::Matrix4 viewProjection = projection * view;
+		frustum.Define(viewProjection);
+
+		Timer timer;
+		float start = timer.GetMS(1000.0f);
+		culler.BeginFrame(viewProjection, 0.1f);
+		for (auto& occluder : occluders)
+		{
+			if (frustum.IsInsideFast(occluder.GetBoundingBox()) != Maths::OUTSIDE)
+				Rasterise(culler, occluder);
+		}
+		rasteriseTime += timer.GetMS(1000.0f) - start;
+
+		start = timer.GetMS(1000.0f);
+		culler.BuildHiZ();
+		hiZTime += timer.GetMS(1000.0f) - start;
+
+		start = timer.GetMS(1000.0f);
+		System::JobSystem::Dispatch(context, static_cast<u32>(occludees.size()), 64, [&](JobDispatchArgs args)
+		{
+			const Maths::BoundingBox& box = occludees[args.jobIndex];
+			visible[args.jobIndex] = frustum.IsInsideFast(box) == Maths::OUTSIDE ? 2 : culler.IsVisible(box);
+		});
+		System::JobSystem::Wait(context);
+		testTime += timer.GetMS(1000.0f) - start;
+
+		for (size_t i = 0; i < occludees.size(); i++)
+		{
+			if (visible[i] == 2)
+				continue;
+
+			tested++;
+			if (visible[i])
+				continue;
+
+			culled++;
+			if (IsSeen(occludees[i], eye, frustum, buildings))
+				falseCulls++;
+		}
+	}
+
+	printf("    %zu occluders, %zu occludees, %.0f in the frustum and %.0f hidden a frame, %llu wrongly hidden\n", occluders.size(), occludees.size(),
+		tested / double(frameCount), culled / double(frameCount), static_cast<unsigned long long>(falseCulls));
+	printf("    per frame: rasterise %.3f ms, hi-z %.3f ms, test %.3f ms (%u threads)\n", rasteriseTime / frameCount, hiZTime / frameCount, testTime / frameCount, System::JobSystem::GetThreadCount());
+
+	CHECK(culled > tested / 4);
+	CHECK(falseCulls == 0);
+}
@@ -0,0 +1,45 @@
+#include "Test.h"
+#include "Core/OS/Memory.h"
+#include "Core/JobSystem.h"
+#include "Core/VFS.h"
+#include "Utilities/Timer.h"
+
+// Runs every registered test case, or only those whose name contains the first argument.
+// The exit code is the number of failed checks.
+int main(int argc, char** argv)
+{
+	Lumos::Debug::Log::OnInit();
+	Lumos::System::JobSystem::OnInit();
+	Lumos::VFS::OnInit();
+
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+	u32 run = 0;
+	u32 failedCases = 0;
+
+	for (auto& testCase : Lumos::Test::GetTestCases())
+	{
+		if (filter && !strstr(testCase.name, filter))
+			continue;
+
+		printf("%s\n", testCase.name);
+
+		const u32 failuresBefore = Lumos::Test::GetFailureCount();
+		Lumos::Timer timer;
+		testCase.func();
+		const float ms = timer.GetMS(1000.0f);
+
+		const bool passed = Lumos::Test::GetFailureCount() == failuresBefore;
+		printf("    %s (%.1f ms)\n", passed ? "passed" : "FAILED", ms);
+
+		run++;
+		if (!passed)
+			failedCases++;
+	}
+
+	printf("%u test cases, %u failed\n", run, failedCases);
+
+	Lumos::System::JobSystem::OnShutdown();
+	Lumos::VFS::OnShutdown();
+	Lumos::Debug::Log::OnRelease();
+	return static_cast<int>(Lumos::Test::GetFailureCount());
+}
@@ -0,0 +1,403 @@
+#include "Test.h"
+#include "Maths/BVH.h"
+#include "Utilities/Timer.h"
+
+#include <random>
+
+using namespace Lumos;
+using namespace Lumos::Maths;
+
+namespace
+{
+	struct Soup
+	{
+		std::vector<Vector3> vertices;
+		std::vector<u32> indices;
+
+		u32 GetTriangleCount() const { return static_cast<u32>(indices.size() / 3); }
+		const Vector3& GetVertex(u32 triangle, u32 corner) const { return vertices[indices[triangle * 3 + corner]]; }
+
+		void Add(const Vector3& v0, const Vector3& v1, const Vector3& v2)
+		{
+			for (auto& v : { v0, v1, v2 })
+			{
+				indices.push_back(static_cast<u32>(vertices.size()));
+				vertices.push_back(v);
+			}
+		}
+
+		void Build(TriangleBVH& bvh) const
+		{
+			bvh.Build(vertices.data(), sizeof(Vector3), indices.data(), static_cast<u32>(indices.size()));
+		}
+	};
+
+	// Triangles up to size across, scattered through a cube of half width extent
+	Soup CreateSoup(u32 count, float extent, float size, u32 seed)
+	{
+		std::mt19937 engine(seed);
+		std::uniform_real_distribution<float> position(-extent, extent);
+		std::uniform_real_distribution<float> offset(-size * 0.5f, size * 0.5f);
+
+		Soup soup;
+		for (u32 i = 0; i < count; i++)
+		{
+			const Vector3 centre(position(engine), position(engine), position(engine));
+			soup.Add(centre + Vector3(offset(engine), offset(engine), offset(engine)), centre + Vector3(offset(engine), offset(engine), offset(engine)),
+				centre + Vector3(offset(engine), offset(engine), offset(engine)));
+		}
+		return soup;
+	}
+
+	// Rays from a shell around the cube towards points inside it, about half of them start inside
+	std::vector<Ray> CreateRays(u32 count, float extent, u32 seed)
+	{
+		std::mt19937 engine(seed);
+		std::uniform_real_distribution<float> position(-extent, extent);
+
+		std::vector<Ray> rays;
+		for (u32 i = 0; i < count; i++)
+		{
+			const Vector3 target(position(engine), position(engine), position(engine));
+			const Vector3 origin = i % 2 ? Vector3(position(engine), position(engine), position(engine)) * 2.0f : Vector3(position(engine), position(engine), position(engine));
+			rays.emplace_back(origin, target - origin);
+		}
+		return rays;
+	}
+
+	// Ray::HitDistance culls back faces, so both windings are tried
+	float HitDistance(const Ray& ray, const Vector3& v0, const Vector3& v1, const Vector3& v2)
+	{
+		return Min(ray.HitDistance(v0, v1, v2), ray.HitDistance(v0, v2, v1));
+	}
+
+	float BruteForce(const Soup& soup, const Ray& ray)
+	{
+		float closest = M_INFINITY;
+		for (u32 i = 0; i < soup.GetTriangleCount(); i++)
+			closest = Min(closest, HitDistance(ray, soup.GetVertex(i, 0), soup.GetVertex(i, 1), soup.GetVertex(i, 2)));
+		return closest;
+	}
+
+	float BruteForce(const std::vector<BoundingBox>& boxes, const Ray& ray)
+	{
+		float closest = M_INFINITY;
+		for (auto& box : boxes)
+			closest = Min(closest, ray.HitDistance(box));
+		return closest;
+	}
+
+	bool Close(float a, float b)
+	{
+		if (a == M_INFINITY || b == M_INFINITY)
+			return a == b;
+		return Abs(a - b) <= 1e-4f * Max(1.0f, Abs(b));
+	}
+
+	// Closest box hit through the tree, testing the boxes in each leaf the way a caller would
+	float Traverse(const BVH& bvh, const std::vector<BoundingBox>& boxes, const Ray& ray)
+	{
+		float closest = M_INFINITY;
+		bvh.Traverse(ray, closest, [&](u32 first, u32 count, float& maxDistance)
+		{
+			for (u32 i = first; i < first + count; i++)
+				maxDistance = Min(maxDistance, ray.HitDistance(boxes[bvh.GetIndices()[i]]));
+			return false;
+		});
+		return closest;
+	}
+
+	bool Contains(const BVH::Node& node, const Vector3& min, const Vector3& max)
+	{
+		return node.min.x <= min.x && node.min.y <= min.y && node.min.z <= min.z && node.max.x >= max.x && node.max.y >= max.y && node.max.z >= max.z;
+	}
+
+	// Counts nodes that don't bound what is below them, and indices that are missing or repeated
+	u32 CountErrors(const BVH& bvh, const std::vector<BoundingBox>& boxes)
+	{
+		const auto& nodes = bvh.GetNodes();
+		const auto& indices = bvh.GetIndices();
+		u32 errors = 0;
+
+		std::vector<u32> seen(boxes.size());
+		for (u32 index : indices)
+			seen[index]++;
+		for (u32 count : seen)
+			errors += count != 1;
+
+		for (u32 i = 0; i < nodes.size(); i++)
+		{
+			const auto& node = nodes[i];
+			if (node.count > 0)
+			{
+				for (u32 j = node.first; j < node.first + node.count; j++)
+					errors += !Contains(node, boxes[indices[j]].min_, boxes[indices[j]].max_);
+			}
+			else
+			{
+				// Children always come after their parent, Refit relies on it
+				errors += node.first <= i;
+				errors += !Contains(node, nodes[node.first].min, nodes[node.first].max);
+				errors += !Contains(node, nodes[node.first + 1].min, nodes[node.first + 1].max);
+			}
+		}
+		return errors;
+	}
+
+	void GetTreeShape(const BVH& bvh, u32& maxDepth, u32& maxLeafSize, u32& leafPrimitives)
+	{
+		const auto& nodes = bvh.GetNodes();
+		maxDepth = maxLeafSize = leafPrimitives = 0;
+
+		std::vector<std::pair<u32, u32>> pending = { { 0, 0 } };
+		while (!pending.empty())
+		{
+			const auto [index, depth] = pending.back();
+			pending.pop_back();
+			maxDepth = Max(maxDepth, depth);
+
+			const auto& node = nodes[index];
+			if (node.count > 0)
+			{
+				maxLeafSize = Max(maxLeafSize, node.count);
+				leafPrimitives += node.count;
+				continue;
+			}
+			pending.emplace_back(node.first, depth + 1);
+			pending.emplace_back(node.first + 1, depth + 1);
+		}
+	}
+
+	// Expected cost of a random ray that hits the root, one per node visited plus one per primitive tested
+	float GetSAHCost(const BVH& bvh)
+	{
+		auto halfArea = [](const BVH::Node& node) { const Vector3 e = node.max - node.min; return e.x * e.y + e.y * e.z + e.z * e.x; };
+		const auto& nodes = bvh.GetNodes();
+
+		float cost = 0.0f;
+		for (auto& node : nodes)
+			cost += halfArea(node) * (node.count > 0 ? float(node.count) : 1.0f);
+		return cost / halfArea(nodes[0]);
+	}
+
+	std::vector<BoundingBox> GetBounds(const Soup& soup)
+	{
+		std::vector<BoundingBox> boxes(soup.GetTriangleCount());
+		for (u32 i = 0; i < soup.GetTriangleCount(); i++)
+		{
+			boxes[i].Define(soup.GetVertex(i, 0));
+			boxes[i].Merge(soup.GetVertex(i, 1));
+			boxes[i].Merge(soup.GetVertex(i, 2));
+		}
+		return boxes;
+	}
+
+	// Compares closest hits, any hits and the packet against brute force, returns the number of mismatches
+	u32 CompareWithBruteForce(const Soup& soup, const TriangleBVH& bvh, const std::vector<Ray>& rays, u32& hits)
+	{
+		u32 mismatches = 0;
+		hits = 0;
+
+		std::vector<RayHit> packet(rays.size());
+		bvh.Raycast(rays.data(), static_cast<u32>(rays.size()), packet.data());
+
+		for (size_t r = 0; r < rays.size(); r++)
+		{
+			const Ray& ray = rays[r];
+			const float expected = BruteForce(soup, ray);
+
+			RayHit hit;
+			const bool found = bvh.Raycast(ray, hit);
+			mismatches += found != (expected != M_INFINITY) || !Close(hit.distance, expected);
+			mismatches += bvh.AnyHit(ray) != found;
+			mismatches += packet[r].distance != hit.distance || packet[r].primitive != hit.primitive;
+
+			if (!found)
+				continue;
+
+			hits++;
+
+			// The primitive, barycentric coordinates and normal all describe the same point
+			const Vector3& v0 = soup.GetVertex(hit.primitive, 0);
+			const Vector3 point = v0 + (soup.GetVertex(hit.primitive, 1) - v0) * hit.barycentric.x + (soup.GetVertex(hit.primitive, 2) - v0) * hit.barycentric.y;
+			mismatches += (point - ray.origin_ - ray.direction_ * hit.distance).Length() > 1e-3f;
+			mismatches += !Close(HitDistance(ray, v0, soup.GetVertex(hit.primitive, 1), soup.GetVertex(hit.primitive, 2)), hit.distance);
+			mismatches += Abs(hit.normal.Length() - 1.0f) > 1e-4f || hit.normal.DotProduct(ray.direction_) > 0.0f;
+
+			// Limited to just short of the hit, or to past it
+			RayHit limited;
+			mismatches += bvh.Raycast(ray, limited, hit.distance * 0.999f - 1e-4f);
+			mismatches += bvh.AnyHit(ray, hit.distance * 0.999f - 1e-4f);
+			mismatches += !bvh.AnyHit(ray, hit.distance * 1.001f + 1e-4f);
+		}
+
+		return mismatches;
+	}
+}
+
+TEST_CASE("BVH SAH build bounds every primitive and keeps leaves small")
+{
+	const Soup soup = CreateSoup(20000, 50.0f, 2.0f, 1);
+	const std::vector<BoundingBox> boxes = GetBounds(soup);
+
+	BVH bvh;
+	Timer timer;
+	const float start = timer.GetMS(1000.0f);
+	bvh.Build(boxes.data(), static_cast<u32>(boxes.size()));
+	const float buildTime = timer.GetMS(1000.0f) - start;
+
+	u32 maxDepth, maxLeafSize, leafPrimitives;
+	GetTreeShape(bvh, maxDepth, maxLeafSize, leafPrimitives);
+	const float cost = GetSAHCost(bvh);
+
+	printf("    %zu boxes, %zu nodes, depth %u, SAH cost %.1f, build %.2f ms\n", boxes.size(), bvh.GetNodes().size(), maxDepth, cost, buildTime);
+	CHECK(CountErrors(bvh, boxes) == 0);
+	CHECK(leafPrimitives == boxes.size());
+	CHECK(maxLeafSize <= 4);
+	CHECK(bvh.GetNodes().size() < boxes.size() * 2);
+
+	// Testing every box costs 20000, a sound tree over evenly spread boxes needs a few hundredths of that
+	CHECK(cost < 300.0f);
+
+	const std::vector<Ray> rays = CreateRays(500, 50.0f, 2);
+	u32 mismatches = 0;
+	for (auto& ray : rays)
+		mismatches += !Close(Traverse(bvh, boxes, ray), BruteForce(boxes, ray));
+	CHECK(mismatches == 0);
+
+	bvh.Clear();
+	CHECK(bvh.Empty());
+	CHECK(Traverse(bvh, boxes, rays[0]) == M_INFINITY);
+}
+
+TEST_CASE("BVH ray casts match brute force over a triangle soup")
+{
+	const Soup soup = CreateSoup(5000, 50.0f, 4.0f, 3);
+	TriangleBVH bvh;
+	soup.Build(bvh);
+	CHECK(bvh.GetTriangleCount() == soup.GetTriangleCount());
+
+	// 600 is not a multiple of the packet size, the last packet is partly empty
+	const std::vector<Ray> rays = CreateRays(600, 50.0f, 4);
+	u32 hits;
+	const u32 mismatches = CompareWithBruteForce(soup, bvh, rays, hits);
+
+	printf("    %u of %zu rays hit\n", hits, rays.size());
+	CHECK(hits > rays.size() / 4);
+	CHECK(hits < rays.size());
+	CHECK(mismatches == 0);
+
+	// A 64 ray packet from one point, the case the packet path is for
+	std::vector<Ray> camera;
+	for (u32 i = 0; i < 64; i++)
+		camera.emplace_back(Vector3(0.0f, 0.0f, 120.0f), Vector3(float(i % 8) * 0.05f - 0.2f, float(i / 8) * 0.05f - 0.2f, -1.0f));
+	CHECK(CompareWithBruteForce(soup, bvh, camera, hits) == 0);
+	CHECK(hits > 0);
+
+	// Empty trees hit nothing
+	TriangleBVH empty;
+	RayHit hit;
+	CHECK(!empty.Raycast(rays[0], hit));
+	CHECK(!empty.AnyHit(rays[0]));
+	empty.Raycast(rays.data(), 1, &hit);
+	CHECK(!hit.Hit());
+}
+
+TEST_CASE("BVH refit follows moved primitives")
+{
+	std::vector<BoundingBox> boxes = GetBounds(CreateSoup(4000, 30.0f, 3.0f, 5));
+
+	BVH bvh;
+	bvh.Build(boxes.data(), static_cast<u32>(boxes.size()));
+	const size_t nodeCount = bvh.GetNodes().size();
+	const std::vector<u32> order = bvh.GetIndices();
+
+	// Far enough that most boxes end up outside their old parents, some grow as well
+	std::mt19937 engine(6);
+	std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> grow(0.0f, 2.0f);
+	for (auto& box : boxes)
+	{
+		const Vector3 move(offset(engine), offset(engine), offset(engine));
+		box = BoundingBox(box.min_ + move, box.max_ + move + Vector3(grow(engine), grow(engine), grow(engine)));
+	}
+
+	bvh.Refit(boxes.data());
+	CHECK(CountErrors(bvh, boxes) == 0);
+	CHECK(bvh.GetNodes().size() == nodeCount);
+	CHECK(bvh.GetIndices() == order);
+
+	u32 mismatches = 0;
+	for (auto& ray : CreateRays(500, 40.0f, 7))
+		mismatches += !Close(Traverse(bvh, boxes, ray), BruteForce(boxes, ray));
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE("BVH keeps primitives with one centroid in a single leaf")
+{
+	// Every triangle's bounds are centred on the origin, there is nothing to split on
+	std::mt19937 engine(8);
+	std::uniform_real_distribution<float> size(0.5f, 20.0f);
+	Soup soup;
+	for (u32 i = 0; i < 300; i++)
+	{
+		const float x = size(engine), y = size(engine), z = size(engine);
+		soup.Add(Vector3(-x, -y, z), Vector3(x, -y, -z), Vector3(0.0f, y, 0.0f));
+	}
+
+	const std::vector<BoundingBox> boxes = GetBounds(soup);
+	BVH bvh;
+	bvh.Build(boxes.data(), static_cast<u32>(boxes.size()));
+	REQUIRE(bvh.GetNodes().size() == 1);
+	CHECK(bvh.GetNodes()[0].count == boxes.size());
+	CHECK(CountErrors(bvh, boxes) == 0);
+
+	TriangleBVH triangles;
+	soup.Build(triangles);
+	CHECK(triangles.GetNodeCount() == 1);
+
+	u32 hits;
+	CHECK(CompareWithBruteForce(soup, triangles, CreateRays(200, 20.0f, 9), hits) == 0);
+	CHECK(hits > 0);
+}
+
+TEST_CASE("BVH depth stays within the traversal stack")
+{
+	// Segments end to end along a line have no area, so every split costs nothing and the first
+	// one, peeling a sixteenth off the end, wins. Left alone that would go well past the cap
+	const u32 count = 2000;
+	std::vector<BoundingBox> boxes;
+	for (u32 i = 0; i < count; i++)
+		boxes.emplace_back(Vector3(float(i), 0.0f, 0.0f), Vector3(float(i + 1), 0.0f, 0.0f));
+
+	BVH bvh;
+	bvh.Build(boxes.data(), count);
+
+	u32 maxDepth, maxLeafSize, leafPrimitives;
+	GetTreeShape(bvh, maxDepth, maxLeafSize, leafPrimitives);
+	printf("    depth %u, largest leaf %u\n", maxDepth, maxLeafSize);
+
+	// The cap was reached, what is below it stays in one larger leaf
+	CHECK(maxDepth == 60);
+	CHECK(maxLeafSize > 4);
+	CHECK(leafPrimitives == count);
+	CHECK(CountErrors(bvh, boxes) == 0);
+
+	// One ray across the middle of each segment reaches the leaf holding it, the capped one included.
+	// The y and z slabs give the same entry and exit for every node, so only the x slab decides
+	u32 missed = 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		const Ray ray(Vector3(float(i) + 0.5f, -1.0f, -1.0f), Vector3(0.0f, 1.0f, 1.0f));
+		float maxDistance = M_INFINITY;
+		bool found = false;
+		bvh.Traverse(ray, maxDistance, [&](u32 first, u32 leafCount, float&)
+		{
+			for (u32 j = first; j < first + leafCount; j++)
+				found |= bvh.GetIndices()[j] == i;
+			return found;
+		});
+		missed += !found;
+	}
+	CHECK(missed == 0);
+}
@@ -0,0 +1,330 @@
+#include "Test.h"
+#include "Physics/LumosPhysicsEngine/CollisionDetection.h"
+#include "Physics/LumosPhysicsEngine/CuboidCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/SphereCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/PyramidCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/CapsuleCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/HullCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/PhysicsObject3D.h"
+
+#include <random>
+
+using namespace Lumos;
+
+namespace
+{
+	enum ShapeKind
+	{
+		Cuboid,
+		Sphere,
+		Pyramid,
+		Prism,
+		Capsule,
+		ShapeKindCount
+	};
+
+	const char* ShapeNames[ShapeKindCount] = { "cuboid", "sphere", "pyramid", "prism", "capsule" };
+
+	// Below this depth a contact is grazing, and which side of zero each test lands on is rounding
+	const float GrazingDepth = 1e-3f;
+
+	// Deepest overlap a resting or impact contact normally reaches
+	const float ContactDepth = 0.25f;
+
+	class Random
+	{
+	public:
+		explicit Random(u32 seed) : m_Engine(seed) {}
+
+		float Range(float min, float max) { return std::uniform_real_distribution<float>(min, max)(m_Engine); }
+		Maths::Vector3 Position(float extent) { return Maths::Vector3(Range(-extent, extent), Range(-extent, extent), Range(-extent, extent)); }
+
+		Maths::Quaternion Orientation()
+		{
+			Maths::Quaternion q(Range(-1.0f, 1.0f), Range(-1.0f, 1.0f), Range(-1.0f, 1.0f), Range(-1.0f, 1.0f));
+			q.Normalize();
+			return q;
+		}
+
+	private:
+		std::mt19937 m_Engine;
+	};
+
+	// Sixteen sided prism, a hull with faces that no other shape type covers
+	Ref<Hull> BuildPrism(float radius, float halfHeight)
+	{
+		const int sides = 16;
+		auto hull = CreateRef<Hull>();
+
+		for (int i = 0; i < sides; i++)
+		{
+			const float angle = i * Maths::M_PI * 2.0f / sides;
+			hull->AddVertex(Maths::Vector3(radius * cosf(angle), -halfHeight, radius * sinf(angle)));
+		}
+		for (int i = 0; i < sides; i++)
+		{
+			const float angle = i * Maths::M_PI * 2.0f / sides;
+			hull->AddVertex(Maths::Vector3(radius * cosf(angle), halfHeight, radius * sinf(angle)));
+		}
+
+		std::vector<int> bottom, top;
+		for (int i = 0; i < sides; i++)
+		{
+			bottom.push_back(i);
+			top.push_back(2 * sides - 1 - i);
+		}
+		hull->AddFace(Maths::Vector3(0.0f, -1.0f, 0.0f), bottom);
+		hull->AddFace(Maths::Vector3(0.0f, 1.0f, 0.0f), top);
+
+		for (int i = 0; i < sides; i++)
+		{
+			const int next = (i + 1) % sides;
+			const float angle = (i + 0.5f) * Maths::M_PI * 2.0f / sides;
+			int face[4] = { i, sides + i, sides + next, next };
+			hull->AddFace(Maths::Vector3(cosf(angle), 0.0f, sinf(angle)), 4, face);
+		}
+
+		return hull;
+	}
+
+	Ref<CollisionShape> CreateShape(ShapeKind kind, Random& random)
+	{
+		switch (kind)
+		{
+		case Cuboid		: return CreateRef<CuboidCollisionShape>(Maths::Vector3(random.Range(0.2f, 1.5f), random.Range(0.2f, 1.5f), random.Range(0.2f, 1.5f)));
+		case Sphere		: return CreateRef<SphereCollisionShape>(random.Range(0.2f, 1.5f));
+		case Pyramid	: return CreateRef<PyramidCollisionShape>(Maths::Vector3(random.Range(0.3f, 1.5f), random.Range(0.3f, 1.5f), random.Range(0.3f, 1.5f)));
+		case Prism		: return CreateRef<HullCollisionShape>(BuildPrism(random.Range(0.3f, 1.5f), random.Range(0.3f, 1.5f)));
+		default			: return CreateRef<CapsuleCollisionShape>(random.Range(0.2f, 1.0f), random.Range(0.2f, 2.0f));
+		}
+	}
+
+	void Place(PhysicsObject3D& object, const Ref<CollisionShape>& shape, Random& random)
+	{
+		object.SetCollisionShape(shape);
+		object.SetPosition(random.Position(1.6f));
+		object.SetOrientation(random.Orientation());
+	}
+
+	// Depth of the overlap along an axis, from the shapes' extents on it
+	float OverlapOnAxis(const PhysicsObject3D& a, const PhysicsObject3D& b, const Maths::Vector3& axis)
+	{
+		Maths::Vector3 minA, maxA, minB, maxB;
+		a.GetCollisionShape()->GetMinMaxVertexOnAxis(&a, axis, &minA, &maxA);
+		b.GetCollisionShape()->GetMinMaxVertexOnAxis(&b, axis, &minB, &maxB);
+		return Maths::Min(axis.DotProduct(maxA) - axis.DotProduct(minB), axis.DotProduct(maxB) - axis.DotProduct(minA));
+	}
+
+	// True if moving b along the contact normal by the depth plus a little separates the pair
+	bool Resolves(const PhysicsObject3D& a, const PhysicsObject3D& b, const CollisionData& contact)
+	{
+		PhysicsObject3D moved = b;
+		moved.SetPosition(b.GetPosition() + contact.normal * (-contact.penetration + 2e-3f));
+		return !CollisionDetection::Instance()->CheckCollision(&a, &moved, a.GetCollisionShape().get(), b.GetCollisionShape().get());
+	}
+
+	Maths::Vector3 ClosestPointOnSegment(const Maths::Vector3& point, const Maths::Vector3& start, const Maths::Vector3& end)
+	{
+		const Maths::Vector3 segment = end - start;
+		const float t = Maths::Clamp((point - start).DotProduct(segment) / segment.LengthSquared(), 0.0f, 1.0f);
+		return start + segment * t;
+	}
+
+	// Segment to segment distance, refined from the closest point on each to the other
+	float SegmentDistance(const Maths::Vector3& p0, const Maths::Vector3& p1, const Maths::Vector3& q0, const Maths::Vector3& q1)
+	{
+		float best = FLT_MAX;
+		const int steps = 64;
+		for (int i = 0; i <= steps; i++)
+		{
+			const Maths::Vector3 p = p0 + (p1 - p0) * (float(i) / steps);
+			const Maths::Vector3 q = ClosestPointOnSegment(p, q0, q1);
+			const Maths::Vector3 refined = ClosestPointOnSegment(q, p0, p1);
+			best = Maths::Min(best, (ClosestPointOnSegment(refined, q0, q1) - refined).Length());
+		}
+		return best;
+	}
+
+	void CapsuleSegment(const PhysicsObject3D& object, const CapsuleCollisionShape& capsule, Maths::Vector3& start, Maths::Vector3& end)
+	{
+		const Maths::Vector3 axis = object.GetOrientation().RotationMatrix() * Maths::Vector3(0.0f, 1.0f, 0.0f);
+		start = object.GetPosition() - axis * (capsule.GetHeight() * 0.5f);
+		end = object.GetPosition() + axis * (capsule.GetHeight() * 0.5f);
+	}
+}
+
+TEST_CASE("GJK / EPA agrees with SAT for every polyhedron and sphere pair")
+{
+	auto detection = CollisionDetection::Instance();
+	Random random(1234);
+
+	for (int kindA = Cuboid; kindA < Capsule; kindA++)
+	{
+		for (int kindB = kindA; kindB < Capsule; kindB++)
+		{
+			u32 hits = 0, compared = 0, mismatches = 0, depthMismatches = 0, normalMismatches = 0, unresolved = 0;
+
+			for (u32 trial = 0; trial < 1000; trial++)
+			{
+				PhysicsObject3D a, b;
+				Place(a, CreateShape(ShapeKind(kindA), random), random);
+				Place(b, CreateShape(ShapeKind(kindB), random), random);
+
+				CollisionData gjk, sat;
+				const bool gjkHit = detection->CheckCollision(&a, &b, a.GetCollisionShape().get(), b.GetCollisionShape().get(), &gjk);
+				const bool satHit = detection->CheckCollisionSAT(&a, &b, a.GetCollisionShape().get(), b.GetCollisionShape().get(), &sat);
+
+				// The early out without contact data must give the same answer
+				if (gjkHit != detection->CheckCollision(&a, &b, a.GetCollisionShape().get(), b.GetCollisionShape().get()))
+					mismatches++;
+
+				if (gjkHit != satHit)
+				{
+					if (satHit)
+					{
+						// GJK found them apart, the axis between its closest points must separate them
+						Maths::Vector3 pointOnA, pointOnB;
+						detection->GetDistance(&a, &b, a.GetCollisionShape().get(), b.GetCollisionShape().get(), &pointOnA, &pointOnB);
+						if (OverlapOnAxis(a, b, (pointOnB - pointOnA).Normalized()) > GrazingDepth)
+							mismatches++;
+					}
+					else if (-gjk.penetration > GrazingDepth)
+						mismatches++;
+					continue;
+				}
+
+				if (!gjkHit)
+					continue;
+
+				hits++;
+
+				// EPA's depth is the overlap along its own normal and never deeper than along SAT's axis. SAT can
+				// report its axis pointing the long way through a deep overlap, so that is measured both ways.
+				const float gjkDepth = -gjk.penetration;
+				const float satAxisDepth = OverlapOnAxis(a, b, sat.normal);
+				if (std::abs(gjkDepth - OverlapOnAxis(a, b, gjk.normal)) > 1e-3f || gjkDepth > satAxisDepth + 1e-3f)
+					depthMismatches++;
+
+				// At contact depths both find the same axis, unless another separates by the same depth. Deep
+				// overlaps are left out, SAT's candidate axes miss the minimum there and EPA finds a shallower one.
+				if (satAxisDepth < ContactDepth)
+				{
+					compared++;
+					if (std::abs(gjk.normal.DotProduct(sat.normal)) < 0.999f && std::abs(gjkDepth - satAxisDepth) > 1e-3f)
+						normalMismatches++;
+				}
+
+				if (!Resolves(a, b, gjk))
+					unresolved++;
+			}
+
+			if (mismatches + depthMismatches + normalMismatches + unresolved > 0)
+				printf("    %s vs %s: %u hits, %u compared, %u hit mismatches, %u depth, %u normal, %u unresolved\n", ShapeNames[kindA], ShapeNames[kindB], hits, compared, mismatches, depthMismatches, normalMismatches, unresolved);
+
+			CHECK(hits > 100);
+			CHECK(compared > 50);
+			CHECK(mismatches == 0);
+			CHECK(depthMismatches == 0);
+			CHECK(normalMismatches == 0);
+			CHECK(unresolved == 0);
+		}
+	}
+}
+
+TEST_CASE("GJK / EPA matches the analytic distance for capsules")
+{
+	auto detection = CollisionDetection::Instance();
+	Random random(5678);
+
+	for (int kind : { Sphere, Capsule })
+	{
+		u32 hits = 0, mismatches = 0;
+
+		for (u32 trial = 0; trial < 1000; trial++)
+		{
+			PhysicsObject3D a, b;
+			auto capsule = CreateRef<CapsuleCollisionShape>(random.Range(0.2f, 1.0f), random.Range(0.2f, 2.0f));
+			Place(a, capsule, random);
+			Place(b, CreateShape(ShapeKind(kind), random), random);
+
+			Maths::Vector3 p0, p1, q0, q1;
+			CapsuleSegment(a, *capsule, p0, p1);
+
+			float expected = 0.0f;
+			if (kind == Sphere)
+				expected = (ClosestPointOnSegment(b.GetPosition(), p0, p1) - b.GetPosition()).Length() - capsule->GetRadius() - static_cast<SphereCollisionShape*>(b.GetCollisionShape().get())->GetRadius();
+			else
+			{
+				auto other = static_cast<CapsuleCollisionShape*>(b.GetCollisionShape().get());
+				CapsuleSegment(b, *other, q0, q1);
+				expected = SegmentDistance(p0, p1, q0, q1) - capsule->GetRadius() - other->GetRadius();
+			}
+
+			CollisionData contact;
+			const bool hit = detection->CheckCollision(&a, &b, capsule.get(), b.GetCollisionShape().get(), &contact);
+
+			if (std::abs(expected) < GrazingDepth)
+				continue;
+
+			if (hit != (expected < 0.0f))
+				mismatches++;
+			else if (hit)
+			{
+				hits++;
+				if (std::abs(-contact.penetration + expected) > 2e-3f || !Resolves(a, b, contact))
+					mismatches++;
+			}
+			else if (std::abs(detection->GetDistance(&a, &b, capsule.get(), b.GetCollisionShape().get()) - expected) > 2e-3f)
+				mismatches++;
+		}
+
+		if (mismatches > 0)
+			printf("    capsule vs %s: %u hits, %u mismatches\n", ShapeNames[kind], hits, mismatches);
+
+		CHECK(hits > 100);
+		CHECK(mismatches == 0);
+	}
+}
+
+TEST_CASE("GJK / EPA contacts between capsules and polyhedra are minimal")
+{
+	// SAT has no capsule support, so the contact is checked by moving the pair apart along it:
+	// a little past the depth separates them, a little short of it does not
+	auto detection = CollisionDetection::Instance();
+	Random random(91011);
+
+	for (int kind : { Cuboid, Pyramid, Prism })
+	{
+		u32 hits = 0, unresolved = 0, tooDeep = 0;
+
+		for (u32 trial = 0; trial < 1000; trial++)
+		{
+			PhysicsObject3D a, b;
+			Place(a, CreateShape(Capsule, random), random);
+			Place(b, CreateShape(ShapeKind(kind), random), random);
+
+			CollisionData contact;
+			if (!detection->CheckCollision(&a, &b, a.GetCollisionShape().get(), b.GetCollisionShape().get(), &contact))
+				continue;
+
+			hits++;
+			if (!Resolves(a, b, contact))
+				unresolved++;
+
+			if (-contact.penetration > 4e-3f)
+			{
+				PhysicsObject3D moved = b;
+				moved.SetPosition(b.GetPosition() + contact.normal * (-contact.penetration - 2e-3f));
+				if (!detection->CheckCollision(&a, &moved, a.GetCollisionShape().get(), b.GetCollisionShape().get()))
+					tooDeep++;
+			}
+		}
+
+		if (unresolved + tooDeep > 0)
+			printf("    capsule vs %s: %u hits, %u unresolved, %u deeper than needed\n", ShapeNames[kind], hits, unresolved, tooDeep);
+
+		CHECK(hits > 100);
+		CHECK(unresolved == 0);
+		CHECK(tooDeep == 0);
+	}
+}
@@ -0,0 +1,120 @@
+#include "Test.h"
+#include "Physics/LumosPhysicsEngine/LumosPhysicsEngine.h"
+#include "Physics/LumosPhysicsEngine/CuboidCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/SphereCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/CapsuleCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/SortAndSweepBroadphase.h"
+
+using namespace Lumos;
+
+namespace
+{
+	// Steps the engine without a scene
+	class TestPhysicsEngine : public LumosPhysicsEngine
+	{
+	public:
+		void Step() { UpdatePhysics(nullptr); }
+		void Add(const Ref<PhysicsObject3D>& object) { m_PhysicsObjects.push_back(object); }
+	};
+
+	enum ShapeKind
+	{
+		Sphere,
+		Cuboid,
+		Capsule,
+		ShapeKindCount
+	};
+
+	const char* ShapeNames[ShapeKindCount] = { "sphere", "cube", "capsule" };
+
+	const float Speeds[] = { 50.0f, 200.0f, 1000.0f, 5000.0f };
+
+	// 5cm thick walls, far thinner than any of these speeds covers in a step
+	const float WallX = 5.0f;
+	const float WallSpacing = 3.0f;
+	const float WallThickness = 0.05f;
+
+	Ref<PhysicsObject3D> CreateWall(float x)
+	{
+		auto wall = CreateRef<PhysicsObject3D>();
+		wall->SetCollisionShape(CreateRef<CuboidCollisionShape>(Maths::Vector3(WallThickness * 0.5f, 5.0f, 5.0f)));
+		wall->SetPosition(Maths::Vector3(x, 0.0f, 0.0f));
+		wall->SetIsStatic(true);
+		wall->SetInverseMass(0.0f);
+		wall->SetInverseInertia(Maths::Matrix3::ZERO);
+		return wall;
+	}
+
+	Ref<CollisionShape> CreateShape(ShapeKind kind)
+	{
+		switch (kind)
+		{
+		case Sphere: return CreateRef<SphereCollisionShape>(0.1f);
+		case Cuboid: return CreateRef<CuboidCollisionShape>(Maths::Vector3(0.1f));
+		default: return CreateRef<CapsuleCollisionShape>(0.05f, 0.2f);
+		}
+	}
+
+	// Fires a body at the walls and returns the furthest its centre got
+	float Fire(ShapeKind kind, float speed, bool continuous, u32 wallCount)
+	{
+		TestPhysicsEngine engine;
+		engine.SetBroadphase(CreateRef<SortAndSweepBroadphase>());
+		engine.SetGravity(Maths::Vector3(0.0f));
+		engine.SetIntegrationType(IntegrationType::SEMI_IMPLICIT_EULER);
+
+		for (u32 i = 0; i < wallCount; i++)
+			engine.Add(CreateWall(WallX + i * WallSpacing));
+
+		auto shape = CreateShape(kind);
+		auto body = CreateRef<PhysicsObject3D>();
+		body->SetCollisionShape(shape);
+		body->SetInverseMass(1.0f);
+		body->SetInverseInertia(shape->BuildInverseInertia(1.0f));
+		body->SetPosition(Maths::Vector3(0.0f, 0.3f, 0.2f));
+		body->SetOrientation(Maths::Quaternion::EulerAnglesToQuaternion(10.0f, 20.0f, 30.0f));
+		body->SetLinearVelocity(Maths::Vector3(speed, 0.0f, 0.0f));
+		body->SetRestVelocityThreshold(0.0f);
+		body->SetContinuousCollision(continuous);
+		engine.Add(body);
+
+		float furthest = body->GetPosition().x;
+		for (u32 i = 0; i < 120; i++)
+		{
+			engine.Step();
+			furthest = std::max(furthest, body->GetPosition().x);
+		}
+
+		return furthest;
+	}
+}
+
+TEST_CASE("Fast bodies pass through a thin wall without continuous collision")
+{
+	for (u32 kind = 0; kind < ShapeKindCount; kind++)
+	{
+		for (float speed : Speeds)
+		{
+			const float furthest = Fire(ShapeKind(kind), speed, false, 1);
+			if (!CHECK(furthest > WallX + 1.0f))
+				printf("    %s at %.0f m/s stopped at %.2f\n", ShapeNames[kind], speed, furthest);
+		}
+	}
+}
+
+TEST_CASE("Continuous collision stops fast bodies at a thin wall")
+{
+	for (u32 kind = 0; kind < ShapeKindCount; kind++)
+	{
+		for (float speed : Speeds)
+		{
+			// A second and third wall behind the first must not pull the sweep past it
+			for (u32 wallCount : { 1u, 3u })
+			{
+				const float furthest = Fire(ShapeKind(kind), speed, true, wallCount);
+				if (!CHECK(furthest < WallX - WallThickness * 0.5f))
+					printf("    %s at %.0f m/s against %u walls reached %.2f\n", ShapeNames[kind], speed, wallCount, furthest);
+			}
+		}
+	}
+}
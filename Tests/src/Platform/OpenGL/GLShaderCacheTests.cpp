@@ -0,0 +1,145 @@
+#include "Test.h"
+
+#ifdef LUMOS_RENDER_API_OPENGL
+#include "Platform/OpenGL/GLShaderCache.h"
+#include "Core/OS/FileSystem.h"
+
+using namespace Lumos;
+using namespace Lumos::Graphics;
+
+namespace
+{
+	const char* CachePath = "ShaderCacheTest.glcache";
+	const char* VertexPath = "ShaderCacheTest.vert";
+	const char* FragmentPath = "ShaderCacheTest.frag";
+
+	const String ShaderSource = "#shader vertex ShaderCacheTest.vert\n#shader fragment ShaderCacheTest.frag\n";
+
+	void WriteText(const String& path, const String& text)
+	{
+		FileSystem::WriteFile(path, reinterpret_cast<u8*>(const_cast<char*>(text.data())), static_cast<u32>(text.size()));
+	}
+
+	// What GLShader::Init would have produced, with a made up program binary
+	GLShaderCacheEntry CreateEntry()
+	{
+		GLShaderCacheEntry entry;
+		entry.stageFiles = { VertexPath, FragmentPath };
+		entry.sourceHash = GLShaderCache::HashSources(ShaderSource, "", entry.stageFiles);
+		entry.sources[ShaderType::VERTEX] = "#version 410\nvoid main() { gl_Position = vec4(0.0); }\n";
+		entry.sources[ShaderType::FRAGMENT] = "#version 410\nout vec4 colour;\nvoid main() { colour = vec4(1.0); }\n";
+		entry.declarations.push_back({ ShaderType::VERTEX, true, "struct Light { vec4 colour; };" });
+		entry.declarations.push_back({ ShaderType::FRAGMENT, false, "uniform sampler2D u_Texture;" });
+		entry.uniformBlocks = { "UniformBufferObject" };
+		entry.driver = "Vendor|Renderer|4.1";
+		entry.binaryFormat = 0x8741;
+		for (u32 i = 0; i < 4096; i++)
+			entry.binary.push_back(static_cast<u8>(i * 7));
+		return entry;
+	}
+
+	bool Equal(const GLShaderCacheEntry& a, const GLShaderCacheEntry& b)
+	{
+		if (a.sourceHash != b.sourceHash || a.stageFiles != b.stageFiles || a.sources != b.sources || a.uniformBlocks != b.uniformBlocks
+			|| a.driver != b.driver || a.binaryFormat != b.binaryFormat || a.binary != b.binary || a.declarations.size() != b.declarations.size())
+			return false;
+
+		for (size_t i = 0; i < a.declarations.size(); i++)
+		{
+			if (a.declarations[i].type != b.declarations[i].type || a.declarations[i].isStruct != b.declarations[i].isStruct || a.declarations[i].statement != b.declarations[i].statement)
+				return false;
+		}
+
+		return true;
+	}
+
+	void RemoveFiles()
+	{
+		std::remove(CachePath);
+		std::remove(VertexPath);
+		std::remove(FragmentPath);
+	}
+}
+
+TEST_CASE("Shader cache entries round trip")
+{
+	WriteText(VertexPath, "void main() {}\n");
+	WriteText(FragmentPath, "void main() {}\n");
+
+	const GLShaderCacheEntry entry = CreateEntry();
+	CHECK(entry.sourceHash != 0);
+	REQUIRE(GLShaderCache::Save(CachePath, entry));
+
+	GLShaderCacheEntry loaded;
+	CHECK(GLShaderCache::Load(CachePath, loaded));
+	CHECK(Equal(entry, loaded));
+	CHECK(loaded.sourceHash == GLShaderCache::HashSources(ShaderSource, "", loaded.stageFiles));
+
+	RemoveFiles();
+}
+
+TEST_CASE("Shader cache is invalidated by edits to the shader or its stages")
+{
+	WriteText(VertexPath, "void main() {}\n");
+	WriteText(FragmentPath, "void main() {}\n");
+
+	const GLShaderCacheEntry entry = CreateEntry();
+
+	CHECK(GLShaderCache::HashSources(ShaderSource + " ", "", entry.stageFiles) != entry.sourceHash);
+
+	// Same size, so only the content can tell them apart
+	WriteText(FragmentPath, "void main() {/\n");
+	CHECK(GLShaderCache::HashSources(ShaderSource, "", entry.stageFiles) != entry.sourceHash);
+
+	WriteText(FragmentPath, "void main() {}\n");
+	CHECK(GLShaderCache::HashSources(ShaderSource, "", entry.stageFiles) == entry.sourceHash);
+
+	// A missing stage can't be validated at all
+	std::remove(VertexPath);
+	CHECK(GLShaderCache::HashSources(ShaderSource, "", entry.stageFiles) == 0);
+
+	RemoveFiles();
+}
+
+TEST_CASE("Truncated or foreign shader caches are rejected")
+{
+	WriteText(VertexPath, "void main() {}\n");
+	WriteText(FragmentPath, "void main() {}\n");
+
+	REQUIRE(GLShaderCache::Save(CachePath, CreateEntry()));
+
+	std::vector<u8> data(static_cast<size_t>(FileSystem::GetFileSize(CachePath)));
+	REQUIRE(FileSystem::ReadFile(CachePath, data.data(), data.size()));
+
+	// Every cut, including ones inside strings and the binary
+	u32 accepted = 0;
+	for (size_t size = 0; size < data.size(); size++)
+	{
+		FileSystem::WriteFile(CachePath, data.data(), static_cast<u32>(size));
+		GLShaderCacheEntry loaded;
+		if (GLShaderCache::Load(CachePath, loaded))
+			accepted++;
+	}
+	CHECK(accepted == 0);
+
+	data[0] ^= 0xff;
+	FileSystem::WriteFile(CachePath, data.data(), static_cast<u32>(data.size()));
+	GLShaderCacheEntry loaded;
+	CHECK(!GLShaderCache::Load(CachePath, loaded));
+
+	RemoveFiles();
+}
+
+TEST_CASE("Shader cache files go in the working directory, one per shader folder")
+{
+	const String core = GLShaderCache::GetCachePath("/CoreShaders/", "Batch2D");
+	CHECK(core == GLShaderCache::GetCachePath("/CoreShaders/", "Batch2D"));
+	CHECK(core.find('/') == String::npos);
+	CHECK(core.compare(0, 8, "Batch2D.") == 0);
+	CHECK(core.compare(core.size() - 8, 8, ".glcache") == 0);
+
+	// Same name in another folder, and another name in the same folder
+	CHECK(core != GLShaderCache::GetCachePath("/Shaders/", "Batch2D"));
+	CHECK(core != GLShaderCache::GetCachePath("/CoreShaders/", "Batch2DPoly"));
+}
+#endif
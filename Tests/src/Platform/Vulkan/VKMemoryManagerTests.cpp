@@ -0,0 +1,152 @@
+#include "Test.h"
+
+#ifdef LUMOS_RENDER_API_VULKAN
+#include "Platform/Vulkan/VKMemoryManager.h"
+
+#include <random>
+
+using namespace Lumos;
+using namespace Lumos::Graphics;
+
+// The block only does the bookkeeping, so it can be tested without a device or any memory behind it
+
+namespace
+{
+	const VkDeviceSize BlockSize = 1024 * 1024;
+
+	struct Range
+	{
+		VkDeviceSize offset;
+		VkDeviceSize size;
+	};
+
+	bool Overlaps(const std::vector<Range>& ranges)
+	{
+		for (size_t i = 0; i < ranges.size(); i++)
+		{
+			for (size_t j = i + 1; j < ranges.size(); j++)
+			{
+				if (ranges[i].offset < ranges[j].offset + ranges[j].size && ranges[j].offset < ranges[i].offset + ranges[i].size)
+					return true;
+			}
+		}
+		return false;
+	}
+}
+
+TEST_CASE("Memory block splits free ranges and keeps alignment")
+{
+	VKMemoryBlock block(VK_NULL_HANDLE, BlockSize, nullptr);
+	CHECK(block.GetFreeRangeCount() == 1);
+	CHECK(block.GetLargestFree() == BlockSize);
+	CHECK(!block.IsDedicated());
+
+	VkDeviceSize a, b;
+	REQUIRE(block.Allocate(100, 1, a));
+	CHECK(a == 0);
+	CHECK(block.GetFreeRangeCount() == 1);
+
+	// The padding in front of an aligned allocation stays free
+	REQUIRE(block.Allocate(256, 256, b));
+	CHECK(b == 256);
+	CHECK(block.GetFreeRangeCount() == 2);
+	CHECK(block.GetUsed() == 356);
+	CHECK(block.GetAllocationCount() == 2);
+	CHECK(block.GetLargestFree() == BlockSize - 512);
+
+	// Best fit puts a small allocation in the padding rather than the large range after it
+	VkDeviceSize c;
+	REQUIRE(block.Allocate(64, 4, c));
+	CHECK(c == 100);
+	CHECK(block.GetFreeRangeCount() == 2);
+
+	VkDeviceSize tooBig;
+	CHECK(!block.Allocate(BlockSize, 1, tooBig));
+	CHECK(block.GetAllocationCount() == 3);
+}
+
+TEST_CASE("Memory block merges neighbouring free ranges")
+{
+	VKMemoryBlock block(VK_NULL_HANDLE, BlockSize, nullptr);
+
+	VkDeviceSize offsets[4];
+	for (auto& offset : offsets)
+		REQUIRE(block.Allocate(1000, 1, offset));
+	CHECK(block.GetFreeRangeCount() == 1);
+
+	// Nothing either side is free yet
+	block.Free(offsets[1], 1000);
+	CHECK(block.GetFreeRangeCount() == 2);
+
+	// Merges with the range before it
+	block.Free(offsets[2], 1000);
+	CHECK(block.GetFreeRangeCount() == 2);
+	CHECK(block.GetLargestFree() == BlockSize - 4000);
+
+	// Merges with the range after it
+	block.Free(offsets[0], 1000);
+	CHECK(block.GetFreeRangeCount() == 2);
+
+	// Merges both sides, back to a single range
+	block.Free(offsets[3], 1000);
+	CHECK(block.GetFreeRangeCount() == 1);
+	CHECK(block.GetLargestFree() == BlockSize);
+	CHECK(block.GetUsed() == 0);
+	CHECK(block.GetAllocationCount() == 0);
+
+	// Freed space is handed out again
+	VkDeviceSize whole;
+	CHECK(block.Allocate(BlockSize, 1, whole));
+	CHECK(whole == 0);
+}
+
+TEST_CASE("Memory block survives random allocation and release")
+{
+	VKMemoryBlock block(VK_NULL_HANDLE, BlockSize, nullptr, true);
+	CHECK(block.IsDedicated());
+
+	std::mt19937 engine(11);
+	std::vector<Range> live;
+	u32 failed = 0;
+
+	for (u32 step = 0; step < 20000; step++)
+	{
+		if (live.empty() || engine() % 3 != 0)
+		{
+			const VkDeviceSize size = 1 + engine() % 8000;
+			const VkDeviceSize alignment = VkDeviceSize(1) << (engine() % 9);
+			VkDeviceSize offset;
+			if (block.Allocate(size, alignment, offset))
+			{
+				CHECK(offset % alignment == 0);
+				CHECK(offset + size <= BlockSize);
+				live.push_back({ offset, size });
+			}
+			else
+				failed++;
+		}
+		else
+		{
+			const size_t index = engine() % live.size();
+			block.Free(live[index].offset, live[index].size);
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+
+	CHECK(failed > 0);
+	CHECK(!Overlaps(live));
+	CHECK(block.GetAllocationCount() == live.size());
+
+	VkDeviceSize used = 0;
+	for (auto& range : live)
+		used += range.size;
+	CHECK(block.GetUsed() == used);
+
+	for (auto& range : live)
+		block.Free(range.offset, range.size);
+
+	CHECK(block.GetFreeRangeCount() == 1);
+	CHECK(block.GetLargestFree() == BlockSize);
+}
+#endif
@@ -0,0 +1,391 @@
+#include "Test.h"
+#include "App/SceneSnapshot.h"
+#include "App/SceneGraph.h"
+#include "ECS/Component/Components.h"
+#include "Scripting/ScriptComponent.h"
+#include "Graphics/Light.h"
+#include "Graphics/Mesh.h"
+#include "Graphics/Material.h"
+#include "Graphics/Camera/Camera.h"
+#include "Physics/LumosPhysicsEngine/CuboidCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/SphereCollisionShape.h"
+#include "Physics/LumosPhysicsEngine/CapsuleCollisionShape.h"
+#include "Maths/Transform.h"
+#include "Core/OS/FileSystem.h"
+
+using namespace Lumos;
+
+namespace
+{
+	// Layout of the snapshot file, kept here so the tests can write what an older or newer build would
+	struct FileHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 chunkCount;
+		u32 entityCount;
+	};
+
+	struct FileChunkHeader
+	{
+		u32 id;
+		u32 version;
+		u32 count;
+		u32 size;
+	};
+
+	const char* SnapshotPath = "SnapshotTest.lmss";
+
+	// One or more of every component type the snapshot saves, with a recycled entity so versions matter
+	void BuildScene(entt::registry& registry, Ref<Graphics::Mesh>& mesh, Ref<Material>& material)
+	{
+		std::vector<entt::entity> entities;
+		for (u32 i = 0; i < 8; i++)
+			entities.push_back(registry.create());
+
+		registry.destroy(entities[3]);
+		entities[3] = registry.create();
+		registry.destroy(entities[5]);
+		entities.erase(entities.begin() + 5);
+
+		for (u32 i = 0; i < entities.size(); i++)
+		{
+			const float f = float(i);
+			auto entity = entities[i];
+
+			auto& transform = registry.emplace<Maths::Transform>(entity, Maths::Vector3(f, f * 2.0f, -f));
+			transform.SetLocalScale(Maths::Vector3(1.0f + f, 2.0f, 0.5f));
+			transform.SetLocalOrientation(Maths::Quaternion(f * 10.0f, f * 20.0f, 5.0f));
+
+			registry.emplace<NameComponent>(entity, "Entity " + StringFormat::ToString(i));
+			registry.emplace<ActiveComponent>(entity, i % 3 != 0);
+
+			if (i % 2 == 0)
+				registry.emplace<TagComponent>(entity, i == 0 ? String() : "Tag " + StringFormat::ToString(i));
+		}
+
+		registry.emplace<Hierarchy>(entities[1], entities[0]);
+		registry.emplace<Hierarchy>(entities[2], entities[0]);
+		registry.emplace<Hierarchy>(entities[4], entities[2]);
+
+		mesh = CreateRef<Graphics::Mesh>();
+		material = CreateRef<Material>();
+		registry.emplace<MeshComponent>(entities[1], mesh);
+		registry.emplace<MeshComponent>(entities[2], mesh);
+		registry.emplace<MaterialComponent>(entities[1], material);
+		registry.emplace<MaterialComponent>(entities[2], material);
+
+		registry.emplace<Graphics::Light>(entities[0], Maths::Vector3(0.0f, -1.0f, 0.2f), Maths::Vector4(1.0f, 0.5f, 0.25f, 1.0f), 2.0f, Graphics::LightType::DirectionalLight);
+		registry.emplace<Graphics::Light>(entities[4], Maths::Vector3(0.0f), Maths::Vector4(0.2f, 1.0f, 0.2f, 1.0f), 4.0f, Graphics::LightType::SpotLight, Maths::Vector3(3.0f, 4.0f, 5.0f), 12.0f, 30.0f);
+
+		auto& camera = registry.emplace<Camera>(entities[3], -10.0f, 45.0f, Maths::Vector3(1.0f, 2.0f, 3.0f), 60.0f, 0.1f, 500.0f, 16.0f / 9.0f);
+		camera.SetRoll(3.0f);
+		camera.SetScale(2.0f);
+		camera.SetIsOrthographic(true);
+
+		const Ref<CollisionShape> shapes[3] = { CreateRef<CuboidCollisionShape>(Maths::Vector3(1.0f, 2.0f, 3.0f)), CreateRef<SphereCollisionShape>(1.5f), CreateRef<CapsuleCollisionShape>(0.5f, 2.0f) };
+		for (u32 i = 0; i < 3; i++)
+		{
+			const float f = float(i + 1);
+			auto object = CreateRef<PhysicsObject3D>();
+			object->SetCollisionShape(shapes[i]);
+			object->SetPosition(Maths::Vector3(f, 10.0f * f, 0.0f));
+			object->SetOrientation(Maths::Quaternion(0.0f, 30.0f * f, 0.0f));
+			object->SetLinearVelocity(Maths::Vector3(0.0f, -f, 0.0f));
+			object->SetAngularVelocity(Maths::Vector3(f, 0.0f, 0.0f));
+			object->SetForce(Maths::Vector3(0.0f, 0.0f, f));
+			object->SetTorque(Maths::Vector3(f, f, 0.0f));
+			object->SetInverseMass(1.0f / f);
+			object->SetInverseInertia(Maths::Matrix3(1.0f / f, 0.0f, 0.0f, 0.0f, 2.0f / f, 0.0f, 0.0f, 0.0f, 3.0f / f));
+			object->SetElasticity(0.1f * f);
+			object->SetFriction(0.2f * f);
+			object->SetIsAtRest(i == 1);
+			object->SetIsStatic(i == 2);
+			registry.emplace<Physics3DComponent>(entities[4 + i], object);
+		}
+
+		// Not found, so nothing is run, but the path and rate are still saved
+		auto& script = registry.emplace<ScriptComponent>(entities[6], "Missing/SnapshotTest.lua", nullptr);
+		script.SetUpdateRate(ScriptUpdateRate::TenHz);
+	}
+
+	template<typename T, typename Compare>
+	void CheckComponents(entt::registry& source, entt::registry& target, Compare compare)
+	{
+		CHECK(source.view<T>().size() == target.view<T>().size());
+
+		source.view<T>().each([&](auto entity, auto& component)
+		{
+			auto restored = target.try_get<T>(entity);
+			if (CHECK(restored))
+				CHECK(compare(component, *restored));
+		});
+	}
+
+	// Everything with a binary form, meshes and materials are compared by the callers
+	void CheckSavedComponents(entt::registry& source, entt::registry& target)
+	{
+		CHECK(source.alive() == target.alive());
+		CHECK(source.size() == target.size());
+		for (size_t i = 0; i < source.size() && i < target.size(); i++)
+			CHECK(source.data()[i] == target.data()[i]);
+
+		CheckComponents<Maths::Transform>(source, target, [](const Maths::Transform& a, const Maths::Transform& b)
+		{
+			return a.GetLocalPosition() == b.GetLocalPosition() && a.GetLocalScale() == b.GetLocalScale() && a.GetLocalOrientation() == b.GetLocalOrientation();
+		});
+
+		CheckComponents<Hierarchy>(source, target, [](const Hierarchy& a, const Hierarchy& b)
+		{
+			return a.parent() == b.parent() && a.first() == b.first() && a.next() == b.next() && a.prev() == b.prev();
+		});
+
+		CheckComponents<NameComponent>(source, target, [](const NameComponent& a, const NameComponent& b) { return a.name == b.name; });
+		CheckComponents<TagComponent>(source, target, [](const TagComponent& a, const TagComponent& b) { return a.tag == b.tag; });
+		CheckComponents<ActiveComponent>(source, target, [](const ActiveComponent& a, const ActiveComponent& b) { return a.active == b.active; });
+
+		CheckComponents<Graphics::Light>(source, target, [](const Graphics::Light& a, const Graphics::Light& b)
+		{
+			return a.m_Colour == b.m_Colour && a.m_Position == b.m_Position && a.m_Direction == b.m_Direction && a.m_Intensity == b.m_Intensity
+				&& a.m_Radius == b.m_Radius && a.m_Type == b.m_Type && a.m_Angle == b.m_Angle;
+		});
+
+		CheckComponents<Camera>(source, target, [](const Camera& a, const Camera& b)
+		{
+			return a.GetPitch() == b.GetPitch() && a.GetYaw() == b.GetYaw() && a.GetRoll() == b.GetRoll() && a.GetPosition() == b.GetPosition()
+				&& a.GetAspectRatio() == b.GetAspectRatio() && a.GetScale() == b.GetScale() && a.GetFOV() == b.GetFOV()
+				&& a.GetNear() == b.GetNear() && a.GetFar() == b.GetFar() && a.IsOrthographic() == b.IsOrthographic();
+		});
+
+		CheckComponents<Physics3DComponent>(source, target, [](const Physics3DComponent& a, const Physics3DComponent& b)
+		{
+			auto x = a.GetPhysicsObject();
+			auto y = b.GetPhysicsObject();
+			return x->GetPosition() == y->GetPosition() && x->GetOrientation() == y->GetOrientation()
+				&& x->GetLinearVelocity() == y->GetLinearVelocity() && x->GetAngularVelocity() == y->GetAngularVelocity()
+				&& x->GetForce() == y->GetForce() && x->GetTorque() == y->GetTorque() && x->GetInverseInertia() == y->GetInverseInertia()
+				&& x->GetInverseMass() == y->GetInverseMass() && x->GetElasticity() == y->GetElasticity() && x->GetFriction() == y->GetFriction()
+				&& x->GetIsStatic() == y->GetIsStatic() && x->GetIsAtRest() == y->GetIsAtRest()
+				&& y->GetCollisionShape() && x->GetCollisionShape()->GetType() == y->GetCollisionShape()->GetType();
+		});
+
+		CheckComponents<ScriptComponent>(source, target, [](const ScriptComponent& a, const ScriptComponent& b)
+		{
+			return a.GetFilePath() == b.GetFilePath() && a.GetUpdateRate() == b.GetUpdateRate();
+		});
+	}
+
+	std::vector<u8> ReadSnapshotFile()
+	{
+		std::vector<u8> data(static_cast<size_t>(FileSystem::GetFileSize(SnapshotPath)));
+		FileSystem::ReadFile(SnapshotPath, data.data(), data.size());
+		return data;
+	}
+
+	void WriteSnapshotFile(std::vector<u8>& data)
+	{
+		FileSystem::WriteFile(SnapshotPath, data.data(), static_cast<u32>(data.size()));
+	}
+}
+
+TEST_CASE("Scene snapshot restores every component in the same session")
+{
+	entt::registry source;
+	SceneGraph sourceGraph;
+	sourceGraph.Init(source);
+
+	Ref<Graphics::Mesh> mesh;
+	Ref<Material> material;
+	BuildScene(source, mesh, material);
+
+	SceneSnapshot snapshot;
+	snapshot.Capture(source);
+	CHECK(snapshot.GetEntityCount() == source.alive());
+
+	entt::registry target;
+	SceneGraph targetGraph;
+	targetGraph.Init(target);
+	REQUIRE(snapshot.Restore(target));
+
+	CheckSavedComponents(source, target);
+
+	// Shared assets come back shared, not copied
+	CheckComponents<MeshComponent>(source, target, [](const MeshComponent& a, const MeshComponent& b) { return a.GetMesh() == b.GetMesh(); });
+	CheckComponents<MaterialComponent>(source, target, [](const MaterialComponent& a, const MaterialComponent& b) { return a.GetMaterial() == b.GetMaterial(); });
+}
+
+TEST_CASE("Scene snapshot round trips saved components through a file")
+{
+	entt::registry source;
+	SceneGraph sourceGraph;
+	sourceGraph.Init(source);
+
+	Ref<Graphics::Mesh> mesh;
+	Ref<Material> material;
+	BuildScene(source, mesh, material);
+
+	SceneSnapshot snapshot;
+	snapshot.Capture(source);
+	REQUIRE(snapshot.Save(SnapshotPath));
+
+	SceneSnapshot loaded;
+	REQUIRE(loaded.Load(SnapshotPath));
+	CHECK(loaded.GetEntityCount() == snapshot.GetEntityCount());
+	CHECK(loaded.GetSize() == snapshot.GetSize());
+
+	entt::registry target;
+	SceneGraph targetGraph;
+	targetGraph.Init(target);
+	REQUIRE(loaded.Restore(target));
+
+	CheckSavedComponents(source, target);
+
+	// The test mesh has no source file, so only its materials come back from disk
+	CHECK(target.view<MaterialComponent>().size() == source.view<MaterialComponent>().size());
+
+	std::remove(SnapshotPath);
+}
+
+TEST_CASE("Scene snapshot skips unknown chunks")
+{
+	entt::registry source;
+	SceneGraph sourceGraph;
+	sourceGraph.Init(source);
+
+	Ref<Graphics::Mesh> mesh;
+	Ref<Material> material;
+	BuildScene(source, mesh, material);
+
+	SceneSnapshot snapshot;
+	snapshot.Capture(source);
+	REQUIRE(snapshot.Save(SnapshotPath));
+
+	// A chunk from a newer build, between the header and the entities, and another at the end
+	std::vector<u8> data = ReadSnapshotFile();
+	REQUIRE(data.size() > sizeof(FileHeader));
+
+	const u8 payload[12] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+	const FileChunkHeader unknown = { 0x4B4E4B55, 3, 7, sizeof(payload) };
+
+	std::vector<u8> chunk(sizeof(unknown) + sizeof(payload));
+	memcpy(chunk.data(), &unknown, sizeof(unknown));
+	memcpy(chunk.data() + sizeof(unknown), payload, sizeof(payload));
+
+	data.insert(data.begin() + sizeof(FileHeader), chunk.begin(), chunk.end());
+	data.insert(data.end(), chunk.begin(), chunk.end());
+
+	FileHeader header;
+	memcpy(&header, data.data(), sizeof(header));
+	header.chunkCount += 2;
+	memcpy(data.data(), &header, sizeof(header));
+	WriteSnapshotFile(data);
+
+	SceneSnapshot loaded;
+	REQUIRE(loaded.Load(SnapshotPath));
+
+	entt::registry target;
+	SceneGraph targetGraph;
+	targetGraph.Init(target);
+	REQUIRE(loaded.Restore(target));
+
+	CheckSavedComponents(source, target);
+
+	std::remove(SnapshotPath);
+}
+
+TEST_CASE("Scene snapshot rejects newer versions and other files")
+{
+	entt::registry source;
+	SceneGraph sourceGraph;
+	sourceGraph.Init(source);
+
+	Ref<Graphics::Mesh> mesh;
+	Ref<Material> material;
+	BuildScene(source, mesh, material);
+
+	SceneSnapshot snapshot;
+	snapshot.Capture(source);
+	REQUIRE(snapshot.Save(SnapshotPath));
+
+	std::vector<u8> data = ReadSnapshotFile();
+	FileHeader header;
+	memcpy(&header, data.data(), sizeof(header));
+
+	// A newer format loads, but restoring it fails and leaves the registry alone
+	header.version++;
+	memcpy(data.data(), &header, sizeof(header));
+	WriteSnapshotFile(data);
+
+	SceneSnapshot newer;
+	CHECK(newer.Load(SnapshotPath));
+
+	entt::registry target;
+	auto existing = target.create();
+	target.emplace<NameComponent>(existing, "Existing");
+
+	CHECK(!newer.Restore(target));
+	CHECK(target.alive() == 1);
+	CHECK(target.valid(existing) && target.get<NameComponent>(existing).name == "Existing");
+
+	// Not a snapshot at all
+	header.version--;
+	header.magic = 0x46464952;
+	memcpy(data.data(), &header, sizeof(header));
+	WriteSnapshotFile(data);
+
+	SceneSnapshot other;
+	CHECK(!other.Load(SnapshotPath));
+	CHECK(other.Empty());
+
+	// Cut short in the middle of a chunk
+	header.magic = 0x53534D4C;
+	memcpy(data.data(), &header, sizeof(header));
+	data.resize(data.size() / 2);
+	WriteSnapshotFile(data);
+
+	SceneSnapshot truncated;
+	CHECK(truncated.Load(SnapshotPath));
+	CHECK(!truncated.Restore(target));
+
+	std::remove(SnapshotPath);
+}
+
+TEST_CASE("Scene snapshot restores a large scene")
+{
+	const u32 entityCount = 10000;
+
+	entt::registry source;
+	SceneGraph sourceGraph;
+	sourceGraph.Init(source);
+
+	// Roots with up to 64 children each
+	entt::entity parent = entt::null;
+	for (u32 i = 0; i < entityCount; i++)
+	{
+		auto entity = source.create();
+		source.emplace<Maths::Transform>(entity, Maths::Vector3(float(i), 0.0f, float(i % 64)));
+		source.emplace<NameComponent>(entity, "Entity " + StringFormat::ToString(i));
+
+		if (i % 64 == 0)
+			parent = entity;
+		else
+			source.emplace<Hierarchy>(entity, parent);
+	}
+
+	SceneSnapshot snapshot;
+	snapshot.Capture(source);
+	REQUIRE(snapshot.Save(SnapshotPath));
+
+	SceneSnapshot loaded;
+	REQUIRE(loaded.Load(SnapshotPath));
+
+	entt::registry target;
+	SceneGraph targetGraph;
+	targetGraph.Init(target);
+	REQUIRE(loaded.Restore(target));
+
+	CheckSavedComponents(source, target);
+	printf("    %u entities, capture %.2f ms, restore %.2f ms, %.1f KB\n", entityCount, snapshot.GetCaptureTime(), loaded.GetRestoreTime(), snapshot.GetSize() / 1024.0f);
+
+	std::remove(SnapshotPath);
+}
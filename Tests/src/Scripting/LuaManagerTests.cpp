@@ -0,0 +1,75 @@
+#include "Test.h"
+#include "Scripting/LuaManager.h"
+#include "Maths/Transform.h"
+
+using namespace Lumos;
+
+namespace
+{
+	// Runs chunk, returning false with the error printed when it raises one
+	bool Run(sol::state& state, const char* chunk)
+	{
+		auto result = state.safe_script(chunk, sol::script_pass_on_error);
+		if (!result.valid())
+		{
+			sol::error error = result;
+			printf("    %s\n", error.what());
+		}
+		return result.valid();
+	}
+}
+
+TEST_CASE("Bulk transform access follows entities being removed")
+{
+	sol::state state;
+	state.open_libraries(sol::lib::base, sol::lib::table);
+	LuaManager::Instance()->BindECSLua(state);
+
+	entt::registry registry;
+	std::vector<entt::entity> entities;
+	for (u32 i = 0; i < 4; i++)
+	{
+		entities.push_back(registry.create());
+		registry.emplace<Maths::Transform>(entities.back(), Maths::Vector3(float(i), float(i * 10), float(i * 100)));
+	}
+	state["registry"] = std::ref(registry);
+
+	REQUIRE(Run(state, R"(
+		positions, ids = {}, {}
+		count = registry:GetPositions(positions, ids)
+		for i = 1, #positions do positions[i] = positions[i] + 1 end
+		registry:SetPositions(positions, ids)
+	)"));
+	CHECK(state.get<u32>("count") == 4);
+	CHECK(registry.get<Maths::Transform>(entities[2]).GetLocalPosition() == Maths::Vector3(3.0f, 21.0f, 201.0f));
+
+	registry.destroy(entities[1]);
+
+	// The reused tables lose their last entity, and what is left lines up with the registry again
+	REQUIRE(Run(state, R"(
+		count = registry:GetPositions(positions, ids)
+		valuesLeft, idsLeft = #positions, #ids
+		stale = positions[10] ~= nil or ids[4] ~= nil
+		for i = 1, #positions do positions[i] = positions[i] * 2 end
+		registry:SetPositions(positions, ids)
+	)"));
+	CHECK(state.get<u32>("count") == 3);
+	CHECK(state.get<u32>("valuesLeft") == 9);
+	CHECK(state.get<u32>("idsLeft") == 3);
+	CHECK(!state.get<bool>("stale"));
+
+	const Maths::Vector3 expected[4] = { Maths::Vector3(2.0f, 2.0f, 2.0f), Maths::Vector3(), Maths::Vector3(6.0f, 42.0f, 402.0f), Maths::Vector3(8.0f, 62.0f, 602.0f) };
+	for (u32 i : { 0u, 2u, 3u })
+		CHECK(registry.get<Maths::Transform>(entities[i]).GetLocalPosition() == expected[i]);
+
+	// Tables from before the removal no longer match and write nothing
+	REQUIRE(Run(state, R"(
+		stalePositions = { 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4 }
+		wrongCount = not pcall(registry.SetPositions, registry, stalePositions)
+		stalePositions[10], stalePositions[11], stalePositions[12] = nil, nil, nil
+		wrongOrder = not pcall(registry.SetPositions, registry, stalePositions, { ids[2], ids[1], ids[3] })
+	)"));
+	CHECK(state.get<bool>("wrongCount"));
+	CHECK(state.get<bool>("wrongOrder"));
+	CHECK(registry.get<Maths::Transform>(entities[0]).GetLocalPosition() == expected[0]);
+}
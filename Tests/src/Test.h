@@ -0,0 +1,59 @@
+#pragma once
+
+#include "lmpch.h"
+
+// Minimal self registering test cases, run by Main.cpp. A failed CHECK records the failure
+// and carries on, a failed REQUIRE also leaves the test case.
+
+namespace Lumos
+{
+	namespace Test
+	{
+		struct TestCase
+		{
+			const char* name;
+			void (*func)();
+		};
+
+		inline std::vector<TestCase>& GetTestCases()
+		{
+			static std::vector<TestCase> testCases;
+			return testCases;
+		}
+
+		inline u32& GetFailureCount()
+		{
+			static u32 failures = 0;
+			return failures;
+		}
+
+		inline bool Report(bool passed, const char* expression, const char* file, int line)
+		{
+			if (!passed)
+			{
+				printf("    %s(%d): check failed: %s\n", file, line, expression);
+				GetFailureCount()++;
+			}
+			return passed;
+		}
+
+		struct Registrar
+		{
+			Registrar(const char* name, void (*func)()) { GetTestCases().push_back({ name, func }); }
+		};
+	}
+}
+
+#define LUMOS_TEST_CONCAT_IMPL(a, b) a##b
+#define LUMOS_TEST_CONCAT(a, b) LUMOS_TEST_CONCAT_IMPL(a, b)
+
+#define TEST_CASE(name)                                                                                            \
+	static void LUMOS_TEST_CONCAT(TestFunc, __LINE__)();                                                           \
+	static Lumos::Test::Registrar LUMOS_TEST_CONCAT(TestRegistrar, __LINE__)(name, &LUMOS_TEST_CONCAT(TestFunc, __LINE__)); \
+	static void LUMOS_TEST_CONCAT(TestFunc, __LINE__)()
+
+#define CHECK(expr) Lumos::Test::Report(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+#define CHECK_CLOSE(a, b, epsilon) Lumos::Test::Report(std::abs((a) - (b)) <= (epsilon), #a " ~= " #b, __FILE__, __LINE__)
+#define REQUIRE(expr)      \
+	if (!CHECK(expr))      \
+		return
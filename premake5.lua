@@ -55,6 +55,7 @@ workspace "Lumos"
 
 	require("Lumos/premake5")
 	require("Sandbox/premake5")
+	require("Tests/premake5")
 
 	filter()
 